@@ -27,6 +27,8 @@
 #endif
 #include "dev/button-hal.h"
 #include "sys/log.h"
+#include "sys/energest.h"
+#include "sys/platform.h"
 #if !CONTIKI_TARGET_COOJA
 #include "Board.h"
 #include <ti/drivers/pin/PINCC26XX.h>
@@ -46,8 +48,12 @@
 #include "sf_joinRequester.h"
 #include "sf_measSender.h"
 #include "sf_tsch.h"
+#include "sf_tschDrift.h"
+#include "sf_txPower.h"
 #include "sf_app_api.h"
 #include "sf_led.h"
+#include "sf_bootProfile.h"
+#include "sf_memMonitor.h"
 //reboot includes
 #include <ti/devices/DeviceFamily.h>
 #include DeviceFamily_constructPath(driverlib/sys_ctrl.h)
@@ -72,6 +78,12 @@
 #ifndef LED_ENABLED
 #define LED_ENABLED                1
 #endif
+/* Latest start of the init deferred on a fast boot */
+#ifndef SF_APP_CONF_DEFERRED_INIT_TIMEOUT
+  #define SF_APP_DEFERRED_INIT_TIMEOUT     (30UL * CLOCK_SECOND)
+#else
+  #define SF_APP_DEFERRED_INIT_TIMEOUT     SF_APP_CONF_DEFERRED_INIT_TIMEOUT
+#endif
 
 /*=============================================================================
                                 GLOBAL VARIABLES
@@ -97,6 +109,8 @@ uint16_t adcValue2;
 uint32_t adcValue2MicroVolt;
 float temp_in_celsius=0.0;
 float v_batt_sense = 0.0;
+/* Timer of the latest start of the deferred init */
+static struct ctimer gDeferredInitTimer;
 
 
 /*=============================================================================
@@ -120,10 +134,37 @@ PROCESS(button_process, "The button handler");
 
 /*============================================================================*/
 /**
- * \brief Perform factory reset then go into shutdown mode.
+ * \brief Start the init which is not needed for the first uplink. It is
+ *        deferred on a fast boot and called once the first measurement has
+ *        been acknowledged or the deferral timed out.
+ */
+/*============================================================================*/
+static void device_deferredInit(void *ptr)
+{
+  ctimer_stop(&gDeferredInitTimer);
+
+  if(!process_is_running(&button_process))
+  {
+#if PLATFORM_DEFERS_INIT
+    /* Console and LED boot indication */
+    platform_init_deferred();
+#endif
+    LOG_INFO("Deferred init\n");
+
+    /* Start button handle process. */
+    process_start(&button_process, NULL);
+  }
+} /* device_deferredInit() */
+
+/*============================================================================*/
+/**
+ * \brief Perform factory reset. The caller shows the result and goes into
+ *        shutdown mode.
+ *
+ * \return True if the configuration has been removed.
  */
 /*============================================================================*/
-static void device_factoryReset(void)
+static bool device_factoryReset(void)
 {
   /* Set device status to not connected */
   sf_configMgmt_setDeviceStatus(E_CONFIGMGMT_DEVICESTATUS_NOT_CONNECTED);
@@ -139,19 +180,17 @@ static void device_factoryReset(void)
     /* Restart. */
     SysCtrlSystemReset();
 #endif
+    return false;
   }
-  else
-  {
-    /* Turn off device and wait for button press. */
-    sf_led_flash(LEDS_CONF_RED);
-    sf_led_flash(LEDS_CONF_GREEN);
-    sf_led_flash(LEDS_CONF_RED);
-    sf_led_flash(LEDS_CONF_GREEN);
 
-#if !CONTIKI_TARGET_COOJA
-    sf_app_shutDownDevice();
-#endif
+  /* Turn off device and wait for button press. */
+  if(!sf_led_flash(LEDS_CONF_RED) || !sf_led_flash(LEDS_CONF_GREEN) ||
+     !sf_led_flash(LEDS_CONF_RED) || !sf_led_flash(LEDS_CONF_GREEN))
+  {
+    LOG_ERR("!LED pattern queue full\n");
   }
+
+  return true;
 } /* device_factoryReset() */
 
 /*=============================================================================
@@ -196,12 +235,28 @@ PROCESS_THREAD(button_process, ev, data)
         if(pressDuration > 10U)
         {
           /* Factory reset and go off. All configuration will be deleted */
-          device_factoryReset();
+          if(device_factoryReset())
+          {
+            /* The scheduler keeps running while the LEDs flash. */
+            if(sf_led_isBusy())
+            {
+              PROCESS_WAIT_EVENT_UNTIL((ev == sf_led_event) && !sf_led_isBusy());
+            }
+#if !CONTIKI_TARGET_COOJA
+            sf_app_shutDownDevice();
+#endif
+          }
         }
         else if(pressDuration > 3U)
         {
-          sf_led_flash(LEDS_CONF_RED);
-          sf_led_flash(LEDS_CONF_GREEN);
+          if(!sf_led_flash(LEDS_CONF_RED) || !sf_led_flash(LEDS_CONF_GREEN))
+          {
+            LOG_ERR("!LED pattern queue full\n");
+          }
+          if(sf_led_isBusy())
+          {
+            PROCESS_WAIT_EVENT_UNTIL((ev == sf_led_event) && !sf_led_isBusy());
+          }
 
           /* Sleep mode */
 #if !CONTIKI_TARGET_COOJA
@@ -213,14 +268,20 @@ PROCESS_THREAD(button_process, ev, data)
           /* Show current device state.
             Green LED flash if connected and associated
             Red LED flash otherwise */
-          if(E_CONFIGMGMT_DEVICESTATUS_NOT_CONNECTED == sf_configMgmt_getDeviceStatus() ||
+          if(E_CONFIGMGMT_DEVICESTATUS_CONNECTED != sf_configMgmt_getDeviceStatus() ||
             !tsch_is_associated)
           {
-            sf_led_flash(LEDS_CONF_RED);
+            if(!sf_led_flash(LEDS_CONF_RED))
+            {
+              LOG_ERR("!LED pattern queue full\n");
+            }
           }
           else
           {
-            sf_led_flash(LEDS_CONF_GREEN);
+            if(!sf_led_flash(LEDS_CONF_GREEN))
+            {
+              LOG_ERR("!LED pattern queue full\n");
+            }
           }
           GPIO_toggleDio(CC26X2R1_LAUNCHXL_SB_LED1);
         }
@@ -244,15 +305,20 @@ PROCESS_THREAD(sc_app_process, ev, data)
   uint16_t panId = 0;
   /* Device address */
   linkaddr_t deviceAddress = linkaddr_null;
+  /* Source of the last reset */
+  uint32_t resetSource;
 
   PROCESS_BEGIN();
 
+  /* Get reboot source of last restart. */
+  resetSource = SysCtrlResetSourceGet();
+  sf_bootProfile_init((uint8_t)resetSource);
+  sf_memMonitor_init();
+
   LOG_INFO("Starting as smart cell\n");
   LOG_INFO("Version: 1.0.0\n");
   LOG_INFO("Bitrate: %u kbps\n", SF_RADIO_BIT_RATE);
 
-  /* Get reboot source of last restart. */
-    uint32_t resetSource = SysCtrlResetSourceGet();
     if(RSTSRC_WAKEUP_FROM_SHUTDOWN == resetSource)
     {
       LOG_ERR("Reboot shut, button\n");
@@ -287,14 +353,11 @@ PROCESS_THREAD(sc_app_process, ev, data)
   {
     LOG_ERR("!Failed to select GLOB2G4 RF region\n");
   }
+  sf_bootProfile_mark(E_SF_BOOTPROFILE_PHASE_RF_READY);
 
-  /* Set Tx power to Max */
+  /* Set Tx power to Max. The Tx power control lowers it once joined. */
   sf_tsch_setTxPowerMax();
-
-  /* Start button handle process. */
-  process_start(&button_process, NULL);
-
-
+  sf_txPower_init();
 
   /* Read device configuration */
   if(E_SF_SUCCESS == sf_configMgmt_readConfig())
@@ -346,10 +409,26 @@ PROCESS_THREAD(sc_app_process, ev, data)
   {
     LOG_INFO("Stored network ID 0x%02X \n", panId);
   }
+  sf_bootProfile_mark(E_SF_BOOTPROFILE_PHASE_CONFIG_READY);
+
+  /* Fast boot: A known network is rejoined without waiting for the
+     button handler. A wake-up by the button needs it to see the press. */
+  if((0 != panId) && (RSTSRC_WAKEUP_FROM_SHUTDOWN != resetSource))
+  {
+    ctimer_set(&gDeferredInitTimer, SF_APP_DEFERRED_INIT_TIMEOUT,
+               device_deferredInit, NULL);
+  }
+  else
+  {
+    device_deferredInit(NULL);
+  }
 
   /* Check network ID validity and determine start mode
      + Mode Cold: invalid network id
      + Mode Warm: valid network id */
+  /* Learn the clock drift, restore the stored one on warm start only */
+  sf_tschDrift_start(0 != panId);
+
   if(0 != panId)
   {
     LOG_INFO("Valid PAN ID; Warm start\n");
@@ -367,10 +446,12 @@ PROCESS_THREAD(sc_app_process, ev, data)
        The Manual join window should be open on the BMSCC*/
     sf_joinRequester_join();
   }
+  sf_bootProfile_mark(E_SF_BOOTPROFILE_PHASE_JOIN_START);
 
-  /* Wait until device is connected to start sending measurements */
-  PROCESS_YIELD_UNTIL(E_CONFIGMGMT_DEVICESTATUS_CONNECTED ==
+  /* Wait until the data slots are assigned to start sending measurements */
+  PROCESS_YIELD_UNTIL(E_CONFIGMGMT_DEVICESTATUS_NOT_CONNECTED !=
                         sf_configMgmt_getDeviceStatus());
+  sf_bootProfile_mark(E_SF_BOOTPROFILE_PHASE_CONNECTED);
 
 
 
@@ -399,9 +480,11 @@ PROCESS_THREAD(sc_app_process, ev, data)
   gpio_hal_arch_pin_set_output( NULL, TSCH_TIMING_PIN_4 );
 #endif
 
-
-
-
+  /* Finish the deferred init after the first uplink. The timeout may have
+     finished it before. */
+  PROCESS_WAIT_EVENT_UNTIL(process_is_running(&button_process) ||
+                           (sf_bootProfile_event == ev));
+  device_deferredInit(NULL);
 
   PROCESS_END();
 }/* sc_app_process() */
@@ -453,6 +536,7 @@ PROCESS_THREAD(adc_sb_process, ev, data)
       uint_least8_t adc_index_ct = 6; // index = 6 for current, IOID_29 and index = 7 for voltage, IOID_30, index = 5 for temperature
       uint_least8_t adc_index_temp = 5; // index = 6 for current, IOID_29 and index = 7 for voltage, IOID_30, index = 5 for temperature
 
+      ENERGEST_ON(ENERGEST_TYPE_SF_ADC);
       ADC_Params_init(&params);
       adc_ct = ADC_open(adc_index_ct, &params);
       /* Blocking mode conversion */
@@ -488,8 +572,10 @@ PROCESS_THREAD(adc_sb_process, ev, data)
 
 
       ADC_close(adc_temp);
+      ENERGEST_OFF(ENERGEST_TYPE_SF_ADC);
 
       temp_in_celsius = adcValue2MicroVolt*0.00001251 + 4.518; // Using linear fit based on experimental data
+      sf_tschDrift_setTemperature((int8_t)temp_in_celsius);
       v_batt_sense = adcValue0MicroVolt*0.000003; // scaled down gain is 1/3 in the schematic, so we multiply by 3e-6 on the microvolt value of the adc
 
 
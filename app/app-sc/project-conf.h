@@ -41,6 +41,13 @@
  */
 #define TSCH_CONF_DEFAULT_TIMESLOT_TIMING        tsch_timeslot_timing_us_7500
 
+/**
+ *  Maps the timeslot template ID advertised by the BMS-CC in the EB to the
+ *  local timeslot timing. The timing (7500, 5000 or 4000 us) is therefore
+ *  selected at join time. See sf-tsch-timeslot.h.
+ */
+#define TSCH_CALLBACK_GET_TIMESLOT_TIMING        sf_tsch_timeslot_get_timing
+
 /**
  *  Path to timeslot Header file.
  */
@@ -193,6 +200,12 @@
 /** Maximum number of devices */
 #define APP_MAX_DEVICES                           100
 
+/** Number of channel offsets (shards) the data slots can be assigned to.
+ *  Each BMS-CC serves the cells of one channel offset, so the data slots
+ *  can be reused by several BMS-CCs. Must not exceed the hopping sequence
+ *  length. The offset is assigned within the join response. */
+#define APP_SLOTFRAME_CHANNEL_OFFSET_NUM          4
+
 /* Maximum number of device slots */
 #define APP_MAX_DEVICE_SLOTS                      0
 
@@ -217,12 +230,49 @@
 /** Maximum allowed absolute time (AT) drift between beacon AT and internal AT */
 #define TSCH_CONF_MAX_AT_DRIFT                   2
 
+/** Defines the callback function called by TSCH when joining a network. */
+#define TSCH_CALLBACK_JOINING_NETWORK            sf_bootProfile_joiningNetworkCallback
+
 /** Defines the callback function called by TSCH when leaving a network. */
 #define TSCH_CALLBACK_LEAVING_NETWORK            sf_tsch_leaving_network_callback
 
 /** Define a callback function called by TISCH at new slot cycle. */
 #define TSCH_CALLBACK_CYCLE_START                sf_measSender_cycleStartCallback
 
+/** Defines the callback function deciding whether a beacon slot is skipped. */
+#define TSCH_CALLBACK_SKIP_BEACON_RX             sf_tschDrift_skipBeaconCallback
+
+/** Defines the callback functions feeding the link quality cache and the Tx
+    power control. */
+#define TSCH_CALLBACK_LINK_RX                    sf_linkQuality_rxCallback
+#define TSCH_CALLBACK_LINK_TX                    sf_tsch_linkTxCallback
+
+/** Defines the callback functions splitting the Rx slot listening time into
+    beacon and downlink reception. */
+#define TSCH_CALLBACK_RX_LISTEN_START            sf_energy_rxListenStartCallback
+#define TSCH_CALLBACK_RX_LISTEN_END              sf_energy_rxListenEndCallback
+
+/** Defines the callback functions counting the slot operation failures. */
+#define TSCH_CALLBACK_DEADLINE_MISS              sf_slotStats_deadlineMissCallback
+#define TSCH_CALLBACK_SLOT_SKIPPED               sf_slotStats_slotSkippedCallback
+#define TSCH_CALLBACK_INPUT_QUEUE_DROP           sf_slotStats_inputQueueDropCallback
+#define TSCH_CALLBACK_ACK_TIMEOUT                sf_slotStats_ackTimeoutCallback
+
+/** Enables the energy accounting. */
+#define ENERGEST_CONF_ON                         1
+/** Energest types of the subsystems reported in the energy report. */
+#define ENERGEST_CONF_ADDITIONS                  ENERGEST_TYPE_SF_ADC, \
+                                                 ENERGEST_TYPE_SF_RX_BEACON, \
+                                                 ENERGEST_TYPE_SF_RX_DOWNLINK, \
+                                                 ENERGEST_TYPE_SF_FLASH
+
+/** Fills the stack at boot for the high watermark of the memory monitor,
+    which samples it itself. */
+#define STACK_CHECK_CONF_ENABLED                 1
+#define STACK_CHECK_CONF_PERIODIC_CHECKS         0
+/** Keeps the queue buffer watermark of the memory monitor. */
+#define QUEUEBUF_CONF_STATS                      1
+
 #if WITH_SECURITY
 /** Enable security */
 #define LLSEC802154_CONF_ENABLED                 1
@@ -304,6 +354,11 @@
 #else
 #define UART_SENSOR_PULLDOWN_AFTER_INIT          0
 #endif
+/** Defers the console and the LED boot indication until the first uplink.
+    Logs before are dropped. */
+#if !CONTIKI_TARGET_COOJA
+#define PLATFORM_CONF_DEFERS_INIT                1
+#endif
 
 #define RF_TEST_APP_WD_DEBUG_DISABLE             1
 
@@ -329,6 +384,11 @@
 #define LOG_CONF_LEVEL_RADIO                     LOG_LEVEL_NONE
 /** Log Configuration per slot. */
 #define TSCH_LOG_CONF_PER_SLOT                   1
+/** Per-slot logs as SLIP framed binary records instead of text, see
+    test/host/tsch_log_decode for the host decoder. */
+#ifndef TSCH_LOG_CONF_BINARY
+#define TSCH_LOG_CONF_BINARY                     0
+#endif
 /** The application LOG level. */
 #define LOG_CONF_APP                             LOG_LEVEL_INFO
 /** The application join LOG level. */
@@ -387,4 +447,20 @@
 #endif /* #if DEBUG_TSCH_TIMING_TX */
 #endif /* #if DEBUG_TSCH_TIMING */
 
+/** Profiles the slot operation timing, printed periodically on the UART. */
+#define SF_CONF_SLOTPROFILE                      0
+
+#if SF_CONF_SLOTPROFILE
+#ifdef DEBUG_TSCH_TIMING
+#error "The slot profiler and the TSCH timing pins share the debug hooks"
+#endif
+#include "sf_slotProfile.h"
+#define TSCH_DEBUG_INIT()                   sf_slotProfile_init()
+#define TSCH_DEBUG_INTERRUPT()              sf_slotProfile_interrupt()
+#define TSCH_DEBUG_SCHEDULE(target, now)    sf_slotProfile_schedule(target, now)
+#define TSCH_DEBUG_TX_SLOT_SLOT_START()     sf_slotProfile_txSlotStart()
+#define TSCH_DEBUG_RX_SLOT_RX_END()         sf_slotProfile_rxEnd()
+#define TSCH_DEBUG_RX_SLOT_ACK_SEND_START() sf_slotProfile_ackSendStart()
+#endif /* #if SF_CONF_SLOTPROFILE */
+
 #endif /* PROJECT_CONF_H_ */
@@ -0,0 +1,217 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Implementation of the boot phase profiler.
+*/
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+/* Stack include */
+#include "contiki.h"
+/* Application include */
+#include "sf_bootProfile.h"
+
+/* Log configuration */
+#include "sys/log.h"
+
+/*==============================================================================
+                            MACROS
+==============================================================================*/
+#define LOG_MODULE "Boot Profile"
+/* Defines log level*/
+#ifndef LOG_CONF_APP
+  #define LOG_LEVEL     LOG_LEVEL_NONE
+#else
+  #define LOG_LEVEL     LOG_CONF_APP
+#endif
+/* Marks valid retained data */
+#define SF_BOOTPROFILE_MAGIC             (0x5342504FUL)
+/* Time of a phase not reached */
+#define SF_BOOTPROFILE_TIME_NONE         (0xFFFFFFFFUL)
+/* Length of the report header */
+#define SF_BOOTPROFILE_REPORT_HEADER_LEN (4U)
+/* Keeps the data over a reset without power loss. */
+#if CONTIKI_TARGET_SIMPLELINK
+  #define SF_BOOTPROFILE_RETAINED        __attribute__((section(".noinit")))
+#else
+  #define SF_BOOTPROFILE_RETAINED
+#endif
+
+/*==============================================================================
+                            STRUCTS
+==============================================================================*/
+/*! Boot profile kept in retained RAM. */
+typedef struct
+{
+  /* Marks valid data */
+  uint32_t magic;
+  /* Number of boots */
+  uint16_t bootCount;
+  /* Source of the last reset */
+  uint8_t resetSource;
+  /* Whether the report has been delivered */
+  bool reported;
+  /* rtimer time of each phase */
+  rtimer_clock_t phaseTime[E_SF_BOOTPROFILE_PHASE_MAX];
+  /* Whether a phase has been reached */
+  bool phaseReached[E_SF_BOOTPROFILE_PHASE_MAX];
+} sf_bootProfile_t;
+
+/*==============================================================================
+                            GLOBAL VARIABLES
+==============================================================================*/
+/* Profile of this boot. Not initialized at startup. */
+static sf_bootProfile_t gBootProfile SF_BOOTPROFILE_RETAINED;
+/* Process notified of the first uplink */
+static struct process *gpProcess;
+/* Event posted when the first uplink is done */
+process_event_t sf_bootProfile_event;
+
+/*==============================================================================
+                      API FUNCTION IMPLEMENTATION
+==============================================================================*/
+/*------------------------------------------------------------------------------
+  sf_bootProfile_init()
+------------------------------------------------------------------------------*/
+void sf_bootProfile_init(uint8_t resetSource)
+{
+  /* Boot count of the previous boots */
+  uint16_t bootCount = 0;
+
+  /* The retained RAM is random after a power loss. */
+  if(SF_BOOTPROFILE_MAGIC == gBootProfile.magic)
+  {
+    bootCount = gBootProfile.bootCount;
+  }
+
+  memset(&gBootProfile, 0, sizeof(gBootProfile));
+  gBootProfile.magic = SF_BOOTPROFILE_MAGIC;
+  gBootProfile.bootCount = bootCount + 1;
+  gBootProfile.resetSource = resetSource;
+
+  if(PROCESS_EVENT_NONE == sf_bootProfile_event)
+  {
+    sf_bootProfile_event = process_alloc_event();
+  }
+  gpProcess = PROCESS_CURRENT();
+
+  LOG_INFO("Boot %u, reset source %u\n", gBootProfile.bootCount, resetSource);
+
+  sf_bootProfile_mark(E_SF_BOOTPROFILE_PHASE_APP_START);
+}/* sf_bootProfile_init() */
+
+/*------------------------------------------------------------------------------
+  sf_bootProfile_mark()
+------------------------------------------------------------------------------*/
+void sf_bootProfile_mark(E_SF_BOOTPROFILE_PHASE_t phase)
+{
+  if((E_SF_BOOTPROFILE_PHASE_MAX <= phase) || gBootProfile.phaseReached[phase])
+  {
+    return;
+  }
+
+  /* The rtimer counts from the reset. */
+  gBootProfile.phaseTime[phase] = RTIMER_NOW();
+  gBootProfile.phaseReached[phase] = true;
+
+  LOG_INFO("Boot phase %u at %lu ms\n", phase,
+           (unsigned long)((uint64_t)gBootProfile.phaseTime[phase] * 1000U /
+                           RTIMER_SECOND));
+
+  if((E_SF_BOOTPROFILE_PHASE_FIRST_UPLINK == phase) && (NULL != gpProcess))
+  {
+    process_post(gpProcess, sf_bootProfile_event, NULL);
+  }
+}/* sf_bootProfile_mark() */
+
+/*------------------------------------------------------------------------------
+  sf_bootProfile_isReached()
+------------------------------------------------------------------------------*/
+bool sf_bootProfile_isReached(E_SF_BOOTPROFILE_PHASE_t phase)
+{
+  return (E_SF_BOOTPROFILE_PHASE_MAX > phase) &&
+         gBootProfile.phaseReached[phase];
+}/* sf_bootProfile_isReached() */
+
+/*------------------------------------------------------------------------------
+  sf_bootProfile_isReportPending()
+------------------------------------------------------------------------------*/
+bool sf_bootProfile_isReportPending(void)
+{
+  return !gBootProfile.reported &&
+         gBootProfile.phaseReached[E_SF_BOOTPROFILE_PHASE_FIRST_UPLINK];
+}/* sf_bootProfile_isReportPending() */
+
+/*------------------------------------------------------------------------------
+  sf_bootProfile_getReport()
+------------------------------------------------------------------------------*/
+uint8_t sf_bootProfile_getReport(uint8_t *pBuf, uint8_t maxLen)
+{
+  /* Report length */
+  uint8_t len = 0;
+  /* Time of a phase in milliseconds */
+  uint32_t timeMs;
+  uint8_t phase;
+
+  if((NULL == pBuf) || !sf_bootProfile_isReportPending() ||
+     (maxLen < (SF_BOOTPROFILE_REPORT_HEADER_LEN +
+                E_SF_BOOTPROFILE_PHASE_MAX * sizeof(timeMs))))
+  {
+    return 0;
+  }
+
+  memcpy(pBuf + len, &gBootProfile.bootCount, sizeof(gBootProfile.bootCount));
+  len += sizeof(gBootProfile.bootCount);
+  pBuf[len++] = gBootProfile.resetSource;
+  pBuf[len++] = E_SF_BOOTPROFILE_PHASE_MAX;
+
+  for(phase = 0; phase < E_SF_BOOTPROFILE_PHASE_MAX; phase++)
+  {
+    timeMs = gBootProfile.phaseReached[phase] ?
+             (uint32_t)((uint64_t)gBootProfile.phaseTime[phase] * 1000U /
+                        RTIMER_SECOND) :
+             SF_BOOTPROFILE_TIME_NONE;
+    memcpy(pBuf + len, &timeMs, sizeof(timeMs));
+    len += sizeof(timeMs);
+  }
+
+  return len;
+}/* sf_bootProfile_getReport() */
+
+/*------------------------------------------------------------------------------
+  sf_bootProfile_setReported()
+------------------------------------------------------------------------------*/
+void sf_bootProfile_setReported(void)
+{
+  gBootProfile.reported = true;
+}/* sf_bootProfile_setReported() */
+
+/*------------------------------------------------------------------------------
+  sf_bootProfile_joiningNetworkCallback()
+------------------------------------------------------------------------------*/
+void sf_bootProfile_joiningNetworkCallback(void)
+{
+  sf_bootProfile_mark(E_SF_BOOTPROFILE_PHASE_ASSOCIATED);
+}/* sf_bootProfile_joiningNetworkCallback() */
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,170 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __SF_BOOT_PROFILE_H__
+#define __SF_BOOT_PROFILE_H__
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Boot phase profiler.
+
+ @details The time of each boot phase from the reset up to the first
+          acknowledged measurement is taken from the rtimer and kept in
+          retained RAM together with a boot counter and the reset source.
+          Once the first measurement has been acknowledged, the profile is
+          sent to the BMS-CC in a boot profile frame. Every phase is logged,
+          so a boot can also be followed on the UART.
+*/
+
+/**
+ *  @addtogroup SF_BOOT_PROFILE
+ *
+ *  @details
+ *
+ *  - <b>Boot profile API</b>\n
+ *    | API Function                              | Description                                     |
+ *    |-------------------------------------------|-------------------------------------------------|
+ *    | @ref sf_bootProfile_init()                | @copybrief sf_bootProfile_init()                |
+ *    | @ref sf_bootProfile_mark()                | @copybrief sf_bootProfile_mark()                |
+ *    | @ref sf_bootProfile_isReached()           | @copybrief sf_bootProfile_isReached()           |
+ *    | @ref sf_bootProfile_isReportPending()     | @copybrief sf_bootProfile_isReportPending()     |
+ *    | @ref sf_bootProfile_getReport()           | @copybrief sf_bootProfile_getReport()           |
+ *    | @ref sf_bootProfile_setReported()         | @copybrief sf_bootProfile_setReported()         |
+ *    | @ref sf_bootProfile_joiningNetworkCallback() | @copybrief sf_bootProfile_joiningNetworkCallback() |
+ *  @{
+ */
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdint.h>
+#include <stdbool.h>
+/* Stack include */
+#include "contiki.h"
+
+/*==============================================================================
+                            ENUMS
+==============================================================================*/
+/*! Boot phases, in the order they are passed. */
+typedef enum
+{
+  /*! The application process has started. */
+  E_SF_BOOTPROFILE_PHASE_APP_START,
+  /*! The radio has been initialized. */
+  E_SF_BOOTPROFILE_PHASE_RF_READY,
+  /*! The configuration has been read. */
+  E_SF_BOOTPROFILE_PHASE_CONFIG_READY,
+  /*! The join or rejoin has been started. */
+  E_SF_BOOTPROFILE_PHASE_JOIN_START,
+  /*! TSCH is associated. */
+  E_SF_BOOTPROFILE_PHASE_ASSOCIATED,
+  /*! The device is connected to the BMS-CC. */
+  E_SF_BOOTPROFILE_PHASE_CONNECTED,
+  /*! The first measurement has been acknowledged. */
+  E_SF_BOOTPROFILE_PHASE_FIRST_UPLINK,
+  /*! Number of phases. */
+  E_SF_BOOTPROFILE_PHASE_MAX
+} E_SF_BOOTPROFILE_PHASE_t;
+
+/*==============================================================================
+                            GLOBAL VARIABLES
+==============================================================================*/
+/*! Event posted to the process which called @ref sf_bootProfile_init when
+    the first measurement has been acknowledged. */
+extern process_event_t sf_bootProfile_event;
+
+/*==============================================================================
+                            FUNCTION PROTOTYPES
+==============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Start the profile of this boot. Must be called first by the
+ *        application process, @ref sf_bootProfile_event is posted to it.
+ *
+ * \param resetSource   Source of the last reset.
+ */
+/*============================================================================*/
+void sf_bootProfile_init(uint8_t resetSource);
+
+/*============================================================================*/
+/**
+ * \brief Record the time a phase has been reached. Only the first time of
+ *        a phase is kept.
+ *
+ * \param phase         @ref E_SF_BOOTPROFILE_PHASE_t
+ */
+/*============================================================================*/
+void sf_bootProfile_mark(E_SF_BOOTPROFILE_PHASE_t phase);
+
+/*============================================================================*/
+/**
+ * \brief Check if a phase has been reached in this boot.
+ *
+ * \param phase         @ref E_SF_BOOTPROFILE_PHASE_t
+ *
+ * \return True if the phase has been reached.
+ */
+/*============================================================================*/
+bool sf_bootProfile_isReached(E_SF_BOOTPROFILE_PHASE_t phase);
+
+/*============================================================================*/
+/**
+ * \brief Check if the report is to be sent, i.e. the first uplink is done
+ *        and the report has not been delivered yet.
+ *
+ * \return True if the report is pending.
+ */
+/*============================================================================*/
+bool sf_bootProfile_isReportPending(void);
+
+/*============================================================================*/
+/**
+ * \brief Get the boot profile report once the first uplink is done.
+ *
+ *        boot count  |  reset source  |  phases  |  phases x time
+ *        ------------|----------------|----------|-------------------------
+ *           2byte    |     1byte      |  1byte   |  phases x 4byte in ms
+ *
+ *        A phase not reached has the time 0xFFFFFFFF.
+ *
+ * \param pBuf          Pointer to the report storage.
+ * \param maxLen        Size of the report storage.
+ *
+ * \return Length of the report, 0 if there is nothing to report.
+ */
+/*============================================================================*/
+uint8_t sf_bootProfile_getReport(uint8_t *pBuf, uint8_t maxLen);
+
+/*============================================================================*/
+/**
+ * \brief Mark the report as delivered.
+ */
+/*============================================================================*/
+void sf_bootProfile_setReported(void);
+
+/*============================================================================*/
+/**
+ * \brief TSCH callback called when the network has been joined.
+ */
+/*============================================================================*/
+void sf_bootProfile_joiningNetworkCallback(void);
+
+/*! @} */
+
+#endif /* __SF_BOOT_PROFILE_H__ */
+
+#ifdef __cplusplus
+}
+#endif
@@ -105,6 +105,8 @@ void sf_input_callback_handler(const void *data, uint16_t len,
       case E_FRAME_TYPE_REQUEST:
       case E_FRAME_TYPE_SUCCESSFUL:
       case E_FRAME_TYPE_RESPONSE:
+      case E_FRAME_TYPE_REQUEST_COMPACT:
+      case E_FRAME_TYPE_RESPONSE_COMPACT:
         sf_join_handleFrame((uint8_t*)data, len, (linkaddr_t *)src);
         break;
       case E_FRAME_TYPE_REMOTE:
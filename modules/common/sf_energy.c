@@ -0,0 +1,150 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Implementation of the energy accounting per subsystem.
+*/
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdint.h>
+#include <string.h>
+/* Stack include */
+#include "contiki.h"
+#include "sys/energest.h"
+#include "net/mac/tsch/tsch.h"
+/* Application include */
+#include "sf_energy.h"
+
+/*==============================================================================
+                            MACROS
+==============================================================================*/
+/* Length of the report header */
+#define SF_ENERGY_REPORT_HEADER_LEN      (5U)
+
+/*==============================================================================
+                            GLOBAL VARIABLES
+==============================================================================*/
+/* Energest type of each subsystem. */
+static const energest_type_t gEnergestType[E_SF_ENERGY_MAX] =
+{
+  ENERGEST_TYPE_CPU,
+  ENERGEST_TYPE_SF_ADC,
+  ENERGEST_TYPE_SF_RX_BEACON,
+  ENERGEST_TYPE_SF_RX_DOWNLINK,
+  ENERGEST_TYPE_TRANSMIT,
+  ENERGEST_TYPE_SF_FLASH
+};
+
+/*==============================================================================
+                         LOCAL FUNCTION DEFINITION
+==============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Convert an energest time to milliseconds.
+ *
+ * \param time    Energest time.
+ *
+ * \return Time in ms, wrapping around at 2^32.
+ */
+/*============================================================================*/
+static uint32_t loc_toMs(uint64_t time);
+
+/*==============================================================================
+                         LOCAL FUNCTION IMPLEMENTATION
+==============================================================================*/
+/*------------------------------------------------------------------------------
+  loc_toMs()
+------------------------------------------------------------------------------*/
+static uint32_t loc_toMs(uint64_t time)
+{
+  return (uint32_t)(time * 1000U / ENERGEST_SECOND);
+}/* loc_toMs() */
+
+/*==============================================================================
+                      API FUNCTION IMPLEMENTATION
+==============================================================================*/
+/*------------------------------------------------------------------------------
+  sf_energy_getReport()
+------------------------------------------------------------------------------*/
+uint8_t sf_energy_getReport(uint8_t *pBuf, uint8_t maxLen)
+{
+  /* Report length */
+  uint8_t len = 0;
+  /* Time in milliseconds */
+  uint32_t timeMs;
+  uint8_t i;
+
+  if((NULL == pBuf) ||
+     (maxLen < (SF_ENERGY_REPORT_HEADER_LEN + E_SF_ENERGY_MAX * sizeof(timeMs))))
+  {
+    return 0;
+  }
+
+  /* Add the time of the running intervals. The slot operation switches the
+     radio types, so it must not run meanwhile. Without the lock, the times
+     up to the last switch are reported. */
+  if(tsch_get_lock())
+  {
+    energest_flush();
+    tsch_release_lock();
+  }
+
+  timeMs = loc_toMs(ENERGEST_GET_TOTAL_TIME());
+  memcpy(pBuf + len, &timeMs, sizeof(timeMs));
+  len += sizeof(timeMs);
+  pBuf[len++] = E_SF_ENERGY_MAX;
+
+  for(i = 0; i < E_SF_ENERGY_MAX; i++)
+  {
+    timeMs = loc_toMs(energest_type_time(gEnergestType[i]));
+    memcpy(pBuf + len, &timeMs, sizeof(timeMs));
+    len += sizeof(timeMs);
+  }
+
+  return len;
+}/* sf_energy_getReport() */
+
+/*------------------------------------------------------------------------------
+  sf_energy_rxListenStartCallback()
+------------------------------------------------------------------------------*/
+void sf_energy_rxListenStartCallback(uint8_t linkType)
+{
+  if((LINK_TYPE_ADVERTISING == linkType) ||
+     (LINK_TYPE_ADVERTISING_ONLY == linkType))
+  {
+    ENERGEST_ON(ENERGEST_TYPE_SF_RX_BEACON);
+  }
+  else
+  {
+    ENERGEST_ON(ENERGEST_TYPE_SF_RX_DOWNLINK);
+  }
+}/* sf_energy_rxListenStartCallback() */
+
+/*------------------------------------------------------------------------------
+  sf_energy_rxListenEndCallback()
+------------------------------------------------------------------------------*/
+void sf_energy_rxListenEndCallback(void)
+{
+  /* Only the type turned on is counted. */
+  ENERGEST_OFF(ENERGEST_TYPE_SF_RX_BEACON);
+  ENERGEST_OFF(ENERGEST_TYPE_SF_RX_DOWNLINK);
+}/* sf_energy_rxListenEndCallback() */
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,121 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __SF_ENERGY_H__
+#define __SF_ENERGY_H__
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Energy accounting per subsystem.
+
+ @details The time each subsystem is active is taken by energest. Besides the
+          CPU and the radio Tx time counted by the platform, the ADC sampling,
+          the listening in beacon and in downlink Rx slots and the flash
+          program and erase operations have their own energest types, see
+          ENERGEST_CONF_ADDITIONS in the project configuration.
+          The totals since the reset are sent to the BMS-CC periodically in an
+          energy report frame. As the totals are cumulative, a lost report
+          does not lose any time; the BMS-CC converts the difference of two
+          reports to a charge with the currents of the hardware.
+*/
+
+/**
+ *  @addtogroup SF_ENERGY
+ *
+ *  @details
+ *
+ *  - <b>Energy API</b>\n
+ *    | API Function                              | Description                                     |
+ *    |-------------------------------------------|-------------------------------------------------|
+ *    | @ref sf_energy_getReport()                | @copybrief sf_energy_getReport()                |
+ *    | @ref sf_energy_rxListenStartCallback()    | @copybrief sf_energy_rxListenStartCallback()    |
+ *    | @ref sf_energy_rxListenEndCallback()      | @copybrief sf_energy_rxListenEndCallback()      |
+ *  @{
+ */
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdint.h>
+
+/*==============================================================================
+                            ENUMS
+==============================================================================*/
+/*! Subsystems of the energy report, in the order they are reported. */
+typedef enum
+{
+  /*! CPU active. */
+  E_SF_ENERGY_CPU,
+  /*! ADC sampling. */
+  E_SF_ENERGY_ADC,
+  /*! Radio listening in beacon slots and during the beacon scan. */
+  E_SF_ENERGY_RX_BEACON,
+  /*! Radio listening in downlink slots. */
+  E_SF_ENERGY_RX_DOWNLINK,
+  /*! Radio transmitting. */
+  E_SF_ENERGY_TX_DATA,
+  /*! Flash program and erase. */
+  E_SF_ENERGY_FLASH,
+  /*! Number of subsystems. */
+  E_SF_ENERGY_MAX
+} E_SF_ENERGY_t;
+
+/*==============================================================================
+                            FUNCTION PROTOTYPES
+==============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Get the energy report with the totals since the reset.
+ *
+ *        uptime  |  subsystems  |  subsystems x time
+ *        --------|--------------|------------------------------
+ *         4byte  |    1byte     |  subsystems x 4byte in ms
+ *
+ *        The uptime is in ms. The subsystems are ordered as
+ *        @ref E_SF_ENERGY_t. All times wrap around at 2^32 ms.
+ *
+ * \param pBuf          Pointer to the report storage.
+ * \param maxLen        Size of the report storage.
+ *
+ * \return Length of the report, 0 if the storage is too small.
+ */
+/*============================================================================*/
+uint8_t sf_energy_getReport(uint8_t *pBuf, uint8_t maxLen);
+
+/*============================================================================*/
+/**
+ * \brief TSCH callback called from the rtimer interrupt when the radio starts
+ *        listening in an Rx slot.
+ *
+ * \param linkType      Link type of the slot.
+ */
+/*============================================================================*/
+void sf_energy_rxListenStartCallback(uint8_t linkType);
+
+/*============================================================================*/
+/**
+ * \brief TSCH callback called from the rtimer interrupt when the radio stops
+ *        listening in an Rx slot.
+ */
+/*============================================================================*/
+void sf_energy_rxListenEndCallback(void);
+
+/*! @} */
+
+#endif /* __SF_ENERGY_H__ */
+
+#ifdef __cplusplus
+}
+#endif
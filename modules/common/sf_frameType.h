@@ -62,6 +62,48 @@ typedef enum
      Used for transmitting config/cmd
      to the endpoints. */
   E_FRAME_TYPE_REMOTE = 4,
+  /* Measurement frame type with
+     millisecond timestamp. Used for
+     transmitting measurement data. */
+  E_FRAME_TYPE_MEASUREMENT_HR = 5,
+  /* Compact join request frame type.
+    This frame is issued by a sensor
+    to join with the two-message handshake.*/
+  E_FRAME_TYPE_REQUEST_COMPACT = 6,
+  /* Compact join response frame type.
+    This frame is issued by a gateway to
+    assign the address and data slots. The
+    join completes with the first ACKed
+    data frame.*/
+  E_FRAME_TYPE_RESPONSE_COMPACT = 7,
+  /* Link quality report frame type.
+     Used for transmitting the link
+     quality cache as diagnostics. */
+  E_FRAME_TYPE_LINK_QUALITY = 8,
+  /* Measurement journal frame type.
+     Used for transmitting the current
+     measurement together with the ones
+     taken while disconnected. */
+  E_FRAME_TYPE_MEASUREMENT_JOURNAL = 9,
+  /* Boot profile frame type.
+     Used for transmitting the time of
+     the boot phases once after the
+     first measurement. */
+  E_FRAME_TYPE_BOOT_PROFILE = 10,
+  /* Energy report frame type.
+     Used for transmitting the time
+     spent per subsystem periodically. */
+  E_FRAME_TYPE_ENERGY = 11,
+  /* Slot statistics frame type.
+     Used for transmitting the slot
+     operation failure counters
+     periodically. */
+  E_FRAME_TYPE_SLOT_STATS = 12,
+  /* Memory report frame type.
+     Used for transmitting the stack
+     and buffer pool watermarks
+     periodically. */
+  E_FRAME_TYPE_MEMORY = 13,
   /* Invalid frame type. */
   E_FRAME_TYPE_UNDEFINED
 } E_FRAME_TYPE_t;
@@ -0,0 +1,128 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Implementation of the log2 histogram.
+*/
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdint.h>
+/* Application include */
+#include "sf_histogram.h"
+
+/*==============================================================================
+                      API FUNCTION IMPLEMENTATION
+==============================================================================*/
+/*------------------------------------------------------------------------------
+  sf_histogram_add()
+------------------------------------------------------------------------------*/
+void sf_histogram_add(sf_histogram_t *pHist, uint32_t value)
+{
+  uint8_t bin = sf_histogram_bin(value);
+
+  if((0U == pHist->count) || (value < pHist->min))
+  {
+    pHist->min = value;
+  }
+  if(value > pHist->max)
+  {
+    pHist->max = value;
+  }
+  pHist->count++;
+  pHist->sum += value;
+  if(UINT16_MAX > pHist->bins[bin])
+  {
+    pHist->bins[bin]++;
+  }
+}/* sf_histogram_add() */
+
+/*------------------------------------------------------------------------------
+  sf_histogram_addNegative()
+------------------------------------------------------------------------------*/
+void sf_histogram_addNegative(sf_histogram_t *pHist)
+{
+  pHist->negative++;
+}/* sf_histogram_addNegative() */
+
+/*------------------------------------------------------------------------------
+  sf_histogram_bin()
+------------------------------------------------------------------------------*/
+uint8_t sf_histogram_bin(uint32_t value)
+{
+  /* Bit length of the sample */
+  uint8_t bin = (0U == value) ? 0U : (uint8_t)(32 - __builtin_clz(value));
+
+  return (bin < SF_HISTOGRAM_BINS) ? bin : (uint8_t)(SF_HISTOGRAM_BINS - 1U);
+}/* sf_histogram_bin() */
+
+/*------------------------------------------------------------------------------
+  sf_histogram_mean()
+------------------------------------------------------------------------------*/
+uint32_t sf_histogram_mean(const sf_histogram_t *pHist)
+{
+  return (0U == pHist->count) ? 0U : (uint32_t)(pHist->sum / pHist->count);
+}/* sf_histogram_mean() */
+
+/*------------------------------------------------------------------------------
+  sf_histogram_percentile()
+------------------------------------------------------------------------------*/
+uint32_t sf_histogram_percentile(const sf_histogram_t *pHist, uint8_t percent)
+{
+  /* Samples in the bins, less than the count if a bin saturated */
+  uint32_t total = 0U;
+  uint32_t rank;
+  uint32_t value;
+  uint8_t bin;
+
+  for(bin = 0; bin < SF_HISTOGRAM_BINS; bin++)
+  {
+    total += pHist->bins[bin];
+  }
+  if(0U == total)
+  {
+    return 0U;
+  }
+
+  /* Rank of the percentile, counted from 1 */
+  rank = (uint32_t)(((uint64_t)total * percent + 99U) / 100U);
+  rank = (0U == rank) ? 1U : rank;
+  for(bin = 0; bin < SF_HISTOGRAM_BINS - 1U; bin++)
+  {
+    if(rank <= pHist->bins[bin])
+    {
+      break;
+    }
+    rank -= pHist->bins[bin];
+  }
+
+  /* Upper end of the bin, the last bin ends at the maximum */
+  value = (bin < SF_HISTOGRAM_BINS - 1U) ? ((1UL << bin) - 1U) : pHist->max;
+  if(value < pHist->min)
+  {
+    value = pHist->min;
+  }
+  if(value > pHist->max)
+  {
+    value = pHist->max;
+  }
+  return value;
+}/* sf_histogram_percentile() */
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,144 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __SF_HISTOGRAM_H__
+#define __SF_HISTOGRAM_H__
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Histogram of log2 bins with its statistics.
+
+ @details Bin 0 counts the samples of 0, bin n the samples in
+          [2^(n-1), 2^n) and the last bin all samples above. Besides the
+          bins, the number, the minimum, the maximum and the sum of the
+          samples are kept. Percentiles are estimated from the bins, as the
+          upper end of the bin they fall into, bounded by the minimum and
+          the maximum. An estimate is thus at most twice the true value.
+          Negative samples are only counted.
+          Adding a sample takes constant time, it may be done from an
+          interrupt.
+*/
+
+/**
+ *  @addtogroup SF_HISTOGRAM
+ *
+ *  @details
+ *
+ *  - <b>Histogram API</b>\n
+ *    | API Function                              | Description                                     |
+ *    |-------------------------------------------|-------------------------------------------------|
+ *    | @ref sf_histogram_add()                   | @copybrief sf_histogram_add()                   |
+ *    | @ref sf_histogram_addNegative()           | @copybrief sf_histogram_addNegative()           |
+ *    | @ref sf_histogram_bin()                   | @copybrief sf_histogram_bin()                   |
+ *    | @ref sf_histogram_mean()                  | @copybrief sf_histogram_mean()                  |
+ *    | @ref sf_histogram_percentile()            | @copybrief sf_histogram_percentile()            |
+ *  @{
+ */
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdint.h>
+
+/*==============================================================================
+                            MACROS
+==============================================================================*/
+/*! Number of bins. */
+#define SF_HISTOGRAM_BINS                (16U)
+
+/*==============================================================================
+                            STRUCTS
+==============================================================================*/
+/*! Histogram, all zero when empty. */
+typedef struct
+{
+  /* Number of samples */
+  uint32_t count;
+  /* Smallest sample */
+  uint32_t min;
+  /* Largest sample */
+  uint32_t max;
+  /* Sum of the samples */
+  uint64_t sum;
+  /* Number of negative samples, not part of the histogram */
+  uint32_t negative;
+  /* Number of samples per bin, saturating */
+  uint16_t bins[SF_HISTOGRAM_BINS];
+} sf_histogram_t;
+
+/*==============================================================================
+                            FUNCTION PROTOTYPES
+==============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Add a sample.
+ *
+ * \param pHist         Histogram.
+ * \param value         Sample.
+ */
+/*============================================================================*/
+void sf_histogram_add(sf_histogram_t *pHist, uint32_t value);
+
+/*============================================================================*/
+/**
+ * \brief Count a negative sample.
+ *
+ * \param pHist         Histogram.
+ */
+/*============================================================================*/
+void sf_histogram_addNegative(sf_histogram_t *pHist);
+
+/*============================================================================*/
+/**
+ * \brief Get the bin of a sample.
+ *
+ * \param value         Sample.
+ *
+ * \return Bin, the bit length of the sample up to the last bin.
+ */
+/*============================================================================*/
+uint8_t sf_histogram_bin(uint32_t value);
+
+/*============================================================================*/
+/**
+ * \brief Get the mean of the samples.
+ *
+ * \param pHist         Histogram.
+ *
+ * \return Mean rounded down, 0 if empty.
+ */
+/*============================================================================*/
+uint32_t sf_histogram_mean(const sf_histogram_t *pHist);
+
+/*============================================================================*/
+/**
+ * \brief Estimate a percentile of the samples.
+ *
+ * \param pHist         Histogram.
+ * \param percent       Percentile, 0 to 100.
+ *
+ * \return Upper end of the bin of the percentile, bounded by the minimum
+ *         and the maximum. 0 if empty.
+ */
+/*============================================================================*/
+uint32_t sf_histogram_percentile(const sf_histogram_t *pHist, uint8_t percent);
+
+/*! @} */
+
+#endif /* __SF_HISTOGRAM_H__ */
+
+#ifdef __cplusplus
+}
+#endif
@@ -16,8 +16,29 @@
 /*=============================================================================
                                 INCLUDES
 =============================================================================*/
+/* Stack includes */
+#include "contiki.h"
+#include "lib/ringbufindex.h"
+/* Project specific include */
 #include "sf_led.h"
 
+/*=============================================================================
+                                MACROS
+=============================================================================*/
+/* Size of the pattern ring. Must be a power of two. The ring holds one
+   pattern less than its size, i.e. 7 patterns by default. */
+#ifndef SF_CONF_LED_QUEUE_SIZE
+  #define SF_LED_QUEUE_SIZE              (8U)
+#else
+  #define SF_LED_QUEUE_SIZE              SF_CONF_LED_QUEUE_SIZE
+#endif
+#if (SF_LED_QUEUE_SIZE & (SF_LED_QUEUE_SIZE - 1)) != 0
+  #error "SF_LED_QUEUE_SIZE must be a power of two"
+#endif
+/* On and off time of a flash in milliseconds */
+#define SF_LED_FLASH_ON_TIME             (200U)
+#define SF_LED_FLASH_OFF_TIME            (800U)
+
 /*=============================================================================
                                 STRUCTS
 =============================================================================*/
@@ -35,6 +56,23 @@ typedef struct
   uint16_t offTicks;
 } sf_led_t;
 
+/* Queued LED pattern. */
+typedef struct
+{
+  /* LED identifier */
+  leds_num_t ledNum;
+  /* On period */
+  clock_time_t onTicks;
+  /* Off period */
+  clock_time_t offTicks;
+  /* Completion callback */
+  sf_led_callback_t callback;
+  /* Callback and event data */
+  void *ptr;
+  /* Process to be notified */
+  struct process *pProcess;
+} sf_led_pattern_t;
+
 /*=============================================================================
                             GLOBAL VARIABLES
 =============================================================================*/
@@ -42,6 +80,111 @@ typedef struct
 static sf_led_t gLedHandler;
 /* Storage of the data of LED blink timer*/
 static struct etimer gLedBlinkTimer;
+/* Index ring and storage of the queued patterns. The head is shown. */
+static struct ringbufindex gPatternRingbuf;
+static sf_led_pattern_t gPatternArray[SF_LED_QUEUE_SIZE];
+/* Timer of the pattern being shown */
+static struct ctimer gPatternTimer;
+/* Whether the pattern queue is initialized */
+static bool gPatternInit;
+/* Pattern completion event */
+process_event_t sf_led_event;
+
+/*=============================================================================
+                         LOCAL FUNCTION DEFINITION
+=============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Show the pattern at the head of the queue.
+ */
+/*============================================================================*/
+static void loc_patternStart(void);
+
+/*============================================================================*/
+/**
+ * \brief Timer callback at the end of the on period.
+ */
+/*============================================================================*/
+static void loc_patternOff(void *ptr);
+
+/*============================================================================*/
+/**
+ * \brief Timer callback at the end of the off period. Completes the pattern
+ *        and starts the next one.
+ */
+/*============================================================================*/
+static void loc_patternDone(void *ptr);
+
+/*=============================================================================
+                         LOCAL FUNCTION IMPLEMENTATION
+=============================================================================*/
+/*------------------------------------------------------------------------------
+  loc_patternStart()
+------------------------------------------------------------------------------*/
+static void loc_patternStart(void)
+{
+  /* Index of the pattern */
+  int idx = ringbufindex_peek_get(&gPatternRingbuf);
+
+  if(-1 == idx)
+  {
+    return;
+  }
+
+  leds_single_off(LEDS_CONF_RED);
+  leds_single_off(LEDS_CONF_GREEN);
+
+  sf_led_on(gPatternArray[idx].ledNum);
+  ctimer_set(&gPatternTimer, gPatternArray[idx].onTicks, loc_patternOff, NULL);
+}/* loc_patternStart() */
+
+/*------------------------------------------------------------------------------
+  loc_patternOff()
+------------------------------------------------------------------------------*/
+static void loc_patternOff(void *ptr)
+{
+  /* Index of the pattern */
+  int idx = ringbufindex_peek_get(&gPatternRingbuf);
+
+  if(-1 == idx)
+  {
+    return;
+  }
+
+  sf_led_off(gPatternArray[idx].ledNum);
+  ctimer_set(&gPatternTimer, gPatternArray[idx].offTicks, loc_patternDone, NULL);
+}/* loc_patternOff() */
+
+/*------------------------------------------------------------------------------
+  loc_patternDone()
+------------------------------------------------------------------------------*/
+static void loc_patternDone(void *ptr)
+{
+  /* Completed pattern */
+  sf_led_pattern_t pattern;
+  /* Index of the pattern */
+  int idx = ringbufindex_peek_get(&gPatternRingbuf);
+
+  if(-1 == idx)
+  {
+    return;
+  }
+
+  /* Release the entry first, the callback may queue the next pattern. */
+  pattern = gPatternArray[idx];
+  ringbufindex_get(&gPatternRingbuf);
+
+  loc_patternStart();
+
+  if(NULL != pattern.callback)
+  {
+    pattern.callback(pattern.ptr);
+  }
+  if(NULL != pattern.pProcess)
+  {
+    process_post(pattern.pProcess, sf_led_event, pattern.ptr);
+  }
+}/* loc_patternDone() */
 
 /*=============================================================================
                               PROCESSES
@@ -58,7 +201,8 @@ PROCESS_THREAD(led_process, ev, data)
 {
   PROCESS_BEGIN();
 
-  while(1)
+  /* Stopped in the off period, the LED is not switched on again. */
+  while(ev != PROCESS_EVENT_EXIT)
   {
     sf_led_on(gLedHandler.ledNum);
 
@@ -163,27 +307,63 @@ int sf_led_waitUntilOff( void )
 /*------------------------------------------------------------------------------
   sf_led_flash()
 ------------------------------------------------------------------------------*/
-void sf_led_flash(leds_num_t led)
+bool sf_led_flash(leds_num_t led)
 {
-  volatile uint32_t i;
-  uint32_t on  = 600000;
-  uint32_t off = 2500000;
+  return sf_led_queuePattern(led, SF_LED_FLASH_ON_TIME, SF_LED_FLASH_OFF_TIME,
+                             NULL, NULL);
+} /* sf_led_flash() */
 
-  // 3333333 => ~ 1 sec.
-  // 600000 => ~ 0.2 sec.
-  // 2500000 => ~ 0.8 sec.
+/*------------------------------------------------------------------------------
+  sf_led_queuePattern()
+------------------------------------------------------------------------------*/
+bool sf_led_queuePattern(leds_num_t led, uint16_t onTime, uint16_t offTime,
+                         sf_led_callback_t callback, void *ptr)
+{
+  /* Index of the free entry */
+  int idx;
+  /* Whether the queue was empty */
+  bool idle;
 
-  leds_single_off(LEDS_CONF_RED);
-  leds_single_off(LEDS_CONF_GREEN);
+  if(!gPatternInit)
+  {
+    ringbufindex_init(&gPatternRingbuf, SF_LED_QUEUE_SIZE);
+    sf_led_event = process_alloc_event();
+    gPatternInit = true;
+  }
 
-  sf_led_on(led);
-  for(i = 0; i < on; ++i) {
-    __asm__ __volatile__ ("nop");
+  idle = (0 == ringbufindex_elements(&gPatternRingbuf));
+
+  idx = ringbufindex_peek_put(&gPatternRingbuf);
+  if(-1 == idx)
+  {
+    return false;
   }
 
-  sf_led_off(led);
-  for(i = 0; i < off; ++i) {
-    __asm__ __volatile__ ("nop");
+  gPatternArray[idx].ledNum = led;
+  gPatternArray[idx].onTicks = (clock_time_t)CLOCK_SECOND * onTime / 1000;
+  gPatternArray[idx].offTicks = (clock_time_t)CLOCK_SECOND * offTime / 1000;
+  gPatternArray[idx].callback = callback;
+  gPatternArray[idx].ptr = ptr;
+  gPatternArray[idx].pProcess = PROCESS_CURRENT();
+  ringbufindex_put(&gPatternRingbuf);
+
+  if(idle)
+  {
+    /* The pattern takes over the LEDs from a blinking. */
+    if(process_is_running(&led_process))
+    {
+      sf_led_stopBlink();
+    }
+    loc_patternStart();
   }
-} /* sf_led_flash() */
 
+  return true;
+} /* sf_led_queuePattern() */
+
+/*------------------------------------------------------------------------------
+  sf_led_isBusy()
+------------------------------------------------------------------------------*/
+bool sf_led_isBusy(void)
+{
+  return gPatternInit && (0 != ringbufindex_elements(&gPatternRingbuf));
+} /* sf_led_isBusy() */
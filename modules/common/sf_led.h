@@ -35,6 +35,8 @@ extern "C" {
  *    | @ref sf_led_onDuration()                  | @copybrief sf_led_onDuration()                  |
  *    | @ref sf_led_waitUntilOff()                | @copybrief sf_led_waitUntilOff()                |
  *    | @ref sf_led_flash()                       | @copybrief sf_led_flash()                       |
+ *    | @ref sf_led_queuePattern()                | @copybrief sf_led_queuePattern()                |
+ *    | @ref sf_led_isBusy()                      | @copybrief sf_led_isBusy()                      |
  *  @{
  */
 
@@ -45,8 +47,23 @@ extern "C" {
 #include <stdint.h>
 #include <stdbool.h>
 /* Stack includes */
+#include "contiki.h"
 #include "dev/leds.h"
 
+/*=============================================================================
+                                TYPES
+=============================================================================*/
+/*! Called when a queued pattern has completed.
+    The pointer given to @ref sf_led_queuePattern is passed. */
+typedef void (*sf_led_callback_t)(void *ptr);
+
+/*=============================================================================
+                                GLOBAL VARIABLES
+=============================================================================*/
+/*! Event posted to the process which queued a pattern once the pattern has
+    completed. The data is the pointer given to @ref sf_led_queuePattern. */
+extern process_event_t sf_led_event;
+
 /*=============================================================================
                                 API FUNCTIONS
 =============================================================================*/
@@ -109,10 +126,44 @@ int sf_led_waitUntilOff(void);
 
 /*============================================================================*/
 /**
- * \brief Flash the given LED.
+ * \brief Flash the given LED. The LED is on for 200 ms and stays off for
+ *        800 ms before the next pattern starts. The call does not block,
+ *        @ref sf_led_event is posted to the calling process on completion.
+ *
+ * \param led           LED ID
+ *
+ * \return True if the flash has been queued.
+ */
+/*============================================================================*/
+bool sf_led_flash(leds_num_t led);
+
+/*============================================================================*/
+/**
+ * \brief Queue an LED pattern. The patterns are shown one after another
+ *        without blocking. Both LEDs are switched off when a pattern starts.
+ *        On completion the callback is called and @ref sf_led_event is posted
+ *        to the calling process.
+ *
+ * \param led           LED ID
+ * \param onTime        On time in milliseconds
+ * \param offTime       Off time in milliseconds
+ * \param callback      Completion callback, may be NULL.
+ * \param ptr           Pointer passed to the callback and with the event.
+ *
+ * \return True if the pattern has been queued, false if the queue is full.
+ */
+/*============================================================================*/
+bool sf_led_queuePattern(leds_num_t led, uint16_t onTime, uint16_t offTime,
+                         sf_led_callback_t callback, void *ptr);
+
+/*============================================================================*/
+/**
+ * \brief Check if queued patterns are pending.
+ *
+ * \return True while a pattern is shown or queued.
  */
 /*============================================================================*/
-void sf_led_flash(leds_num_t led);
+bool sf_led_isBusy(void);
 
 /*! @} */
 
@@ -0,0 +1,252 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Implementation of the stack and buffer pool monitor.
+*/
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdint.h>
+#include <string.h>
+/* Stack include */
+#include "contiki.h"
+#include "sys/stack-check.h"
+#include "net/queuebuf.h"
+#include "net/mac/tsch/tsch.h"
+/* Application include */
+#include "sf_memMonitor.h"
+
+/* Log configuration */
+#include "sys/log.h"
+
+/*==============================================================================
+                            MACROS
+==============================================================================*/
+#define LOG_MODULE "Memory"
+/* Defines log level*/
+#ifndef LOG_CONF_APP
+  #define LOG_LEVEL     LOG_LEVEL_NONE
+#else
+  #define LOG_LEVEL     LOG_CONF_APP
+#endif
+/* Interval of the sampling. */
+#ifndef SF_CONF_MEMMONITOR_INTERVAL
+  #define SF_MEMMONITOR_INTERVAL         (10U * CLOCK_SECOND)
+#else
+  #define SF_MEMMONITOR_INTERVAL         SF_CONF_MEMMONITOR_INTERVAL
+#endif
+/* Minimum free stack in bytes. */
+#ifndef SF_CONF_MEMMONITOR_STACK_MARGIN
+  #define SF_MEMMONITOR_STACK_MARGIN     (256)
+#else
+  #define SF_MEMMONITOR_STACK_MARGIN     SF_CONF_MEMMONITOR_STACK_MARGIN
+#endif
+/* Minimum number of free queue buffers. */
+#ifndef SF_CONF_MEMMONITOR_QUEUEBUF_MARGIN
+  #define SF_MEMMONITOR_QUEUEBUF_MARGIN  (1)
+#else
+  #define SF_MEMMONITOR_QUEUEBUF_MARGIN  SF_CONF_MEMMONITOR_QUEUEBUF_MARGIN
+#endif
+/* Length of the report */
+#define SF_MEMMONITOR_REPORT_LEN         (9U)
+
+#ifdef SF_CONF_MEMMONITOR_FAULT_HANDLER
+/* Called once per fault, given the E_SF_MEMMONITOR_FAULT_t flag. */
+void SF_CONF_MEMMONITOR_FAULT_HANDLER(uint8_t fault);
+#endif
+
+/*==============================================================================
+                            GLOBAL VARIABLES
+==============================================================================*/
+/* Highest stack use in bytes. */
+static int32_t gStackPeak;
+/* Highest number of used queue buffers. */
+static uint8_t gQueuebufPeak;
+/* Highest number of queued TSCH packets. */
+static uint8_t gTschPacketPeak;
+/* Latched faults, see E_SF_MEMMONITOR_FAULT_t. */
+static uint8_t gFaults;
+
+PROCESS(sf_memMonitor_process, "Memory monitor process");
+
+/*==============================================================================
+                         LOCAL FUNCTION DEFINITION
+==============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Sample the memory use and update the watermarks.
+ */
+/*============================================================================*/
+static void loc_sample(void);
+
+/*============================================================================*/
+/**
+ * \brief Latch a fault and call the fault handler the first time.
+ *
+ * \param fault         @ref E_SF_MEMMONITOR_FAULT_t
+ */
+/*============================================================================*/
+static void loc_setFault(E_SF_MEMMONITOR_FAULT_t fault);
+
+/*==============================================================================
+                         LOCAL FUNCTION IMPLEMENTATION
+==============================================================================*/
+/*------------------------------------------------------------------------------
+  loc_sample()
+------------------------------------------------------------------------------*/
+static void loc_sample(void)
+{
+  /* Number of used entries */
+  int used;
+#if STACK_CHECK_ENABLED
+  /* Stack use in bytes */
+  int32_t stackUsage = stack_check_get_usage();
+  int32_t stackSize = stack_check_get_reserved_size();
+
+  if(stackUsage < 0)
+  {
+    /* The whole stack area was overwritten. */
+    stackUsage = stackSize;
+    loc_setFault(E_SF_MEMMONITOR_FAULT_STACK_OVERFLOW);
+  }
+  if(stackUsage > gStackPeak)
+  {
+    gStackPeak = stackUsage;
+  }
+  if((stackSize - gStackPeak) < SF_MEMMONITOR_STACK_MARGIN)
+  {
+    loc_setFault(E_SF_MEMMONITOR_FAULT_STACK);
+  }
+#endif
+
+#if QUEUEBUF_CONF_STATS
+  /* Watermark kept by the queue buffer allocation. */
+  used = queuebuf_max_len;
+#else
+  used = QUEUEBUF_NUM - queuebuf_numfree();
+#endif
+  if(used > gQueuebufPeak)
+  {
+    gQueuebufPeak = (uint8_t)used;
+  }
+  if((QUEUEBUF_NUM - gQueuebufPeak) < SF_MEMMONITOR_QUEUEBUF_MARGIN)
+  {
+    loc_setFault(E_SF_MEMMONITOR_FAULT_QUEUEBUF);
+  }
+
+  /* Watermark kept by the TSCH queue. */
+  used = tsch_queue_global_packet_peak();
+  if(used > gTschPacketPeak)
+  {
+    gTschPacketPeak = (uint8_t)used;
+  }
+}/* loc_sample() */
+
+/*------------------------------------------------------------------------------
+  loc_setFault()
+------------------------------------------------------------------------------*/
+static void loc_setFault(E_SF_MEMMONITOR_FAULT_t fault)
+{
+  if(0U == (gFaults & fault))
+  {
+    gFaults |= fault;
+    LOG_ERR("!Memory fault 0x%02x, stack peak %ld, queuebuf peak %u\n",
+            fault, (long)gStackPeak, gQueuebufPeak);
+#ifdef SF_CONF_MEMMONITOR_FAULT_HANDLER
+    SF_CONF_MEMMONITOR_FAULT_HANDLER((uint8_t)fault);
+#endif
+  }
+}/* loc_setFault() */
+
+/*------------------------------------------------------------------------------
+  sf_memMonitor_process()
+------------------------------------------------------------------------------*/
+PROCESS_THREAD(sf_memMonitor_process, ev, data)
+{
+  static struct etimer sampleTimer;
+
+  PROCESS_BEGIN();
+
+  etimer_set(&sampleTimer, SF_MEMMONITOR_INTERVAL);
+
+  while(1)
+  {
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&sampleTimer));
+    etimer_reset(&sampleTimer);
+
+    loc_sample();
+  }
+
+  PROCESS_END();
+}/* sf_memMonitor_process() */
+
+/*==============================================================================
+                      API FUNCTION IMPLEMENTATION
+==============================================================================*/
+/*------------------------------------------------------------------------------
+  sf_memMonitor_init()
+------------------------------------------------------------------------------*/
+void sf_memMonitor_init(void)
+{
+  if(!process_is_running(&sf_memMonitor_process))
+  {
+    process_start(&sf_memMonitor_process, NULL);
+  }
+}/* sf_memMonitor_init() */
+
+/*------------------------------------------------------------------------------
+  sf_memMonitor_getReport()
+------------------------------------------------------------------------------*/
+uint8_t sf_memMonitor_getReport(uint8_t *pBuf, uint8_t maxLen)
+{
+  /* Report length */
+  uint8_t len = 0;
+  /* Stack values in bytes */
+  uint16_t stack;
+
+  if((NULL == pBuf) || (maxLen < SF_MEMMONITOR_REPORT_LEN))
+  {
+    return 0;
+  }
+
+  loc_sample();
+
+#if STACK_CHECK_ENABLED
+  stack = (uint16_t)stack_check_get_reserved_size();
+#else
+  stack = 0;
+#endif
+  memcpy(pBuf + len, &stack, sizeof(stack));
+  len += sizeof(stack);
+  stack = (uint16_t)gStackPeak;
+  memcpy(pBuf + len, &stack, sizeof(stack));
+  len += sizeof(stack);
+
+  pBuf[len++] = QUEUEBUF_NUM;
+  pBuf[len++] = gQueuebufPeak;
+  /* The TSCH packets are allocated per queue buffer. */
+  pBuf[len++] = QUEUEBUF_NUM;
+  pBuf[len++] = gTschPacketPeak;
+  pBuf[len++] = gFaults;
+
+  return len;
+}/* sf_memMonitor_getReport() */
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,108 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __SF_MEM_MONITOR_H__
+#define __SF_MEM_MONITOR_H__
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Monitor of the stack and the buffer pools.
+
+ @details The processes are protothreads and the interrupts run on the main
+          stack, so a single stack serves all of them. Its high watermark is
+          taken from the fill pattern written by the stack checker at boot.
+          Besides, the peak use of the queue buffers and of the TSCH packets
+          is read from the watermarks kept at their allocation. Without
+          QUEUEBUF_CONF_STATS the queue buffer use is sampled periodically
+          and short peaks are missed.
+          When the free stack or the free queue buffers fall below their
+          margins, a fault flag is latched and, if configured, the fault
+          handler SF_CONF_MEMMONITOR_FAULT_HANDLER is called once per fault.
+          The watermarks since the reset and the fault flags are sent to the
+          BMS-CC periodically in a memory report frame.
+*/
+
+/**
+ *  @addtogroup SF_MEM_MONITOR
+ *
+ *  @details
+ *
+ *  - <b>Memory monitor API</b>\n
+ *    | API Function                              | Description                                     |
+ *    |-------------------------------------------|-------------------------------------------------|
+ *    | @ref sf_memMonitor_init()                 | @copybrief sf_memMonitor_init()                 |
+ *    | @ref sf_memMonitor_getReport()            | @copybrief sf_memMonitor_getReport()            |
+ *  @{
+ */
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdint.h>
+
+/*==============================================================================
+                            ENUMS
+==============================================================================*/
+/*! Fault flags of the memory report. */
+typedef enum
+{
+  /*! The free stack fell below its margin. */
+  E_SF_MEMMONITOR_FAULT_STACK = 0x01,
+  /*! The fill pattern is gone, the stack overflowed. */
+  E_SF_MEMMONITOR_FAULT_STACK_OVERFLOW = 0x02,
+  /*! The free queue buffers fell below their margin. */
+  E_SF_MEMMONITOR_FAULT_QUEUEBUF = 0x04
+} E_SF_MEMMONITOR_FAULT_t;
+
+/*==============================================================================
+                            FUNCTION PROTOTYPES
+==============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Start the periodic sampling of the memory use.
+ */
+/*============================================================================*/
+void sf_memMonitor_init(void);
+
+/*============================================================================*/
+/**
+ * \brief Get the memory report with the watermarks since the reset.
+ *
+ *        stack size  |  stack peak  |  queuebufs  |  queuebuf peak
+ *        ------------|--------------|-------------|---------------
+ *           2byte    |    2byte     |    1byte    |     1byte
+ *
+ *        TSCH packets  |  TSCH packet peak  |  faults
+ *        --------------|--------------------|--------
+ *            1byte     |       1byte        |  1byte
+ *
+ *        The stack values are in bytes, 0 if the stack checker is disabled.
+ *        The faults are a bitmap of @ref E_SF_MEMMONITOR_FAULT_t.
+ *
+ * \param pBuf          Pointer to the report storage.
+ * \param maxLen        Size of the report storage.
+ *
+ * \return Length of the report, 0 if the storage is too small.
+ */
+/*============================================================================*/
+uint8_t sf_memMonitor_getReport(uint8_t *pBuf, uint8_t maxLen);
+
+/*! @} */
+
+#endif /* __SF_MEM_MONITOR_H__ */
+
+#ifdef __cplusplus
+}
+#endif
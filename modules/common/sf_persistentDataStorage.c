@@ -18,6 +18,8 @@
 ==============================================================================*/
 /* Standard library. */
 #include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
 /* SDK includes */
 #if !CONTIKI_TARGET_COOJA
 #include <ti/devices/DeviceFamily.h>
@@ -29,31 +31,115 @@
 /* Module specific include. */
 #include "sf_persistentDataStorage.h"
 #include "contiki-crc16.h"
+#include "sys/energest.h"
 
 /*==============================================================================
                           MACROS
 ==============================================================================*/
-/* The size of flash page in bytes */
-#define SF_PERSISTENTDATASTORAGE_PAGE_SIZE          0x2000
-/* The flash size */
-#ifndef SF_PERSISTENTDATASTORAGE_CONF_FLASH_SIZE
-#define SF_PERSISTENTDATASTORAGE_FLASH_SIZE         0x58000
-#else
-#define SF_PERSISTENTDATASTORAGE_FLASH_SIZE         SF_PERSISTENTDATASTORAGE_CONF_FLASH_SIZE
-#endif
 /* Configuration storage base address.
    The last page of the flash is reserved for the CCFG configurations.
    The device configurations are stored in one page before the last */
 #define SF_PERSISTENTDATASTORAGE_CONFIG_BASEADDR    SF_PERSISTENTDATASTORAGE_FLASH_SIZE -\
                                                     2 * SF_PERSISTENTDATASTORAGE_PAGE_SIZE
+/* Second configuration page. The configuration is appended as a log of
+   records to the two pages in turn. A page is only erased when the other
+   one is full, so the newest record always survives a power loss. */
+#define SF_PERSISTENTDATASTORAGE_CONFIG_BASEADDR2   SF_PERSISTENTDATASTORAGE_FLASH_SIZE -\
+                                                    5 * SF_PERSISTENTDATASTORAGE_PAGE_SIZE
+/* Number of configuration pages */
+#define SF_PERSISTENTDATASTORAGE_CONFIG_PAGES       2
+/* Configuration log record flag of firmware versions with a fixed
+   configuration structure */
+#define SF_PERSISTENTDATASTORAGE_CONFIG_LOG_FLAG    0xB2
+/* Number of configuration records per page */
+#define SF_PERSISTENTDATASTORAGE_CONFIG_RECORDS     (SF_PERSISTENTDATASTORAGE_PAGE_SIZE /\
+                                                    sizeof(sf_persistent_configRecord_t))
+/* TLV configuration log record flag. A page holds either records with a
+   fixed configuration structure or TLV records, the first byte of the page
+   tells which. */
+#define SF_PERSISTENTDATASTORAGE_CONFIG_TLV_FLAG    0xB3
+/* Number of TLV configuration records per page */
+#define SF_PERSISTENTDATASTORAGE_CONFIG_TLV_RECORDS (SF_PERSISTENTDATASTORAGE_PAGE_SIZE /\
+                                                    sizeof(sf_persistent_configTlvRecord_t))
 /* Device configuration flag */
-#define SF_PERSISTENTDATASTORAGE_CONFIG_FLAG        0xB0
+#define SF_PERSISTENTDATASTORAGE_CONFIG_FLAG        0xB1
+/* Device configuration flag of firmware versions without channel offset.
+   Such a configuration ends after the device address followed by the CRC. */
+#define SF_PERSISTENTDATASTORAGE_CONFIG_FLAG_V1     0xB0
+/* Length of the CRC protected data of a configuration without channel offset */
+#define SF_PERSISTENTDATASTORAGE_CONFIG_V1_LEN      offsetof(sf_persistent_deviceConfig_t,\
+                                                             channelOffset)
+/* Drift model storage base address. The drift model is checkpointed more
+   often than the configuration, so it uses the page before the configuration
+   page as an append-only log of records. The page is only erased when full. */
+#define SF_PERSISTENTDATASTORAGE_DRIFT_BASEADDR     SF_PERSISTENTDATASTORAGE_FLASH_SIZE -\
+                                                    3 * SF_PERSISTENTDATASTORAGE_PAGE_SIZE
+/* Drift model record flag */
+#define SF_PERSISTENTDATASTORAGE_DRIFT_FLAG         0xD1
+/* Sync context storage base address. The sync context is appended on each
+   association, it uses its own page below the drift model log. */
+#define SF_PERSISTENTDATASTORAGE_SYNC_BASEADDR      SF_PERSISTENTDATASTORAGE_FLASH_SIZE -\
+                                                    4 * SF_PERSISTENTDATASTORAGE_PAGE_SIZE
+/* Sync context record flag */
+#define SF_PERSISTENTDATASTORAGE_SYNC_FLAG          0xC1
+/* Maximum length of a log record */
+#define SF_PERSISTENTDATASTORAGE_RECORD_MAX_LEN     32
+/* Value of an erased flash byte */
+#define SF_PERSISTENTDATASTORAGE_ERASED             0xFF
+
+/*==============================================================================
+                          STRUCTS
+==============================================================================*/
+/*! Record of the configuration log. */
+PACKED_STRUCT(typedef struct
+{
+  uint8_t flag;
+  /* Reserved, keeps the sequence number aligned. */
+  uint8_t reserved;
+  /* Sequence number, incremented with every record. */
+  uint16_t seq;
+  /* Device configuration */
+  sf_persistent_deviceConfig_t config;
+  /* The calculated CRC. */
+  uint16_t crc;
+}, sf_persistent_configRecord_t);
+
+/*! Record of the TLV configuration log. */
+PACKED_STRUCT(typedef struct
+{
+  uint8_t flag;
+  /* Version of the TLV encoding. */
+  uint8_t version;
+  /* Sequence number, incremented with every record. */
+  uint16_t seq;
+  /* Length of the TLV data. */
+  uint8_t len;
+  /* Reserved, keeps the record 4 byte aligned. */
+  uint8_t reserved;
+  /* TLV data, unused bytes are left erased. */
+  uint8_t data[SF_PERSISTENTDATASTORAGE_CONFIG_TLV_MAX_LEN];
+  /* The calculated CRC. */
+  uint16_t crc;
+}, sf_persistent_configTlvRecord_t);
 
 /*==============================================================================
                           GLOBAL PARAMS
 ==============================================================================*/
 /* Device life time life time configuration address. */
 static const uint32_t gDeviceConfigAddress = (uint32_t)SF_PERSISTENTDATASTORAGE_CONFIG_BASEADDR;
+#if !CONTIKI_TARGET_COOJA
+/* Configuration log pages. The first one holds the configuration of
+   previous firmware versions at its start. */
+static const uint32_t gConfigPageAddress[SF_PERSISTENTDATASTORAGE_CONFIG_PAGES] =
+{
+  (uint32_t)SF_PERSISTENTDATASTORAGE_CONFIG_BASEADDR,
+  (uint32_t)SF_PERSISTENTDATASTORAGE_CONFIG_BASEADDR2
+};
+#endif
+/* Drift model log address. */
+static const uint32_t gDriftModelAddress = (uint32_t)SF_PERSISTENTDATASTORAGE_DRIFT_BASEADDR;
+/* Sync context log address. */
+static const uint32_t gSyncContextAddress = (uint32_t)SF_PERSISTENTDATASTORAGE_SYNC_BASEADDR;
 
 /*==============================================================================
                       LOCAL FUNCTION
@@ -71,16 +157,39 @@ E_SF_RETURN_t loc_writeFlash(uint32_t address, uint8_t *pData, uint32_t datalen)
 
   writeStatus = E_SF_SUCCESS;
 #else
+  ENERGEST_ON(ENERGEST_TYPE_SF_FLASH);
   /* Write into the flash. */
   if(FLASH_SUCCESS == writeFlash(address, pData, datalen))
   {
     writeStatus = E_SF_SUCCESS;
   }
+  ENERGEST_OFF(ENERGEST_TYPE_SF_FLASH);
 #endif
 
   return writeStatus;
 }/* loc_writeFlash */
 
+#if !CONTIKI_TARGET_COOJA
+/*----------------------------------------------------------------------------*/
+/*! loc_eraseFlash */
+/*----------------------------------------------------------------------------*/
+static E_SF_RETURN_t loc_eraseFlash(uint32_t pageAddress)
+{
+  /* Return value. */
+  E_SF_RETURN_t eraseStatus = E_SF_ERROR;
+
+  ENERGEST_ON(ENERGEST_TYPE_SF_FLASH);
+  if(FLASH_SUCCESS == eraseFlashPg(pageAddress /
+                                   SF_PERSISTENTDATASTORAGE_PAGE_SIZE))
+  {
+    eraseStatus = E_SF_SUCCESS;
+  }
+  ENERGEST_OFF(ENERGEST_TYPE_SF_FLASH);
+
+  return eraseStatus;
+}/* loc_eraseFlash */
+#endif /* !CONTIKI_TARGET_COOJA */
+
 /*----------------------------------------------------------------------------*/
 /*! loc_readFlash */
 /*----------------------------------------------------------------------------*/
@@ -104,40 +213,416 @@ E_SF_RETURN_t loc_readFlash(uint32_t address, uint8_t *pData, uint32_t datalen)
   return readStatus;
 }/* loc_readFlash */
 
+/*----------------------------------------------------------------------------*/
+/*! loc_appendRecord */
+/*----------------------------------------------------------------------------*/
+static E_SF_RETURN_t loc_appendRecord(uint32_t pageAddress, uint8_t flag,
+                                      uint8_t *pRecord, uint16_t recordLen)
+{
+  /* CRC of the record. */
+  uint16_t crc;
+
+  /* The record starts with the flag and ends with the CRC. */
+  pRecord[0] = flag;
+  crc = crc16_data(pRecord, recordLen - sizeof(uint16_t), 0);
+  memcpy(pRecord + recordLen - sizeof(uint16_t), &crc, sizeof(crc));
+
+#if !CONTIKI_TARGET_COOJA
+  /* Flag of the record being checked. */
+  uint8_t recordFlag;
+  /* Index of the first free record. */
+  uint16_t idx;
+
+  for(idx = 0; idx < SF_PERSISTENTDATASTORAGE_PAGE_SIZE / recordLen; idx++)
+  {
+    if((E_SF_SUCCESS != loc_readFlash(pageAddress + idx * recordLen,
+                                      &recordFlag, 1)) ||
+       (SF_PERSISTENTDATASTORAGE_ERASED == recordFlag))
+    {
+      break;
+    }
+  }
+
+  if(SF_PERSISTENTDATASTORAGE_PAGE_SIZE / recordLen == idx)
+  {
+    /* Page is full, start over. */
+    if(E_SF_SUCCESS != loc_eraseFlash(pageAddress))
+    {
+      return E_SF_ERROR;
+    }
+    idx = 0;
+  }
+
+  return loc_writeFlash(pageAddress + idx * recordLen, pRecord, recordLen);
+#else
+  /* The EEPROM of the simulation only holds the device configuration. */
+  return E_SF_ERROR;
+#endif
+}/* loc_appendRecord */
+
+/*----------------------------------------------------------------------------*/
+/*! loc_readNewestRecord */
+/*----------------------------------------------------------------------------*/
+static E_SF_RETURN_t loc_readNewestRecord(uint32_t pageAddress, uint8_t flag,
+                                          uint8_t *pRecord, uint16_t recordLen)
+{
+#if !CONTIKI_TARGET_COOJA
+  /* Return value. */
+  E_SF_RETURN_t readStatus = E_SF_ERROR;
+  /* Record being checked. */
+  uint8_t record[SF_PERSISTENTDATASTORAGE_RECORD_MAX_LEN];
+  /* Stored CRC of the record being checked. */
+  uint16_t crc;
+  /* Index of the record being checked. */
+  uint16_t idx;
+
+  if(recordLen > sizeof(record))
+  {
+    return E_SF_ERROR_INVALID_PARAM;
+  }
+
+  /* The newest valid record is the last one written. */
+  for(idx = 0; idx < SF_PERSISTENTDATASTORAGE_PAGE_SIZE / recordLen; idx++)
+  {
+    if((E_SF_SUCCESS != loc_readFlash(pageAddress + idx * recordLen,
+                                      record, recordLen)) ||
+       (SF_PERSISTENTDATASTORAGE_ERASED == record[0]))
+    {
+      break;
+    }
+
+    memcpy(&crc, record + recordLen - sizeof(uint16_t), sizeof(crc));
+    if((flag == record[0]) &&
+       (crc == crc16_data(record, recordLen - sizeof(uint16_t), 0)))
+    {
+      memcpy(pRecord, record, recordLen);
+      readStatus = E_SF_SUCCESS;
+    }
+  }
+
+  return readStatus;
+#else
+  return E_SF_ERROR;
+#endif
+}/* loc_readNewestRecord */
+
+#if !CONTIKI_TARGET_COOJA
+/*----------------------------------------------------------------------------*/
+/*! loc_isConfigTlvPage */
+/*----------------------------------------------------------------------------*/
+static bool loc_isConfigTlvPage(uint8_t page)
+{
+  /* Flag of the first record of the page. */
+  uint8_t flag;
+
+  return (E_SF_SUCCESS == loc_readFlash(gConfigPageAddress[page], &flag, 1)) &&
+         (SF_PERSISTENTDATASTORAGE_CONFIG_TLV_FLAG == flag);
+}/* loc_isConfigTlvPage */
+
+/*----------------------------------------------------------------------------*/
+/*! loc_readConfigRecord */
+/*----------------------------------------------------------------------------*/
+static E_SF_RETURN_t loc_readConfigRecord(uint8_t page, uint16_t idx,
+                                          sf_persistent_configRecord_t *pRecord)
+{
+  if(E_SF_SUCCESS != loc_readFlash(gConfigPageAddress[page] +
+                                   idx * sizeof(sf_persistent_configRecord_t),
+                                   (uint8_t*)pRecord,
+                                   sizeof(sf_persistent_configRecord_t)))
+  {
+    return E_SF_ERROR;
+  }
+
+  /* A record cut by a power loss fails the CRC check. */
+  if((SF_PERSISTENTDATASTORAGE_CONFIG_LOG_FLAG != pRecord->flag) ||
+     (pRecord->crc != crc16_data((uint8_t*)pRecord,
+                                 sizeof(sf_persistent_configRecord_t) -
+                                 sizeof(uint16_t), 0)))
+  {
+    return E_SF_ERROR;
+  }
+
+  return E_SF_SUCCESS;
+}/* loc_readConfigRecord */
+
+/*----------------------------------------------------------------------------*/
+/*! loc_findNewestConfigRecord */
+/*----------------------------------------------------------------------------*/
+static E_SF_RETURN_t loc_findNewestConfigRecord(sf_persistent_configRecord_t *pRecord,
+                                                uint8_t *pPage)
+{
+  /* Return value. */
+  E_SF_RETURN_t findStatus = E_SF_ERROR;
+  /* Record being checked. */
+  sf_persistent_configRecord_t record;
+  /* Page and index of the record being checked. */
+  uint8_t page;
+  uint16_t idx;
+
+  for(page = 0; page < SF_PERSISTENTDATASTORAGE_CONFIG_PAGES; page++)
+  {
+    if(loc_isConfigTlvPage(page))
+    {
+      continue;
+    }
+
+    for(idx = 0; idx < SF_PERSISTENTDATASTORAGE_CONFIG_RECORDS; idx++)
+    {
+      if(E_SF_SUCCESS != loc_readConfigRecord(page, idx, &record))
+      {
+        /* Erased, cut or a configuration of a previous firmware. */
+        continue;
+      }
+
+      /* The sequence number wraps around. */
+      if((E_SF_SUCCESS != findStatus) ||
+         ((int16_t)(record.seq - pRecord->seq) > 0))
+      {
+        memcpy(pRecord, &record, sizeof(record));
+        *pPage = page;
+        findStatus = E_SF_SUCCESS;
+      }
+    }
+  }
+
+  return findStatus;
+}/* loc_findNewestConfigRecord */
+
+/*----------------------------------------------------------------------------*/
+/*! loc_readConfigTlvRecord */
+/*----------------------------------------------------------------------------*/
+static E_SF_RETURN_t loc_readConfigTlvRecord(uint8_t page, uint16_t idx,
+                                             sf_persistent_configTlvRecord_t *pRecord)
+{
+  if(E_SF_SUCCESS != loc_readFlash(gConfigPageAddress[page] +
+                                   idx * sizeof(sf_persistent_configTlvRecord_t),
+                                   (uint8_t*)pRecord,
+                                   sizeof(sf_persistent_configTlvRecord_t)))
+  {
+    return E_SF_ERROR;
+  }
+
+  /* A record cut by a power loss fails the CRC check. */
+  if((SF_PERSISTENTDATASTORAGE_CONFIG_TLV_FLAG != pRecord->flag) ||
+     (SF_PERSISTENTDATASTORAGE_CONFIG_TLV_MAX_LEN < pRecord->len) ||
+     (pRecord->crc != crc16_data((uint8_t*)pRecord,
+                                 sizeof(sf_persistent_configTlvRecord_t) -
+                                 sizeof(uint16_t), 0)))
+  {
+    return E_SF_ERROR;
+  }
+
+  return E_SF_SUCCESS;
+}/* loc_readConfigTlvRecord */
+
+/*----------------------------------------------------------------------------*/
+/*! loc_findNewestConfigTlvRecord */
+/*----------------------------------------------------------------------------*/
+static E_SF_RETURN_t loc_findNewestConfigTlvRecord(sf_persistent_configTlvRecord_t *pRecord,
+                                                   uint8_t *pPage)
+{
+  /* Return value. */
+  E_SF_RETURN_t findStatus = E_SF_ERROR;
+  /* Record being checked. */
+  sf_persistent_configTlvRecord_t record;
+  /* Page and index of the record being checked. */
+  uint8_t page;
+  uint16_t idx;
+
+  for(page = 0; page < SF_PERSISTENTDATASTORAGE_CONFIG_PAGES; page++)
+  {
+    if(!loc_isConfigTlvPage(page))
+    {
+      continue;
+    }
+
+    for(idx = 0; idx < SF_PERSISTENTDATASTORAGE_CONFIG_TLV_RECORDS; idx++)
+    {
+      if(E_SF_SUCCESS != loc_readConfigTlvRecord(page, idx, &record))
+      {
+        /* Erased or cut. */
+        continue;
+      }
+
+      /* The sequence number wraps around. */
+      if((E_SF_SUCCESS != findStatus) ||
+         ((int16_t)(record.seq - pRecord->seq) > 0))
+      {
+        memcpy(pRecord, &record, sizeof(record));
+        *pPage = page;
+        findStatus = E_SF_SUCCESS;
+      }
+    }
+  }
+
+  return findStatus;
+}/* loc_findNewestConfigTlvRecord */
+
+/*----------------------------------------------------------------------------*/
+/*! loc_appendConfigTlvRecord */
+/*----------------------------------------------------------------------------*/
+static E_SF_RETURN_t loc_appendConfigTlvRecord(uint8_t version,
+                                               const uint8_t *pTlv, uint8_t len)
+{
+  /* Newest record and the new one. */
+  sf_persistent_configTlvRecord_t record;
+  /* Newest record of a previous firmware. */
+  sf_persistent_configRecord_t oldRecord;
+  /* Page of the newest record. */
+  uint8_t page = 0;
+  /* Flag of the record slot being checked. */
+  uint8_t recordFlag;
+  /* Index of the first free record slot. */
+  uint16_t idx = SF_PERSISTENTDATASTORAGE_CONFIG_TLV_RECORDS;
+
+  if(E_SF_SUCCESS == loc_findNewestConfigTlvRecord(&record, &page))
+  {
+    if((record.version == version) && (record.len == len) &&
+       (0 == memcmp(record.data, pTlv, len)))
+    {
+      /* Nothing changed, save the flash. */
+      return E_SF_SUCCESS;
+    }
+    record.seq++;
+
+    /* Slots are used in order. A slot with a written flag is used, even if
+       its record has been cut by a power loss. */
+    for(idx = 0; idx < SF_PERSISTENTDATASTORAGE_CONFIG_TLV_RECORDS; idx++)
+    {
+      if((E_SF_SUCCESS != loc_readFlash(gConfigPageAddress[page] +
+                                        idx * sizeof(record),
+                                        &recordFlag, 1)) ||
+         (SF_PERSISTENTDATASTORAGE_ERASED == recordFlag))
+      {
+        break;
+      }
+    }
+  }
+  else
+  {
+    /* First TLV record. Start on the page not holding the newest
+       configuration of a previous firmware, it is kept until the new one
+       is written. The legacy configuration is on the first page. */
+    record.seq = 0;
+    if(E_SF_SUCCESS != loc_findNewestConfigRecord(&oldRecord, &page))
+    {
+      page = 0;
+    }
+  }
+
+  if(SF_PERSISTENTDATASTORAGE_CONFIG_TLV_RECORDS == idx)
+  {
+    /* Page is full, continue on the other page. The full page keeps the
+       newest record until the new one is written. */
+    page = (page + 1) % SF_PERSISTENTDATASTORAGE_CONFIG_PAGES;
+    if(E_SF_SUCCESS != loc_eraseFlash(gConfigPageAddress[page]))
+    {
+      return E_SF_ERROR;
+    }
+    idx = 0;
+  }
+
+  memset(&record.data, SF_PERSISTENTDATASTORAGE_ERASED, sizeof(record.data));
+  record.flag = SF_PERSISTENTDATASTORAGE_CONFIG_TLV_FLAG;
+  record.version = version;
+  record.len = len;
+  record.reserved = SF_PERSISTENTDATASTORAGE_ERASED;
+  memcpy(record.data, pTlv, len);
+  record.crc = crc16_data((uint8_t*)&record,
+                          sizeof(record) - sizeof(uint16_t), 0);
+
+  return loc_writeFlash(gConfigPageAddress[page] + idx * sizeof(record),
+                        (uint8_t*)&record, sizeof(record));
+}/* loc_appendConfigTlvRecord */
+#endif /* !CONTIKI_TARGET_COOJA */
+
 /*==============================================================================
                       API FUNCTION IMPLEMENTATION
 ==============================================================================*/
 /*----------------------------------------------------------------------------*/
-/*! sf_persistentDataStorage_writeConfig */
+/*! sf_persistentDataStorage_writeConfigTlv */
 /*----------------------------------------------------------------------------*/
-E_SF_RETURN_t sf_persistentDataStorage_writeConfig(sf_persistent_deviceConfig_t*
-                                                   pPersistentDeviceConfig)
+E_SF_RETURN_t sf_persistentDataStorage_writeConfigTlv(uint8_t version,
+                                                      const uint8_t *pTlv,
+                                                      uint8_t len)
 {
   /* Return value. */
   E_SF_RETURN_t writeStatus = E_SF_ERROR;
 
-  if(NULL == pPersistentDeviceConfig)
+  if((NULL == pTlv) || (SF_PERSISTENTDATASTORAGE_CONFIG_TLV_MAX_LEN < len))
   {
     return E_SF_ERROR_INVALID_PARAM;
   }
 
-  if(E_SF_SUCCESS == sf_persistentDataStorage_removeConfig())
+#if !CONTIKI_TARGET_COOJA
+  /* Append to the configuration log, no erase per write. */
+  writeStatus = loc_appendConfigTlvRecord(version, pTlv, len);
+#else
   {
-    pPersistentDeviceConfig->flag = SF_PERSISTENTDATASTORAGE_CONFIG_FLAG;
+    /* Record to be written. */
+    sf_persistent_configTlvRecord_t record;
 
-    /* Compute CRC */
-    pPersistentDeviceConfig->crc = crc16_data((uint8_t*)pPersistentDeviceConfig,
-                                            sizeof(sf_persistent_deviceConfig_t) -
-                                            sizeof(uint16_t), 0);
+    memset(&record, SF_PERSISTENTDATASTORAGE_ERASED, sizeof(record));
+    record.flag = SF_PERSISTENTDATASTORAGE_CONFIG_TLV_FLAG;
+    record.version = version;
+    record.seq = 0;
+    record.len = len;
+    memcpy(record.data, pTlv, len);
+    record.crc = crc16_data((uint8_t*)&record,
+                            sizeof(record) - sizeof(uint16_t), 0);
 
     /* Write to NVM */
-    writeStatus = loc_writeFlash(gDeviceConfigAddress,
-                                  (uint8_t*)pPersistentDeviceConfig,
-                                  sizeof(sf_persistent_deviceConfig_t));
+    writeStatus = loc_writeFlash(gDeviceConfigAddress, (uint8_t*)&record,
+                                 sizeof(record));
   }
+#endif
 
   return writeStatus;
-}/* sf_persistentDataStorage_writeConfig() */
+}/* sf_persistentDataStorage_writeConfigTlv() */
+
+/*----------------------------------------------------------------------------*/
+/*! sf_persistentDataStorage_readConfigTlv */
+/*----------------------------------------------------------------------------*/
+E_SF_RETURN_t sf_persistentDataStorage_readConfigTlv(uint8_t *pVersion,
+                                                     uint8_t *pTlv,
+                                                     uint8_t *pLen)
+{
+  /* Newest record. */
+  sf_persistent_configTlvRecord_t record;
+
+  if((NULL == pVersion) || (NULL == pTlv) || (NULL == pLen))
+  {
+    return E_SF_ERROR_INVALID_PARAM;
+  }
+
+#if !CONTIKI_TARGET_COOJA
+  {
+    /* Page of the newest record. */
+    uint8_t page;
+
+    if(E_SF_SUCCESS != loc_findNewestConfigTlvRecord(&record, &page))
+    {
+      return E_SF_ERROR;
+    }
+  }
+#else
+  if((E_SF_SUCCESS != loc_readFlash(gDeviceConfigAddress, (uint8_t*)&record,
+                                    sizeof(record))) ||
+     (SF_PERSISTENTDATASTORAGE_CONFIG_TLV_FLAG != record.flag) ||
+     (SF_PERSISTENTDATASTORAGE_CONFIG_TLV_MAX_LEN < record.len) ||
+     (record.crc != crc16_data((uint8_t*)&record,
+                               sizeof(record) - sizeof(uint16_t), 0)))
+  {
+    return E_SF_ERROR;
+  }
+#endif
+
+  *pVersion = record.version;
+  *pLen = record.len;
+  memcpy(pTlv, record.data, record.len);
+
+  return E_SF_SUCCESS;
+}/* sf_persistentDataStorage_readConfigTlv() */
 
 /*----------------------------------------------------------------------------*/
 /*! sf_persistentDataStorage_readConfig */
@@ -155,11 +640,46 @@ E_SF_RETURN_t sf_persistentDataStorage_readConfig(sf_persistent_deviceConfig_t*
     return E_SF_ERROR_INVALID_PARAM;
   }
 
-  /* Read from NVM */
+#if !CONTIKI_TARGET_COOJA
+  {
+    /* Newest record of the configuration log. */
+    sf_persistent_configRecord_t record;
+    /* Page of the newest record. */
+    uint8_t page;
+
+    if(E_SF_SUCCESS == loc_findNewestConfigRecord(&record, &page))
+    {
+      memcpy(pPersistentDeviceConfig, &record.config, sizeof(record.config));
+      return E_SF_SUCCESS;
+    }
+  }
+#endif
+
+  /* No log yet, read the configuration of a previous firmware. */
   readStatus = loc_readFlash(gDeviceConfigAddress,
                              (uint8_t*)pPersistentDeviceConfig,
                               sizeof(sf_persistent_deviceConfig_t));
 
+  if(SF_PERSISTENTDATASTORAGE_CONFIG_FLAG_V1 == pPersistentDeviceConfig->flag)
+  {
+    /* Configuration stored by a previous firmware. The CRC directly follows
+       the device address and no channel offset has been assigned. */
+    uint16_t storedCrc;
+    memcpy(&storedCrc, (uint8_t*)pPersistentDeviceConfig +
+           SF_PERSISTENTDATASTORAGE_CONFIG_V1_LEN, sizeof(storedCrc));
+
+    crc = crc16_data((uint8_t*)pPersistentDeviceConfig,
+                     SF_PERSISTENTDATASTORAGE_CONFIG_V1_LEN, 0);
+    if(storedCrc != crc)
+    {
+      readStatus = E_SF_ERROR;
+    }
+
+    pPersistentDeviceConfig->channelOffset = 0;
+    pPersistentDeviceConfig->crc = crc;
+    return readStatus;
+  }
+
   /* Check CRC */
   crc = crc16_data((uint8_t*)pPersistentDeviceConfig,
                    sizeof(sf_persistent_deviceConfig_t) -
@@ -181,11 +701,15 @@ E_SF_RETURN_t sf_persistentDataStorage_removeConfig(void)
 {
   E_SF_RETURN_t  eraseStatus = E_SF_ERROR;
 #if !CONTIKI_TARGET_COOJA
-  uint8_t page = gDeviceConfigAddress / SF_PERSISTENTDATASTORAGE_PAGE_SIZE;
+  uint8_t page;
 
-  if(FLASH_SUCCESS == eraseFlashPg(page))
+  eraseStatus = E_SF_SUCCESS;
+  for(page = 0; page < SF_PERSISTENTDATASTORAGE_CONFIG_PAGES; page++)
   {
-    eraseStatus = E_SF_SUCCESS;
+    if(E_SF_SUCCESS != loc_eraseFlash(gConfigPageAddress[page]))
+    {
+      eraseStatus = E_SF_ERROR;
+    }
   }
 #else
   eraseStatus = E_SF_SUCCESS;
@@ -194,3 +718,68 @@ E_SF_RETURN_t sf_persistentDataStorage_removeConfig(void)
   return eraseStatus;
 }/* sf_persistentDataStorage_removeConfig() */
 
+/*----------------------------------------------------------------------------*/
+/*! sf_persistentDataStorage_writeDriftModel */
+/*----------------------------------------------------------------------------*/
+E_SF_RETURN_t sf_persistentDataStorage_writeDriftModel(sf_persistent_driftModel_t*
+                                                       pDriftModel)
+{
+  if(NULL == pDriftModel)
+  {
+    return E_SF_ERROR_INVALID_PARAM;
+  }
+
+  memset(pDriftModel->reserved, SF_PERSISTENTDATASTORAGE_ERASED,
+         sizeof(pDriftModel->reserved));
+
+  return loc_appendRecord(gDriftModelAddress, SF_PERSISTENTDATASTORAGE_DRIFT_FLAG,
+                          (uint8_t*)pDriftModel, sizeof(sf_persistent_driftModel_t));
+}/* sf_persistentDataStorage_writeDriftModel() */
+
+/*----------------------------------------------------------------------------*/
+/*! sf_persistentDataStorage_readDriftModel */
+/*----------------------------------------------------------------------------*/
+E_SF_RETURN_t sf_persistentDataStorage_readDriftModel(sf_persistent_driftModel_t*
+                                                      pDriftModel)
+{
+  if(NULL == pDriftModel)
+  {
+    return E_SF_ERROR_INVALID_PARAM;
+  }
+
+  return loc_readNewestRecord(gDriftModelAddress, SF_PERSISTENTDATASTORAGE_DRIFT_FLAG,
+                              (uint8_t*)pDriftModel, sizeof(sf_persistent_driftModel_t));
+}/* sf_persistentDataStorage_readDriftModel() */
+
+/*----------------------------------------------------------------------------*/
+/*! sf_persistentDataStorage_writeSyncContext */
+/*----------------------------------------------------------------------------*/
+E_SF_RETURN_t sf_persistentDataStorage_writeSyncContext(sf_persistent_syncContext_t*
+                                                        pSyncContext)
+{
+  if(NULL == pSyncContext)
+  {
+    return E_SF_ERROR_INVALID_PARAM;
+  }
+
+  memset(pSyncContext->reserved, SF_PERSISTENTDATASTORAGE_ERASED,
+         sizeof(pSyncContext->reserved));
+
+  return loc_appendRecord(gSyncContextAddress, SF_PERSISTENTDATASTORAGE_SYNC_FLAG,
+                          (uint8_t*)pSyncContext, sizeof(sf_persistent_syncContext_t));
+}/* sf_persistentDataStorage_writeSyncContext() */
+
+/*----------------------------------------------------------------------------*/
+/*! sf_persistentDataStorage_readSyncContext */
+/*----------------------------------------------------------------------------*/
+E_SF_RETURN_t sf_persistentDataStorage_readSyncContext(sf_persistent_syncContext_t*
+                                                       pSyncContext)
+{
+  if(NULL == pSyncContext)
+  {
+    return E_SF_ERROR_INVALID_PARAM;
+  }
+
+  return loc_readNewestRecord(gSyncContextAddress, SF_PERSISTENTDATASTORAGE_SYNC_FLAG,
+                              (uint8_t*)pSyncContext, sizeof(sf_persistent_syncContext_t));
+}/* sf_persistentDataStorage_readSyncContext() */
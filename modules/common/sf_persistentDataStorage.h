@@ -105,11 +105,26 @@ extern "C" {
   #error The compiler is not supported.
 #endif /* Compiler */
 
+/* The size of flash page in bytes */
+#define SF_PERSISTENTDATASTORAGE_PAGE_SIZE          0x2000
+/* The flash size */
+#ifndef SF_PERSISTENTDATASTORAGE_CONF_FLASH_SIZE
+#define SF_PERSISTENTDATASTORAGE_FLASH_SIZE         0x58000
+#else
+#define SF_PERSISTENTDATASTORAGE_FLASH_SIZE         SF_PERSISTENTDATASTORAGE_CONF_FLASH_SIZE
+#endif
+/* Number of pages below the flash end used by the persistent data storage:
+   CCFG, configuration, drift model, sync context and the second
+   configuration page. */
+#define SF_PERSISTENTDATASTORAGE_PAGES_USED         5
+/* Maximum length of the TLV encoded device configuration */
+#define SF_PERSISTENTDATASTORAGE_CONFIG_TLV_MAX_LEN 56
+
 /*==============================================================================
                              STRUCTS
 ==============================================================================*/
-/*! This structure defines the device life time configuration. It will be stored in RAM or
-    ROM memory. */
+/*! This structure defines the device life time configuration of previous
+    firmware versions. It is only read to migrate to the TLV encoding. */
 PACKED_STRUCT(typedef struct
 {
   uint8_t flag;
@@ -123,28 +138,98 @@ PACKED_STRUCT(typedef struct
   uint16_t panId;
   /* device short address. */
   uint8_t deviceAddr[2];
+  /* Channel offset of the data slots. */
+  uint8_t channelOffset;
   /* The calculated CRC. */
   uint16_t crc;
 }, sf_persistent_deviceConfig_t);
 
+/*! This structure defines a checkpoint of the learned clock drift to the
+    time source. It is stored as a record of an append-only log in ROM. */
+PACKED_STRUCT(typedef struct
+{
+  uint8_t flag;
+  /* Temperature in degree Celsius at which driftPpm applies. */
+  int8_t refTemp;
+  /* Drift change per degree Celsius in ppm * 256. */
+  int16_t tempCoeff;
+  /* Drift to the time source in ppm * 256. */
+  int32_t driftPpm;
+  /* Reserved, keeps the record 4 byte aligned. */
+  uint8_t reserved[2];
+  /* The calculated CRC. */
+  uint16_t crc;
+}, sf_persistent_driftModel_t);
+
+/*! This structure defines the TSCH synchronization context of the last
+    association. It is stored as a record of an append-only log in ROM and
+    allows a warm start to listen for the known time source directly. */
+PACKED_STRUCT(typedef struct
+{
+  uint8_t flag;
+  /* Channel the beacons of the time source are received on. */
+  uint8_t beaconChannel;
+  /* Short link address of the time source. */
+  uint8_t timeSourceAddr[2];
+  /* Network ID. */
+  uint16_t panId;
+  /* Most significant byte of the ASN at association. */
+  uint8_t asnMs1b;
+  /* Least significant 4 bytes of the ASN at association. */
+  uint32_t asnLs4b;
+  /* Absolute time in seconds at the ASN. */
+  uint32_t absoluteTime;
+  /* Reserved, keeps the record 4 byte aligned. */
+  uint8_t reserved[3];
+  /* The calculated CRC. */
+  uint16_t crc;
+}, sf_persistent_syncContext_t);
+
 /*==============================================================================
                             FUNCTION PROTOTYPES
 ==============================================================================*/
 /*============================================================================*/
 /**
- * \brief Store device life time configuration into NVM memory.
+ * \brief Store the TLV encoded device life time configuration into NVM memory.
+ *
+ *        The configuration is appended as a record with a sequence number
+ *        and a CRC to a log on two flash pages. A page is only erased when
+ *        the other one is full. An unchanged configuration is not written.
+ *
+ * \param version       Version of the TLV encoding.
+ * \param pTlv          TLV encoded configuration.
+ * \param len           Length of the TLV data, at most
+ *                      @ref SF_PERSISTENTDATASTORAGE_CONFIG_TLV_MAX_LEN.
+ *
+ * \return @ref E_SF_RETURN_t.
+ */
+/*============================================================================*/
+E_SF_RETURN_t sf_persistentDataStorage_writeConfigTlv(uint8_t version,
+                                                      const uint8_t *pTlv,
+                                                      uint8_t len);
+
+/*============================================================================*/
+/**
+ * \brief Read the newest TLV encoded device life time configuration from the
+ *        NVM memory.
  *
- * \param pPersistentDeviceConfig       The device configuration to be stored.
+ * \param pVersion      Pointer to the version of the TLV encoding.
+ * \param pTlv          Pointer to the TLV data storage of
+ *                      @ref SF_PERSISTENTDATASTORAGE_CONFIG_TLV_MAX_LEN bytes.
+ * \param pLen          Pointer to the length of the TLV data.
  *
  * \return @ref E_SF_RETURN_t.
  */
 /*============================================================================*/
-E_SF_RETURN_t sf_persistentDataStorage_writeConfig(sf_persistent_deviceConfig_t*
-                                                   pPersistentDeviceConfig);
+E_SF_RETURN_t sf_persistentDataStorage_readConfigTlv(uint8_t *pVersion,
+                                                     uint8_t *pTlv,
+                                                     uint8_t *pLen);
 
 /*============================================================================*/
 /**
- * \brief Read the device lifetime configuration from the NVM memory.
+ * \brief Read the device lifetime configuration stored by previous firmware
+ *        versions with a fixed configuration structure from the NVM memory.
+ *        It is used to migrate the configuration to the TLV encoding.
  *
  *
  * \param pPersistentDeviceConfig      Pointer to the device configuration
@@ -158,13 +243,63 @@ E_SF_RETURN_t sf_persistentDataStorage_readConfig(sf_persistent_deviceConfig_t*
 
 /*============================================================================*/
 /**
- * \brief Remove the device lifetime configurations from the NVM memory.
+ * \brief Remove the device lifetime configurations from the NVM memory,
+ *        i.e. erase both pages of the configuration log.
  *
  * \return @ref E_SF_RETURN_t.
  */
 /*============================================================================*/
 E_SF_RETURN_t sf_persistentDataStorage_removeConfig(void);
 
+/*============================================================================*/
+/**
+ * \brief Append a drift model checkpoint to the NVM memory.
+ *
+ * \param pDriftModel       The drift model to be stored.
+ *
+ * \return @ref E_SF_RETURN_t.
+ */
+/*============================================================================*/
+E_SF_RETURN_t sf_persistentDataStorage_writeDriftModel(sf_persistent_driftModel_t*
+                                                       pDriftModel);
+
+/*============================================================================*/
+/**
+ * \brief Read the newest drift model checkpoint from the NVM memory.
+ *
+ * \param pDriftModel      Pointer to the drift model read from the NVM memory.
+ *
+ * \return @ref E_SF_RETURN_t.
+ */
+/*============================================================================*/
+E_SF_RETURN_t sf_persistentDataStorage_readDriftModel(sf_persistent_driftModel_t*
+                                                      pDriftModel);
+
+/*============================================================================*/
+/**
+ * \brief Append a synchronization context to the NVM memory.
+ *
+ * \param pSyncContext      The synchronization context to be stored.
+ *
+ * \return @ref E_SF_RETURN_t.
+ */
+/*============================================================================*/
+E_SF_RETURN_t sf_persistentDataStorage_writeSyncContext(sf_persistent_syncContext_t*
+                                                        pSyncContext);
+
+/*============================================================================*/
+/**
+ * \brief Read the newest synchronization context from the NVM memory.
+ *
+ * \param pSyncContext     Pointer to the synchronization context read from the
+ *                         NVM memory.
+ *
+ * \return @ref E_SF_RETURN_t.
+ */
+/*============================================================================*/
+E_SF_RETURN_t sf_persistentDataStorage_readSyncContext(sf_persistent_syncContext_t*
+                                                       pSyncContext);
+
 #endif /* __SF_PERSISTENT_DATA_STORAGE_H__ */
 
 #ifdef __cplusplus
@@ -17,7 +17,9 @@ extern "C" {
  *
  * @details    The absolute time is synchronized between the BMSCC and
  *             the smart cells. The time base should be set by the user
- *             at the startup time of the BMSCC.
+ *             at the startup time of the BMSCC. The smart cells derive it
+ *             from the TSCH ASN, anchored to the absolute time carried by
+ *             the beacons, so no periodic timer is needed.
  *
  */
 
@@ -36,7 +38,7 @@ extern "C" {
  *    | @ref sf_absoluteTime_getMinutes()         | @copybrief sf_absoluteTime_getMinutes()         |
  *    | @ref sf_absoluteTime_getHours()           | @copybrief sf_absoluteTime_getHours()           |
  *    | @ref sf_absoluteTime_getTime()            | @copybrief sf_absoluteTime_getTime()            |
- *    | @ref sf_absoluteTime_startTimer()         | @copybrief sf_absoluteTime_startTimer()         |
+ *    | @ref sf_absoluteTime_getTimeMs()          | @copybrief sf_absoluteTime_getTimeMs()          |
  *  @{
  */
 
@@ -95,12 +97,12 @@ uint32_t sf_absoluteTime_getTime(void);
 
 /*============================================================================*/
 /**
- * \brief Starts absolute time incrementing.
+ * \brief Fetch the current absolute time with millisecond resolution.
  *
- * \return @ref E_SF_RETURN_t
+ * \return absolute time in milliseconds, 0 if not yet synchronized
  */
 /*============================================================================*/
-E_SF_RETURN_t sf_absoluteTime_startTimer(void);
+uint64_t sf_absoluteTime_getTimeMs(void);
 
 /*! @} */
 
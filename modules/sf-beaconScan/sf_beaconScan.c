@@ -29,12 +29,14 @@ extern "C" {
 #include "net/packetbuf.h"
 #include "net/mac/framer/framer-802154.h"
 #include "net/mac/tsch/tsch.h"
+#include "sys/energest.h"
 #if CONTIKI_TARGET_COOJA
 #include "random.h"
 #endif
 /* Application specific includes */
 #include "sf_configMgmt.h"
 #include "sf_rfSettings.h"
+#include "sf_linkQuality.h"
 #include "sf_beaconScan.h"
 /* Log configuration */
 #include "sys/log.h"
@@ -61,8 +63,36 @@ extern "C" {
 #else
 #define SF_BEACON_SCAN_DURATION          (SF_CONF_BEACON_SCAN_DURATION * CLOCK_SECOND)
 #endif
-/* Defines the scan time for one channel. */
+/* Defines the scan time for one channel. It is longer than a slotframe in
+   all radio profiles, so a source is heard on its beacon channel. */
 #define SF_BEACON_SCAN_CHANNEL_TIME      (5 * CLOCK_SECOND)
+/* Channel index step from one beacon of a source to its next one. The
+   beacons are sent once per slotframe on the advertising hopping sequence,
+   which is the join hopping sequence. */
+#define SF_BEACON_SCAN_FOLLOW_STEP(numChannels) \
+                                         (APP_SLOTFRAME_SIZE % (numChannels))
+/* Interval in which pending packets are checked while scanning. */
+#define SF_BEACON_SCAN_POLL_TIME         (CLOCK_SECOND / 8)
+/* Number of beacons of the best source ending the scan early. */
+#ifndef SF_CONF_BEACON_SCAN_HITS
+#define SF_BEACON_SCAN_HITS              3U
+#else
+#define SF_BEACON_SCAN_HITS              SF_CONF_BEACON_SCAN_HITS
+#endif
+/* Minimum RSSI in dBm of a join beacon counted for ending the scan early. */
+#ifndef SF_CONF_BEACON_SCAN_RSSI_THRESHOLD
+#define SF_BEACON_SCAN_RSSI_THRESHOLD    (-75)
+#else
+#define SF_BEACON_SCAN_RSSI_THRESHOLD    SF_CONF_BEACON_SCAN_RSSI_THRESHOLD
+#endif
+/* Number of beacon sources counted for ending the scan early. */
+#define SF_BEACON_SCAN_SOURCES_MAX       4U
+/* Lifetime of the cached scan result in seconds. */
+#ifndef SF_CONF_BEACON_SCAN_CACHE_LIFETIME
+#define SF_BEACON_SCAN_CACHE_LIFETIME    (10UL * 60UL)
+#else
+#define SF_BEACON_SCAN_CACHE_LIFETIME    SF_CONF_BEACON_SCAN_CACHE_LIFETIME
+#endif
 
 /*==============================================================================
                             STRUCTS
@@ -84,15 +114,39 @@ typedef struct
   E_SF_JOIN_BEACON_t joinBeaconFlag;
 }sf_beaconInfo_t;
 
+/* Number of counted beacons of a source */
+typedef struct
+{
+  /* Beacon source address */
+  linkaddr_t src_addr;
+  /* Number of counted beacons */
+  uint8_t hits;
+}sf_beaconSource_t;
+
+/* Result of the last successful scan */
+typedef struct
+{
+  /* Time of the scan in seconds */
+  unsigned long timestamp;
+  /* Channel on which the best beacon has been received */
+  uint8_t channel;
+  /* True if the cache holds a result */
+  bool valid;
+}sf_beaconScanCache_t;
+
 /*==============================================================================
                             GLOBAL VARIABLES
 ==============================================================================*/
-/* Received beacon with best RSSI */
+/* Received beacon of the best rated source */
 static sf_beaconInfo_t gBestBeacon = {0};
 /* Stores accepted beacon type.
    E_SF_JOIN_BEACON_ENABLED: Manual join is allowed
    E_SF_JOIN_BEACON_DISABLED: Manual join is not allowed */
 static E_SF_JOIN_BEACON_t gBeaconType = E_SF_JOIN_BEACON_DISABLED;
+/* Counted beacons per source of the ongoing scan */
+static sf_beaconSource_t gBeaconSources[SF_BEACON_SCAN_SOURCES_MAX];
+/* Result of the last successful scan */
+static sf_beaconScanCache_t gScanCache = {0};
 
 /*==============================================================================
                          LOCAL FUNCTION DECLARATION
@@ -111,6 +165,32 @@ static E_SF_JOIN_BEACON_t gBeaconType = E_SF_JOIN_BEACON_DISABLED;
 static bool loc_parseBeaconPacket(const struct input_packet *pInput_eb,
                                   sf_beaconInfo_t *output_eb);
 
+/*============================================================================*/
+/**
+ * \brief Counts a beacon of the given source.
+ *
+ * \param pAddr               Beacon source address.
+ *
+ * \return Number of beacons counted for this source, 0 if the source could
+ *         not be tracked.
+ */
+/*============================================================================*/
+static uint8_t loc_countBeacon(const linkaddr_t *pAddr);
+
+/*============================================================================*/
+/**
+ * \brief Returns the index of the first channel to be scanned. This is the
+ *        channel of the cached result, if still valid.
+ *
+ * \param pChannels           Channels to be scanned.
+ * \param numChannels         Number of channels to be scanned.
+ *
+ * \return Channel index.
+ */
+/*============================================================================*/
+static uint8_t loc_getFirstChannelIdx(const uint8_t *pChannels,
+                                      uint8_t numChannels);
+
 /*==============================================================================
                          LOCAL FUNCTION DEFINITION
 ==============================================================================*/
@@ -142,6 +222,57 @@ static bool loc_parseBeaconPacket(const struct input_packet *pInput_eb,
   return parseStatus;
 }/* loc_parseBeaconPacket() */
 
+/*----------------------------------------------------------------------------*/
+/*! loc_countBeacon */
+/*----------------------------------------------------------------------------*/
+static uint8_t loc_countBeacon(const linkaddr_t *pAddr)
+{
+  uint8_t i;
+
+  for(i = 0; i < SF_BEACON_SCAN_SOURCES_MAX; i++)
+  {
+    if(0 == gBeaconSources[i].hits)
+    {
+      /* Free entry, start counting this source. */
+      linkaddr_copy(&gBeaconSources[i].src_addr, pAddr);
+    }
+
+    if(linkaddr_cmp(&gBeaconSources[i].src_addr, pAddr))
+    {
+      if(gBeaconSources[i].hits < UINT8_MAX)
+      {
+        gBeaconSources[i].hits++;
+      }
+      return gBeaconSources[i].hits;
+    }
+  }
+
+  return 0;
+}/* loc_countBeacon() */
+
+/*----------------------------------------------------------------------------*/
+/*! loc_getFirstChannelIdx */
+/*----------------------------------------------------------------------------*/
+static uint8_t loc_getFirstChannelIdx(const uint8_t *pChannels,
+                                      uint8_t numChannels)
+{
+  uint8_t i;
+
+  if(gScanCache.valid &&
+     (clock_seconds() - gScanCache.timestamp) < SF_BEACON_SCAN_CACHE_LIFETIME)
+  {
+    for(i = 0; i < numChannels; i++)
+    {
+      if(pChannels[i] == gScanCache.channel)
+      {
+        return i;
+      }
+    }
+  }
+
+  return 0;
+}/* loc_getFirstChannelIdx() */
+
 /*==============================================================================
                                   THREADS
 ==============================================================================*/
@@ -156,6 +287,8 @@ PT_THREAD(beacon_scan_process(struct pt *pt))
   static struct etimer channelScanTimer;
   /* Timer to count individual channel scan time */
   static struct etimer individualChannelScanTimer;
+  /* Timer to check for pending packets */
+  static struct etimer pollTimer;
   /* Number of accepted beacons */
   static uint8_t beaconCounter;
   /* Last received beacon */
@@ -165,10 +298,18 @@ PT_THREAD(beacon_scan_process(struct pt *pt))
   static uint8_t channelIdx;
   /* Channels which should be scanned */
   static uint8_t scanChannels[] = SF_BEACON_SCAN_HOPPING_SEQUENCE;
-  /* Network ID */
-  static uint16_t panId = 0;
-  /* BMSCC short address */
-  linkaddr_t bmsAddr = linkaddr_null;
+  /* Set once enough beacons of the best source are received */
+  static bool scanDone;
+  /* Set while the beacons of the best source are followed */
+  static bool followBeacon;
+  /* Set to end the channel scan on a followed beacon */
+  static bool nextChannel;
+  /* Number of beacons counted for the received source */
+  uint8_t hits;
+  /* Start of the scan in seconds */
+  static unsigned long scanStart;
+  /* Best rated beacon source */
+  sf_linkQuality_neighbour_t best;
 
   PT_BEGIN(pt);
 
@@ -185,8 +326,12 @@ PT_THREAD(beacon_scan_process(struct pt *pt))
   linkaddr_copy(&gBestBeacon.src_addr, &linkaddr_null);
   /* Initialized operational variables */
   beaconCounter = 0;
-  scanCounter = 0;
+  scanCounter = loc_getFirstChannelIdx(scanChannels, sizeof(scanChannels));
   channelIdx = 0;
+  scanDone = false;
+  followBeacon = false;
+  scanStart = clock_seconds();
+  memset(gBeaconSources, 0, sizeof(gBeaconSources));
 
   etimer_set(&individualChannelScanTimer, SF_BEACON_SCAN_CHANNEL_TIME);
   etimer_set(&channelScanTimer, SF_BEACON_SCAN_DURATION);
@@ -201,11 +346,16 @@ PT_THREAD(beacon_scan_process(struct pt *pt))
     LOG_INFO_("without manual join flag.\n");
   }
 
-  while(!etimer_expired(&channelScanTimer))
+  while(!etimer_expired(&channelScanTimer) && !scanDone)
   {
     /* Calculate next beacon channel. */
-    channelIdx = scanCounter % 3U;
-    scanCounter = scanCounter + 1U;
+    channelIdx = scanCounter % sizeof(scanChannels);
+    /* A followed source sends its next beacon one slotframe later on the
+       next advertising channel. Otherwise the channels are scanned in
+       turn. */
+    scanCounter = (uint8_t)(channelIdx + (followBeacon ?
+                            SF_BEACON_SCAN_FOLLOW_STEP(sizeof(scanChannels)) : 1U));
+    nextChannel = false;
 
     LOG_INFO("Scan channel %u: \n", scanChannels[channelIdx]);
 
@@ -217,10 +367,14 @@ PT_THREAD(beacon_scan_process(struct pt *pt))
 
     /* Turn radio on and wait for EB */
     NETSTACK_RADIO.on();
+    ENERGEST_ON(ENERGEST_TYPE_SF_RX_BEACON);
 
-    while(!etimer_expired(&individualChannelScanTimer))
+    /* The restarted channel timer must not extend the overall scan. */
+    while(!etimer_expired(&individualChannelScanTimer) &&
+          !etimer_expired(&channelScanTimer) && !scanDone && !nextChannel)
     {
       /* Wait until any event. */
+      etimer_set(&pollTimer, SF_BEACON_SCAN_POLL_TIME);
       PT_YIELD(pt);
 
       int isPacketPending = NETSTACK_RADIO.pending_packet();
@@ -251,17 +405,19 @@ PT_THREAD(beacon_scan_process(struct pt *pt))
                       lastBeacon.rssi, lastBeacon.joinBeaconFlag);
 
             /* Check the beacon flag. */
-            if(gBeaconType == lastBeacon.joinBeaconFlag)
+            if(gBeaconType != lastBeacon.joinBeaconFlag)
+            {
+              /* Beacons of other sources still tell about the channel. */
+              sf_linkQuality_beaconRx(NULL, lastBeacon.rssi, lastBeacon.channel);
+            }
+            else
             {
               if(E_SF_JOIN_BEACON_DISABLED == gBeaconType)
               {
-                sf_configMgmt_getParam(&panId, sizeof(panId),
-                                       E_CONFIGMGMT_PARAM_PAN_ID);
-                sf_configMgmt_getParam(bmsAddr.u8, sizeof(bmsAddr.u8),
-                                       E_CONFIGMGMT_PARAM_GW_ADDR);
-
-                if(panId != lastBeacon.src_pid || !linkaddr_cmp(&bmsAddr, &lastBeacon.src_addr))
+                if(sf_configMgmt_getPanId() != lastBeacon.src_pid ||
+                   !linkaddr_cmp(sf_configMgmt_getGwAddr(), &lastBeacon.src_addr))
                 {
+                  sf_linkQuality_beaconRx(NULL, lastBeacon.rssi, lastBeacon.channel);
                   isPacketPending = NETSTACK_RADIO.pending_packet();
                   continue;
                 }
@@ -269,10 +425,48 @@ PT_THREAD(beacon_scan_process(struct pt *pt))
 
               beaconCounter++;
 
-              /* Store beacon with best RSSI */
-              if(lastBeacon.rssi > gBestBeacon.rssi)
+              /* Select the best rated source seen during this scan. Its
+                 link quality history is kept across scans. */
+              sf_linkQuality_beaconRx(&lastBeacon.src_addr, lastBeacon.rssi,
+                                      lastBeacon.channel);
+              if(sf_linkQuality_getBestNeighbour(scanStart, &best))
               {
-                gBestBeacon = lastBeacon;
+                linkaddr_copy(&gBestBeacon.src_addr, &best.addr);
+                gBestBeacon.channel = best.beaconChannel;
+                gBestBeacon.rssi = best.link.rssi / SF_LINKQUALITY_RSSI_SCALE;
+              }
+
+              /* Count beacons of the stored network (rejoin) or strong
+                 enough join beacons. Stop once the best source is
+                 confirmed. */
+              if((E_SF_JOIN_BEACON_DISABLED == gBeaconType) ||
+                 (lastBeacon.rssi >= SF_BEACON_SCAN_RSSI_THRESHOLD))
+              {
+                hits = loc_countBeacon(&lastBeacon.src_addr);
+                if(linkaddr_cmp(&lastBeacon.src_addr, &gBestBeacon.src_addr))
+                {
+                  if(hits >= SF_BEACON_SCAN_HITS)
+                  {
+                    LOG_INFO("Best beacon confirmed, stop scan\n");
+                    scanDone = true;
+                    break;
+                  }
+
+                  /* The advertising channel moves on with every
+                     slotframe. On a rejoin, wait for the next beacon of
+                     the stored BMS-CC on its channel. A manual join keeps
+                     scanning the channels in turn, since following the
+                     first source heard hides the other packs in the join
+                     mode. */
+                  if(E_SF_JOIN_BEACON_DISABLED == gBeaconType)
+                  {
+                    scanCounter = (uint8_t)(channelIdx +
+                                  SF_BEACON_SCAN_FOLLOW_STEP(sizeof(scanChannels)));
+                    followBeacon = true;
+                    nextChannel = true;
+                    break;
+                  }
+                }
               }
             }
           }
@@ -288,10 +482,22 @@ PT_THREAD(beacon_scan_process(struct pt *pt))
 
     /* Turn radio off */
     NETSTACK_RADIO.off();
+    ENERGEST_OFF(ENERGEST_TYPE_SF_RX_BEACON);
+
+    /* A missed beacon is skipped once, then the source is searched for
+       again. */
+    if(!nextChannel)
+    {
+      followBeacon = false;
+    }
 
     etimer_set(&individualChannelScanTimer, SF_BEACON_SCAN_CHANNEL_TIME);
   }
 
+  etimer_stop(&pollTimer);
+  etimer_stop(&individualChannelScanTimer);
+  etimer_stop(&channelScanTimer);
+
   /* Check if valid beacons are received */
   if(beaconCounter == 0)
   {
@@ -302,9 +508,14 @@ PT_THREAD(beacon_scan_process(struct pt *pt))
   else
   {
     LOG_INFO("Rx %u beacon packets\n", beaconCounter);
-    LOG_INFO("Best RSSI from ");
+    LOG_INFO("Best link to ");
     LOG_INFO_LLADDR(&gBestBeacon.src_addr);
     LOG_INFO_(": %d dBm\n", gBestBeacon.rssi);
+
+    /* Start the next scan on this channel. */
+    gScanCache.channel = gBestBeacon.channel;
+    gScanCache.timestamp = clock_seconds();
+    gScanCache.valid = true;
   }
 
   /* Set fixed address for TSCH beacon scan. */
@@ -18,6 +18,8 @@
 /*****************************************************************************/
 /* Standard include */
 #include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
 #include <string.h>
 /* Stack includes */
 #if !CONTIKI_TARGET_COOJA
@@ -46,6 +48,60 @@
 /* IEEE 802.15.4 MAC address. This is a unique entity provided by the vendor.
    We will use it to configure the default device serial number. */
 #define SF_CONFIGMGMT_MAC_PRIMARY_ADDRESS          (FCFG1_BASE + FCFG1_O_MAC_15_4_0)
+/* Version of the TLV encoding of the stored configuration.
+   Version 0 is the fixed structure of previous firmware versions. */
+#define SF_CONFIGMGMT_TLV_VERSION                  1
+/* Length of the TLV tag and length fields */
+#define SF_CONFIGMGMT_TLV_HEADER_LEN               2
+/* Registry entry of a member of sf_deviceConfig_t */
+#define SF_CONFIGMGMT_PARAM(tag, member, pIsValid)                            \
+        {(tag), offsetof(sf_deviceConfig_t, member),                          \
+         sizeof(((sf_deviceConfig_t*)0)->member), (pIsValid)}
+
+/*****************************************************************************/
+/*                         STRUCTS                                           */
+/*****************************************************************************/
+/*! Registry entry of a configuration parameter. */
+typedef struct
+{
+  /* TLV tag of the stored parameter. It must never change once released,
+     new parameters get a new tag. */
+  uint8_t tag;
+  /* Offset of the parameter in sf_deviceConfig_t. */
+  uint8_t offset;
+  /* Size of the parameter. */
+  uint8_t size;
+  /* Checks a new value, NULL if any value is valid. */
+  bool (*pIsValid)(const void* pParamData);
+} sf_configMgmt_param_t;
+
+/*****************************************************************************/
+/*                         LOCAL FUNCTION DEFINITION                         */
+/*****************************************************************************/
+/*============================================================================*/
+/**
+ * \brief Check a new measurement interval.
+ */
+/*============================================================================*/
+static bool loc_isMeasIntervalValid(const void* pParamData);
+
+/*============================================================================*/
+/**
+ * \brief Check a new data slot channel offset.
+ */
+/*============================================================================*/
+static bool loc_isChannelOffsetValid(const void* pParamData);
+
+/*============================================================================*/
+/**
+ * \brief Decode a TLV encoded configuration. Unknown tags and values of an
+ *        unexpected size are skipped, the parameters keep their value.
+ *
+ * \param pTlv       TLV data.
+ * \param len        Length of the TLV data.
+ */
+/*============================================================================*/
+static void loc_decodeTlv(const uint8_t* pTlv, uint8_t len);
 
 /*****************************************************************************/
 /*                         GLOBAL VARIABLES                                  */
@@ -54,135 +110,123 @@
 sf_deviceConfig_t gDeviceConfig = {0};
 /* Stores device status */
 static SF_GONFIGMGMT_DEVICESTATUS_t gDeviceStatus = E_CONFIGMGMT_DEVICESTATUS_NOT_CONNECTED;
+/* Registry of the configuration parameters */
+static const sf_configMgmt_param_t gParamTable[E_CONFIGMGMT_PARAM_MAX] =
+{
+  [E_CONFIGMGMT_PARAM_DEVICE_SERIAL] =
+    SF_CONFIGMGMT_PARAM(0x01, deviceSerial, NULL),
+  [E_CONFIGMGMT_PARAM_MEAS_INTERVAL] =
+    SF_CONFIGMGMT_PARAM(0x02, measIntervalSec, loc_isMeasIntervalValid),
+  [E_CONFIGMGMT_PARAM_DEVICE_ADDR] =
+    SF_CONFIGMGMT_PARAM(0x03, deviceAddr, NULL),
+  [E_CONFIGMGMT_PARAM_GW_ADDR] =
+    SF_CONFIGMGMT_PARAM(0x04, bmsccAddr, NULL),
+  [E_CONFIGMGMT_PARAM_PAN_ID] =
+    SF_CONFIGMGMT_PARAM(0x05, panId, NULL),
+  [E_CONFIGMGMT_PARAM_CHANNEL_OFFSET] =
+    SF_CONFIGMGMT_PARAM(0x06, channelOffset, loc_isChannelOffsetValid),
+};
 
 /*****************************************************************************/
-/*                         API FUNCTIONS                                     */
+/*                         LOCAL FUNCTION IMPLEMENTATION                     */
 /*****************************************************************************/
 /*------------------------------------------------------------------------------
-  sf_configMgmt_setParam()
+  loc_isMeasIntervalValid()
 ------------------------------------------------------------------------------*/
-E_SF_RETURN_t sf_configMgmt_setParam(const void* pParamData, size_t paramSize,
-                                     SF_CONFIGMGMT_PARAM_t paramType)
+static bool loc_isMeasIntervalValid(const void* pParamData)
 {
-  E_SF_RETURN_t returnValue = E_SF_ERROR_INVALID_PARAM;
+  uint32_t measInterval;
 
-  if(NULL == pParamData)
-  {
-    return returnValue;
-  }
+  memcpy(&measInterval, pParamData, sizeof(measInterval));
+  return SF_CONFIGMGMT_MEAS_INTERVAL_LIMIT_LOWER <= measInterval;
+}/* loc_isMeasIntervalValid() */
 
-  switch (paramType)
-  {
-    case E_CONFIGMGMT_PARAM_DEVICE_SERIAL:
-      if(paramSize == sizeof(gDeviceConfig.deviceSerial))
-      {
-        memcpy(&gDeviceConfig.deviceSerial, pParamData, paramSize);
-        returnValue = E_SF_SUCCESS;
-      }
-      break;
-
-    case E_CONFIGMGMT_PARAM_MEAS_INTERVAL:
-      if(paramSize == sizeof(gDeviceConfig.measIntervalSec) &&
-         SF_CONFIGMGMT_MEAS_INTERVAL_LIMIT_LOWER <= *((uint32_t*)pParamData))
-      {
-        memcpy(&gDeviceConfig.measIntervalSec, pParamData, paramSize);
-        returnValue = E_SF_SUCCESS;
-      }
-      break;
+/*------------------------------------------------------------------------------
+  loc_isChannelOffsetValid()
+------------------------------------------------------------------------------*/
+static bool loc_isChannelOffsetValid(const void* pParamData)
+{
+  return APP_SLOTFRAME_CHANNEL_OFFSET_NUM > *((const uint8_t*)pParamData);
+}/* loc_isChannelOffsetValid() */
 
-    case E_CONFIGMGMT_PARAM_DEVICE_ADDR:
-      if(paramSize == sizeof(gDeviceConfig.deviceAddr))
-      {
-        memcpy(&gDeviceConfig.deviceAddr, pParamData, paramSize);
-        returnValue = E_SF_SUCCESS;
-      }
-      break;
+/*------------------------------------------------------------------------------
+  loc_decodeTlv()
+------------------------------------------------------------------------------*/
+static void loc_decodeTlv(const uint8_t* pTlv, uint8_t len)
+{
+  /* Offset of the TLV being decoded */
+  uint8_t pos = 0;
+  /* Parameter of the TLV */
+  uint8_t param;
 
-    case E_CONFIGMGMT_PARAM_GW_ADDR:
-      if(paramSize == sizeof(gDeviceConfig.bmsccAddr))
-      {
-        memcpy(&gDeviceConfig.bmsccAddr, pParamData, paramSize);
-        returnValue = E_SF_SUCCESS;
-      }
+  while((pos + SF_CONFIGMGMT_TLV_HEADER_LEN) <= len)
+  {
+    if((pos + SF_CONFIGMGMT_TLV_HEADER_LEN + pTlv[pos + 1]) > len)
+    {
+      /* Truncated value. */
       break;
+    }
 
-    case E_CONFIGMGMT_PARAM_PAN_ID:
-      if(paramSize == sizeof(gDeviceConfig.panId))
+    for(param = 0; param < E_CONFIGMGMT_PARAM_MAX; param++)
+    {
+      if(gParamTable[param].tag == pTlv[pos])
       {
-        memcpy(&gDeviceConfig.panId, pParamData, paramSize);
-        returnValue = E_SF_SUCCESS;
+        /* Ignore the result, an invalid value keeps the default. */
+        sf_configMgmt_setParam(&pTlv[pos + SF_CONFIGMGMT_TLV_HEADER_LEN],
+                               pTlv[pos + 1], (SF_CONFIGMGMT_PARAM_t)param);
+        break;
       }
-      break;
+    }
 
-    default:
-      break;
+    pos += SF_CONFIGMGMT_TLV_HEADER_LEN + pTlv[pos + 1];
   }
+}/* loc_decodeTlv() */
 
-  return returnValue;
-}/* sf_configMgmt_setParam() */
-
-
+/*****************************************************************************/
+/*                         API FUNCTIONS                                     */
+/*****************************************************************************/
 /*------------------------------------------------------------------------------
-  sf_configMgmt_getDeviceSerial()
+  sf_configMgmt_setParam()
 ------------------------------------------------------------------------------*/
-E_SF_RETURN_t sf_configMgmt_getParam(void* pParamData, size_t paramSize,
+E_SF_RETURN_t sf_configMgmt_setParam(const void* pParamData, size_t paramSize,
                                      SF_CONFIGMGMT_PARAM_t paramType)
 {
-  E_SF_RETURN_t returnValue = E_SF_ERROR_INVALID_PARAM;
-
-  if(NULL == pParamData)
+  if((NULL == pParamData) || (E_CONFIGMGMT_PARAM_MAX <= paramType) ||
+     (paramSize != gParamTable[paramType].size))
   {
-    return returnValue;
+    return E_SF_ERROR_INVALID_PARAM;
   }
 
-  switch (paramType)
+  if((NULL != gParamTable[paramType].pIsValid) &&
+     !gParamTable[paramType].pIsValid(pParamData))
   {
-    case E_CONFIGMGMT_PARAM_DEVICE_SERIAL:
-      if(paramSize == sizeof(gDeviceConfig.deviceSerial))
-      {
-        memcpy(pParamData, &gDeviceConfig.deviceSerial, paramSize);
-        returnValue = E_SF_SUCCESS;
-      }
-      break;
+    return E_SF_ERROR_INVALID_PARAM;
+  }
 
-    case E_CONFIGMGMT_PARAM_MEAS_INTERVAL:
-      if(paramSize == sizeof(gDeviceConfig.measIntervalSec))
-      {
-        memcpy(pParamData, &gDeviceConfig.measIntervalSec, paramSize);
-        returnValue = E_SF_SUCCESS;
-      }
-      break;
+  memcpy((uint8_t*)&gDeviceConfig + gParamTable[paramType].offset, pParamData,
+         paramSize);
 
-    case E_CONFIGMGMT_PARAM_DEVICE_ADDR:
-      if(paramSize == sizeof(gDeviceConfig.deviceAddr))
-      {
-        memcpy(pParamData, gDeviceConfig.deviceAddr.u8, paramSize);
-        returnValue = E_SF_SUCCESS;
-      }
-      break;
-
-    case E_CONFIGMGMT_PARAM_GW_ADDR:
-      if(paramSize == sizeof(gDeviceConfig.bmsccAddr))
-      {
-        memcpy(pParamData, &gDeviceConfig.bmsccAddr, paramSize);
-        returnValue = E_SF_SUCCESS;
-      }
-      break;
+  return E_SF_SUCCESS;
+}/* sf_configMgmt_setParam() */
 
-    case E_CONFIGMGMT_PARAM_PAN_ID:
-      if(paramSize == sizeof(gDeviceConfig.panId))
-      {
-        memcpy(pParamData, &gDeviceConfig.panId, paramSize);
-        returnValue = E_SF_SUCCESS;
-      }
-      break;
 
-    default:
-      break;
+/*------------------------------------------------------------------------------
+  sf_configMgmt_getParam()
+------------------------------------------------------------------------------*/
+E_SF_RETURN_t sf_configMgmt_getParam(void* pParamData, size_t paramSize,
+                                     SF_CONFIGMGMT_PARAM_t paramType)
+{
+  if((NULL == pParamData) || (E_CONFIGMGMT_PARAM_MAX <= paramType) ||
+     (paramSize != gParamTable[paramType].size))
+  {
+    return E_SF_ERROR_INVALID_PARAM;
   }
 
-  return returnValue;
-}
+  memcpy(pParamData, (const uint8_t*)&gDeviceConfig +
+         gParamTable[paramType].offset, paramSize);
+
+  return E_SF_SUCCESS;
+}/* sf_configMgmt_getParam() */
 
 /*------------------------------------------------------------------------------
   sf_configMgmt_setDefaultConfig()
@@ -248,21 +292,34 @@ E_SF_RETURN_t sf_configMgmt_setDefaultConfig(void)
 ------------------------------------------------------------------------------*/
 E_SF_RETURN_t sf_configMgmt_writeConfig(void)
 {
-  E_SF_RETURN_t writeStatus = E_SF_ERROR;
-  /* Buffer to store the configuration to write into the flash. */
-  sf_persistent_deviceConfig_t persistentDeviceConfig = {0};
-
-  persistentDeviceConfig.measIntervalSec = gDeviceConfig.measIntervalSec;
-  persistentDeviceConfig.deviceSerial = gDeviceConfig.deviceSerial;
-  memcpy(persistentDeviceConfig.bmsccAddr, gDeviceConfig.bmsccAddr.u8,
-        sizeof(persistentDeviceConfig.bmsccAddr));
-  persistentDeviceConfig.panId = gDeviceConfig.panId;
-  memcpy(persistentDeviceConfig.deviceAddr, gDeviceConfig.deviceAddr.u8,
-        sizeof(persistentDeviceConfig.deviceAddr));
-
-  writeStatus = sf_persistentDataStorage_writeConfig(&persistentDeviceConfig);
+  /* Buffer of the TLV encoded configuration. */
+  uint8_t tlv[SF_PERSISTENTDATASTORAGE_CONFIG_TLV_MAX_LEN];
+  /* Length of the TLV data */
+  uint8_t len = 0;
+  /* Parameter being encoded */
+  uint8_t param;
+
+  /* tag  |  length  |  value
+     -----|----------|--------------
+     1byte|  1byte   |  length bytes */
+  for(param = 0; param < E_CONFIGMGMT_PARAM_MAX; param++)
+  {
+    if((len + SF_CONFIGMGMT_TLV_HEADER_LEN + gParamTable[param].size) >
+       sizeof(tlv))
+    {
+      /* The registry exceeds the storage. */
+      return E_SF_ERROR;
+    }
+
+    tlv[len++] = gParamTable[param].tag;
+    tlv[len++] = gParamTable[param].size;
+    memcpy(&tlv[len], (const uint8_t*)&gDeviceConfig + gParamTable[param].offset,
+           gParamTable[param].size);
+    len += gParamTable[param].size;
+  }
 
-  return writeStatus;
+  return sf_persistentDataStorage_writeConfigTlv(SF_CONFIGMGMT_TLV_VERSION,
+                                                 tlv, len);
 } /* sf_configMgmt_writeConfig() */
 
 /*------------------------------------------------------------------------------
@@ -271,10 +328,26 @@ E_SF_RETURN_t sf_configMgmt_writeConfig(void)
 E_SF_RETURN_t sf_configMgmt_readConfig(void)
 {
   E_SF_RETURN_t readStatus = E_SF_ERROR;
+  /* Buffer of the TLV encoded configuration. */
+  uint8_t tlv[SF_PERSISTENTDATASTORAGE_CONFIG_TLV_MAX_LEN];
+  /* Length of the TLV data */
+  uint8_t len;
+  /* Version of the TLV encoding */
+  uint8_t version;
   /* Buffer to store the data device lifetime configuration read from
      the flash. */
   sf_persistent_deviceConfig_t persistentDeviceConfig = {0};
 
+  if(E_SF_SUCCESS == sf_persistentDataStorage_readConfigTlv(&version, tlv,
+                                                            &len))
+  {
+    /* The tags of all versions are decoded the same way. Parameters added
+       by a later version are kept at their value. */
+    loc_decodeTlv(tlv, len);
+    return E_SF_SUCCESS;
+  }
+
+  /* Migrate the fixed structure of previous firmware versions. */
   readStatus = sf_persistentDataStorage_readConfig(&persistentDeviceConfig);
   if(E_SF_SUCCESS == readStatus)
   {
@@ -285,6 +358,11 @@ E_SF_RETURN_t sf_configMgmt_readConfig(void)
     gDeviceConfig.panId = persistentDeviceConfig.panId;
     memcpy(gDeviceConfig.deviceAddr.u8, persistentDeviceConfig.deviceAddr,
             sizeof(persistentDeviceConfig.deviceAddr));
+    gDeviceConfig.channelOffset = persistentDeviceConfig.channelOffset;
+
+    /* Store it TLV encoded. The old configuration is kept until the new
+       one has been written. */
+    sf_configMgmt_writeConfig();
   }
 
   return readStatus;
@@ -35,6 +35,12 @@
  *    | @ref sf_configMgmt_readConfig()           | @copybrief sf_configMgmt_readConfig()           |
  *    | @ref sf_configMgmt_setDeviceStatus()      | @copybrief sf_configMgmt_setDeviceStatus()      |
  *    | @ref sf_configMgmt_getDeviceStatus()      | @copybrief sf_configMgmt_getDeviceStatus()      |
+ *    | @ref sf_configMgmt_getDeviceSerial()      | @copybrief sf_configMgmt_getDeviceSerial()      |
+ *    | @ref sf_configMgmt_getMeasInterval()      | @copybrief sf_configMgmt_getMeasInterval()      |
+ *    | @ref sf_configMgmt_getDeviceAddr()        | @copybrief sf_configMgmt_getDeviceAddr()        |
+ *    | @ref sf_configMgmt_getGwAddr()            | @copybrief sf_configMgmt_getGwAddr()            |
+ *    | @ref sf_configMgmt_getPanId()             | @copybrief sf_configMgmt_getPanId()             |
+ *    | @ref sf_configMgmt_getChannelOffset()     | @copybrief sf_configMgmt_getChannelOffset()     |
  *  @{
  */
 
@@ -75,6 +81,8 @@ typedef struct
   linkaddr_t bmsccAddr;
   /*! Network ID. */
   uint16_t panId;
+  /*! Channel offset of the data slots assigned by the BMSCC. */
+  uint8_t channelOffset;
 } sf_deviceConfig_t;
 
 /*****************************************************************************/
@@ -86,7 +94,10 @@ typedef enum
   /*! Device disconnected from the network */
   E_CONFIGMGMT_DEVICESTATUS_NOT_CONNECTED,
   /*! Device connected to the network */
-  E_CONFIGMGMT_DEVICESTATUS_CONNECTED
+  E_CONFIGMGMT_DEVICESTATUS_CONNECTED,
+  /*! Device address and data slots assigned by a compact join response, the
+      join completes with the first ACKed data frame */
+  E_CONFIGMGMT_DEVICESTATUS_CONFIRMING
 } SF_GONFIGMGMT_DEVICESTATUS_t;
 
 /*! Binding configurations identifiers */
@@ -102,8 +113,20 @@ typedef enum
   E_CONFIGMGMT_PARAM_GW_ADDR,
   /*! Network ID */
   E_CONFIGMGMT_PARAM_PAN_ID,
+  /*! Data slot channel offset */
+  E_CONFIGMGMT_PARAM_CHANNEL_OFFSET,
+  /*! Number of parameters. New parameters are added before and get an entry
+      with a new TLV tag in the registry. */
+  E_CONFIGMGMT_PARAM_MAX
 } SF_CONFIGMGMT_PARAM_t;
 
+/*****************************************************************************/
+/*                         GLOBAL VARIABLES                                  */
+/*****************************************************************************/
+/*! SC configuration parameters. Read it with the typed accessors, it is only
+    changed with @ref sf_configMgmt_setParam. */
+extern sf_deviceConfig_t gDeviceConfig;
+
 /*****************************************************************************/
 /*                         API FUNCTIONS                                     */
 /*****************************************************************************/
@@ -183,6 +206,69 @@ void sf_configMgmt_setDeviceStatus(SF_GONFIGMGMT_DEVICESTATUS_t deviceStatus);
 /*============================================================================*/
 SF_GONFIGMGMT_DEVICESTATUS_t sf_configMgmt_getDeviceStatus(void);
 
+/*****************************************************************************/
+/*                         INLINE ACCESSORS                                  */
+/*****************************************************************************/
+/*============================================================================*/
+/**
+ * \brief Get the device serial number.
+ */
+/*============================================================================*/
+static inline uint32_t sf_configMgmt_getDeviceSerial(void)
+{
+  return gDeviceConfig.deviceSerial;
+}
+
+/*============================================================================*/
+/**
+ * \brief Get the measurement interval in seconds.
+ */
+/*============================================================================*/
+static inline uint32_t sf_configMgmt_getMeasInterval(void)
+{
+  return gDeviceConfig.measIntervalSec;
+}
+
+/*============================================================================*/
+/**
+ * \brief Get the SC short address.
+ */
+/*============================================================================*/
+static inline const linkaddr_t* sf_configMgmt_getDeviceAddr(void)
+{
+  return &gDeviceConfig.deviceAddr;
+}
+
+/*============================================================================*/
+/**
+ * \brief Get the BMS-CC short address.
+ */
+/*============================================================================*/
+static inline const linkaddr_t* sf_configMgmt_getGwAddr(void)
+{
+  return &gDeviceConfig.bmsccAddr;
+}
+
+/*============================================================================*/
+/**
+ * \brief Get the network ID.
+ */
+/*============================================================================*/
+static inline uint16_t sf_configMgmt_getPanId(void)
+{
+  return gDeviceConfig.panId;
+}
+
+/*============================================================================*/
+/**
+ * \brief Get the data slot channel offset.
+ */
+/*============================================================================*/
+static inline uint8_t sf_configMgmt_getChannelOffset(void)
+{
+  return gDeviceConfig.channelOffset;
+}
+
 /*! @} */
 
 #endif /* SF_CONFIGMGMT_H_ */
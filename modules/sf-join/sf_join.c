@@ -27,6 +27,7 @@ extern "C" {
 #include "sf_join.h"
 #include "sf_joinFramer.h"
 #include "sf_callbackHandler.h"
+#include "sf_tsch.h"
 /* Stack specific includes. */
 #include "net/nullnet/nullnet.h"
 #include "net/packetbuf.h"
@@ -176,7 +177,8 @@ static E_SF_RETURN_t loc_handleResponse(uint8_t *pRespFrame, uint16_t length)
   /* Return value. */
   E_SF_RETURN_t handleStatus = E_SF_SUCCESS;
 
-  if(!pRespFrame || SF_JOINFRAMER_RESPONSE_LENGTH != length)
+  if(!pRespFrame || (SF_JOINFRAMER_RESPONSE_LENGTH != length &&
+     SF_JOINFRAMER_RESPONSE_LENGTH_LEGACY != length))
   {
     return E_SF_ERROR_INVALID_PARAM;
   }
@@ -249,21 +251,57 @@ E_SF_RETURN_t sf_join_request_send(linkaddr_t *pDestinationAddr)
     LOG_INFO_BYTES(gpFrameBuffer, gFrameLen);
     LOG_INFO_("\n");
 
-    /* Set the max number of transmissions, 8 = 1 transmission and 7 retry. */
-    packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS, 8U);
+    /* Set the retransmission budget of the join request. */
+    sf_tsch_setTxPolicy(E_SF_TSCH_TRAFFIC_JOIN_REQUEST, pDestinationAddr, 0U);
     loc_sendFrame(pDestinationAddr);
-    /* Set the max number of transmissions, 1 = 1 transmission and 0 retry. */
-    packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS, 1U);
+    /* Back to a single transmission for other frames. */
+    sf_tsch_setTxPolicy(E_SF_TSCH_TRAFFIC_DEFAULT, pDestinationAddr, 0U);
   }
 
   return requestSent;
 }/* sf_join_request_send() */
 
+/*----------------------------------------------------------------------------*/
+/*! sf_join_compactRequest_send */
+/*----------------------------------------------------------------------------*/
+E_SF_RETURN_t sf_join_compactRequest_send(linkaddr_t *pDestinationAddr)
+{
+  /* Return value. */
+  E_SF_RETURN_t requestSent = E_SF_ERROR;
+
+  if(NULL == pDestinationAddr)
+  {
+    return E_SF_ERROR_INVALID_PARAM;
+  }
+
+  requestSent = sf_joinFramer_create_compactRequest(gpFrameBuffer);
+  gFrameLen = SF_JOINFRAMER_REQUEST_LENGTH;
+
+  /* Send compact join request. */
+  if(E_SF_SUCCESS == requestSent)
+  {
+    LOG_INFO("Tx compact JoinReq to ");
+    LOG_INFO_LLADDR(pDestinationAddr);
+    LOG_INFO_(" : ");
+    LOG_INFO_BYTES(gpFrameBuffer, gFrameLen);
+    LOG_INFO_("\n");
+
+    /* Set the retransmission budget of the join request. */
+    sf_tsch_setTxPolicy(E_SF_TSCH_TRAFFIC_JOIN_REQUEST, pDestinationAddr, 0U);
+    loc_sendFrame(pDestinationAddr);
+    /* Back to a single transmission for other frames. */
+    sf_tsch_setTxPolicy(E_SF_TSCH_TRAFFIC_DEFAULT, pDestinationAddr, 0U);
+  }
+
+  return requestSent;
+}/* sf_join_compactRequest_send() */
+
 /*----------------------------------------------------------------------------*/
 /*! sf_join_response_send */
 /*----------------------------------------------------------------------------*/
 E_SF_RETURN_t sf_join_response_send(linkaddr_t *pDestinationAddr,
-                                    linkaddr_t *pNewDeviceAddress)
+                                    linkaddr_t *pNewDeviceAddress,
+                                    uint8_t channelOffset)
 {
   /* Return value. */
   E_SF_RETURN_t responseSent = E_SF_SUCCESS;
@@ -273,7 +311,8 @@ E_SF_RETURN_t sf_join_response_send(linkaddr_t *pDestinationAddr,
     return E_SF_ERROR_INVALID_PARAM;
   }
 
-  responseSent = sf_joinFramer_create_response(gpFrameBuffer, pNewDeviceAddress);
+  responseSent = sf_joinFramer_create_response(gpFrameBuffer, pNewDeviceAddress,
+                                               channelOffset);
   gFrameLen = SF_JOINFRAMER_RESPONSE_LENGTH;
 
   if(E_SF_SUCCESS == responseSent)
@@ -290,6 +329,40 @@ E_SF_RETURN_t sf_join_response_send(linkaddr_t *pDestinationAddr,
   return responseSent;
 }/* sf_join_response_send() */
 
+/*----------------------------------------------------------------------------*/
+/*! sf_join_compactResponse_send */
+/*----------------------------------------------------------------------------*/
+E_SF_RETURN_t sf_join_compactResponse_send(linkaddr_t *pDestinationAddr,
+                                           linkaddr_t *pNewDeviceAddress,
+                                           uint8_t channelOffset)
+{
+  /* Return value. */
+  E_SF_RETURN_t responseSent = E_SF_SUCCESS;
+
+  if(NULL == pDestinationAddr || NULL == pNewDeviceAddress)
+  {
+    return E_SF_ERROR_INVALID_PARAM;
+  }
+
+  responseSent = sf_joinFramer_create_compactResponse(gpFrameBuffer,
+                                                      pNewDeviceAddress,
+                                                      channelOffset);
+  gFrameLen = SF_JOINFRAMER_RESPONSE_LENGTH;
+
+  if(E_SF_SUCCESS == responseSent)
+  {
+    LOG_INFO("Send compact JoinResponse message to ");
+    LOG_INFO_LLADDR(pDestinationAddr);
+    LOG_INFO_(" : ");
+    LOG_INFO_BYTES(gpFrameBuffer, SF_JOINFRAMER_RESPONSE_LENGTH);
+    LOG_INFO_("\n");
+
+    loc_sendFrame(pDestinationAddr);
+  }
+
+  return responseSent;
+}/* sf_join_compactResponse_send() */
+
 /*----------------------------------------------------------------------------*/
 /*! sf_join_successful_send */
 /*----------------------------------------------------------------------------*/
@@ -314,11 +387,11 @@ E_SF_RETURN_t sf_join_successful_send(linkaddr_t *pDestinationAddr)
     LOG_INFO_BYTES(gpFrameBuffer, gFrameLen);
     LOG_INFO_("\n");
 
-    /* Set the max number of transmissions, 8 = 1 transmission and 7 retry. */
-    packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS, 8U);
+    /* Set the retransmission budget of the join frames. */
+    sf_tsch_setTxPolicy(E_SF_TSCH_TRAFFIC_JOIN, pDestinationAddr, 0U);
     loc_sendFrame(pDestinationAddr);
-    /* Set the max number of transmissions, 1 = 1 transmission and 0 retry. */
-    packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS, 1U);
+    /* Back to a single transmission for other frames. */
+    sf_tsch_setTxPolicy(E_SF_TSCH_TRAFFIC_DEFAULT, pDestinationAddr, 0U);
   }
 
   return E_SF_SUCCESS;
@@ -346,11 +419,13 @@ E_SF_RETURN_t sf_join_handleFrame(uint8_t* pInBuf, uint16_t length,
     switch(frameType)
     {
       case E_FRAME_TYPE_REQUEST:
+      case E_FRAME_TYPE_REQUEST_COMPACT:
         LOG_INFO("Received join request frame;\n ");
         handleStatus = loc_handleRequest(pInBuf, length, pSrcAddr);
         break;
 
       case E_FRAME_TYPE_RESPONSE:
+      case E_FRAME_TYPE_RESPONSE_COMPACT:
         LOG_INFO("Received join response frame;\n ");
         handleStatus = loc_handleResponse(pInBuf, length);
         break;
@@ -48,18 +48,49 @@ extern "C" {
 /*============================================================================*/
 E_SF_RETURN_t sf_join_request_send(linkaddr_t *pDestinationAddr);
 
+/*============================================================================*/
+/**
+ * \brief Send-out a compact join request frame. The gateway answers with a
+ *        compact join response if it supports the two-message handshake.
+ *
+ * \param pDestinationAddr       Pointer to the destination address.
+ *
+ * \return @ref E_SF_RETURN_t.
+ */
+/*============================================================================*/
+E_SF_RETURN_t sf_join_compactRequest_send(linkaddr_t *pDestinationAddr);
+
 /*============================================================================*/
 /**
  * \brief Send-out a join response frame to the giver address.
  *
  * \param pDestinationAddr       Pointer to the destination address.
  * \param pNewDeviceAddress      Pointer to the assigned address.
+ * \param channelOffset          Assigned channel offset of the data slots.
  *
  * \return @ref E_SF_RETURN_t.
  */
 /*============================================================================*/
 E_SF_RETURN_t sf_join_response_send(linkaddr_t *pDestinationAddr,
-                                    linkaddr_t *pNewDeviceAddress);
+                                    linkaddr_t *pNewDeviceAddress,
+                                    uint8_t channelOffset);
+
+/*============================================================================*/
+/**
+ * \brief Send-out a compact join response frame to the given address. The
+ *        gateway considers the device joined on the first data frame
+ *        received from the assigned address, no join successful follows.
+ *
+ * \param pDestinationAddr       Pointer to the destination address.
+ * \param pNewDeviceAddress      Pointer to the assigned address.
+ * \param channelOffset          Assigned channel offset of the data slots.
+ *
+ * \return @ref E_SF_RETURN_t.
+ */
+/*============================================================================*/
+E_SF_RETURN_t sf_join_compactResponse_send(linkaddr_t *pDestinationAddr,
+                                           linkaddr_t *pNewDeviceAddress,
+                                           uint8_t channelOffset);
 
 /*============================================================================*/
 /**
@@ -75,8 +106,8 @@ E_SF_RETURN_t sf_join_successful_send(linkaddr_t *pDestinationAddr);
 /*============================================================================*/
 /**
  * \brief Handle join frame. The frame can be one of the following:
- *          - join request
- *          - join response
+ *          - join request or compact join request
+ *          - join response or compact join response
  *          - join successful
  *
  * \param pInBuf        Pointer to the frame.
@@ -95,7 +126,9 @@ E_SF_RETURN_t sf_join_handleFrame(uint8_t* pInBuf, uint16_t length,
 /*============================================================================*/
 /**
  * @brief Informs the upper layer about new join request reception.
- *        This function is implemented by the application.
+ *        This function is implemented by the application. A request with
+ *        @ref joinRequest_t.compact set should be answered with
+ *        @ref sf_join_compactResponse_send().
  *
  * @param	pSrcAddr Pointer to received frame source address.
  */
@@ -0,0 +1,84 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Implementation of the join request backoff.
+*/
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Stack include */
+#include "contiki.h"
+#include "lib/random.h"
+/* Application include */
+#include "project-conf.h"
+#include "sf_joinBackoff.h"
+
+/*==============================================================================
+                      API FUNCTION IMPLEMENTATION
+==============================================================================*/
+/*------------------------------------------------------------------------------
+  sf_joinBackoff_init()
+------------------------------------------------------------------------------*/
+void sf_joinBackoff_init(sf_joinBackoff_t *pBackoff, uint32_t serial)
+{
+  pBackoff->slot = (uint8_t)(serial % APP_SLOTFRAME_SECTION_JOIN_REQUEST_SLOTS);
+  pBackoff->exp = 0;
+}/* sf_joinBackoff_init() */
+
+/*------------------------------------------------------------------------------
+  sf_joinBackoff_failed()
+------------------------------------------------------------------------------*/
+void sf_joinBackoff_failed(sf_joinBackoff_t *pBackoff)
+{
+  if(pBackoff->exp < SF_JOIN_BACKOFF_MAX_EXP)
+  {
+    pBackoff->exp++;
+  }
+
+  if(APP_SLOTFRAME_SECTION_JOIN_REQUEST_SLOTS > 1)
+  {
+    pBackoff->slot = (pBackoff->slot + 1 + random_rand() %
+                      (APP_SLOTFRAME_SECTION_JOIN_REQUEST_SLOTS - 1)) %
+                     APP_SLOTFRAME_SECTION_JOIN_REQUEST_SLOTS;
+  }
+}/* sf_joinBackoff_failed() */
+
+/*------------------------------------------------------------------------------
+  sf_joinBackoff_getRetryTime()
+------------------------------------------------------------------------------*/
+clock_time_t sf_joinBackoff_getRetryTime(const sf_joinBackoff_t *pBackoff,
+                                         uint8_t congestion)
+{
+  /* Exponent including the congestion level. Added in a wider type, the
+     congestion level is taken from the beacon as is. */
+  uint16_t exp = (uint16_t)pBackoff->exp + congestion;
+  /* Backoff window. */
+  clock_time_t window;
+
+  if(exp > SF_JOIN_BACKOFF_MAX_EXP)
+  {
+    exp = SF_JOIN_BACKOFF_MAX_EXP;
+  }
+
+  window = ((1U << exp) - 1U) * SF_JOIN_RETRY_TX_TIME;
+
+  return SF_JOIN_RETRY_TX_TIME + random_rand() % (window + 1U);
+}/* sf_joinBackoff_getRetryTime() */
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,110 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Backoff of the join requests.
+
+ @details Each device sends its join requests in one of the join request
+          slots of the section, the first one derived from its serial. A
+          request dropped by the MAC moves the device to a random other slot
+          and doubles its retry window. The retry time is one retry period
+          plus a random share of the window, which is widened further by the
+          congestion level the time source signals in its beacons.
+*/
+
+#ifndef __SF_JOIN_BACKOFF_H__
+#define __SF_JOIN_BACKOFF_H__
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdint.h>
+/* Stack include */
+#include "contiki.h"
+
+/*==============================================================================
+                            MACROS
+==============================================================================*/
+/* The join frame retransmit time */
+#ifndef SF_JOIN_CONF_RETRY_TX_TIME
+#define SF_JOIN_RETRY_TX_TIME      (3 * CLOCK_SECOND)
+#else
+#define SF_JOIN_RETRY_TX_TIME      (SF_JOIN_CONF_RETRY_TX_TIME * CLOCK_SECOND)
+#endif
+/* Maximum exponent of the join request backoff window. The window is
+   (2^exp - 1) retry times, exp grows with each failed request and with the
+   congestion level signaled in the beacons. */
+#ifndef SF_JOIN_CONF_BACKOFF_MAX_EXP
+#define SF_JOIN_BACKOFF_MAX_EXP    (5U)
+#else
+#define SF_JOIN_BACKOFF_MAX_EXP    SF_JOIN_CONF_BACKOFF_MAX_EXP
+#endif
+
+/*==============================================================================
+                            STRUCTS
+==============================================================================*/
+/*! Join request backoff of a device. */
+typedef struct
+{
+  /*! Join request slot of the section used by the device. */
+  uint8_t slot;
+  /*! Exponent of the retry window. */
+  uint8_t exp;
+} sf_joinBackoff_t;
+
+/*==============================================================================
+                            FUNCTION PROTOTYPES
+==============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Start the backoff of a join. The slot is derived from the serial
+ *        directly, the window is closed.
+ *
+ * \param pBackoff      Backoff to start.
+ * \param serial        Serial number of the device.
+ */
+/*============================================================================*/
+void sf_joinBackoff_init(sf_joinBackoff_t *pBackoff, uint32_t serial);
+
+/*============================================================================*/
+/**
+ * \brief Back off after a join request dropped by the MAC. The window is
+ *        doubled and a random other join request slot is taken, the last
+ *        one is likely shared with another device.
+ *
+ * \param pBackoff      Backoff of the device.
+ */
+/*============================================================================*/
+void sf_joinBackoff_failed(sf_joinBackoff_t *pBackoff);
+
+/*============================================================================*/
+/**
+ * \brief Get the time until the next join request.
+ *
+ * \param pBackoff      Backoff of the device.
+ * \param congestion    Join congestion level of the time source.
+ *
+ * \return One retry period plus a random share of the window.
+ */
+/*============================================================================*/
+clock_time_t sf_joinBackoff_getRetryTime(const sf_joinBackoff_t *pBackoff,
+                                         uint8_t congestion);
+
+#endif /* __SF_JOIN_BACKOFF_H__ */
+
+#ifdef __cplusplus
+}
+#endif
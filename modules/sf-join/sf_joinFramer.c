@@ -86,8 +86,8 @@ E_SF_RETURN_t sf_joinFramer_create_request(uint8_t* pOutBuf)
   if(E_SF_SUCCESS == requestCreated)
   {
     requestCreated = sf_frameType_set(pOutBuf, E_FRAME_TYPE_REQUEST);
-    memcpy(pOutBuf + SF_FRAME_TYPE_LEN, &gJoinReqParams,
-           sizeof(gJoinReqParams));
+    memcpy(pOutBuf + SF_FRAME_TYPE_LEN, &gJoinReqParams.serialNumber,
+           SF_JOINFRAMER_SERIALNUMBER_LENGTH);
   }
 
   return requestCreated;
@@ -97,7 +97,8 @@ E_SF_RETURN_t sf_joinFramer_create_request(uint8_t* pOutBuf)
 /*! sf_joinFramer_create_response */
 /*----------------------------------------------------------------------------*/
 E_SF_RETURN_t sf_joinFramer_create_response(uint8_t* pOutBuf,
-                                            linkaddr_t *pNewDeviceAddress)
+                                            linkaddr_t *pNewDeviceAddress,
+                                            uint8_t channelOffset)
 {
   /* Return value. */
   E_SF_RETURN_t responseCreated = E_SF_SUCCESS;
@@ -108,15 +109,53 @@ E_SF_RETURN_t sf_joinFramer_create_response(uint8_t* pOutBuf,
   }
 
   gJoinRespParams.deviceId = pNewDeviceAddress->u16;
+  gJoinRespParams.channelOffset = channelOffset;
 
   responseCreated = sf_frameType_set(pOutBuf, E_FRAME_TYPE_RESPONSE);
 
-  memcpy(pOutBuf + SF_FRAME_TYPE_LEN, (uint8_t*)&gJoinRespParams,
-        sizeof(gJoinRespParams));
+  memcpy(pOutBuf + SF_FRAME_TYPE_LEN, (uint8_t*)&gJoinRespParams.deviceId,
+        SF_JOINFRAMER_SHORTADDR_LENGTH);
+  pOutBuf[SF_FRAME_TYPE_LEN + SF_JOINFRAMER_SHORTADDR_LENGTH] = channelOffset;
 
   return responseCreated;
 }/* sf_joinFramer_create_response() */
 
+/*----------------------------------------------------------------------------*/
+/*! sf_joinFramer_create_compactRequest */
+/*----------------------------------------------------------------------------*/
+E_SF_RETURN_t sf_joinFramer_create_compactRequest(uint8_t* pOutBuf)
+{
+  /* The compact request only differs in the frame type. */
+  E_SF_RETURN_t requestCreated = sf_joinFramer_create_request(pOutBuf);
+
+  if(E_SF_SUCCESS == requestCreated)
+  {
+    requestCreated = sf_frameType_set(pOutBuf, E_FRAME_TYPE_REQUEST_COMPACT);
+  }
+
+  return requestCreated;
+}/* sf_joinFramer_create_compactRequest() */
+
+/*----------------------------------------------------------------------------*/
+/*! sf_joinFramer_create_compactResponse */
+/*----------------------------------------------------------------------------*/
+E_SF_RETURN_t sf_joinFramer_create_compactResponse(uint8_t* pOutBuf,
+                                                   linkaddr_t *pNewDeviceAddress,
+                                                   uint8_t channelOffset)
+{
+  /* The compact response only differs in the frame type. */
+  E_SF_RETURN_t responseCreated = sf_joinFramer_create_response(pOutBuf,
+                                                                pNewDeviceAddress,
+                                                                channelOffset);
+
+  if(E_SF_SUCCESS == responseCreated)
+  {
+    responseCreated = sf_frameType_set(pOutBuf, E_FRAME_TYPE_RESPONSE_COMPACT);
+  }
+
+  return responseCreated;
+}/* sf_joinFramer_create_compactResponse() */
+
 /*----------------------------------------------------------------------------*/
 /*! sf_joinFramer_create_successful */
 /*----------------------------------------------------------------------------*/
@@ -139,14 +178,21 @@ E_SF_RETURN_t sf_joinFramer_create_successful(uint8_t* pOutBuf)
 /*----------------------------------------------------------------------------*/
 E_SF_RETURN_t sf_joinFramer_parse_request(uint8_t *pInBuf, uint16_t length)
 {
+  /* Frame type of the request. */
+  E_FRAME_TYPE_t frameType = E_FRAME_TYPE_UNDEFINED;
+
   if((NULL == pInBuf) || (SF_JOINFRAMER_REQUEST_LENGTH != length))
   {
     return E_SF_ERROR_INVALID_PARAM;
   }
 
+  sf_frameType_get(pInBuf, &frameType);
+  gJoinReqParams.compact = (E_FRAME_TYPE_REQUEST_COMPACT == frameType);
+
   pInBuf += SF_FRAME_TYPE_LEN;
 
-  memcpy((uint8_t*)&gJoinReqParams, pInBuf, length);
+  memcpy((uint8_t*)&gJoinReqParams.serialNumber, pInBuf,
+         SF_JOINFRAMER_SERIALNUMBER_LENGTH);
 
   return E_SF_SUCCESS;
 }/* sf_joinFramer_parse_request() */
@@ -157,16 +203,29 @@ E_SF_RETURN_t sf_joinFramer_parse_request(uint8_t *pInBuf, uint16_t length)
 E_SF_RETURN_t sf_joinFramer_parse_response(uint8_t *pInBuf, uint16_t length)
 {
   E_SF_RETURN_t responseParsed = E_SF_SUCCESS;
+  /* Frame type of the response. */
+  E_FRAME_TYPE_t frameType = E_FRAME_TYPE_UNDEFINED;
 
-  if((NULL == pInBuf) || (SF_JOINFRAMER_RESPONSE_LENGTH != length))
+  if((NULL == pInBuf) || ((SF_JOINFRAMER_RESPONSE_LENGTH != length) &&
+     (SF_JOINFRAMER_RESPONSE_LENGTH_LEGACY != length)))
   {
     return E_SF_ERROR_INVALID_PARAM;
   }
 
+  sf_frameType_get(pInBuf, &frameType);
+  gJoinRespParams.compact = (E_FRAME_TYPE_RESPONSE_COMPACT == frameType);
+
   pInBuf += SF_FRAME_TYPE_LEN;
 
   gJoinRespParams.deviceId = UINT8_TO_UINT16(pInBuf);
 
+  /* A BMSCC without channel offset support keeps all cells on offset 0. */
+  gJoinRespParams.channelOffset = 0;
+  if(SF_JOINFRAMER_RESPONSE_LENGTH == length)
+  {
+    gJoinRespParams.channelOffset = pInBuf[SF_JOINFRAMER_SHORTADDR_LENGTH];
+  }
+
   return responseParsed;
 }/* sf_joinFramer_parse_response() */
 
@@ -23,6 +23,10 @@ extern "C" {
     + Join request frame
     + Join response frame
     + Join successful frame
+    + Compact join request and response frames. They carry the same
+      parameters as the request and response frames. With the compact
+      handshake, the join successful frame is replaced by the ACK of the
+      first data frame sent from the assigned address.
  In addition to that, this module can parse all kind of frames mentioned above.
  The parsed data will be formatted into struct data type.
     + @ref joinRequest_t
@@ -54,10 +58,19 @@ extern "C" {
             = 4 + 1 = 5 */
 #define SF_JOINFRAMER_REQUEST_LENGTH             SF_JOINFRAMER_SERIALNUMBER_LENGTH + \
                                                  SF_FRAME_TYPE_LEN
+/* Channel offset length */
+#define SF_JOINFRAMER_CHANNELOFFSET_LENGTH       (1U)
 /* Length of join response frame.
+    resp len = assigned device address + channel offset + frame type field.
+             = 2 + 1 + 1 = 4 */
+#define SF_JOINFRAMER_RESPONSE_LENGTH            SF_JOINFRAMER_SHORTADDR_LENGTH + \
+                                                 SF_JOINFRAMER_CHANNELOFFSET_LENGTH + \
+                                                 SF_FRAME_TYPE_LEN
+/* Length of join response frame sent by a BMSCC without channel offset
+   support. The channel offset 0 is assumed in that case.
     resp len = assigned device address + frame type field.
              = 2 + 1 = 3 */
-#define SF_JOINFRAMER_RESPONSE_LENGTH            SF_JOINFRAMER_SHORTADDR_LENGTH + \
+#define SF_JOINFRAMER_RESPONSE_LENGTH_LEGACY     SF_JOINFRAMER_SHORTADDR_LENGTH + \
                                                  SF_FRAME_TYPE_LEN
 /* Length of join successful frame.
     succ len = frame type field.
@@ -76,6 +89,8 @@ typedef struct
 {
   /*! Device serial number */
   uint32_t serialNumber;
+  /*! True if the request asks for the compact handshake. */
+  bool compact;
 } joinRequest_t;
 
 /*! Store the join response frame parameters. */
@@ -83,6 +98,10 @@ typedef struct
 {
   /*! Store the assigned id to the joined device. */
   uint16_t deviceId;
+  /*! Store the assigned channel offset of the data slots. */
+  uint8_t channelOffset;
+  /*! True if the data slots are confirmed (compact handshake). */
+  bool compact;
 } joinResponse_t;
 
 /*==============================================================================
@@ -105,12 +124,40 @@ E_SF_RETURN_t sf_joinFramer_create_request(uint8_t* pOutBuf);
  *
  * \param pOutBuf              Pointer to the join response frame.
  * \param pNewDeviceAddress    Pointer to the assigned address.
+ * \param channelOffset        Assigned channel offset of the data slots.
  *
  * \return @ref E_SF_RETURN_t.
  */
 /*============================================================================*/
 E_SF_RETURN_t sf_joinFramer_create_response(uint8_t* pOutBuf,
-                                            linkaddr_t *pNewDeviceAddress);
+                                            linkaddr_t *pNewDeviceAddress,
+                                            uint8_t channelOffset);
+
+/*============================================================================*/
+/**
+ * \brief Create a compact join request frame.
+ *
+ * \param pOutBuf             Pointer to the compact join request frame.
+ *
+ * \return @ref E_SF_RETURN_t.
+ */
+/*============================================================================*/
+E_SF_RETURN_t sf_joinFramer_create_compactRequest(uint8_t* pOutBuf);
+
+/*============================================================================*/
+/**
+ * \brief Create a compact join response frame.
+ *
+ * \param pOutBuf              Pointer to the compact join response frame.
+ * \param pNewDeviceAddress    Pointer to the assigned address.
+ * \param channelOffset        Assigned channel offset of the data slots.
+ *
+ * \return @ref E_SF_RETURN_t.
+ */
+/*============================================================================*/
+E_SF_RETURN_t sf_joinFramer_create_compactResponse(uint8_t* pOutBuf,
+                                                   linkaddr_t *pNewDeviceAddress,
+                                                   uint8_t channelOffset);
 
 /*============================================================================*/
 /**
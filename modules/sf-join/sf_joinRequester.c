@@ -27,6 +27,8 @@ extern "C" {
 #include "sf-tsch-schedule.h"
 #endif
 #include "sys/log.h"
+#include "lib/random.h"
+#include <string.h>
 /* Application specific includes */
 #include "project-conf.h"
 #include "sf_join.h"
@@ -35,9 +37,12 @@ extern "C" {
 #include "sf_stateManager.h"
 #include "sf_configMgmt.h"
 #include "sf_tsch.h"
+#include "sf_txPower.h"
 #include "sf_led.h"
 #include "sf_beaconScan.h"
 #include "sf_app_api.h"
+#include "sf_persistentDataStorage.h"
+#include "sf_joinBackoff.h"
 
 /*=============================================================================
                                 MACROS
@@ -57,12 +62,6 @@ extern "C" {
 /*============================================================================*/
 #define UINT16_TO_UINT8(x, y)  ((x)[0] = (uint8_t)((uint8_t)((y)>>8U) & 0xFFU)); \
                                ((x)[1] = (uint8_t)((y) & 0xFFU))
-/* The join frame retransmit time */
-#ifndef SF_JOIN_CONF_RETRY_TX_TIME
-#define SF_JOIN_RETRY_TX_TIME      (3 * CLOCK_SECOND)
-#else
-#define SF_JOIN_RETRY_TX_TIME      (SF_JOIN_CONF_RETRY_TX_TIME * CLOCK_SECOND)
-#endif
 /* Timeout for join request Tx state */
 #define SF_JOIN_REQ_TIMEOUT        (120 * CLOCK_SECOND)
 /* Timeout for join response Rx state */
@@ -72,10 +71,62 @@ extern "C" {
 /* Overall join process timeout. */
 #define SF_JOIN_TIMEOUT            SF_JOIN_REQ_TIMEOUT + SF_JOIN_RESP_TIMEOUT +\
                                    SF_JOIN_SUCC_TIMEOUT
+/* Use the two-message handshake. The request carries the serial, the
+   response assigns the address and the data slots. The first ACKed data frame
+   completes the join. Falls back to the three-message handshake if the
+   gateway does not answer the compact request. Off until the gateways
+   answer E_FRAME_TYPE_REQUEST_COMPACT, each join would wait for the
+   fallback timeout otherwise. */
+#ifndef SF_JOIN_CONF_COMPACT_HANDSHAKE
+#define SF_JOIN_COMPACT_HANDSHAKE  (0U)
+#else
+#define SF_JOIN_COMPACT_HANDSHAKE  SF_JOIN_CONF_COMPACT_HANDSHAKE
+#endif
+/* Timeout for a compact join response before falling back to the
+   three-message handshake. */
+#define SF_JOIN_COMPACT_RESP_TIMEOUT (30 * CLOCK_SECOND)
+/* Number of data frames without ACK after which a compact join fails. A
+   failed join costs a rejoin backoff and a beacon scan, so the budget
+   matches the transmissions of the join frames. */
+#ifndef SF_JOIN_CONF_CONFIRM_ATTEMPTS
+#define SF_JOIN_CONFIRM_ATTEMPTS   (8U)
+#else
+#define SF_JOIN_CONFIRM_ATTEMPTS   SF_JOIN_CONF_CONFIRM_ATTEMPTS
+#endif
 /* Define the number of the join states. */
-#define SF_JOIN_STATES_COUNT       (3U)
-/* Defines rejoin retry interval. */
-#define SF_JOIN_REJOIN_INTERVAL    (5 * 60 * CLOCK_SECOND)
+#define SF_JOIN_STATES_COUNT       (4U)
+/* Defines the first and the maximum rejoin retry interval. The interval
+   doubles with each failed beacon scan, each device waits a random time
+   between half and the full interval. */
+#ifndef SF_JOIN_CONF_REJOIN_MIN_INTERVAL
+#define SF_JOIN_REJOIN_MIN_INTERVAL (10 * CLOCK_SECOND)
+#else
+#define SF_JOIN_REJOIN_MIN_INTERVAL (SF_JOIN_CONF_REJOIN_MIN_INTERVAL * CLOCK_SECOND)
+#endif
+#define SF_JOIN_REJOIN_MAX_INTERVAL (5 * 60 * CLOCK_SECOND)
+/* Duration of the passive listening for the last time source between two
+   beacon scans. The listening covers one slotframe, one beacon is sent per
+   slotframe (~3.2 s). */
+#define SF_JOIN_PASSIVE_LISTEN_TIME (4 * CLOCK_SECOND)
+/* The passive listening runs once in the middle of a rejoin retry interval,
+   so its period grows with the rejoin backoff. It is skipped for intervals
+   shorter than SF_JOIN_PASSIVE_DUTY_DIV listening times, which bounds the
+   radio on time to 1/SF_JOIN_PASSIVE_DUTY_DIV. The short intervals at the
+   start of the backoff are covered by the beacon scans. */
+#ifndef SF_JOIN_CONF_PASSIVE_DUTY_DIV
+#define SF_JOIN_PASSIVE_DUTY_DIV   (16U)
+#else
+#define SF_JOIN_PASSIVE_DUTY_DIV   SF_JOIN_CONF_PASSIVE_DUTY_DIV
+#endif
+/* Time to listen for the stored time source on a warm start before falling
+   back to the beacon scan. One beacon is sent per slotframe (~3.2 s). */
+#ifndef SF_JOIN_CONF_WARM_LISTEN_TIME
+#define SF_JOIN_WARM_LISTEN_TIME   (15 * CLOCK_SECOND)
+#else
+#define SF_JOIN_WARM_LISTEN_TIME   (SF_JOIN_CONF_WARM_LISTEN_TIME * CLOCK_SECOND)
+#endif
+/* Interval to check the association during the warm start listening. */
+#define SF_JOIN_WARM_POLL_TIME     (CLOCK_SECOND / 8)
 
 /*=============================================================================
                                 ENUMS
@@ -88,7 +139,9 @@ typedef enum
   /* Join response reception state. */
   E_JOIN_STATE_RESP_RX,
   /* Join successful transmission state. */
-  E_JOIN_STATE_SUCC_TX
+  E_JOIN_STATE_SUCC_TX,
+  /* Wait for the ACK of the first data frame (compact handshake). */
+  E_JOIN_STATE_CONFIRM
 } E_JOIN_STATE_t;
 
 /*=============================================================================
@@ -97,6 +150,14 @@ typedef enum
 static void loc_txJoinRequest(void);
 static void loc_rxJoinResponse(void);
 static void loc_txJoinSuccessful(void);
+static void loc_waitJoinConfirm(void);
+static void loc_abortJoinConfirm(void);
+static void loc_storeJoinConfig(void);
+static bool loc_loadSyncContext(void);
+static void loc_storeSyncContext(void);
+static uint32_t loc_seedRandom(void);
+static clock_time_t loc_getRejoinTime(void);
+static void loc_joinBackoff(void);
 
 /*=============================================================================
                                 GLOBAL VARIABLES
@@ -127,12 +188,31 @@ static struct etimer gJoinSuccessfulTimer;
 static struct ctimer gJoinResponseTimer;
 /* Overall join process timer. */
 static struct ctimer gJoinTimer;
+/* True while the compact handshake is used. */
+static bool gCompact = false;
+/* True if the joins start with the compact handshake. */
+static bool gCompactEnabled = SF_JOIN_COMPACT_HANDSHAKE;
+/* True while waiting for the ACK of the first data frame. */
+static bool gConfirmPending = false;
+/* Number of data frames not ACKed while waiting for the join confirmation. */
+static uint8_t gConfirmFailures = 0;
+/* Join request backoff of this device. */
+static sf_joinBackoff_t gJoinBackoff;
+/* Exponent of the rejoin retry interval. */
+static uint8_t gRejoinBackoffExp = 0;
+/* Synchronization context of the last association. */
+static sf_persistent_syncContext_t gSyncContext;
+/* True if gSyncContext belongs to the joined network. */
+static bool gSyncContextValid = false;
+/* Duration of the listening for the last time source. */
+static clock_time_t gListenTime = 0;
 /* Array of state-manager states. */
 static stateManager_state_t gpStates[] =
 {
   {E_JOIN_STATE_REQ_TX, &loc_txJoinRequest},
   {E_JOIN_STATE_RESP_RX, &loc_rxJoinResponse},
-  {E_JOIN_STATE_SUCC_TX, &loc_txJoinSuccessful}
+  {E_JOIN_STATE_SUCC_TX, &loc_txJoinSuccessful},
+  {E_JOIN_STATE_CONFIRM, &loc_waitJoinConfirm}
 };
 
 /*=============================================================================
@@ -143,7 +223,9 @@ PROCESS(rejoin_process, "Rejoin process");
 PROCESS(handshake_process, "Handshake process");
 PROCESS(request_tx_process, "Req Tx process");
 PROCESS(successful_tx_process, "Succ Tx process");
+PROCESS(join_retry_process, "Join retry process");
 PT_THREAD(beacon_scan_process(struct pt *pt));
+static PT_THREAD(sync_listen_process(struct pt *pt));
 
 /*=============================================================================
                           LOCAL FUNCTION IMPLEMENTATION
@@ -174,13 +256,31 @@ static void loc_join_timeout_callback(void * ptr)
   process_post(&manaul_join_process, PROCESS_EVENT_CONTINUE, NULL);
 } /* loc_join_timeout_callback() */
 
+/*------------------------------------------------------------------------------
+  loc_compact_timeout_callback()
+------------------------------------------------------------------------------*/
+static void loc_compact_timeout_callback(void * ptr)
+{
+  LOG_INFO("No compact join response; Use legacy handshake\n");
+
+  gCompact = false;
+
+  /* Remove the join process slots from the schedule. */
+  sf_tsch_schedule_delete_jproc_slots(NULL);
+
+  /* Send a join request again. */
+  sf_stateManager_setState(&gJoinStateCtx, (uint8_t)E_JOIN_STATE_REQ_TX);
+  sf_stateManager_execState(&gJoinStateCtx);
+} /* loc_compact_timeout_callback() */
+
 /*------------------------------------------------------------------------------
   loc_txJoinRequest()
 ------------------------------------------------------------------------------*/
 static void loc_txJoinRequest( void )
 {
-  /* Schedule join request slots. */
-  sf_tsch_schedule_add_jreq_slots();
+  /* Schedule the join request slot of this device. */
+  sf_joinBackoff_init(&gJoinBackoff, loc_seedRandom());
+  sf_tsch_schedule_add_jreq_slot(gJoinBackoff.slot);
 
   /* Start state timeout. */
   etimer_set(&gJoinRequestTimer, SF_JOIN_REQ_TIMEOUT);
@@ -201,13 +301,52 @@ static void loc_txJoinSuccessful(void)
   process_start(&successful_tx_process, NULL);
 }/* loc_txJoinSuccessful() */
 
+/*------------------------------------------------------------------------------
+  loc_waitJoinConfirm()
+------------------------------------------------------------------------------*/
+static void loc_waitJoinConfirm(void)
+{
+  gConfirmFailures = 0;
+  gConfirmPending = true;
+
+  LOG_INFO("Wait for the first data frame ACK\n");
+}/* loc_waitJoinConfirm() */
+
+/*------------------------------------------------------------------------------
+  loc_abortJoinConfirm()
+------------------------------------------------------------------------------*/
+static void loc_abortJoinConfirm(void)
+{
+  LOG_ERR("!Join not confirmed\n");
+
+  gConfirmPending = false;
+  sf_tsch_schedule_delete_data_slots((const linkaddr_t*)&linkaddr_node_addr);
+  sf_configMgmt_setDeviceStatus(E_CONFIGMGMT_DEVICESTATUS_NOT_CONNECTED);
+
+  /* Nothing is stored. Leave the network and start over with a new join
+     after the rejoin backoff. */
+  if(process_is_running(&join_retry_process))
+  {
+    process_exit(&join_retry_process);
+  }
+  process_start(&join_retry_process, NULL);
+}/* loc_abortJoinConfirm() */
+
 /*------------------------------------------------------------------------------
   loc_rxJoinResponse()
 ------------------------------------------------------------------------------*/
 static void loc_rxJoinResponse(void)
 {
   /* Start join state timeout. */
-  ctimer_set(&gJoinResponseTimer, SF_JOIN_RESP_TIMEOUT, loc_join_timeout_callback, NULL);
+  if(gCompact)
+  {
+    ctimer_set(&gJoinResponseTimer, SF_JOIN_COMPACT_RESP_TIMEOUT,
+               loc_compact_timeout_callback, NULL);
+  }
+  else
+  {
+    ctimer_set(&gJoinResponseTimer, SF_JOIN_RESP_TIMEOUT, loc_join_timeout_callback, NULL);
+  }
 
   /* Open join process slots to the gw. */
   sf_tsch_schedule_add_jproc_slots((const linkaddr_t*)gpDestinationAddress);
@@ -215,6 +354,173 @@ static void loc_rxJoinResponse(void)
   LOG_INFO("Wait for resp Rx\n");
 }/* loc_rxJoinResponse() */
 
+/*------------------------------------------------------------------------------
+  loc_storeJoinConfig()
+------------------------------------------------------------------------------*/
+static void loc_storeJoinConfig(void)
+{
+  /* Store device configuration.  */
+  uint16_t panId = frame802154_get_pan_id();
+  LOG_INFO("Set PAN ID of device to 0x%04x\n", panId);
+
+  /* Set communication params */
+  sf_configMgmt_setParam(&panId, sizeof(panId), E_CONFIGMGMT_PARAM_PAN_ID);
+  sf_configMgmt_setParam(linkaddr_node_addr.u8, sizeof(linkaddr_node_addr.u8),
+                          E_CONFIGMGMT_PARAM_DEVICE_ADDR);
+  sf_configMgmt_setParam(gpDestinationAddress->u8, sizeof(gpDestinationAddress->u8),
+                          E_CONFIGMGMT_PARAM_GW_ADDR);
+  uint8_t channelOffset = (uint8_t)sf_tsch_schedule_get_data_channel_offset();
+  sf_configMgmt_setParam(&channelOffset, sizeof(channelOffset),
+                          E_CONFIGMGMT_PARAM_CHANNEL_OFFSET);
+  sf_configMgmt_writeConfig();
+  /* Keep the sync context for the next warm start. */
+  loc_storeSyncContext();
+  /* A failed join retries after the shortest interval again. */
+  gRejoinBackoffExp = 0;
+
+  LOG_INFO("Device joined NW successfully; New device ID; ");
+  LOG_INFO_LLADDR(&linkaddr_node_addr);
+  LOG_INFO_("\n");
+}/* loc_storeJoinConfig() */
+
+/*------------------------------------------------------------------------------
+  loc_seedRandom()
+------------------------------------------------------------------------------*/
+static uint32_t loc_seedRandom(void)
+{
+  /* Set once the random generator is seeded. */
+  static bool seeded = false;
+  /* Serial number of the device. */
+  uint32_t serial = 0;
+
+  sf_configMgmt_getParam(&serial, sizeof(serial), E_CONFIGMGMT_PARAM_DEVICE_SERIAL);
+
+  /* Devices of a pack are powered up at the same time. Seeding with the
+     serial keeps their random choices apart. */
+  if(!seeded)
+  {
+    random_init((unsigned short)(serial ^ (serial >> 16)));
+    seeded = true;
+  }
+
+  return serial;
+}/* loc_seedRandom() */
+
+/*------------------------------------------------------------------------------
+  loc_getRejoinTime()
+------------------------------------------------------------------------------*/
+static clock_time_t loc_getRejoinTime(void)
+{
+  /* Rejoin retry interval. */
+  clock_time_t interval = SF_JOIN_REJOIN_MIN_INTERVAL << gRejoinBackoffExp;
+
+  loc_seedRandom();
+
+  if(interval >= SF_JOIN_REJOIN_MAX_INTERVAL)
+  {
+    interval = SF_JOIN_REJOIN_MAX_INTERVAL;
+  }
+  else
+  {
+    gRejoinBackoffExp++;
+  }
+
+  /* Spread the devices that lost the network at the same time. */
+  return interval / 2 + random_rand() % (interval / 2 + 1);
+}/* loc_getRejoinTime() */
+
+/*------------------------------------------------------------------------------
+  loc_joinBackoff()
+------------------------------------------------------------------------------*/
+static void loc_joinBackoff(void)
+{
+  /* Time source the request was sent to. */
+  struct tsch_neighbor *pNbr;
+
+  sf_joinBackoff_failed(&gJoinBackoff);
+  sf_tsch_schedule_delete_jreq_slots();
+  sf_tsch_schedule_add_jreq_slot(gJoinBackoff.slot);
+
+  /* The CSMA backoff counts the join request links of this device, one per
+     slotframe, and is not reset by a dropped request. The join backoff
+     takes over, the CSMA window restarts from the minimum. */
+  if(tsch_get_lock())
+  {
+    pNbr = tsch_queue_get_nbr(gpDestinationAddress);
+    if(NULL != pNbr)
+    {
+      tsch_queue_backoff_reset(pNbr);
+    }
+    tsch_release_lock();
+  }
+
+  LOG_INFO("Join backoff exp %u; Slot %u\n", gJoinBackoff.exp, gJoinBackoff.slot);
+}/* loc_joinBackoff() */
+
+/*------------------------------------------------------------------------------
+  loc_loadSyncContext()
+------------------------------------------------------------------------------*/
+static bool loc_loadSyncContext(void)
+{
+  /* Stored network ID. */
+  uint16_t panId = 0;
+  /* Stored BMS-CC address. */
+  linkaddr_t gwAddress = linkaddr_null;
+  /* Time source of the context. */
+  linkaddr_t timeSource;
+
+  gSyncContextValid = false;
+
+  if(E_SF_SUCCESS != sf_persistentDataStorage_readSyncContext(&gSyncContext))
+  {
+    return false;
+  }
+
+  sf_configMgmt_getParam(&panId, sizeof(panId), E_CONFIGMGMT_PARAM_PAN_ID);
+  sf_configMgmt_getParam(gwAddress.u8, sizeof(gwAddress.u8),
+                         E_CONFIGMGMT_PARAM_GW_ADDR);
+  memcpy(timeSource.u8, gSyncContext.timeSourceAddr, sizeof(timeSource.u8));
+
+  /* Only use a context of the network the device has joined. */
+  if((gSyncContext.panId != panId) || !linkaddr_cmp(&timeSource, &gwAddress))
+  {
+    LOG_INFO("Sync context of other network ignored\n");
+    return false;
+  }
+
+  gSyncContextValid = true;
+
+  return true;
+}/* loc_loadSyncContext() */
+
+/*------------------------------------------------------------------------------
+  loc_storeSyncContext()
+------------------------------------------------------------------------------*/
+static void loc_storeSyncContext(void)
+{
+  /* Time source neighbor. */
+  struct tsch_neighbor *pTimeSource = tsch_queue_get_time_source();
+
+  if(!tsch_is_associated || (NULL == pTimeSource) ||
+     !tsch_static_beacon_channel_available())
+  {
+    return;
+  }
+
+  gSyncContext.beaconChannel = tsch_get_static_beacon_channel();
+  memcpy(gSyncContext.timeSourceAddr, tsch_queue_get_nbr_address(pTimeSource)->u8,
+         sizeof(gSyncContext.timeSourceAddr));
+  gSyncContext.panId = frame802154_get_pan_id();
+  gSyncContext.asnMs1b = tsch_current_asn.ms1b;
+  gSyncContext.asnLs4b = tsch_current_asn.ls4b;
+  gSyncContext.absoluteTime = tsch_get_internal_absolute_time();
+
+  if(E_SF_SUCCESS != sf_persistentDataStorage_writeSyncContext(&gSyncContext))
+  {
+    LOG_ERR("!Failed to store sync context\n");
+  }
+}/* loc_storeSyncContext() */
+
 /*=============================================================================
                           PROCESSES IMPLEMENTATION
 =============================================================================*/
@@ -225,16 +531,20 @@ PROCESS_THREAD(request_tx_process, ev, data)
 {
   /* Timer handler. */
   static struct etimer periodicTimer;
+  /* Time until the next request. */
+  static clock_time_t retryTime;
 
   PROCESS_BEGIN();
 
   while(1)
   {
     /* Blocks until timeout expires. */
-    LOG_INFO("Block until req Tx timeout expires; %lu sec\n",
-             (long unsigned)(SF_JOIN_RETRY_TX_TIME / CLOCK_SECOND));
+    retryTime = sf_joinBackoff_getRetryTime(&gJoinBackoff,
+                                            tsch_get_join_congestion());
+    LOG_INFO("Block until req Tx timeout expires; %lu ms\n",
+             (long unsigned)(retryTime * 1000 / CLOCK_SECOND));
     /* Set Tx timeout. */
-    etimer_set(&periodicTimer, SF_JOIN_RETRY_TX_TIME);
+    etimer_set(&periodicTimer, retryTime);
     PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&periodicTimer));
 
     /* Check the correctness of the join state */
@@ -258,7 +568,9 @@ PROCESS_THREAD(request_tx_process, ev, data)
           gReqTxFailed = false;
           /* Use as destination the device from where it gets the time source. */
           gpDestinationAddress = tsch_queue_get_nbr_address(tsch_queue_get_time_source());
-          if(E_SF_SUCCESS != sf_join_request_send(gpDestinationAddress))
+          if(E_SF_SUCCESS != (gCompact ?
+                              sf_join_compactRequest_send(gpDestinationAddress) :
+                              sf_join_request_send(gpDestinationAddress)))
           {
             gReqActive = false;
             LOG_ERR("!Failed req Tx\n");
@@ -358,6 +670,7 @@ PROCESS_THREAD(handshake_process, ev, data)
   /* Initialize global variables */
   gReqActive = false;
   gSuccActive = false;
+  gCompact = gCompactEnabled;
 
   /* Use as destination the device where it gets the time source from. */
   gpDestinationAddress = tsch_queue_get_nbr_address(tsch_queue_get_time_source());
@@ -377,7 +690,7 @@ PROCESS_THREAD(handshake_process, ev, data)
 
   /* Set overall timeout. If this timeout expires. The process will abort */
   ctimer_set(&gJoinTimer, SF_JOIN_TIMEOUT, loc_join_timeout_callback, NULL);
-  PROCESS_YIELD_UNTIL(E_CONFIGMGMT_DEVICESTATUS_CONNECTED ==
+  PROCESS_YIELD_UNTIL(E_CONFIGMGMT_DEVICESTATUS_NOT_CONNECTED !=
                       sf_configMgmt_getDeviceStatus());
 
   /* Stop over all timer */
@@ -436,7 +749,7 @@ PROCESS_THREAD(manaul_join_process, ev, data)
 
     sf_led_stopBlink();
 
-    if(E_CONFIGMGMT_DEVICESTATUS_CONNECTED == sf_configMgmt_getDeviceStatus())
+    if(E_CONFIGMGMT_DEVICESTATUS_NOT_CONNECTED != sf_configMgmt_getDeviceStatus())
     {
       sf_led_onDuration(LEDS_CONF_GREEN, 2000);
       PROCESS_WAIT_EVENT_UNTIL(sf_led_waitUntilOff() ||
@@ -470,6 +783,80 @@ PROCESS_THREAD(manaul_join_process, ev, data)
   PROCESS_END();
 }/* manaul_join_process() */
 
+/*------------------------------------------------------------------------------
+  sync_listen_process()
+------------------------------------------------------------------------------*/
+static PT_THREAD(sync_listen_process(struct pt *pt))
+{
+  /* Time source of the last association */
+  linkaddr_t timeSource;
+  /* Listening timer */
+  static struct etimer listenTimer;
+  /* Association check timer */
+  static struct etimer pollTimer;
+
+  PT_BEGIN(pt);
+
+  /* Listen on the beacon channel of the last association for the time
+     source of the last association only. */
+  memcpy(timeSource.u8, gSyncContext.timeSourceAddr, sizeof(timeSource.u8));
+  tsch_set_beaconScan_addr(&timeSource);
+  tsch_set_static_beacon_channel(gSyncContext.beaconChannel);
+  sf_tsch_init();
+  sf_tsch_start();
+
+  etimer_set(&listenTimer, gListenTime);
+  while(!tsch_is_associated && !etimer_expired(&listenTimer))
+  {
+    etimer_set(&pollTimer, SF_JOIN_WARM_POLL_TIME);
+    PT_WAIT_UNTIL(pt, etimer_expired(&pollTimer));
+  }
+  etimer_stop(&listenTimer);
+
+  if(!tsch_is_associated)
+  {
+    /* Keep the radio off until the next listening or scan. */
+    sf_tsch_stop();
+  }
+
+  PT_END(pt);
+}/* sync_listen_process() */
+
+/*------------------------------------------------------------------------------
+  join_retry_process()
+------------------------------------------------------------------------------*/
+PROCESS_THREAD(join_retry_process, ev, data)
+{
+  /* Join retry timer */
+  static struct etimer retryTimer;
+  /* Join retry time */
+  clock_time_t retryTime;
+
+  PROCESS_BEGIN();
+
+  /* The abort is called from the Tx callbacks of the MAC. Stop the handshake
+     and leave the network from the own process context. */
+  PROCESS_PAUSE();
+  ctimer_stop(&gJoinTimer);
+  process_exit(&handshake_process);
+  sf_tsch_stop();
+
+  /* Devices failing at the same time are spread by the rejoin backoff. */
+  retryTime = loc_getRejoinTime();
+  LOG_INFO("Wait for %lu sec then retry to join again\n",
+           (unsigned long)(retryTime / CLOCK_SECOND));
+  etimer_set(&retryTimer, retryTime);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&retryTimer));
+
+  if(process_is_running(&manaul_join_process))
+  {
+    process_exit(&manaul_join_process);
+  }
+  process_start(&manaul_join_process, NULL);
+
+  PROCESS_END();
+}/* join_retry_process() */
+
 /*------------------------------------------------------------------------------
   rejoin_process()
 ------------------------------------------------------------------------------*/
@@ -477,38 +864,88 @@ PROCESS_THREAD(rejoin_process, ev, data)
 {
   /* Device address */
   linkaddr_t deviceAddress;
+  /* Channel offset of the data slots */
+  uint8_t channelOffset = 0;
+  /* Rejoin retry time */
+  clock_time_t rejoinTime;
   /* Beacon scan protothread reference. */
   static struct pt beacon_scan_pt;
+  /* Time source listening protothread reference. */
+  static struct pt sync_listen_pt;
   /* Rejoin retry timer */
   static struct etimer retryTimer;
+  /* Passive listening timer */
+  static struct etimer passiveTimer;
+  /* Start of the rejoin */
+  static clock_time_t startTime;
 
   PROCESS_BEGIN();
 
   LOG_INFO("Start rejoin process; No handshake will be performed;\n");
 
-  while(E_CONFIGMGMT_DEVICESTATUS_NOT_CONNECTED == sf_configMgmt_getDeviceStatus())
+  startTime = clock_time();
+  gRejoinBackoffExp = 0;
+
+  /* Warm start. Listen for the time source of the last association on its
+     beacon channel before scanning all channels. */
+  if(loc_loadSyncContext())
   {
-    /* Red LED blinks during beacon scan*/
+    LOG_INFO("Listen for time source on channel %u\n", gSyncContext.beaconChannel);
+
     sf_led_startBlink(LEDS_CONF_RED, 200, 800);
 
-    /* Start beacon scan. It will be scanning for beacons without manual join flag
-       coming from the stored BMS-CC within the stored network.*/
-    sf_beaconScan_setBeaconType(E_SF_JOIN_BEACON_DISABLED);
-    PROCESS_PT_SPAWN(&beacon_scan_pt, beacon_scan_process(&beacon_scan_pt));
+    gListenTime = SF_JOIN_WARM_LISTEN_TIME;
+    PROCESS_PT_SPAWN(&sync_listen_pt, sync_listen_process(&sync_listen_pt));
 
     sf_led_stopBlink();
 
-    if(!linkaddr_cmp(&linkaddr_null, sf_beaconScan_getBestBeaconAddress()))
+    if(tsch_is_associated)
     {
-      /* Initiate TSCH */
-      sf_tsch_init();
+      LOG_INFO("Synchronized after %lu ms\n",
+               (unsigned long)((clock_time() - startTime) * 1000 / CLOCK_SECOND));
+
+      if((tsch_current_asn.ms1b < gSyncContext.asnMs1b) ||
+         ((tsch_current_asn.ms1b == gSyncContext.asnMs1b) &&
+          (tsch_current_asn.ls4b < gSyncContext.asnLs4b)))
+      {
+        LOG_WARN("Time source restarted the network\n");
+      }
+    }
+    else
+    {
+      LOG_INFO("No beacon from time source; Start beacon scan\n");
+    }
+  }
+
+  while(E_CONFIGMGMT_DEVICESTATUS_NOT_CONNECTED == sf_configMgmt_getDeviceStatus())
+  {
+    if(!tsch_is_associated)
+    {
+      /* Red LED blinks during beacon scan*/
+      sf_led_startBlink(LEDS_CONF_RED, 200, 800);
+
+      /* Start beacon scan. It will be scanning for beacons without manual join flag
+         coming from the stored BMS-CC within the stored network.*/
+      sf_beaconScan_setBeaconType(E_SF_JOIN_BEACON_DISABLED);
+      PROCESS_PT_SPAWN(&beacon_scan_pt, beacon_scan_process(&beacon_scan_pt));
+
+      sf_led_stopBlink();
 
-      /* Start TSCH as end point*/
-      sf_tsch_start();
+      if(!linkaddr_cmp(&linkaddr_null, sf_beaconScan_getBestBeaconAddress()))
+      {
+        /* Initiate TSCH */
+        sf_tsch_init();
+
+        /* Start TSCH as end point*/
+        sf_tsch_start();
 
-      /* Wait until TSCH get synchronized */
-      PROCESS_YIELD_UNTIL(tsch_is_associated);
+        /* Wait until TSCH get synchronized */
+        PROCESS_YIELD_UNTIL(tsch_is_associated);
+      }
+    }
 
+    if(tsch_is_associated)
+    {
       if(E_SF_ERROR == sf_configMgmt_getParam(deviceAddress.u8,
                                               sizeof(deviceAddress.u8),
                                               E_CONFIGMGMT_PARAM_DEVICE_ADDR))
@@ -520,12 +957,20 @@ PROCESS_THREAD(rejoin_process, ev, data)
         LOG_INFO("Stored device address %i \n", deviceAddress.u16);
       }
 
+      /* Apply the stored channel offset of the data slots. */
+      sf_configMgmt_getParam(&channelOffset, sizeof(channelOffset),
+                             E_CONFIGMGMT_PARAM_CHANNEL_OFFSET);
+      sf_tsch_schedule_set_data_channel_offset(channelOffset);
+
       /* Add data slots. */
       sf_tsch_addDataSlots((const linkaddr_t*)&deviceAddress);
 
       /* Set the global connected state to connected. */
       sf_configMgmt_setDeviceStatus(E_CONFIGMGMT_DEVICESTATUS_CONNECTED);
 
+      /* Keep the sync context for the next warm start. */
+      loc_storeSyncContext();
+
       sf_led_onDuration(LEDS_CONF_GREEN, 2000);
       PROCESS_WAIT_EVENT_UNTIL(sf_led_waitUntilOff() ||
                                 ev == PROCESS_EVENT_EXIT);
@@ -539,10 +984,38 @@ PROCESS_THREAD(rejoin_process, ev, data)
                                 ev == PROCESS_EVENT_EXIT);
 
       /* Retry to rejoin */
-      LOG_INFO("Wait for %u sec then retry to rejoin again\n", SF_JOIN_REJOIN_INTERVAL /
-              CLOCK_SECOND);
-      etimer_set(&retryTimer, SF_JOIN_REJOIN_INTERVAL);
-      PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&retryTimer));
+      rejoinTime = loc_getRejoinTime();
+      LOG_INFO("Wait for %lu sec then retry to rejoin again\n",
+               (unsigned long)(rejoinTime / CLOCK_SECOND));
+      etimer_set(&retryTimer, rejoinTime);
+
+      /* Listen for the last time source once in the middle of the interval
+         if it is long enough. It costs less than a scan of all channels. */
+      if(gSyncContextValid &&
+         (rejoinTime >= SF_JOIN_PASSIVE_DUTY_DIV * SF_JOIN_PASSIVE_LISTEN_TIME))
+      {
+        etimer_set(&passiveTimer, rejoinTime / 2);
+        PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&passiveTimer) ||
+                                 etimer_expired(&retryTimer));
+
+        if(!etimer_expired(&retryTimer))
+        {
+          gListenTime = SF_JOIN_PASSIVE_LISTEN_TIME;
+          PROCESS_PT_SPAWN(&sync_listen_pt, sync_listen_process(&sync_listen_pt));
+
+          if(tsch_is_associated)
+          {
+            LOG_INFO("Synchronized by passive listening\n");
+          }
+        }
+      }
+
+      if(!tsch_is_associated && !etimer_expired(&retryTimer))
+      {
+        PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&retryTimer));
+      }
+      etimer_stop(&retryTimer);
+      etimer_stop(&passiveTimer);
     }
   }
 
@@ -557,6 +1030,11 @@ PROCESS_THREAD(rejoin_process, ev, data)
 ------------------------------------------------------------------------------*/
 void sf_joinRequester_join(void)
 {
+  if(process_is_running(&join_retry_process))
+  {
+    process_exit(&join_retry_process);
+  }
+
   if(process_is_running(&manaul_join_process))
   {
     process_exit(&manaul_join_process);
@@ -578,6 +1056,40 @@ void sf_joinRequester_rejoin(void)
   process_start(&rejoin_process, NULL);
 }/* sf_joinRequester_rejoin() */
 
+/*------------------------------------------------------------------------------
+  sf_joinRequester_dataTxDone()
+------------------------------------------------------------------------------*/
+void sf_joinRequester_dataTxDone(bool acked)
+{
+  if(!gConfirmPending)
+  {
+    return;
+  }
+
+  if(acked)
+  {
+    LOG_INFO("Join confirmed by data ACK\n");
+
+    gConfirmPending = false;
+    loc_storeJoinConfig();
+
+    /* Set the global connected state to connected. */
+    sf_configMgmt_setDeviceStatus(E_CONFIGMGMT_DEVICESTATUS_CONNECTED);
+  }
+  else if(++gConfirmFailures >= SF_JOIN_CONFIRM_ATTEMPTS)
+  {
+    loc_abortJoinConfirm();
+  }
+}/* sf_joinRequester_dataTxDone() */
+
+/*------------------------------------------------------------------------------
+  sf_joinRequester_setCompact()
+------------------------------------------------------------------------------*/
+void sf_joinRequester_setCompact(bool enable)
+{
+  gCompactEnabled = enable;
+}/* sf_joinRequester_setCompact() */
+
 /*=============================================================================
                           CALLBACKS IMPLEMENTATION
 =============================================================================*/
@@ -593,6 +1105,7 @@ void sf_join_output_callback(void *ptr, nullnet_tx_status_t status)
       /* A request fragment not successfully transmitted. */
       LOG_ERR("!Failed Tx req frame\n");
       gReqTxFailed = true;
+      loc_joinBackoff();
     }
 
     /* If we reach here, then we are sure that no active join request
@@ -654,20 +1167,7 @@ void sf_join_output_callback(void *ptr, nullnet_tx_status_t status)
       etimer_stop(&gJoinSuccessfulTimer);
 
       /* Store device configuration.  */
-      uint16_t panId = frame802154_get_pan_id();
-      LOG_INFO("Set PAN ID of device to 0x%04x\n", panId);
-
-      /* Set communication params */
-      sf_configMgmt_setParam(&panId, sizeof(panId), E_CONFIGMGMT_PARAM_PAN_ID);
-      sf_configMgmt_setParam(linkaddr_node_addr.u8, sizeof(linkaddr_node_addr.u8),
-                              E_CONFIGMGMT_PARAM_DEVICE_ADDR);
-      sf_configMgmt_setParam(gpDestinationAddress->u8, sizeof(gpDestinationAddress->u8),
-                              E_CONFIGMGMT_PARAM_GW_ADDR);
-      sf_configMgmt_writeConfig();
-
-      LOG_INFO("Device joined NW successfully; New device ID; ");
-      LOG_INFO_LLADDR(&linkaddr_node_addr);
-      LOG_INFO_("\n");
+      loc_storeJoinConfig();
 
       /* Set the global connected state to connected. */
       sf_configMgmt_setDeviceStatus(E_CONFIGMGMT_DEVICESTATUS_CONNECTED);
@@ -693,11 +1193,18 @@ void sf_tsch_leaving_network_callback( void )
 {
   LOG_INFO("TSCH left network\n");
 
+  /* Search and join the network at the maximum Tx power. */
+  sf_txPower_reset();
+
   if(E_CONFIGMGMT_DEVICESTATUS_CONNECTED == sf_configMgmt_getDeviceStatus())
   {
     sf_configMgmt_setDeviceStatus(E_CONFIGMGMT_DEVICESTATUS_NOT_CONNECTED);
     sf_joinRequester_rejoin();
   }
+  else if(E_CONFIGMGMT_DEVICESTATUS_CONFIRMING == sf_configMgmt_getDeviceStatus())
+  {
+    loc_abortJoinConfirm();
+  }
 }
 
 /*=============================================================================
@@ -721,11 +1228,39 @@ void sf_join_response_receive(void)
 
   LOG_INFO("Rx resp; New device address;");
   LOG_INFO_LLADDR(&assignedDeviceAddr);
-  LOG_INFO_("\n");
+  LOG_INFO_("; Channel offset %u\n", resFrameParams.channelOffset);
+
+  /* Use the assigned channel offset for the data slots. */
+  if(sf_tsch_schedule_set_data_channel_offset(resFrameParams.channelOffset))
+  {
+    LOG_ERR("!Invalid channel offset; use 0\n");
+    sf_tsch_schedule_set_data_channel_offset(0);
+  }
 
   /* Stop state timoeout */
   ctimer_stop(&gJoinResponseTimer);
 
+  if(resFrameParams.compact)
+  {
+    /* The data slots are confirmed by the response. Use them right away, the
+       ACK of the first data frame completes the join. */
+    sf_tsch_schedule_delete_jproc_slots(NULL);
+    sf_tsch_schedule_add_data_slots((const linkaddr_t*)&linkaddr_node_addr);
+
+    /* Data frames are sent to the configured gateway address. The
+       configuration is only written to the flash once the join is confirmed. */
+    sf_configMgmt_setParam(gpDestinationAddress->u8, sizeof(gpDestinationAddress->u8),
+                           E_CONFIGMGMT_PARAM_GW_ADDR);
+
+    sf_stateManager_setState(&gJoinStateCtx, (uint8_t)E_JOIN_STATE_CONFIRM);
+    sf_stateManager_execState(&gJoinStateCtx);
+
+    /* Data frames are sent meanwhile, the first ACK sets the connected
+       state. */
+    sf_configMgmt_setDeviceStatus(E_CONFIGMGMT_DEVICESTATUS_CONFIRMING);
+    return;
+  }
+
   /* Set next state to E_JOIN_STATE_SUCC_TX */
   sf_stateManager_setState(&gJoinStateCtx, (uint8_t)E_JOIN_STATE_SUCC_TX);
   sf_stateManager_execState(&gJoinStateCtx);
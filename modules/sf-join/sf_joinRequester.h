@@ -30,9 +30,16 @@ extern "C" {
  *    |-------------------------------------------|-------------------------------------------------|
  *    | @ref sf_joinRequester_join()              | @copybrief sf_joinRequester_join()             |
  *    | @ref sf_joinRequester_rejoin()            | @copybrief sf_joinRequester_rejoin()           |
+ *    | @ref sf_joinRequester_dataTxDone()        | @copybrief sf_joinRequester_dataTxDone()       |
+ *    | @ref sf_joinRequester_setCompact()        | @copybrief sf_joinRequester_setCompact()       |
  *  @{
  */
 
+/*=============================================================================
+                                INCLUDES
+=============================================================================*/
+#include <stdbool.h>
+
 /*=============================================================================
                                 API FUNCTIONS
 =============================================================================*/
@@ -55,6 +62,28 @@ void sf_joinRequester_join(void);
 /*============================================================================*/
 void sf_joinRequester_rejoin(void);
 
+/*============================================================================*/
+/**
+ * \brief Report the Tx result of a data frame. With the compact handshake,
+ *        the first ACKed data frame completes the join. If several data
+ *        frames are not ACKed, the join is started over.
+ *
+ * \param acked   True if the data frame was ACKed by the gateway.
+ */
+/*============================================================================*/
+void sf_joinRequester_dataTxDone(bool acked);
+
+/*============================================================================*/
+/**
+ * \brief Select the handshake of the next joins. The compact handshake falls
+ *        back to the three-message handshake if the gateway does not answer.
+ *        Defaults to SF_JOIN_CONF_COMPACT_HANDSHAKE.
+ *
+ * \param enable  True to use the compact handshake.
+ */
+/*============================================================================*/
+void sf_joinRequester_setCompact(bool enable);
+
 /*! @} */
 
 #endif /* __SF_JOINREQUESTER_H__ */
@@ -63,7 +63,9 @@ __attribute__((weak)) bool measHandler_performMeas(void)
 
 
   /* Get internal absolute time */
-  gMeas.timeStamp = sf_absoluteTime_getTime();
+  uint64_t timeMs = sf_absoluteTime_getTimeMs();
+  gMeas.timeStamp = (uint32_t)(timeMs / 1000U);
+  gMeas.timeStampMs = (uint16_t)(timeMs % 1000U);
 
 //  //MY ADC CODE
 //
@@ -64,8 +64,10 @@ typedef enum
 /*! Defines the measurement data */
 typedef struct
 {
-  /* Timestamp */
+  /* Timestamp in seconds */
   uint32_t timeStamp;
+  /* Millisecond part of the timestamp (0..999) */
+  uint16_t timeStampMs;
   /* Measurement value */
   float value;
 } meas_t;
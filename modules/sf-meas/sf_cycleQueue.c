@@ -0,0 +1,160 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Implementation of the deferred-work queue of the TSCH cycle
+             start.
+*/
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdbool.h>
+#include <stdint.h>
+/* Stack include */
+#include "contiki.h"
+#include "lib/ringbufindex.h"
+#include "sys/int-master.h"
+/* Application include */
+#include "sf_cycleQueue.h"
+
+/*==============================================================================
+                            MACROS
+==============================================================================*/
+/* Size of the cycle start ring. Must be a power of two, one entry less can
+   be pending. */
+#ifndef SF_CONF_MEAS_CYCLE_QUEUE_SIZE
+  #define SF_MEAS_CYCLE_QUEUE_SIZE       (4U)
+#else
+  #define SF_MEAS_CYCLE_QUEUE_SIZE       SF_CONF_MEAS_CYCLE_QUEUE_SIZE
+#endif
+#if (SF_MEAS_CYCLE_QUEUE_SIZE & (SF_MEAS_CYCLE_QUEUE_SIZE - 1)) != 0
+  #error "SF_MEAS_CYCLE_QUEUE_SIZE must be a power of two"
+#endif
+
+/*==============================================================================
+                            GLOBAL VARIABLES
+==============================================================================*/
+/* Index ring and storage of the pending entries. */
+static struct ringbufindex gRingbuf;
+static sf_cycleQueue_entry_t gEntries[SF_MEAS_CYCLE_QUEUE_SIZE];
+/* Number of dropped entries and longest enqueue, written by the producer
+   only. */
+static volatile uint16_t gDropped;
+static volatile rtimer_clock_t gEnqueueMax;
+/* Longest drain latency, written by the consumer only. */
+static rtimer_clock_t gLatencyMax;
+
+/*==============================================================================
+                      API FUNCTION IMPLEMENTATION
+==============================================================================*/
+/*------------------------------------------------------------------------------
+  sf_cycleQueue_init()
+------------------------------------------------------------------------------*/
+void sf_cycleQueue_init(void)
+{
+  /* Interrupt state */
+  int_master_status_t status;
+
+  status = int_master_read_and_disable();
+  ringbufindex_init(&gRingbuf, SF_MEAS_CYCLE_QUEUE_SIZE);
+  gDropped = 0U;
+  gEnqueueMax = 0;
+  gLatencyMax = 0;
+  int_master_status_set(status);
+}/* sf_cycleQueue_init() */
+
+/*------------------------------------------------------------------------------
+  sf_cycleQueue_put()
+------------------------------------------------------------------------------*/
+bool sf_cycleQueue_put(const struct tsch_asn_t *pAsn, rtimer_clock_t slotStart)
+{
+  /* Index of the free entry */
+  int idx;
+  /* rtimer time at the entry, then the enqueue cost */
+  rtimer_clock_t start = RTIMER_NOW();
+
+  idx = ringbufindex_peek_put(&gRingbuf);
+  if(idx != -1)
+  {
+    gEntries[idx].asn = *pAsn;
+    gEntries[idx].slotStart = slotStart;
+    gEntries[idx].putTime = start;
+    /* The entry is complete before the consumer can see it. */
+    __asm__ volatile("" ::: "memory");
+    ringbufindex_put(&gRingbuf);
+  }
+  else if(gDropped < UINT16_MAX)
+  {
+    gDropped++;
+  }
+
+  start = RTIMER_NOW() - start;
+  if(start > gEnqueueMax)
+  {
+    gEnqueueMax = start;
+  }
+
+  return (idx != -1);
+}/* sf_cycleQueue_put() */
+
+/*------------------------------------------------------------------------------
+  sf_cycleQueue_peek()
+------------------------------------------------------------------------------*/
+const sf_cycleQueue_entry_t* sf_cycleQueue_peek(void)
+{
+  /* Index of the oldest entry */
+  int idx = ringbufindex_peek_get(&gRingbuf);
+  /* Time from putting to taking the entry */
+  rtimer_clock_t latency;
+
+  if(idx == -1)
+  {
+    return NULL;
+  }
+
+  latency = RTIMER_NOW() - gEntries[idx].putTime;
+  if(latency > gLatencyMax)
+  {
+    gLatencyMax = latency;
+  }
+
+  return &gEntries[idx];
+}/* sf_cycleQueue_peek() */
+
+/*------------------------------------------------------------------------------
+  sf_cycleQueue_release()
+------------------------------------------------------------------------------*/
+void sf_cycleQueue_release(void)
+{
+  /* The entry is no longer read before the producer can reuse it. */
+  __asm__ volatile("" ::: "memory");
+  ringbufindex_get(&gRingbuf);
+}/* sf_cycleQueue_release() */
+
+/*------------------------------------------------------------------------------
+  sf_cycleQueue_getStats()
+------------------------------------------------------------------------------*/
+void sf_cycleQueue_getStats(sf_cycleQueue_stats_t *pStats)
+{
+  pStats->dropped = gDropped;
+  pStats->enqueueMax = gEnqueueMax;
+  pStats->latencyMax = gLatencyMax;
+}/* sf_cycleQueue_getStats() */
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,138 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Deferred-work queue of the TSCH cycle start.
+
+ @details The TSCH cycle start callback runs in rtimer interrupt context. It
+          puts the cycle start into a lock-free single-producer (rtimer ISR)
+          / single-consumer (process) ring of bounded size instead of posting
+          events to the global event queue. The entries carry the ASN and
+          the start time of slot zero. The queue keeps the number of dropped
+          entries, the longest enqueue and the longest time from putting an
+          entry until it is taken.
+*/
+
+#ifndef __SF_CYCLE_QUEUE_H__
+#define __SF_CYCLE_QUEUE_H__
+
+/**
+ *  @addtogroup SF_MEAS_SENDER
+ *
+ *  @details
+ *
+ *  - <b>Cycle start queue API</b>\n
+ *    | API Function                    | Description                           |
+ *    |---------------------------------|---------------------------------------|
+ *    | @ref sf_cycleQueue_init()       | @copybrief sf_cycleQueue_init()       |
+ *    | @ref sf_cycleQueue_put()        | @copybrief sf_cycleQueue_put()        |
+ *    | @ref sf_cycleQueue_peek()       | @copybrief sf_cycleQueue_peek()       |
+ *    | @ref sf_cycleQueue_release()    | @copybrief sf_cycleQueue_release()    |
+ *    | @ref sf_cycleQueue_getStats()   | @copybrief sf_cycleQueue_getStats()   |
+ *  @{
+ */
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdbool.h>
+#include <stdint.h>
+/* Stack include */
+#include "contiki.h"
+#include "net/mac/tsch/tsch-asn.h"
+
+/*==============================================================================
+                            STRUCTS
+==============================================================================*/
+/*! Cycle start deferred from the TSCH rtimer interrupt. */
+typedef struct
+{
+  /*! ASN of slot zero. */
+  struct tsch_asn_t asn;
+  /*! Start time of slot zero. */
+  rtimer_clock_t slotStart;
+  /*! rtimer time the entry was put. */
+  rtimer_clock_t putTime;
+} sf_cycleQueue_entry_t;
+
+/*! Statistics of the queue since @ref sf_cycleQueue_init. */
+typedef struct
+{
+  /*! Entries dropped because the queue was full. */
+  uint16_t dropped;
+  /*! Longest run of @ref sf_cycleQueue_put in rtimer ticks. */
+  rtimer_clock_t enqueueMax;
+  /*! Longest time from putting an entry until it is taken, rtimer ticks. */
+  rtimer_clock_t latencyMax;
+} sf_cycleQueue_stats_t;
+
+/*==============================================================================
+                            FUNCTION PROTOTYPES
+==============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Empty the queue and reset the statistics. The producer is kept out
+ *        by disabling the interrupts meanwhile.
+ */
+/*============================================================================*/
+void sf_cycleQueue_init(void);
+
+/*============================================================================*/
+/**
+ * \brief Put a cycle start, called by the producer (rtimer ISR) only.
+ *
+ * \param pAsn          ASN of slot zero.
+ * \param slotStart     Start time of slot zero.
+ *
+ * \return false if the queue is full and the entry has been dropped.
+ */
+/*============================================================================*/
+bool sf_cycleQueue_put(const struct tsch_asn_t *pAsn, rtimer_clock_t slotStart);
+
+/*============================================================================*/
+/**
+ * \brief Get the oldest entry, called by the consumer only. The entry stays
+ *        valid until @ref sf_cycleQueue_release.
+ *
+ * \return Pointer to the entry, NULL if the queue is empty.
+ */
+/*============================================================================*/
+const sf_cycleQueue_entry_t* sf_cycleQueue_peek(void);
+
+/*============================================================================*/
+/**
+ * \brief Release the entry returned by @ref sf_cycleQueue_peek, called by
+ *        the consumer only.
+ */
+/*============================================================================*/
+void sf_cycleQueue_release(void);
+
+/*============================================================================*/
+/**
+ * \brief Get the statistics of the queue.
+ *
+ * \param pStats        Returns the statistics.
+ */
+/*============================================================================*/
+void sf_cycleQueue_getStats(sf_cycleQueue_stats_t *pStats);
+
+/*! @} */
+
+#endif /* __SF_CYCLE_QUEUE_H__ */
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,261 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Implementation of the encoder and decoder of the measurement
+             frames.
+*/
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+/* Application include */
+#include "sf_frameType.h"
+#include "sf_measFrame.h"
+
+/*==============================================================================
+                            MACROS
+==============================================================================*/
+/* Length of the encoded timestamp, millisecond part and value. */
+#define SF_MEAS_FRAME_TS_LEN           (4U)
+#define SF_MEAS_FRAME_TS_MS_LEN        (2U)
+#define SF_MEAS_FRAME_VALUE_LEN        (4U)
+/* Longest varint of a 32 bit value. */
+#define SF_MEAS_FRAME_VARINT_LEN_MAX   (5U)
+
+/*==============================================================================
+                         LOCAL FUNCTION DEFINITION
+==============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Timestamp of a measurement in milliseconds.
+ */
+/*============================================================================*/
+static uint64_t loc_timeMs(const meas_t *pMeas);
+
+/*============================================================================*/
+/**
+ * \brief Write a zigzag encoded varint, 7 bit per byte, lowest first.
+ *
+ * \return Number of bytes written.
+ */
+/*============================================================================*/
+static uint8_t loc_putVarint(uint8_t *pBuf, int32_t value);
+
+/*============================================================================*/
+/**
+ * \brief Read a zigzag encoded varint.
+ *
+ * \return Number of bytes read, 0 if it exceeds len or 32 bit.
+ */
+/*============================================================================*/
+static uint8_t loc_getVarint(const uint8_t *pBuf, uint8_t len, int32_t *pValue);
+
+/*==============================================================================
+                         LOCAL FUNCTION IMPLEMENTATION
+==============================================================================*/
+/*----------------------------------------------------------------------------*/
+/*! loc_timeMs */
+/*----------------------------------------------------------------------------*/
+static uint64_t loc_timeMs(const meas_t *pMeas)
+{
+  return (uint64_t)pMeas->timeStamp * 1000U + pMeas->timeStampMs;
+}/* loc_timeMs() */
+
+/*----------------------------------------------------------------------------*/
+/*! loc_putVarint */
+/*----------------------------------------------------------------------------*/
+static uint8_t loc_putVarint(uint8_t *pBuf, int32_t value)
+{
+  uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+  uint8_t len = 0U;
+
+  while(zigzag >= 0x80U)
+  {
+    pBuf[len++] = (uint8_t)(zigzag | 0x80U);
+    zigzag >>= 7;
+  }
+  pBuf[len++] = (uint8_t)zigzag;
+
+  return len;
+}/* loc_putVarint() */
+
+/*----------------------------------------------------------------------------*/
+/*! loc_getVarint */
+/*----------------------------------------------------------------------------*/
+static uint8_t loc_getVarint(const uint8_t *pBuf, uint8_t len, int32_t *pValue)
+{
+  uint32_t zigzag = 0U;
+  uint8_t i;
+
+  for(i = 0U; (i < len) && (i < SF_MEAS_FRAME_VARINT_LEN_MAX); i++)
+  {
+    zigzag |= (uint32_t)(pBuf[i] & 0x7FU) << (7U * i);
+    if(0U == (pBuf[i] & 0x80U))
+    {
+      *pValue = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1U);
+      return i + 1U;
+    }
+  }
+
+  return 0U;
+}/* loc_getVarint() */
+
+/*==============================================================================
+                      API FUNCTION IMPLEMENTATION
+==============================================================================*/
+/*----------------------------------------------------------------------------*/
+/*! sf_measFrame_encode */
+/*----------------------------------------------------------------------------*/
+uint8_t sf_measFrame_encode(uint8_t *pBuf, uint8_t bufLen, const meas_t *pMeas,
+                            uint8_t *pNumMeas)
+{
+  /* Varint of the difference to the measurement before */
+  uint8_t pDelta[SF_MEAS_FRAME_VARINT_LEN_MAX];
+  uint8_t deltaLen;
+  int64_t delta;
+  uint8_t frameLen = 0U;
+  uint8_t count;
+
+  if((0U == *pNumMeas) || (bufLen < SF_MEAS_FRAME_HR_LEN_MIN))
+  {
+    *pNumMeas = 0U;
+    return 0U;
+  }
+
+  sf_frameType_set(pBuf, E_FRAME_TYPE_MEASUREMENT_HR);
+  frameLen += SF_FRAME_TYPE_LEN;
+  /* The count is written at the end. */
+  frameLen++;
+
+  memcpy(pBuf + frameLen, &pMeas[0].timeStamp, SF_MEAS_FRAME_TS_LEN);
+  frameLen += SF_MEAS_FRAME_TS_LEN;
+  memcpy(pBuf + frameLen, &pMeas[0].timeStampMs, SF_MEAS_FRAME_TS_MS_LEN);
+  frameLen += SF_MEAS_FRAME_TS_MS_LEN;
+  memcpy(pBuf + frameLen, &pMeas[0].value, SF_MEAS_FRAME_VALUE_LEN);
+  frameLen += SF_MEAS_FRAME_VALUE_LEN;
+
+  for(count = 1U; count < *pNumMeas; count++)
+  {
+    delta = (int64_t)loc_timeMs(&pMeas[count]) -
+            (int64_t)loc_timeMs(&pMeas[count - 1U]);
+    if((delta > INT32_MAX) || (delta < INT32_MIN))
+    {
+      break;
+    }
+
+    deltaLen = loc_putVarint(pDelta, (int32_t)delta);
+    if(frameLen + deltaLen + SF_MEAS_FRAME_VALUE_LEN > bufLen)
+    {
+      break;
+    }
+
+    memcpy(pBuf + frameLen, pDelta, deltaLen);
+    frameLen += deltaLen;
+    memcpy(pBuf + frameLen, &pMeas[count].value, SF_MEAS_FRAME_VALUE_LEN);
+    frameLen += SF_MEAS_FRAME_VALUE_LEN;
+  }
+
+  pBuf[SF_FRAME_TYPE_LEN] = count;
+  *pNumMeas = count;
+
+  return frameLen;
+}/* sf_measFrame_encode() */
+
+/*----------------------------------------------------------------------------*/
+/*! sf_measFrame_decode */
+/*----------------------------------------------------------------------------*/
+uint8_t sf_measFrame_decode(const uint8_t *pFrame, uint8_t frameLen,
+                            meas_t *pMeas, uint8_t maxMeas)
+{
+  E_FRAME_TYPE_t frameType;
+  uint64_t timeMs;
+  int32_t delta;
+  uint8_t deltaLen;
+  uint8_t count;
+  uint8_t ofs = SF_FRAME_TYPE_LEN;
+  uint8_t i;
+
+  if((NULL == pFrame) || (0U == maxMeas) || (frameLen < SF_FRAME_TYPE_LEN) ||
+     (E_SF_SUCCESS != sf_frameType_get(pFrame, &frameType)))
+  {
+    return 0U;
+  }
+
+  if(E_FRAME_TYPE_MEASUREMENT == frameType)
+  {
+    if(SF_MEAS_FRAME_LEGACY_LEN != frameLen)
+    {
+      return 0U;
+    }
+    memcpy(&pMeas[0].timeStamp, pFrame + ofs, SF_MEAS_FRAME_TS_LEN);
+    ofs += SF_MEAS_FRAME_TS_LEN;
+    pMeas[0].timeStampMs = 0U;
+    memcpy(&pMeas[0].value, pFrame + ofs, SF_MEAS_FRAME_VALUE_LEN);
+    return 1U;
+  }
+
+  if((E_FRAME_TYPE_MEASUREMENT_HR != frameType) ||
+     (frameLen < SF_MEAS_FRAME_HR_LEN_MIN))
+  {
+    return 0U;
+  }
+
+  count = pFrame[ofs++];
+  if((0U == count) || (count > maxMeas))
+  {
+    return 0U;
+  }
+
+  memcpy(&pMeas[0].timeStamp, pFrame + ofs, SF_MEAS_FRAME_TS_LEN);
+  ofs += SF_MEAS_FRAME_TS_LEN;
+  memcpy(&pMeas[0].timeStampMs, pFrame + ofs, SF_MEAS_FRAME_TS_MS_LEN);
+  ofs += SF_MEAS_FRAME_TS_MS_LEN;
+  memcpy(&pMeas[0].value, pFrame + ofs, SF_MEAS_FRAME_VALUE_LEN);
+  ofs += SF_MEAS_FRAME_VALUE_LEN;
+  if(pMeas[0].timeStampMs > 999U)
+  {
+    return 0U;
+  }
+  timeMs = loc_timeMs(&pMeas[0]);
+
+  for(i = 1U; i < count; i++)
+  {
+    deltaLen = loc_getVarint(pFrame + ofs, frameLen - ofs, &delta);
+    if((0U == deltaLen) ||
+       (ofs + deltaLen + SF_MEAS_FRAME_VALUE_LEN > frameLen) ||
+       ((delta < 0) && ((uint64_t)-(int64_t)delta > timeMs)))
+    {
+      return 0U;
+    }
+    ofs += deltaLen;
+
+    timeMs += delta;
+    pMeas[i].timeStamp = (uint32_t)(timeMs / 1000U);
+    pMeas[i].timeStampMs = (uint16_t)(timeMs % 1000U);
+    memcpy(&pMeas[i].value, pFrame + ofs, SF_MEAS_FRAME_VALUE_LEN);
+    ofs += SF_MEAS_FRAME_VALUE_LEN;
+  }
+
+  return (ofs == frameLen) ? count : 0U;
+}/* sf_measFrame_decode() */
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,114 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Encoder and decoder of the measurement frames.
+
+ @details The high resolution measurement frame carries one or more
+          measurements. The first one has the full timestamp, seconds and
+          milliseconds. The following ones have the difference of their
+          timestamp to the one before in milliseconds, as a zigzag encoded
+          varint: 1 byte up to +-63 ms, 2 bytes up to +-8 s, 3 bytes up to
+          +-17 min. The measurements may come in any order.
+
+          frame type | count | timestamp | timestamp ms | measurement
+          -----------|-------|-----------|--------------|------------
+            1byte    | 1byte |   4byte   |    2byte     |   4byte
+          followed by (count - 1) x
+          delta ms | measurement
+          ---------|------------
+          1-5byte  |   4byte
+
+          The decoder also takes the legacy E_FRAME_TYPE_MEASUREMENT frame,
+          so that the BMS-CC decodes both formats with the same code.
+*/
+
+#ifndef __SF_MEAS_FRAME_H__
+#define __SF_MEAS_FRAME_H__
+
+/**
+ *  @addtogroup SF_MEAS_SENDER
+ *
+ *  @details
+ *
+ *  - <b>Measurement frame API</b>\n
+ *    | API Function                    | Description                           |
+ *    |---------------------------------|---------------------------------------|
+ *    | @ref sf_measFrame_encode()      | @copybrief sf_measFrame_encode()      |
+ *    | @ref sf_measFrame_decode()      | @copybrief sf_measFrame_decode()      |
+ *  @{
+ */
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdint.h>
+/* Application include */
+#include "measHandler_api.h"
+
+/*==============================================================================
+                            MACROS
+==============================================================================*/
+/*! Length of a high resolution frame with a single measurement. */
+#define SF_MEAS_FRAME_HR_LEN_MIN       (1U + 1U + 4U + 2U + 4U)
+/*! Length of a legacy measurement frame. */
+#define SF_MEAS_FRAME_LEGACY_LEN       (1U + 4U + 4U)
+
+/*==============================================================================
+                            FUNCTION PROTOTYPES
+==============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Build a high resolution measurement frame with as many of the
+ *        given measurements as fit into the buffer.
+ *
+ * \param pBuf          Buffer of the frame.
+ * \param bufLen        Length of the buffer.
+ * \param pMeas         Measurements, the first one is the base.
+ * \param pNumMeas      Number of measurements, returns the number encoded.
+ *                      Stops at a difference of more than 2^31 ms.
+ *
+ * \return Length of the frame, 0 if not even one measurement fits.
+ */
+/*============================================================================*/
+uint8_t sf_measFrame_encode(uint8_t *pBuf, uint8_t bufLen, const meas_t *pMeas,
+                            uint8_t *pNumMeas);
+
+/*============================================================================*/
+/**
+ * \brief Get the measurements of a high resolution or of a legacy
+ *        measurement frame. Legacy measurements have a millisecond part
+ *        of 0.
+ *
+ * \param pFrame        The frame, starting with the frame type.
+ * \param frameLen      Length of the frame.
+ * \param pMeas         Returns the measurements in the order of the frame.
+ * \param maxMeas       Size of pMeas.
+ *
+ * \return Number of measurements, 0 if the frame is malformed or is no
+ *         measurement frame.
+ */
+/*============================================================================*/
+uint8_t sf_measFrame_decode(const uint8_t *pFrame, uint8_t frameLen,
+                            meas_t *pMeas, uint8_t maxMeas);
+
+/*! @} */
+
+#endif /* __SF_MEAS_FRAME_H__ */
+
+#ifdef __cplusplus
+}
+#endif
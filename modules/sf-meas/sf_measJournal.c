@@ -0,0 +1,527 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Implementation of the measurement journal.
+*/
+
+/*=============================================================================
+                                INCLUDES
+=============================================================================*/
+/* Standard include */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+/* Stack include */
+#include "contiki.h"
+#include "contiki-crc16.h"
+#include "sys/log.h"
+#include "sys/energest.h"
+/* SDK includes */
+#if !CONTIKI_TARGET_COOJA
+#include "flash_interface.h"
+#endif
+/* Project specific include */
+#include "sf_persistentDataStorage.h"
+#include "sf_measFrame.h"
+#include "sf_measJournal.h"
+
+/*=============================================================================
+                                MACROS
+=============================================================================*/
+#define LOG_MODULE "Meas Journal"
+#ifndef LOG_CONF_APP
+  #define LOG_LEVEL     LOG_LEVEL_NONE
+#else
+  #define LOG_LEVEL     LOG_CONF_APP
+#endif
+/* Number of flash pages of the journal. The linker scripts reserve two
+   pages, they must be changed along with it. */
+#ifndef SF_CONF_MEASJOURNAL_PAGES
+  #define SF_MEASJOURNAL_PAGES           (2U)
+#else
+  #define SF_MEASJOURNAL_PAGES           SF_CONF_MEASJOURNAL_PAGES
+#endif
+/* Length of a block in flash */
+#define SF_MEASJOURNAL_BLOCK_LEN         (128U)
+/* Length of the encoded records of a block: the block without state, count,
+   sequence number, length and CRC */
+#define SF_MEASJOURNAL_PAYLOAD_LEN       (SF_MEASJOURNAL_BLOCK_LEN - 7U)
+/* Maximum number of records of a block, all following the first one within
+   +-63 ms, i.e. with a delta of 1 byte */
+#define SF_MEASJOURNAL_BLOCK_RECORDS     ((SF_MEASJOURNAL_PAYLOAD_LEN -\
+                                           SF_MEAS_FRAME_HR_LEN_MIN) / 5U + 1U)
+/* Journal base address, below the pages of the persistent data storage */
+#define SF_MEASJOURNAL_BASEADDR          (SF_PERSISTENTDATASTORAGE_FLASH_SIZE -\
+                                          (SF_PERSISTENTDATASTORAGE_PAGES_USED +\
+                                           SF_MEASJOURNAL_PAGES) *\
+                                          SF_PERSISTENTDATASTORAGE_PAGE_SIZE)
+/* Number of blocks per page */
+#define SF_MEASJOURNAL_PAGE_BLOCKS       (SF_PERSISTENTDATASTORAGE_PAGE_SIZE /\
+                                          sizeof(sf_measJournal_block_t))
+/* Block states. A state is changed by clearing bits only. */
+#define SF_MEASJOURNAL_STATE_ERASED      (0xFFU)
+#define SF_MEASJOURNAL_STATE_VALID       (0x7FU)
+#define SF_MEASJOURNAL_STATE_REPLAYED    (0x3FU)
+
+/*=============================================================================
+                                STRUCTS
+=============================================================================*/
+/*! Block of records as written to flash */
+PACKED_STRUCT(typedef struct
+{
+  /* Block state, not covered by the CRC. */
+  uint8_t state;
+  /* Number of records */
+  uint8_t count;
+  /* Sequence number, incremented with every block. */
+  uint16_t seq;
+  /* Length of the encoded records */
+  uint8_t len;
+  /* Records encoded as a high resolution measurement frame: the first one
+     with the full timestamp, the following ones with the difference to
+     the one before. Unused bytes are left erased. */
+  uint8_t payload[SF_MEASJOURNAL_PAYLOAD_LEN];
+  /* The calculated CRC from count to the end of the payload. */
+  uint16_t crc;
+}, sf_measJournal_block_t);
+
+/*=============================================================================
+                                GLOBAL VARIABLES
+=============================================================================*/
+/* Records not written to flash yet, oldest first. */
+static meas_t gBatch[SF_MEASJOURNAL_BLOCK_RECORDS];
+static uint8_t gBatchCount;
+/* Number of records returned by the last peek and the source of them. */
+static uint8_t gPeekCount;
+static bool gPeekFromFlash;
+#if !CONTIKI_TARGET_COOJA
+/* Position of the next block to be written and its sequence number. */
+static uint8_t gWritePage;
+static uint16_t gWriteIdx;
+static uint16_t gWriteSeq;
+/* Position of the oldest block not replayed yet and the number of records
+   of it that have been replayed. */
+static bool gReadValid;
+static uint8_t gReadPage;
+static uint16_t gReadIdx;
+static uint8_t gReadOffset;
+#endif
+
+/*==============================================================================
+                         LOCAL FUNCTION DEFINITION
+==============================================================================*/
+#if !CONTIKI_TARGET_COOJA
+/*============================================================================*/
+/**
+ * \brief Returns the flash address of a block.
+ */
+/*============================================================================*/
+static uint32_t loc_blockAddress(uint8_t page, uint16_t idx);
+
+/*============================================================================*/
+/**
+ * \brief Read a block and check its CRC.
+ *
+ * \param page      Journal page.
+ * \param idx       Index of the block in the page.
+ * \param pBlock    Pointer to the block storage.
+ *
+ * \return True if the block has been written completely.
+ */
+/*============================================================================*/
+static bool loc_readBlock(uint8_t page, uint16_t idx,
+                          sf_measJournal_block_t *pBlock);
+
+/*============================================================================*/
+/**
+ * \brief Find the oldest block not replayed yet.
+ */
+/*============================================================================*/
+static void loc_findOldest(void);
+
+/*============================================================================*/
+/**
+ * \brief Encode as many of the records collected in RAM as fit into a block.
+ *
+ * \param pBlock    Pointer to the block storage.
+ *
+ * \return Number of records encoded.
+ */
+/*============================================================================*/
+static uint8_t loc_encode(sf_measJournal_block_t *pBlock);
+
+/*============================================================================*/
+/**
+ * \brief Write an encoded block and remove its records from RAM.
+ *
+ * \param pBlock    Pointer to the encoded block.
+ *
+ * \return True on success.
+ */
+/*============================================================================*/
+static bool loc_flush(sf_measJournal_block_t *pBlock);
+#endif /* !CONTIKI_TARGET_COOJA */
+
+/*==============================================================================
+                         LOCAL FUNCTION IMPLEMENTATION
+==============================================================================*/
+#if !CONTIKI_TARGET_COOJA
+/*------------------------------------------------------------------------------
+  loc_blockAddress()
+------------------------------------------------------------------------------*/
+static uint32_t loc_blockAddress(uint8_t page, uint16_t idx)
+{
+  return (uint32_t)SF_MEASJOURNAL_BASEADDR +
+         (uint32_t)page * SF_PERSISTENTDATASTORAGE_PAGE_SIZE +
+         (uint32_t)idx * sizeof(sf_measJournal_block_t);
+}/* loc_blockAddress() */
+
+/*------------------------------------------------------------------------------
+  loc_readBlock()
+------------------------------------------------------------------------------*/
+static bool loc_readBlock(uint8_t page, uint16_t idx,
+                          sf_measJournal_block_t *pBlock)
+{
+  if(FLASH_SUCCESS != readFlash(loc_blockAddress(page, idx), (uint8_t*)pBlock,
+                                sizeof(sf_measJournal_block_t)))
+  {
+    return false;
+  }
+
+  /* A block cut by a power loss fails the CRC check. */
+  return (SF_MEASJOURNAL_STATE_ERASED != pBlock->state) &&
+         (0U != pBlock->count) &&
+         (SF_MEASJOURNAL_BLOCK_RECORDS >= pBlock->count) &&
+         (SF_MEASJOURNAL_PAYLOAD_LEN >= pBlock->len) &&
+         (pBlock->crc == crc16_data(&pBlock->count,
+                                    sizeof(sf_measJournal_block_t) -
+                                    sizeof(pBlock->state) - sizeof(pBlock->crc),
+                                    0));
+}/* loc_readBlock() */
+
+/*------------------------------------------------------------------------------
+  loc_findOldest()
+------------------------------------------------------------------------------*/
+static void loc_findOldest(void)
+{
+  /* Block being checked */
+  sf_measJournal_block_t block;
+  /* Sequence number of the oldest block */
+  uint16_t oldestSeq = 0;
+  uint8_t page;
+  uint16_t idx;
+
+  gReadValid = false;
+  gReadOffset = 0;
+
+  for(page = 0; page < SF_MEASJOURNAL_PAGES; page++)
+  {
+    for(idx = 0; idx < SF_MEASJOURNAL_PAGE_BLOCKS; idx++)
+    {
+      if(loc_readBlock(page, idx, &block) &&
+         (SF_MEASJOURNAL_STATE_VALID == block.state) &&
+         (!gReadValid || ((int16_t)(block.seq - oldestSeq) < 0)))
+      {
+        oldestSeq = block.seq;
+        gReadPage = page;
+        gReadIdx = idx;
+        gReadValid = true;
+      }
+    }
+  }
+}/* loc_findOldest() */
+
+/*------------------------------------------------------------------------------
+  loc_encode()
+------------------------------------------------------------------------------*/
+static uint8_t loc_encode(sf_measJournal_block_t *pBlock)
+{
+  memset(pBlock, SF_MEASJOURNAL_STATE_ERASED, sizeof(sf_measJournal_block_t));
+  pBlock->count = gBatchCount;
+  pBlock->len = sf_measFrame_encode(pBlock->payload, sizeof(pBlock->payload),
+                                    gBatch, &pBlock->count);
+
+  return pBlock->count;
+}/* loc_encode() */
+
+/*------------------------------------------------------------------------------
+  loc_flush()
+------------------------------------------------------------------------------*/
+static bool loc_flush(sf_measJournal_block_t *pBlock)
+{
+  /* State of the block slot being checked */
+  uint8_t state;
+  /* Status of the flash operation */
+  uint8_t status;
+
+  /* Skip slots used by a block cut by a power loss. */
+  while(0U != gWriteIdx)
+  {
+    if(gWriteIdx >= SF_MEASJOURNAL_PAGE_BLOCKS)
+    {
+      gWritePage = (gWritePage + 1U) % SF_MEASJOURNAL_PAGES;
+      gWriteIdx = 0;
+      break;
+    }
+    if((FLASH_SUCCESS == readFlash(loc_blockAddress(gWritePage, gWriteIdx),
+                                   &state, 1)) &&
+       (SF_MEASJOURNAL_STATE_ERASED == state))
+    {
+      break;
+    }
+    gWriteIdx++;
+  }
+
+  if(0U == gWriteIdx)
+  {
+    /* Start of a page. Overwrite the oldest records if the journal is full.
+       The erase only happens every page of records. */
+    ENERGEST_ON(ENERGEST_TYPE_SF_FLASH);
+    status = eraseFlashPg(loc_blockAddress(gWritePage, 0) /
+                          SF_PERSISTENTDATASTORAGE_PAGE_SIZE);
+    ENERGEST_OFF(ENERGEST_TYPE_SF_FLASH);
+    if(FLASH_SUCCESS != status)
+    {
+      return false;
+    }
+    if(gReadValid && (gReadPage == gWritePage))
+    {
+      LOG_WARN("Journal full, oldest records dropped\n");
+      loc_findOldest();
+      gPeekCount = gPeekFromFlash ? 0U : gPeekCount;
+    }
+  }
+
+  pBlock->state = SF_MEASJOURNAL_STATE_VALID;
+  pBlock->seq = gWriteSeq;
+  pBlock->crc = crc16_data(&pBlock->count, sizeof(sf_measJournal_block_t) -
+                           sizeof(pBlock->state) - sizeof(pBlock->crc), 0);
+
+  /* The complete block is programmed at once. */
+  ENERGEST_ON(ENERGEST_TYPE_SF_FLASH);
+  status = writeFlash(loc_blockAddress(gWritePage, gWriteIdx),
+                      (uint8_t*)pBlock, sizeof(sf_measJournal_block_t));
+  ENERGEST_OFF(ENERGEST_TYPE_SF_FLASH);
+  if(FLASH_SUCCESS != status)
+  {
+    return false;
+  }
+
+  if(!gReadValid)
+  {
+    gReadValid = true;
+    gReadPage = gWritePage;
+    gReadIdx = gWriteIdx;
+    gReadOffset = 0;
+  }
+
+  gWriteSeq++;
+  gWriteIdx++;
+  memmove(&gBatch[0], &gBatch[pBlock->count],
+          (gBatchCount - pBlock->count) * sizeof(meas_t));
+  gBatchCount -= pBlock->count;
+  /* A pending peek of the RAM records is void. */
+  gPeekCount = gPeekFromFlash ? gPeekCount : 0U;
+
+  return true;
+}/* loc_flush() */
+#endif /* !CONTIKI_TARGET_COOJA */
+
+/*=============================================================================
+                                API IMPLEMENTATION
+=============================================================================*/
+/*------------------------------------------------------------------------------
+  sf_measJournal_init()
+------------------------------------------------------------------------------*/
+void sf_measJournal_init(void)
+{
+#if !CONTIKI_TARGET_COOJA
+  /* Block being checked */
+  sf_measJournal_block_t block;
+  /* Whether a block has been found */
+  bool found = false;
+  uint8_t page;
+  uint16_t idx;
+
+  gWritePage = 0;
+  gWriteIdx = 0;
+  gWriteSeq = 0;
+
+  /* Continue after the newest block. */
+  for(page = 0; page < SF_MEASJOURNAL_PAGES; page++)
+  {
+    for(idx = 0; idx < SF_MEASJOURNAL_PAGE_BLOCKS; idx++)
+    {
+      if(loc_readBlock(page, idx, &block) &&
+         (!found || ((int16_t)(block.seq - gWriteSeq) >= 0)))
+      {
+        gWriteSeq = block.seq;
+        gWritePage = page;
+        gWriteIdx = idx;
+        found = true;
+      }
+    }
+  }
+
+  if(found)
+  {
+    gWriteSeq++;
+    gWriteIdx++;
+  }
+
+  loc_findOldest();
+#endif
+
+  gBatchCount = 0;
+  gPeekCount = 0;
+}/* sf_measJournal_init() */
+
+/*------------------------------------------------------------------------------
+  sf_measJournal_add()
+------------------------------------------------------------------------------*/
+bool sf_measJournal_add(const meas_t* pMeas)
+{
+#if !CONTIKI_TARGET_COOJA
+  /* Block to be written */
+  sf_measJournal_block_t block;
+#endif
+
+  if(NULL == pMeas)
+  {
+    return false;
+  }
+
+  if(SF_MEASJOURNAL_BLOCK_RECORDS == gBatchCount)
+  {
+    /* The block could not be written, keep the newest records. */
+    memmove(&gBatch[0], &gBatch[1],
+            (SF_MEASJOURNAL_BLOCK_RECORDS - 1U) * sizeof(meas_t));
+    gBatchCount--;
+    gPeekCount = gPeekFromFlash ? gPeekCount : 0U;
+  }
+
+  memcpy(&gBatch[gBatchCount], pMeas, sizeof(meas_t));
+  gBatchCount++;
+
+#if !CONTIKI_TARGET_COOJA
+  /* A block is written once the new record does not fit any more, with
+     the records before it. */
+  if((loc_encode(&block) < gBatchCount) ||
+     (SF_MEASJOURNAL_BLOCK_RECORDS == gBatchCount))
+  {
+    if(!loc_flush(&block))
+    {
+      LOG_ERR("Journal write failed\n");
+    }
+  }
+#endif
+
+  return true;
+}/* sf_measJournal_add() */
+
+/*------------------------------------------------------------------------------
+  sf_measJournal_peek()
+------------------------------------------------------------------------------*/
+uint8_t sf_measJournal_peek(meas_t* pMeas, uint8_t maxMeas)
+{
+  /* Records to be returned */
+  const meas_t *pRecords = gBatch;
+  /* Number of records available */
+  uint8_t count = gBatchCount;
+#if !CONTIKI_TARGET_COOJA
+  /* Block being replayed and its records */
+  sf_measJournal_block_t block;
+  meas_t records[SF_MEASJOURNAL_BLOCK_RECORDS];
+
+  gPeekFromFlash = false;
+
+  /* Flash records are older than the RAM records. */
+  while(gReadValid)
+  {
+    if(loc_readBlock(gReadPage, gReadIdx, &block) &&
+       (SF_MEASJOURNAL_STATE_VALID == block.state) &&
+       (gReadOffset < block.count) &&
+       (block.count == sf_measFrame_decode(block.payload, block.len, records,
+                                           SF_MEASJOURNAL_BLOCK_RECORDS)))
+    {
+      pRecords = &records[gReadOffset];
+      count = block.count - gReadOffset;
+      gPeekFromFlash = true;
+      break;
+    }
+    /* The block became invalid, e.g. it has been overwritten. */
+    loc_findOldest();
+  }
+#else
+  gPeekFromFlash = false;
+#endif
+
+  if((NULL == pMeas) || (0U == maxMeas))
+  {
+    gPeekCount = 0;
+    return 0;
+  }
+
+  gPeekCount = MIN(count, maxMeas);
+  memcpy(pMeas, pRecords, gPeekCount * sizeof(meas_t));
+
+  return gPeekCount;
+}/* sf_measJournal_peek() */
+
+/*------------------------------------------------------------------------------
+  sf_measJournal_commit()
+------------------------------------------------------------------------------*/
+void sf_measJournal_commit(uint8_t numMeas)
+{
+  /* Only the records of the last peek can be removed. */
+  numMeas = MIN(numMeas, gPeekCount);
+  gPeekCount = 0;
+
+  if(0U == numMeas)
+  {
+    return;
+  }
+
+#if !CONTIKI_TARGET_COOJA
+  if(gPeekFromFlash)
+  {
+    /* Block being replayed */
+    sf_measJournal_block_t block;
+    /* Replayed state */
+    uint8_t state = SF_MEASJOURNAL_STATE_REPLAYED;
+
+    gReadOffset += numMeas;
+    if(!loc_readBlock(gReadPage, gReadIdx, &block) ||
+       (gReadOffset >= block.count))
+    {
+      /* Block completely replayed. Only the state byte is programmed. */
+      ENERGEST_ON(ENERGEST_TYPE_SF_FLASH);
+      writeFlash(loc_blockAddress(gReadPage, gReadIdx), &state, 1);
+      ENERGEST_OFF(ENERGEST_TYPE_SF_FLASH);
+      loc_findOldest();
+    }
+    return;
+  }
+#endif
+
+  memmove(&gBatch[0], &gBatch[numMeas],
+          (gBatchCount - numMeas) * sizeof(meas_t));
+  gBatchCount -= numMeas;
+}/* sf_measJournal_commit() */
+
+#ifdef __cplusplus
+}
+#endif
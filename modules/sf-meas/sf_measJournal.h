@@ -0,0 +1,110 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __SF_MEAS_JOURNAL_H__
+#define __SF_MEAS_JOURNAL_H__
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Flash journal of the measurements taken while disconnected.
+
+ @details The measurements are collected in RAM and written to flash in
+          blocks of several records. This bounds the flash write rate and the
+          program operations per flash row. The records of a block are delta
+          encoded as a high resolution measurement frame, a block is written
+          once the next record does not fit any more. The blocks form a
+          circular log on the journal pages below the persistent data
+          storage. If the journal is full, the oldest page is overwritten.
+          Once connected, the records are replayed oldest first. A block is
+          marked as replayed in flash as soon as all its records have been
+          acknowledged, so the journal survives a reboot. The records of a
+          partly replayed block are sent again after a reboot.
+*/
+
+/**
+ *  @addtogroup SF_MEAS
+ *
+ *  @details
+ *
+ *  - <b>Measurement journal API</b>\n
+ *    | API Function                              | Description                                     |
+ *    |-------------------------------------------|-------------------------------------------------|
+ *    | @ref sf_measJournal_init()                | @copybrief sf_measJournal_init()                |
+ *    | @ref sf_measJournal_add()                 | @copybrief sf_measJournal_add()                 |
+ *    | @ref sf_measJournal_peek()                | @copybrief sf_measJournal_peek()                |
+ *    | @ref sf_measJournal_commit()              | @copybrief sf_measJournal_commit()              |
+ *  @{
+ */
+
+/*=============================================================================
+                                INCLUDES
+=============================================================================*/
+/* Standard include */
+#include <stdint.h>
+#include <stdbool.h>
+/* Project specific include */
+#include "measHandler_api.h"
+
+/*=============================================================================
+                                API FUNCTIONS
+=============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Initialize the journal. Finds the write position and the oldest
+ *        record not replayed yet in flash.
+ */
+/*============================================================================*/
+void sf_measJournal_init(void);
+
+/*============================================================================*/
+/**
+ * \brief Add a measurement which could not be sent.
+ *
+ * \param pMeas     Pointer to the measurement.
+ *
+ * \return True if the measurement has been added.
+ */
+/*============================================================================*/
+bool sf_measJournal_add(const meas_t* pMeas);
+
+/*============================================================================*/
+/**
+ * \brief Copy the oldest measurements to be replayed. They stay in the journal
+ *        until @ref sf_measJournal_commit is called.
+ *
+ * \param pMeas     Pointer to the measurement storage.
+ * \param maxMeas   Maximum number of measurements.
+ *
+ * \return Number of measurements copied.
+ */
+/*============================================================================*/
+uint8_t sf_measJournal_peek(meas_t* pMeas, uint8_t maxMeas);
+
+/*============================================================================*/
+/**
+ * \brief Remove the given number of the oldest measurements, i.e. the ones
+ *        returned by @ref sf_measJournal_peek and acknowledged by the BMS-CC.
+ *
+ * \param numMeas   Number of measurements.
+ */
+/*============================================================================*/
+void sf_measJournal_commit(uint8_t numMeas);
+
+/*! @} */
+
+#endif /* __SF_MEAS_JOURNAL_H__ */
+
+#ifdef __cplusplus
+}
+#endif
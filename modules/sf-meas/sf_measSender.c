@@ -37,8 +37,16 @@ extern "C" {
 #include "sf_measSender.h"
 #include "sf_configMgmt.h"
 #include "measHandler_api.h"
-#include "sf_absoluteTime.h"
 #include "sf_tsch.h"
+#include "sf_joinRequester.h"
+#include "sf_linkQuality.h"
+#include "sf_measJournal.h"
+#include "sf_measFrame.h"
+#include "sf_bootProfile.h"
+#include "sf_energy.h"
+#include "sf_slotStats.h"
+#include "sf_memMonitor.h"
+#include "sf_cycleQueue.h"
 
 /*=============================================================================
                                 MACROS
@@ -51,6 +59,55 @@ extern "C" {
 #endif
 /* The maximum length of payload */
 #define SF_APP_PAYLOAD_LENGTH_MAX        (40U)
+/* Send measurements with millisecond timestamps (E_FRAME_TYPE_MEASUREMENT_HR,
+   see sf_measFrame.h). The BMS-CC tells the formats apart by the frame type
+   and decodes both with sf_measFrame_decode(). Set to 0 for BMS-CCs that
+   have not been updated and only decode E_FRAME_TYPE_MEASUREMENT. */
+#ifndef SF_CONF_MEAS_HR_TIMESTAMP
+  #define SF_MEAS_HR_TIMESTAMP           1
+#else
+  #define SF_MEAS_HR_TIMESTAMP           SF_CONF_MEAS_HR_TIMESTAMP
+#endif
+/* Interval of the link quality report in seconds. 0 disables the report. */
+#ifndef SF_CONF_MEAS_LINK_QUALITY_INTERVAL
+  #define SF_MEAS_LINK_QUALITY_INTERVAL  (10UL * 60UL)
+#else
+  #define SF_MEAS_LINK_QUALITY_INTERVAL  SF_CONF_MEAS_LINK_QUALITY_INTERVAL
+#endif
+/* Interval of the energy report in seconds. 0 disables the report. */
+#ifndef SF_CONF_MEAS_ENERGY_INTERVAL
+  #define SF_MEAS_ENERGY_INTERVAL        (60UL * 60UL)
+#else
+  #define SF_MEAS_ENERGY_INTERVAL        SF_CONF_MEAS_ENERGY_INTERVAL
+#endif
+/* Interval of the slot statistics report in seconds. 0 disables the report. */
+#ifndef SF_CONF_MEAS_SLOT_STATS_INTERVAL
+  #define SF_MEAS_SLOT_STATS_INTERVAL    (60UL * 60UL)
+#else
+  #define SF_MEAS_SLOT_STATS_INTERVAL    SF_CONF_MEAS_SLOT_STATS_INTERVAL
+#endif
+/* Interval of the memory report in seconds. 0 disables the report. */
+#ifndef SF_CONF_MEAS_MEMORY_INTERVAL
+  #define SF_MEAS_MEMORY_INTERVAL        (6UL * 60UL * 60UL)
+#else
+  #define SF_MEAS_MEMORY_INTERVAL        SF_CONF_MEAS_MEMORY_INTERVAL
+#endif
+/* The maximum length of the link quality report frame */
+#define SF_APP_REPORT_LENGTH_MAX         (64U)
+/* Number of journal measurements appended to a measurement frame. */
+#ifndef SF_CONF_MEAS_JOURNAL_REPLAY
+  #define SF_MEAS_JOURNAL_REPLAY         (2U)
+#else
+  #define SF_MEAS_JOURNAL_REPLAY         SF_CONF_MEAS_JOURNAL_REPLAY
+#endif
+/* Length of a measurement in the journal frame: timestamp (4byte),
+   timestamp ms (2byte) and value (4byte). Literal, as it is checked by
+   the preprocessor. */
+#define SF_MEAS_JOURNAL_RECORD_LEN       (4U + 2U + 4U)
+#if (SF_FRAME_TYPE_LEN + 1U + (SF_MEAS_JOURNAL_REPLAY + 1U) *\
+     SF_MEAS_JOURNAL_RECORD_LEN) > SF_APP_PAYLOAD_LENGTH_MAX
+  #error "SF_MEAS_JOURNAL_REPLAY exceeds the measurement frame"
+#endif
 
 /*=============================================================================
                                 GLOBAL VARIABLES
@@ -58,14 +115,33 @@ extern "C" {
 /* Stores callback handler context parameters. */
 static sf_callbackHandlerCtxt_t gMeasCallbackHandlerCtxt = {sf_measSender_output_callback,
                                                             NULL};
+/* Stores callback handler context parameters of the link quality report. */
+static sf_callbackHandlerCtxt_t gReportCallbackHandlerCtxt = {sf_measSender_report_callback,
+                                                              NULL};
+/* Stores callback handler context parameters of the boot profile report. */
+static sf_callbackHandlerCtxt_t gBootCallbackHandlerCtxt = {sf_measSender_bootProfile_callback,
+                                                            NULL};
 /* Event object */
 static process_event_t tx_event;
+/* Time of the last link quality report in seconds. */
+static unsigned long gLastReport;
+/* First entry of the next part of the link quality report, 0 if none. */
+static uint8_t gReportNext;
+/* Time of the last energy report in seconds. */
+static unsigned long gLastEnergyReport;
+/* Time of the last slot statistics report in seconds. */
+static unsigned long gLastSlotStatsReport;
+/* Time of the last memory report in seconds. */
+static unsigned long gLastMemoryReport;
+/* Number of journal measurements in the pending measurement frame. */
+static uint8_t gJournalSent;
 
 /*=============================================================================
                                 PROCESSES
 =============================================================================*/
 PROCESS(meas_read_process, "Meas read process");
 PROCESS(meas_tx_process, "Meas Tx process");
+PROCESS(meas_cycle_process, "Meas cycle process");
 
 /*==============================================================================
                          LOCAL FUNCTION DEFINITION
@@ -76,10 +152,72 @@ PROCESS(meas_tx_process, "Meas Tx process");
  *
  * \param pAddr            Destination address.
  * \param pMeas            Pointer to the measurement.
- * \param measLen          Length of the measurement.
  */
 /*============================================================================*/
-static void loc_sendMeas(linkaddr_t *pAddr, const uint8_t* pMeas, uint8_t measLen);
+static void loc_sendMeas(linkaddr_t *pAddr, const meas_t* pMeas);
+
+/*============================================================================*/
+/**
+ * \brief Builds the link quality report frame and schedules it to be sent to
+ *        the BMS-CC.
+ *
+ * \param pAddr            Destination address.
+ */
+/*============================================================================*/
+static void loc_sendLinkQuality(linkaddr_t *pAddr);
+
+/*============================================================================*/
+/**
+ * \brief Builds the boot profile report frame and schedules it to be sent to
+ *        the BMS-CC, once per boot after the first measurement.
+ *
+ * \param pAddr            Destination address.
+ */
+/*============================================================================*/
+static void loc_sendBootProfile(linkaddr_t *pAddr);
+
+/*============================================================================*/
+/**
+ * \brief Builds the energy report frame and schedules it to be sent to the
+ *        BMS-CC.
+ *
+ * \param pAddr            Destination address.
+ */
+/*============================================================================*/
+static void loc_sendEnergy(linkaddr_t *pAddr);
+
+/*============================================================================*/
+/**
+ * \brief Builds the slot statistics report frame and schedules it to be sent
+ *        to the BMS-CC.
+ *
+ * \param pAddr            Destination address.
+ */
+/*============================================================================*/
+static void loc_sendSlotStats(linkaddr_t *pAddr);
+
+/*============================================================================*/
+/**
+ * \brief Builds the memory report frame and schedules it to be sent to the
+ *        BMS-CC.
+ *
+ * \param pAddr            Destination address.
+ */
+/*============================================================================*/
+static void loc_sendMemory(linkaddr_t *pAddr);
+
+/*============================================================================*/
+/**
+ * \brief Builds the measurement journal frame and schedules it to be sent to
+ *        the BMS-CC.
+ *
+ * \param pAddr            Destination address.
+ * \param pMeas            Pointer to the measurements, the current one first.
+ * \param numMeas          Number of measurements.
+ */
+/*============================================================================*/
+static void loc_sendMeasJournal(linkaddr_t *pAddr, const meas_t* pMeas,
+                                uint8_t numMeas);
 
 /*==============================================================================
                          LOCAL FUNCTION IMPLEMENTATION
@@ -87,22 +225,32 @@ static void loc_sendMeas(linkaddr_t *pAddr, const uint8_t* pMeas, uint8_t measLe
 /*----------------------------------------------------------------------------*/
 /*! loc_sendMeas */
 /*----------------------------------------------------------------------------*/
-static void loc_sendMeas(linkaddr_t *pAddr, const uint8_t* pMeas, uint8_t measLen)
+static void loc_sendMeas(linkaddr_t *pAddr, const meas_t* pMeas)
 {
   /* Storage for the measurement frame. */
   uint8_t pFrameBuf[SF_APP_PAYLOAD_LENGTH_MAX] = {0x00};
   /* Frame length */
   uint8_t frameLen = 0;
+#if SF_MEAS_HR_TIMESTAMP
+  /* Number of measurements in the frame */
+  uint8_t numMeas = 1U;
 
+  /* Build high resolution measurement frame, see sf_measFrame.h */
+  frameLen = sf_measFrame_encode(pFrameBuf, sizeof(pFrameBuf), pMeas, &numMeas);
+#else
   /* Build measurement frame
      frame type  |  timestamp  |  measurement
      ------------|-------------|-------------
-        1byte    |    4byte    |  nbyte     */
+        1byte    |    4byte    |    4byte    */
   sf_frameType_set(pFrameBuf, E_FRAME_TYPE_MEASUREMENT);
   frameLen += SF_FRAME_TYPE_LEN;
 
-  memcpy(pFrameBuf + frameLen, pMeas, measLen);
-  frameLen += measLen;
+  memcpy(pFrameBuf + frameLen, &pMeas->timeStamp, sizeof(pMeas->timeStamp));
+  frameLen += sizeof(pMeas->timeStamp);
+
+  memcpy(pFrameBuf + frameLen, &pMeas->value, sizeof(pMeas->value));
+  frameLen += sizeof(pMeas->value);
+#endif
 
   LOG_INFO("New packet is transmitted to the BMS-CC; ");
   LOG_INFO_LLADDR(pAddr);
@@ -114,11 +262,214 @@ static void loc_sendMeas(linkaddr_t *pAddr, const uint8_t* pMeas, uint8_t measLe
   sf_tsch_send(pFrameBuf, frameLen, pAddr, &gMeasCallbackHandlerCtxt);
 }/* loc_sendMeas() */
 
+/*----------------------------------------------------------------------------*/
+/*! loc_sendLinkQuality */
+/*----------------------------------------------------------------------------*/
+static void loc_sendLinkQuality(linkaddr_t *pAddr)
+{
+  /* Storage for the link quality report frame. */
+  uint8_t pFrameBuf[SF_APP_REPORT_LENGTH_MAX] = {0x00};
+  /* Frame length */
+  uint8_t frameLen = 0;
+  /* Maximum frame length of the timeslot profile */
+  uint8_t maxLen = sf_tsch_getMaxPayloadLen();
+  /* Length of the report part */
+  uint8_t reportLen;
+
+  if(maxLen > sizeof(pFrameBuf))
+  {
+    maxLen = sizeof(pFrameBuf);
+  }
+  else if(maxLen < SF_FRAME_TYPE_LEN)
+  {
+    maxLen = SF_FRAME_TYPE_LEN;
+  }
+
+  /* Build link quality report frame
+     frame type  |  report part
+     ------------|---------------------------------
+        1byte    |  see sf_linkQuality_getReport() */
+  sf_frameType_set(pFrameBuf, E_FRAME_TYPE_LINK_QUALITY);
+  frameLen += SF_FRAME_TYPE_LEN;
+
+  reportLen = sf_linkQuality_getReport(pFrameBuf + frameLen,
+                                       maxLen - frameLen, &gReportNext);
+  if(0U == reportLen)
+  {
+    LOG_ERR("! link quality report does not fit into %u bytes\n", maxLen);
+    gReportNext = 0U;
+    return;
+  }
+  frameLen += reportLen;
+
+  LOG_INFO("Link quality report is transmitted to the BMS-CC; ");
+  LOG_INFO_BYTES(pFrameBuf, frameLen);
+  LOG_INFO_("\n");
+
+  /* Schedule frame Tx */
+  sf_tsch_send(pFrameBuf, frameLen, pAddr, &gReportCallbackHandlerCtxt);
+}/* loc_sendLinkQuality() */
+
+/*----------------------------------------------------------------------------*/
+/*! loc_sendBootProfile */
+/*----------------------------------------------------------------------------*/
+static void loc_sendBootProfile(linkaddr_t *pAddr)
+{
+  /* Storage for the boot profile report frame. */
+  uint8_t pFrameBuf[SF_APP_REPORT_LENGTH_MAX] = {0x00};
+  /* Frame length */
+  uint8_t frameLen = 0;
+
+  /* Build boot profile report frame
+     frame type  |  report
+     ------------|---------------------------------
+        1byte    |  see sf_bootProfile_getReport() */
+  sf_frameType_set(pFrameBuf, E_FRAME_TYPE_BOOT_PROFILE);
+  frameLen += SF_FRAME_TYPE_LEN;
+
+  frameLen += sf_bootProfile_getReport(pFrameBuf + frameLen,
+                                       sizeof(pFrameBuf) - frameLen);
+
+  LOG_INFO("Boot profile report is transmitted to the BMS-CC; ");
+  LOG_INFO_BYTES(pFrameBuf, frameLen);
+  LOG_INFO_("\n");
+
+  /* Schedule frame Tx */
+  sf_tsch_send(pFrameBuf, frameLen, pAddr, &gBootCallbackHandlerCtxt);
+}/* loc_sendBootProfile() */
+
+/*----------------------------------------------------------------------------*/
+/*! loc_sendEnergy */
+/*----------------------------------------------------------------------------*/
+static void loc_sendEnergy(linkaddr_t *pAddr)
+{
+  /* Storage for the energy report frame. */
+  uint8_t pFrameBuf[SF_APP_REPORT_LENGTH_MAX] = {0x00};
+  /* Frame length */
+  uint8_t frameLen = 0;
+
+  /* Build energy report frame
+     frame type  |  report
+     ------------|-----------------------------
+        1byte    |  see sf_energy_getReport() */
+  sf_frameType_set(pFrameBuf, E_FRAME_TYPE_ENERGY);
+  frameLen += SF_FRAME_TYPE_LEN;
+
+  frameLen += sf_energy_getReport(pFrameBuf + frameLen,
+                                  sizeof(pFrameBuf) - frameLen);
+
+  LOG_INFO("Energy report is transmitted to the BMS-CC; ");
+  LOG_INFO_BYTES(pFrameBuf, frameLen);
+  LOG_INFO_("\n");
+
+  /* Schedule frame Tx */
+  sf_tsch_send(pFrameBuf, frameLen, pAddr, &gReportCallbackHandlerCtxt);
+}/* loc_sendEnergy() */
+
+/*----------------------------------------------------------------------------*/
+/*! loc_sendSlotStats */
+/*----------------------------------------------------------------------------*/
+static void loc_sendSlotStats(linkaddr_t *pAddr)
+{
+  /* Storage for the slot statistics report frame. */
+  uint8_t pFrameBuf[SF_APP_REPORT_LENGTH_MAX] = {0x00};
+  /* Frame length */
+  uint8_t frameLen = 0;
+
+  /* Build slot statistics report frame
+     frame type  |  report
+     ------------|--------------------------------
+        1byte    |  see sf_slotStats_getReport() */
+  sf_frameType_set(pFrameBuf, E_FRAME_TYPE_SLOT_STATS);
+  frameLen += SF_FRAME_TYPE_LEN;
+
+  frameLen += sf_slotStats_getReport(pFrameBuf + frameLen,
+                                     sizeof(pFrameBuf) - frameLen);
+
+  LOG_INFO("Slot statistics report is transmitted to the BMS-CC; ");
+  LOG_INFO_BYTES(pFrameBuf, frameLen);
+  LOG_INFO_("\n");
+
+  /* Schedule frame Tx */
+  sf_tsch_send(pFrameBuf, frameLen, pAddr, &gReportCallbackHandlerCtxt);
+}/* loc_sendSlotStats() */
+
+/*----------------------------------------------------------------------------*/
+/*! loc_sendMemory */
+/*----------------------------------------------------------------------------*/
+static void loc_sendMemory(linkaddr_t *pAddr)
+{
+  /* Storage for the memory report frame. */
+  uint8_t pFrameBuf[SF_APP_REPORT_LENGTH_MAX] = {0x00};
+  /* Frame length */
+  uint8_t frameLen = 0;
+
+  /* Build memory report frame
+     frame type  |  report
+     ------------|----------------------------------
+        1byte    |  see sf_memMonitor_getReport() */
+  sf_frameType_set(pFrameBuf, E_FRAME_TYPE_MEMORY);
+  frameLen += SF_FRAME_TYPE_LEN;
+
+  frameLen += sf_memMonitor_getReport(pFrameBuf + frameLen,
+                                      sizeof(pFrameBuf) - frameLen);
+
+  LOG_INFO("Memory report is transmitted to the BMS-CC; ");
+  LOG_INFO_BYTES(pFrameBuf, frameLen);
+  LOG_INFO_("\n");
+
+  /* Schedule frame Tx */
+  sf_tsch_send(pFrameBuf, frameLen, pAddr, &gReportCallbackHandlerCtxt);
+}/* loc_sendMemory() */
+
+/*----------------------------------------------------------------------------*/
+/*! loc_sendMeasJournal */
+/*----------------------------------------------------------------------------*/
+static void loc_sendMeasJournal(linkaddr_t *pAddr, const meas_t* pMeas,
+                                uint8_t numMeas)
+{
+  /* Storage for the measurement journal frame. */
+  uint8_t pFrameBuf[SF_APP_PAYLOAD_LENGTH_MAX] = {0x00};
+  /* Frame length */
+  uint8_t frameLen = 0;
+  uint8_t i;
+
+  /* Build measurement journal frame
+     frame type  |  count  |  count x (timestamp | timestamp ms | measurement)
+     ------------|---------|---------------------------------------------------
+        1byte    |  1byte  |  count x (  4byte   |    2byte     |    4byte   ) */
+  sf_frameType_set(pFrameBuf, E_FRAME_TYPE_MEASUREMENT_JOURNAL);
+  frameLen += SF_FRAME_TYPE_LEN;
+
+  pFrameBuf[frameLen++] = numMeas;
+
+  for(i = 0; i < numMeas; i++)
+  {
+    memcpy(pFrameBuf + frameLen, &pMeas[i].timeStamp,
+           sizeof(pMeas[i].timeStamp));
+    frameLen += sizeof(pMeas[i].timeStamp);
+    memcpy(pFrameBuf + frameLen, &pMeas[i].timeStampMs,
+           sizeof(pMeas[i].timeStampMs));
+    frameLen += sizeof(pMeas[i].timeStampMs);
+    memcpy(pFrameBuf + frameLen, &pMeas[i].value, sizeof(pMeas[i].value));
+    frameLen += sizeof(pMeas[i].value);
+  }
+
+  LOG_INFO("New journal packet is transmitted to the BMS-CC; ");
+  LOG_INFO_LLADDR(pAddr);
+  LOG_INFO_("; ");
+  LOG_INFO_BYTES(pFrameBuf, frameLen);
+  LOG_INFO_("\n");
+
+  /* Schedule frame Tx */
+  sf_tsch_send(pFrameBuf, frameLen, pAddr, &gMeasCallbackHandlerCtxt);
+}/* loc_sendMeasJournal() */
+
 /*=============================================================================
                           PROCESSES IMPLEMENTATION
 =============================================================================*/
 /*------------------------------------------------------------------------------
-  meas_tx_process()
+  meas_read_process()
 ------------------------------------------------------------------------------*/
 PROCESS_THREAD(meas_read_process, ev, data)
 {
@@ -126,17 +477,15 @@ PROCESS_THREAD(meas_read_process, ev, data)
   static struct etimer periodicTimer;
   /* Stores measurement interval */
   static uint32_t measInterval;
+  /* Storage for a measurement which cannot be sent. */
+  meas_t meas;
 
   PROCESS_BEGIN();
 
-  /* Start absolute counting. */
-  sf_absoluteTime_startTimer();
-
   while(1)
   {
     /* Get configured measurement interval */
-    sf_configMgmt_getParam(&measInterval, sizeof(measInterval),
-                           E_CONFIGMGMT_PARAM_MEAS_INTERVAL);
+    measInterval = sf_configMgmt_getMeasInterval();
 
     /* Check if measurement interval is at highest rate
        i.e., the measurement interval is set to lowest limit.
@@ -144,8 +493,13 @@ PROCESS_THREAD(meas_read_process, ev, data)
        callback. Otherwise, we use the etimer interrupt. */
     if(SF_CONFIGMGMT_MEAS_INTERVAL_LIMIT_LOWER >= measInterval)
     {
+      /* Without TSCH the cycle start is not signalled. Keep measuring
+         with a timer meanwhile. */
+      etimer_set(&periodicTimer, measInterval * CLOCK_SECOND + CLOCK_SECOND / 2);
       LOG_INFO("Blocked until meas read time \n");
-      PROCESS_WAIT_EVENT_UNTIL(ev == tx_event);
+      PROCESS_WAIT_EVENT_UNTIL((ev == tx_event) ||
+                               etimer_expired(&periodicTimer));
+      etimer_stop(&periodicTimer);
     }
     else
     {
@@ -159,6 +513,16 @@ PROCESS_THREAD(meas_read_process, ev, data)
 
     /* Perform measurement */
     measHandler_performMeas();
+
+    if(!tsch_is_associated || E_CONFIGMGMT_DEVICESTATUS_NOT_CONNECTED ==
+       sf_configMgmt_getDeviceStatus())
+    {
+      /* Keep the measurement until the BMS-CC is reachable again. */
+      if(measHandler_getMeas(&meas))
+      {
+        sf_measJournal_add(&meas);
+      }
+    }
   }
 
   PROCESS_END();
@@ -171,10 +535,12 @@ PROCESS_THREAD(meas_tx_process, ev, data)
 {
   /* BMSCC address */
   linkaddr_t bmssccAddr = linkaddr_null;
-  /* Storage for the measurement */
-  meas_t meas;
+  /* Storage for the current measurement and the journal measurements */
+  meas_t meas[SF_MEAS_JOURNAL_REPLAY + 1U];
   /* Measurement handler return value */
   bool measRet = false;
+  /* Number of journal measurements */
+  uint8_t numJournal;
 
   PROCESS_BEGIN();
 
@@ -187,20 +553,90 @@ PROCESS_THREAD(meas_tx_process, ev, data)
     LOG_INFO("Blocked until transmission time...\n");
     PROCESS_WAIT_EVENT_UNTIL(ev == tx_event);
 
-    if(tsch_is_associated && E_CONFIGMGMT_DEVICESTATUS_CONNECTED ==
-       sf_configMgmt_getDeviceStatus())
+    if(data != NULL)
     {
-      measRet = measHandler_getMeas(&meas);
-      if(true == measRet)
-      {
-        /* Get the BMSCC linkaddr from the stored configuration. */
-        sf_configMgmt_getParam(bmssccAddr.u8, LINKADDR_SIZE,
-                                E_CONFIGMGMT_PARAM_GW_ADDR);
+      LOG_DBG("Cycle start at ASN %02x.%08lx\n",
+              ((const sf_cycleQueue_entry_t*)data)->asn.ms1b,
+              (unsigned long)((const sf_cycleQueue_entry_t*)data)->asn.ls4b);
+    }
 
-        /* Set the max number of transmissions, 2 = 1 transmission + 1 retry. */
-        packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS, 2U);
+    /* While a compact join is confirmed, the data frames are sent too. */
+    if(tsch_is_associated && E_CONFIGMGMT_DEVICESTATUS_NOT_CONNECTED !=
+       sf_configMgmt_getDeviceStatus())
+    {
+      /* Get the BMSCC linkaddr from the stored configuration. */
+      linkaddr_copy(&bmssccAddr, sf_configMgmt_getGwAddr());
 
-        loc_sendMeas(&bmssccAddr, (uint8_t*)&meas, sizeof(meas_t));
+      if(sf_bootProfile_isReportPending())
+      {
+        /* The boot profile takes the slot of the cycle after the first
+           measurement, so it includes the time of the first uplink. */
+        sf_tsch_setTxPolicy(E_SF_TSCH_TRAFFIC_REPORT, &bmssccAddr, 0U);
+        loc_sendBootProfile(&bmssccAddr);
+      }
+      else if((0U != gReportNext) || ((0U != SF_MEAS_LINK_QUALITY_INTERVAL) &&
+         (clock_seconds() - gLastReport >= SF_MEAS_LINK_QUALITY_INTERVAL)))
+      {
+        /* The report takes the slot of this cycle, the pending measurement
+           is sent in the next one. A report longer than the frame of the
+           timeslot profile is sent in parts in the following cycles. */
+        if(0U == gReportNext)
+        {
+          gLastReport = clock_seconds();
+        }
+        sf_tsch_setTxPolicy(E_SF_TSCH_TRAFFIC_REPORT, &bmssccAddr, 0U);
+        loc_sendLinkQuality(&bmssccAddr);
+      }
+      else if((0U != SF_MEAS_ENERGY_INTERVAL) &&
+         (clock_seconds() - gLastEnergyReport >= SF_MEAS_ENERGY_INTERVAL))
+      {
+        /* The totals are cumulative, a lost report is not sent again. */
+        gLastEnergyReport = clock_seconds();
+        sf_tsch_setTxPolicy(E_SF_TSCH_TRAFFIC_REPORT, &bmssccAddr, 0U);
+        loc_sendEnergy(&bmssccAddr);
+      }
+      else if((0U != SF_MEAS_SLOT_STATS_INTERVAL) &&
+         (clock_seconds() - gLastSlotStatsReport >= SF_MEAS_SLOT_STATS_INTERVAL))
+      {
+        /* The counters restart with each report, a lost report loses the
+           counts of its interval. */
+        gLastSlotStatsReport = clock_seconds();
+        sf_tsch_setTxPolicy(E_SF_TSCH_TRAFFIC_REPORT, &bmssccAddr, 0U);
+        loc_sendSlotStats(&bmssccAddr);
+      }
+      else if((0U != SF_MEAS_MEMORY_INTERVAL) &&
+         (clock_seconds() - gLastMemoryReport >= SF_MEAS_MEMORY_INTERVAL))
+      {
+        /* The watermarks are kept since the reset, a lost report is not
+           sent again. */
+        gLastMemoryReport = clock_seconds();
+        sf_tsch_setTxPolicy(E_SF_TSCH_TRAFFIC_REPORT, &bmssccAddr, 0U);
+        loc_sendMemory(&bmssccAddr);
+      }
+      else
+      {
+        measRet = measHandler_getMeas(&meas[0]);
+        /* Replay the measurements taken while disconnected along with the
+           current one. They are removed from the journal once ACKed. */
+        numJournal = sf_measJournal_peek(measRet ? &meas[1] : &meas[0],
+                                         SF_MEAS_JOURNAL_REPLAY);
+        gJournalSent = numJournal;
+        if((true == measRet) || (0U != numJournal))
+        {
+          /* Not sent any more once the next measurement is taken, it
+             would be refused while this one is queued. */
+          sf_tsch_setTxPolicy(E_SF_TSCH_TRAFFIC_MEAS, &bmssccAddr,
+                              sf_configMgmt_getMeasInterval());
+          if(0U == numJournal)
+          {
+            loc_sendMeas(&bmssccAddr, &meas[0]);
+          }
+          else
+          {
+            loc_sendMeasJournal(&bmssccAddr, meas,
+                                numJournal + (measRet ? 1U : 0U));
+          }
+        }
       }
     }
     else
@@ -212,6 +648,62 @@ PROCESS_THREAD(meas_tx_process, ev, data)
   PROCESS_END();
 }/* meas_tx_process() */
 
+/*------------------------------------------------------------------------------
+  meas_cycle_process()
+------------------------------------------------------------------------------*/
+PROCESS_THREAD(meas_cycle_process, ev, data)
+{
+  /* Entry to be processed. */
+  const sf_cycleQueue_entry_t *pEntry;
+  /* Statistics of the queue. */
+  sf_cycleQueue_stats_t stats;
+  /* Statistics reported so far. */
+  static sf_cycleQueue_stats_t reported;
+
+  PROCESS_BEGIN();
+
+  sf_cycleQueue_getStats(&reported);
+
+  while(1)
+  {
+    PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
+
+    /* Drain all pending entries. The slot is released only after the
+       consumers returned, so the producer never overwrites an entry in use. */
+    while((pEntry = sf_cycleQueue_peek()) != NULL)
+    {
+      /* Trigger TX process */
+      process_post_synch(&meas_tx_process, tx_event, (void*)pEntry);
+
+      /* Trigger meas read process */
+      process_post_synch(&meas_read_process, tx_event, (void*)pEntry);
+
+      sf_cycleQueue_release();
+    }
+
+    sf_cycleQueue_getStats(&stats);
+    if(reported.dropped != stats.dropped)
+    {
+      LOG_WARN("Cycle start queue full, dropped %u\n", stats.dropped);
+    }
+
+    if(reported.latencyMax != stats.latencyMax)
+    {
+      LOG_INFO("Cycle start drain latency max %lu us\n",
+               (unsigned long)RTIMERTICKS_TO_US(stats.latencyMax));
+    }
+
+    if(reported.enqueueMax != stats.enqueueMax)
+    {
+      LOG_INFO("Cycle start enqueue cost max %lu us\n",
+               (unsigned long)RTIMERTICKS_TO_US(stats.enqueueMax));
+    }
+    reported = stats;
+  }
+
+  PROCESS_END();
+}/* meas_cycle_process() */
+
 /*=============================================================================
                                 API IMPLEMENTATION
 =============================================================================*/
@@ -222,6 +714,20 @@ void sf_measSender_start(void)
 {
   tx_event = process_alloc_event();
 
+  sf_measJournal_init();
+  gJournalSent = 0U;
+
+  if(process_is_running(&meas_cycle_process))
+  {
+    process_exit(&meas_cycle_process);
+  }
+
+  /* The cycle start callback may still run while meas_cycle_process exits.
+     The queue keeps it out while it is reset. */
+  sf_cycleQueue_init();
+  gLastReport = clock_seconds();
+  gReportNext = 0U;
+
   if(process_is_running(&meas_read_process))
   {
     process_exit(&meas_read_process);
@@ -235,6 +741,8 @@ void sf_measSender_start(void)
   }
 
   process_start(&meas_tx_process, NULL);
+
+  process_start(&meas_cycle_process, NULL);
 } /* sf_measSender_start() */
 
 /*------------------------------------------------------------------------------
@@ -246,14 +754,48 @@ void sf_measSender_output_callback(void *ptr, nullnet_tx_status_t status)
   {
     LOG_INFO("Tx successful\n");
     measHandler_setStatus(E_MEAS_TX_SUCCESS);
+    sf_bootProfile_mark(E_SF_BOOTPROFILE_PHASE_FIRST_UPLINK);
+    sf_measJournal_commit(gJournalSent);
   }
   else
   {
     LOG_INFO("Tx failed\n");
     measHandler_setStatus(E_MEAS_TX_FAIL);
+    /* The journal measurements are sent again with the next frame. */
+    sf_measJournal_commit(0U);
   }
+  gJournalSent = 0U;
+
+  /* The first ACKed measurement completes a compact join. */
+  sf_joinRequester_dataTxDone(NULLNET_TX_OK == status);
 } /* sf_measSender_output_callback() */
 
+/*------------------------------------------------------------------------------
+  sf_measSender_report_callback()
+------------------------------------------------------------------------------*/
+void sf_measSender_report_callback(void *ptr, nullnet_tx_status_t status)
+{
+  LOG_INFO("Report Tx %s\n",
+           (NULLNET_TX_OK == status) ? "successful" : "failed");
+
+  sf_joinRequester_dataTxDone(NULLNET_TX_OK == status);
+} /* sf_measSender_report_callback() */
+
+/*------------------------------------------------------------------------------
+  sf_measSender_bootProfile_callback()
+------------------------------------------------------------------------------*/
+void sf_measSender_bootProfile_callback(void *ptr, nullnet_tx_status_t status)
+{
+  LOG_INFO("Boot profile report Tx %s\n",
+           (NULLNET_TX_OK == status) ? "successful" : "failed");
+
+  /* A lost report is sent again in the next cycle. */
+  if(NULLNET_TX_OK == status)
+  {
+    sf_bootProfile_setReported();
+  }
+} /* sf_measSender_bootProfile_callback() */
+
 /*=============================================================================
                                 CALLBACK IMPLEMENTATION
 =============================================================================*/
@@ -267,15 +809,27 @@ void sf_measSender_output_callback(void *ptr, nullnet_tx_status_t status)
                 i.e. measurement interval of 3s
  *          It replaces the usage of etimer events as it is impossible to set a
  *          timeout of fraction of seconds using the CONTIKI event timer.
+ *          As it runs in rtimer interrupt context, it only queues the cycle
+ *          start into a lock-free ring and polls meas_cycle_process, which
+ *          dispatches the work. Polling does not touch the shared event queue
+ *          and is served before any pending event.
+ *          Its longest run (enqueue cost) and the longest time until an entry
+ *          is drained are logged by meas_cycle_process when they grow.
+ *
+ * \param asn         ASN of slot zero.
+ * \param slotStart   Start time of slot zero.
  */
 /*============================================================================*/
-void sf_measSender_cycleStartCallback(void)
+void sf_measSender_cycleStartCallback(const struct tsch_asn_t *asn,
+                                      rtimer_clock_t slotStart)
 {
-  /* Trigger TX process */
-  process_post(&meas_tx_process, tx_event, NULL);
+  if(!process_is_running(&meas_cycle_process))
+  {
+    return;
+  }
 
-  /* Trigger meas read process */
-  process_post(&meas_read_process, tx_event, NULL);
+  sf_cycleQueue_put(asn, slotStart);
+  process_poll(&meas_cycle_process);
 }
 
 #ifdef __cplusplus
@@ -30,6 +30,8 @@ extern "C" {
  *    |-------------------------------------------|-------------------------------------------------|
  *    | @ref sf_measSender_start()                | @copybrief sf_measSender_start()                |
  *    | @ref sf_measSender_output_callback()      | @copybrief sf_measSender_output_callback()      |
+ *    | @ref sf_measSender_report_callback()      | @copybrief sf_measSender_report_callback()      |
+ *    | @ref sf_measSender_bootProfile_callback() | @copybrief sf_measSender_bootProfile_callback() |
  *  @{
  */
 
@@ -54,6 +56,8 @@ extern "C" {
  *        The second process controls the transmission time. At every slot cycle
  *        it checks for measurement by calling @ref measHandler_getMeas
  *        and sends it if available.
+ *        Both are triggered at slot cycle start by meas_cycle_process, which
+ *        drains the cycle start notifications queued from the TSCH interrupt.
  */
 /*============================================================================*/
 void sf_measSender_start(void);
@@ -71,6 +75,29 @@ void sf_measSender_start(void);
 /*============================================================================*/
 void sf_measSender_output_callback(void *ptr, nullnet_tx_status_t status);
 
+/*============================================================================*/
+/**
+ * \brief This is a callback function that TSCH calls to inform about
+ *        the Tx status of the periodic link quality, energy, slot
+ *        statistics and memory reports.
+ *
+ * \param ptr         Pointer to the  data.
+ * \param status      Status of nullnet Tx.
+ */
+/*============================================================================*/
+void sf_measSender_report_callback(void *ptr, nullnet_tx_status_t status);
+
+/*============================================================================*/
+/**
+ * \brief This is a callback function that TSCH calls to inform about
+ *        the Tx status of the boot profile report.
+ *
+ * \param ptr         Pointer to the  data.
+ * \param status      Status of nullnet Tx.
+ */
+/*============================================================================*/
+void sf_measSender_bootProfile_callback(void *ptr, nullnet_tx_status_t status);
+
 /*! @} */
 
 #endif /* __SF_MEASSENDER_H__ */
@@ -17,6 +17,7 @@ extern "C" {
  @brief      Implementation of the contains the schedule interfaces.
 */
 
+#include <string.h>
 #include "sf-tsch-schedule.h"
 #include "net/mac/tsch/tsch-schedule.h"
 #include "watchdog.h"
@@ -34,6 +35,29 @@ extern "C" {
 /* check whether the module has already been initialized */
 static int initialized = 0;
 
+/* channel offset (shard) used for the data slots of this device */
+static uint16_t data_channel_offset = 0;
+
+#if SCHEDULE_A && ((APP_MAX_DEVICES > APP_SLOTFRAME_SECTION_NUM * APP_SLOTFRAME_SECTION_DEVICE_TX_SLOTS) ||\
+                   (APP_MAX_DEVICES > APP_SLOTFRAME_SECTION_NUM * APP_SLOTFRAME_SECTION_DEVICE_RX_SLOTS) ||\
+                   (APP_SLOTFRAME_SECTION_DEVICE_RX_SLOTS % 2))
+#error "The data slots of the schedule can not serve APP_MAX_DEVICES"
+#endif
+
+/*---------------------------------------------------------------------------*/
+static int remove_data_link( struct tsch_slotframe *sf, uint16_t slot_offset )
+{
+    /* The data slots may have been added with a channel offset assigned
+       before, so the link is looked up by its timeslot. */
+    for( uint16_t channel_offset = 0; channel_offset < APP_SLOTFRAME_CHANNEL_OFFSET_NUM; channel_offset++ )
+    {
+        if( tsch_schedule_get_link_by_timeslot(sf, slot_offset, channel_offset) != NULL )
+            return (tsch_schedule_remove_link_by_timeslot(sf, slot_offset, channel_offset) == 0) ? -1 : 0;
+    }
+
+    return -1;
+}
+
 /*---------------------------------------------------------------------------*/
 int sf_tsch_schedule_init( void )
 {
@@ -55,6 +79,26 @@ int sf_tsch_schedule_init( void )
 }
 
 
+/*---------------------------------------------------------------------------*/
+int sf_tsch_schedule_set_data_channel_offset( uint16_t channel_offset )
+{
+    if( channel_offset >= APP_SLOTFRAME_CHANNEL_OFFSET_NUM )
+        return -1;
+
+    LOG_INFO("Set data channel offset %u\n", channel_offset);
+
+    data_channel_offset = channel_offset;
+    return 0;
+}
+
+
+/*---------------------------------------------------------------------------*/
+uint16_t sf_tsch_schedule_get_data_channel_offset( void )
+{
+    return data_channel_offset;
+}
+
+
 /*---------------------------------------------------------------------------*/
 int sf_tsch_schedule_add_beacon_slots( void )
 {
@@ -158,6 +202,42 @@ int sf_tsch_schedule_add_jreq_slots( void )
 }
 
 
+/*---------------------------------------------------------------------------*/
+int sf_tsch_schedule_add_jreq_slot( uint8_t index )
+{
+    struct tsch_link* link;
+    uint16_t slot_offset;
+    uint16_t channel_offset;
+    struct tsch_slotframe *sf_common;
+
+    sf_common = tsch_schedule_get_slotframe_by_handle( APP_SLOTFRAME_HANDLE );
+    if( (sf_common == NULL) || (!initialized) ||
+        (index >= APP_SLOTFRAME_SECTION_JOIN_REQUEST_SLOTS) )
+        return -1;
+
+    LOG_INFO("Add join req slot %u\n", index);
+
+    /* schedule one join request slot per section */
+    for( int i = 0; i < APP_SLOTFRAME_SECTION_NUM; i++ )
+    {
+      slot_offset = (i * APP_SLOTFRAME_SECTION_SIZE) + APP_SLOTFRAME_SECTION_BEACON_SLOTS;
+      channel_offset = 0;
+
+      watchdog_periodic();
+      link = tsch_schedule_add_link(sf_common,
+            (LINK_OPTION_TX | LINK_OPTION_SHARED) ,
+            LINK_TYPE_NORMAL, &tsch_broadcast_address,
+            slot_offset+index, channel_offset, true);
+
+      if( link == NULL )
+          /* an error occurred that should not. */
+          return -1;
+    }
+
+    return 0;
+}
+
+
 /*---------------------------------------------------------------------------*/
 int sf_tsch_schedule_delete_jreq_slots( void )
 {
@@ -180,6 +260,10 @@ int sf_tsch_schedule_delete_jreq_slots( void )
         for( int j = 0; j < APP_SLOTFRAME_SECTION_JOIN_REQUEST_SLOTS; j++ )
         {
             watchdog_periodic();
+            /* a device only schedules the join request slot it selected */
+            if( tsch_schedule_get_link_by_timeslot(sf_common, slot_offset+j, channel_offset) == NULL )
+                continue;
+
             if( tsch_schedule_remove_link_by_timeslot(sf_common, slot_offset+j, channel_offset) == 0)
                 /* an error occurred that should not. */
                 return -1;
@@ -267,12 +351,9 @@ int sf_tsch_schedule_delete_jproc_slots( const linkaddr_t* addr )
 
 
 /*---------------------------------------------------------------------------*/
-int sf_tsch_schedule_add_data_slots( const linkaddr_t* addr )
+int sf_tsch_schedule_get_data_timeslots( const linkaddr_t* addr, uint16_t* tx_slot_offset,
+                                         uint16_t* rx_slot_offset )
 {
-    struct tsch_link* link;
-    uint16_t slot_offset;
-    uint16_t channel_offset;
-    struct tsch_slotframe *sf_common;
     uint8_t section = 0;
     uint16_t slot = 0;
 #if LINKADDR_SIZE == 2
@@ -281,42 +362,89 @@ int sf_tsch_schedule_add_data_slots( const linkaddr_t* addr )
     uint16_t devid = addr->u16[0] - 1;
 #endif /* #if LINKADDR_SIZE == 2 */
 
+    if( ((int16_t)devid < 0) || (devid >= APP_MAX_DEVICES) )
+      return -1;
+
+#if SCHEDULE_A
+    /* TX slot followed by the slot for retransmissions */
+    section = devid / APP_SLOTFRAME_SECTION_DEVICE_TX_SLOTS;
+    slot = (devid % APP_SLOTFRAME_SECTION_DEVICE_TX_SLOTS) * 2;
+    *tx_slot_offset = (section * APP_SLOTFRAME_SECTION_SIZE) +
+            APP_SLOTFRAME_SECTION_BEACON_SLOTS + APP_SLOTFRAME_SECTION_JOIN_SLOTS +
+            slot;
+
+    /* RX slot. The first half of the devices keeps the even slots used so
+       far, the second half gets the odd ones. */
+    section = devid / APP_SLOTFRAME_SECTION_DEVICE_RX_SLOTS;
+    slot = ((devid % APP_SLOTFRAME_SECTION_DEVICE_RX_SLOTS) * 2) % APP_SLOTFRAME_SECTION_DEVICE_RX_SLOTS +
+           ((devid % APP_SLOTFRAME_SECTION_DEVICE_RX_SLOTS) * 2) / APP_SLOTFRAME_SECTION_DEVICE_RX_SLOTS;
+    *rx_slot_offset = (section * APP_SLOTFRAME_SECTION_SIZE) +
+            APP_SLOTFRAME_SECTION_BEACON_SLOTS + APP_SLOTFRAME_SECTION_JOIN_SLOTS + (APP_SLOTFRAME_SECTION_DEVICE_TX_SLOTS * 2) +
+            slot;
+    return 0;
+#else
+    return -1;
+#endif /* #if SCHEDULE_A */
+}
+
+
+/*---------------------------------------------------------------------------*/
+int sf_tsch_schedule_assign_data_slots( uint16_t cell_index, linkaddr_t* addr,
+                                        uint16_t* channel_offset )
+{
+    if( cell_index >= SF_TSCH_SCHEDULE_DATA_CAPACITY )
+        return -1;
+
+    /* Each channel offset serves a block of APP_MAX_DEVICES cells. */
+    memset(addr, 0, sizeof(linkaddr_t));
+#if LINKADDR_SIZE == 2
+    addr->u16 = (cell_index % APP_MAX_DEVICES) + 1;
+#else
+    addr->u16[0] = (cell_index % APP_MAX_DEVICES) + 1;
+#endif /* #if LINKADDR_SIZE == 2 */
+    *channel_offset = cell_index / APP_MAX_DEVICES;
+
+    return 0;
+}
+
+
+/*---------------------------------------------------------------------------*/
+int sf_tsch_schedule_add_data_slots( const linkaddr_t* addr )
+{
+    struct tsch_link* link;
+    uint16_t tx_slot_offset;
+    uint16_t rx_slot_offset;
+    uint16_t channel_offset;
+    struct tsch_slotframe *sf_common;
+
     sf_common = tsch_schedule_get_slotframe_by_handle( APP_SLOTFRAME_HANDLE );
     if( (sf_common == NULL) || (!initialized))
         return -1;
 
-    if( (int16_t)devid < 0 )
+    if( sf_tsch_schedule_get_data_timeslots(addr, &tx_slot_offset, &rx_slot_offset) != 0 )
       return -1;
 
 
     LOG_INFO("Add data slots ");
     LOG_INFO_LLADDR(addr);
-    LOG_INFO_("\n");
-
-#if SCHEDULE_A
+    LOG_INFO_(" ch off %u\n", data_channel_offset);
 
     /* schedule the TX slot */
-    section = devid / APP_SLOTFRAME_SECTION_DEVICE_TX_SLOTS;
-    slot = ((devid - 0) * 2) % APP_SLOTFRAME_SECTION_DEVICE_TX_SLOTS;
-    slot_offset = (section * APP_SLOTFRAME_SECTION_SIZE) +
-            APP_SLOTFRAME_SECTION_BEACON_SLOTS + APP_SLOTFRAME_SECTION_JOIN_SLOTS +
-            slot;
-    channel_offset = 0;
+    channel_offset = data_channel_offset;
     link = tsch_schedule_add_link(sf_common,
           LINK_OPTION_TX,
           LINK_TYPE_NORMAL, &tsch_broadcast_address,
-          slot_offset, channel_offset, true);
+          tx_slot_offset, channel_offset, true);
 
     if( link == NULL )
         /* an error occurred that should not. */
         return -1;
 
     /* Add slot only for retransmissions */
-    slot_offset = slot_offset + 1;
     link = tsch_schedule_add_link(sf_common,
           LINK_OPTION_TX,
           LINK_TYPE_NORMAL_RTX, &tsch_broadcast_address,
-          slot_offset, channel_offset, true);
+          tx_slot_offset + 1, channel_offset, true);
 
     if( link == NULL )
         /* an error occurred that should not. */
@@ -325,21 +453,14 @@ int sf_tsch_schedule_add_data_slots( const linkaddr_t* addr )
 
 
     /* schedule the RX slot */
-    section = devid / APP_SLOTFRAME_SECTION_DEVICE_RX_SLOTS;
-    slot = ((devid - 0) * 2) % APP_SLOTFRAME_SECTION_DEVICE_RX_SLOTS;
-    slot_offset = (section * APP_SLOTFRAME_SECTION_SIZE) +
-            APP_SLOTFRAME_SECTION_BEACON_SLOTS + APP_SLOTFRAME_SECTION_JOIN_SLOTS + (APP_SLOTFRAME_SECTION_DEVICE_TX_SLOTS * 2) +
-            slot;
-    channel_offset = 0;
     link = tsch_schedule_add_link(sf_common,
           LINK_OPTION_RX,
           LINK_TYPE_NORMAL, &tsch_broadcast_address,
-          slot_offset, channel_offset, true);
+          rx_slot_offset, channel_offset, true);
 
     if( link == NULL )
         /* an error occurred that should not. */
         return -1;
-#endif /* #endif #if SCHEDULE_A */
 
     return 0;
 }
@@ -348,22 +469,15 @@ int sf_tsch_schedule_add_data_slots( const linkaddr_t* addr )
 /*---------------------------------------------------------------------------*/
 int sf_tsch_schedule_delete_data_slots( const linkaddr_t* addr )
 {
-    uint16_t slot_offset;
-    uint16_t channel_offset;
+    uint16_t tx_slot_offset;
+    uint16_t rx_slot_offset;
     struct tsch_slotframe *sf_common;
-    uint8_t section = 0;
-    uint16_t slot = 0;
-#if LINKADDR_SIZE == 2
-    uint16_t devid = addr->u16 - 1;
-#else
-    uint16_t devid = addr->u16[0] - 1;
-#endif /* #if LINKADDR_SIZE == 2 */
 
     sf_common = tsch_schedule_get_slotframe_by_handle( APP_SLOTFRAME_HANDLE );
     if( (sf_common == NULL) || (!initialized))
         return -1;
 
-    if( (int16_t)devid < 0 )
+    if( sf_tsch_schedule_get_data_timeslots(addr, &tx_slot_offset, &rx_slot_offset) != 0 )
       return -1;
 
 
@@ -371,42 +485,18 @@ int sf_tsch_schedule_delete_data_slots( const linkaddr_t* addr )
     LOG_INFO_LLADDR(addr);
     LOG_INFO_("\n");
 
-#if SCHEDULE_A
-    /* remove the TX slot */
-    section = devid / APP_SLOTFRAME_SECTION_DEVICE_TX_SLOTS;
-    slot = ((devid - 0) * 2) % APP_SLOTFRAME_SECTION_DEVICE_TX_SLOTS;
-    slot_offset = (section * APP_SLOTFRAME_SECTION_SIZE) +
-            APP_SLOTFRAME_SECTION_BEACON_SLOTS + APP_SLOTFRAME_SECTION_JOIN_SLOTS +
-            slot;
-    channel_offset = 0;
-    if( tsch_schedule_remove_link_by_timeslot(sf_common, slot_offset, channel_offset) == 0)
+    /* remove the TX slot, the slot for retransmissions and the RX slot */
+    if( (remove_data_link(sf_common, tx_slot_offset) != 0) ||
+        (remove_data_link(sf_common, tx_slot_offset + 1) != 0) ||
+        (remove_data_link(sf_common, rx_slot_offset) != 0) )
        /* an error occurred that should not. */
        return -1;
 
-    /* Remove slot only for retransmissions */
-    slot_offset = slot_offset + 1;
-    if( tsch_schedule_remove_link_by_timeslot(sf_common, slot_offset, channel_offset) == 0)
-       /* an error occurred that should not. */
-       return -1;
-
-        /* remove the RX slot */
-    section = devid / APP_SLOTFRAME_SECTION_DEVICE_RX_SLOTS;
-    slot = ((devid - 0) * 2) % APP_SLOTFRAME_SECTION_DEVICE_RX_SLOTS;
-    slot_offset = (section * APP_SLOTFRAME_SECTION_SIZE) +
-            APP_SLOTFRAME_SECTION_BEACON_SLOTS + APP_SLOTFRAME_SECTION_JOIN_SLOTS + (APP_SLOTFRAME_SECTION_DEVICE_TX_SLOTS * 2) +
-            slot;
-    channel_offset = 0;
-    if( tsch_schedule_remove_link_by_timeslot(sf_common, slot_offset, channel_offset) == 0)
-       /* an error occurred that should not. */
-       return -1;
-#endif /* #if SCHEDULE_A */
-
     return 0;
 
 }
 
 
-
 #ifdef __cplusplus
 }
 #endif
@@ -25,6 +25,9 @@ extern "C" {
 #include "linkaddr.h"
 #include "tsch.h"
 
+/** Number of cells the data slots of all channel offsets can serve. */
+#define SF_TSCH_SCHEDULE_DATA_CAPACITY    (APP_MAX_DEVICES * APP_SLOTFRAME_CHANNEL_OFFSET_NUM)
+
 /**
  * @brief   Initialize the schedule.
  *
@@ -35,6 +38,31 @@ extern "C" {
 int sf_tsch_schedule_init( void );
 
 
+/**
+ * @brief   Set the channel offset of the data slots.
+ *
+ *          The channel offset (shard) is assigned by the BMS-CC within the
+ *          join response. Several BMS-CCs can serve disjoint groups of cells
+ *          in the same timeslots by using different channel offsets. The
+ *          value is applied by the next call of
+ *          @ref sf_tsch_schedule_add_data_slots.
+ *
+ * @param   channel_offset  Channel offset, lower than
+ *                          APP_SLOTFRAME_CHANNEL_OFFSET_NUM.
+ *
+ * @return  0 on success.
+ */
+int sf_tsch_schedule_set_data_channel_offset( uint16_t channel_offset );
+
+
+/**
+ * @brief   Get the channel offset of the data slots.
+ *
+ * @return  The channel offset currently used for the data slots.
+ */
+uint16_t sf_tsch_schedule_get_data_channel_offset( void );
+
+
 /**
  * @brief	Add the Beacon Slots.
  *
@@ -72,6 +100,22 @@ int sf_tsch_schedule_delete_beacon_slots( void );
 int sf_tsch_schedule_add_jreq_slots( void );
 
 
+/**
+ * @brief	Add a single Join-Request Slot.
+ *
+ *			A device uses one of the join request slots of a section only,
+ *			so that simultaneously joining devices spread over the slots
+ *			instead of all colliding in the same shared slots. The gateway
+ *			still listens on all join request slots.
+ *
+ * @param	index 	Join request slot within the section, lower than
+ *					APP_SLOTFRAME_SECTION_JOIN_REQUEST_SLOTS.
+ *
+ * @return	0 on success.
+ */
+int sf_tsch_schedule_add_jreq_slot( uint8_t index );
+
+
 /**
  * @brief	Remove the Join-Request Slots.
  *
@@ -112,6 +156,42 @@ int sf_tsch_schedule_add_jproc_slots( const linkaddr_t* addr );
 int sf_tsch_schedule_delete_jproc_slots( const linkaddr_t* addr );
 
 
+/**
+ * @brief   Get the timeslots of the data slots of a device.
+ *
+ *          The TX slot is followed by the slot for retransmissions. The
+ *          channel offset is not part of the mapping, so the timeslots of
+ *          a device are the same on every channel offset.
+ *
+ * @param   addr            Device address, 1 to APP_MAX_DEVICES.
+ * @param   tx_slot_offset  Returns the timeslot of the TX slot.
+ * @param   rx_slot_offset  Returns the timeslot of the RX slot.
+ *
+ * @return  0 on success.
+ */
+int sf_tsch_schedule_get_data_timeslots( const linkaddr_t* addr, uint16_t* tx_slot_offset,
+                                         uint16_t* rx_slot_offset );
+
+
+/**
+ * @brief   Assign the device address and channel offset of a cell.
+ *
+ *          Used by the gateway side to fill the join response. The cells
+ *          of the pack are assigned in blocks of APP_MAX_DEVICES per channel
+ *          offset, the BMS-CC of channel offset n serves the cells
+ *          n * APP_MAX_DEVICES to (n + 1) * APP_MAX_DEVICES - 1.
+ *
+ * @param   cell_index      Index of the cell within the pack, lower than
+ *                          SF_TSCH_SCHEDULE_DATA_CAPACITY.
+ * @param   addr            Returns the device address.
+ * @param   channel_offset  Returns the channel offset of the data slots.
+ *
+ * @return  0 on success, -1 if the pack exceeds the capacity.
+ */
+int sf_tsch_schedule_assign_data_slots( uint16_t cell_index, linkaddr_t* addr,
+                                        uint16_t* channel_offset );
+
+
 /**
  * @brief	Add Data-Slots.
  *
@@ -133,7 +213,8 @@ int sf_tsch_schedule_add_data_slots( const linkaddr_t* addr );
  *			Remove Data Slots from the schedule. SInce data slots
  *			are devic especific the according address is required. Gateway
  *			and devices remove data slots whenever the connection was
- *			closed or broke.
+ *			closed or broke. The links are removed on whatever channel
+ *			offset they have been added.
  *
  * @return	0 on success.
  */
@@ -1,5 +1,8 @@
 #include "contiki.h"
 #include "net/mac/tsch/tsch.h"
+#include "net/mac/framer/frame802154e-ie.h"
+#include "sf_rfSettings.h"
+#include "sf-tsch-timeslot.h"
 
 /**
  * \brief TSCH timing attributes and description. All timings are in usec.
@@ -45,6 +48,95 @@
 #define TSCH_DEFAULT_TS_MAX_TX             2500
 #define TSCH_DEFAULT_TS_TIMESLOT_LENGTH    7500
 
+/*
+ * The shorter timeslot profiles are derived from the radio bit rate and the
+ * maximum frame length allowed within the profile.
+ *
+ * Airtime     -> (PHY header + PSDU) * 8 / bit rate, PHY header = preamble (4),
+ *                SFD (1) and PHR (1)
+ * MaxTx       -> airtime of the maximum PSDU of the profile
+ * MaxAck      -> airtime of an enhanced ACK carrying the time correction IE
+ * RxWait      -> guard time, centered on TxOffset
+ * AckWait     -> ACK guard time, centered on TxAckDelay
+ *
+ * A profile is feasible if the frame and the ACK, each with its guard time,
+ * fit into the timeslot and the receiver can be turned around in between.
+ * This is checked at compile time below.
+ */
+#define SF_TSCH_TS_PHY_HDR_LEN             6
+#define SF_TSCH_TS_BYTE_US                 (8000 / SF_RADIO_BIT_RATE)
+#define SF_TSCH_TS_AIRTIME(len)            (((len) + SF_TSCH_TS_PHY_HDR_LEN) * SF_TSCH_TS_BYTE_US)
+/* Maximum PSDU of IEEE 802.15.4 */
+#define SF_TSCH_TS_PSDU_MAX                127
+
+#if SF_RADIO_BIT_RATE >= 250
+#define SF_TSCH_TS_SHORT_PROFILES          1
+/* Enhanced ACK: FCF (2) + seq (1) + header IE time correction (4) + term (2) + FCS (2) */
+#define SF_TSCH_TS_MAX_ACK_LEN             11
+/* Maximum turnaround of the radio between Rx and Tx */
+#define SF_TSCH_TS_TURNAROUND              192
+/* Minimum time from the begin of the timeslot until the radio is ready */
+#define SF_TSCH_TS_PREPARE                 200
+
+/* 5000 us profile: PSDU up to 60 bytes */
+#define SF_TSCH_TS5000_MAX_FRAME_LEN       60
+#define SF_TSCH_TS5000_RX_WAIT             1600
+#define SF_TSCH_TS5000_TX_OFFSET           (SF_TSCH_TS_PREPARE + (SF_TSCH_TS5000_RX_WAIT / 2))
+#define SF_TSCH_TS5000_ACK_WAIT            400
+#define SF_TSCH_TS5000_TX_ACK_DELAY        500
+#define SF_TSCH_TS5000_MAX_TX              SF_TSCH_TS_AIRTIME(SF_TSCH_TS5000_MAX_FRAME_LEN)
+#define SF_TSCH_TS5000_LENGTH              5000
+
+/* 4000 us profile: PSDU up to 48 bytes */
+#define SF_TSCH_TS4000_MAX_FRAME_LEN       48
+#define SF_TSCH_TS4000_RX_WAIT             1000
+#define SF_TSCH_TS4000_TX_OFFSET           (SF_TSCH_TS_PREPARE + (SF_TSCH_TS4000_RX_WAIT / 2))
+#define SF_TSCH_TS4000_ACK_WAIT            400
+#define SF_TSCH_TS4000_TX_ACK_DELAY        400
+#define SF_TSCH_TS4000_MAX_TX              SF_TSCH_TS_AIRTIME(SF_TSCH_TS4000_MAX_FRAME_LEN)
+#define SF_TSCH_TS4000_LENGTH              4000
+
+#define SF_TSCH_TS_MAX_ACK                 SF_TSCH_TS_AIRTIME(SF_TSCH_TS_MAX_ACK_LEN)
+
+/* Latest end of the ACK. The frame may start up to RxWait / 2 late on the
+   receiver, the ACK up to AckWait / 2 late on the transmitter. */
+#define SF_TSCH_TS_BUDGET(tx_offset, rx_wait, max_tx, tx_ack_delay, ack_wait) \
+  ((tx_offset) + (max_tx) + (tx_ack_delay) + SF_TSCH_TS_MAX_ACK + \
+   (((rx_wait) > (ack_wait)) ? ((rx_wait) / 2) : ((ack_wait) / 2)))
+
+#if SF_TSCH_TS_BUDGET(SF_TSCH_TS5000_TX_OFFSET, SF_TSCH_TS5000_RX_WAIT, \
+                      SF_TSCH_TS5000_MAX_TX, SF_TSCH_TS5000_TX_ACK_DELAY, \
+                      SF_TSCH_TS5000_ACK_WAIT) > SF_TSCH_TS5000_LENGTH
+#error "5000 us timeslot profile exceeds the timeslot length"
+#endif
+#if SF_TSCH_TS_BUDGET(SF_TSCH_TS4000_TX_OFFSET, SF_TSCH_TS4000_RX_WAIT, \
+                      SF_TSCH_TS4000_MAX_TX, SF_TSCH_TS4000_TX_ACK_DELAY, \
+                      SF_TSCH_TS4000_ACK_WAIT) > SF_TSCH_TS4000_LENGTH
+#error "4000 us timeslot profile exceeds the timeslot length"
+#endif
+#if ((SF_TSCH_TS5000_TX_ACK_DELAY - (SF_TSCH_TS5000_ACK_WAIT / 2)) < SF_TSCH_TS_TURNAROUND) || \
+    ((SF_TSCH_TS4000_TX_ACK_DELAY - (SF_TSCH_TS4000_ACK_WAIT / 2)) < SF_TSCH_TS_TURNAROUND)
+#error "ACK guard time does not leave enough time for the radio turnaround"
+#endif
+
+/* PSDU length of an EB: MAC header (FCF, sequence number, source PAN ID and
+   address), header termination IE, payload IE header, sync IE, absolute time
+   and join mode IE, timeslot IE (ID only), MIC and FCS. */
+#if LLSEC802154_ENABLED && (TSCH_SECURITY_KEY_SEC_LEVEL_EB & 3)
+#define SF_TSCH_TS_EB_MIC_LEN              (2 << (TSCH_SECURITY_KEY_SEC_LEVEL_EB & 3))
+#else
+#define SF_TSCH_TS_EB_MIC_LEN              0
+#endif
+#define SF_TSCH_TS_EB_LEN                  (2 + 1 + 2 + LINKADDR_SIZE + 2 + 2 + \
+                                            (2 + 6) + \
+                                            (2 + FRAME802154E_IE_ABSOLUTE_TIME_AND_JOIN_MODE_LEN) + \
+                                            (2 + 1) + SF_TSCH_TS_EB_MIC_LEN + 2)
+#if (SF_TSCH_TS_EB_LEN > SF_TSCH_TS5000_MAX_FRAME_LEN) || \
+    (SF_TSCH_TS_EB_LEN > SF_TSCH_TS4000_MAX_FRAME_LEN)
+#error "EB does not fit the maximum frame of a short timeslot profile"
+#endif
+#endif /* SF_RADIO_BIT_RATE >= 250 */
+
 /* TSCH timeslot timing (microseconds) */
 const tsch_timeslot_timing_usec tsch_timeslot_timing_us_7500 = {
   TSCH_DEFAULT_TS_CCA_OFFSET,
@@ -60,3 +152,75 @@ const tsch_timeslot_timing_usec tsch_timeslot_timing_us_7500 = {
   TSCH_DEFAULT_TS_MAX_TX,
   TSCH_DEFAULT_TS_TIMESLOT_LENGTH,
 };
+
+#if SF_TSCH_TS_SHORT_PROFILES
+/* TSCH timeslot timing, 5000 us profile (microseconds) */
+const tsch_timeslot_timing_usec tsch_timeslot_timing_us_5000 = {
+  SF_TSCH_TS5000_TX_OFFSET - TSCH_DEFAULT_TS_CCA,
+  TSCH_DEFAULT_TS_CCA,
+  SF_TSCH_TS5000_TX_OFFSET,
+  SF_TSCH_TS5000_TX_OFFSET - (SF_TSCH_TS5000_RX_WAIT / 2),
+  SF_TSCH_TS5000_TX_ACK_DELAY - (SF_TSCH_TS5000_ACK_WAIT / 2),
+  SF_TSCH_TS5000_TX_ACK_DELAY,
+  SF_TSCH_TS5000_RX_WAIT,
+  SF_TSCH_TS5000_ACK_WAIT,
+  SF_TSCH_TS_TURNAROUND,
+  SF_TSCH_TS_MAX_ACK,
+  SF_TSCH_TS5000_MAX_TX,
+  SF_TSCH_TS5000_LENGTH,
+};
+
+/* TSCH timeslot timing, 4000 us profile (microseconds) */
+const tsch_timeslot_timing_usec tsch_timeslot_timing_us_4000 = {
+  SF_TSCH_TS4000_TX_OFFSET - TSCH_DEFAULT_TS_CCA,
+  TSCH_DEFAULT_TS_CCA,
+  SF_TSCH_TS4000_TX_OFFSET,
+  SF_TSCH_TS4000_TX_OFFSET - (SF_TSCH_TS4000_RX_WAIT / 2),
+  SF_TSCH_TS4000_TX_ACK_DELAY - (SF_TSCH_TS4000_ACK_WAIT / 2),
+  SF_TSCH_TS4000_TX_ACK_DELAY,
+  SF_TSCH_TS4000_RX_WAIT,
+  SF_TSCH_TS4000_ACK_WAIT,
+  SF_TSCH_TS_TURNAROUND,
+  SF_TSCH_TS_MAX_ACK,
+  SF_TSCH_TS4000_MAX_TX,
+  SF_TSCH_TS4000_LENGTH,
+};
+#endif /* SF_TSCH_TS_SHORT_PROFILES */
+
+/*---------------------------------------------------------------------------*/
+const uint16_t *sf_tsch_timeslot_get_timing(uint8_t timeslot_id)
+{
+    switch( timeslot_id )
+    {
+        case SF_TSCH_TIMESLOT_ID_7500:
+            return tsch_timeslot_timing_us_7500;
+#if SF_TSCH_TS_SHORT_PROFILES
+        case SF_TSCH_TIMESLOT_ID_5000:
+            return tsch_timeslot_timing_us_5000;
+        case SF_TSCH_TIMESLOT_ID_4000:
+            return tsch_timeslot_timing_us_4000;
+#endif /* SF_TSCH_TS_SHORT_PROFILES */
+        default:
+            return NULL;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+uint8_t sf_tsch_timeslot_get_max_frame_len(uint8_t timeslot_id)
+{
+    /* ID 0 is the default timing, i.e. the 7500 us profile. */
+    const uint16_t *timing = (timeslot_id == 0) ? tsch_timeslot_timing_us_7500 :
+                             sf_tsch_timeslot_get_timing(timeslot_id);
+    uint16_t len;
+
+    if( timing == NULL )
+        return 0;
+
+    /* PSDU that fits into MaxTx */
+    len = timing[tsch_ts_max_tx] / SF_TSCH_TS_BYTE_US;
+    if( len <= SF_TSCH_TS_PHY_HDR_LEN )
+        return 0;
+    len -= SF_TSCH_TS_PHY_HDR_LEN;
+
+    return (len > SF_TSCH_TS_PSDU_MAX) ? SF_TSCH_TS_PSDU_MAX : (uint8_t)len;
+}
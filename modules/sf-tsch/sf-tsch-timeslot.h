@@ -3,7 +3,39 @@
 
 #include "contiki.h"
 
+/* Timeslot template IDs advertised in the EB timeslot IE (short form).
+ * ID 0 is reserved for the default timeslot timing. */
+#define SF_TSCH_TIMESLOT_ID_7500        0x80
+#define SF_TSCH_TIMESLOT_ID_5000        0x81
+#define SF_TSCH_TIMESLOT_ID_4000        0x82
+
 /* TSCH timeslot timing (microseconds) */
 extern const uint16_t tsch_timeslot_timing_us_7500[];
+extern const uint16_t tsch_timeslot_timing_us_5000[];
+extern const uint16_t tsch_timeslot_timing_us_4000[];
+
+/**
+ * @brief   Get the timeslot timing of a timeslot template ID.
+ *
+ *          Used by TSCH at association to map the timeslot ID advertised
+ *          by the BMS-CC to the local timing table.
+ *
+ * @param   timeslot_id   Timeslot template ID from the EB.
+ *
+ * @return  Pointer to the timing in micro-seconds, NULL if the ID is unknown.
+ */
+const uint16_t *sf_tsch_timeslot_get_timing(uint8_t timeslot_id);
+
+/**
+ * @brief   Get the maximum frame length of a timeslot template ID.
+ *
+ *          The longest PSDU, including the FCS and a MIC, whose airtime
+ *          fits into the MaxTx of the timing.
+ *
+ * @param   timeslot_id   Timeslot template ID, e.g. tsch_timeslot_id.
+ *
+ * @return  The maximum PSDU length in bytes, 0 if the ID is unknown.
+ */
+uint8_t sf_tsch_timeslot_get_max_frame_len(uint8_t timeslot_id);
 
 #endif /* SF_TSCH_TIMESLOT_H_ */
@@ -0,0 +1,486 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Implementation of the link quality cache.
+*/
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+/* Stack include */
+#include "contiki.h"
+#include "net/mac/mac.h"
+#include "sys/int-master.h"
+/* Application include */
+#include "sf_linkQuality.h"
+
+/*==============================================================================
+                            MACROS
+==============================================================================*/
+/* Number of neighbours kept. */
+#ifndef SF_CONF_LINKQUALITY_NEIGHBOURS
+  #define SF_LINKQUALITY_NEIGHBOURS      (4U)
+#else
+  #define SF_LINKQUALITY_NEIGHBOURS      SF_CONF_LINKQUALITY_NEIGHBOURS
+#endif
+/* EWMA weight of a new sample as power of two, i.e. 1/8. */
+#define SF_LINKQUALITY_EWMA_SHIFT        (3)
+/* Rating penalty in dB of a neighbour losing every ACK. */
+#ifndef SF_CONF_LINKQUALITY_PRR_PENALTY
+  #define SF_LINKQUALITY_PRR_PENALTY     (10)
+#else
+  #define SF_LINKQUALITY_PRR_PENALTY     SF_CONF_LINKQUALITY_PRR_PENALTY
+#endif
+/* Report values of an unknown RSSI and PRR. */
+#define SF_LINKQUALITY_REPORT_NO_RSSI    INT8_MIN
+#define SF_LINKQUALITY_REPORT_NO_PRR     (0xFFU)
+/* Report length of a channel and of a neighbour. */
+#define SF_LINKQUALITY_REPORT_CH_LEN     (2U)
+#define SF_LINKQUALITY_REPORT_NBR_LEN    (6U)
+
+/*==============================================================================
+                            GLOBAL VARIABLES
+==============================================================================*/
+/* The tables are updated by the TSCH callbacks from the rtimer interrupt.
+   The process context accesses them with the interrupts disabled. */
+/* Link quality per channel. */
+static sf_linkQuality_t gChannels[SF_LINKQUALITY_NUM_CHANNELS];
+/* Link quality per neighbour. Unused entries have a zero rxCount and
+   txCount. */
+static sf_linkQuality_neighbour_t gNeighbours[SF_LINKQUALITY_NEIGHBOURS];
+
+/*==============================================================================
+                         LOCAL FUNCTION DEFINITION
+==============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Update an EWMA with a new sample. The first sample initializes it.
+ *
+ * \param pAvg        Pointer to the average.
+ * \param sample      New sample, same scaling as the average.
+ * \param isFirst     True for the first sample.
+ */
+/*============================================================================*/
+static void loc_ewma(int32_t *pAvg, int32_t sample, bool isFirst);
+
+/*============================================================================*/
+/**
+ * \brief Add a received frame to a link.
+ *
+ * \param pLink       Link to be updated.
+ * \param rssi        RSSI in dBm.
+ */
+/*============================================================================*/
+static void loc_updateRx(sf_linkQuality_t *pLink, int16_t rssi);
+
+/*============================================================================*/
+/**
+ * \brief Add a transmission attempt to a link.
+ *
+ * \param pLink       Link to be updated.
+ * \param acked       True if the attempt has been acknowledged.
+ */
+/*============================================================================*/
+static void loc_updateTx(sf_linkQuality_t *pLink, bool acked);
+
+/*============================================================================*/
+/**
+ * \brief Returns the link of a channel.
+ *
+ * \param channel     Channel number.
+ *
+ * \return Pointer to the link, NULL if the channel is out of range.
+ */
+/*============================================================================*/
+static sf_linkQuality_t* loc_getChannel(uint8_t channel);
+
+/*============================================================================*/
+/**
+ * \brief Returns the entry of a neighbour. An unknown neighbour replaces the
+ *        neighbour not seen for the longest time.
+ *
+ * \param pAddr       Neighbour address.
+ *
+ * \return Pointer to the entry.
+ */
+/*============================================================================*/
+static sf_linkQuality_neighbour_t* loc_getNeighbour(const linkaddr_t *pAddr);
+
+/*============================================================================*/
+/**
+ * \brief Rate a link for the neighbour selection.
+ *
+ * \param pLink       Link to be rated.
+ *
+ * \return Rating in 1/16 dBm.
+ */
+/*============================================================================*/
+static int32_t loc_rate(const sf_linkQuality_t *pLink);
+
+/*============================================================================*/
+/**
+ * \brief Write the RSSI and PRR of a link in the report format.
+ *
+ * \param pBuf        Buffer with at least 2 bytes.
+ * \param pLink       Link to be reported.
+ */
+/*============================================================================*/
+static void loc_reportLink(uint8_t *pBuf, const sf_linkQuality_t *pLink);
+
+/*==============================================================================
+                         LOCAL FUNCTION IMPLEMENTATION
+==============================================================================*/
+/*------------------------------------------------------------------------------
+  loc_ewma()
+------------------------------------------------------------------------------*/
+static void loc_ewma(int32_t *pAvg, int32_t sample, bool isFirst)
+{
+  if(isFirst)
+  {
+    *pAvg = sample;
+  }
+  else
+  {
+    /* Divide instead of shifting to round negative values towards zero. */
+    *pAvg += (sample - *pAvg) / (1L << SF_LINKQUALITY_EWMA_SHIFT);
+  }
+}/* loc_ewma() */
+
+/*------------------------------------------------------------------------------
+  loc_updateRx()
+------------------------------------------------------------------------------*/
+static void loc_updateRx(sf_linkQuality_t *pLink, int16_t rssi)
+{
+  /* Average in a wider type */
+  int32_t avg = pLink->rssi;
+
+  loc_ewma(&avg, (int32_t)rssi * SF_LINKQUALITY_RSSI_SCALE, 0 == pLink->rxCount);
+  pLink->rssi = (int16_t)avg;
+  pLink->lastSeen = clock_seconds();
+
+  if(pLink->rxCount < UINT16_MAX)
+  {
+    pLink->rxCount++;
+  }
+}/* loc_updateRx() */
+
+/*------------------------------------------------------------------------------
+  loc_updateTx()
+------------------------------------------------------------------------------*/
+static void loc_updateTx(sf_linkQuality_t *pLink, bool acked)
+{
+  /* Average in a wider type */
+  int32_t avg = pLink->prr;
+
+  loc_ewma(&avg, acked ? SF_LINKQUALITY_PRR_SCALE : 0, 0 == pLink->txCount);
+  pLink->prr = (uint16_t)avg;
+
+  if(pLink->txCount < UINT16_MAX)
+  {
+    pLink->txCount++;
+  }
+}/* loc_updateTx() */
+
+/*------------------------------------------------------------------------------
+  loc_getChannel()
+------------------------------------------------------------------------------*/
+static sf_linkQuality_t* loc_getChannel(uint8_t channel)
+{
+  if((channel < SF_LINKQUALITY_FIRST_CHANNEL) ||
+     (channel >= SF_LINKQUALITY_FIRST_CHANNEL + SF_LINKQUALITY_NUM_CHANNELS))
+  {
+    return NULL;
+  }
+
+  return &gChannels[channel - SF_LINKQUALITY_FIRST_CHANNEL];
+}/* loc_getChannel() */
+
+/*------------------------------------------------------------------------------
+  loc_getNeighbour()
+------------------------------------------------------------------------------*/
+static sf_linkQuality_neighbour_t* loc_getNeighbour(const linkaddr_t *pAddr)
+{
+  uint8_t i;
+  /* Entry to be replaced */
+  sf_linkQuality_neighbour_t *pOldest = &gNeighbours[0];
+
+  for(i = 0; i < SF_LINKQUALITY_NEIGHBOURS; i++)
+  {
+    if((0 == gNeighbours[i].link.rxCount) && (0 == gNeighbours[i].link.txCount))
+    {
+      /* Free entries are replaced first. */
+      if((0 != pOldest->link.rxCount) || (0 != pOldest->link.txCount))
+      {
+        pOldest = &gNeighbours[i];
+      }
+    }
+    else if(linkaddr_cmp(&gNeighbours[i].addr, pAddr))
+    {
+      return &gNeighbours[i];
+    }
+    else if(((0 != pOldest->link.rxCount) || (0 != pOldest->link.txCount)) &&
+            (gNeighbours[i].link.lastSeen < pOldest->link.lastSeen))
+    {
+      pOldest = &gNeighbours[i];
+    }
+  }
+
+  memset(pOldest, 0, sizeof(*pOldest));
+  linkaddr_copy(&pOldest->addr, pAddr);
+
+  return pOldest;
+}/* loc_getNeighbour() */
+
+/*------------------------------------------------------------------------------
+  loc_rate()
+------------------------------------------------------------------------------*/
+static int32_t loc_rate(const sf_linkQuality_t *pLink)
+{
+  /* Rating */
+  int32_t rating = pLink->rssi;
+
+  if(0 != pLink->txCount)
+  {
+    rating -= ((int32_t)(SF_LINKQUALITY_PRR_SCALE - pLink->prr) *
+               SF_LINKQUALITY_PRR_PENALTY * SF_LINKQUALITY_RSSI_SCALE) /
+              SF_LINKQUALITY_PRR_SCALE;
+  }
+
+  return rating;
+}/* loc_rate() */
+
+/*------------------------------------------------------------------------------
+  loc_reportLink()
+------------------------------------------------------------------------------*/
+static void loc_reportLink(uint8_t *pBuf, const sf_linkQuality_t *pLink)
+{
+  pBuf[0] = (uint8_t)((0 != pLink->rxCount) ?
+                      (int8_t)(pLink->rssi / SF_LINKQUALITY_RSSI_SCALE) :
+                      SF_LINKQUALITY_REPORT_NO_RSSI);
+  pBuf[1] = (0 != pLink->txCount) ?
+            (uint8_t)(((uint32_t)pLink->prr * 100U) / SF_LINKQUALITY_PRR_SCALE) :
+            SF_LINKQUALITY_REPORT_NO_PRR;
+}/* loc_reportLink() */
+
+/*==============================================================================
+                      API FUNCTION IMPLEMENTATION
+==============================================================================*/
+/*------------------------------------------------------------------------------
+  sf_linkQuality_beaconRx()
+------------------------------------------------------------------------------*/
+void sf_linkQuality_beaconRx(const linkaddr_t *pAddr, int16_t rssi,
+                             uint8_t channel)
+{
+  /* Interrupt state */
+  int_master_status_t status;
+  /* Neighbour entry */
+  sf_linkQuality_neighbour_t *pNeighbour;
+
+  status = int_master_read_and_disable();
+  sf_linkQuality_rxCallback(NULL, rssi, channel);
+
+  if(NULL != pAddr)
+  {
+    pNeighbour = loc_getNeighbour(pAddr);
+    loc_updateRx(&pNeighbour->link, rssi);
+    pNeighbour->beaconChannel = channel;
+  }
+  int_master_status_set(status);
+}/* sf_linkQuality_beaconRx() */
+
+/*------------------------------------------------------------------------------
+  sf_linkQuality_getBestNeighbour()
+------------------------------------------------------------------------------*/
+bool sf_linkQuality_getBestNeighbour(unsigned long since,
+                                     sf_linkQuality_neighbour_t *pNeighbour)
+{
+  uint8_t i;
+  /* Interrupt state */
+  int_master_status_t status;
+  /* Best neighbour */
+  const sf_linkQuality_neighbour_t *pBest = NULL;
+
+  if(NULL == pNeighbour)
+  {
+    return false;
+  }
+
+  status = int_master_read_and_disable();
+  for(i = 0; i < SF_LINKQUALITY_NEIGHBOURS; i++)
+  {
+    if((0 == gNeighbours[i].link.rxCount) || (0 == gNeighbours[i].beaconChannel) ||
+       (gNeighbours[i].link.lastSeen < since))
+    {
+      continue;
+    }
+
+    if((NULL == pBest) || (loc_rate(&gNeighbours[i].link) > loc_rate(&pBest->link)))
+    {
+      pBest = &gNeighbours[i];
+    }
+  }
+
+  if(NULL != pBest)
+  {
+    *pNeighbour = *pBest;
+  }
+  int_master_status_set(status);
+
+  return (NULL != pBest);
+}/* sf_linkQuality_getBestNeighbour() */
+
+/*------------------------------------------------------------------------------
+  sf_linkQuality_getReport()
+------------------------------------------------------------------------------*/
+uint8_t sf_linkQuality_getReport(uint8_t *pBuf, uint8_t maxLen, uint8_t *pNext)
+{
+  /* Interrupt state */
+  int_master_status_t status;
+  /* Entry copied with the interrupts disabled */
+  sf_linkQuality_neighbour_t entry;
+  /* Report length */
+  uint8_t len = 0;
+  /* Entry to be reported */
+  uint8_t idx;
+  /* Age of a neighbour in seconds */
+  unsigned long age;
+  /* Current time in seconds */
+  unsigned long now = clock_seconds();
+
+  /* At least one entry of any kind has to fit. */
+  if((NULL == pBuf) || (NULL == pNext) ||
+     (maxLen < 1U + SF_LINKQUALITY_REPORT_NBR_LEN) ||
+     (*pNext >= SF_LINKQUALITY_NUM_CHANNELS + SF_LINKQUALITY_NEIGHBOURS))
+  {
+    return 0;
+  }
+
+  pBuf[len++] = *pNext;
+
+  for(idx = *pNext; idx < SF_LINKQUALITY_NUM_CHANNELS; idx++)
+  {
+    if(len + SF_LINKQUALITY_REPORT_CH_LEN > maxLen)
+    {
+      *pNext = idx;
+      return len;
+    }
+
+    status = int_master_read_and_disable();
+    entry.link = gChannels[idx];
+    int_master_status_set(status);
+
+    loc_reportLink(&pBuf[len], &entry.link);
+    len += SF_LINKQUALITY_REPORT_CH_LEN;
+  }
+
+  for(; idx < SF_LINKQUALITY_NUM_CHANNELS + SF_LINKQUALITY_NEIGHBOURS; idx++)
+  {
+    status = int_master_read_and_disable();
+    entry = gNeighbours[idx - SF_LINKQUALITY_NUM_CHANNELS];
+    int_master_status_set(status);
+
+    if((0 == entry.link.rxCount) && (0 == entry.link.txCount))
+    {
+      continue;
+    }
+
+    if(len + SF_LINKQUALITY_REPORT_NBR_LEN > maxLen)
+    {
+      *pNext = idx;
+      return len;
+    }
+
+    memcpy(&pBuf[len], entry.addr.u8, 2U);
+    loc_reportLink(&pBuf[len + 2U], &entry.link);
+    age = now - entry.link.lastSeen;
+    if(age > UINT16_MAX)
+    {
+      age = UINT16_MAX;
+    }
+    pBuf[len + 4U] = (uint8_t)age;
+    pBuf[len + 5U] = (uint8_t)(age >> 8);
+    len += SF_LINKQUALITY_REPORT_NBR_LEN;
+  }
+
+  /* Report complete */
+  *pNext = 0;
+
+  return len;
+}/* sf_linkQuality_getReport() */
+
+/*------------------------------------------------------------------------------
+  sf_linkQuality_rxCallback()
+------------------------------------------------------------------------------*/
+void sf_linkQuality_rxCallback(const linkaddr_t *pAddr, int16_t rssi,
+                               uint8_t channel)
+{
+  /* Channel entry */
+  sf_linkQuality_t *pChannel = loc_getChannel(channel);
+
+  if(NULL != pChannel)
+  {
+    loc_updateRx(pChannel, rssi);
+  }
+
+  if(NULL != pAddr)
+  {
+    loc_updateRx(&loc_getNeighbour(pAddr)->link, rssi);
+  }
+}/* sf_linkQuality_rxCallback() */
+
+/*------------------------------------------------------------------------------
+  sf_linkQuality_txCallback()
+------------------------------------------------------------------------------*/
+void sf_linkQuality_txCallback(const linkaddr_t *pAddr, uint8_t macTxStatus,
+                               uint8_t channel, int16_t ackRssi)
+{
+  /* Channel entry */
+  sf_linkQuality_t *pChannel = loc_getChannel(channel);
+  /* Neighbour entry */
+  sf_linkQuality_neighbour_t *pNeighbour;
+
+  /* Only a sent frame tells about the link. */
+  if(((MAC_TX_OK != macTxStatus) && (MAC_TX_NOACK != macTxStatus)) ||
+     (NULL == pAddr))
+  {
+    return;
+  }
+
+  pNeighbour = loc_getNeighbour(pAddr);
+  loc_updateTx(&pNeighbour->link, MAC_TX_OK == macTxStatus);
+  if(NULL != pChannel)
+  {
+    loc_updateTx(pChannel, MAC_TX_OK == macTxStatus);
+  }
+
+  /* The ACK is a received frame as well. */
+  if(MAC_TX_OK == macTxStatus)
+  {
+    loc_updateRx(&pNeighbour->link, ackRssi);
+    if(NULL != pChannel)
+    {
+      loc_updateRx(pChannel, ackRssi);
+    }
+  }
+}/* sf_linkQuality_txCallback() */
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,184 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __SF_LINK_QUALITY_H__
+#define __SF_LINK_QUALITY_H__
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Per-channel and per-neighbour link quality cache.
+
+ @details The cache keeps an RSSI EWMA, a packet reception ratio (PRR) EWMA
+          and the last seen time for every channel of the hopping sequence
+          and for a few neighbours. It is fed by the beacon scan, by the
+          frames received by the TSCH and by the ACK outcome of the unicast
+          transmissions. The beacon scan uses it to select the BMS-CC and its
+          beacon channel, the measurement sender reports it periodically.
+*/
+
+/**
+ *  @addtogroup SF_TSCH
+ *
+ *  @details
+ *
+ *  - <b>Link quality API</b>\n
+ *    | API Function                              | Description                                     |
+ *    |-------------------------------------------|-------------------------------------------------|
+ *    | @ref sf_linkQuality_beaconRx()            | @copybrief sf_linkQuality_beaconRx()            |
+ *    | @ref sf_linkQuality_getBestNeighbour()    | @copybrief sf_linkQuality_getBestNeighbour()    |
+ *    | @ref sf_linkQuality_getReport()           | @copybrief sf_linkQuality_getReport()           |
+ *    | @ref sf_linkQuality_rxCallback()          | @copybrief sf_linkQuality_rxCallback()          |
+ *    | @ref sf_linkQuality_txCallback()          | @copybrief sf_linkQuality_txCallback()          |
+ *  @{
+ */
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdint.h>
+#include <stdbool.h>
+/* Stack include */
+#include "net/linkaddr.h"
+
+/*==============================================================================
+                            MACROS
+==============================================================================*/
+/* First channel of the 2.4 GHz band and number of channels. */
+#define SF_LINKQUALITY_FIRST_CHANNEL     (11U)
+#define SF_LINKQUALITY_NUM_CHANNELS      (16U)
+/* Scaling of the RSSI EWMA, i.e. 1/16 dBm. */
+#define SF_LINKQUALITY_RSSI_SCALE        16
+/* Scaling of the PRR EWMA, i.e. 4096 equals 100%. */
+#define SF_LINKQUALITY_PRR_SCALE         4096
+
+/*==============================================================================
+                            STRUCTS
+==============================================================================*/
+/*! Link quality of a channel or a neighbour. */
+typedef struct
+{
+  /* Time of the last reception in seconds. */
+  unsigned long lastSeen;
+  /* RSSI EWMA scaled by SF_LINKQUALITY_RSSI_SCALE. */
+  int16_t rssi;
+  /* PRR EWMA scaled by SF_LINKQUALITY_PRR_SCALE. */
+  uint16_t prr;
+  /* Number of receptions, saturating. */
+  uint16_t rxCount;
+  /* Number of acknowledged transmission attempts, saturating. */
+  uint16_t txCount;
+} sf_linkQuality_t;
+
+/*! Link quality of a neighbour. */
+typedef struct
+{
+  /* Link quality */
+  sf_linkQuality_t link;
+  /* Neighbour address */
+  linkaddr_t addr;
+  /* Channel on which the last beacon has been received. */
+  uint8_t beaconChannel;
+} sf_linkQuality_neighbour_t;
+
+/*==============================================================================
+                            FUNCTION PROTOTYPES
+==============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Adds a beacon received during the beacon scan.
+ *
+ * \param pAddr     Beacon source address. NULL to update the channel only,
+ *                  e.g. for beacons of other networks.
+ * \param rssi      RSSI of the beacon in dBm.
+ * \param channel   Channel on which the beacon has been received.
+ */
+/*============================================================================*/
+void sf_linkQuality_beaconRx(const linkaddr_t *pAddr, int16_t rssi,
+                             uint8_t channel);
+
+/*============================================================================*/
+/**
+ * \brief Returns the neighbour with the best link seen since the given time.
+ *        The rating is the RSSI EWMA lowered for lost ACKs.
+ *
+ * \param since       Time in seconds, see clock_seconds().
+ * \param pNeighbour  Storage for a copy of the neighbour.
+ *
+ * \return True if a neighbour has been seen.
+ */
+/*============================================================================*/
+bool sf_linkQuality_getBestNeighbour(unsigned long since,
+                                     sf_linkQuality_neighbour_t *pNeighbour);
+
+/*============================================================================*/
+/**
+ * \brief Writes a part of the diagnostic report of the cache.
+ *
+ *        The entries of the report are the channels, starting with channel
+ *        11, followed by the neighbours seen. A part starts with the index
+ *        of its first entry and holds the following entries that fit into
+ *        the buffer. A channel entry is the RSSI in dBm (int8, INT8_MIN if
+ *        unknown) and the PRR in percent (uint8, 0xFF if unknown). A
+ *        neighbour entry is the address (2 bytes), RSSI, PRR and the age in
+ *        seconds (uint16, saturating).
+ *
+ *        The part is sized for the frame length of the timeslot profile,
+ *        the full report of 57 bytes does not fit the short profiles.
+ *
+ * \param pBuf      Buffer for the report.
+ * \param maxLen    Size of the buffer, at least 7 bytes.
+ * \param pNext     Index of the first entry, 0 for the first part. Set to
+ *                  the first entry of the next part, 0 once the report is
+ *                  complete.
+ *
+ * \return Length of the part, 0 if the buffer is too small.
+ */
+/*============================================================================*/
+uint8_t sf_linkQuality_getReport(uint8_t *pBuf, uint8_t maxLen, uint8_t *pNext);
+
+/*============================================================================*/
+/**
+ * \brief TSCH callback called from the rtimer interrupt for every received
+ *        frame.
+ *
+ * \param pAddr     Source address.
+ * \param rssi      RSSI of the frame in dBm.
+ * \param channel   Channel of the slot.
+ */
+/*============================================================================*/
+void sf_linkQuality_rxCallback(const linkaddr_t *pAddr, int16_t rssi,
+                               uint8_t channel);
+
+/*============================================================================*/
+/**
+ * \brief TSCH callback called from the rtimer interrupt after every unicast
+ *        transmission attempt.
+ *
+ * \param pAddr         Destination address.
+ * \param macTxStatus   MAC status of the attempt.
+ * \param channel       Channel of the slot.
+ * \param ackRssi       RSSI of the ACK in dBm, 0 if no ACK was received.
+ */
+/*============================================================================*/
+void sf_linkQuality_txCallback(const linkaddr_t *pAddr, uint8_t macTxStatus,
+                               uint8_t channel, int16_t ackRssi);
+
+/*! @} */
+
+#endif /* __SF_LINK_QUALITY_H__ */
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,321 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Implementation of the TSCH slot operation profiler.
+*/
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+/* Stack include */
+#include "contiki.h"
+#include "sys/int-master.h"
+/* Application include */
+#include "sf_slotProfile.h"
+
+/* Log configuration */
+#include "sys/log.h"
+
+/*==============================================================================
+                            MACROS
+==============================================================================*/
+#define LOG_MODULE "Slot Profile"
+/* Defines log level*/
+#ifndef LOG_CONF_APP
+  #define LOG_LEVEL     LOG_LEVEL_NONE
+#else
+  #define LOG_LEVEL     LOG_CONF_APP
+#endif
+/* Interval of the histogram print. */
+#ifndef SF_CONF_SLOTPROFILE_PRINT_INTERVAL
+  #define SF_SLOTPROFILE_PRINT_INTERVAL  (60U * CLOCK_SECOND)
+#else
+  #define SF_SLOTPROFILE_PRINT_INTERVAL  SF_CONF_SLOTPROFILE_PRINT_INTERVAL
+#endif
+#if CONTIKI_TARGET_SIMPLELINK
+/* CPU clock counted by the cycle counter. */
+#ifndef SF_CONF_SLOTPROFILE_CPU_HZ
+  #define SF_SLOTPROFILE_CYCLE_HZ        (48000000UL)
+#else
+  #define SF_SLOTPROFILE_CYCLE_HZ        SF_CONF_SLOTPROFILE_CPU_HZ
+#endif
+/* Cortex-M4 debug registers of the cycle counter. */
+#define SF_SLOTPROFILE_DEMCR             (*(volatile uint32_t*)0xE000EDFCUL)
+#define SF_SLOTPROFILE_DEMCR_TRCENA      (1UL << 24)
+#define SF_SLOTPROFILE_DWT_CTRL          (*(volatile uint32_t*)0xE0001000UL)
+#define SF_SLOTPROFILE_DWT_CTRL_CYCCNTENA (1UL << 0)
+#define SF_SLOTPROFILE_DWT_CYCCNT        (*(volatile uint32_t*)0xE0001004UL)
+#define SF_SLOTPROFILE_CYCLES()          (SF_SLOTPROFILE_DWT_CYCCNT)
+#else
+/* Without cycle counter, the rtimer is used. */
+#define SF_SLOTPROFILE_CYCLE_HZ          (RTIMER_SECOND)
+#define SF_SLOTPROFILE_CYCLES()          ((uint32_t)RTIMER_NOW())
+#endif
+
+/*==============================================================================
+                            GLOBAL VARIABLES
+==============================================================================*/
+/* Histograms, written from the rtimer interrupt. */
+static sf_histogram_t gHist[E_SF_SLOTPROFILE_MAX];
+/* Copy of the histograms being printed. */
+static sf_histogram_t gHistPrint[E_SF_SLOTPROFILE_MAX];
+/* Names of the metrics. */
+static const char * const gMetricName[E_SF_SLOTPROFILE_MAX] =
+{
+  "ISR latency",
+  "Tx prepare",
+  "ACK turnaround",
+  "Deadline margin"
+};
+/* rtimer time of the scheduled wakeup. */
+static uint32_t gTarget;
+static bool gTargetValid;
+/* Cycle count at the start of the Tx slot. */
+static uint32_t gTxStart;
+static bool gTxPrepareRunning;
+/* Cycle count at the end of the received frame. */
+static uint32_t gRxEnd;
+static bool gRxEndValid;
+
+PROCESS(sf_slotProfile_process, "Slot profile process");
+
+/*==============================================================================
+                         LOCAL FUNCTION DEFINITION
+==============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Convert a number of cycles to microseconds.
+ */
+/*============================================================================*/
+static uint32_t loc_cyclesToUs(uint32_t cycles);
+
+/*============================================================================*/
+/**
+ * \brief Convert a number of rtimer ticks to microseconds.
+ */
+/*============================================================================*/
+static uint32_t loc_ticksToUs(uint32_t ticks);
+
+/*==============================================================================
+                         LOCAL FUNCTION IMPLEMENTATION
+==============================================================================*/
+/*------------------------------------------------------------------------------
+  loc_cyclesToUs()
+------------------------------------------------------------------------------*/
+static uint32_t loc_cyclesToUs(uint32_t cycles)
+{
+  return (uint32_t)((uint64_t)cycles * 1000000U / SF_SLOTPROFILE_CYCLE_HZ);
+}/* loc_cyclesToUs() */
+
+/*------------------------------------------------------------------------------
+  loc_ticksToUs()
+------------------------------------------------------------------------------*/
+static uint32_t loc_ticksToUs(uint32_t ticks)
+{
+  return (uint32_t)((uint64_t)ticks * 1000000U / RTIMER_SECOND);
+}/* loc_ticksToUs() */
+
+/*------------------------------------------------------------------------------
+  sf_slotProfile_process()
+------------------------------------------------------------------------------*/
+PROCESS_THREAD(sf_slotProfile_process, ev, data)
+{
+  static struct etimer printTimer;
+
+  PROCESS_BEGIN();
+
+  etimer_set(&printTimer, SF_SLOTPROFILE_PRINT_INTERVAL);
+
+  while(1)
+  {
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&printTimer));
+    etimer_reset(&printTimer);
+
+    sf_slotProfile_print();
+  }
+
+  PROCESS_END();
+}/* sf_slotProfile_process() */
+
+/*==============================================================================
+                      API FUNCTION IMPLEMENTATION
+==============================================================================*/
+/*------------------------------------------------------------------------------
+  sf_slotProfile_init()
+------------------------------------------------------------------------------*/
+void sf_slotProfile_init(void)
+{
+#if CONTIKI_TARGET_SIMPLELINK
+  /* The cycle counter is part of the debug trace unit. */
+  SF_SLOTPROFILE_DEMCR |= SF_SLOTPROFILE_DEMCR_TRCENA;
+  SF_SLOTPROFILE_DWT_CYCCNT = 0;
+  SF_SLOTPROFILE_DWT_CTRL |= SF_SLOTPROFILE_DWT_CTRL_CYCCNTENA;
+#endif
+
+  /* The slot operation restarts, e.g. after a resynchronization. */
+  gTargetValid = false;
+  gTxPrepareRunning = false;
+  gRxEndValid = false;
+
+  if(!process_is_running(&sf_slotProfile_process))
+  {
+    process_start(&sf_slotProfile_process, NULL);
+  }
+}/* sf_slotProfile_init() */
+
+/*------------------------------------------------------------------------------
+  sf_slotProfile_interrupt()
+------------------------------------------------------------------------------*/
+void sf_slotProfile_interrupt(void)
+{
+  /* Elapsed rtimer ticks since the scheduled wakeup */
+  uint32_t ticks = (uint32_t)RTIMER_NOW() - gTarget;
+
+  /* The first wakeup after the start is not scheduled by the hook. */
+  if(gTargetValid && ((int32_t)ticks >= 0))
+  {
+    sf_histogram_add(&gHist[E_SF_SLOTPROFILE_ISR_LATENCY], loc_ticksToUs(ticks));
+  }
+  gTargetValid = false;
+}/* sf_slotProfile_interrupt() */
+
+/*------------------------------------------------------------------------------
+  sf_slotProfile_schedule()
+------------------------------------------------------------------------------*/
+void sf_slotProfile_schedule(uint32_t target, uint32_t now)
+{
+  /* Time left until the wakeup in rtimer ticks */
+  int32_t margin = (int32_t)(target - now);
+
+  if(gTxPrepareRunning)
+  {
+    /* The frame is ready, the slot operation waits for the Tx offset. */
+    sf_histogram_add(&gHist[E_SF_SLOTPROFILE_TX_PREPARE],
+                     loc_cyclesToUs(SF_SLOTPROFILE_CYCLES() - gTxStart));
+    gTxPrepareRunning = false;
+  }
+
+  if(margin < 0)
+  {
+    sf_histogram_addNegative(&gHist[E_SF_SLOTPROFILE_DEADLINE_MARGIN]);
+  }
+  else
+  {
+    sf_histogram_add(&gHist[E_SF_SLOTPROFILE_DEADLINE_MARGIN],
+                     loc_ticksToUs((uint32_t)margin));
+  }
+
+  gTarget = target;
+  gTargetValid = true;
+}/* sf_slotProfile_schedule() */
+
+/*------------------------------------------------------------------------------
+  sf_slotProfile_txSlotStart()
+------------------------------------------------------------------------------*/
+void sf_slotProfile_txSlotStart(void)
+{
+  gTxStart = SF_SLOTPROFILE_CYCLES();
+  gTxPrepareRunning = true;
+}/* sf_slotProfile_txSlotStart() */
+
+/*------------------------------------------------------------------------------
+  sf_slotProfile_rxEnd()
+------------------------------------------------------------------------------*/
+void sf_slotProfile_rxEnd(void)
+{
+  gRxEnd = SF_SLOTPROFILE_CYCLES();
+  gRxEndValid = true;
+}/* sf_slotProfile_rxEnd() */
+
+/*------------------------------------------------------------------------------
+  sf_slotProfile_ackSendStart()
+------------------------------------------------------------------------------*/
+void sf_slotProfile_ackSendStart(void)
+{
+  if(gRxEndValid)
+  {
+    sf_histogram_add(&gHist[E_SF_SLOTPROFILE_ACK_TURNAROUND],
+                     loc_cyclesToUs(SF_SLOTPROFILE_CYCLES() - gRxEnd));
+    gRxEndValid = false;
+  }
+}/* sf_slotProfile_ackSendStart() */
+
+/*------------------------------------------------------------------------------
+  sf_slotProfile_get()
+------------------------------------------------------------------------------*/
+void sf_slotProfile_get(E_SF_SLOTPROFILE_t metric, sf_histogram_t *pHist)
+{
+  /* Interrupt state */
+  int_master_status_t status;
+
+  status = int_master_read_and_disable();
+  *pHist = gHist[metric];
+  int_master_status_set(status);
+}/* sf_slotProfile_get() */
+
+/*------------------------------------------------------------------------------
+  sf_slotProfile_print()
+------------------------------------------------------------------------------*/
+void sf_slotProfile_print(void)
+{
+  /* Interrupt state */
+  int_master_status_t status;
+  sf_histogram_t *pHist;
+  uint8_t metric;
+  uint8_t bin;
+
+  /* Take the histograms and restart them. */
+  status = int_master_read_and_disable();
+  memcpy(gHistPrint, gHist, sizeof(gHistPrint));
+  memset(gHist, 0, sizeof(gHist));
+  int_master_status_set(status);
+
+  for(metric = 0; metric < E_SF_SLOTPROFILE_MAX; metric++)
+  {
+    pHist = &gHistPrint[metric];
+
+    LOG_INFO("%s: n %lu", gMetricName[metric], (unsigned long)pHist->count);
+    if(0U != pHist->count)
+    {
+      LOG_INFO_(", min %lu avg %lu p50 %lu p99 %lu max %lu us",
+                (unsigned long)pHist->min,
+                (unsigned long)sf_histogram_mean(pHist),
+                (unsigned long)sf_histogram_percentile(pHist, 50U),
+                (unsigned long)sf_histogram_percentile(pHist, 99U),
+                (unsigned long)pHist->max);
+    }
+    if(0U != pHist->negative)
+    {
+      LOG_INFO_(", missed %lu", (unsigned long)pHist->negative);
+    }
+    LOG_INFO_("\n");
+
+    LOG_INFO("%s log2 us:", gMetricName[metric]);
+    for(bin = 0; bin < SF_HISTOGRAM_BINS; bin++)
+    {
+      LOG_INFO_(" %u", pHist->bins[bin]);
+    }
+    LOG_INFO_("\n");
+  }
+}/* sf_slotProfile_print() */
+
+#ifdef __cplusplus
+}
+#endif
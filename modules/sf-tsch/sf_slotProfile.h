@@ -0,0 +1,149 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __SF_SLOT_PROFILE_H__
+#define __SF_SLOT_PROFILE_H__
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Profiler of the TSCH slot operation.
+
+ @details The hooks are called at the TSCH_DEBUG_* points of the slot
+          operation, see the project configuration. The durations within a
+          slot are taken from the DWT cycle counter of the Cortex-M4, the
+          times relative to a scheduled wakeup from the rtimer. Each metric
+          is collected in a histogram of log2 microsecond bins, which is
+          printed on the UART periodically and then restarted.
+          The hooks are only meant for the profiling build, they are called
+          from the rtimer interrupt.
+*/
+
+/**
+ *  @addtogroup SF_TSCH
+ *
+ *  @details
+ *
+ *  - <b>Slot profile API</b>\n
+ *    | API Function                              | Description                                     |
+ *    |-------------------------------------------|-------------------------------------------------|
+ *    | @ref sf_slotProfile_init()                | @copybrief sf_slotProfile_init()                |
+ *    | @ref sf_slotProfile_interrupt()           | @copybrief sf_slotProfile_interrupt()           |
+ *    | @ref sf_slotProfile_schedule()            | @copybrief sf_slotProfile_schedule()            |
+ *    | @ref sf_slotProfile_txSlotStart()         | @copybrief sf_slotProfile_txSlotStart()         |
+ *    | @ref sf_slotProfile_rxEnd()               | @copybrief sf_slotProfile_rxEnd()               |
+ *    | @ref sf_slotProfile_ackSendStart()        | @copybrief sf_slotProfile_ackSendStart()        |
+ *    | @ref sf_slotProfile_get()                 | @copybrief sf_slotProfile_get()                 |
+ *    | @ref sf_slotProfile_print()               | @copybrief sf_slotProfile_print()               |
+ *  @{
+ */
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdint.h>
+/* Application include */
+#include "sf_histogram.h"
+
+/*==============================================================================
+                            ENUMS
+==============================================================================*/
+/*! Profiled metrics. */
+typedef enum
+{
+  /*! Delay of the slot operation interrupt after the scheduled time. */
+  E_SF_SLOTPROFILE_ISR_LATENCY,
+  /*! Time from the start of a Tx slot until the frame is ready to be sent. */
+  E_SF_SLOTPROFILE_TX_PREPARE,
+  /*! Time from the end of a received frame until the ACK is sent. */
+  E_SF_SLOTPROFILE_ACK_TURNAROUND,
+  /*! Time left until a scheduled wakeup. */
+  E_SF_SLOTPROFILE_DEADLINE_MARGIN,
+  /*! Number of metrics. */
+  E_SF_SLOTPROFILE_MAX
+} E_SF_SLOTPROFILE_t;
+
+/*==============================================================================
+                            FUNCTION PROTOTYPES
+==============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Enable the cycle counter and start the periodic print. Called when
+ *        the slot operation starts.
+ */
+/*============================================================================*/
+void sf_slotProfile_init(void);
+
+/*============================================================================*/
+/**
+ * \brief Hook at the entry of the slot operation interrupt.
+ */
+/*============================================================================*/
+void sf_slotProfile_interrupt(void);
+
+/*============================================================================*/
+/**
+ * \brief Hook at each scheduled wakeup of the slot operation.
+ *
+ * \param target        rtimer time of the wakeup.
+ * \param now           Current rtimer time.
+ */
+/*============================================================================*/
+void sf_slotProfile_schedule(uint32_t target, uint32_t now);
+
+/*============================================================================*/
+/**
+ * \brief Hook at the start of a Tx slot.
+ */
+/*============================================================================*/
+void sf_slotProfile_txSlotStart(void);
+
+/*============================================================================*/
+/**
+ * \brief Hook at the end of a frame received in an Rx slot.
+ */
+/*============================================================================*/
+void sf_slotProfile_rxEnd(void);
+
+/*============================================================================*/
+/**
+ * \brief Hook at the start of the ACK transmission in an Rx slot.
+ */
+/*============================================================================*/
+void sf_slotProfile_ackSendStart(void);
+
+/*============================================================================*/
+/**
+ * \brief Get the histogram of a metric collected since the last print.
+ *
+ * \param metric        @ref E_SF_SLOTPROFILE_t
+ * \param pHist         Returns the histogram in microseconds.
+ */
+/*============================================================================*/
+void sf_slotProfile_get(E_SF_SLOTPROFILE_t metric, sf_histogram_t *pHist);
+
+/*============================================================================*/
+/**
+ * \brief Print the histograms on the UART and restart them.
+ */
+/*============================================================================*/
+void sf_slotProfile_print(void);
+
+/*! @} */
+
+#endif /* __SF_SLOT_PROFILE_H__ */
+
+#ifdef __cplusplus
+}
+#endif
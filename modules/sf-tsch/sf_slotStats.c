@@ -0,0 +1,192 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Implementation of the TSCH slot operation failure counters.
+*/
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdint.h>
+#include <string.h>
+/* Stack include */
+#include "contiki.h"
+#include "sys/int-master.h"
+/* Application include */
+#include "sf_slotStats.h"
+
+/*==============================================================================
+                            MACROS
+==============================================================================*/
+/* Number of skip causes */
+#define SF_SLOTSTATS_SKIP_MAX            (3U)
+/* Length of the report */
+#define SF_SLOTSTATS_REPORT_LEN          (1U + sizeof(uint16_t) *\
+                                          (E_SF_SLOTSTATS_SITE_MAX +\
+                                           SF_SLOTSTATS_SKIP_MAX + 2U))
+
+/*==============================================================================
+                            STRUCTS
+==============================================================================*/
+/*! Counters, in the order they are reported. */
+typedef struct
+{
+  /* Deadline misses per call site */
+  uint16_t deadlineMiss[E_SF_SLOTSTATS_SITE_MAX];
+  /* Slots skipped while locked */
+  uint16_t skipLocked;
+  /* Slots skipped while the lock is requested */
+  uint16_t skipLockRequested;
+  /* Slots skipped without link */
+  uint16_t skipNoLink;
+  /* Received frames dropped on a full input queue */
+  uint16_t inputQueueDrop;
+  /* Unicast frames without ACK */
+  uint16_t ackTimeout;
+} sf_slotStats_counters_t;
+
+/*==============================================================================
+                            GLOBAL VARIABLES
+==============================================================================*/
+/* Counters, written from the rtimer interrupt. */
+static sf_slotStats_counters_t gCounters;
+/* Names of the call sites as passed by the slot operation. */
+static const char * const gSiteName[E_SF_SLOTSTATS_SITE_OTHER] =
+{
+  "cca",
+  "TxBeforeTx",
+  "TxBeforeAck",
+  "RxBeforeListen",
+  "RxBeforeAck",
+  "MainBeforeReady",
+  "main",
+  "assoc"
+};
+
+/*==============================================================================
+                         LOCAL FUNCTION DEFINITION
+==============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Increment a counter, saturating at its maximum.
+ *
+ * \param pCounter      Pointer to the counter.
+ */
+/*============================================================================*/
+static void loc_increment(uint16_t *pCounter);
+
+/*==============================================================================
+                         LOCAL FUNCTION IMPLEMENTATION
+==============================================================================*/
+/*------------------------------------------------------------------------------
+  loc_increment()
+------------------------------------------------------------------------------*/
+static void loc_increment(uint16_t *pCounter)
+{
+  if(UINT16_MAX > *pCounter)
+  {
+    (*pCounter)++;
+  }
+}/* loc_increment() */
+
+/*==============================================================================
+                      API FUNCTION IMPLEMENTATION
+==============================================================================*/
+/*------------------------------------------------------------------------------
+  sf_slotStats_getReport()
+------------------------------------------------------------------------------*/
+uint8_t sf_slotStats_getReport(uint8_t *pBuf, uint8_t maxLen)
+{
+  /* Interrupt state */
+  int_master_status_t status;
+  /* Counters taken for the report */
+  sf_slotStats_counters_t counters;
+
+  if((NULL == pBuf) || (maxLen < SF_SLOTSTATS_REPORT_LEN))
+  {
+    return 0;
+  }
+
+  /* Take the counters and restart them. */
+  status = int_master_read_and_disable();
+  counters = gCounters;
+  memset(&gCounters, 0, sizeof(gCounters));
+  int_master_status_set(status);
+
+  pBuf[0] = E_SF_SLOTSTATS_SITE_MAX;
+  memcpy(pBuf + 1U, &counters, sizeof(counters));
+
+  return SF_SLOTSTATS_REPORT_LEN;
+}/* sf_slotStats_getReport() */
+
+/*------------------------------------------------------------------------------
+  sf_slotStats_deadlineMissCallback()
+------------------------------------------------------------------------------*/
+void sf_slotStats_deadlineMissCallback(const char *pSite)
+{
+  uint8_t site;
+
+  /* Misses are rare, the names are compared only then. */
+  for(site = 0; site < E_SF_SLOTSTATS_SITE_OTHER; site++)
+  {
+    if((NULL != pSite) && (0 == strcmp(pSite, gSiteName[site])))
+    {
+      break;
+    }
+  }
+  loc_increment(&gCounters.deadlineMiss[site]);
+}/* sf_slotStats_deadlineMissCallback() */
+
+/*------------------------------------------------------------------------------
+  sf_slotStats_slotSkippedCallback()
+------------------------------------------------------------------------------*/
+void sf_slotStats_slotSkippedCallback(uint8_t locked, uint8_t lockRequested,
+                                      uint8_t noLink)
+{
+  if(noLink)
+  {
+    loc_increment(&gCounters.skipNoLink);
+  }
+  else if(locked)
+  {
+    loc_increment(&gCounters.skipLocked);
+  }
+  else if(lockRequested)
+  {
+    loc_increment(&gCounters.skipLockRequested);
+  }
+}/* sf_slotStats_slotSkippedCallback() */
+
+/*------------------------------------------------------------------------------
+  sf_slotStats_inputQueueDropCallback()
+------------------------------------------------------------------------------*/
+void sf_slotStats_inputQueueDropCallback(void)
+{
+  loc_increment(&gCounters.inputQueueDrop);
+}/* sf_slotStats_inputQueueDropCallback() */
+
+/*------------------------------------------------------------------------------
+  sf_slotStats_ackTimeoutCallback()
+------------------------------------------------------------------------------*/
+void sf_slotStats_ackTimeoutCallback(void)
+{
+  loc_increment(&gCounters.ackTimeout);
+}/* sf_slotStats_ackTimeoutCallback() */
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,152 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __SF_SLOT_STATS_H__
+#define __SF_SLOT_STATS_H__
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Counters of the TSCH slot operation failures.
+
+ @details The slot operation reports deadline misses and skipped slots only
+          as per-slot log, which is off in the field. The TSCH callbacks
+          count the deadline misses per scheduling call site, the skipped
+          slots per cause, the frames dropped on a full input queue and the
+          missing ACKs. The counters are sent to the BMS-CC periodically in
+          a slot statistics report frame and restart with each report.
+*/
+
+/**
+ *  @addtogroup SF_TSCH
+ *
+ *  @details
+ *
+ *  - <b>Slot statistics API</b>\n
+ *    | API Function                              | Description                                     |
+ *    |-------------------------------------------|-------------------------------------------------|
+ *    | @ref sf_slotStats_getReport()             | @copybrief sf_slotStats_getReport()             |
+ *    | @ref sf_slotStats_deadlineMissCallback()  | @copybrief sf_slotStats_deadlineMissCallback()  |
+ *    | @ref sf_slotStats_slotSkippedCallback()   | @copybrief sf_slotStats_slotSkippedCallback()   |
+ *    | @ref sf_slotStats_inputQueueDropCallback() | @copybrief sf_slotStats_inputQueueDropCallback() |
+ *    | @ref sf_slotStats_ackTimeoutCallback()    | @copybrief sf_slotStats_ackTimeoutCallback()    |
+ *  @{
+ */
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdint.h>
+
+/*==============================================================================
+                            ENUMS
+==============================================================================*/
+/*! Scheduling call sites of the slot operation, in the order they are
+    reported. */
+typedef enum
+{
+  /*! Wakeup before the CCA. */
+  E_SF_SLOTSTATS_SITE_CCA,
+  /*! Wakeup before the transmission. */
+  E_SF_SLOTSTATS_SITE_TX_BEFORE_TX,
+  /*! Wakeup before waiting for the ACK. */
+  E_SF_SLOTSTATS_SITE_TX_BEFORE_ACK,
+  /*! Wakeup before listening. */
+  E_SF_SLOTSTATS_SITE_RX_BEFORE_LISTEN,
+  /*! Wakeup before sending the ACK. */
+  E_SF_SLOTSTATS_SITE_RX_BEFORE_ACK,
+  /*! Wakeup at the start of a skipped slot. */
+  E_SF_SLOTSTATS_SITE_MAIN_BEFORE_READY,
+  /*! Wakeup for the next active slot. */
+  E_SF_SLOTSTATS_SITE_MAIN,
+  /*! Wakeup for the first slot after the association. */
+  E_SF_SLOTSTATS_SITE_ASSOC,
+  /*! Any other call site. */
+  E_SF_SLOTSTATS_SITE_OTHER,
+  /*! Number of call sites. */
+  E_SF_SLOTSTATS_SITE_MAX
+} E_SF_SLOTSTATS_SITE_t;
+
+/*==============================================================================
+                            FUNCTION PROTOTYPES
+==============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Get the slot statistics report and restart the counters.
+ *
+ *        sites  |  sites x deadline misses  |  skipped slots
+ *        -------|---------------------------|---------------------------
+ *        1byte  |     sites x 2byte         |  locked | lock req | no link
+ *               |                           |  2byte  |  2byte   | 2byte
+ *
+ *        input queue drops  |  ACK timeouts
+ *        -------------------|--------------
+ *             2byte         |    2byte
+ *
+ *        The sites are ordered as @ref E_SF_SLOTSTATS_SITE_t. The counters
+ *        saturate at 0xFFFF.
+ *
+ * \param pBuf          Pointer to the report storage.
+ * \param maxLen        Size of the report storage.
+ *
+ * \return Length of the report, 0 if the storage is too small.
+ */
+/*============================================================================*/
+uint8_t sf_slotStats_getReport(uint8_t *pBuf, uint8_t maxLen);
+
+/*============================================================================*/
+/**
+ * \brief TSCH callback called from the rtimer interrupt on a deadline miss.
+ *
+ * \param pSite         Name of the scheduling call site.
+ */
+/*============================================================================*/
+void sf_slotStats_deadlineMissCallback(const char *pSite);
+
+/*============================================================================*/
+/**
+ * \brief TSCH callback called from the rtimer interrupt when a slot is
+ *        skipped.
+ *
+ * \param locked        TSCH is locked.
+ * \param lockRequested The lock is requested.
+ * \param noLink        There is no link in the slot.
+ */
+/*============================================================================*/
+void sf_slotStats_slotSkippedCallback(uint8_t locked, uint8_t lockRequested,
+                                      uint8_t noLink);
+
+/*============================================================================*/
+/**
+ * \brief TSCH callback called from the rtimer interrupt when a received
+ *        frame is dropped on a full input queue.
+ */
+/*============================================================================*/
+void sf_slotStats_inputQueueDropCallback(void);
+
+/*============================================================================*/
+/**
+ * \brief TSCH callback called from the rtimer interrupt when no ACK is
+ *        received.
+ */
+/*============================================================================*/
+void sf_slotStats_ackTimeoutCallback(void);
+
+/*! @} */
+
+#endif /* __SF_SLOT_STATS_H__ */
+
+#ifdef __cplusplus
+}
+#endif
@@ -24,13 +24,73 @@ extern "C" {
 #include "contiki.h"
 #include "net/netstack.h"
 #include "net/nullnet/nullnet.h"
+#include "net/packetbuf.h"
+#include "net/link-stats.h"
 #if MAC_CONF_WITH_TSCH
 #include "net/mac/tsch/tsch.h"
 #endif
 /* Application include */
 #include "sf_callbackHandler.h"
 #include "sf-tsch-schedule.h"
+#include "sf-tsch-timeslot.h"
 #include "sf_tsch.h"
+#include "sf_linkQuality.h"
+#include "sf_txPower.h"
+
+/*==============================================================================
+                            MACROS
+==============================================================================*/
+/* MIC of a data frame. */
+#if LLSEC802154_ENABLED && (TSCH_SECURITY_KEY_SEC_LEVEL_OTHER & 3)
+  #define SF_TSCH_DATA_MIC_LEN           (2U << (TSCH_SECURITY_KEY_SEC_LEVEL_OTHER & 3))
+#else
+  #define SF_TSCH_DATA_MIC_LEN           (0U)
+#endif
+/* MAC overhead of a data frame: FCF (2), sequence number (1), destination
+   PAN ID (2), destination and source address, MIC and FCS (2). */
+#define SF_TSCH_DATA_OVERHEAD            (2U + 1U + 2U + 2U * LINKADDR_SIZE +\
+                                          SF_TSCH_DATA_MIC_LEN + 2U)
+/* Slots between two Tx slots of the device. */
+#define SF_TSCH_TX_SLOT_SPACING          (APP_SLOTFRAME_SIZE /\
+                                          APP_SLOTFRAME_SECTION_NUM)
+
+/*==============================================================================
+                            STRUCTS
+==============================================================================*/
+/* Retransmission policy of a traffic class. */
+typedef struct
+{
+  /* Bounds of the maximum number of transmissions. */
+  uint8_t minTx;
+  uint8_t maxTx;
+  /* Number of transmissions per expected transmission (ETX). */
+  uint8_t etxFactor;
+  /* Minimum time to live in slots, 0 for none. */
+  uint16_t ttl;
+} sf_tsch_txPolicy_t;
+
+/*==============================================================================
+                            GLOBAL VARIABLES
+==============================================================================*/
+/* Retransmission policies, indexed by E_SF_TSCH_TRAFFIC_t. The time to live
+   is extended to cover all transmissions and ends when the frame is replaced,
+   see sf_tsch_setTxPolicy(). The report is kept for at least a few
+   slotframes. Join frames have no time to live, the join procedure has its
+   own timeout. The join request is sent once, it contends on a shared slot
+   and a collision is retried by the join backoff in another slot. */
+static const sf_tsch_txPolicy_t gTxPolicies[E_SF_TSCH_TRAFFIC_MAX] =
+{
+  /* E_SF_TSCH_TRAFFIC_DEFAULT */
+  {1U, 1U, 1U, 0U},
+  /* E_SF_TSCH_TRAFFIC_MEAS */
+  {1U, 4U, 2U, APP_SLOTFRAME_SIZE},
+  /* E_SF_TSCH_TRAFFIC_REPORT */
+  {1U, 6U, 2U, 4U * APP_SLOTFRAME_SIZE},
+  /* E_SF_TSCH_TRAFFIC_JOIN */
+  {4U, 8U, 4U, 0U},
+  /* E_SF_TSCH_TRAFFIC_JOIN_REQUEST */
+  {1U, 1U, 1U, 0U},
+};
 
 /*==============================================================================
                       API FUNCTION IMPLEMENTATION
@@ -150,6 +210,109 @@ E_SF_RETURN_t sf_tsch_send(uint8_t* pFrame, uint8_t frameLen,
   return E_SF_SUCCESS;
 } /* sf_tsch_send() */
 
+/*----------------------------------------------------------------------------*/
+/*! sf_tsch_getMaxPayloadLen */
+/*----------------------------------------------------------------------------*/
+uint8_t sf_tsch_getMaxPayloadLen(void)
+{
+  /* Maximum frame of the timeslot timing in use */
+  uint8_t maxFrameLen = sf_tsch_timeslot_get_max_frame_len(tsch_timeslot_id);
+
+  if(maxFrameLen <= SF_TSCH_DATA_OVERHEAD)
+  {
+    return 0;
+  }
+
+  return maxFrameLen - SF_TSCH_DATA_OVERHEAD;
+}/* sf_tsch_getMaxPayloadLen() */
+
+/*----------------------------------------------------------------------------*/
+/*! sf_tsch_setTxPolicy */
+/*----------------------------------------------------------------------------*/
+E_SF_RETURN_t sf_tsch_setTxPolicy(E_SF_TSCH_TRAFFIC_t trafficClass,
+                                  const linkaddr_t* pDestAddr,
+                                  uint32_t lifetime)
+{
+  /* Policy of the traffic class */
+  const sf_tsch_txPolicy_t *pPolicy;
+  /* Link statistics of the destination */
+  const struct link_stats *pStats;
+  /* Maximum number of transmissions */
+  uint32_t maxTx;
+  /* Time to live in slots */
+  uint32_t ttl;
+  /* Lifetime in slots */
+  uint32_t lifetimeSlots = 0U;
+
+  if(!pDestAddr)
+  {
+    return E_SF_ERROR_NPE;
+  }
+
+  if(E_SF_TSCH_TRAFFIC_MAX <= trafficClass)
+  {
+    return E_SF_ERROR_INVALID_PARAM;
+  }
+
+  pPolicy = &gTxPolicies[trafficClass];
+  pStats = link_stats_from_lladdr(pDestAddr);
+
+  if((NULL != pStats) && (0U != pStats->etx))
+  {
+    /* Round up, ETX is a fixed point value. */
+    maxTx = ((uint32_t)pStats->etx * pPolicy->etxFactor +
+             LINK_STATS_ETX_DIVISOR - 1U) / LINK_STATS_ETX_DIVISOR;
+    maxTx = MAX(maxTx, pPolicy->minTx);
+    maxTx = MIN(maxTx, pPolicy->maxTx);
+  }
+  else
+  {
+    /* Unknown link */
+    maxTx = pPolicy->maxTx;
+  }
+
+  if((0U != lifetime) && (0U != tsch_timing_us[tsch_ts_timeslot_length]))
+  {
+    /* Only the Tx slots before the frame is replaced are used, at least the
+       first one. A frame sent in all of them ends with its last attempt and
+       is accounted by link-stats, an expired one is not. */
+    lifetimeSlots = (uint32_t)MIN((uint64_t)lifetime * 1000000U /
+                                  tsch_timing_us[tsch_ts_timeslot_length],
+                                  UINT16_MAX);
+    maxTx = MIN(maxTx, MAX(1U, lifetimeSlots / SF_TSCH_TX_SLOT_SPACING));
+    lifetimeSlots = MAX(lifetimeSlots, SF_TSCH_TX_SLOT_SPACING);
+  }
+
+  packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS, maxTx);
+  if(0U != pPolicy->ttl)
+  {
+    /* The device has one Tx slot per spacing. The frame waits up to one
+       spacing for its first slot, each retransmission takes another one. */
+    ttl = MAX((uint32_t)pPolicy->ttl, (maxTx + 1U) * SF_TSCH_TX_SLOT_SPACING);
+    if(0U != lifetimeSlots)
+    {
+      ttl = MIN(ttl, lifetimeSlots);
+    }
+    packetbuf_set_attr(PACKETBUF_ATTR_MAC_TTL, ttl);
+  }
+  else
+  {
+    packetbuf_set_attr(PACKETBUF_ATTR_MAC_TTL, lifetimeSlots);
+  }
+
+  return E_SF_SUCCESS;
+}/* sf_tsch_setTxPolicy() */
+
+/*----------------------------------------------------------------------------*/
+/*! sf_tsch_linkTxCallback */
+/*----------------------------------------------------------------------------*/
+void sf_tsch_linkTxCallback(const linkaddr_t *pAddr, uint8_t macTxStatus,
+                            uint8_t channel, int16_t ackRssi)
+{
+  sf_linkQuality_txCallback(pAddr, macTxStatus, channel, ackRssi);
+  sf_txPower_txCallback(macTxStatus, ackRssi);
+}/* sf_tsch_linkTxCallback() */
+
 #ifdef __cplusplus
 }
 #endif
@@ -35,6 +35,9 @@ extern "C" {
  *    | @ref sf_tsch_setDeviceAddress()           | @copybrief sf_tsch_setDeviceAddress()           |
  *    | @ref sf_tsch_addDataSlots()               | @copybrief sf_tsch_addDataSlots()               |
  *    | @ref sf_tsch_send()                       | @copybrief sf_tsch_send()                       |
+ *    | @ref sf_tsch_getMaxPayloadLen()           | @copybrief sf_tsch_getMaxPayloadLen()           |
+ *    | @ref sf_tsch_setTxPolicy()                | @copybrief sf_tsch_setTxPolicy()                |
+ *    | @ref sf_tsch_linkTxCallback()             | @copybrief sf_tsch_linkTxCallback()             |
  *  @{
  */
 
@@ -44,6 +47,22 @@ extern "C" {
 #include "sf_callbackHandler.h"
 #include "sf_types.h"
 
+/*! Traffic classes with their own retransmission policy. */
+typedef enum
+{
+  /*! Any other frame: single transmission, no time to live. */
+  E_SF_TSCH_TRAFFIC_DEFAULT = 0x00,
+  /*! Measurement, stale once the next cycle starts. */
+  E_SF_TSCH_TRAFFIC_MEAS = 0x01,
+  /*! Diagnostic report. */
+  E_SF_TSCH_TRAFFIC_REPORT = 0x02,
+  /*! Join frames. */
+  E_SF_TSCH_TRAFFIC_JOIN = 0x03,
+  /*! Join request, retried by the join backoff. */
+  E_SF_TSCH_TRAFFIC_JOIN_REQUEST = 0x04,
+  E_SF_TSCH_TRAFFIC_MAX
+}E_SF_TSCH_TRAFFIC_t;
+
 /*==============================================================================
                             FUNCTION PROTOTYPES
 ==============================================================================*/
@@ -116,6 +135,59 @@ E_SF_RETURN_t sf_tsch_send(uint8_t* pFrame, uint8_t frameLen,
                            linkaddr_t* pDestAddr,
                            sf_callbackHandlerCtxt_t* pCallbackHandlerCtx);
 
+/*============================================================================*/
+/**
+ * \brief Returns the maximum payload of a frame sent with @ref sf_tsch_send().
+ *        It depends on the timeslot profile in use, TSCH refuses longer
+ *        frames.
+ *
+ * \return Maximum payload length in bytes.
+ */
+/*============================================================================*/
+uint8_t sf_tsch_getMaxPayloadLen(void);
+
+/*============================================================================*/
+/**
+ * \brief Set the retransmission budget and the time to live of the next
+ *        frames to the destination address.
+ *
+ *        The maximum number of transmissions is the ETX of the link (see
+ *        link-stats) multiplied by the factor of the traffic class, bounded
+ *        by the minimum and maximum of the class. A link without ETX gets the
+ *        maximum. Once the time to live elapsed, the frame is not sent again.
+ *        The time to live of a class is extended to cover all transmissions
+ *        in the Tx slots of the device. A frame replaced by a newer one after
+ *        its lifetime is stale: the time to live ends with the lifetime and
+ *        the transmissions are bounded by the Tx slots within it, at least
+ *        the first one is kept.
+ *
+ * \param trafficClass   Traffic class of the frames, see @ref E_SF_TSCH_TRAFFIC_t.
+ * \param pDestAddr      Pointer to the destination link address.
+ * \param lifetime       Time in seconds until the frame is replaced by a newer
+ *                       one, 0 if it is not replaced.
+ *
+ * \return @ref E_SF_RETURN_t
+ */
+/*============================================================================*/
+E_SF_RETURN_t sf_tsch_setTxPolicy(E_SF_TSCH_TRAFFIC_t trafficClass,
+                                  const linkaddr_t* pDestAddr,
+                                  uint32_t lifetime);
+
+/*============================================================================*/
+/**
+ * \brief TSCH callback called from the rtimer interrupt after every unicast
+ *        transmission attempt. Feeds the link quality cache and the Tx power
+ *        control.
+ *
+ * \param pAddr         Destination address.
+ * \param macTxStatus   MAC status of the attempt.
+ * \param channel       Channel of the slot.
+ * \param ackRssi       RSSI of the ACK in dBm, 0 if no ACK was received.
+ */
+/*============================================================================*/
+void sf_tsch_linkTxCallback(const linkaddr_t *pAddr, uint8_t macTxStatus,
+                            uint8_t channel, int16_t ackRssi);
+
 /*! @} */
 
 #endif /* __SF_TSCH_H__ */
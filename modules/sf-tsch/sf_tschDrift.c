@@ -0,0 +1,403 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Implementation of the persistent TSCH clock drift model.
+*/
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+/* Stack include */
+#include "contiki.h"
+#include "net/mac/tsch/tsch.h"
+#include "sys/log.h"
+/* Application include */
+#include "sf_persistentDataStorage.h"
+#include "sf_tschDrift.h"
+
+/*==============================================================================
+                            MACROS
+==============================================================================*/
+#define LOG_MODULE "TSCH drift"
+#ifndef LOG_CONF_APP
+  #define LOG_LEVEL     LOG_LEVEL_NONE
+#else
+  #define LOG_LEVEL     LOG_CONF_APP
+#endif
+
+/* Period of the drift model update. */
+#ifndef SF_CONF_TSCH_DRIFT_UPDATE_PERIOD
+  #define SF_TSCH_DRIFT_UPDATE_PERIOD       (30U * CLOCK_SECOND)
+#else
+  #define SF_TSCH_DRIFT_UPDATE_PERIOD       SF_CONF_TSCH_DRIFT_UPDATE_PERIOD
+#endif
+/* Minimum time between two flash checkpoints in seconds. */
+#ifndef SF_CONF_TSCH_DRIFT_CHECKPOINT_PERIOD
+  #define SF_TSCH_DRIFT_CHECKPOINT_PERIOD   (3600UL)
+#else
+  #define SF_TSCH_DRIFT_CHECKPOINT_PERIOD   SF_CONF_TSCH_DRIFT_CHECKPOINT_PERIOD
+#endif
+/* Model change, in ppm * 256, worth a new flash checkpoint. */
+#define SF_TSCH_DRIFT_CHECKPOINT_DELTA      (256L)
+/* Residual error of a converged drift estimate in ppm. */
+#ifndef SF_CONF_TSCH_DRIFT_RESIDUAL_PPM
+  #define SF_TSCH_DRIFT_RESIDUAL_PPM        (3L)
+#else
+  #define SF_TSCH_DRIFT_RESIDUAL_PPM        SF_CONF_TSCH_DRIFT_RESIDUAL_PPM
+#endif
+/* Maximum number of consecutive beacon slots skipped. 0 disables skipping. */
+#ifndef SF_CONF_TSCH_DRIFT_MAX_BEACON_SKIP
+  #define SF_TSCH_DRIFT_MAX_BEACON_SKIP     (8U)
+#else
+  #define SF_TSCH_DRIFT_MAX_BEACON_SKIP     SF_CONF_TSCH_DRIFT_MAX_BEACON_SKIP
+#endif
+/* Temperature difference in degree Celsius needed to learn the coefficient.
+   It is also the temperature change budgeted between two synchronizations. */
+#define SF_TSCH_DRIFT_TEMP_STEP             (2)
+/* Marks an unknown temperature. */
+#define SF_TSCH_DRIFT_TEMP_UNKNOWN          INT8_MIN
+
+/*==============================================================================
+                            GLOBAL VARIABLES
+==============================================================================*/
+/* Current drift model. */
+static sf_persistent_driftModel_t gDriftModel;
+/* Whether gDriftModel holds a model. */
+static bool gDriftModelValid;
+/* Drift model stored in the flash. */
+static sf_persistent_driftModel_t gStoredDriftModel;
+/* Whether gStoredDriftModel holds a model. */
+static bool gStoredDriftModelValid;
+/* Time of the last checkpoint in seconds. */
+static unsigned long gLastCheckpoint;
+/* Current temperature in degree Celsius. */
+static volatile int8_t gTemperature = SF_TSCH_DRIFT_TEMP_UNKNOWN;
+/* Longest time without synchronization a beacon may be skipped for.
+   0 to always listen. */
+static volatile clock_time_t gMaxUnsynced;
+/* Consecutive skipped beacon slots. */
+static volatile uint8_t gConsecutiveSkips;
+/* Total skipped beacon slots. */
+static volatile uint32_t gSkippedBeacons;
+
+/*==============================================================================
+                            PROCESSES
+==============================================================================*/
+PROCESS(tsch_drift_process, "TSCH drift process");
+
+/*==============================================================================
+                         LOCAL FUNCTION DEFINITION
+==============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Predict the drift at the given temperature from the model.
+ *
+ * \param temperature   Temperature in degree Celsius.
+ *
+ * \return Drift in ppm * 256.
+ */
+/*============================================================================*/
+static int32_t loc_predictDrift(int8_t temperature);
+
+/*============================================================================*/
+/**
+ * \brief Update the model with a converged drift estimate.
+ *
+ * \param drift         Drift in ppm * 256.
+ * \param temperature   Temperature in degree Celsius.
+ */
+/*============================================================================*/
+static void loc_learn(int32_t drift, int8_t temperature);
+
+/*============================================================================*/
+/**
+ * \brief Store the model into the flash if it changed notably and the last
+ *        checkpoint is old enough.
+ */
+/*============================================================================*/
+static void loc_checkpoint(void);
+
+/*============================================================================*/
+/**
+ * \brief Compute how long the node may stay without synchronization before
+ *        the predicted clock error exceeds half of the Rx guard time.
+ */
+/*============================================================================*/
+static void loc_updateSkipPolicy(void);
+
+/*==============================================================================
+                         LOCAL FUNCTION IMPLEMENTATION
+==============================================================================*/
+/*----------------------------------------------------------------------------*/
+/*! loc_predictDrift */
+/*----------------------------------------------------------------------------*/
+static int32_t loc_predictDrift(int8_t temperature)
+{
+  if((SF_TSCH_DRIFT_TEMP_UNKNOWN == temperature) ||
+     (SF_TSCH_DRIFT_TEMP_UNKNOWN == gDriftModel.refTemp))
+  {
+    return gDriftModel.driftPpm;
+  }
+
+  return gDriftModel.driftPpm +
+         (int32_t)gDriftModel.tempCoeff * (temperature - gDriftModel.refTemp);
+}/* loc_predictDrift() */
+
+/*----------------------------------------------------------------------------*/
+/*! loc_learn */
+/*----------------------------------------------------------------------------*/
+static void loc_learn(int32_t drift, int8_t temperature)
+{
+  /* Temperature difference to the reference. */
+  int16_t deltaTemp = 0;
+  /* Coefficient measured by this estimate. */
+  int32_t coeff;
+
+  if(!gDriftModelValid)
+  {
+    gDriftModel.driftPpm = drift;
+    gDriftModel.refTemp = temperature;
+    gDriftModel.tempCoeff = 0;
+    gDriftModelValid = true;
+    return;
+  }
+
+  if(SF_TSCH_DRIFT_TEMP_UNKNOWN == gDriftModel.refTemp)
+  {
+    gDriftModel.refTemp = temperature;
+  }
+  else if(SF_TSCH_DRIFT_TEMP_UNKNOWN != temperature)
+  {
+    deltaTemp = temperature - gDriftModel.refTemp;
+  }
+
+  if((deltaTemp >= SF_TSCH_DRIFT_TEMP_STEP) ||
+     (deltaTemp <= -SF_TSCH_DRIFT_TEMP_STEP))
+  {
+    /* Far enough from the reference to learn the coefficient. */
+    coeff = (drift - gDriftModel.driftPpm) / deltaTemp;
+    coeff = (3 * (int32_t)gDriftModel.tempCoeff + coeff) / 4;
+    if(coeff > INT16_MAX)
+    {
+      coeff = INT16_MAX;
+    }
+    else if(coeff < INT16_MIN)
+    {
+      coeff = INT16_MIN;
+    }
+    gDriftModel.tempCoeff = (int16_t)coeff;
+  }
+  else
+  {
+    /* Close to the reference, track the drift itself. */
+    drift -= (int32_t)gDriftModel.tempCoeff * deltaTemp;
+    gDriftModel.driftPpm = (3 * gDriftModel.driftPpm + drift) / 4;
+  }
+}/* loc_learn() */
+
+/*----------------------------------------------------------------------------*/
+/*! loc_checkpoint */
+/*----------------------------------------------------------------------------*/
+static void loc_checkpoint(void)
+{
+  /* Model change since the last checkpoint. */
+  int32_t delta;
+
+  if(gStoredDriftModelValid)
+  {
+    if((clock_seconds() - gLastCheckpoint) < SF_TSCH_DRIFT_CHECKPOINT_PERIOD)
+    {
+      return;
+    }
+
+    delta = gDriftModel.driftPpm - gStoredDriftModel.driftPpm;
+    if((delta < SF_TSCH_DRIFT_CHECKPOINT_DELTA) &&
+       (delta > -SF_TSCH_DRIFT_CHECKPOINT_DELTA) &&
+       (gDriftModel.tempCoeff == gStoredDriftModel.tempCoeff))
+    {
+      return;
+    }
+  }
+
+  memcpy(&gStoredDriftModel, &gDriftModel, sizeof(gStoredDriftModel));
+  if(E_SF_SUCCESS == sf_persistentDataStorage_writeDriftModel(&gStoredDriftModel))
+  {
+    gStoredDriftModelValid = true;
+    gLastCheckpoint = clock_seconds();
+    LOG_INFO("Drift model stored: %ld ppm, %d ppm/256 per C at %d C\n",
+             (long)(gDriftModel.driftPpm / 256), gDriftModel.tempCoeff,
+             gDriftModel.refTemp);
+  }
+  else
+  {
+    LOG_ERR("!Failed to store drift model\n");
+  }
+}/* loc_checkpoint() */
+
+/*----------------------------------------------------------------------------*/
+/*! loc_updateSkipPolicy */
+/*----------------------------------------------------------------------------*/
+static void loc_updateSkipPolicy(void)
+{
+  /* Error of the drift estimate in ppm * 256. */
+  int32_t residual;
+  /* Tolerated clock error in us. */
+  uint32_t guardUs;
+  /* Resulting interval in clock ticks. */
+  uint32_t maxUnsynced;
+
+  if(!SF_TSCH_DRIFT_MAX_BEACON_SKIP || !tsch_is_associated ||
+     !tsch_adaptive_timesync_is_converged())
+  {
+    gMaxUnsynced = 0;
+    return;
+  }
+
+  /* Residual error of the estimate plus the drift caused by a temperature
+     change within the interval. */
+  residual = SF_TSCH_DRIFT_RESIDUAL_PPM * 256 +
+             (gDriftModel.tempCoeff < 0 ? -gDriftModel.tempCoeff :
+                                          gDriftModel.tempCoeff) *
+             SF_TSCH_DRIFT_TEMP_STEP;
+
+  /* Half the guard time on each side of the expected Rx time is kept as
+     margin. ppm equals us per second. */
+  guardUs = tsch_timing_us[tsch_ts_rx_wait] / 4;
+  maxUnsynced = (uint32_t)(((uint64_t)guardUs * 256 * CLOCK_SECOND) / residual);
+  if(maxUnsynced > (TSCH_DESYNC_THRESHOLD / 2))
+  {
+    maxUnsynced = TSCH_DESYNC_THRESHOLD / 2;
+  }
+
+  gMaxUnsynced = (clock_time_t)maxUnsynced;
+}/* loc_updateSkipPolicy() */
+
+/*==============================================================================
+                            PROCESS IMPLEMENTATION
+==============================================================================*/
+/*------------------------------------------------------------------------------
+  tsch_drift_process()
+------------------------------------------------------------------------------*/
+PROCESS_THREAD(tsch_drift_process, ev, data)
+{
+  /* Update timer */
+  static struct etimer updateTimer;
+  /* Temperature in degree Celsius */
+  int8_t temperature;
+
+  PROCESS_BEGIN();
+
+  etimer_set(&updateTimer, SF_TSCH_DRIFT_UPDATE_PERIOD);
+
+  while(1)
+  {
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&updateTimer));
+    etimer_reset(&updateTimer);
+
+    if(tsch_is_associated && tsch_adaptive_timesync_is_converged())
+    {
+      temperature = gTemperature;
+      loc_learn(tsch_adaptive_timesync_get_drift(), temperature);
+
+      /* A later re-association starts from the current prediction. */
+      tsch_adaptive_timesync_set_initial_drift(loc_predictDrift(temperature));
+
+      loc_checkpoint();
+    }
+
+    loc_updateSkipPolicy();
+  }
+
+  PROCESS_END();
+}/* tsch_drift_process() */
+
+/*==============================================================================
+                      API FUNCTION IMPLEMENTATION
+==============================================================================*/
+/*----------------------------------------------------------------------------*/
+/*! sf_tschDrift_start */
+/*----------------------------------------------------------------------------*/
+void sf_tschDrift_start(bool restore)
+{
+  gDriftModelValid = false;
+  gStoredDriftModelValid = false;
+  gMaxUnsynced = 0;
+
+  if(E_SF_SUCCESS == sf_persistentDataStorage_readDriftModel(&gStoredDriftModel))
+  {
+    gStoredDriftModelValid = true;
+    gLastCheckpoint = clock_seconds();
+
+    if(restore)
+    {
+      memcpy(&gDriftModel, &gStoredDriftModel, sizeof(gDriftModel));
+      gDriftModelValid = true;
+
+      tsch_adaptive_timesync_set_initial_drift(loc_predictDrift(gTemperature));
+      LOG_INFO("Drift model restored: %ld ppm\n",
+               (long)(gDriftModel.driftPpm / 256));
+    }
+  }
+
+  if(process_is_running(&tsch_drift_process))
+  {
+    process_exit(&tsch_drift_process);
+  }
+
+  process_start(&tsch_drift_process, NULL);
+}/* sf_tschDrift_start() */
+
+/*----------------------------------------------------------------------------*/
+/*! sf_tschDrift_setTemperature */
+/*----------------------------------------------------------------------------*/
+void sf_tschDrift_setTemperature(int8_t temperature)
+{
+  gTemperature = temperature;
+}/* sf_tschDrift_setTemperature() */
+
+/*----------------------------------------------------------------------------*/
+/*! sf_tschDrift_getSkippedBeacons */
+/*----------------------------------------------------------------------------*/
+uint32_t sf_tschDrift_getSkippedBeacons(void)
+{
+  return gSkippedBeacons;
+}/* sf_tschDrift_getSkippedBeacons() */
+
+/*----------------------------------------------------------------------------*/
+/*! sf_tschDrift_skipBeaconCallback */
+/*----------------------------------------------------------------------------*/
+int sf_tschDrift_skipBeaconCallback(clock_time_t sinceLastSync)
+{
+  if((0 == gMaxUnsynced) || (sinceLastSync >= gMaxUnsynced) ||
+     (gConsecutiveSkips >= SF_TSCH_DRIFT_MAX_BEACON_SKIP))
+  {
+    gConsecutiveSkips = 0;
+    return 0;
+  }
+
+  gConsecutiveSkips++;
+  gSkippedBeacons++;
+
+  return 1;
+}/* sf_tschDrift_skipBeaconCallback() */
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,104 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __SF_TSCH_DRIFT_H__
+#define __SF_TSCH_DRIFT_H__
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Persistent clock drift model of the TSCH time synchronization.
+
+ @details The drift to the time source learned by the TSCH adaptive time
+          synchronization is modeled as drift at a reference temperature plus
+          a temperature coefficient. The model is checkpointed to the flash
+          and restored on warm start, so the drift compensation is active
+          from the first slot. Once the drift estimate has converged, beacon
+          slots are skipped as long as the predicted clock error since the
+          last synchronization stays within the Rx guard time.
+*/
+
+/**
+ *  @addtogroup SF_TSCH
+ *
+ *  @details
+ *
+ *  - <b>TSCH drift model API</b>\n
+ *    | API Function                              | Description                                     |
+ *    |-------------------------------------------|-------------------------------------------------|
+ *    | @ref sf_tschDrift_start()                 | @copybrief sf_tschDrift_start()                 |
+ *    | @ref sf_tschDrift_setTemperature()        | @copybrief sf_tschDrift_setTemperature()        |
+ *    | @ref sf_tschDrift_getSkippedBeacons()     | @copybrief sf_tschDrift_getSkippedBeacons()     |
+ *    | @ref sf_tschDrift_skipBeaconCallback()    | @copybrief sf_tschDrift_skipBeaconCallback()    |
+ *  @{
+ */
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdint.h>
+#include <stdbool.h>
+/* Stack include */
+#include "contiki.h"
+
+/*==============================================================================
+                            FUNCTION PROTOTYPES
+==============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Start learning the drift model and adapting the beacon listening.
+ *
+ * \param restore   True to seed the TSCH drift compensation with the model
+ *                  stored in the flash (warm start).
+ */
+/*============================================================================*/
+void sf_tschDrift_start(bool restore);
+
+/*============================================================================*/
+/**
+ * \brief Provide the current device temperature.
+ *
+ * \param temperature   Temperature in degree Celsius.
+ */
+/*============================================================================*/
+void sf_tschDrift_setTemperature(int8_t temperature);
+
+/*============================================================================*/
+/**
+ * \brief Returns the number of beacon slots skipped since start.
+ *
+ * \return Number of skipped beacon slots.
+ */
+/*============================================================================*/
+uint32_t sf_tschDrift_getSkippedBeacons(void);
+
+/*============================================================================*/
+/**
+ * \brief TSCH callback called from the rtimer interrupt before listening to
+ *        a beacon slot.
+ *
+ * \param sinceLastSync   Time since the last synchronization in clock ticks.
+ *
+ * \return 1 to skip the beacon slot, 0 to listen.
+ */
+/*============================================================================*/
+int sf_tschDrift_skipBeaconCallback(clock_time_t sinceLastSync);
+
+/*! @} */
+
+#endif /* __SF_TSCH_DRIFT_H__ */
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,345 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Implementation of the closed-loop Tx power control.
+*/
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdint.h>
+#include <stdbool.h>
+/* Stack include */
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/mac/mac.h"
+#include "net/mac/tsch/tsch.h"
+#if CONTIKI_TARGET_SIMPLELINK
+#include "rf/tx-power.h"
+#endif
+/* Application include */
+#include "sf_txPower.h"
+
+/* Log configuration */
+#include "sys/log.h"
+
+/*==============================================================================
+                            MACROS
+==============================================================================*/
+#define LOG_MODULE "Tx Power"
+/* Defines log level*/
+#ifndef LOG_CONF_APP
+  #define LOG_LEVEL     LOG_LEVEL_NONE
+#else
+  #define LOG_LEVEL     LOG_CONF_APP
+#endif
+/* Number of transmission attempts evaluated at once. */
+#ifndef SF_CONF_TXPOWER_WINDOW
+  #define SF_TXPOWER_WINDOW              (8U)
+#else
+  #define SF_TXPOWER_WINDOW              SF_CONF_TXPOWER_WINDOW
+#endif
+/* Minimum average ACK RSSI in dBm. */
+#ifndef SF_CONF_TXPOWER_TARGET_RSSI
+  #define SF_TXPOWER_TARGET_RSSI         (-75)
+#else
+  #define SF_TXPOWER_TARGET_RSSI         SF_CONF_TXPOWER_TARGET_RSSI
+#endif
+/* Minimum PRR of a window in percent. */
+#ifndef SF_CONF_TXPOWER_TARGET_PRR
+  #define SF_TXPOWER_TARGET_PRR          (90U)
+#else
+  #define SF_TXPOWER_TARGET_PRR          SF_CONF_TXPOWER_TARGET_PRR
+#endif
+/* Margin in dB the RSSI must keep above the target after a step down. */
+#ifndef SF_CONF_TXPOWER_HYSTERESIS
+  #define SF_TXPOWER_HYSTERESIS          (6)
+#else
+  #define SF_TXPOWER_HYSTERESIS          SF_CONF_TXPOWER_HYSTERESIS
+#endif
+/* Number of lost ACKs in a row setting the maximum power. */
+#ifndef SF_CONF_TXPOWER_NOACK_LIMIT
+  #define SF_TXPOWER_NOACK_LIMIT         (2U)
+#else
+  #define SF_TXPOWER_NOACK_LIMIT         SF_CONF_TXPOWER_NOACK_LIMIT
+#endif
+#if !CONTIKI_TARGET_SIMPLELINK
+/* Step in dB between the levels if the RF driver has no power table. */
+#define SF_TXPOWER_STEP_DB               (3)
+#endif
+
+/*==============================================================================
+                            GLOBAL VARIABLES
+==============================================================================*/
+/* Index of the current power level. */
+static uint8_t gLevel;
+/* Transmission attempts, acknowledged attempts and ACK RSSI sum of the
+   current window. Written from the rtimer interrupt. */
+static volatile uint8_t gWinTx;
+static volatile uint8_t gWinAcked;
+static volatile int32_t gWinRssiSum;
+/* Number of lost ACKs in a row. */
+static volatile uint8_t gNoAckRun;
+/* Set from the rtimer interrupt to select the maximum power. */
+static volatile bool gStepUpMax;
+
+PROCESS(sf_txPower_process, "Tx power control process");
+
+/*==============================================================================
+                         LOCAL FUNCTION DEFINITION
+==============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Returns the number of power levels.
+ */
+/*============================================================================*/
+static uint8_t loc_numLevels(void);
+
+/*============================================================================*/
+/**
+ * \brief Returns the power of a level, levels are sorted by increasing power.
+ *
+ * \param level   Index of the level.
+ *
+ * \return Tx power in dBm.
+ */
+/*============================================================================*/
+static int8_t loc_getPower(uint8_t level);
+
+/*============================================================================*/
+/**
+ * \brief Set a power level in the radio and start a new window. Must be
+ *        called with the TSCH lock taken.
+ *
+ * \param level   Index of the level.
+ */
+/*============================================================================*/
+static void loc_setLevel(uint8_t level);
+
+/*============================================================================*/
+/**
+ * \brief Evaluate the current window and step the power level.
+ */
+/*============================================================================*/
+static void loc_evaluate(void);
+
+/*==============================================================================
+                         LOCAL FUNCTION IMPLEMENTATION
+==============================================================================*/
+/*------------------------------------------------------------------------------
+  loc_numLevels()
+------------------------------------------------------------------------------*/
+static uint8_t loc_numLevels(void)
+{
+#if CONTIKI_TARGET_SIMPLELINK
+  return (uint8_t)rf_tx_power_table_size;
+#else
+  radio_value_t min;
+  radio_value_t max;
+
+  NETSTACK_RADIO.get_value(RADIO_CONST_TXPOWER_MIN, &min);
+  NETSTACK_RADIO.get_value(RADIO_CONST_TXPOWER_MAX, &max);
+  return (uint8_t)((max - min) / SF_TXPOWER_STEP_DB + 1);
+#endif
+}/* loc_numLevels() */
+
+/*------------------------------------------------------------------------------
+  loc_getPower()
+------------------------------------------------------------------------------*/
+static int8_t loc_getPower(uint8_t level)
+{
+#if CONTIKI_TARGET_SIMPLELINK
+  return rf_tx_power_table[level].power;
+#else
+  radio_value_t max;
+
+  /* The highest level is the maximum of the radio. */
+  NETSTACK_RADIO.get_value(RADIO_CONST_TXPOWER_MAX, &max);
+  return (int8_t)(max - (loc_numLevels() - 1 - level) * SF_TXPOWER_STEP_DB);
+#endif
+}/* loc_getPower() */
+
+/*------------------------------------------------------------------------------
+  loc_setLevel()
+------------------------------------------------------------------------------*/
+static void loc_setLevel(uint8_t level)
+{
+  if(level != gLevel)
+  {
+    if(RADIO_RESULT_OK == NETSTACK_RADIO.set_value(RADIO_PARAM_TXPOWER,
+                                                   loc_getPower(level)))
+    {
+      LOG_INFO("Tx power %d dBm\n", loc_getPower(level));
+      gLevel = level;
+    }
+  }
+
+  gWinTx = 0;
+  gWinAcked = 0;
+  gWinRssiSum = 0;
+  gNoAckRun = 0;
+  gStepUpMax = false;
+}/* loc_setLevel() */
+
+/*------------------------------------------------------------------------------
+  loc_evaluate()
+------------------------------------------------------------------------------*/
+static void loc_evaluate(void)
+{
+  /* Index of the highest level */
+  uint8_t maxLevel = loc_numLevels() - 1;
+  /* Level of the next window */
+  uint8_t level = gLevel;
+  /* RSSI of the window at the BMS-CC, estimated from the ACK RSSI */
+  int16_t rssi;
+
+  if(gStepUpMax)
+  {
+    /* Lost ACKs in a row. Restore the link first. */
+    level = maxLevel;
+  }
+  else if(gWinTx >= SF_TXPOWER_WINDOW)
+  {
+    /* The ACKs are sent at the maximum power and do not follow the level,
+       the frames arrive weaker by the power below the maximum. */
+    rssi = (gWinAcked > 0) ?
+           (int16_t)(gWinRssiSum / gWinAcked -
+                     (loc_getPower(maxLevel) - loc_getPower(level))) :
+           INT16_MIN;
+
+    if(((gWinAcked * 100U) < (gWinTx * SF_TXPOWER_TARGET_PRR)) ||
+       (rssi < SF_TXPOWER_TARGET_RSSI))
+    {
+      if(level < maxLevel)
+      {
+        level++;
+      }
+    }
+    else if((gWinAcked == gWinTx) && (level > 0) &&
+            ((rssi - (loc_getPower(level) - loc_getPower(level - 1))) >=
+             (SF_TXPOWER_TARGET_RSSI + SF_TXPOWER_HYSTERESIS)))
+    {
+      /* The link keeps its margin one level below. */
+      level--;
+    }
+  }
+  else
+  {
+    /* Window not complete yet. */
+    return;
+  }
+
+  loc_setLevel(level);
+}/* loc_evaluate() */
+
+/*------------------------------------------------------------------------------
+  sf_txPower_process()
+------------------------------------------------------------------------------*/
+PROCESS_THREAD(sf_txPower_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  while(1)
+  {
+    PROCESS_WAIT_EVENT_UNTIL(PROCESS_EVENT_POLL == ev);
+
+    /* The slot operation must not use the radio or the window meanwhile.
+       If the lock is not granted, the next transmission polls again. */
+    if(tsch_get_lock())
+    {
+      loc_evaluate();
+      tsch_release_lock();
+    }
+  }
+
+  PROCESS_END();
+}/* sf_txPower_process() */
+
+/*==============================================================================
+                      API FUNCTION IMPLEMENTATION
+==============================================================================*/
+/*------------------------------------------------------------------------------
+  sf_txPower_init()
+------------------------------------------------------------------------------*/
+void sf_txPower_init(void)
+{
+  /* The radio has been set to the maximum power. */
+  gLevel = loc_numLevels() - 1;
+  loc_setLevel(gLevel);
+
+  process_start(&sf_txPower_process, NULL);
+}/* sf_txPower_init() */
+
+/*------------------------------------------------------------------------------
+  sf_txPower_reset()
+------------------------------------------------------------------------------*/
+void sf_txPower_reset(void)
+{
+  gStepUpMax = true;
+  process_poll(&sf_txPower_process);
+}/* sf_txPower_reset() */
+
+/*------------------------------------------------------------------------------
+  sf_txPower_get()
+------------------------------------------------------------------------------*/
+int8_t sf_txPower_get(void)
+{
+  return loc_getPower(gLevel);
+}/* sf_txPower_get() */
+
+/*------------------------------------------------------------------------------
+  sf_txPower_txCallback()
+------------------------------------------------------------------------------*/
+void sf_txPower_txCallback(uint8_t macTxStatus, int16_t ackRssi)
+{
+  /* Only a sent frame tells about the link. */
+  if((MAC_TX_OK != macTxStatus) && (MAC_TX_NOACK != macTxStatus))
+  {
+    return;
+  }
+
+  if(gWinTx >= SF_TXPOWER_WINDOW)
+  {
+    /* The window is not evaluated yet, e.g. the TSCH lock was not granted. */
+    process_poll(&sf_txPower_process);
+    return;
+  }
+
+  gWinTx++;
+  if(MAC_TX_OK == macTxStatus)
+  {
+    gWinAcked++;
+    gWinRssiSum += ackRssi;
+    gNoAckRun = 0;
+  }
+  else if((++gNoAckRun >= SF_TXPOWER_NOACK_LIMIT) &&
+          (gLevel < (loc_numLevels() - 1)))
+  {
+    /* Fast step up to the maximum power. */
+    gStepUpMax = true;
+    process_poll(&sf_txPower_process);
+  }
+
+  if(gWinTx >= SF_TXPOWER_WINDOW)
+  {
+    process_poll(&sf_txPower_process);
+  }
+}/* sf_txPower_txCallback() */
+
+#ifdef __cplusplus
+}
+#endif
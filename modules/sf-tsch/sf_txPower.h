@@ -0,0 +1,100 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __SF_TX_POWER_H__
+#define __SF_TX_POWER_H__
+
+/**
+ @code
+  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ embedded.connectivity.solutions.==============
+ @endcode
+
+ @file
+ @copyright  STACKFORCE GmbH, Germany, www.stackforce.de
+ @author     STACKFORCE
+ @brief      Closed-loop Tx power control.
+
+ @details The Tx power starts at the maximum level of the RF driver power
+          table. The unicast transmissions are evaluated in windows of a few
+          frames. The BMS-CC sends the ACKs at the maximum power of the same
+          table, the RSSI of the frames at the BMS-CC is estimated as the
+          average ACK RSSI less the power below the maximum. The power is
+          lowered by one level of the table if this RSSI stays above the
+          target plus a hysteresis after the step and no ACK has been lost.
+          It is raised by one level if the RSSI or the PRR falls below the
+          target, and set back to the maximum as soon as several ACKs in a
+          row are lost.
+*/
+
+/**
+ *  @addtogroup SF_TSCH
+ *
+ *  @details
+ *
+ *  - <b>Tx power control API</b>\n
+ *    | API Function                              | Description                                     |
+ *    |-------------------------------------------|-------------------------------------------------|
+ *    | @ref sf_txPower_init()                    | @copybrief sf_txPower_init()                    |
+ *    | @ref sf_txPower_reset()                   | @copybrief sf_txPower_reset()                   |
+ *    | @ref sf_txPower_get()                     | @copybrief sf_txPower_get()                     |
+ *    | @ref sf_txPower_txCallback()              | @copybrief sf_txPower_txCallback()              |
+ *  @{
+ */
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Standard include */
+#include <stdint.h>
+#include <stdbool.h>
+
+/*==============================================================================
+                            FUNCTION PROTOTYPES
+==============================================================================*/
+/*============================================================================*/
+/**
+ * \brief Initialize the Tx power control at the maximum power level.
+ */
+/*============================================================================*/
+void sf_txPower_init(void);
+
+/*============================================================================*/
+/**
+ * \brief Set the Tx power back to the maximum level, e.g. when the network
+ *        has been left.
+ */
+/*============================================================================*/
+void sf_txPower_reset(void);
+
+/*============================================================================*/
+/**
+ * \brief Returns the current Tx power.
+ *
+ * \return Tx power in dBm.
+ */
+/*============================================================================*/
+int8_t sf_txPower_get(void);
+
+/*============================================================================*/
+/**
+ * \brief TSCH callback called from the rtimer interrupt after every unicast
+ *        transmission attempt.
+ *
+ * \param macTxStatus   MAC status of the attempt.
+ * \param ackRssi       RSSI of the ACK in dBm, 0 if no ACK was received.
+ */
+/*============================================================================*/
+void sf_txPower_txCallback(uint8_t macTxStatus, int16_t ackRssi);
+
+/*! @} */
+
+#endif /* __SF_TX_POWER_H__ */
+
+#ifdef __cplusplus
+}
+#endif
@@ -102,6 +102,13 @@
 bool gUartConnected = false;
 #endif
 
+/* The boot indication is shown by platform_init_deferred() instead. */
+#if PLATFORM_DEFERS_INIT
+#define boot_fade(pin)
+#else
+#define boot_fade(pin) fade(pin)
+#endif
+
 /*---------------------------------------------------------------------------*/
 /*
  * Board-specific initialization function. This function is defined in
@@ -161,6 +168,33 @@ set_rf_params(void)
   NETSTACK_RADIO.set_object(RADIO_PARAM_64BIT_ADDR, ext_addr, sizeof(ext_addr));
 }
 /*---------------------------------------------------------------------------*/
+/*
+ * \brief  Start the console on the UARTs.
+ */
+static void
+console_init(void)
+{
+#if UART_DEPENDS_ON_UART_CONNECTION
+  if(!gUartConnected) {
+    return;
+  }
+#endif
+
+  serial_line_init();
+
+#if TI_UART_CONF_UART0_ENABLE
+  uart0_init();
+#endif
+
+#if BOARD_CONF_ENABLE_LOGS_ON_UART1
+  uart1_init();
+#endif
+
+#if BUILD_WITH_SHELL
+  uart0_set_callback(serial_line_input_byte);
+#endif
+}
+/*---------------------------------------------------------------------------*/
 void
 platform_init_stage_one(void)
 {
@@ -197,7 +231,7 @@ platform_init_stage_one(void)
   gpio_hal_init();
   leds_init();
 
-  fade(Board_PIN_LED0);
+  boot_fade(Board_PIN_LED0);
 
 
 #if UART_DEPENDS_ON_UART_CONNECTION
@@ -237,7 +271,7 @@ platform_init_stage_one(void)
 
 
 
-  fade(Board_PIN_LED1);
+  boot_fade(Board_PIN_LED1);
 
   /* NoRTOS must be called last */
   NoRTOS_start();
@@ -246,39 +280,8 @@ platform_init_stage_one(void)
 void
 platform_init_stage_two(void)
 {
-
-#if UART_DEPENDS_ON_UART_CONNECTION
-  if(gUartConnected)
-  {
-    serial_line_init();
-
-#if TI_UART_CONF_UART0_ENABLE
-    uart0_init();
-#endif
-
-#if BOARD_CONF_ENABLE_LOGS_ON_UART1
-    uart1_init();
-#endif
-
-#if BUILD_WITH_SHELL
-    uart0_set_callback(serial_line_input_byte);
-#endif
-  }
-#else
-
-  serial_line_init();
-
-#if TI_UART_CONF_UART0_ENABLE
-  uart0_init();
-#endif
-
-#if BOARD_CONF_ENABLE_LOGS_ON_UART1
-  uart1_init();
-#endif
-
-#if BUILD_WITH_SHELL
-  uart0_set_callback(serial_line_input_byte);
-#endif
+#if !PLATFORM_DEFERS_INIT
+  console_init();
 #endif
 
   /* Use TRNG to seed PRNG. If TRNG fails, use a hard-coded seed. */
@@ -304,7 +307,7 @@ platform_init_stage_two(void)
 
 
 
-  fade(Board_PIN_LED0);
+  boot_fade(Board_PIN_LED0);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -346,10 +349,21 @@ platform_init_stage_three(void)
   process_start(&sensors_process, NULL);
 #endif
 
-  fade(Board_PIN_LED1);
+  boot_fade(Board_PIN_LED1);
 
 
 
+}
+/*---------------------------------------------------------------------------*/
+void
+platform_init_deferred(void)
+{
+#if PLATFORM_DEFERS_INIT
+  console_init();
+
+  fade(Board_PIN_LED0);
+  fade(Board_PIN_LED1);
+#endif
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -351,18 +351,25 @@ frame80215e_create_ie_tsch_channel_hopping_sequence(uint8_t *buf, int len,
   }
 }
 
-/* MLME sub-IE. Current time stamp and join mode. Used in EBs */
+/* MLME sub-IE. Current time stamp, join mode, join congestion level and
+ * hopping sequence blacklist. Used in EBs. Receivers not aware of the
+ * trailing fields ignore them. */
 int frame80215e_create_ie_tsch_absolute_time_and_join_mode(uint8_t *buf, int len,
     struct ieee802154_ies *ies)
 {
   int ie_len;
-  if((ies == NULL) || (len < 6)) {
+  if((ies == NULL) || (len < 2 + FRAME802154E_IE_ABSOLUTE_TIME_AND_JOIN_MODE_LEN)) {
     return -1;
   }
 
-  ie_len = 5;
+  ie_len = FRAME802154E_IE_ABSOLUTE_TIME_AND_JOIN_MODE_LEN;
   WRITE32(buf + 2, ies->ie_absolute_time); /* time stamp */
   buf[2 + 4] = ies->ie_join_mode; /* join mode */
+  buf[2 + 5] = ies->ie_join_congestion; /* join congestion level */
+  WRITE16(buf + 2 + 6, ies->ie_hopping_blacklist); /* current blacklist */
+  WRITE16(buf + 2 + 8, ies->ie_hopping_next_blacklist); /* next blacklist */
+  WRITE32(buf + 2 + 10, ies->ie_hopping_switch_asn.ls4b); /* switch ASN */
+  buf[2 + 14] = ies->ie_hopping_switch_asn.ms1b;
   create_mlme_long_ie_descriptor(buf, MLME_LONG_IE_TSCH_ABSOLUTE_TIME_AND_JOIN_MODE, ie_len);
   return 2 + ie_len;
 }
@@ -497,6 +504,17 @@ frame802154e_parse_mlme_long_ie(const uint8_t *buf, int len,
           if(ies != NULL) {
             READ32(buf+0, ies->ie_absolute_time);
             ies->ie_join_mode = buf[4];
+            ies->ie_join_congestion = (len > 5) ? buf[5] : 0;
+            if(len > 14) {
+              READ16(buf+6, ies->ie_hopping_blacklist);
+              READ16(buf+8, ies->ie_hopping_next_blacklist);
+              READ32(buf+10, ies->ie_hopping_switch_asn.ls4b);
+              ies->ie_hopping_switch_asn.ms1b = buf[14];
+            } else {
+              ies->ie_hopping_blacklist = 0;
+              ies->ie_hopping_next_blacklist = 0;
+              TSCH_ASN_INIT(ies->ie_hopping_switch_asn, 0, 0);
+            }
           }
           return len;
         }
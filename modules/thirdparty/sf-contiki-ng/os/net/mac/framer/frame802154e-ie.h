@@ -50,6 +50,10 @@
 #include "net/mac/tsch/tsch-asn.h"
 
 #define FRAME802154E_IE_MAX_LINKS       4
+/* Content length of the MLME absolute time and join mode IE: time stamp (4),
+ * join mode (1), join congestion (1), blacklist (2), next blacklist (2) and
+ * switch ASN (5) */
+#define FRAME802154E_IE_ABSOLUTE_TIME_AND_JOIN_MODE_LEN 15
 
 /* Structures used for the Slotframe and Links information element */
 struct tsch_slotframe_and_links_link {
@@ -90,6 +94,13 @@ struct ieee802154_ies {
   uint32_t ie_absolute_time;
   /* Join mode */
   uint32_t ie_join_mode;
+  /* Join congestion level (0: none) */
+  uint8_t ie_join_congestion;
+  /* Blacklisted entries of the default hopping sequence, one bit per entry */
+  uint16_t ie_hopping_blacklist;
+  /* Blacklist taking effect at ie_hopping_switch_asn (ASN 0: none pending) */
+  uint16_t ie_hopping_next_blacklist;
+  struct tsch_asn_t ie_hopping_switch_asn;
 #if TSCH_WITH_SIXTOP
   /* Payload Sixtop IE */
   const uint8_t *sixtop_ie_content_ptr;
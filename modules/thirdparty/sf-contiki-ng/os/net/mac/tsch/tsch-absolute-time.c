@@ -0,0 +1,77 @@
+/*
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \addtogroup tsch
+ * @{
+ * \file
+ *	TSCH network time derived from the ASN
+*/
+
+#include "net/mac/tsch/tsch-absolute-time.h"
+
+/*---------------------------------------------------------------------------*/
+int64_t
+tsch_at_asn_diff(const struct tsch_asn_t *asn1, const struct tsch_asn_t *asn2)
+{
+  return (int64_t)(((uint64_t)asn1->ms1b << 32) | asn1->ls4b)
+         - (int64_t)(((uint64_t)asn2->ms1b << 32) | asn2->ls4b);
+}
+/*---------------------------------------------------------------------------*/
+uint64_t
+tsch_at_to_ms(const struct tsch_at_anchor *anchor, const struct tsch_asn_t *asn,
+              int64_t ofs_us, uint32_t timeslot_us)
+{
+  int64_t elapsed_us;
+
+  elapsed_us = tsch_at_asn_diff(asn, &anchor->asn) * timeslot_us + ofs_us;
+  /* Round towards the past, also before the anchor */
+  if(elapsed_us < 0) {
+    return anchor->ms - (uint64_t)((999 - elapsed_us) / 1000);
+  }
+  return anchor->ms + (uint64_t)(elapsed_us / 1000);
+}
+/*---------------------------------------------------------------------------*/
+enum tsch_at_resync_result
+tsch_at_resync(struct tsch_at_anchor *anchor, uint32_t t,
+               const struct tsch_asn_t *asn, uint32_t timeslot_us,
+               uint32_t max_drift_ms, int64_t *adjust_ms)
+{
+  uint64_t t_ms = (uint64_t)t * 1000;
+  uint64_t estimate_ms;
+  uint64_t new_ms;
+
+  if(adjust_ms != NULL) {
+    *adjust_ms = 0;
+  }
+
+  if(anchor->ms == 0) {
+    anchor->ms = t_ms;
+    anchor->asn = *asn;
+    return TSCH_AT_SET;
+  }
+
+  estimate_ms = tsch_at_to_ms(anchor, asn, 0, timeslot_us);
+  if(estimate_ms < t_ms) {
+    new_ms = t_ms;
+  } else if(estimate_ms >= t_ms + 1000) {
+    new_ms = t_ms + 999;
+  } else {
+    return TSCH_AT_UNCHANGED;
+  }
+
+  anchor->ms = new_ms;
+  anchor->asn = *asn;
+  if(adjust_ms != NULL) {
+    *adjust_ms = (int64_t)new_ms - (int64_t)estimate_ms;
+  }
+
+  if(estimate_ms + max_drift_ms < new_ms || new_ms + max_drift_ms < estimate_ms) {
+    return TSCH_AT_RESET;
+  }
+  return TSCH_AT_ADJUSTED;
+}
+/*---------------------------------------------------------------------------*/
+/** @} */
@@ -0,0 +1,84 @@
+/*
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \addtogroup tsch
+ * @{
+ * \file
+ *	TSCH network time derived from the ASN. The absolute time in ms is
+ *	anchored to the start of a slot; the time of any other slot follows
+ *	from the elapsed slots and the timeslot length, with no periodic timer.
+*/
+
+#ifndef __TSCH_ABSOLUTE_TIME_H__
+#define __TSCH_ABSOLUTE_TIME_H__
+
+/********** Includes **********/
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch-asn.h"
+
+/********** Data types **********/
+
+/** \brief Absolute time at the start of a slot */
+struct tsch_at_anchor {
+  uint64_t ms; /* absolute time in ms, 0: unknown */
+  struct tsch_asn_t asn;
+};
+
+/** \brief Result of tsch_at_resync */
+enum tsch_at_resync_result {
+  TSCH_AT_UNCHANGED, /* the estimate lies within the beacon second */
+  TSCH_AT_SET,       /* the anchor was unknown and has been set */
+  TSCH_AT_ADJUSTED,  /* moved to the beacon second by up to the max drift */
+  TSCH_AT_RESET,     /* moved by more than the max drift */
+};
+
+/********** Functions *********/
+
+/**
+ * \brief Signed number of slots from asn2 to asn1 over the full 40-bit ASN.
+ * TSCH_ASN_DIFF only covers 2^31 slots, i.e. about 186 days at 7.5 ms.
+ * \param asn1 The later ASN
+ * \param asn2 The earlier ASN
+ * \return asn1 - asn2
+ */
+int64_t tsch_at_asn_diff(const struct tsch_asn_t *asn1,
+                         const struct tsch_asn_t *asn2);
+
+/**
+ * \brief Absolute time at an offset from the start of a slot
+ * \param anchor The anchor, its time must be known
+ * \param asn The slot
+ * \param ofs_us Offset from the start of the slot in us, negative before it
+ * \param timeslot_us The timeslot length in us
+ * \return The absolute time in ms
+ */
+uint64_t tsch_at_to_ms(const struct tsch_at_anchor *anchor,
+                       const struct tsch_asn_t *asn, int64_t ofs_us,
+                       uint32_t timeslot_us);
+
+/**
+ * \brief Align the anchor to the absolute time of an EB sent at slot asn.
+ * The EB carries whole seconds, i.e. the sender time at asn lies within
+ * [t, t + 1s). The anchor is only moved when the local estimate leaves that
+ * window, which converges to the sender's second boundary without jumps.
+ * \param anchor The anchor, set if its time is unknown
+ * \param t The absolute time of the EB in s
+ * \param asn The slot the EB was sent at
+ * \param timeslot_us The timeslot length in us
+ * \param max_drift_ms The largest move reported as an adjustment
+ * \param adjust_ms Returns the move of the estimate at asn in ms, may be NULL
+ * \return What has been done to the anchor
+ */
+enum tsch_at_resync_result tsch_at_resync(struct tsch_at_anchor *anchor,
+                                          uint32_t t,
+                                          const struct tsch_asn_t *asn,
+                                          uint32_t timeslot_us,
+                                          uint32_t max_drift_ms,
+                                          int64_t *adjust_ms);
+
+#endif /* __TSCH_ABSOLUTE_TIME_H__ */
+/** @} */
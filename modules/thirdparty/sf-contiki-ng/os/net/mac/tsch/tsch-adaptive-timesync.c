@@ -60,9 +60,14 @@ static uint8_t timesync_entry_count;
 static uint32_t asn_since_last_learning;
 /* The last neighbor used for timesync */
 struct tsch_neighbor *last_timesource_neighbor;
+/* Drift restored from a previous session, applied at reset.
+ * Units used: ppm multiplied by 256. */
+static int32_t initial_drift_ppm;
 
 /* Units in which drift is stored: ppm * 256 */
 #define TSCH_DRIFT_UNIT (1000L * 1000 * 256)
+/* Number of drift measurements averaged */
+#define NUM_TIMESYNC_ENTRIES 8
 
 /*---------------------------------------------------------------------------*/
 long int
@@ -71,11 +76,29 @@ tsch_adaptive_timesync_get_drift_ppm(void)
   return (long int)drift_ppm / 256;
 }
 /*---------------------------------------------------------------------------*/
+int32_t
+tsch_adaptive_timesync_get_drift(void)
+{
+  return drift_ppm;
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_adaptive_timesync_is_converged(void)
+{
+  return last_timesource_neighbor != NULL
+      && timesync_entry_count >= NUM_TIMESYNC_ENTRIES;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_adaptive_timesync_set_initial_drift(int32_t drift)
+{
+  initial_drift_ppm = drift;
+}
+/*---------------------------------------------------------------------------*/
 /* Add a value to a moving average estimator */
 static int32_t
 timesync_entry_add(int32_t val)
 {
-#define NUM_TIMESYNC_ENTRIES 8
   static int32_t buffer[NUM_TIMESYNC_ENTRIES];
   static uint8_t pos;
   int i;
@@ -205,6 +228,10 @@ tsch_adaptive_timesync_reset(void)
   timesync_entry_count = 0;
   compensated_ticks = 0;
   asn_since_last_learning = 0;
+  if(initial_drift_ppm) {
+    /* Start from the restored drift as first averaged measurement */
+    drift_ppm = timesync_entry_add(initial_drift_ppm);
+  }
 }
 /*---------------------------------------------------------------------------*/
 #else /* TSCH_ADAPTIVE_TIMESYNC */
@@ -230,5 +257,22 @@ tsch_adaptive_timesync_get_drift_ppm(void)
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+int32_t
+tsch_adaptive_timesync_get_drift(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_adaptive_timesync_is_converged(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_adaptive_timesync_set_initial_drift(int32_t drift)
+{
+}
+/*---------------------------------------------------------------------------*/
 #endif /* TSCH_ADAPTIVE_TIMESYNC */
 /** @} */
@@ -67,6 +67,26 @@ int32_t tsch_timesync_adaptive_compensate(rtimer_clock_t delta_ticks);
  */
 long int tsch_adaptive_timesync_get_drift_ppm(void);
 
+/**
+ * \brief Gives the estimated clock drift w.r.t. the time source
+ * \return The time drift in PPM multiplied by 256
+ */
+int32_t tsch_adaptive_timesync_get_drift(void);
+
+/**
+ * \brief Tells whether the drift estimate averages a full history of
+ * measurements from the current time source
+ * \return 1 if converged, 0 otherwise
+ */
+int tsch_adaptive_timesync_is_converged(void);
+
+/**
+ * \brief Set the drift used as first estimate after each reset, e.g. restored
+ * from a previous session. 0 starts without estimate.
+ * \param drift The time drift in PPM multiplied by 256
+ */
+void tsch_adaptive_timesync_set_initial_drift(int32_t drift);
+
 /**
  * \brief Reset the status of the module
  */
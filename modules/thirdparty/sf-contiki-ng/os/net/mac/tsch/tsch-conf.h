@@ -90,9 +90,9 @@
 #define TSCH_BEACON_SEND_PERIOD 6
 #endif
 
-/* Maximum allowed drift between beacon absolute time and internal absolute time in seconds.
-   If the drift is higher than this value, the internal absolute time will be
-   overwritten by the beacon absolute time.
+/* Drift between beacon absolute time and the ASN-derived internal absolute time
+   in seconds above which a beacon is reported as a time reset rather than an
+   adjustment. The internal time always follows the beacon second window.
    This is an absolute value and is valid in positive and negative range. */
 #ifdef TSCH_CONF_MAX_AT_DRIFT
 #define TSCH_MAX_AT_DRIFT TSCH_CONF_MAX_AT_DRIFT
@@ -177,6 +177,35 @@
 #define TSCH_HOPPING_SEQUENCE_MAX_LEN sizeof(TSCH_DEFAULT_HOPPING_SEQUENCE)
 #endif
 
+/* Minimum number of channels left in the hopping sequence by a blacklist.
+ * Must not be lower than the number of channel offsets in use, so that
+ * links with different channel offsets stay on different channels. */
+#ifdef TSCH_CONF_HOPPING_MIN_LEN
+#define TSCH_HOPPING_MIN_LEN TSCH_CONF_HOPPING_MIN_LEN
+#else
+#define TSCH_HOPPING_MIN_LEN 4
+#endif
+
+/* The adaptive channel selection of the coordinator rates the channels by
+ * the noise sampled in its idle slots as well */
+#if BUILD_WITH_TSCH_CS
+#ifndef TSCH_STATS_CONF_ON
+#define TSCH_STATS_CONF_ON 1
+#endif
+#ifndef TSCH_STATS_CONF_SAMPLE_NOISE_RSSI
+#define TSCH_STATS_CONF_SAMPLE_NOISE_RSSI 1
+#endif
+/* Statistics over the channels of the sub-GHz band instead of 11 to 26 */
+#ifdef DOT_15_4G_CHAN_MIN
+#ifndef TSCH_STATS_CONF_FIRST_CHANNEL
+#define TSCH_STATS_CONF_FIRST_CHANNEL DOT_15_4G_CHAN_MIN
+#endif
+#ifndef TSCH_STATS_CONF_NUM_CHANNELS
+#define TSCH_STATS_CONF_NUM_CHANNELS (DOT_15_4G_CHAN_MAX - DOT_15_4G_CHAN_MIN + 1)
+#endif
+#endif /* DOT_15_4G_CHAN_MIN */
+#endif /* BUILD_WITH_TSCH_CS */
+
 /******** Configuration: association *******/
 
 /* Start TSCH automatically after init? If not, the upper layers
@@ -249,6 +278,15 @@
 #define TSCH_PACKET_EB_WITH_TIMESLOT_TIMING 0
 #endif
 
+/* TSCH EB: include the timeslot template ID only (short form of the timeslot
+ * timing IE)? Joining nodes map the ID to a local timing table through
+ * TSCH_CALLBACK_GET_TIMESLOT_TIMING. */
+#ifdef TSCH_PACKET_CONF_EB_WITH_TIMESLOT_ID
+#define TSCH_PACKET_EB_WITH_TIMESLOT_ID TSCH_PACKET_CONF_EB_WITH_TIMESLOT_ID
+#else
+#define TSCH_PACKET_EB_WITH_TIMESLOT_ID 0
+#endif
+
 /* TSCH EB: include hopping sequence Information Element? */
 #ifdef TSCH_PACKET_CONF_EB_WITH_HOPPING_SEQUENCE
 #define TSCH_PACKET_EB_WITH_HOPPING_SEQUENCE TSCH_PACKET_CONF_EB_WITH_HOPPING_SEQUENCE
@@ -49,21 +49,188 @@
 #include <stdio.h>
 #include "net/mac/tsch/tsch.h"
 #include "lib/ringbufindex.h"
+#include "lib/contiki-crc16.h"
 #include "sys/log.h"
+#include <string.h>
 
 #if TSCH_LOG_PER_SLOT
 
 PROCESS_NAME(tsch_pending_events_process);
 
+#if TSCH_LOG_BINARY
+/* Check if TSCH_LOG_BINARY_QUEUE_LEN is a power of two */
+#if (TSCH_LOG_BINARY_QUEUE_LEN & (TSCH_LOG_BINARY_QUEUE_LEN - 1)) != 0
+#error TSCH_LOG_BINARY_QUEUE_LEN must be power of two
+#endif
+static struct ringbufindex log_ringbuf;
+static struct tsch_log_record_t log_array[TSCH_LOG_BINARY_QUEUE_LEN];
+/* The log being added, encoded into a record at commit */
+static struct tsch_log_t log_pending;
+static volatile uint8_t log_pending_busy = 0;
+#else /* TSCH_LOG_BINARY */
 /* Check if TSCH_LOG_QUEUE_LEN is a power of two */
 #if (TSCH_LOG_QUEUE_LEN & (TSCH_LOG_QUEUE_LEN - 1)) != 0
 #error TSCH_LOG_QUEUE_LEN must be power of two
 #endif
 static struct ringbufindex log_ringbuf;
 static struct tsch_log_t log_array[TSCH_LOG_QUEUE_LEN];
+#endif /* TSCH_LOG_BINARY */
 static int log_dropped = 0;
 static int log_active = 0;
 
+#if TSCH_LOG_BINARY
+/* SLIP special characters */
+#define SLIP_END     0300
+#define SLIP_ESC     0333
+#define SLIP_ESC_END 0334
+#define SLIP_ESC_ESC 0335
+/*---------------------------------------------------------------------------*/
+/* Write bytes of a SLIP frame, escaping the special characters */
+static void
+log_write_escaped(const uint8_t *data, uint16_t len)
+{
+  while(len-- > 0) {
+    if(*data == SLIP_END) {
+      TSCH_LOG_BINARY_PUTCHAR(SLIP_ESC);
+      TSCH_LOG_BINARY_PUTCHAR(SLIP_ESC_END);
+    } else if(*data == SLIP_ESC) {
+      TSCH_LOG_BINARY_PUTCHAR(SLIP_ESC);
+      TSCH_LOG_BINARY_PUTCHAR(SLIP_ESC_ESC);
+    } else {
+      TSCH_LOG_BINARY_PUTCHAR(*data);
+    }
+    data++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Write a record as a SLIP frame followed by its CRC */
+static void
+log_write_record(const struct tsch_log_record_t *record)
+{
+  uint16_t crc = crc16_data((const unsigned char *)record, sizeof(*record), 0);
+  uint8_t crc_bytes[2] = { crc & 0xff, crc >> 8 };
+
+  TSCH_LOG_BINARY_PUTCHAR(SLIP_END);
+  log_write_escaped((const uint8_t *)record, sizeof(*record));
+  log_write_escaped(crc_bytes, sizeof(crc_bytes));
+  TSCH_LOG_BINARY_PUTCHAR(SLIP_END);
+}
+/*---------------------------------------------------------------------------*/
+/* Encode a log into a record. Called from the slot operation, so only
+ * copies the fields. */
+static void
+log_encode(struct tsch_log_record_t *record, const struct tsch_log_t *log)
+{
+  struct tsch_slotframe *sf;
+
+  memset(record, 0, sizeof(*record));
+  record->asn_ls4b = log->asn.ls4b;
+  record->asn_ms1b = log->asn.ms1b;
+  record->type = log->type;
+  record->burst_count = log->burst_count;
+  record->channel_offset = log->channel_offset;
+  record->channel = log->channel;
+  if(log->link != NULL) {
+    sf = tsch_schedule_get_slotframe_by_handle(log->link->slotframe_handle);
+    record->flags |= TSCH_LOG_RECORD_FLAG_LINK;
+    record->slotframe_handle = log->link->slotframe_handle;
+    record->slotframe_size = sf ? sf->size.val : 0;
+    record->timeslot = log->link->timeslot;
+  }
+
+  switch(log->type) {
+    case tsch_log_tx:
+      record->flags |= linkaddr_cmp(&log->tx.dest, &linkaddr_null) ? 0 : TSCH_LOG_RECORD_FLAG_UNICAST;
+      record->flags |= log->tx.is_data ? TSCH_LOG_RECORD_FLAG_DATA : 0;
+      record->flags |= log->tx.drift_used ? TSCH_LOG_RECORD_FLAG_DRIFT_USED : 0;
+      record->flags |= (log->tx.sec_level & 7) << TSCH_LOG_RECORD_SEC_LEVEL_SHIFT;
+      record->seqno = log->tx.seqno;
+      memcpy(&record->tx.dest, &log->tx.dest, sizeof(linkaddr_t));
+      record->tx.drift = log->tx.drift;
+      record->tx.mac_tx_status = log->tx.mac_tx_status;
+      record->tx.num_tx = log->tx.num_tx;
+      record->tx.datalen = log->tx.datalen;
+      record->tx.radio_prop_err = log->tx.radio_prop_err;
+      record->tx.radio_sched_err = log->tx.radio_sched_err;
+      record->tx.pending_tx_counter = log->tx.pendingTxCounter;
+      record->tx.pending_tx_counter_reset = log->tx.pendingTxCounterReset;
+      break;
+    case tsch_log_rx:
+      record->flags |= log->rx.is_unicast ? TSCH_LOG_RECORD_FLAG_UNICAST : 0;
+      record->flags |= log->rx.is_data ? TSCH_LOG_RECORD_FLAG_DATA : 0;
+      record->flags |= log->rx.drift_used ? TSCH_LOG_RECORD_FLAG_DRIFT_USED : 0;
+      record->flags |= (log->rx.sec_level & 7) << TSCH_LOG_RECORD_SEC_LEVEL_SHIFT;
+      record->seqno = log->rx.seqno;
+      memcpy(&record->rx.src, &log->rx.src, sizeof(linkaddr_t));
+      record->rx.drift = log->rx.drift;
+      record->rx.estimated_drift = log->rx.estimated_drift;
+      record->rx.datalen = log->rx.datalen;
+      record->rx.ack_data = log->rx.ack_data;
+      break;
+    case tsch_log_message:
+      strncpy(record->message, log->message, sizeof(record->message));
+      break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Stream pending log records */
+void
+tsch_log_process_pending(void)
+{
+  static int last_log_dropped = 0;
+  static struct tsch_log_record_t dropped_record;
+  int16_t log_index;
+
+  if(log_dropped != last_log_dropped) {
+    memset(&dropped_record, 0, sizeof(dropped_record));
+    dropped_record.asn_ls4b = tsch_current_asn.ls4b;
+    dropped_record.asn_ms1b = tsch_current_asn.ms1b;
+    dropped_record.type = TSCH_LOG_RECORD_TYPE_DROPPED;
+    dropped_record.dropped.count = log_dropped;
+    log_write_record(&dropped_record);
+    last_log_dropped = log_dropped;
+  }
+  while((log_index = ringbufindex_peek_get(&log_ringbuf)) != -1) {
+    log_write_record(&log_array[log_index]);
+    /* Remove record from ringbuf */
+    ringbufindex_get(&log_ringbuf);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Prepare addition of a new log.
+ * Returns pointer to log structure if success, NULL otherwise */
+struct tsch_log_t *
+tsch_log_prepare_add(void)
+{
+  /* A log is added from the slot operation, or from process context with
+   * the slot operation possibly preempting it. */
+  if(log_pending_busy == 0 && ringbufindex_peek_put(&log_ringbuf) != -1) {
+    log_pending_busy = 1;
+    log_pending.asn = tsch_current_asn;
+    log_pending.link = current_link;
+    log_pending.burst_count = tsch_current_burst_count;
+    log_pending.channel = tsch_current_channel;
+    log_pending.channel_offset = tsch_current_channel_offset;
+    return &log_pending;
+  } else {
+    log_dropped++;
+    return NULL;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Actually add the previously prepared log */
+void
+tsch_log_commit(void)
+{
+  int log_index = ringbufindex_peek_put(&log_ringbuf);
+  if(log_active == 1 && log_index != -1) {
+    log_encode(&log_array[log_index], &log_pending);
+    ringbufindex_put(&log_ringbuf);
+    process_poll(&tsch_pending_events_process);
+  }
+  log_pending_busy = 0;
+}
+#else /* TSCH_LOG_BINARY */
 /*---------------------------------------------------------------------------*/
 /* Process pending log messages */
 void
@@ -156,13 +323,18 @@ tsch_log_commit(void)
     process_poll(&tsch_pending_events_process);
   }
 }
+#endif /* TSCH_LOG_BINARY */
 /*---------------------------------------------------------------------------*/
 /* Initialize log module */
 void
 tsch_log_init(void)
 {
   if(log_active == 0) {
+#if TSCH_LOG_BINARY
+    ringbufindex_init(&log_ringbuf, TSCH_LOG_BINARY_QUEUE_LEN);
+#else /* TSCH_LOG_BINARY */
     ringbufindex_init(&log_ringbuf, TSCH_LOG_QUEUE_LEN);
+#endif /* TSCH_LOG_BINARY */
     log_active = 1;
   }
 }
@@ -62,6 +62,37 @@
 #define TSCH_LOG_QUEUE_LEN 8
 #endif /* TSCH_LOG_CONF_QUEUE_LEN */
 
+/* Binary per-slot logging. The logs are stored as fixed-size records
+ * (struct tsch_log_record_t) and streamed raw in SLIP frames instead of
+ * being formatted with printf. Text printed meanwhile is ASCII, so a host
+ * decoder can tell both apart by the SLIP END byte. */
+#ifdef TSCH_LOG_CONF_BINARY
+#define TSCH_LOG_BINARY TSCH_LOG_CONF_BINARY
+#else /* TSCH_LOG_CONF_BINARY */
+#define TSCH_LOG_BINARY 0
+#endif /* TSCH_LOG_CONF_BINARY */
+
+/* The length of the binary log queue, in records */
+#ifdef TSCH_LOG_CONF_BINARY_QUEUE_LEN
+#define TSCH_LOG_BINARY_QUEUE_LEN TSCH_LOG_CONF_BINARY_QUEUE_LEN
+#else /* TSCH_LOG_CONF_BINARY_QUEUE_LEN */
+#define TSCH_LOG_BINARY_QUEUE_LEN 32
+#endif /* TSCH_LOG_CONF_BINARY_QUEUE_LEN */
+
+/* The number of message characters kept in a binary record */
+#ifdef TSCH_LOG_CONF_BINARY_MESSAGE_LEN
+#define TSCH_LOG_BINARY_MESSAGE_LEN TSCH_LOG_CONF_BINARY_MESSAGE_LEN
+#else /* TSCH_LOG_CONF_BINARY_MESSAGE_LEN */
+#define TSCH_LOG_BINARY_MESSAGE_LEN 16
+#endif /* TSCH_LOG_CONF_BINARY_MESSAGE_LEN */
+
+/* Output of a byte of the binary log */
+#ifdef TSCH_LOG_CONF_BINARY_PUTCHAR
+#define TSCH_LOG_BINARY_PUTCHAR(c) TSCH_LOG_CONF_BINARY_PUTCHAR(c)
+#else /* TSCH_LOG_CONF_BINARY_PUTCHAR */
+#define TSCH_LOG_BINARY_PUTCHAR(c) putchar(c)
+#endif /* TSCH_LOG_CONF_BINARY_PUTCHAR */
+
 #if (TSCH_LOG_PER_SLOT == 0)
 
 #define tsch_log_init()
@@ -115,6 +146,62 @@ struct tsch_log_t {
   };
 };
 
+#if TSCH_LOG_BINARY
+/** \brief Flags of a binary log record */
+#define TSCH_LOG_RECORD_FLAG_LINK        0x01 /* link fields are valid */
+#define TSCH_LOG_RECORD_FLAG_UNICAST     0x02
+#define TSCH_LOG_RECORD_FLAG_DATA        0x04
+#define TSCH_LOG_RECORD_FLAG_DRIFT_USED  0x08
+#define TSCH_LOG_RECORD_SEC_LEVEL_SHIFT  4    /* bits 4..6 */
+/** \brief Type of the record reporting dropped logs */
+#define TSCH_LOG_RECORD_TYPE_DROPPED     0xff
+
+/**
+ * \brief Binary log record, little endian. Streamed as a SLIP frame
+ * (END, escaped record and CRC-16 of the record, END). The content of the
+ * union is given by type, the type of struct tsch_log_t or
+ * TSCH_LOG_RECORD_TYPE_DROPPED. The own address, printed in the text
+ * format, is not part of the records.
+ */
+struct tsch_log_record_t {
+  uint32_t asn_ls4b;
+  uint8_t asn_ms1b;
+  uint8_t type;
+  uint8_t flags;
+  uint8_t seqno;
+  uint8_t slotframe_handle;
+  uint8_t burst_count;
+  uint16_t slotframe_size;
+  uint16_t timeslot;
+  uint8_t channel_offset;
+  uint8_t channel;
+  union {
+    char message[TSCH_LOG_BINARY_MESSAGE_LEN]; /* not terminated if full */
+    struct {
+      linkaddr_t dest;
+      int16_t drift;
+      int8_t mac_tx_status;
+      uint8_t num_tx;
+      uint8_t datalen;
+      int16_t radio_prop_err;
+      int32_t radio_sched_err;
+      uint16_t pending_tx_counter;
+      uint16_t pending_tx_counter_reset;
+    } tx;
+    struct {
+      linkaddr_t src;
+      int16_t drift;
+      int16_t estimated_drift;
+      uint8_t datalen;
+      uint8_t ack_data;
+    } rx;
+    struct {
+      uint16_t count; /* number of logs dropped so far */
+    } dropped;
+  };
+} __attribute__((packed));
+#endif /* TSCH_LOG_BINARY */
+
 /********** Functions *********/
 
 /**
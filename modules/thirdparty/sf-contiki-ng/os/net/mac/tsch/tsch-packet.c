@@ -259,6 +259,9 @@ tsch_packet_create_eb(uint8_t *hdr_len, uint8_t *tsch_sync_ie_offset)
       ies.ie_tsch_timeslot[i] = RTIMERTICKS_TO_US(tsch_timing[i]);
     }
   }
+#elif TSCH_PACKET_EB_WITH_TIMESLOT_ID
+  /* Advertise the timeslot template ID only */
+  ies.ie_tsch_timeslot_id = tsch_timeslot_id;
 #endif /* TSCH_PACKET_EB_WITH_TIMESLOT_TIMING */
 
   /* Add TSCH hopping sequence IE */
@@ -311,7 +314,7 @@ tsch_packet_create_eb(uint8_t *hdr_len, uint8_t *tsch_sync_ie_offset)
   p += ie_len;
   packetbuf_set_datalen(packetbuf_datalen() + ie_len);
 
-#if 0
+#if TSCH_PACKET_EB_WITH_TIMESLOT_TIMING || TSCH_PACKET_EB_WITH_TIMESLOT_ID
   ie_len = frame80215e_create_ie_tsch_timeslot(p,
                                                packetbuf_remaininglen(),
                                                &ies);
@@ -320,7 +323,9 @@ tsch_packet_create_eb(uint8_t *hdr_len, uint8_t *tsch_sync_ie_offset)
   }
   p += ie_len;
   packetbuf_set_datalen(packetbuf_datalen() + ie_len);
+#endif
 
+#if 0
   ie_len = frame80215e_create_ie_tsch_channel_hopping_sequence(p,
                                                                packetbuf_remaininglen(),
                                                                &ies);
@@ -417,6 +422,15 @@ tsch_packet_update_eb(uint8_t *buf, int buf_size, uint8_t tsch_sync_ie_offset)
   ies.ie_absolute_time = tsch_get_internal_absolute_time();
   /* Get current join mode */
   ies.ie_join_mode = tsch_join_mode;
+  /* Get current join congestion level */
+  ies.ie_join_congestion = tsch_join_congestion;
+  /* Get current and pending hopping sequence blacklist */
+  if(!tsch_get_hopping_blacklist(&ies.ie_hopping_blacklist,
+                                 &ies.ie_hopping_next_blacklist,
+                                 &ies.ie_hopping_switch_asn)) {
+    ies.ie_hopping_next_blacklist = 0;
+    TSCH_ASN_INIT(ies.ie_hopping_switch_asn, 0, 0);
+  }
 
   if( frame80215e_create_ie_tsch_synchronization(buf+tsch_sync_ie_offset, buf_size-tsch_sync_ie_offset, &ies) == -1 )
       return 0;
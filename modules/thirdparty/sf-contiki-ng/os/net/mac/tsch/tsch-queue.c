@@ -69,6 +69,8 @@
 
 /* We have as many packets are there are queuebuf in the system */
 MEMB(packet_memb, struct tsch_packet, QUEUEBUF_NUM);
+/* Highest number of allocated packets since the boot */
+static int global_packet_peak;
 NBR_TABLE(struct tsch_neighbor, tsch_neighbors);
 
 /* Broadcast and EB virtual neighbors */
@@ -232,6 +234,7 @@ tsch_queue_add_packet(const linkaddr_t *addr, uint8_t max_transmissions,
   struct tsch_neighbor *n = NULL;
   int16_t put_index = -1;
   struct tsch_packet *p = NULL;
+  uint16_t ttl;
 
 #ifdef TSCH_CALLBACK_PACKET_READY
   /* The scheduler provides a callback which sets the timeslot and other attributes */
@@ -257,9 +260,21 @@ tsch_queue_add_packet(const linkaddr_t *addr, uint8_t max_transmissions,
             p->ret = MAC_TX_DEFERRED;
             p->transmissions = 0;
             p->max_transmissions = max_transmissions;
+            /* Time to live in slots, set by the upper layer */
+            ttl = packetbuf_attr(PACKETBUF_ATTR_MAC_TTL);
+            if(ttl != 0) {
+              p->expiry_asn = tsch_current_asn;
+              TSCH_ASN_INC(p->expiry_asn, ttl);
+            } else {
+              p->expiry_asn.ls4b = 0;
+              p->expiry_asn.ms1b = 0;
+            }
             /* Add to ringbuf (actual add committed through atomic operation) */
             n->tx_array[put_index] = p;
             ringbufindex_put(&n->tx_ringbuf);
+            if(tsch_queue_global_packet_count() > global_packet_peak) {
+              global_packet_peak = tsch_queue_global_packet_count();
+            }
             LOG_DBG("packet is added put_index %u, packet %p\n",
                    put_index, p);
             return p;
@@ -281,6 +296,13 @@ tsch_queue_global_packet_count(void)
   return QUEUEBUF_NUM - memb_numfree(&packet_memb);
 }
 /*---------------------------------------------------------------------------*/
+/* Returns the highest number of packets in all TSCH queues since the boot */
+int
+tsch_queue_global_packet_peak(void)
+{
+  return global_packet_peak;
+}
+/*---------------------------------------------------------------------------*/
 /* Returns the number of packets currently in the queue */
 int
 tsch_queue_nbr_packet_count(const struct tsch_neighbor *n)
@@ -319,6 +341,14 @@ tsch_queue_free_packet(struct tsch_packet *p)
   }
 }
 /*---------------------------------------------------------------------------*/
+/* Has the time to live of a packet elapsed? */
+int
+tsch_queue_packet_is_expired(const struct tsch_packet *p)
+{
+  return (p->expiry_asn.ls4b != 0 || p->expiry_asn.ms1b != 0)
+         && (int32_t)TSCH_ASN_DIFF(tsch_current_asn, p->expiry_asn) > 0;
+}
+/*---------------------------------------------------------------------------*/
 /* Updates neighbor queue state after a transmission */
 int
 tsch_queue_packet_sent(struct tsch_neighbor *n, struct tsch_packet *p,
@@ -345,7 +375,8 @@ tsch_queue_packet_sent(struct tsch_neighbor *n, struct tsch_packet *p,
     }
   } else {
     /* Failed transmission */
-    if(p->transmissions >= p->max_transmissions) {
+    if(p->transmissions >= p->max_transmissions
+       || tsch_queue_packet_is_expired(p)) {
       /* Drop packet */
 #ifndef RF_TEST_APP_PACKET_REMOVE_DISABLE
       tsch_queue_remove_packet_from_queue(n);
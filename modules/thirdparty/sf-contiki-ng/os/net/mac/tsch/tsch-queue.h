@@ -96,6 +96,12 @@ struct tsch_packet *tsch_queue_add_packet(const linkaddr_t *addr, uint8_t max_tr
  * \return The number of packets currently in all TSCH queues
  */
 int tsch_queue_global_packet_count(void);
+/**
+ * \brief Returns the highest number of packets in all TSCH queues since the
+ * boot, updated whenever a packet is added
+ * \return The highest number of packets in all TSCH queues
+ */
+int tsch_queue_global_packet_peak(void);
 /**
  * \brief Returns the number of packets currently a given neighbor queue (by pointer)
  * \param n The neighbor we are interested in
@@ -114,6 +120,12 @@ struct tsch_packet *tsch_queue_remove_packet_from_queue(struct tsch_neighbor *n)
  * \param p The packet to be freed
  */
 void tsch_queue_free_packet(struct tsch_packet *p);
+/**
+ * \brief Has the time to live of a packet elapsed?
+ * \param p The packet
+ * \return 1 if the packet must not be sent anymore, 0 otherwise
+ */
+int tsch_queue_packet_is_expired(const struct tsch_packet *p);
 /**
  * \brief Updates neighbor queue state after a transmission
  * \param n The neighbor queue we just sent from
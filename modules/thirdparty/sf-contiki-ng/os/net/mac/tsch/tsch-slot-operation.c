@@ -54,6 +54,9 @@
 #include "net/mac/tsch/tsch.h"
 #include "sys/critical.h"
 #include "dev/gpio-hal.h"
+#if BUILD_WITH_TSCH_CS
+#include "services/tsch-cs/tsch-cs.h"
+#endif /* BUILD_WITH_TSCH_CS */
 
 #include "sys/log.h"
 /* TSCH debug macros, i.e. to set LEDs or GPIOs on various TSCH
@@ -141,6 +144,12 @@
 #define TSCH_DEBUG_CUSTOM_END()
 #endif
 
+/* Called whenever a wakeup of the slot operation is scheduled, with the
+ * target time and the current time */
+#ifndef TSCH_DEBUG_SCHEDULE
+#define TSCH_DEBUG_SCHEDULE(target, now)
+#endif
+
 
 /* Check if TSCH_MAX_INCOMING_PACKETS is power of two */
 #if (TSCH_MAX_INCOMING_PACKETS & (TSCH_MAX_INCOMING_PACKETS - 1)) != 0
@@ -449,7 +458,12 @@ tsch_schedule_slot_operation(struct rtimer *tm, rtimer_clock_t ref_time, rtimer_
    * because we can not schedule rtimer less than RTIMER_GUARD in the future */
   int missed = check_timer_miss(ref_time, offset - RTIMER_GUARD, now);
 
+  TSCH_DEBUG_SCHEDULE(ref_time + offset, now);
+
   if(missed) {
+#ifdef TSCH_CALLBACK_DEADLINE_MISS
+    TSCH_CALLBACK_DEADLINE_MISS(str);
+#endif
     TSCH_LOG_ADD(tsch_log_message,
                 snprintf(log->message, sizeof(log->message),
                     "!dl-miss %s %d %d",
@@ -644,6 +658,8 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
   static uint8_t mac_tx_status;
   /* ack app data */
   static uint8_t ack_app_data = 0;
+  /* RSSI of the received ACK */
+  static radio_value_t ack_rssi;
   /* is the packet in its neighbor's queue? */
   uint8_t in_queue;
   static int dequeued_index;
@@ -657,9 +673,13 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
   /* First check if we have space to store a newly dequeued packet (in case of
    * successful Tx or Drop) */
   dequeued_index = ringbufindex_peek_put(&dequeued_ringbuf);
+  ack_rssi = 0;
   if(dequeued_index != -1) {
     if(current_packet == NULL || current_packet->qb == NULL) {
       mac_tx_status = MAC_TX_ERR_FATAL;
+    } else if(tsch_queue_packet_is_expired(current_packet)) {
+      /* Stale packet, drop it without sending */
+      mac_tx_status = MAC_TX_ERR;
     } else {
       /* packet payload */
       static void *packet;
@@ -851,6 +871,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
               }
 
               if(ack_len != 0) {
+                NETSTACK_RADIO.get_value(RADIO_PARAM_LAST_RSSI, &ack_rssi);
                 if(is_time_source) {
 #if TSCH_PACKET_EACK_WITH_ACK_NACK_TCORR
                   int32_t eack_time_correction = US_TO_RTIMERTICKS(ack_ies.ie_time_correction);
@@ -890,6 +911,9 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
                 }
               } else {
                 mac_tx_status = MAC_TX_NOACK;
+#ifdef TSCH_CALLBACK_ACK_TIMEOUT
+                TSCH_CALLBACK_ACK_TIMEOUT();
+#endif
                 TSCH_DEBUG_CUSTOM_START();
                 TSCH_DEBUG_CUSTOM_END();
               }
@@ -925,6 +949,21 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
       tsch_stats_tx_packet(current_neighbor, mac_tx_status, tsch_current_channel);
     }
 
+#if BUILD_WITH_TSCH_CS
+    /* Account the attempt for the channel selection */
+    if(current_neighbor != NULL && !current_neighbor->is_broadcast) {
+      tsch_cs_tx_packet(tsch_current_channel, mac_tx_status);
+    }
+#endif /* BUILD_WITH_TSCH_CS */
+
+#ifdef TSCH_CALLBACK_LINK_TX
+    /* Report the outcome of every unicast attempt */
+    if(current_neighbor != NULL && !current_neighbor->is_broadcast) {
+      TSCH_CALLBACK_LINK_TX(tsch_queue_get_nbr_address(current_neighbor),
+                            mac_tx_status, tsch_current_channel, ack_rssi);
+    }
+#endif
+
     /* Log every tx attempt */
     TSCH_LOG_ADD(tsch_log_tx,
         log->tx.mac_tx_status = mac_tx_status;
@@ -982,6 +1021,9 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
   input_index = ringbufindex_peek_put(&input_ringbuf);
   if(input_index == -1) {
     input_queue_drop++;
+#ifdef TSCH_CALLBACK_INPUT_QUEUE_DROP
+    TSCH_CALLBACK_INPUT_QUEUE_DROP();
+#endif
   } else {
     static struct input_packet *current_input;
     /* Estimated drift based on RX time */
@@ -1006,6 +1048,9 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 
     /* Start radio for at least guard time */
     tsch_radio_on(TSCH_RADIO_CMD_ON_WITHIN_TIMESLOT);
+#ifdef TSCH_CALLBACK_RX_LISTEN_START
+    TSCH_CALLBACK_RX_LISTEN_START(current_link->link_type);
+#endif
     packet_seen = NETSTACK_RADIO.receiving_packet() || NETSTACK_RADIO.pending_packet();
     if(!packet_seen) {
       /* Check if receiving within guard time */
@@ -1020,6 +1065,9 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 
       /* no packets on air */
       tsch_radio_off(TSCH_RADIO_CMD_OFF_FORCE);
+#ifdef TSCH_CALLBACK_RX_LISTEN_END
+      TSCH_CALLBACK_RX_LISTEN_END();
+#endif
       TSCH_DEBUG_RX_SLOT_RX_END();
     } else {
       TSCH_DEBUG_RX_EVENT();
@@ -1032,6 +1080,9 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
       TSCH_DEBUG_RX_EVENT();
       TSCH_DEBUG_RX_SLOT_RX_END();
       tsch_radio_off(TSCH_RADIO_CMD_OFF_WITHIN_TIMESLOT);
+#ifdef TSCH_CALLBACK_RX_LISTEN_END
+      TSCH_CALLBACK_RX_LISTEN_END();
+#endif
 
       if(NETSTACK_RADIO.pending_packet()) {
         static int frame_valid;
@@ -1201,6 +1252,10 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
               tsch_stats_rx_packet(n, current_input->rssi, radio_last_lqi, tsch_current_channel);
             }
 
+#ifdef TSCH_CALLBACK_LINK_RX
+            TSCH_CALLBACK_LINK_RX(&source_address, current_input->rssi, tsch_current_channel);
+#endif
+
             /* Log every reception */
             TSCH_LOG_ADD(tsch_log_rx,
               linkaddr_copy(&log->rx.src, (linkaddr_t *)&frame.src_addr);
@@ -1266,7 +1321,7 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
       {
         /* Inform the application about start of new cycle */
         #ifdef TSCH_CALLBACK_CYCLE_START
-        TSCH_CALLBACK_CYCLE_START();
+        TSCH_CALLBACK_CYCLE_START(&tsch_current_asn, current_slot_start);
         #endif
       }
     }
@@ -1276,6 +1331,10 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
 
     if(current_link == NULL || tsch_lock_requested) { /* Skip slot operation if there is no link
                                                           or if there is a pending request for getting the lock */
+#ifdef TSCH_CALLBACK_SLOT_SKIPPED
+      TSCH_CALLBACK_SLOT_SKIPPED(tsch_locked, tsch_lock_requested,
+                                 current_link == NULL);
+#endif
       /* Issue a log whenever skipping a slot */
 #if !CONTIKI_TARGET_COOJA
       TSCH_LOG_ADD(tsch_log_message,
@@ -1313,6 +1372,8 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
       TSCH_DEBUG_SLOT_START();
       TSCH_DEBUG_SLOT_SLOT_START();
       tsch_in_slot_operation = 1;
+      /* Switch the hopping sequence in the announced slot */
+      tsch_hopping_switch_check();
       /* Measure on-air noise level while TSCH is idle */
       tsch_stats_sample_rssi();
       /* Reset drift correction */
@@ -1339,6 +1400,13 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
         current_packet = get_packet_and_neighbor_for_link(current_link, &current_neighbor);
       }
       is_active_slot = current_packet != NULL || (current_link->link_options & LINK_OPTION_RX);
+#ifdef TSCH_CALLBACK_SKIP_BEACON_RX
+      /* Let the application skip listening to a beacon while in sync */
+      if(current_packet == NULL && current_link->link_type == LINK_TYPE_ADVERTISING_ONLY
+          && TSCH_CALLBACK_SKIP_BEACON_RX(clock_time() - tsch_last_sync_time)) {
+        is_active_slot = 0;
+      }
+#endif
       if(is_active_slot) {
         /* If we are in a burst, we stick to current channel instead of
          * doing channel hopping, as per IEEE 802.15.4-2015 */
@@ -1554,6 +1622,19 @@ tsch_slot_operation_sync(rtimer_clock_t next_slot_start,
   current_link = NULL;
 }
 /*---------------------------------------------------------------------------*/
+/* Get the ASN and start time of the current (or next scheduled) slot */
+void
+tsch_slot_operation_get_current_slot(struct tsch_asn_t *asn,
+    rtimer_clock_t *slot_start)
+{
+  /* Both are updated from the rtimer interrupt: read until consistent */
+  do {
+    *asn = *(volatile struct tsch_asn_t *)&tsch_current_asn;
+    *slot_start = current_slot_start;
+  } while(asn->ls4b != ((volatile struct tsch_asn_t *)&tsch_current_asn)->ls4b
+          || *slot_start != current_slot_start);
+}
+/*---------------------------------------------------------------------------*/
 /* Get RTimer timestamp of last sent EB */
 uint32_t
 tsch_get_last_eb_timestamp(void)
@@ -101,6 +101,16 @@ void tsch_slot_operation_start(void);
  */
 void tsch_slot_operation_stop(void);
 
+/**
+ * \brief Return a consistent snapshot of the ASN and start time of the current
+ * slot. Outside of a slot, this is the next scheduled slot, whose start time
+ * may lie in the future.
+ * \param asn Filled with the slot ASN
+ * \param slot_start Filled with the slot start time, in rtimer ticks
+ */
+void tsch_slot_operation_get_current_slot(struct tsch_asn_t *asn,
+    rtimer_clock_t *slot_start);
+
 /**
  * \brief Return the RTimer timestamp of the last sent EB
  * \return The attribute value
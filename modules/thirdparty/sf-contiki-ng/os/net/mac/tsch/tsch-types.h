@@ -104,6 +104,7 @@ struct tsch_packet {
   uint8_t header_len; /* length of header and header IEs (needed for link-layer security) */
   uint8_t tsch_sync_ie_offset; /* Offset within the frame used for quick update of EB ASN and join priority */
   uint8_t ack_app_data; /* application data delivered via Ack */
+  struct tsch_asn_t expiry_asn; /* ASN after which the packet is not sent anymore, 0 for none */
 };
 
 /** \brief TSCH neighbor information */
@@ -57,6 +57,7 @@
 #include "net/mac/tsch/tsch.h"
 #include "net/mac/mac-sequence.h"
 #include "lib/random.h"
+#include "sys/critical.h"
 #if ROUTING_CONF_ENABLE
 #include "net/routing/routing.h"
 #endif /* ROUTING_CONF_ENABLE */
@@ -76,6 +77,13 @@
 
 #define FLAG_FW_UPDATE_START  3
 
+/* MIC added to a data frame after it has been enqueued */
+#if LLSEC802154_ENABLED && (TSCH_SECURITY_KEY_SEC_LEVEL_OTHER & 3)
+#define TSCH_SEND_MIC_LEN (2 << (TSCH_SECURITY_KEY_SEC_LEVEL_OTHER & 3))
+#else
+#define TSCH_SEND_MIC_LEN 0
+#endif
+
 /* The address of the last node we received an EB from (other than our time source).
  * Used for recovery */
 static linkaddr_t last_eb_nbr_addr;
@@ -104,8 +112,24 @@ struct tsch_asn_divisor_t tsch_hopping_sequence_adv_length;
 const uint8_t *default_tsch_hopping_sequence_adv = TSCH_JOIN_HOPPING_SEQUENCE;
 uint16_t default_tsch_hopping_sequence_adv_length = sizeof(TSCH_JOIN_HOPPING_SEQUENCE);
 
+/* Blacklisted entries of the default hopping sequence, one bit per entry.
+ * Changed by the slot operation only, the process context requests a
+ * change with the interrupts disabled. */
+uint16_t tsch_hopping_blacklist;
+/* Blacklist to be applied at the start of the next active slot */
+static uint16_t hopping_now_blacklist;
+static uint8_t hopping_now_pending;
+/* Blacklist to be applied at hopping_switch_asn */
+static uint16_t hopping_next_blacklist;
+static struct tsch_asn_t hopping_switch_asn;
+static uint8_t hopping_switch_pending;
+
 /* Default TSCH timeslot timing (in micro-second) */
-static const uint16_t *tsch_default_timing_us;
+static const uint16_t *tsch_default_timing_us = TSCH_DEFAULT_TIMESLOT_TIMING;
+/* Timeslot template ID of the default timing */
+static uint8_t tsch_default_timeslot_id = 0;
+/* Timeslot template ID in use */
+uint8_t tsch_timeslot_id;
 /* TSCH timeslot timing (in micro-second) */
 uint16_t tsch_timing_us[tsch_ts_elements_count];
 /* TSCH timeslot timing (in rtimer ticks) */
@@ -155,9 +179,15 @@ static bool tsch_is_fw_update_pending = false;
 
 /* absolute time */
 uint32_t tsch_beacon_absolute_time;
-uint32_t tsch_internal_absolute_time;
+/* Network time anchor: absolute time in ms (0: unknown) at the start of the
+ * slot tsch_at_anchor.asn, or at tsch_at_anchor_clock when not on ASN */
+static struct tsch_at_anchor tsch_at_anchor;
+static clock_time_t tsch_at_anchor_clock;
+static uint8_t tsch_at_anchor_on_asn;
 /* join mode */
 uint8_t tsch_join_mode;
+/* join congestion level, set by the coordinator or received in EBs */
+uint8_t tsch_join_congestion;
 /* Beacon scan address for fixed beacon scan. */
 linkaddr_t beaconScan_addr;
 
@@ -189,6 +219,105 @@ PROCESS(tsch_pending_events_process, "pending events process");
 /* Other function prototypes */
 static void packet_input(void);
 
+/* Network time */
+
+/*---------------------------------------------------------------------------*/
+/* Current network time in ms, 0 if unknown */
+static uint64_t
+at_now_ms(void)
+{
+  struct tsch_asn_t asn;
+  rtimer_clock_t slot_start;
+  int32_t slot_ofs;
+  int64_t ofs_us;
+
+  if(tsch_at_anchor.ms == 0) {
+    return 0;
+  }
+
+  if(!tsch_at_anchor_on_asn) {
+    return tsch_at_anchor.ms
+           + (uint64_t)(clock_time() - tsch_at_anchor_clock) * 1000 / CLOCK_SECOND;
+  }
+
+  /* Anchor time + elapsed slots + offset within the current slot. The slot
+   * start may lie ahead of now while waiting for the next active slot. */
+  tsch_slot_operation_get_current_slot(&asn, &slot_start);
+  slot_ofs = (int32_t)RTIMER_CLOCK_DIFF(RTIMER_NOW(), slot_start);
+  if(slot_ofs >= 0) {
+    ofs_us = RTIMERTICKS_TO_US_64(slot_ofs);
+  } else {
+    ofs_us = -(int64_t)RTIMERTICKS_TO_US_64(-slot_ofs);
+  }
+
+  return tsch_at_to_ms(&tsch_at_anchor, &asn, ofs_us,
+                       tsch_timing_us[tsch_ts_timeslot_length]);
+}
+/*---------------------------------------------------------------------------*/
+/* Anchor the network time to the start of the given slot */
+static void
+at_set_anchor_asn(uint64_t ms, const struct tsch_asn_t *asn)
+{
+  tsch_at_anchor.asn = *asn;
+  tsch_at_anchor.ms = ms;
+  tsch_at_anchor_on_asn = 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Anchor the network time to the current slot */
+static void
+at_set_anchor_now(uint64_t ms)
+{
+  struct tsch_asn_t asn;
+  rtimer_clock_t slot_start;
+  int32_t slot_ofs;
+
+  if(ms == 0 || !tsch_is_associated) {
+    tsch_at_anchor.ms = ms;
+    tsch_at_anchor_clock = clock_time();
+    tsch_at_anchor_on_asn = 0;
+    return;
+  }
+
+  /* Refer the time back to the start of the current slot */
+  tsch_slot_operation_get_current_slot(&asn, &slot_start);
+  slot_ofs = (int32_t)RTIMER_CLOCK_DIFF(RTIMER_NOW(), slot_start);
+  if(slot_ofs >= 0) {
+    ms -= RTIMERTICKS_TO_US_64(slot_ofs) / 1000;
+  } else {
+    ms += RTIMERTICKS_TO_US_64(-slot_ofs) / 1000;
+  }
+  at_set_anchor_asn(ms, &asn);
+}
+/*---------------------------------------------------------------------------*/
+/* Align the network time to the absolute time of an EB sent at slot asn */
+static void
+at_resync(uint32_t t, const struct tsch_asn_t *asn)
+{
+  int64_t adjust_ms;
+
+  if(!tsch_at_anchor_on_asn) {
+    /* The time kept on the system clock is replaced by the beacon one */
+    tsch_at_anchor.ms = 0;
+  }
+  tsch_at_anchor_on_asn = 1;
+
+  switch(tsch_at_resync(&tsch_at_anchor, t, asn,
+                        tsch_timing_us[tsch_ts_timeslot_length],
+                        (uint32_t)TSCH_MAX_AT_DRIFT * 1000, &adjust_ms)) {
+  case TSCH_AT_SET:
+    LOG_INFO("Network time set to %lu s\n", (unsigned long)t);
+    break;
+  case TSCH_AT_RESET:
+    LOG_WARN("Network time reset to beacon value %lu s\n", (unsigned long)t);
+    break;
+  case TSCH_AT_ADJUSTED:
+    LOG_DBG("Network time adjusted by %ld ms\n", (long)adjust_ms);
+    break;
+  default:
+    break;
+  }
+}
+
 /* Getters and setters */
 
 /*---------------------------------------------------------------------------*/
@@ -217,13 +346,19 @@ tsch_set_join_priority(uint8_t jp)
 void
 tsch_set_internal_absolute_time(uint32_t t)
 {
-  tsch_internal_absolute_time = t;
+  at_set_anchor_now((uint64_t)t * 1000);
 }
 /*---------------------------------------------------------------------------*/
 uint32_t
 tsch_get_internal_absolute_time(void)
 {
-  return tsch_internal_absolute_time;
+  return (uint32_t)(at_now_ms() / 1000);
+}
+/*---------------------------------------------------------------------------*/
+uint64_t
+tsch_get_absolute_time_ms(void)
+{
+  return at_now_ms();
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -263,12 +398,41 @@ tsch_get_join_mode(void)
 }
 /*---------------------------------------------------------------------------*/
 void
+tsch_set_join_congestion(uint8_t level)
+{
+  tsch_join_congestion = level;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+tsch_get_join_congestion(void)
+{
+  return tsch_join_congestion;
+}
+/*---------------------------------------------------------------------------*/
+void
 tsch_set_ka_timeout(uint32_t timeout)
 {
   tsch_current_ka_timeout = timeout;
   tsch_schedule_keepalive(0);
 }
 /*---------------------------------------------------------------------------*/
+int
+tsch_set_timeslot_timing(uint8_t timeslot_id, const uint16_t *timing_us)
+{
+  int i;
+  if(tsch_is_associated || timing_us == NULL) {
+    return 0;
+  }
+  tsch_default_timing_us = timing_us;
+  tsch_default_timeslot_id = timeslot_id;
+  tsch_timeslot_id = timeslot_id;
+  for(i = 0; i < tsch_ts_elements_count; i++) {
+    tsch_timing_us[i] = tsch_default_timing_us[i];
+    tsch_timing[i] = US_TO_RTIMERTICKS(tsch_timing_us[i]);
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
 void
 tsch_set_eb_period(uint32_t period)
 {
@@ -292,6 +456,154 @@ void tsch_set_hopping_sequence_adv(const uint8_t hoppingSequenceAdv[], uint16_t
     default_tsch_hopping_sequence_adv_length = length;
 }
 /*---------------------------------------------------------------------------*/
+/* Number of channels left by a blacklist, 0 if it is not applicable */
+static uint16_t
+hopping_blacklist_len(uint16_t blacklist)
+{
+  uint16_t i;
+  uint16_t len = 0;
+
+  if(default_tsch_hopping_sequence_length > 16) {
+    return blacklist == 0 ? default_tsch_hopping_sequence_length : 0;
+  }
+  for(i = 0; i < default_tsch_hopping_sequence_length; i++) {
+    if(!(blacklist & (1u << i))) {
+      len++;
+    }
+  }
+  return len >= TSCH_HOPPING_MIN_LEN ? len : 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Build the hopping sequence from the default one without the blacklisted
+ * entries. The order of the remaining entries is kept, so every node derives
+ * the same sequence from the blacklist. Called from the slot operation
+ * before the channel of the slot is calculated, or before it is started. */
+static void
+hopping_blacklist_apply(uint16_t blacklist)
+{
+  uint16_t i;
+  uint16_t len = 0;
+
+  for(i = 0; i < default_tsch_hopping_sequence_length; i++) {
+    if(i >= 16 || !(blacklist & (1u << i))) {
+      tsch_hopping_sequence[len++] = default_tsch_hopping_sequence[i];
+    }
+  }
+  TSCH_ASN_DIVISOR_INIT(tsch_hopping_sequence_length, len);
+  tsch_hopping_blacklist = blacklist;
+}
+/*---------------------------------------------------------------------------*/
+/* Use the default hopping sequence without a blacklist. TSCH is not running */
+static void
+hopping_blacklist_reset(void)
+{
+  hopping_now_pending = 0;
+  hopping_switch_pending = 0;
+  hopping_blacklist_apply(0);
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_set_hopping_blacklist(uint16_t blacklist)
+{
+  int_master_status_t status;
+
+  if(hopping_blacklist_len(blacklist) == 0) {
+    return -1;
+  }
+  status = critical_enter();
+  hopping_switch_pending = 0;
+  hopping_now_blacklist = blacklist;
+  hopping_now_pending = 1;
+  critical_exit(status);
+  LOG_INFO("hopping blacklist %04x -> %04x\n", tsch_hopping_blacklist, blacklist);
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_schedule_hopping_blacklist(uint16_t blacklist, const struct tsch_asn_t *asn)
+{
+  int_master_status_t status;
+
+  if(hopping_blacklist_len(blacklist) == 0) {
+    return -1;
+  }
+  status = critical_enter();
+  hopping_next_blacklist = blacklist;
+  hopping_switch_asn = *asn;
+  hopping_switch_pending = 1;
+  critical_exit(status);
+  LOG_INFO("hopping blacklist %04x at asn-%x.%lx\n",
+           blacklist, asn->ms1b, asn->ls4b);
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_get_hopping_blacklist(uint16_t *blacklist, uint16_t *next_blacklist,
+                           struct tsch_asn_t *asn)
+{
+  int_master_status_t status;
+  int pending;
+
+  status = critical_enter();
+  *blacklist = hopping_now_pending ? hopping_now_blacklist : tsch_hopping_blacklist;
+  pending = hopping_switch_pending;
+  if(pending) {
+    *next_blacklist = hopping_next_blacklist;
+    *asn = hopping_switch_asn;
+  }
+  critical_exit(status);
+  return pending;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_hopping_switch_check(void)
+{
+  if(hopping_now_pending) {
+    hopping_blacklist_apply(hopping_now_blacklist);
+    hopping_now_pending = 0;
+  }
+  if(hopping_switch_pending
+     && (int32_t)TSCH_ASN_DIFF(tsch_current_asn, hopping_switch_asn) >= 0) {
+    hopping_blacklist_apply(hopping_next_blacklist);
+    hopping_switch_pending = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Follow the hopping sequence blacklist advertised by the time source */
+static void
+hopping_blacklist_from_eb(const struct ieee802154_ies *ies, const struct tsch_asn_t *rx_asn)
+{
+  uint16_t blacklist = ies->ie_hopping_blacklist;
+  uint16_t current;
+  uint16_t next;
+  struct tsch_asn_t asn;
+  int pending = tsch_get_hopping_blacklist(&current, &next, &asn);
+
+  if((ies->ie_hopping_switch_asn.ls4b != 0 || ies->ie_hopping_switch_asn.ms1b != 0)
+     && (int32_t)TSCH_ASN_DIFF(ies->ie_hopping_switch_asn, *rx_asn) > 0) {
+    if((int32_t)TSCH_ASN_DIFF(ies->ie_hopping_switch_asn, tsch_current_asn) > 0) {
+      /* Switch announced and still ahead */
+      if(!pending
+         || next != ies->ie_hopping_next_blacklist
+         || TSCH_ASN_DIFF(asn, ies->ie_hopping_switch_asn) != 0) {
+        if(blacklist != current) {
+          tsch_set_hopping_blacklist(blacklist);
+        }
+        tsch_schedule_hopping_blacklist(ies->ie_hopping_next_blacklist,
+                                        &ies->ie_hopping_switch_asn);
+      }
+      return;
+    }
+    /* The EB is processed after the announced switch */
+    blacklist = ies->ie_hopping_next_blacklist;
+  }
+
+  /* Catch up if a switch was missed or cancelled */
+  if(blacklist != current || pending) {
+    tsch_set_hopping_blacklist(blacklist);
+  }
+}
+/*---------------------------------------------------------------------------*/
 void
 tsch_scan_enable(void)
 {
@@ -318,7 +630,7 @@ tsch_set_static_beacon_channel(uint8_t channel)
     tsch_static_beacon_channel_flag = true;
 }
 /*---------------------------------------------------------------------------*/
-static bool
+bool
 tsch_static_beacon_channel_available(void)
 {
     return tsch_static_beacon_channel_flag;
@@ -338,10 +650,14 @@ tsch_reset(void)
   tsch_queue_update_time_source(NULL);
   /* Initialize global variables */
   tsch_join_priority = 0xff;
+  /* Keep the network time running on the system clock while the ASN is reset */
+  if(tsch_at_anchor_on_asn) {
+    at_set_anchor_now(at_now_ms());
+  }
   TSCH_ASN_INIT(tsch_current_asn, 0, 0);
   current_link = NULL;
   /* Reset timeslot timing to defaults */
-  tsch_default_timing_us = TSCH_DEFAULT_TIMESLOT_TIMING;
+  tsch_timeslot_id = tsch_default_timeslot_id;
   for(i = 0; i < tsch_ts_elements_count; i++) {
     tsch_timing_us[i] = tsch_default_timing_us[i];
     tsch_timing[i] = US_TO_RTIMERTICKS(tsch_timing_us[i]);
@@ -544,15 +860,8 @@ eb_input(struct input_packet *current_input)
       LOG_INFO("Received beacon absolute time: %lu\n", eb_ies.ie_absolute_time);
       if(eb_ies.ie_absolute_time)
       {
-        LOG_INFO("Absolute time drift betwenn beacon AT and internal AT in seconds: %ld\n", eb_ies.ie_absolute_time - tsch_get_internal_absolute_time());
-
         tsch_set_beacon_absolute_time(eb_ies.ie_absolute_time);
-        int32_t absoluteTimeDrift = tsch_get_beacon_absolute_time() - tsch_get_internal_absolute_time();
-        if(absoluteTimeDrift >= TSCH_MAX_AT_DRIFT || absoluteTimeDrift <= -TSCH_MAX_AT_DRIFT)
-        {
-          LOG_INFO("Timestamp reset to beacon value %ld\n", tsch_get_beacon_absolute_time());
-          tsch_set_internal_absolute_time(tsch_get_beacon_absolute_time());
-        }
+        at_resync(eb_ies.ie_absolute_time, &current_input->rx_asn);
       }
     }
 
@@ -562,6 +871,7 @@ eb_input(struct input_packet *current_input)
       {
         tsch_is_fw_update_pending = true;
       }
+      tsch_join_congestion = eb_ies.ie_join_congestion;
     }
 
 #if TSCH_AUTOSELECT_TIME_SOURCE
@@ -623,6 +933,9 @@ eb_input(struct input_packet *current_input)
 #endif /* TSCH_AUTOSELECT_TIME_SOURCE */
       }
 
+      /* Hop over the channels blacklisted by the time source */
+      hopping_blacklist_from_eb(&eb_ies, &current_input->rx_asn);
+
       /* TSCH hopping sequence */
       if(eb_ies.ie_channel_hopping_sequence_id != 0) {
         if(eb_ies.ie_hopping_sequence_len != tsch_hopping_sequence_length.val
@@ -713,8 +1026,7 @@ tsch_start_coordinator(void)
 #endif
 
   /* Initialize hopping sequence as default */
-  memcpy(tsch_hopping_sequence, default_tsch_hopping_sequence, default_tsch_hopping_sequence_length);
-  TSCH_ASN_DIVISOR_INIT(tsch_hopping_sequence_length, default_tsch_hopping_sequence_length);
+  hopping_blacklist_reset();
   memcpy(tsch_hopping_sequence_adv, default_tsch_hopping_sequence_adv, default_tsch_hopping_sequence_adv_length);
   TSCH_ASN_DIVISOR_INIT(tsch_hopping_sequence_adv_length, default_tsch_hopping_sequence_adv_length);
 #if TSCH_SCHEDULE_WITH_6TISCH_MINIMAL
@@ -805,22 +1117,40 @@ tsch_associate(const struct input_packet *input_eb, rtimer_clock_t timestamp)
   }
 
   /* TSCH timeslot timing */
-  for(i = 0; i < tsch_ts_elements_count; i++) {
-    if(ies.ie_tsch_timeslot_id == 0) {
-      tsch_timing_us[i] = tsch_default_timing_us[i];
+  const uint16_t *timing_us = tsch_default_timing_us;
+  if(ies.ie_tsch_timeslot_id != 0) {
+    if(ies.ie_tsch_timeslot[tsch_ts_timeslot_length] != 0) {
+      /* Full timeslot timing IE */
+      timing_us = ies.ie_tsch_timeslot;
     } else {
-      tsch_timing_us[i] = ies.ie_tsch_timeslot[i];
+      /* Timeslot template ID only, look up the local timing */
+#ifdef TSCH_CALLBACK_GET_TIMESLOT_TIMING
+      timing_us = TSCH_CALLBACK_GET_TIMESLOT_TIMING(ies.ie_tsch_timeslot_id);
+#else
+      timing_us = NULL;
+#endif
+      if(timing_us == NULL) {
+        LOG_ERR("! parse_eb: unknown timeslot id %u\n", ies.ie_tsch_timeslot_id);
+        return 0;
+      }
     }
+  }
+  for(i = 0; i < tsch_ts_elements_count; i++) {
+    tsch_timing_us[i] = timing_us[i];
     tsch_timing[i] = US_TO_RTIMERTICKS(tsch_timing_us[i]);
   }
+  tsch_timeslot_id = ies.ie_tsch_timeslot_id;
 
   /* TSCH hopping sequence */
   if(ies.ie_channel_hopping_sequence_id == 0) {
-    memcpy(tsch_hopping_sequence, default_tsch_hopping_sequence, default_tsch_hopping_sequence_length);
-    TSCH_ASN_DIVISOR_INIT(tsch_hopping_sequence_length, default_tsch_hopping_sequence_length);
+    hopping_blacklist_reset();
     memcpy(tsch_hopping_sequence_adv, default_tsch_hopping_sequence_adv, default_tsch_hopping_sequence_adv_length);
     TSCH_ASN_DIVISOR_INIT(tsch_hopping_sequence_adv_length, default_tsch_hopping_sequence_adv_length);
 
+    /* Hop over the channels blacklisted by the PAN, applied by the slot
+     * operation before the first slot */
+    hopping_blacklist_from_eb(&ies, &tsch_current_asn);
+
     if(tsch_static_beacon_channel_available())
     {
       /* Set static beacon channel for all hopping sequences. */
@@ -901,6 +1231,14 @@ tsch_associate(const struct input_packet *input_eb, rtimer_clock_t timestamp)
       /* Update global flags */
       tsch_is_associated = 1;
       tsch_is_pan_secured = frame.fcf.security_enabled;
+
+      /* Move the network time onto the new ASN */
+      if(ies.ie_absolute_time) {
+        tsch_set_beacon_absolute_time(ies.ie_absolute_time);
+        at_set_anchor_asn((uint64_t)ies.ie_absolute_time * 1000, &ies.ie_asn);
+      } else if(tsch_at_anchor.ms != 0) {
+        at_set_anchor_now(at_now_ms());
+      }
       tx_count = 0;
       rx_count = 0;
       sync_count = 0;
@@ -1338,6 +1676,12 @@ send_packet(mac_callback_t sent, void *ptr)
   if((hdr_len = NETSTACK_FRAMER.create()) < 0) {
     LOG_ERR("! can't send packet due to framer error\n");
     ret = MAC_TX_ERR;
+  } else if(RADIO_BYTE_AIR_TIME * (packetbuf_totlen() + TSCH_SEND_MIC_LEN +
+            RADIO_PHY_OVERHEAD + RADIO_PHY_HEADER_LEN) > tsch_timing_us[tsch_ts_max_tx]) {
+    /* The frame does not fit into the timeslot timing in use */
+    LOG_ERR("! can't send packet of %u bytes, exceeds max tx %u us\n",
+        packetbuf_totlen(), tsch_timing_us[tsch_ts_max_tx]);
+    ret = MAC_TX_ERR_FATAL;
   } else {
     struct tsch_packet *p;
     struct tsch_neighbor *n;
@@ -61,6 +61,7 @@ frequency hopping for enhanced reliability.
 #include "net/mac/tsch/tsch-security.h"
 #include "net/mac/tsch/tsch-schedule.h"
 #include "net/mac/tsch/tsch-stats.h"
+#include "net/mac/tsch/tsch-absolute-time.h"
 #if UIP_CONF_IPV6_RPL
 #include "net/mac/tsch/tsch-rpl.h"
 #endif /* UIP_CONF_IPV6_RPL */
@@ -106,6 +107,19 @@ frequency hopping for enhanced reliability.
 
 #endif /* BUILD_WITH_ORCHESTRA */
 
+/* Link the channel statistics to the adaptive channel selection */
+#if BUILD_WITH_TSCH_CS
+
+#ifndef TSCH_CALLBACK_CHANNEL_STATS_UPDATED
+#define TSCH_CALLBACK_CHANNEL_STATS_UPDATED tsch_cs_channel_stats_updated
+#endif /* TSCH_CALLBACK_CHANNEL_STATS_UPDATED */
+
+#endif /* BUILD_WITH_TSCH_CS */
+
+#ifdef TSCH_CALLBACK_CHANNEL_STATS_UPDATED
+void TSCH_CALLBACK_CHANNEL_STATS_UPDATED(uint8_t updated_channel, uint16_t old_busyness_metric);
+#endif
+
 /* Called by TSCH when get PAN ID */
 #ifdef TSCH_CALLBACK_ACK_APP_IE_TX
 uint8_t TSCH_CALLBACK_ACK_APP_IE_TX( const linkaddr_t *dest_addr, const void *data );
@@ -126,9 +140,74 @@ void TSCH_CALLBACK_JOINING_NETWORK();
 void TSCH_CALLBACK_LEAVING_NETWORK();
 #endif
 
-/* Called by TSCH when at slot zero (new slot cycle) */
+/* Called by TSCH at association to map an advertised timeslot template ID
+ * to the timeslot timing (in micro-second). Returns NULL if unknown. */
+#ifdef TSCH_CALLBACK_GET_TIMESLOT_TIMING
+const uint16_t *TSCH_CALLBACK_GET_TIMESLOT_TIMING(uint8_t timeslot_id);
+#endif
+
+/* Called by TSCH when at slot zero (new slot cycle). Invoked from the rtimer
+ * interrupt: implementations must only defer work, never block. */
 #ifdef TSCH_CALLBACK_CYCLE_START
-void TSCH_CALLBACK_CYCLE_START();
+void TSCH_CALLBACK_CYCLE_START(const struct tsch_asn_t *asn,
+                               rtimer_clock_t slot_start);
+#endif
+
+/* Called by TSCH from the rtimer interrupt before listening to a beacon slot.
+ * Returns non-zero to skip the slot, given the time since the last sync. */
+#ifdef TSCH_CALLBACK_SKIP_BEACON_RX
+int TSCH_CALLBACK_SKIP_BEACON_RX(clock_time_t since_last_sync);
+#endif
+
+/* Called by TSCH from the rtimer interrupt for every received frame, given
+ * the source address, the RSSI and the channel. */
+#ifdef TSCH_CALLBACK_LINK_RX
+void TSCH_CALLBACK_LINK_RX(const linkaddr_t *addr, int16_t rssi,
+                           uint8_t channel);
+#endif
+
+/* Called by TSCH from the rtimer interrupt after every unicast transmission
+ * attempt, given the MAC status, the channel and the RSSI of the ACK. */
+#ifdef TSCH_CALLBACK_LINK_TX
+void TSCH_CALLBACK_LINK_TX(const linkaddr_t *addr, uint8_t mac_tx_status,
+                           uint8_t channel, int16_t ack_rssi);
+#endif
+
+/* Called by TSCH from the rtimer interrupt when the radio starts listening in
+ * an Rx slot, given the link type of the slot. */
+#ifdef TSCH_CALLBACK_RX_LISTEN_START
+void TSCH_CALLBACK_RX_LISTEN_START(uint8_t link_type);
+#endif
+
+/* Called by TSCH from the rtimer interrupt when the radio stops listening in
+ * an Rx slot. */
+#ifdef TSCH_CALLBACK_RX_LISTEN_END
+void TSCH_CALLBACK_RX_LISTEN_END(void);
+#endif
+
+/* Called by TSCH from the rtimer interrupt when a wakeup is scheduled too
+ * late, given the name of the scheduling call site. */
+#ifdef TSCH_CALLBACK_DEADLINE_MISS
+void TSCH_CALLBACK_DEADLINE_MISS(const char *site);
+#endif
+
+/* Called by TSCH from the rtimer interrupt when a slot is skipped, given the
+ * lock state and whether there was no link. */
+#ifdef TSCH_CALLBACK_SLOT_SKIPPED
+void TSCH_CALLBACK_SLOT_SKIPPED(uint8_t locked, uint8_t lock_requested,
+                                uint8_t no_link);
+#endif
+
+/* Called by TSCH from the rtimer interrupt when a received frame is dropped
+ * because the input queue is full. */
+#ifdef TSCH_CALLBACK_INPUT_QUEUE_DROP
+void TSCH_CALLBACK_INPUT_QUEUE_DROP(void);
+#endif
+
+/* Called by TSCH from the rtimer interrupt when no ACK is received for a
+ * unicast frame. */
+#ifdef TSCH_CALLBACK_ACK_TIMEOUT
+void TSCH_CALLBACK_ACK_TIMEOUT(void);
 #endif
 
 #ifdef TSCH_CALLBACK_NEEDS_RESTART
@@ -191,6 +270,7 @@ extern struct tsch_asn_t tsch_current_asn;
 extern uint8_t tsch_join_priority;
 extern uint32_t tsch_absolute_time;
 extern uint8_t tsch_join_mode;
+extern uint8_t tsch_join_congestion;
 extern struct tsch_link *current_link;
 /* If we are inside a slot, these tell the current channel and channel offset */
 extern uint8_t tsch_current_channel;
@@ -200,10 +280,17 @@ extern uint8_t tsch_hopping_sequence[TSCH_HOPPING_SEQUENCE_MAX_LEN];
 extern struct tsch_asn_divisor_t tsch_hopping_sequence_length;
 extern uint8_t tsch_hopping_sequence_adv[TSCH_HOPPING_SEQUENCE_MAX_LEN];
 extern struct tsch_asn_divisor_t tsch_hopping_sequence_adv_length;
+/* Default TSCH channel hopping sequence, the blacklist refers to its entries */
+extern const uint8_t *default_tsch_hopping_sequence;
+extern uint16_t default_tsch_hopping_sequence_length;
+/* Blacklisted entries of the default hopping sequence, one bit per entry */
+extern uint16_t tsch_hopping_blacklist;
 /* TSCH timeslot timing (in micro-second) */
 extern tsch_timeslot_timing_usec tsch_timing_us;
 /* TSCH timeslot timing (in rtimer ticks) */
 extern tsch_timeslot_timing_ticks tsch_timing;
+/* TSCH timeslot template ID in use (0: default timing) */
+extern uint8_t tsch_timeslot_id;
 /* Statistics on the current session */
 extern unsigned long tx_count;
 extern unsigned long rx_count;
@@ -239,6 +326,14 @@ void tsch_set_internal_absolute_time(uint32_t t);
  * \return the current absolute time
  */
 uint32_t tsch_get_internal_absolute_time(void);
+/**
+ * Get the TSCH absolute time (AT) with millisecond resolution. While
+ * associated it is derived from the ASN, the timeslot length and the
+ * offset within the current slot.
+ *
+ * \return the current absolute time in ms, 0 if unknown
+ */
+uint64_t tsch_get_absolute_time_ms(void);
 /**
  * Set the TSCH absolute time (AT) received from beacons
  *
@@ -272,10 +367,57 @@ void tsch_set_join_mode(uint8_t m);
  * Get the TSCH join mode (JM)
  */
 uint8_t tsch_get_join_mode(void);
+/**
+ * Set the join congestion level advertised in EBs. The coordinator raises it
+ * while many join requests collide, joining nodes widen their backoff.
+ *
+ * \param level the new join congestion level (0: no congestion)
+ */
+void tsch_set_join_congestion(uint8_t level);
+/**
+ * Get the join congestion level, as set or as received from the time source
+ */
+uint8_t tsch_get_join_congestion(void);
 
 void tsch_set_hopping_sequence(const uint8_t hoppingSequence[], uint16_t length);
 
 void tsch_set_hopping_sequence_adv(const uint8_t hoppingSequenceAdv[], uint16_t length);
+/**
+ * Blacklist entries of the default hopping sequence. The slot operation
+ * applies it at the start of the next active slot. Cancels a pending
+ * switch.
+ *
+ * \param blacklist one bit per entry of the default hopping sequence
+ * \return 0 on success, -1 if less than TSCH_HOPPING_MIN_LEN channels remain
+ */
+int tsch_set_hopping_blacklist(uint16_t blacklist);
+/**
+ * Schedule a hopping sequence blacklist to take effect at the given ASN,
+ * so that all nodes of the PAN switch in the same slot. The coordinator
+ * announces the switch in its EBs.
+ *
+ * \param blacklist one bit per entry of the default hopping sequence
+ * \param asn the ASN of the switch
+ * \return 0 on success, -1 if less than TSCH_HOPPING_MIN_LEN channels remain
+ */
+int tsch_schedule_hopping_blacklist(uint16_t blacklist, const struct tsch_asn_t *asn);
+/**
+ * Get the hopping sequence blacklist and the pending switch, consistent
+ * with the slot operation applying them.
+ *
+ * \param blacklist the blacklist in use, or requested for the next slot
+ * \param next_blacklist the pending blacklist, set if a switch is pending
+ * \param asn the ASN of the switch, set if a switch is pending
+ * \return 1 if a switch is pending, 0 otherwise
+ */
+int tsch_get_hopping_blacklist(uint16_t *blacklist, uint16_t *next_blacklist,
+                               struct tsch_asn_t *asn);
+/**
+ * Apply a requested or a pending hopping sequence blacklist once its ASN
+ * is reached. Called from the slot operation at the start of every active
+ * slot, before the channel of the slot is calculated.
+ */
+void tsch_hopping_switch_check(void);
 
 void tsch_scan_enable(void);
 
@@ -286,6 +428,8 @@ uint8_t tsch_get_static_beacon_channel(void);
 
 void tsch_set_static_beacon_channel(uint8_t channel);
 
+bool tsch_static_beacon_channel_available(void);
+
 /**
  * Set a fixed address for TSCH beacon scan.
  *
@@ -315,6 +459,16 @@ void tsch_set_eb_period(uint32_t period);
  * \param timeout The timeout in Clock ticks.
  */
 void tsch_set_ka_timeout(uint32_t timeout);
+/**
+ * Set the timeslot timing used when not associated to a network. At the
+ * coordinator, the timeslot template ID is advertised in EBs (see
+ * TSCH_PACKET_CONF_EB_WITH_TIMESLOT_ID). Must be called before starting TSCH.
+ *
+ * \param timeslot_id The timeslot template ID, 0 for the default timing
+ * \param timing_us The timeslot timing in micro-seconds
+ * \return 1 if the timing has been set, 0 if already associated
+ */
+int tsch_set_timeslot_timing(uint8_t timeslot_id, const uint16_t *timing_us);
 /**
  * Set the node as PAN coordinator
  *
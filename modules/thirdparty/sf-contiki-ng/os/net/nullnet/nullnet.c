@@ -47,6 +47,7 @@
 #include "net/packetbuf.h"
 #include "net/netstack.h"
 #include "net/nullnet/nullnet.h"
+#include "net/link-stats.h"
 #if LLSEC802154_ENABLED
 #include "tsch-security.h"
 #endif
@@ -84,6 +85,7 @@ static void
 init(void)
 {
   LOG_INFO("init\n");
+  link_stats_init();
   current_input_callback = NULL;
   current_output_callback = NULL;
 }
@@ -91,6 +93,8 @@ init(void)
 static void
 input(void)
 {
+  link_stats_input_callback(packetbuf_addr(PACKETBUF_ADDR_SENDER));
+
   if(current_input_callback != NULL) {
     LOG_INFO("received %u bytes from ", packetbuf_datalen());
     LOG_INFO_LLADDR(packetbuf_addr(PACKETBUF_ADDR_SENDER));
@@ -120,6 +124,11 @@ nullnet_mac_callback(void *ptr, int status, int transmissions, uint8_t ack_app_d
   busy_singlePacket = false;
 #endif /* NULLNET_SINGLE_PACKET_ENABLED */
 
+  /* Update the ETX of unicast links */
+  if(!linkaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER), &linkaddr_null)) {
+    link_stats_packet_sent(packetbuf_addr(PACKETBUF_ADDR_RECEIVER), status, transmissions);
+  }
+
   if(current_output_callback != NULL) {
     nullnet_tx_status_t tx_status = NULLNET_TX_ERR;
 
@@ -172,6 +181,7 @@ static uint8_t
 output(const linkaddr_t *dest, void *ptr, const uint8_t frameType)
 {
   packetbuf_attr_t transmissionsAttr;
+  packetbuf_attr_t ttlAttr;
 
 #if NULLNET_SINGLE_PACKET_ENABLED
   if(true == enabled_singlePacket){
@@ -187,6 +197,7 @@ output(const linkaddr_t *dest, void *ptr, const uint8_t frameType)
 #endif /* NULLNET_SINGLE_PACKET_ENABLED */
 
   transmissionsAttr = packetbuf_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS);
+  ttlAttr = packetbuf_attr(PACKETBUF_ATTR_MAC_TTL);
   packetbuf_clear();
   packetbuf_copyfrom(nullnet_buf, nullnet_len);
   if(dest != NULL) {
@@ -197,6 +208,7 @@ output(const linkaddr_t *dest, void *ptr, const uint8_t frameType)
   packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &linkaddr_node_addr);
 
   packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS, transmissionsAttr);
+  packetbuf_set_attr(PACKETBUF_ATTR_MAC_TTL, ttlAttr);
 
   packetbuf_set_attr(PACKETBUF_ATTR_FRAME_TYPE, frameType);
 
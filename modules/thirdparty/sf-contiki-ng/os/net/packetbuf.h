@@ -219,6 +219,7 @@ enum {
   PACKETBUF_ATTR_RSSI,
   PACKETBUF_ATTR_TIMESTAMP,
   PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS,
+  PACKETBUF_ATTR_MAC_TTL,
   PACKETBUF_ATTR_MAC_SEQNO,
   PACKETBUF_ATTR_MAC_ACK,
   PACKETBUF_ATTR_MAC_METADATA,
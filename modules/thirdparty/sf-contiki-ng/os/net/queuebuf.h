@@ -117,6 +117,11 @@ void queuebuf_debug_print(void);
 
 int queuebuf_numfree(void);
 
+#if QUEUEBUF_CONF_STATS
+/* Number of queue buffers in use and its high watermark since the boot */
+extern uint8_t queuebuf_len, queuebuf_max_len;
+#endif /* QUEUEBUF_CONF_STATS */
+
 #endif /* __QUEUEBUF_H__ */
 
 /** @} */
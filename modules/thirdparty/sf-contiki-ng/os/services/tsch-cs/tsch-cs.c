@@ -0,0 +1,265 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \file
+ *         TSCH adaptive channel selection.
+ *
+ *         The coordinator rates every channel of the default hopping
+ *         sequence by the share of idle slots in which the channel was found
+ *         free (noise sampling of tsch-stats) and by the success rate of its
+ *         unicast transmissions. Busy channels are blacklisted one at a time.
+ *         The new blacklist is announced in the EBs together with the ASN of
+ *         the switch, so that all nodes of the PAN change the hopping
+ *         sequence in the same slot. Other nodes only follow the coordinator.
+ *
+ *         A coordinator is built with MODULES += os/services/tsch-cs. This
+ *         enables the noise sampling of tsch-stats and links its channel
+ *         updates to tsch_cs_channel_stats_updated (see tsch-conf.h and
+ *         tsch.h), the process is started by contiki-main. The slot
+ *         operation accounts the unicast attempts and applies the switch.
+ */
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch.h"
+#include "services/tsch-cs/tsch-cs.h"
+
+/* Log configuration */
+#include "sys/log.h"
+#define LOG_MODULE "TSCH CS"
+#define LOG_LEVEL LOG_LEVEL_MAC
+
+/*---------------------------------------------------------------------------*/
+/* EWMA of the unicast Tx success per channel */
+static tsch_stat_t tx_success_ewma[TSCH_STATS_NUM_CHANNELS];
+/* Set when a channel metric crossed its threshold */
+static volatile bool recalculation_requested;
+
+PROCESS(tsch_cs_adaptation_process, "TSCH CS adaptation process");
+/*---------------------------------------------------------------------------*/
+/* Returns the index of a channel in the statistics, or -1 */
+static int
+channel_index(uint8_t channel)
+{
+  if(channel < TSCH_STATS_FIRST_CHANNEL
+     || channel >= TSCH_STATS_FIRST_CHANNEL + TSCH_STATS_NUM_CHANNELS) {
+    return -1;
+  }
+  return tsch_stats_channel_to_index(channel);
+}
+/*---------------------------------------------------------------------------*/
+/* Returns whether the channel is busy, with hysteresis for channels that are
+ * currently blacklisted */
+static bool
+is_busy(uint8_t index, bool is_blacklisted)
+{
+  tsch_stat_t margin = is_blacklisted ? TSCH_CS_HYSTERESIS : 0;
+
+  if(tx_success_ewma[index] < TSCH_CS_TX_SUCCESS_THRESHOLD + margin) {
+    return true;
+  }
+#if TSCH_STATS_ON && TSCH_STATS_SAMPLE_NOISE_RSSI
+  if(tsch_stats.channel_free_ewma[index] < TSCH_CS_FREE_THRESHOLD + margin) {
+    return true;
+  }
+#endif /* TSCH_STATS_ON && TSCH_STATS_SAMPLE_NOISE_RSSI */
+  return false;
+}
+/*---------------------------------------------------------------------------*/
+/* Lower metric of a channel, to select the worst or the best channel */
+static tsch_stat_t
+quality(uint8_t index)
+{
+  tsch_stat_t q = tx_success_ewma[index];
+#if TSCH_STATS_ON && TSCH_STATS_SAMPLE_NOISE_RSSI
+  q = MIN(q, tsch_stats.channel_free_ewma[index]);
+#endif /* TSCH_STATS_ON && TSCH_STATS_SAMPLE_NOISE_RSSI */
+  return q;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_cs_adaptations_init(void)
+{
+  int i;
+
+  for(i = 0; i < TSCH_STATS_NUM_CHANNELS; i++) {
+    tx_success_ewma[i] = TSCH_STATS_BINARY_SCALING_FACTOR;
+  }
+  recalculation_requested = false;
+  process_start(&tsch_cs_adaptation_process, NULL);
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_cs_channel_stats_updated(uint8_t updated_channel, uint16_t old_busyness_metric)
+{
+#if TSCH_STATS_ON && TSCH_STATS_SAMPLE_NOISE_RSSI
+  int index = channel_index(updated_channel);
+  tsch_stat_t new_metric;
+
+  if(index < 0) {
+    return;
+  }
+  new_metric = tsch_stats.channel_free_ewma[index];
+  /* Called from the rtimer interrupt. Only flag threshold crossings, the
+   * decision is taken by the periodic process. */
+  if((old_busyness_metric < TSCH_CS_FREE_THRESHOLD) != (new_metric < TSCH_CS_FREE_THRESHOLD)) {
+    recalculation_requested = true;
+    process_poll(&tsch_cs_adaptation_process);
+  }
+#endif /* TSCH_STATS_ON && TSCH_STATS_SAMPLE_NOISE_RSSI */
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_cs_tx_packet(uint8_t channel, uint8_t mac_tx_status)
+{
+  int index = channel_index(channel);
+  tsch_stat_t old_metric;
+
+  /* Only a sent frame tells about the channel */
+  if(index < 0 || (mac_tx_status != MAC_TX_OK && mac_tx_status != MAC_TX_NOACK)) {
+    return;
+  }
+  old_metric = tx_success_ewma[index];
+  TSCH_STATS_EWMA_UPDATE(tx_success_ewma[index],
+      mac_tx_status == MAC_TX_OK ? TSCH_STATS_BINARY_SCALING_FACTOR : 0);
+  if((old_metric < TSCH_CS_TX_SUCCESS_THRESHOLD)
+     != (tx_success_ewma[index] < TSCH_CS_TX_SUCCESS_THRESHOLD)) {
+    recalculation_requested = true;
+    process_poll(&tsch_cs_adaptation_process);
+  }
+}
+/*---------------------------------------------------------------------------*/
+bool
+tsch_cs_process(void)
+{
+  uint16_t i;
+  uint16_t current;
+  uint16_t blacklist;
+  uint16_t pending_blacklist;
+  struct tsch_asn_t switch_asn;
+  uint16_t num_channels = 0;
+  int worst = -1;
+  int best = -1;
+  int index;
+  uint8_t changed;
+
+  recalculation_requested = false;
+
+  /* Only the coordinator decides, and only one switch at a time */
+  if(!tsch_is_coordinator || !tsch_is_associated
+     || tsch_get_hopping_blacklist(&current, &pending_blacklist, &switch_asn)
+     || default_tsch_hopping_sequence_length > 16) {
+    return false;
+  }
+  blacklist = current;
+
+  for(changed = 0; changed < TSCH_CS_MAX_CHANNELS_CHANGED; changed++) {
+    num_channels = 0;
+    worst = -1;
+    best = -1;
+    for(i = 0; i < default_tsch_hopping_sequence_length; i++) {
+      bool is_blacklisted = (blacklist & (1u << i)) != 0;
+      index = channel_index(default_tsch_hopping_sequence[i]);
+      if(index < 0) {
+        continue;
+      }
+      if(!is_blacklisted) {
+        num_channels++;
+      }
+      if(is_busy(index, is_blacklisted)) {
+        if(!is_blacklisted
+           && (worst < 0 || quality(index) < quality(channel_index(default_tsch_hopping_sequence[worst])))) {
+          worst = i;
+        }
+      } else if(is_blacklisted
+                && (best < 0 || quality(index) > quality(channel_index(default_tsch_hopping_sequence[best])))) {
+        best = i;
+      }
+    }
+
+    if(worst >= 0 && num_channels > TSCH_HOPPING_MIN_LEN) {
+      blacklist |= 1u << worst;
+    } else if(best >= 0) {
+      blacklist &= ~(1u << best);
+    } else {
+      break;
+    }
+  }
+
+  if(blacklist == current) {
+    return false;
+  }
+
+  /* Switch far enough in the future for every node to receive an EB */
+  switch_asn = tsch_current_asn;
+  TSCH_ASN_INC(switch_asn, TSCH_CS_SWITCH_DELAY_SEC * 1000000ul
+               / tsch_timing_us[tsch_ts_timeslot_length]);
+  if(tsch_schedule_hopping_blacklist(blacklist, &switch_asn) < 0) {
+    return false;
+  }
+
+  LOG_INFO("new blacklist %04x (was %04x)\n", blacklist, current);
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(tsch_cs_adaptation_process, ev, data)
+{
+  static struct etimer et;
+  uint16_t i;
+  int index;
+  uint16_t blacklist;
+  uint16_t pending_blacklist;
+  struct tsch_asn_t switch_asn;
+
+  PROCESS_BEGIN();
+
+  etimer_set(&et, TSCH_CS_LEARNING_PERIOD_SEC * CLOCK_SECOND);
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et) || recalculation_requested);
+
+    if(etimer_expired(&et)) {
+      etimer_reset(&et);
+
+      /* Blacklisted channels are not used for Tx. Let their success rate
+       * recover, so that they are probed again. */
+      tsch_get_hopping_blacklist(&blacklist, &pending_blacklist, &switch_asn);
+      for(i = 0; i < default_tsch_hopping_sequence_length && i < 16; i++) {
+        index = channel_index(default_tsch_hopping_sequence[i]);
+        if(index >= 0 && (blacklist & (1u << i))) {
+          TSCH_STATS_EWMA_UPDATE(tx_success_ewma[index], TSCH_STATS_BINARY_SCALING_FACTOR);
+        }
+      }
+    }
+
+    /* Decide once per learning period, or earlier if a channel changed */
+    tsch_cs_process();
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
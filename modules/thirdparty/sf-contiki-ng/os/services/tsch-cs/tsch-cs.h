@@ -38,6 +38,7 @@
 #define __TSCH_CS_H__
 
 #include "contiki.h"
+#include "net/mac/tsch/tsch.h"
 #include <stdbool.h>
 
 /* If `channel_free_ewma` value is less than this, the channel is considered busy */
@@ -48,6 +49,29 @@
 #define TSCH_CS_FREE_THRESHOLD ((tsch_stat_t)(85ul * TSCH_STATS_BINARY_SCALING_FACTOR / 100))
 #endif
 
+/* If the EWMA of the unicast Tx success is less than this, the channel is considered busy */
+#ifdef TSCH_CS_CONF_TX_SUCCESS_THRESHOLD
+#define TSCH_CS_TX_SUCCESS_THRESHOLD TSCH_CS_CONF_TX_SUCCESS_THRESHOLD
+#else
+/* < 70% success */
+#define TSCH_CS_TX_SUCCESS_THRESHOLD ((tsch_stat_t)(70ul * TSCH_STATS_BINARY_SCALING_FACTOR / 100))
+#endif
+
+/* A busy channel is used again once both metrics exceed their threshold by this */
+#define TSCH_CS_HYSTERESIS (TSCH_STATS_BINARY_SCALING_FACTOR / 10)
+
+/* Maximum number of channels added to or removed from the blacklist at once */
+#define TSCH_CS_MAX_CHANNELS_CHANGED 1
+
+/* Delay between the decision and the hopping sequence switch. All nodes
+ * must receive at least one EB announcing the switch in between, including
+ * nodes skipping beacons. */
+#ifdef TSCH_CS_CONF_SWITCH_DELAY_SEC
+#define TSCH_CS_SWITCH_DELAY_SEC TSCH_CS_CONF_SWITCH_DELAY_SEC
+#else
+#define TSCH_CS_SWITCH_DELAY_SEC 120
+#endif
+
 #define TSCH_CS_LEARNING_PERIOD_SEC 30
 
 /**
@@ -68,6 +92,13 @@ void tsch_cs_channel_stats_updated(uint8_t updated_channel, uint16_t old_busynes
  */
 bool tsch_cs_process(void);
 
+/**
+ * \brief Account a unicast transmission attempt for the channel failure rate.
+ * \param channel       The channel of the attempt
+ * \param mac_tx_status The MAC status of the attempt
+ */
+void tsch_cs_tx_packet(uint8_t channel, uint8_t mac_tx_status);
+
 
 /* A bit corresponds to a channel; `uint16_t` value is OK for up to 16 channels. */
 typedef uint16_t tsch_cs_bitmap_t;
@@ -95,6 +95,20 @@
 #define PLATFORM_MAIN_ACCEPTS_ARGS 0
 #endif
 /*---------------------------------------------------------------------------*/
+/**
+ * Controls whether the platform defers the init not needed by the network
+ *
+ * If set, the platform leaves out the init of drivers which are only used
+ * for indication and debugging, e.g. the console, during the boot. The
+ * application completes it with platform_init_deferred() when the boot is
+ * done.
+ */
+#ifdef PLATFORM_CONF_DEFERS_INIT
+#define PLATFORM_DEFERS_INIT PLATFORM_CONF_DEFERS_INIT
+#else
+#define PLATFORM_DEFERS_INIT 0
+#endif
+/*---------------------------------------------------------------------------*/
 /**
  * \brief Basic (Stage 1) platform driver initialisation.
  *
@@ -167,6 +181,17 @@ void platform_init_stage_two(void);
  */
 void platform_init_stage_three(void);
 /*---------------------------------------------------------------------------*/
+/**
+ * \brief Deferred platform driver initialisation.
+ *
+ * Initialisation of the drivers left out by the boot sequence if
+ * PLATFORM_DEFERS_INIT is set. Called once by the application. Until then
+ * character I/O may be dropped.
+ *
+ * \sa platform_init_stage_two()
+ */
+void platform_init_deferred(void);
+/*---------------------------------------------------------------------------*/
 /**
  * \brief The platform's idle/sleep function
  *
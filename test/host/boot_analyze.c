@@ -0,0 +1,38 @@
+/**
+ @file
+ @brief      Analyzer of boot profile traces, see boot_trace.h.
+
+ @details Usage: boot_analyze [trace...]
+          Reads the standard input without a trace file.
+*/
+#include <stdio.h>
+
+#include "boot_trace.h"
+
+int main(int argc, char *argv[])
+{
+  boot_trace_summary_t sum;
+  FILE *pFile;
+  int i;
+
+  if(argc < 2)
+  {
+    boot_trace_analyze(stdin, &sum);
+    boot_trace_print("stdin", &sum);
+    return 0;
+  }
+
+  for(i = 1; i < argc; i++)
+  {
+    pFile = fopen(argv[i], "r");
+    if(NULL == pFile)
+    {
+      perror(argv[i]);
+      return 1;
+    }
+    boot_trace_analyze(pFile, &sum);
+    fclose(pFile);
+    boot_trace_print(argv[i], &sum);
+  }
+  return 0;
+}
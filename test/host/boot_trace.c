@@ -0,0 +1,203 @@
+/**
+ @file
+ @brief      Trace format and analyzer of the boot profiles, see
+             boot_trace.h.
+*/
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sf_frameType.h"
+#include "boot_trace.h"
+
+/* Boot count, reset source and number of phases */
+#define HEADER_LEN         4U
+/* Longest line of a trace */
+#define LINE_MAX_LEN       1024U
+
+static const char *const gPhaseName[E_SF_BOOTPROFILE_PHASE_MAX] =
+{
+  [E_SF_BOOTPROFILE_PHASE_APP_START] = "app start",
+  [E_SF_BOOTPROFILE_PHASE_RF_READY] = "radio ready",
+  [E_SF_BOOTPROFILE_PHASE_CONFIG_READY] = "config read",
+  [E_SF_BOOTPROFILE_PHASE_JOIN_START] = "join started",
+  [E_SF_BOOTPROFILE_PHASE_ASSOCIATED] = "associated",
+  [E_SF_BOOTPROFILE_PHASE_CONNECTED] = "connected",
+  [E_SF_BOOTPROFILE_PHASE_FIRST_UPLINK] = "first uplink",
+};
+
+static int loc_cmp(const void *a, const void *b)
+{
+  double d = *(const double *)a - *(const double *)b;
+
+  return (d > 0) - (d < 0);
+}
+
+static double loc_percentile(double *pValues, unsigned n, unsigned percent)
+{
+  if(0U == n)
+  {
+    return 0.0;
+  }
+  qsort(pValues, n, sizeof(pValues[0]), loc_cmp);
+  return pValues[(n - 1U) * percent / 100U];
+}
+
+static int loc_hex(char c)
+{
+  if(isdigit((unsigned char)c))
+  {
+    return c - '0';
+  }
+  c = (char)tolower((unsigned char)c);
+  return ((c >= 'a') && (c <= 'f')) ? c - 'a' + 10 : -1;
+}
+
+bool boot_trace_decode(const uint8_t *pFrame, size_t len, boot_trace_t *pTrace)
+{
+  size_t pos = SF_FRAME_TYPE_LEN;
+  uint8_t p;
+
+  if((len < SF_FRAME_TYPE_LEN + HEADER_LEN) ||
+     (E_FRAME_TYPE_BOOT_PROFILE != pFrame[0]))
+  {
+    return false;
+  }
+
+  memset(pTrace, 0, sizeof(*pTrace));
+  memcpy(&pTrace->bootCount, &pFrame[pos], sizeof(pTrace->bootCount));
+  pos += sizeof(pTrace->bootCount);
+  pTrace->resetSource = pFrame[pos++];
+  pTrace->phases = pFrame[pos++];
+  if((pTrace->phases > BOOT_TRACE_PHASES_MAX) ||
+     (len != pos + pTrace->phases * sizeof(uint32_t)))
+  {
+    return false;
+  }
+
+  for(p = 0; p < pTrace->phases; p++)
+  {
+    memcpy(&pTrace->timeMs[p], &pFrame[pos], sizeof(uint32_t));
+    pos += sizeof(uint32_t);
+  }
+  return true;
+}
+
+void boot_trace_write(FILE *pFile, const uint8_t *pFrame, size_t len)
+{
+  size_t i;
+
+  for(i = 0; i < len; i++)
+  {
+    fprintf(pFile, "%02x", pFrame[i]);
+  }
+  fputc('\n', pFile);
+}
+
+int boot_trace_read(FILE *pFile, boot_trace_t *pTrace)
+{
+  char line[LINE_MAX_LEN];
+  uint8_t frame[LINE_MAX_LEN / 2];
+  size_t len;
+  char *pHex;
+  int hi;
+  int lo;
+
+  do
+  {
+    if(NULL == fgets(line, sizeof(line), pFile))
+    {
+      return 0;
+    }
+    pHex = strrchr(line, ';');
+    pHex = (NULL != pHex) ? pHex + 1 : line;
+    while(isspace((unsigned char)*pHex))
+    {
+      pHex++;
+    }
+  } while(('\0' == *pHex) || ('#' == *pHex));
+
+  len = 0;
+  while(!isspace((unsigned char)*pHex) && ('\0' != *pHex))
+  {
+    hi = loc_hex(pHex[0]);
+    lo = (hi >= 0) ? loc_hex(pHex[1]) : -1;
+    if(lo < 0)
+    {
+      return -1;
+    }
+    frame[len++] = (uint8_t)((hi << 4) | lo);
+    pHex += 2;
+  }
+
+  return boot_trace_decode(frame, len, pTrace) ? 1 : -1;
+}
+
+void boot_trace_analyze(FILE *pFile, boot_trace_summary_t *pSum)
+{
+  static double step[BOOT_TRACE_PHASES_MAX][BOOT_TRACE_BOOTS_MAX];
+  static double uplink[BOOT_TRACE_BOOTS_MAX];
+  unsigned steps[BOOT_TRACE_PHASES_MAX] = {0};
+  unsigned uplinks = 0;
+  boot_trace_t trace;
+  int res;
+  uint8_t p;
+
+  memset(pSum, 0, sizeof(*pSum));
+  while((0 != (res = boot_trace_read(pFile, &trace))) &&
+        (pSum->boots < BOOT_TRACE_BOOTS_MAX))
+  {
+    if(res < 0)
+    {
+      pSum->invalid++;
+      continue;
+    }
+    pSum->boots++;
+
+    for(p = 0; p < trace.phases; p++)
+    {
+      if(BOOT_TRACE_NONE == trace.timeMs[p])
+      {
+        continue;
+      }
+      pSum->reached[p]++;
+      if((p > 0) && (BOOT_TRACE_NONE != trace.timeMs[p - 1]))
+      {
+        step[p][steps[p]++] = (double)trace.timeMs[p] - (double)trace.timeMs[p - 1];
+      }
+    }
+    if((trace.phases > E_SF_BOOTPROFILE_PHASE_FIRST_UPLINK) &&
+       (BOOT_TRACE_NONE != trace.timeMs[E_SF_BOOTPROFILE_PHASE_FIRST_UPLINK]))
+    {
+      uplink[uplinks++] = trace.timeMs[E_SF_BOOTPROFILE_PHASE_FIRST_UPLINK];
+    }
+  }
+
+  for(p = 0; p < BOOT_TRACE_PHASES_MAX; p++)
+  {
+    pSum->stepP50Ms[p] = loc_percentile(step[p], steps[p], 50U);
+    pSum->stepP90Ms[p] = loc_percentile(step[p], steps[p], 90U);
+  }
+  pSum->uplinkP50Ms = loc_percentile(uplink, uplinks, 50U);
+  pSum->uplinkP90Ms = loc_percentile(uplink, uplinks, 90U);
+  pSum->uplinkMaxMs = loc_percentile(uplink, uplinks, 100U);
+}
+
+void boot_trace_print(const char *pName, const boot_trace_summary_t *pSum)
+{
+  uint8_t p;
+
+  printf("%s: %u boots, %u invalid lines\n", pName, pSum->boots, pSum->invalid);
+  for(p = 0; p < BOOT_TRACE_PHASES_MAX; p++)
+  {
+    if(0U == pSum->reached[p])
+    {
+      continue;
+    }
+    printf("  %-14s reached %4u, step p50 %8.1f ms p90 %8.1f ms\n",
+           (p < E_SF_BOOTPROFILE_PHASE_MAX) ? gPhaseName[p] : "later phase",
+           pSum->reached[p], pSum->stepP50Ms[p], pSum->stepP90Ms[p]);
+  }
+  printf("  reset to first uplink p50 %.1f ms p90 %.1f ms max %.1f ms\n",
+         pSum->uplinkP50Ms, pSum->uplinkP90Ms, pSum->uplinkMaxMs);
+}
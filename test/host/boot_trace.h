@@ -0,0 +1,73 @@
+/**
+ @file
+ @brief      Trace format and analyzer of the boot profiles of the SCs.
+
+ @details A trace is a text file with one boot per line: the boot profile
+          frame in hex, frame type first, as logged by the SC with
+          LOG_INFO_BYTES or as received by the BMS-CC. Anything up to the
+          last ';' of a line is skipped, so the UART log of an SC can be
+          replayed as it is. Empty lines and lines starting with '#' are
+          comments.
+
+          The analyzer reports per boot phase the number of boots reaching
+          it and the median and 90th percentile of the step from the phase
+          before, and the time from the reset to the first uplink.
+*/
+#ifndef BOOT_TRACE_H
+#define BOOT_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "sf_bootProfile.h"
+
+/* Phases of a frame decoded, later firmware versions may add phases */
+#define BOOT_TRACE_PHASES_MAX   16U
+/* Boots per analyzed trace */
+#define BOOT_TRACE_BOOTS_MAX    4096U
+/* Time of a phase not reached */
+#define BOOT_TRACE_NONE         0xFFFFFFFFUL
+
+typedef struct
+{
+  uint16_t bootCount;
+  uint8_t resetSource;
+  uint8_t phases;
+  /* Time of each phase from the reset in ms */
+  uint32_t timeMs[BOOT_TRACE_PHASES_MAX];
+} boot_trace_t;
+
+typedef struct
+{
+  unsigned boots;
+  /* Lines which are no boot profile frame */
+  unsigned invalid;
+  unsigned reached[BOOT_TRACE_PHASES_MAX];
+  /* Step from the phase before, over the boots reaching both */
+  double stepP50Ms[BOOT_TRACE_PHASES_MAX];
+  double stepP90Ms[BOOT_TRACE_PHASES_MAX];
+  /* Reset to the first uplink */
+  double uplinkP50Ms;
+  double uplinkP90Ms;
+  double uplinkMaxMs;
+} boot_trace_summary_t;
+
+/* Decodes a boot profile frame, false if it is none. */
+bool boot_trace_decode(const uint8_t *pFrame, size_t len, boot_trace_t *pTrace);
+
+/* Writes a boot profile frame as a line of a trace. */
+void boot_trace_write(FILE *pFile, const uint8_t *pFrame, size_t len);
+
+/* Reads the next boot of a trace. Returns 1 for a boot, 0 at the end and
+   -1 for a line which is no boot profile frame. */
+int boot_trace_read(FILE *pFile, boot_trace_t *pTrace);
+
+/* Analyzes all boots of a trace. */
+void boot_trace_analyze(FILE *pFile, boot_trace_summary_t *pSum);
+
+/* Prints the summary of a trace. */
+void boot_trace_print(const char *pName, const boot_trace_summary_t *pSum);
+
+#endif /* BOOT_TRACE_H */
@@ -0,0 +1,143 @@
+/**
+ @file
+ @brief      Charge model of the energy reports, see energy_model.h.
+*/
+#include <stdlib.h>
+#include <string.h>
+
+#include "sf_frameType.h"
+#include "energy_model.h"
+
+/* Uptime and number of subsystems */
+#define HEADER_LEN         5U
+#define MS_PER_HOUR        3600000.0
+
+const char *const gEnergyModelName[E_SF_ENERGY_MAX] =
+{
+  [E_SF_ENERGY_CPU] = "cpu",
+  [E_SF_ENERGY_ADC] = "adc",
+  [E_SF_ENERGY_RX_BEACON] = "rx_beacon",
+  [E_SF_ENERGY_RX_DOWNLINK] = "rx_downlink",
+  [E_SF_ENERGY_TX_DATA] = "tx_data",
+  [E_SF_ENERGY_FLASH] = "flash",
+};
+
+const energy_currents_t gEnergyModelCc2652r =
+{
+  /* RTC running, full RAM retained */
+  .standbyUa = 0.94,
+  .activeUa =
+  {
+    /* 48 MHz, CoreMark */
+    [E_SF_ENERGY_CPU] = 3400.0,
+    /* Not in the data sheet: reference and converter estimated */
+    [E_SF_ENERGY_ADC] = 600.0,
+    [E_SF_ENERGY_RX_BEACON] = 6900.0,
+    [E_SF_ENERGY_RX_DOWNLINK] = 6900.0,
+    /* 0 dBm */
+    [E_SF_ENERGY_TX_DATA] = 7300.0,
+    /* Not in the data sheet: program and erase estimated */
+    [E_SF_ENERGY_FLASH] = 2600.0,
+  },
+};
+
+bool energy_model_decode(const uint8_t *pFrame, size_t len, energy_report_t *pReport)
+{
+  size_t pos = SF_FRAME_TYPE_LEN;
+  uint8_t i;
+
+  if((len < SF_FRAME_TYPE_LEN + HEADER_LEN) || (E_FRAME_TYPE_ENERGY != pFrame[0]))
+  {
+    return false;
+  }
+
+  memset(pReport, 0, sizeof(*pReport));
+  memcpy(&pReport->uptimeMs, &pFrame[pos], sizeof(pReport->uptimeMs));
+  pos += sizeof(pReport->uptimeMs);
+  pReport->subsystems = pFrame[pos++];
+  if((pReport->subsystems > ENERGY_MODEL_SUBSYSTEMS_MAX) ||
+     (len != pos + pReport->subsystems * sizeof(uint32_t)))
+  {
+    return false;
+  }
+
+  for(i = 0; i < pReport->subsystems; i++)
+  {
+    memcpy(&pReport->timeMs[i], &pFrame[pos], sizeof(uint32_t));
+    pos += sizeof(uint32_t);
+  }
+  return true;
+}
+
+int energy_model_readCurrents(FILE *pFile, energy_currents_t *pCurrents)
+{
+  char line[256];
+  char name[32];
+  char rest[2];
+  double ua;
+  int lineNo = 0;
+  int fields;
+  uint8_t i;
+
+  while(NULL != fgets(line, sizeof(line), pFile))
+  {
+    lineNo++;
+    fields = sscanf(line, " %31s %lf %1s", name, &ua, rest);
+    if((fields < 1) || ('#' == name[0]))
+    {
+      continue;
+    }
+    if((2 != fields) || (ua < 0.0))
+    {
+      return lineNo;
+    }
+
+    if(0 == strcmp(name, "standby"))
+    {
+      pCurrents->standbyUa = ua;
+      continue;
+    }
+    for(i = 0; i < E_SF_ENERGY_MAX; i++)
+    {
+      if(0 == strcmp(name, gEnergyModelName[i]))
+      {
+        pCurrents->activeUa[i] = ua;
+        break;
+      }
+    }
+    if(E_SF_ENERGY_MAX == i)
+    {
+      return lineNo;
+    }
+  }
+  return 0;
+}
+
+double energy_model_chargeUah(const energy_report_t *pFrom,
+                              const energy_report_t *pTo,
+                              const energy_currents_t *pCurrents,
+                              double pUah[E_SF_ENERGY_MAX])
+{
+  /* The times wrap around at 2^32 ms, the differences not */
+  uint32_t ms = pTo->uptimeMs - ((NULL != pFrom) ? pFrom->uptimeMs : 0U);
+  double uah = pCurrents->standbyUa * ms / MS_PER_HOUR;
+  double subsystemUah;
+  uint8_t i;
+
+  for(i = 0; i < E_SF_ENERGY_MAX; i++)
+  {
+    subsystemUah = 0.0;
+    /* Subsystems of a later firmware are not modeled */
+    if(i < pTo->subsystems)
+    {
+      ms = pTo->timeMs[i] - ((NULL != pFrom) ? pFrom->timeMs[i] : 0U);
+      subsystemUah = pCurrents->activeUa[i] * ms / MS_PER_HOUR;
+    }
+    uah += subsystemUah;
+    if(NULL != pUah)
+    {
+      pUah[i] = subsystemUah;
+    }
+  }
+  return uah;
+}
@@ -0,0 +1,69 @@
+/**
+ @file
+ @brief      Charge model of the energy reports of the SCs.
+
+ @details Converts the active times of the subsystems in two energy report
+          frames to the charge drawn from the cell in between, in uAh. The
+          current of each subsystem is taken from a current table, the
+          defaults are those of the CC2652R data sheet at 3.0 V.
+
+          The subsystems overlap, e.g. the CPU runs while the flash is
+          programmed. A current of the table is therefore the one drawn
+          additionally while the subsystem is active. The standby current
+          is drawn over the whole uptime.
+
+          A current table is a text file with one "<subsystem> <uA>" per
+          line, subsystems as in gEnergyModelName. Subsystems not listed
+          keep their current. Empty lines and lines starting with '#' are
+          comments.
+*/
+#ifndef ENERGY_MODEL_H
+#define ENERGY_MODEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "sf_energy.h"
+
+/* Subsystems of a frame decoded, later firmware versions may add some */
+#define ENERGY_MODEL_SUBSYSTEMS_MAX   16U
+
+typedef struct
+{
+  uint32_t uptimeMs;
+  uint8_t subsystems;
+  /* Active time of each subsystem as E_SF_ENERGY_t */
+  uint32_t timeMs[ENERGY_MODEL_SUBSYSTEMS_MAX];
+} energy_report_t;
+
+typedef struct
+{
+  double standbyUa;
+  /* Additional current of each subsystem as E_SF_ENERGY_t */
+  double activeUa[E_SF_ENERGY_MAX];
+} energy_currents_t;
+
+/* Names of the subsystems in a current table */
+extern const char *const gEnergyModelName[E_SF_ENERGY_MAX];
+
+/* Data sheet currents of the CC2652R */
+extern const energy_currents_t gEnergyModelCc2652r;
+
+/* Decodes an energy report frame, false if it is none. */
+bool energy_model_decode(const uint8_t *pFrame, size_t len, energy_report_t *pReport);
+
+/* Reads a current table over the currents given. Returns the line of the
+   first error, 0 if there is none. */
+int energy_model_readCurrents(FILE *pFile, energy_currents_t *pCurrents);
+
+/* Charge between two reports of a boot in uAh, the first report may be NULL
+   for the reset. The charge of each subsystem is returned in pUah if not
+   NULL, the standby charge is not part of it. */
+double energy_model_chargeUah(const energy_report_t *pFrom,
+                              const energy_report_t *pTo,
+                              const energy_currents_t *pCurrents,
+                              double pUah[E_SF_ENERGY_MAX]);
+
+#endif /* ENERGY_MODEL_H */
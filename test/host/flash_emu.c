@@ -0,0 +1,152 @@
+/**
+ @file
+ @brief      RAM emulation of the CC26x2 flash for the host tests.
+*/
+#include <string.h>
+
+#include "flash_interface.h"
+#include "flash_emu.h"
+
+#define FLASH_EMU_PAGE  SF_PERSISTENTDATASTORAGE_PAGE_SIZE
+
+static uint8_t gFlash[FLASH_EMU_SIZE];
+static long gBudget = -1;
+static bool gPowerLost;
+static unsigned long gWrites;
+static unsigned long gTimeUs;
+static unsigned long gErases[FLASH_EMU_PAGES];
+
+/* Count an operation, returns false if the power is lost before it ends. */
+static bool loc_spend(void)
+{
+  if(gBudget < 0)
+  {
+    return true;
+  }
+  if(0 == gBudget)
+  {
+    gPowerLost = true;
+    return false;
+  }
+  gBudget--;
+  return true;
+}
+
+void flash_emu_reset(void)
+{
+  memset(gFlash, 0xFF, sizeof(gFlash));
+  memset(gErases, 0, sizeof(gErases));
+  gBudget = -1;
+  gPowerLost = false;
+  gWrites = 0;
+  gTimeUs = 0;
+}
+
+void flash_emu_powerOn(void)
+{
+  gBudget = -1;
+  gPowerLost = false;
+}
+
+void flash_emu_setBudget(long budget)
+{
+  gBudget = budget;
+}
+
+bool flash_emu_powerLost(void)
+{
+  return gPowerLost;
+}
+
+unsigned long flash_emu_getOps(void)
+{
+  return gWrites + flash_emu_getErases();
+}
+
+unsigned long flash_emu_getWrites(void)
+{
+  return gWrites;
+}
+
+unsigned long flash_emu_getErases(void)
+{
+  unsigned long erases = 0;
+  unsigned page;
+
+  for(page = 0; page < FLASH_EMU_PAGES; page++)
+  {
+    erases += gErases[page];
+  }
+  return erases;
+}
+
+unsigned long flash_emu_getPageErases(uint8_t page)
+{
+  return (page < FLASH_EMU_PAGES) ? gErases[page] : 0;
+}
+
+unsigned long flash_emu_getTimeUs(void)
+{
+  return gTimeUs;
+}
+
+void flash_emu_save(uint8_t *pSnapshot)
+{
+  memcpy(pSnapshot, gFlash, sizeof(gFlash));
+}
+
+void flash_emu_restore(const uint8_t *pSnapshot)
+{
+  memcpy(gFlash, pSnapshot, sizeof(gFlash));
+}
+
+uint8_t readFlash(uint_least32_t addr, uint8_t *pBuf, size_t len)
+{
+  if(gPowerLost || (addr + len > FLASH_EMU_SIZE))
+  {
+    return FLASH_FAILURE;
+  }
+  memcpy(pBuf, &gFlash[addr], len);
+  return FLASH_SUCCESS;
+}
+
+uint8_t writeFlash(uint_least32_t addr, uint8_t *pBuf, size_t len)
+{
+  size_t i;
+
+  if(gPowerLost || (addr + len > FLASH_EMU_SIZE))
+  {
+    return FLASH_FAILURE;
+  }
+  gTimeUs += (len + 3U) / 4U * FLASH_EMU_WORD_US;
+  for(i = 0; i < len; i++)
+  {
+    gWrites++;
+    if(!loc_spend())
+    {
+      /* Cut while programming, only the upper bits made it. */
+      gFlash[addr + i] &= (uint8_t)(pBuf[i] | 0x0F);
+      return FLASH_FAILURE;
+    }
+    gFlash[addr + i] &= pBuf[i];
+  }
+  return FLASH_SUCCESS;
+}
+
+uint8_t eraseFlashPg(uint8_t page)
+{
+  if(gPowerLost || (page >= FLASH_EMU_PAGES))
+  {
+    return FLASH_FAILURE;
+  }
+  gErases[page]++;
+  gTimeUs += FLASH_EMU_ERASE_US;
+  if(!loc_spend())
+  {
+    /* Cut while erasing, the page is only erased in part. */
+    memset(&gFlash[page * FLASH_EMU_PAGE], 0xFF, FLASH_EMU_PAGE / 2);
+    return FLASH_FAILURE;
+  }
+  memset(&gFlash[page * FLASH_EMU_PAGE], 0xFF, FLASH_EMU_PAGE);
+  return FLASH_SUCCESS;
+}
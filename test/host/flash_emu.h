@@ -0,0 +1,56 @@
+/**
+ @file
+ @brief      RAM emulation of the CC26x2 flash for the host tests, behind
+             the TI flash interface.
+
+ @details Programming only clears bits, an erase sets a whole page to 0xFF.
+          The programmed bytes and the erases of every page are counted, the
+          time of the operations is accumulated with the typical values of
+          the CC2652R datasheet.
+
+          A power loss is emulated by a budget of programmed bytes and page
+          erases. When it runs out, the byte being programmed keeps only
+          part of its bits, an erase leaves the second half of the page
+          untouched and all further accesses fail until flash_emu_powerOn().
+*/
+#ifndef FLASH_EMU_H
+#define FLASH_EMU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sf_persistentDataStorage.h"
+
+/* Size of the emulated flash */
+#define FLASH_EMU_SIZE  SF_PERSISTENTDATASTORAGE_FLASH_SIZE
+/* Number of pages */
+#define FLASH_EMU_PAGES (FLASH_EMU_SIZE / SF_PERSISTENTDATASTORAGE_PAGE_SIZE)
+/* Time of a page erase and of programming a word of 4 bytes */
+#define FLASH_EMU_ERASE_US  8000UL
+#define FLASH_EMU_WORD_US   8UL
+/* Erase cycles of a page before failure */
+#define FLASH_EMU_ENDURANCE 30000UL
+
+/* Erase the whole flash, restore the power and clear the counters. */
+void flash_emu_reset(void);
+/* Restore the power after a power loss, keeping the flash content. */
+void flash_emu_powerOn(void);
+/* Lose the power after the given number of programmed bytes and page
+   erases, -1 for never. */
+void flash_emu_setBudget(long budget);
+/* True if the power has been lost. */
+bool flash_emu_powerLost(void);
+/* Number of programmed bytes and page erases since the last reset. */
+unsigned long flash_emu_getOps(void);
+/* Number of programmed bytes since the last reset. */
+unsigned long flash_emu_getWrites(void);
+/* Number of erases of all pages or of one page since the last reset. */
+unsigned long flash_emu_getErases(void);
+unsigned long flash_emu_getPageErases(uint8_t page);
+/* Time spent erasing and programming since the last reset, in us. */
+unsigned long flash_emu_getTimeUs(void);
+/* Copy the flash content to or from a snapshot of FLASH_EMU_SIZE bytes. */
+void flash_emu_save(uint8_t *pSnapshot);
+void flash_emu_restore(const uint8_t *pSnapshot);
+
+#endif /* FLASH_EMU_H */
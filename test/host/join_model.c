@@ -0,0 +1,701 @@
+/**
+ @file
+ @brief      Model of the BMS-CC and of the TSCH links of an SC, see
+             join_model.h.
+*/
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "contiki.h"
+#include "lib/random.h"
+#include "net/nullnet/nullnet.h"
+#include "net/mac/tsch/tsch.h"
+#include "sf-tsch-schedule.h"
+#include "sf_app_api.h"
+#include "sf_beaconScan.h"
+#include "sf_configMgmt.h"
+#include "sf_join.h"
+#include "sf_joinFramer.h"
+#include "sf_joinRequester.h"
+#include "sf_led.h"
+#include "sf_persistentDataStorage.h"
+#include "sf_tsch.h"
+#include "sf_txPower.h"
+#include "join_model.h"
+
+#define SLOT_MS            7.5
+#define SLOTFRAME_MS       JOIN_MODEL_SLOTFRAME_MS
+/* Slot offsets of the join request, join process and device Tx sections */
+#define JREQ_OFFSET        APP_SLOTFRAME_SECTION_BEACON_SLOTS
+#define JPROC_OFFSET       (JREQ_OFFSET + APP_SLOTFRAME_SECTION_JOIN_REQUEST_SLOTS)
+#define DATA_OFFSET        (JPROC_OFFSET + APP_SLOTFRAME_SECTION_JOIN_PROCESS_SLOTS)
+/* Transmissions of E_SF_TSCH_TRAFFIC_JOIN, also used by the BMS-CC */
+#define JOIN_TX            8
+/* Beacon scan: hits of the BMS-CC and SF_BEACON_SCAN_DURATION */
+#define SCAN_FOUND_MIN_MS  3000.0
+#define SCAN_FOUND_MAX_MS  10000.0
+#define SCAN_MS            30000.0
+#define DESYNC_MS          (TSCH_DESYNC_THRESHOLD * 1000.0 / CLOCK_SECOND)
+#define DEVICE_ID          0x0042U
+#define PAN_ID             0xABCDU
+
+int tsch_is_associated;
+struct tsch_asn_t tsch_current_asn;
+linkaddr_t linkaddr_node_addr;
+
+static join_model_cfg_t gCfg;
+static join_model_result_t gRes;
+static double gTimeMs;
+static clock_time_t gNow;
+static linkaddr_t gGwAddr = { { 0x00, 0x01 } };
+/* Any object, the neighbor is only passed back to the fakes */
+static int gNbr;
+
+/* Requester state seen by the model */
+static SF_GONFIGMGMT_DEVICESTATUS_t gStatus;
+static uint8_t gParams[E_CONFIGMGMT_PARAM_MAX][8];
+static sf_persistent_syncContext_t gSyncContext;
+static bool gSyncContextValid;
+static bool gScanFound;
+static bool gJreqSlot;
+static uint8_t gJreqIndex;
+static bool gJprocSlots;
+static bool gDataSlots;
+static uint16_t gChannelOffset;
+static struct etimer gLedTimer;
+/* Start of the listening for the time source, < 0 if not listening */
+static double gListenMs;
+
+/* Scheduled events of the model, < 0 if none */
+static double gAssocAtMs;
+static double gDesyncAtMs;
+static double gReqAtMs;
+static double gRespAtMs;
+static double gSuccAtMs;
+static double gDataAtMs;
+/* Join request in the queue of the device */
+static bool gReqCompact;
+/* Join response in the queue of the BMS-CC */
+static bool gRespCompact;
+static bool gRespDelivered;
+static uint8_t gRespTx;
+/* Join successful frame in the queue of the device */
+static uint8_t gSuccTx;
+
+PROCESS(mac_process, "MAC model");
+
+/*=== Model helpers ==========================================================*/
+static double loc_rand(void)
+{
+  return (double)rand() / ((double)RAND_MAX + 1.0);
+}
+
+static bool loc_air(void)
+{
+  return loc_rand() >= gCfg.loss;
+}
+
+static bool loc_gwOn(double ms)
+{
+  return (ms < gCfg.gwOffMs) || (ms >= gCfg.gwOnMs);
+}
+
+/* Start of the next slot with the offset, after the current time */
+static double loc_nextSlot(unsigned offset)
+{
+  double t = ((unsigned long)(gTimeMs / SLOTFRAME_MS)) * SLOTFRAME_MS +
+             offset * SLOT_MS;
+
+  while(t <= gTimeMs)
+  {
+    t += SLOTFRAME_MS;
+  }
+  return t;
+}
+
+static void loc_radioOn(double startMs, double endMs)
+{
+  if(gRes.radioCount < JOIN_MODEL_RADIO_MAX)
+  {
+    gRes.radioOnMs[gRes.radioCount][0] = startMs;
+    gRes.radioOnMs[gRes.radioCount][1] = endMs;
+    gRes.radioCount++;
+  }
+}
+
+static void loc_stopListen(void)
+{
+  if(gListenMs >= 0.0)
+  {
+    loc_radioOn(gListenMs, gTimeMs);
+    gListenMs = -1.0;
+  }
+}
+
+static void loc_cancelMac(void)
+{
+  gAssocAtMs = -1.0;
+  gDesyncAtMs = -1.0;
+  gReqAtMs = -1.0;
+  gRespAtMs = -1.0;
+  gSuccAtMs = -1.0;
+  gDataAtMs = -1.0;
+}
+
+static void loc_associated(void)
+{
+  tsch_is_associated = 1;
+  gDataAtMs = loc_nextSlot(DATA_OFFSET + DEVICE_ID % 100U);
+  /* Last beacon received before the outage, the synchronization is lost
+     after the desync threshold */
+  if(gTimeMs < gCfg.gwOffMs)
+  {
+    gDesyncAtMs = gCfg.gwOffMs - loc_rand() * SLOTFRAME_MS + DESYNC_MS;
+  }
+}
+
+/*=== Fakes ==================================================================*/
+clock_time_t clock_time(void)
+{
+  return gNow;
+}
+
+unsigned long clock_seconds(void)
+{
+  return gNow / CLOCK_SECOND;
+}
+
+void random_init(unsigned short seed)
+{
+}
+
+unsigned short random_rand(void)
+{
+  return (unsigned short)(rand() >> 8);
+}
+
+void linkaddr_set_node_addr(linkaddr_t *addr)
+{
+  linkaddr_copy(&linkaddr_node_addr, addr);
+}
+
+uint16_t frame802154_get_pan_id(void)
+{
+  return PAN_ID;
+}
+
+void nullnet_enable_single_packet(void)
+{
+}
+
+void nullnet_disable_single_packet(void)
+{
+}
+
+void sf_app_shutDownDevice(void)
+{
+  gRes.shutdown = true;
+}
+
+void sf_txPower_reset(void)
+{
+}
+
+/* Beacon scan, finds the BMS-CC once it is on */
+PT_THREAD(beacon_scan_process(struct pt *pt))
+{
+  static struct etimer scanTimer;
+  double startMs;
+  double endMs;
+
+  PT_BEGIN(pt);
+
+  gRes.scans++;
+  startMs = gTimeMs;
+  endMs = (loc_gwOn(startMs) ? startMs : gCfg.gwOnMs) + SCAN_FOUND_MIN_MS +
+          loc_rand() * (SCAN_FOUND_MAX_MS - SCAN_FOUND_MIN_MS);
+  gScanFound = (endMs <= startMs + SCAN_MS);
+  if(!gScanFound)
+  {
+    endMs = startMs + SCAN_MS;
+  }
+  loc_radioOn(startMs, endMs);
+  etimer_set(&scanTimer, (clock_time_t)((endMs - startMs) * CLOCK_SECOND / 1000.0));
+  PT_WAIT_UNTIL(pt, etimer_expired(&scanTimer));
+
+  PT_END(pt);
+}
+
+void sf_beaconScan_setBeaconType(E_SF_JOIN_BEACON_t beaconType)
+{
+}
+
+linkaddr_t* sf_beaconScan_getBestBeaconAddress(void)
+{
+  return gScanFound ? &gGwAddr : (linkaddr_t *)&linkaddr_null;
+}
+
+void sf_led_startBlink(leds_num_t led, uint16_t onTime, uint16_t offTime)
+{
+}
+
+void sf_led_stopBlink(void)
+{
+}
+
+void sf_led_onDuration(leds_num_t led, uint16_t onTime)
+{
+  etimer_set(&gLedTimer, (clock_time_t)onTime * CLOCK_SECOND / 1000U);
+}
+
+int sf_led_waitUntilOff(void)
+{
+  return etimer_expired(&gLedTimer);
+}
+
+SF_GONFIGMGMT_DEVICESTATUS_t sf_configMgmt_getDeviceStatus(void)
+{
+  return gStatus;
+}
+
+void sf_configMgmt_setDeviceStatus(SF_GONFIGMGMT_DEVICESTATUS_t deviceStatus)
+{
+  if((E_CONFIGMGMT_DEVICESTATUS_CONNECTED == deviceStatus) &&
+     (E_CONFIGMGMT_DEVICESTATUS_CONNECTED != gStatus) && (gRes.connectedMs < 0.0))
+  {
+    gRes.connectedMs = gTimeMs;
+  }
+  gStatus = deviceStatus;
+}
+
+E_SF_RETURN_t sf_configMgmt_setParam(const void* pParamData, size_t paramSize,
+                                     SF_CONFIGMGMT_PARAM_t param)
+{
+  assert(paramSize <= sizeof(gParams[param]));
+  memcpy(gParams[param], pParamData, paramSize);
+  return E_SF_SUCCESS;
+}
+
+E_SF_RETURN_t sf_configMgmt_getParam(void* pParamData, size_t paramSize,
+                                     SF_CONFIGMGMT_PARAM_t param)
+{
+  assert(paramSize <= sizeof(gParams[param]));
+  memcpy(pParamData, gParams[param], paramSize);
+  return E_SF_SUCCESS;
+}
+
+E_SF_RETURN_t sf_configMgmt_writeConfig(void)
+{
+  return E_SF_SUCCESS;
+}
+
+E_SF_RETURN_t sf_persistentDataStorage_readSyncContext(sf_persistent_syncContext_t *pSyncContext)
+{
+  if(!gSyncContextValid)
+  {
+    return E_SF_ERROR;
+  }
+  *pSyncContext = gSyncContext;
+  return E_SF_SUCCESS;
+}
+
+E_SF_RETURN_t sf_persistentDataStorage_writeSyncContext(sf_persistent_syncContext_t *pSyncContext)
+{
+  gSyncContext = *pSyncContext;
+  gSyncContextValid = true;
+  return E_SF_SUCCESS;
+}
+
+joinResponse_t sf_joinFramer_getResponseParams(void)
+{
+  joinResponse_t params = {DEVICE_ID, 1U, false};
+
+  params.compact = gRespCompact;
+  return params;
+}
+
+E_SF_RETURN_t sf_join_request_send(linkaddr_t *pDestinationAddr)
+{
+  assert(gJreqSlot);
+  gRes.requests++;
+  gReqCompact = false;
+  gReqAtMs = loc_nextSlot(JREQ_OFFSET + gJreqIndex);
+  return E_SF_SUCCESS;
+}
+
+E_SF_RETURN_t sf_join_compactRequest_send(linkaddr_t *pDestinationAddr)
+{
+  sf_join_request_send(pDestinationAddr);
+  gReqCompact = true;
+  return E_SF_SUCCESS;
+}
+
+E_SF_RETURN_t sf_join_successful_send(linkaddr_t *pDestinationAddr)
+{
+  gSuccTx = 0;
+  gSuccAtMs = loc_nextSlot(JPROC_OFFSET + 1U);
+  return E_SF_SUCCESS;
+}
+
+void sf_tsch_init(void)
+{
+}
+
+/* The first beacon received associates */
+void sf_tsch_start(void)
+{
+  double frames = 1.0 - loc_rand();
+
+  while(!loc_air())
+  {
+    frames += 1.0;
+  }
+  gListenMs = gTimeMs;
+  gAssocAtMs = (loc_gwOn(gTimeMs) ? gTimeMs : gCfg.gwOnMs) + frames * SLOTFRAME_MS;
+}
+
+/* Leaving the network flushes the queues without Tx callbacks */
+void sf_tsch_stop(void)
+{
+  if(tsch_is_associated)
+  {
+    gRes.leaves++;
+  }
+  tsch_is_associated = 0;
+  loc_stopListen();
+  loc_cancelMac();
+}
+
+E_SF_RETURN_t sf_tsch_addDataSlots(const linkaddr_t* pAddr)
+{
+  gDataSlots = true;
+  return E_SF_SUCCESS;
+}
+
+int sf_tsch_schedule_add_jreq_slot(uint8_t index)
+{
+  gJreqSlot = true;
+  gJreqIndex = index;
+  return 0;
+}
+
+int sf_tsch_schedule_delete_jreq_slots(void)
+{
+  gJreqSlot = false;
+  return 0;
+}
+
+int sf_tsch_schedule_add_jproc_slots(const linkaddr_t* addr)
+{
+  gJprocSlots = true;
+  return 0;
+}
+
+int sf_tsch_schedule_delete_jproc_slots(const linkaddr_t* addr)
+{
+  gJprocSlots = false;
+  return 0;
+}
+
+int sf_tsch_schedule_add_data_slots(const linkaddr_t* addr)
+{
+  gDataSlots = true;
+  return 0;
+}
+
+int sf_tsch_schedule_delete_data_slots(const linkaddr_t* addr)
+{
+  gDataSlots = false;
+  return 0;
+}
+
+int sf_tsch_schedule_set_data_channel_offset(uint16_t channel_offset)
+{
+  gChannelOffset = channel_offset;
+  return 0;
+}
+
+uint16_t sf_tsch_schedule_get_data_channel_offset(void)
+{
+  return gChannelOffset;
+}
+
+uint8_t tsch_get_join_congestion(void)
+{
+  return 0;
+}
+
+int tsch_get_lock(void)
+{
+  return 1;
+}
+
+void tsch_release_lock(void)
+{
+}
+
+struct tsch_neighbor *tsch_queue_get_nbr(const linkaddr_t *addr)
+{
+  return (struct tsch_neighbor *)&gNbr;
+}
+
+struct tsch_neighbor *tsch_queue_get_time_source(void)
+{
+  return (struct tsch_neighbor *)&gNbr;
+}
+
+linkaddr_t *tsch_queue_get_nbr_address(const struct tsch_neighbor *n)
+{
+  return &gGwAddr;
+}
+
+void tsch_queue_backoff_reset(struct tsch_neighbor *n)
+{
+}
+
+void tsch_set_beaconScan_addr(const linkaddr_t *addr)
+{
+}
+
+void tsch_set_static_beacon_channel(uint8_t channel)
+{
+}
+
+uint8_t tsch_get_static_beacon_channel(void)
+{
+  return 15U;
+}
+
+bool tsch_static_beacon_channel_available(void)
+{
+  return tsch_is_associated;
+}
+
+uint32_t tsch_get_internal_absolute_time(void)
+{
+  return 0;
+}
+
+/*=== MAC model ==============================================================*/
+static void loc_macAssociate(void)
+{
+  gAssocAtMs = -1.0;
+  loc_stopListen();
+  loc_associated();
+  /* The requester waits for the association with PROCESS_YIELD_UNTIL */
+  process_post(PROCESS_BROADCAST, PROCESS_EVENT_MSG, NULL);
+}
+
+static void loc_macDesync(void)
+{
+  loc_cancelMac();
+  tsch_is_associated = 0;
+  sf_tsch_leaving_network_callback();
+}
+
+static void loc_macJoinRequest(void)
+{
+  bool received = loc_gwOn(gTimeMs) && loc_air();
+  bool acked = received && loc_air();
+
+  gReqAtMs = -1.0;
+  if(received && (!gReqCompact || gCfg.gwCompact))
+  {
+    /* A new response, also to a repeated request */
+    gRespCompact = gReqCompact;
+    gRespDelivered = false;
+    gRespTx = 0;
+    gRespAtMs = loc_nextSlot(JPROC_OFFSET);
+  }
+  sf_join_output_callback(NULL, acked ? NULLNET_TX_OK : NULLNET_TX_NOACK);
+}
+
+static void loc_macJoinResponse(void)
+{
+  bool received = tsch_is_associated && gJprocSlots && loc_air();
+  bool acked = received && loc_air();
+
+  gRespTx++;
+  gRespAtMs = (!acked && (gRespTx < JOIN_TX)) ? gRespAtMs + SLOTFRAME_MS : -1.0;
+  /* Repeated responses are dropped as duplicates */
+  if(received && !gRespDelivered)
+  {
+    gRespDelivered = true;
+    sf_join_response_receive();
+  }
+}
+
+static void loc_macJoinSuccessful(void)
+{
+  bool acked = gJprocSlots && loc_gwOn(gTimeMs) && loc_air() && loc_air();
+
+  gSuccTx++;
+  if(acked || (gSuccTx >= JOIN_TX))
+  {
+    gSuccAtMs = -1.0;
+    sf_join_output_callback(NULL, acked ? NULLNET_TX_OK : NULLNET_TX_NOACK);
+    return;
+  }
+  gSuccAtMs += SLOTFRAME_MS;
+}
+
+/* One measurement per slotframe, dropped after its cycle */
+static void loc_macData(void)
+{
+  bool acked;
+
+  gDataAtMs += SLOTFRAME_MS;
+  if(!gDataSlots || (E_CONFIGMGMT_DEVICESTATUS_NOT_CONNECTED == gStatus))
+  {
+    return;
+  }
+  acked = (gTimeMs >= gCfg.dataBlockedMs) && loc_gwOn(gTimeMs) &&
+          loc_air() && loc_air();
+  if(acked && (gRes.firstDataMs < 0.0))
+  {
+    gRes.firstDataMs = gTimeMs;
+  }
+  sf_joinRequester_dataTxDone(acked);
+}
+
+/* The TSCH callbacks run in the process context of the MAC */
+PROCESS_THREAD(mac_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  while(1)
+  {
+    PROCESS_WAIT_EVENT_UNTIL(PROCESS_EVENT_CONTINUE == ev);
+    ((void (*)(void))data)();
+  }
+
+  PROCESS_END();
+}
+
+static void loc_dispatch(double *pAtMs, void (*pHandler)(void))
+{
+  if((*pAtMs >= 0.0) && (*pAtMs <= gTimeMs))
+  {
+    process_post_synch(&mac_process, PROCESS_EVENT_CONTINUE, (void *)pHandler);
+  }
+}
+
+static double loc_min(double a, double b)
+{
+  return ((b >= 0.0) && ((a < 0.0) || (b < a))) ? b : a;
+}
+
+/*=== Simulation =============================================================*/
+/* Joined before, the configuration and the sync context are stored */
+static void loc_connect(void)
+{
+  linkaddr_t deviceAddr = { { DEVICE_ID >> 8, DEVICE_ID & 0xFFU } };
+  uint16_t panId = PAN_ID;
+
+  sf_configMgmt_setParam(&panId, sizeof(panId), E_CONFIGMGMT_PARAM_PAN_ID);
+  sf_configMgmt_setParam(deviceAddr.u8, sizeof(deviceAddr.u8),
+                         E_CONFIGMGMT_PARAM_DEVICE_ADDR);
+  sf_configMgmt_setParam(gGwAddr.u8, sizeof(gGwAddr.u8),
+                         E_CONFIGMGMT_PARAM_GW_ADDR);
+  linkaddr_set_node_addr(&deviceAddr);
+  gSyncContext.beaconChannel = tsch_get_static_beacon_channel();
+  memcpy(gSyncContext.timeSourceAddr, gGwAddr.u8, sizeof(gGwAddr.u8));
+  gSyncContext.panId = PAN_ID;
+  gSyncContextValid = true;
+  gStatus = E_CONFIGMGMT_DEVICESTATUS_CONNECTED;
+  gDataSlots = true;
+  loc_associated();
+}
+
+static void loc_run(bool connected, bool withData, double limitMs)
+{
+  double nextMs;
+
+  process_init();
+  process_start(&etimer_process, NULL);
+  ctimer_init();
+  process_start(&mac_process, NULL);
+
+  sf_joinRequester_setCompact(gCfg.compact);
+  if(connected)
+  {
+    loc_connect();
+  }
+  else
+  {
+    sf_joinRequester_join();
+  }
+
+  while((gTimeMs < limitMs) && !gRes.shutdown &&
+        ((gRes.connectedMs < 0.0) || (withData && (gRes.firstDataMs < 0.0))))
+  {
+    while(process_run() > 0)
+    {
+    }
+
+    nextMs = loc_min(loc_min(loc_min(gAssocAtMs, gDesyncAtMs),
+                             loc_min(gReqAtMs, gRespAtMs)),
+                     loc_min(gSuccAtMs, gDataAtMs));
+    if(etimer_pending())
+    {
+      nextMs = loc_min(nextMs, etimer_next_expiration_time() * 1000.0 /
+                               CLOCK_SECOND);
+    }
+    assert(nextMs >= 0.0);
+    if(nextMs > gTimeMs)
+    {
+      gTimeMs = nextMs;
+    }
+    gNow = (clock_time_t)(gTimeMs * CLOCK_SECOND / 1000.0 + 1e-6);
+    if(etimer_pending() &&
+       ((int32_t)(gNow - etimer_next_expiration_time()) >= 0))
+    {
+      etimer_request_poll();
+    }
+
+    loc_dispatch(&gAssocAtMs, loc_macAssociate);
+    loc_dispatch(&gDesyncAtMs, loc_macDesync);
+    loc_dispatch(&gReqAtMs, loc_macJoinRequest);
+    loc_dispatch(&gRespAtMs, loc_macJoinResponse);
+    loc_dispatch(&gSuccAtMs, loc_macJoinSuccessful);
+    loc_dispatch(&gDataAtMs, loc_macData);
+  }
+  loc_stopListen();
+}
+
+void join_model_fork(const join_model_cfg_t *pCfg, unsigned seed,
+                     bool connected, bool withData, double limitMs,
+                     join_model_result_t *pRes)
+{
+  int fd[2];
+  pid_t pid;
+  int status;
+
+  assert(0 == pipe(fd));
+  pid = fork();
+  assert(pid >= 0);
+  if(0 == pid)
+  {
+    close(fd[0]);
+    srand(seed);
+    gCfg = *pCfg;
+    memset(&gRes, 0, sizeof(gRes));
+    gRes.connectedMs = -1.0;
+    gRes.firstDataMs = -1.0;
+    gStatus = E_CONFIGMGMT_DEVICESTATUS_NOT_CONNECTED;
+    memcpy(gParams[E_CONFIGMGMT_PARAM_DEVICE_SERIAL], &seed, sizeof(seed));
+    gListenMs = -1.0;
+    loc_cancelMac();
+    loc_run(connected, withData, limitMs);
+    assert(sizeof(gRes) == write(fd[1], &gRes, sizeof(gRes)));
+    _exit(0);
+  }
+  close(fd[1]);
+  assert(sizeof(*pRes) == read(fd[0], pRes, sizeof(*pRes)));
+  close(fd[0]);
+  assert(pid == waitpid(pid, &status, 0));
+  assert(WIFEXITED(status) && (0 == WEXITSTATUS(status)));
+}
@@ -0,0 +1,78 @@
+/**
+ @file
+ @brief      Model of the BMS-CC and of the TSCH links of an SC, running the
+             join requester unchanged on a simulated clock.
+
+ @details The interfaces used by the join requester are faked. All frames
+          and ACKs are lost at the same rate. The BMS-CC can be off for an
+          outage, the SC loses the synchronization after the desync
+          threshold then.
+
+          Beacon scan: finds the BMS-CC 3 to 10 s after it is on, the scan
+          gives up after 30 s. Association: with the first beacon received
+          after TSCH is started. Join request: sent once in the join request
+          slot of the device. Join response: sent by the BMS-CC in the join
+          process slots to a received request, up to 8 transmissions one
+          slotframe apart, compact requests are ignored without support.
+          Join successful: sent up to 8 times the same way. Measurements:
+          one per slotframe in the data slot, its ACK is reported to the
+          requester.
+
+          The TSCH callbacks run in the context of the MAC process. Each run
+          is forked, the module starts from its initial state.
+*/
+#ifndef JOIN_MODEL_H
+#define JOIN_MODEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "contiki.h"
+
+#define JOIN_MODEL_SLOTFRAME_MS   (APP_SLOTFRAME_SIZE * 7.5)
+/* Radio on intervals recorded per run */
+#define JOIN_MODEL_RADIO_MAX      64U
+
+typedef struct
+{
+  /* Frame and ACK loss rate */
+  double loss;
+  /* The device starts with the compact handshake */
+  bool compact;
+  /* The BMS-CC answers compact requests */
+  bool gwCompact;
+  /* The BMS-CC does not ACK the measurements before this time */
+  double dataBlockedMs;
+  /* The BMS-CC is off from until */
+  double gwOffMs;
+  double gwOnMs;
+} join_model_cfg_t;
+
+typedef struct
+{
+  /* First change to the connected state, < 0 if none */
+  double connectedMs;
+  /* First measurement ACKed, < 0 if none */
+  double firstDataMs;
+  unsigned scans;
+  unsigned requests;
+  /* Networks left on a request of the requester */
+  unsigned leaves;
+  bool shutdown;
+  /* Radio on for a beacon scan or for listening to the time source */
+  unsigned radioCount;
+  double radioOnMs[JOIN_MODEL_RADIO_MAX][2];
+} join_model_result_t;
+
+/* Implemented by the TSCH callbacks of the application */
+void sf_tsch_leaving_network_callback(void);
+
+/* Runs the scenario in a child process. It starts with a connected device
+   if connected is true, with sf_joinRequester_join() otherwise. The run
+   ends once connected, after the first ACKed measurement if withData is
+   true, or after the shutdown or limitMs. */
+void join_model_fork(const join_model_cfg_t *pCfg, unsigned seed,
+                     bool connected, bool withData, double limitMs,
+                     join_model_result_t *pRes);
+
+#endif /* JOIN_MODEL_H */
@@ -0,0 +1,8 @@
+/* Host stub of the platform configuration. The project configuration is
+   included on the command line. */
+#ifndef CONTIKI_CONF_H_STUB
+#define CONTIKI_CONF_H_STUB
+
+#include "contiki.h"
+
+#endif /* CONTIKI_CONF_H_STUB */
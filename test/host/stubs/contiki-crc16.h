@@ -0,0 +1,3 @@
+/* Host stub of the Contiki-NG CRC header, included without its directory by
+   the modules. The one of Contiki-NG is taken. */
+#include "lib/contiki-crc16.h"
@@ -0,0 +1,23 @@
+/* Host stub of the Contiki-NG main header. The platform independent system
+   headers (processes, timers, protothreads) are the ones of Contiki-NG, on
+   the clock of the SC. The tests using them implement clock_time() and
+   clock_seconds(). */
+#ifndef CONTIKI_H_STUB
+#define CONTIKI_H_STUB
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef uint32_t clock_time_t;
+#define CLOCK_CONF_SECOND 128
+#define MAC_CONF_WITH_TSCH 1
+
+#include "sys/process.h"
+#include "sys/timer.h"
+#include "sys/etimer.h"
+#include "sys/ctimer.h"
+#include "sys/rtimer.h"
+#include "sys/clock.h"
+
+#endif /* CONTIKI_H_STUB */
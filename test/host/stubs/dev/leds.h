@@ -0,0 +1,20 @@
+/* Host stub of the Contiki-NG LED HAL. */
+#ifndef LEDS_H_STUB
+#define LEDS_H_STUB
+
+#include <stdint.h>
+
+typedef uint8_t leds_mask_t;
+typedef uint8_t leds_num_t;
+
+#define LEDS_CONF_RED   0
+#define LEDS_CONF_GREEN 1
+
+void leds_on(leds_mask_t leds);
+void leds_off(leds_mask_t leds);
+void leds_toggle(leds_mask_t leds);
+void leds_single_on(leds_num_t led);
+void leds_single_off(leds_num_t led);
+void leds_single_toggle(leds_num_t led);
+
+#endif /* LEDS_H_STUB */
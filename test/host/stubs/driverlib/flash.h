@@ -0,0 +1 @@
+/* Host stub of the TI driverlib flash header, see flash_interface.h. */
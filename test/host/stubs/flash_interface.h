@@ -0,0 +1,15 @@
+/* Host stub of the TI flash interface, implemented by flash_emu.c. */
+#ifndef FLASH_INTERFACE_H_STUB
+#define FLASH_INTERFACE_H_STUB
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FLASH_SUCCESS   0x00
+#define FLASH_FAILURE   0xFF
+
+uint8_t readFlash(uint_least32_t addr, uint8_t *pBuf, size_t len);
+uint8_t writeFlash(uint_least32_t addr, uint8_t *pBuf, size_t len);
+uint8_t eraseFlashPg(uint8_t page);
+
+#endif /* FLASH_INTERFACE_H_STUB */
@@ -0,0 +1,10 @@
+/* Host stub of the IEEE address of the SimpleLink platform, implemented by
+   the tests. */
+#ifndef IEEE_ADDR_H_STUB
+#define IEEE_ADDR_H_STUB
+
+#include <stdint.h>
+
+int ieee_addr_cpy_to(uint8_t *dst, uint8_t len);
+
+#endif /* IEEE_ADDR_H_STUB */
@@ -0,0 +1,5 @@
+/* Host stub of the TI customer configuration. */
+#ifndef HW_CCFG_H_STUB
+#define HW_CCFG_H_STUB
+
+#endif /* HW_CCFG_H_STUB */
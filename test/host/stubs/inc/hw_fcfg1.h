@@ -0,0 +1,13 @@
+/* Host stub of the TI factory configuration. The FCFG1 region is an array
+   of the test. */
+#ifndef HW_FCFG1_H_STUB
+#define HW_FCFG1_H_STUB
+
+#include <stdint.h>
+
+extern uint8_t host_fcfg1[];
+
+#define FCFG1_BASE              ((uintptr_t)host_fcfg1)
+#define FCFG1_O_MAC_15_4_0      0x000002F0
+
+#endif /* HW_FCFG1_H_STUB */
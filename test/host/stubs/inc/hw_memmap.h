@@ -0,0 +1,5 @@
+/* Host stub of the TI memory map, the used regions are in their own stubs. */
+#ifndef HW_MEMMAP_H_STUB
+#define HW_MEMMAP_H_STUB
+
+#endif /* HW_MEMMAP_H_STUB */
@@ -0,0 +1,2 @@
+/* Host stub, some modules include it without path. */
+#include "net/linkaddr.h"
@@ -0,0 +1,33 @@
+/* Host stub of the Contiki-NG link address, 2-byte addresses as on the SC. */
+#ifndef LINKADDR_H_STUB
+#define LINKADDR_H_STUB
+
+#include <stdint.h>
+#include <string.h>
+
+#define LINKADDR_SIZE 2
+
+typedef union {
+  unsigned char u8[LINKADDR_SIZE];
+  uint16_t u16;
+} linkaddr_t;
+
+static const linkaddr_t linkaddr_null = { { 0, 0 } };
+
+/* Implemented by the tests using them. */
+extern linkaddr_t linkaddr_node_addr;
+void linkaddr_set_node_addr(linkaddr_t *addr);
+
+static inline int
+linkaddr_cmp(const linkaddr_t *a, const linkaddr_t *b)
+{
+  return 0 == memcmp(a, b, LINKADDR_SIZE);
+}
+
+static inline void
+linkaddr_copy(linkaddr_t *dest, const linkaddr_t *src)
+{
+  memcpy(dest, src, LINKADDR_SIZE);
+}
+
+#endif /* LINKADDR_H_STUB */
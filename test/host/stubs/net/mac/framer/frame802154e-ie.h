@@ -0,0 +1,14 @@
+/* Host stub of the Contiki-NG 802.15.4e IE framer, the lengths and IE
+   fields used by the modules only. */
+#ifndef FRAME802154E_IE_H_STUB
+#define FRAME802154E_IE_H_STUB
+
+#include <stdint.h>
+
+#define FRAME802154E_IE_ABSOLUTE_TIME_AND_JOIN_MODE_LEN 15
+
+struct ieee802154_ies {
+  uint32_t ie_join_mode;
+};
+
+#endif /* FRAME802154E_IE_H_STUB */
@@ -0,0 +1,20 @@
+/* Host stub of the Contiki-NG 802.15.4 framer, the frame fields used by the
+   modules only. */
+#ifndef FRAMER_802154_H_STUB
+#define FRAMER_802154_H_STUB
+
+#include <stdint.h>
+#include "net/mac/framer/frame802154e-ie.h"
+
+#define FRAME802154_DATAFRAME       (0x01)
+
+typedef struct {
+  uint8_t dest_addr[8];
+  uint8_t src_addr[8];
+  uint16_t dest_pid;
+  uint16_t src_pid;
+} frame802154_t;
+
+uint16_t frame802154_get_pan_id(void);
+
+#endif /* FRAMER_802154_H_STUB */
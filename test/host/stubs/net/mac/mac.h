@@ -0,0 +1,27 @@
+/* Host stub of the Contiki-NG MAC interface: the status codes and the
+   driver structure. */
+#ifndef MAC_H_STUB
+#define MAC_H_STUB
+
+enum {
+  MAC_TX_OK,
+  MAC_TX_COLLISION,
+  MAC_TX_NOACK,
+  MAC_TX_DEFERRED,
+  MAC_TX_ERR,
+  MAC_TX_ERR_FATAL,
+};
+
+typedef void (* mac_callback_t)(void *ptr, int status, int transmissions);
+
+struct mac_driver {
+  char *name;
+  void (* init)(void);
+  void (* send)(mac_callback_t sent_callback, void *ptr);
+  void (* input)(void);
+  int (* on)(void);
+  int (* off)(void);
+  int (* max_payload)(void);
+};
+
+#endif /* MAC_H_STUB */
@@ -0,0 +1,21 @@
+/* Host stub of the Contiki-NG TSCH schedule, implemented by the tests. */
+#ifndef TSCH_SCHEDULE_H_STUB
+#define TSCH_SCHEDULE_H_STUB
+
+#include "net/mac/tsch/tsch.h"
+
+int tsch_schedule_remove_all_slotframes(void);
+struct tsch_slotframe *tsch_schedule_add_slotframe(uint16_t handle, uint16_t size);
+struct tsch_slotframe *tsch_schedule_get_slotframe_by_handle(uint16_t handle);
+struct tsch_link *tsch_schedule_add_link(struct tsch_slotframe *slotframe,
+                                         uint8_t link_options, enum link_type link_type,
+                                         const linkaddr_t *address,
+                                         uint16_t timeslot, uint16_t channel_offset,
+                                         uint8_t do_remove);
+int tsch_schedule_remove_link_by_timeslot(struct tsch_slotframe *slotframe,
+                                          uint16_t timeslot, uint16_t channel_offset);
+struct tsch_link *tsch_schedule_get_link_by_timeslot(struct tsch_slotframe *slotframe,
+                                                     uint16_t timeslot,
+                                                     uint16_t channel_offset);
+
+#endif /* TSCH_SCHEDULE_H_STUB */
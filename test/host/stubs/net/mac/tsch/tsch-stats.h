@@ -0,0 +1,75 @@
+/* Host stub of the Contiki-NG TSCH statistics used by the adaptive channel
+   selection: the channel range, the scaling, the EWMA and the global
+   statistics the tests implement. The defaults of a coordinator built with
+   tsch-cs are the ones of tsch-conf.h. */
+#ifndef TSCH_STATS_H_STUB
+#define TSCH_STATS_H_STUB
+
+#include "contiki.h"
+#include "sys/cc.h"
+
+#if BUILD_WITH_TSCH_CS
+#ifndef TSCH_STATS_CONF_ON
+#define TSCH_STATS_CONF_ON 1
+#endif
+#ifndef TSCH_STATS_CONF_SAMPLE_NOISE_RSSI
+#define TSCH_STATS_CONF_SAMPLE_NOISE_RSSI 1
+#endif
+#ifdef DOT_15_4G_CHAN_MIN
+#ifndef TSCH_STATS_CONF_FIRST_CHANNEL
+#define TSCH_STATS_CONF_FIRST_CHANNEL DOT_15_4G_CHAN_MIN
+#endif
+#ifndef TSCH_STATS_CONF_NUM_CHANNELS
+#define TSCH_STATS_CONF_NUM_CHANNELS (DOT_15_4G_CHAN_MAX - DOT_15_4G_CHAN_MIN + 1)
+#endif
+#endif /* DOT_15_4G_CHAN_MIN */
+#endif /* BUILD_WITH_TSCH_CS */
+
+#ifdef TSCH_STATS_CONF_ON
+#define TSCH_STATS_ON TSCH_STATS_CONF_ON
+#else
+#define TSCH_STATS_ON 0
+#endif
+
+#ifdef TSCH_STATS_CONF_SAMPLE_NOISE_RSSI
+#define TSCH_STATS_SAMPLE_NOISE_RSSI TSCH_STATS_CONF_SAMPLE_NOISE_RSSI
+#else
+#define TSCH_STATS_SAMPLE_NOISE_RSSI 0
+#endif
+
+#define TSCH_STATS_EWMA_UPDATE(x, v) (x) = (((x) * 7 / 8) + (v) / 8)
+
+#ifdef TSCH_STATS_CONF_NUM_CHANNELS
+#define TSCH_STATS_NUM_CHANNELS TSCH_STATS_CONF_NUM_CHANNELS
+#else
+#define TSCH_STATS_NUM_CHANNELS 16
+#endif
+
+#ifdef TSCH_STATS_CONF_FIRST_CHANNEL
+#define TSCH_STATS_FIRST_CHANNEL TSCH_STATS_CONF_FIRST_CHANNEL
+#else
+#define TSCH_STATS_FIRST_CHANNEL 11
+#endif
+
+#define TSCH_STATS_BINARY_SCALING_FACTOR   4096
+#define TSCH_STATS_DEFAULT_CHANNEL_FREE TSCH_STATS_BINARY_SCALING_FACTOR
+
+typedef uint16_t tsch_stat_t;
+
+struct tsch_global_stats {
+#if TSCH_STATS_SAMPLE_NOISE_RSSI
+  tsch_stat_t channel_free_ewma[TSCH_STATS_NUM_CHANNELS];
+#endif /* TSCH_STATS_SAMPLE_NOISE_RSSI */
+};
+
+#if TSCH_STATS_ON
+extern struct tsch_global_stats tsch_stats;
+#endif /* TSCH_STATS_ON */
+
+static inline uint8_t
+tsch_stats_channel_to_index(uint8_t channel)
+{
+  return channel - TSCH_STATS_FIRST_CHANNEL;
+}
+
+#endif /* TSCH_STATS_H_STUB */
@@ -0,0 +1,127 @@
+/* Host stub of the Contiki-NG TSCH interface used by the modules. */
+#ifndef TSCH_H_STUB
+#define TSCH_H_STUB
+
+#include "contiki.h"
+#include "net/linkaddr.h"
+#include "net/packetbuf.h"
+#include "net/mac/mac.h"
+#include "net/mac/framer/framer-802154.h"
+#include "net/mac/tsch/tsch-asn.h"
+#include "net/mac/tsch/tsch-stats.h"
+
+#define LINK_OPTION_TX              1
+#define LINK_OPTION_RX              2
+#define LINK_OPTION_SHARED          4
+#define LINK_OPTION_TIME_KEEPING    8
+
+enum link_type { LINK_TYPE_NORMAL, LINK_TYPE_NORMAL_RTX, LINK_TYPE_ADVERTISING,
+                 LINK_TYPE_ADVERTISING_ONLY };
+
+struct tsch_link {
+  linkaddr_t addr;
+  uint16_t slotframe_handle;
+  uint16_t timeslot;
+  uint16_t channel_offset;
+  uint8_t link_options;
+  enum link_type link_type;
+};
+
+struct tsch_slotframe {
+  uint16_t handle;
+  struct tsch_asn_divisor_t size;
+};
+
+extern const linkaddr_t tsch_broadcast_address;
+
+#ifndef TSCH_CONF_RX_WAIT
+#define TSCH_CONF_RX_WAIT 2200
+#endif
+
+enum tsch_timeslot_timing_elements {
+  tsch_ts_cca_offset,
+  tsch_ts_cca,
+  tsch_ts_tx_offset,
+  tsch_ts_rx_offset,
+  tsch_ts_rx_ack_delay,
+  tsch_ts_tx_ack_delay,
+  tsch_ts_rx_wait,
+  tsch_ts_ack_wait,
+  tsch_ts_rx_tx,
+  tsch_ts_max_ack,
+  tsch_ts_max_tx,
+  tsch_ts_timeslot_length,
+  tsch_ts_elements_count,
+};
+
+typedef uint16_t tsch_timeslot_timing_usec[tsch_ts_elements_count];
+
+#ifdef TSCH_CONF_DESYNC_THRESHOLD
+#define TSCH_DESYNC_THRESHOLD TSCH_CONF_DESYNC_THRESHOLD
+#else
+#define TSCH_DESYNC_THRESHOLD (2 * 60 * CLOCK_SECOND)
+#endif
+
+#define TSCH_PACKET_MAX_LEN PACKETBUF_SIZE
+
+#ifndef TSCH_CONF_HOPPING_MIN_LEN
+#define TSCH_HOPPING_MIN_LEN 4
+#else
+#define TSCH_HOPPING_MIN_LEN TSCH_CONF_HOPPING_MIN_LEN
+#endif
+
+struct input_packet {
+  uint8_t payload[TSCH_PACKET_MAX_LEN];
+  int len;
+};
+
+struct tsch_neighbor;
+
+extern int tsch_is_associated;
+extern int tsch_is_coordinator;
+extern uint8_t tsch_timeslot_id;
+extern const uint8_t *default_tsch_hopping_sequence;
+extern uint16_t default_tsch_hopping_sequence_length;
+extern tsch_timeslot_timing_usec tsch_timing_us;
+extern struct tsch_asn_t tsch_current_asn;
+/* Slot being operated */
+extern struct tsch_link *current_link;
+extern uint8_t tsch_current_channel;
+extern uint8_t tsch_current_channel_offset;
+extern int tsch_current_burst_count;
+
+int32_t tsch_adaptive_timesync_get_drift(void);
+int tsch_adaptive_timesync_is_converged(void);
+void tsch_adaptive_timesync_set_initial_drift(int32_t drift);
+
+int tsch_packet_parse_eb(const uint8_t *buf, int buf_size,
+                         frame802154_t *frame, struct ieee802154_ies *ies,
+                         uint8_t *hdrlen, int frame_without_mic);
+void tsch_scan_enable(void);
+void tsch_scan_disable(void);
+void tsch_set_coordinator(int enable);
+void tsch_set_static_beacon_channel(uint8_t channel);
+void tsch_set_beaconScan_addr(const linkaddr_t *addr);
+uint8_t tsch_get_static_beacon_channel(void);
+bool tsch_static_beacon_channel_available(void);
+uint32_t tsch_get_internal_absolute_time(void);
+uint8_t tsch_get_join_congestion(void);
+
+int tsch_schedule_hopping_blacklist(uint16_t blacklist, const struct tsch_asn_t *asn);
+int tsch_get_hopping_blacklist(uint16_t *blacklist, uint16_t *next_blacklist,
+                               struct tsch_asn_t *asn);
+
+int tsch_get_lock(void);
+void tsch_release_lock(void);
+
+struct tsch_neighbor *tsch_queue_get_nbr(const linkaddr_t *addr);
+struct tsch_neighbor *tsch_queue_get_time_source(void);
+linkaddr_t *tsch_queue_get_nbr_address(const struct tsch_neighbor *n);
+void tsch_queue_backoff_reset(struct tsch_neighbor *n);
+int tsch_queue_global_packet_peak(void);
+
+#include "net/mac/tsch/tsch-schedule.h"
+/* The per-slot log of Contiki-NG */
+#include "net/mac/tsch/tsch-log.h"
+
+#endif /* TSCH_H_STUB */
@@ -0,0 +1,25 @@
+/* Host stub of the Contiki-NG network stack. The radio, MAC and network
+   drivers are implemented by the tests using them. */
+#ifndef NETSTACK_H_STUB
+#define NETSTACK_H_STUB
+
+#include "dev/radio.h"
+#include "net/linkaddr.h"
+#include "net/mac/mac.h"
+
+struct network_driver {
+  char *name;
+  void (*init)(void);
+  void (*input)(void);
+  uint8_t (*output)(const linkaddr_t *localdest, void *ptr, const uint8_t frameType);
+};
+
+extern const struct radio_driver host_radio_driver;
+extern const struct mac_driver host_mac_driver;
+extern const struct network_driver host_network_driver;
+
+#define NETSTACK_RADIO   host_radio_driver
+#define NETSTACK_MAC     host_mac_driver
+#define NETSTACK_NETWORK host_network_driver
+
+#endif /* NETSTACK_H_STUB */
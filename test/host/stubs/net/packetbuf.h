@@ -0,0 +1,24 @@
+/* Host stub of the Contiki-NG packet buffer, the attributes used by the
+   tested modules. The tests using them implement the accessors. */
+#ifndef PACKETBUF_H_STUB
+#define PACKETBUF_H_STUB
+
+#include <stdint.h>
+
+#include "net/linkaddr.h"
+
+#define PACKETBUF_SIZE 127
+
+typedef uint16_t packetbuf_attr_t;
+
+enum {
+  PACKETBUF_ATTR_RSSI,
+  PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS,
+  PACKETBUF_ATTR_MAC_TTL,
+  PACKETBUF_NUM_ATTRS
+};
+
+int packetbuf_set_attr(uint8_t type, const packetbuf_attr_t val);
+packetbuf_attr_t packetbuf_attr(uint8_t type);
+
+#endif /* PACKETBUF_H_STUB */
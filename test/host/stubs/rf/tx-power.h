@@ -0,0 +1,16 @@
+/* Host stub of the SimpleLink RF Tx power table, the power of the entries
+   only. The tests using it define the table. */
+#ifndef TX_POWER_H_STUB
+#define TX_POWER_H_STUB
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct {
+  int8_t power;
+} tx_power_table_t;
+
+extern tx_power_table_t *const rf_tx_power_table;
+extern const size_t rf_tx_power_table_size;
+
+#endif /* TX_POWER_H_STUB */
@@ -0,0 +1,13 @@
+/* Host stub of the energy estimation. The tests of the energy accounting
+   build with -DHOST_ENERGEST=1 and take the one of Contiki-NG. */
+#if HOST_ENERGEST
+#include_next "sys/energest.h"
+#else
+#ifndef ENERGEST_H_STUB
+#define ENERGEST_H_STUB
+
+#define ENERGEST_ON(type)
+#define ENERGEST_OFF(type)
+
+#endif /* ENERGEST_H_STUB */
+#endif /* HOST_ENERGEST */
@@ -0,0 +1,14 @@
+/* Host stub of the Contiki-NG master interrupt control. The tests
+   simulating an interrupt implement it, e.g. by blocking the signal that
+   stands for the interrupt. */
+#ifndef INT_MASTER_H_STUB
+#define INT_MASTER_H_STUB
+
+#include <stdint.h>
+
+typedef uint32_t int_master_status_t;
+
+int_master_status_t int_master_read_and_disable(void);
+void int_master_status_set(int_master_status_t status);
+
+#endif /* INT_MASTER_H_STUB */
@@ -0,0 +1,33 @@
+/* Host stub of the Contiki-NG log, the messages are dropped. The arguments
+   are still evaluated by a call without format checking, since the types
+   of the target differ from the host ones, e.g. int32_t is long there. */
+#ifndef LOG_H_STUB
+#define LOG_H_STUB
+
+#include "net/linkaddr.h"
+
+#define LOG_LEVEL_NONE         0
+#define LOG_LEVEL_ERR          1
+#define LOG_LEVEL_WARN         2
+#define LOG_LEVEL_INFO         3
+#define LOG_LEVEL_DBG          4
+
+static inline void log_stub(const char *fmt, ...) { (void)fmt; }
+
+#define LOG_ERR(...)           log_stub(__VA_ARGS__)
+#define LOG_WARN(...)          log_stub(__VA_ARGS__)
+#define LOG_INFO(...)          log_stub(__VA_ARGS__)
+#define LOG_DBG(...)           log_stub(__VA_ARGS__)
+#define LOG_ERR_(...)          log_stub(__VA_ARGS__)
+#define LOG_WARN_(...)         log_stub(__VA_ARGS__)
+#define LOG_INFO_(...)         log_stub(__VA_ARGS__)
+#define LOG_DBG_(...)          log_stub(__VA_ARGS__)
+#define LOG_ERR_LLADDR(a)      (void)(a)
+#define LOG_WARN_LLADDR(a)     (void)(a)
+#define LOG_INFO_LLADDR(a)     (void)(a)
+#define LOG_DBG_LLADDR(a)      (void)(a)
+
+/* Implemented by the tests using it. */
+void log_lladdr_compact(const linkaddr_t *lladdr);
+
+#endif /* LOG_H_STUB */
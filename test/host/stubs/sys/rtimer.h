@@ -0,0 +1,17 @@
+/* Host stub of the Contiki-NG rtimer. One tick is one microsecond, the
+   tests using RTIMER_NOW() implement rtimer_arch_now(). */
+#ifndef RTIMER_H_STUB
+#define RTIMER_H_STUB
+
+#include <stdint.h>
+
+typedef uint32_t rtimer_clock_t;
+
+#define RTIMER_SECOND          1000000UL
+#define RTIMER_NOW()           rtimer_arch_now()
+#define RTIMERTICKS_TO_US(t)   (t)
+#define US_TO_RTIMERTICKS(us)  (us)
+
+rtimer_clock_t rtimer_arch_now(void);
+
+#endif /* RTIMER_H_STUB */
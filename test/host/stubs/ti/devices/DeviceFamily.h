@@ -0,0 +1,7 @@
+/* Host stub of the TI device family header. */
+#ifndef DEVICEFAMILY_H_STUB
+#define DEVICEFAMILY_H_STUB
+
+#define DeviceFamily_constructPath(x) <x>
+
+#endif /* DEVICEFAMILY_H_STUB */
@@ -0,0 +1 @@
+#include "net/mac/tsch/tsch.h"
@@ -0,0 +1,7 @@
+/* Host stub of the Contiki-NG watchdog. */
+#ifndef WATCHDOG_H_STUB
+#define WATCHDOG_H_STUB
+
+static inline void watchdog_periodic(void) {}
+
+#endif /* WATCHDOG_H_STUB */
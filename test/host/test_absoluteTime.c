@@ -0,0 +1,170 @@
+/**
+ @file
+ @brief      Host test of the network time derived from the ASN.
+
+ @details The conversion between the ASN and the absolute time is checked
+          across the wrap of the lower 32 bits of the ASN and beyond 2^31
+          slots. A node then follows the absolute time of the beacons of a
+          coordinator, whose time is exact at every slot, across the ASN
+          wrap and a restart of the network ASN. Its estimate must stay
+          within the beacon second and converge to the coordinator time.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "net/mac/tsch/tsch-absolute-time.h"
+
+#define TIMESLOT_US      7500U
+#define MAX_DRIFT_MS     2000U
+
+static uint64_t loc_asn64(const struct tsch_asn_t *pAsn)
+{
+  return ((uint64_t)pAsn->ms1b << 32) | pAsn->ls4b;
+}
+
+static struct tsch_asn_t loc_asn(uint64_t asn)
+{
+  struct tsch_asn_t a;
+
+  TSCH_ASN_INIT(a, (uint8_t)(asn >> 32), (uint32_t)asn);
+  return a;
+}
+
+static void test_conversion(void)
+{
+  struct tsch_at_anchor anchor;
+  struct tsch_asn_t asn;
+
+  /* Across the wrap of the lower 32 bits */
+  anchor.ms = 1000000U;
+  anchor.asn = loc_asn(0xFFFFFF00ULL);
+  asn = loc_asn(0x100000100ULL);
+  assert(0x200 == tsch_at_asn_diff(&asn, &anchor.asn));
+  assert(-0x200 == tsch_at_asn_diff(&anchor.asn, &asn));
+  assert(1000000U + 0x200 * TIMESLOT_US / 1000U == tsch_at_to_ms(&anchor, &asn, 0, TIMESLOT_US));
+
+  /* Beyond 2^31 slots, where a 32-bit difference turns negative */
+  asn = anchor.asn;
+  TSCH_ASN_INC(asn, 0x80000000UL);
+  TSCH_ASN_INC(asn, 0x80000000UL);
+  TSCH_ASN_INC(asn, 10);
+  assert(0x10000000AULL == (uint64_t)tsch_at_asn_diff(&asn, &anchor.asn));
+  assert(1000000U + 0x10000000AULL * TIMESLOT_US / 1000U ==
+         tsch_at_to_ms(&anchor, &asn, 0, TIMESLOT_US));
+
+  /* Offsets within and before the slot round towards the past */
+  asn = anchor.asn;
+  assert(1000000U + 2U == tsch_at_to_ms(&anchor, &asn, 2999, TIMESLOT_US));
+  assert(1000000U - 1U == tsch_at_to_ms(&anchor, &asn, -1, TIMESLOT_US));
+  assert(1000000U - 1U == tsch_at_to_ms(&anchor, &asn, -1000, TIMESLOT_US));
+  assert(1000000U - 2U == tsch_at_to_ms(&anchor, &asn, -1001, TIMESLOT_US));
+  TSCH_ASN_DEC(asn, 1);
+  assert(1000000U - 8U == tsch_at_to_ms(&anchor, &asn, 0, TIMESLOT_US));
+}
+
+static void test_resync(void)
+{
+  struct tsch_at_anchor anchor = { 0 };
+  struct tsch_asn_t asn = loc_asn(1000);
+  int64_t adjust;
+
+  assert(TSCH_AT_SET == tsch_at_resync(&anchor, 100, &asn, TIMESLOT_US,
+                                       MAX_DRIFT_MS, &adjust));
+  assert((100000U == anchor.ms) && (1000U == loc_asn64(&anchor.asn)));
+
+  /* 100 slots later the estimate is 100.750 s, within [100 s, 101 s) */
+  asn = loc_asn(1100);
+  assert(TSCH_AT_UNCHANGED == tsch_at_resync(&anchor, 100, &asn, TIMESLOT_US,
+                                             MAX_DRIFT_MS, &adjust));
+  assert((0 == adjust) && (1000U == loc_asn64(&anchor.asn)));
+
+  /* The beacon says 101 s: moved forward by 250 ms */
+  assert(TSCH_AT_ADJUSTED == tsch_at_resync(&anchor, 101, &asn, TIMESLOT_US,
+                                            MAX_DRIFT_MS, &adjust));
+  assert((250 == adjust) && (101000U == anchor.ms));
+
+  /* The beacon says 100 s: moved back to its last ms */
+  assert(TSCH_AT_ADJUSTED == tsch_at_resync(&anchor, 100, &asn, TIMESLOT_US,
+                                            MAX_DRIFT_MS, &adjust));
+  assert((-1 == adjust) && (100999U == anchor.ms));
+
+  /* Beyond the max drift */
+  assert(TSCH_AT_RESET == tsch_at_resync(&anchor, 200, &asn, TIMESLOT_US,
+                                         MAX_DRIFT_MS, NULL));
+  assert(200000U == anchor.ms);
+}
+
+/* Follows the beacons of a coordinator over nSlots slots from firstAsn.
+   Returns the largest error once converged, i.e. after the first second. */
+static uint64_t loc_follow(struct tsch_at_anchor *pAnchor, uint64_t t0Us,
+                           uint64_t firstAsn, uint64_t nSlots, int *pResets)
+{
+  uint64_t a;
+  uint64_t trueMs;
+  uint64_t estimate;
+  uint64_t errMax = 0;
+  uint64_t prevEstimate = 0;
+  struct tsch_asn_t asn;
+
+  for(a = firstAsn; a < firstAsn + nSlots; a += 1U + rand() % 400)
+  {
+    /* Time of the coordinator at the start of the slot of the EB */
+    trueMs = (t0Us + (a - firstAsn) * TIMESLOT_US) / 1000U;
+    asn = loc_asn(a);
+    if(TSCH_AT_RESET == tsch_at_resync(pAnchor, (uint32_t)(trueMs / 1000U),
+                                       &asn, TIMESLOT_US, MAX_DRIFT_MS, NULL))
+    {
+      (*pResets)++;
+    }
+
+    /* Within the beacon second, never ahead of the coordinator */
+    estimate = tsch_at_to_ms(pAnchor, &asn, 0, TIMESLOT_US);
+    assert(estimate <= trueMs);
+    assert(trueMs - estimate < 1000U);
+    /* Never backwards between beacons */
+    assert(estimate >= prevEstimate);
+    prevEstimate = estimate;
+    if((a - firstAsn) * TIMESLOT_US > 1000000U * 60U)
+    {
+      errMax = (trueMs - estimate > errMax) ? trueMs - estimate : errMax;
+    }
+  }
+  return errMax;
+}
+
+static void test_follow(void)
+{
+  struct tsch_at_anchor anchor = { 0 };
+  /* One hour of slots, starting 10 minutes before the wrap of the lower
+     32 bits of the ASN */
+  const uint64_t nSlots = 3600ULL * 1000000U / TIMESLOT_US;
+  const uint64_t firstAsn = 0xFFFFFFFFULL - 600ULL * 1000000U / TIMESLOT_US;
+  const uint64_t t0Us = 1700000000ULL * 1000000U + 123456U;
+  uint64_t errMax;
+  int resets = 0;
+
+  srand(1);
+  errMax = loc_follow(&anchor, t0Us, firstAsn, nSlots, &resets);
+  assert(0 == resets);
+  assert(errMax < 2U * TIMESLOT_US / 1000U);
+  printf("across the ASN wrap: error %u ms after 1 min\n", (unsigned)errMax);
+
+  /* The coordinator restarts the network with ASN 0 half an hour later, the
+     anchor on the old ASN lies far off and is reset once. */
+  errMax = loc_follow(&anchor, t0Us + 5400ULL * 1000000U, 0U, nSlots, &resets);
+  assert(1 == resets);
+  assert(errMax < 2U * TIMESLOT_US / 1000U);
+  printf("after an ASN restart: error %u ms after 1 min, %d reset\n",
+         (unsigned)errMax, resets);
+}
+
+int main(void)
+{
+  test_conversion();
+  test_resync();
+  test_follow();
+
+  printf("test_absoluteTime: OK\n");
+  return 0;
+}
@@ -0,0 +1,794 @@
+/**
+ @file
+ @brief      Host replay harness of the beacon scan and simulation of the
+             time from a reboot to the first uplink.
+
+ @details The beacon scan runs unchanged as protothread of a Contiki-NG
+          process on a simulated clock, with the link quality cache it
+          rates the sources with. The radio is a fake replaying a beacon
+          trace: a beacon is received if the radio is on and tuned to its
+          channel when it is sent. A trace is a list of beacons, each with
+          the time in ms since the scan start, channel, source address, PAN
+          ID, RSSI at the receiver and join flag. It is either read from a
+          file given as argument, one beacon per line in this order, or
+          generated: every source sends a beacon per slotframe in its beacon
+          slot, on the join channel of the ASN. The beacons are lost on the
+          air or below the sensitivity, the RSSI varies around the mean of
+          the source.
+
+          Reported per scenario: time to decision, radio on time and the
+          missed best beacon rate. The best beacon is the stored BMS-CC on a
+          rejoin and the join beacon source with the highest mean RSSI on a
+          manual join. The full scan of SF_BEACON_SCAN_DURATION is the
+          reference.
+
+          The time from a reboot to the first uplink is compared for the
+          rejoin with and without the stored sync context. Without, the
+          beacon scan runs and TSCH then associates on the first beacon of
+          the chosen source on its channel. With, TSCH listens for the
+          stored time source on the stored beacon channel for
+          SF_JOIN_WARM_LISTEN_TIME and falls back to the beacon scan. The
+          first uplink is sent in the next data slot of the cell after the
+          association. The fallback is simulated with a BMS-CC silent for
+          the first 20 s.
+*/
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/mac/tsch/tsch.h"
+#include "sys/int-master.h"
+#include "sf_beaconScan.h"
+#include "sf_configMgmt.h"
+#include "sf_linkQuality.h"
+
+#define TIMESLOT_MS        7.5
+#define CYCLE_MS           (APP_SLOTFRAME_SIZE * TIMESLOT_MS)
+/* Duration of a generated trace, longer than any scan */
+#define TRACE_MS           70000.0
+#define TRACE_LEN_MAX      1024
+/* Full scan duration of the module, without an early exit */
+#define FULL_SCAN_MS       30000.0
+/* Beacons lost on the air, sensitivity and RSSI spread in dB */
+#define AIR_LOSS           0.10
+#define SENSITIVITY        (-97)
+#define RSSI_SPREAD        3.0
+/* Number of beacons the radio buffers */
+#define RADIO_QUEUE_LEN    4
+/* Generated runs per scenario */
+#define RUNS               500
+/* Sources of a scenario */
+#define SOURCES_MAX        5
+/* Warm start listen time of the rejoin */
+#define WARM_LISTEN_MS     15000.0
+/* Stored network of a rejoin */
+#define PAN_ID             0xABCD
+#define GW_ADDR            0x0001
+
+PT_THREAD(beacon_scan_process(struct pt *pt));
+
+/* A beacon of the trace */
+typedef struct
+{
+  double ms;
+  uint8_t channel;
+  uint16_t src;
+  uint16_t pan;
+  int8_t rssi;
+  uint8_t join;
+} beacon_t;
+
+/* A beacon source of a generated trace */
+typedef struct
+{
+  uint16_t src;
+  uint16_t pan;
+  uint8_t join;
+  double rssi;
+  uint16_t slot;
+} source_t;
+
+/* Result of a scenario */
+typedef struct
+{
+  double decisionMs[RUNS];
+  double radioOnMs;
+  unsigned runs;
+  unsigned missed;
+  /* Decisions for a source more than RSSI_SPREAD below the best */
+  unsigned missedFar;
+  unsigned noDecision;
+} result_t;
+
+sf_deviceConfig_t gDeviceConfig;
+
+static const uint8_t gJoinChannels[] = { 18, 11, 22 };
+
+static double gNowMs;
+static double gRadioOnMs;
+static bool gRadioOn;
+static uint8_t gChannel;
+
+static beacon_t gTrace[TRACE_LEN_MAX];
+static unsigned gTraceLen;
+static unsigned gTraceIdx;
+static double gTraceStartMs;
+
+static beacon_t gRadioQueue[RADIO_QUEUE_LEN];
+static unsigned gRadioQueueLen;
+static int gLastRssi;
+
+static linkaddr_t gScanAddr;
+static uint8_t gStaticChannel;
+static bool gScanDone;
+
+/*=== Fakes ==================================================================*/
+clock_time_t clock_time(void)
+{
+  return (clock_time_t)(gNowMs * CLOCK_SECOND / 1000.0);
+}
+
+unsigned long clock_seconds(void)
+{
+  return (unsigned long)(gNowMs / 1000.0);
+}
+
+/* No interrupts are simulated. */
+int_master_status_t int_master_read_and_disable(void)
+{
+  return 0U;
+}
+
+void int_master_status_set(int_master_status_t status)
+{
+  (void)status;
+}
+
+void tsch_scan_disable(void)
+{
+}
+
+void tsch_set_static_beacon_channel(uint8_t channel)
+{
+  gStaticChannel = channel;
+}
+
+void tsch_set_beaconScan_addr(const linkaddr_t *addr)
+{
+  linkaddr_copy(&gScanAddr, addr);
+}
+
+/* The fake radio delivers the beacons as source, PAN ID and join flag. */
+int tsch_packet_parse_eb(const uint8_t *buf, int buf_size,
+                         frame802154_t *frame, struct ieee802154_ies *ies,
+                         uint8_t *hdrlen, int frame_without_mic)
+{
+  (void)frame_without_mic;
+  if(buf_size != 5)
+  {
+    return 0;
+  }
+  memset(frame, 0, sizeof(*frame));
+  frame->src_addr[0] = buf[0];
+  frame->src_addr[1] = buf[1];
+  frame->src_pid = (uint16_t)(buf[2] | (buf[3] << 8));
+  ies->ie_join_mode = buf[4];
+  *hdrlen = 0;
+  return 1;
+}
+
+static int loc_radioInit(void)
+{
+  gRadioQueueLen = 0;
+  return 1;
+}
+
+static int loc_radioRead(void *buf, unsigned short buf_len)
+{
+  uint8_t *pBuf = buf;
+  beacon_t b;
+
+  if((0U == gRadioQueueLen) || (buf_len < 5U))
+  {
+    return 0;
+  }
+  b = gRadioQueue[0];
+  memmove(&gRadioQueue[0], &gRadioQueue[1], --gRadioQueueLen * sizeof(b));
+  memcpy(pBuf, &b.src, 2);
+  pBuf[2] = (uint8_t)b.pan;
+  pBuf[3] = (uint8_t)(b.pan >> 8);
+  pBuf[4] = b.join;
+  gLastRssi = b.rssi;
+  return 5;
+}
+
+static int loc_radioPending(void)
+{
+  return (int)gRadioQueueLen;
+}
+
+static int loc_radioOn(void)
+{
+  gRadioOn = true;
+  return 1;
+}
+
+static int loc_radioOff(void)
+{
+  gRadioOn = false;
+  return 1;
+}
+
+static radio_result_t loc_radioGet(radio_param_t param, radio_value_t *value)
+{
+  if(RADIO_PARAM_LAST_RSSI == param)
+  {
+    *value = gLastRssi;
+    return RADIO_RESULT_OK;
+  }
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+
+static radio_result_t loc_radioSet(radio_param_t param, radio_value_t value)
+{
+  if(RADIO_PARAM_CHANNEL == param)
+  {
+    gChannel = (uint8_t)value;
+    return RADIO_RESULT_OK;
+  }
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+
+const struct radio_driver host_radio_driver = {
+  .init = loc_radioInit,
+  .read = loc_radioRead,
+  .pending_packet = loc_radioPending,
+  .on = loc_radioOn,
+  .off = loc_radioOff,
+  .get_value = loc_radioGet,
+  .set_value = loc_radioSet,
+};
+
+static int loc_macOff(void)
+{
+  return 1;
+}
+
+const struct mac_driver host_mac_driver = {
+  .on = loc_macOff,
+  .off = loc_macOff,
+};
+
+/*=== Replay =================================================================*/
+PROCESS(scan_process, "Beacon scan replay");
+
+PROCESS_THREAD(scan_process, ev, data)
+{
+  static struct pt scanPt;
+
+  PROCESS_BEGIN();
+  PROCESS_PT_SPAWN(&scanPt, beacon_scan_process(&scanPt));
+  gScanDone = true;
+  PROCESS_END();
+}
+
+/* Advances by one clock tick, the radio hears the beacons sent meanwhile. */
+static void loc_tick(void)
+{
+  double nextMs = gNowMs + 1000.0 / CLOCK_SECOND;
+  const beacon_t *pB;
+
+  while((gTraceIdx < gTraceLen) &&
+        (gTraceStartMs + gTrace[gTraceIdx].ms <= nextMs))
+  {
+    pB = &gTrace[gTraceIdx++];
+    if(gRadioOn && (pB->channel == gChannel) &&
+       (gRadioQueueLen < RADIO_QUEUE_LEN))
+    {
+      gRadioQueue[gRadioQueueLen++] = *pB;
+    }
+  }
+  if(gRadioOn)
+  {
+    gRadioOnMs += nextMs - gNowMs;
+  }
+  gNowMs = nextMs;
+
+  if(etimer_pending() &&
+     ((int32_t)(clock_time() - etimer_next_expiration_time()) >= 0))
+  {
+    etimer_request_poll();
+  }
+  while(process_run() > 0)
+  {
+  }
+}
+
+/* Replays the trace from the given time on, returns the time to decision
+   in ms. */
+static double loc_replay(E_SF_JOIN_BEACON_t type, double fromMs)
+{
+  gTraceIdx = 0;
+  while((gTraceIdx < gTraceLen) && (gTrace[gTraceIdx].ms < fromMs))
+  {
+    gTraceIdx++;
+  }
+  gTraceStartMs = gNowMs - fromMs;
+  gRadioOnMs = 0.0;
+  gScanDone = false;
+  sf_beaconScan_setBeaconType(type);
+  process_start(&scan_process, NULL);
+  while(!gScanDone)
+  {
+    loc_tick();
+    assert(gNowMs - gTraceStartMs - fromMs < FULL_SCAN_MS + 1000.0);
+  }
+  linkaddr_copy(&gScanAddr, sf_beaconScan_getBestBeaconAddress());
+  return gNowMs - gTraceStartMs - fromMs;
+}
+
+/*=== Trace generation =======================================================*/
+static double loc_rand(void)
+{
+  return (double)rand() / RAND_MAX;
+}
+
+static double loc_gauss(void)
+{
+  return sqrt(-2.0 * log(loc_rand() + 1e-12)) * cos(2.0 * M_PI * loc_rand());
+}
+
+static int loc_cmpBeacon(const void *a, const void *b)
+{
+  double d = ((const beacon_t *)a)->ms - ((const beacon_t *)b)->ms;
+
+  return (d > 0.0) - (d < 0.0);
+}
+
+/* Generates the beacons heard from the sources, from the given ASN on. */
+static void loc_generate(const source_t *pSources, unsigned numSources,
+                         uint32_t asn)
+{
+  unsigned i;
+  uint32_t cycle;
+  double ms;
+  double rssi;
+  beacon_t *pB;
+
+  gTraceLen = 0;
+  for(i = 0; i < numSources; i++)
+  {
+    for(cycle = 0; ; cycle++)
+    {
+      ms = (cycle * APP_SLOTFRAME_SIZE + pSources[i].slot) * TIMESLOT_MS;
+      if(ms >= TRACE_MS)
+      {
+        break;
+      }
+      rssi = pSources[i].rssi + RSSI_SPREAD * loc_gauss();
+      if((rssi < SENSITIVITY) || (loc_rand() < AIR_LOSS))
+      {
+        continue;
+      }
+      assert(gTraceLen < TRACE_LEN_MAX);
+      pB = &gTrace[gTraceLen++];
+      pB->ms = ms;
+      pB->channel = gJoinChannels[(asn + cycle * APP_SLOTFRAME_SIZE +
+                                   pSources[i].slot) % sizeof(gJoinChannels)];
+      pB->src = pSources[i].src;
+      pB->pan = pSources[i].pan;
+      pB->rssi = (int8_t)lround(rssi);
+      pB->join = pSources[i].join;
+    }
+  }
+  qsort(gTrace, gTraceLen, sizeof(gTrace[0]), loc_cmpBeacon);
+}
+
+/* Draws the sources of a run, the best one first. The neighbouring packs
+   are in other networks. */
+static void loc_drawSources(E_SF_JOIN_BEACON_t type, source_t *pSources,
+                            unsigned *pNum, uint16_t firstAddr)
+{
+  unsigned i;
+  unsigned best = 0;
+  source_t tmp;
+
+  *pNum = 1U + (unsigned)(rand() % SOURCES_MAX);
+  for(i = 0; i < *pNum; i++)
+  {
+    pSources[i].src = (uint16_t)(firstAddr + i);
+    pSources[i].pan = (uint16_t)(PAN_ID + 1U + i);
+    pSources[i].join = (uint8_t)type;
+    pSources[i].rssi = -92.0 + 42.0 * loc_rand();
+    pSources[i].slot = (uint16_t)(rand() % APP_SLOTFRAME_SIZE);
+    if(E_SF_JOIN_BEACON_ENABLED == type)
+    {
+      /* Some packs around are not in the join mode. */
+      if((0U != i) && (0 == rand() % 3))
+      {
+        pSources[i].join = E_SF_JOIN_BEACON_DISABLED;
+      }
+      else if(pSources[i].rssi > pSources[best].rssi)
+      {
+        best = i;
+      }
+    }
+  }
+
+  if(E_SF_JOIN_BEACON_DISABLED == type)
+  {
+    /* The first one is the stored BMS-CC */
+    pSources[0].src = GW_ADDR;
+    pSources[0].pan = PAN_ID;
+  }
+  else
+  {
+    tmp = pSources[0];
+    pSources[0] = pSources[best];
+    pSources[best] = tmp;
+  }
+}
+
+/*=== Scenarios ==============================================================*/
+static int loc_cmpDouble(const void *a, const void *b)
+{
+  double d = *(const double *)a - *(const double *)b;
+
+  return (d > 0.0) - (d < 0.0);
+}
+
+/* Decision of the scan without an early exit, as reference: every channel
+   in turn for 5 s, the source with the highest RSSI average wins. */
+static uint16_t loc_fullScanDecision(E_SF_JOIN_BEACON_t type,
+                                     const source_t *pSources,
+                                     unsigned numSources)
+{
+  double avg[SOURCES_MAX];
+  bool heard[SOURCES_MAX] = { false };
+  const beacon_t *pB;
+  uint16_t decided = 0;
+  double bestAvg = -1000.0;
+  unsigned i, j;
+
+  for(i = 0; (i < gTraceLen) && (gTrace[i].ms < FULL_SCAN_MS); i++)
+  {
+    pB = &gTrace[i];
+    if((pB->channel != gJoinChannels[(unsigned)(pB->ms / 5000.0) %
+                                     sizeof(gJoinChannels)]) ||
+       (pB->join != type) ||
+       ((E_SF_JOIN_BEACON_DISABLED == type) &&
+        ((GW_ADDR != pB->src) || (PAN_ID != pB->pan))))
+    {
+      continue;
+    }
+    for(j = 0; j < numSources; j++)
+    {
+      if(pSources[j].src == pB->src)
+      {
+        /* EWMA of 1/8 as the link quality cache */
+        avg[j] = heard[j] ? avg[j] + (pB->rssi - avg[j]) / 8.0 : pB->rssi;
+        heard[j] = true;
+      }
+    }
+  }
+  for(j = 0; j < numSources; j++)
+  {
+    if(heard[j] && (avg[j] > bestAvg))
+    {
+      bestAvg = avg[j];
+      decided = pSources[j].src;
+    }
+  }
+  return decided;
+}
+
+static void loc_record(result_t *pRes, double ms, double radioOnMs,
+                       uint16_t decided, const source_t *pSources,
+                       unsigned numSources)
+{
+  unsigned i;
+  double decidedRssi = -1000.0;
+  uint16_t best = pSources[0].src;
+
+  for(i = 0; i < numSources; i++)
+  {
+    if(pSources[i].src == decided)
+    {
+      decidedRssi = pSources[i].rssi;
+    }
+  }
+  pRes->decisionMs[pRes->runs++] = ms;
+  pRes->radioOnMs += radioOnMs;
+  if(0U == decided)
+  {
+    pRes->noDecision++;
+  }
+  if(decided != best)
+  {
+    pRes->missed++;
+    if(decidedRssi < pSources[0].rssi - RSSI_SPREAD)
+    {
+      pRes->missedFar++;
+    }
+  }
+}
+
+static void loc_report(const char *pName, result_t *pRes)
+{
+  double sum = 0.0;
+  unsigned i;
+
+  qsort(pRes->decisionMs, pRes->runs, sizeof(double), loc_cmpDouble);
+  for(i = 0; i < pRes->runs; i++)
+  {
+    sum += pRes->decisionMs[i];
+  }
+  printf("%s: time to decision mean %.1f s, p95 %.1f s, radio on %.1f s, "
+         "missed best beacon %.1f %% (%.1f %% by more than %.0f dB), "
+         "no beacon %.1f %%\n",
+         pName, sum / pRes->runs / 1000.0,
+         pRes->decisionMs[pRes->runs * 95U / 100U] / 1000.0,
+         pRes->radioOnMs / pRes->runs / 1000.0,
+         100.0 * pRes->missed / pRes->runs,
+         100.0 * pRes->missedFar / pRes->runs, RSSI_SPREAD,
+         100.0 * pRes->noDecision / pRes->runs);
+}
+
+/* Scans with independent sources, and a second time right after each on
+   the same sources with the cached result. The reference is the full scan
+   of the first traces. */
+static void loc_scenario(E_SF_JOIN_BEACON_t type, result_t *pFirst,
+                         result_t *pCached, result_t *pFull)
+{
+  double ms;
+  source_t sources[SOURCES_MAX];
+  unsigned num;
+  unsigned run;
+  uint32_t asn;
+
+  memset(pFirst, 0, sizeof(*pFirst));
+  memset(pCached, 0, sizeof(*pCached));
+  memset(pFull, 0, sizeof(*pFull));
+  for(run = 0; run < RUNS; run++)
+  {
+    /* Let the cached result of the previous run expire. */
+    gNowMs += 11.0 * 60.0 * 1000.0;
+    loc_drawSources(type, sources, &num, (uint16_t)(0x100U + run * 8U));
+    asn = (uint32_t)rand();
+    loc_generate(sources, num, asn);
+    loc_record(pFull, FULL_SCAN_MS, FULL_SCAN_MS,
+               loc_fullScanDecision(type, sources, num), sources, num);
+    ms = loc_replay(type, 0.0);
+    loc_record(pFirst, ms, gRadioOnMs, gScanAddr.u16, sources, num);
+
+    gNowMs += 1000.0;
+    loc_generate(sources, num, asn + (uint32_t)(gNowMs / TIMESLOT_MS));
+    ms = loc_replay(type, 0.0);
+    loc_record(pCached, ms, gRadioOnMs, gScanAddr.u16, sources, num);
+  }
+}
+
+/*=== Reboot to first uplink =================================================*/
+/* Returns the time of the first beacon of the source on the channel from
+   the given time on, a negative time if there is none. */
+static double loc_nextBeacon(uint16_t src, uint8_t channel, double fromMs)
+{
+  unsigned i;
+
+  for(i = 0; i < gTraceLen; i++)
+  {
+    if((gTrace[i].ms >= fromMs) && (gTrace[i].src == src) &&
+       (gTrace[i].channel == channel))
+    {
+      return gTrace[i].ms;
+    }
+  }
+  return -1.0;
+}
+
+/* Removes the beacons of the source sent before the given time. */
+static void loc_silence(uint16_t src, double untilMs)
+{
+  unsigned i;
+  unsigned len = 0;
+
+  for(i = 0; i < gTraceLen; i++)
+  {
+    if((gTrace[i].src != src) || (gTrace[i].ms >= untilMs))
+    {
+      gTrace[len++] = gTrace[i];
+    }
+  }
+  gTraceLen = len;
+}
+
+/* Rejoins after a reboot at the trace start, as rejoin_process, with or
+   without the stored beacon channel. Returns the time of the first uplink,
+   negative if not synchronized within the trace. */
+static double loc_rejoin(bool warm, uint8_t storedChannel, double dataSlotMs)
+{
+  double fromMs = 0.0;
+  double syncMs = -1.0;
+
+  if(warm)
+  {
+    syncMs = loc_nextBeacon(GW_ADDR, storedChannel, 0.0);
+    if(syncMs >= WARM_LISTEN_MS)
+    {
+      syncMs = -1.0;
+    }
+    if(syncMs < 0.0)
+    {
+      fromMs = WARM_LISTEN_MS;
+    }
+  }
+
+  if(syncMs < 0.0)
+  {
+    fromMs += loc_replay(E_SF_JOIN_BEACON_DISABLED, fromMs);
+    if(GW_ADDR != gScanAddr.u16)
+    {
+      return -1.0;
+    }
+    syncMs = loc_nextBeacon(GW_ADDR, gStaticChannel, fromMs);
+    if(syncMs < 0.0)
+    {
+      return -1.0;
+    }
+  }
+
+  /* Next data slot of the cell */
+  return syncMs + fmod(dataSlotMs - fmod(syncMs, CYCLE_MS) + CYCLE_MS, CYCLE_MS);
+}
+
+static void loc_reportUplink(const char *pName, result_t *pRes)
+{
+  double sum = 0.0;
+  unsigned i;
+
+  qsort(pRes->decisionMs, pRes->runs, sizeof(double), loc_cmpDouble);
+  for(i = 0; i < pRes->runs; i++)
+  {
+    sum += pRes->decisionMs[i];
+  }
+  printf("%s: reboot to first uplink mean %.1f s, p95 %.1f s, "
+         "not synchronized %u of %u\n", pName, sum / pRes->runs / 1000.0,
+         pRes->decisionMs[pRes->runs * 95U / 100U] / 1000.0,
+         pRes->noDecision, pRes->runs + pRes->noDecision);
+}
+
+static void loc_recordUplink(result_t *pRes, double ms)
+{
+  if(ms < 0.0)
+  {
+    pRes->noDecision++;
+  }
+  else
+  {
+    pRes->decisionMs[pRes->runs++] = ms;
+  }
+}
+
+/* Reboots with the stored BMS-CC silent for the given time. */
+static void loc_reboot(double silentMs, result_t *pCold, result_t *pWarm)
+{
+  source_t sources[SOURCES_MAX];
+  unsigned num;
+  unsigned run;
+  uint8_t storedChannel;
+  double dataSlotMs;
+
+  memset(pCold, 0, sizeof(*pCold));
+  memset(pWarm, 0, sizeof(*pWarm));
+  for(run = 0; run < RUNS; run++)
+  {
+    loc_drawSources(E_SF_JOIN_BEACON_DISABLED, sources, &num,
+                    (uint16_t)(0x100U + run * 8U));
+    loc_generate(sources, num, (uint32_t)rand());
+    loc_silence(GW_ADDR, silentMs);
+    /* Channel of the beacon of the last association */
+    storedChannel = gJoinChannels[rand() % sizeof(gJoinChannels)];
+    dataSlotMs = CYCLE_MS * loc_rand();
+
+    gNowMs += 11.0 * 60.0 * 1000.0;
+    loc_recordUplink(pCold, loc_rejoin(false, storedChannel, dataSlotMs));
+    gNowMs += 11.0 * 60.0 * 1000.0;
+    loc_recordUplink(pWarm, loc_rejoin(true, storedChannel, dataSlotMs));
+  }
+}
+
+/* Replays a recorded trace file: ms channel src pan rssi join */
+static void loc_replayFile(const char *pPath, E_SF_JOIN_BEACON_t type)
+{
+  FILE *pFile = fopen(pPath, "r");
+  beacon_t *pB;
+  unsigned channel, src, pan, join;
+  int rssi;
+  double ms;
+
+  assert(NULL != pFile);
+  gTraceLen = 0;
+  while((gTraceLen < TRACE_LEN_MAX) &&
+        (6 == fscanf(pFile, "%lf %u %x %x %d %u", &ms, &channel, &src, &pan,
+                     &rssi, &join)))
+  {
+    pB = &gTrace[gTraceLen++];
+    pB->ms = ms;
+    pB->channel = (uint8_t)channel;
+    pB->src = (uint16_t)src;
+    pB->pan = (uint16_t)pan;
+    pB->rssi = (int8_t)rssi;
+    pB->join = (uint8_t)join;
+  }
+  fclose(pFile);
+  qsort(gTrace, gTraceLen, sizeof(gTrace[0]), loc_cmpBeacon);
+
+  ms = loc_replay(type, 0.0);
+  printf("%s: %u beacons, decision after %.1f s, radio on %.1f s: %04X\n",
+         pPath, gTraceLen, ms / 1000.0, gRadioOnMs / 1000.0, gScanAddr.u16);
+}
+
+static void test_noBeacon(void)
+{
+  gNowMs += 11.0 * 60.0 * 1000.0;
+  gTraceLen = 0;
+  assert(fabs(loc_replay(E_SF_JOIN_BEACON_DISABLED, 0.0) - FULL_SCAN_MS) < 100.0);
+  assert(linkaddr_cmp(&gScanAddr, &linkaddr_null));
+}
+
+int main(int argc, char *argv[])
+{
+  static result_t first;
+  static result_t cached;
+  static result_t full;
+
+  gDeviceConfig.bmsccAddr.u16 = GW_ADDR;
+  gDeviceConfig.panId = PAN_ID;
+  srand(1);
+  process_init();
+  process_start(&etimer_process, NULL);
+
+  if(argc > 1)
+  {
+    /* Manual join unless a second argument selects the rejoin */
+    loc_replayFile(argv[1], (argc > 2) ? E_SF_JOIN_BEACON_DISABLED :
+                                         E_SF_JOIN_BEACON_ENABLED);
+    return 0;
+  }
+
+  test_noBeacon();
+
+  loc_scenario(E_SF_JOIN_BEACON_DISABLED, &first, &cached, &full);
+  loc_report("rejoin, full scan", &full);
+  loc_report("rejoin", &first);
+  loc_report("rejoin, cached channel", &cached);
+  assert(first.missed <= full.missed + first.runs / 100U);
+  assert(cached.missed <= full.missed + cached.runs / 100U);
+  assert(first.decisionMs[first.runs / 2U] < FULL_SCAN_MS / 2.0);
+
+  loc_scenario(E_SF_JOIN_BEACON_ENABLED, &first, &cached, &full);
+  loc_report("manual join, full scan", &full);
+  loc_report("manual join", &first);
+  loc_report("manual join, cached channel", &cached);
+  assert(first.missedFar <= full.missedFar + first.runs / 50U);
+  assert(first.decisionMs[first.runs / 2U] < FULL_SCAN_MS);
+
+  loc_reboot(0.0, &first, &cached);
+  loc_reportUplink("reboot, scan", &first);
+  loc_reportUplink("reboot, sync context", &cached);
+  assert(cached.decisionMs[cached.runs / 2U] * 2.0 < first.decisionMs[first.runs / 2U]);
+
+  loc_reboot(20000.0, &first, &cached);
+  loc_reportUplink("reboot, BMS-CC silent 20 s, scan", &first);
+  loc_reportUplink("reboot, BMS-CC silent 20 s, sync context", &cached);
+  assert(cached.decisionMs[cached.runs / 2U] <
+         first.decisionMs[first.runs / 2U] + WARM_LISTEN_MS);
+  assert(cached.noDecision < first.noDecision);
+
+  printf("test_beaconScan: OK\n");
+  return 0;
+}
@@ -0,0 +1,292 @@
+/**
+ @file
+ @brief      Host test of the boot phase profiler and replay of boot traces
+             with and without the deferred platform init.
+
+ @details The profiler runs unchanged on the Contiki-NG processes with a
+          fake rtimer. Each boot passes the phases of the application with
+          modeled durations. Its boot profile frame is written to a trace
+          and the trace is read back by the analyzer of boot_trace.h.
+
+          Modeled is the former boot, with the 4 LED fades of the platform
+          and the console written blocking, and the fast boot deferring
+          both until the first uplink. A fade is the loop of fade() in
+          platform.c at 48 MHz, a log line 50 characters at 115200 Bd. The
+          logs written while waiting for the radio, i.e. during the
+          association and the wait for the data slot, delay nothing.
+
+          Reported per boot: the analysis of both traces.
+*/
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "sf_bootProfile.h"
+#include "sf_frameType.h"
+#include "boot_trace.h"
+
+#define BOOTS              500U
+#define FADES              4U
+#define FADE_MS            47.0
+#define LOG_LINE_MS        (50.0 * 10.0 / 115.2)
+#define SLOTFRAME_MS       (APP_SLOTFRAME_SIZE * 7.5)
+/* Report of all phases */
+#define REPORT_LEN         (4U + E_SF_BOOTPROFILE_PHASE_MAX * 4U)
+#define RESET_SOURCE       2U
+
+typedef struct
+{
+  /* Duration of the phase from the phase before */
+  double minMs;
+  double maxMs;
+  /* Log lines written blocking within the phase */
+  unsigned logLines;
+} phase_model_t;
+
+static const phase_model_t gModel[E_SF_BOOTPROFILE_PHASE_MAX] =
+{
+  /* Platform init from the reset */
+  [E_SF_BOOTPROFILE_PHASE_APP_START] = {10.0, 20.0, 6},
+  /* RF core and region */
+  [E_SF_BOOTPROFILE_PHASE_RF_READY] = {25.0, 35.0, 5},
+  [E_SF_BOOTPROFILE_PHASE_CONFIG_READY] = {1.0, 3.0, 8},
+  [E_SF_BOOTPROFILE_PHASE_JOIN_START] = {0.5, 1.5, 3},
+  /* Warm start listening for the time source */
+  [E_SF_BOOTPROFILE_PHASE_ASSOCIATED] = {300.0, 3000.0, 0},
+  [E_SF_BOOTPROFILE_PHASE_CONNECTED] = {1.0, 10.0, 3},
+  /* Data slot and ACK of the first measurement */
+  [E_SF_BOOTPROFILE_PHASE_FIRST_UPLINK] = {0.0, SLOTFRAME_MS, 0},
+};
+
+static rtimer_clock_t gNowUs;
+static unsigned gEvents;
+
+PROCESS(app_process, "Application");
+
+/*=== Fakes ==================================================================*/
+rtimer_clock_t rtimer_arch_now(void)
+{
+  return gNowUs;
+}
+
+clock_time_t clock_time(void)
+{
+  return 0;
+}
+
+/*=== Helpers ================================================================*/
+PROCESS_THREAD(app_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  while(1)
+  {
+    PROCESS_WAIT_EVENT_UNTIL(sf_bootProfile_event == ev);
+    assert(sf_bootProfile_isReached(E_SF_BOOTPROFILE_PHASE_FIRST_UPLINK));
+    gEvents++;
+  }
+
+  PROCESS_END();
+}
+
+static double loc_rand(void)
+{
+  return (double)rand() / ((double)RAND_MAX + 1.0);
+}
+
+static void loc_run(void)
+{
+  while(process_run() > 0)
+  {
+  }
+}
+
+/* Advance by the modeled duration of a phase, returns its time in ms. */
+static uint32_t loc_advance(E_SF_BOOTPROFILE_PHASE_t phase, bool deferred)
+{
+  const phase_model_t *pModel = &gModel[phase];
+  double ms = pModel->minMs + (pModel->maxMs - pModel->minMs) * loc_rand();
+
+  if(!deferred)
+  {
+    ms += pModel->logLines * LOG_LINE_MS;
+    ms += (E_SF_BOOTPROFILE_PHASE_APP_START == phase) ? FADES * FADE_MS : 0.0;
+  }
+  gNowUs += (rtimer_clock_t)(ms * 1000.0);
+  return (uint32_t)((uint64_t)gNowUs * 1000U / RTIMER_SECOND);
+}
+
+/* One boot up to the delivered report, its frame is written to the trace. */
+static void loc_boot(bool deferred, FILE *pTrace, boot_trace_t *pExpected)
+{
+  uint8_t frame[SF_FRAME_TYPE_LEN + REPORT_LEN + 8];
+  unsigned events = gEvents;
+  uint8_t len;
+  uint8_t phase;
+
+  gNowUs = 0;
+  memset(pExpected, 0, sizeof(*pExpected));
+  pExpected->timeMs[E_SF_BOOTPROFILE_PHASE_APP_START] =
+    loc_advance(E_SF_BOOTPROFILE_PHASE_APP_START, deferred);
+  PROCESS_CONTEXT_BEGIN(&app_process);
+  sf_bootProfile_init(RESET_SOURCE);
+  PROCESS_CONTEXT_END(&app_process);
+
+  for(phase = E_SF_BOOTPROFILE_PHASE_RF_READY;
+      phase < E_SF_BOOTPROFILE_PHASE_MAX; phase++)
+  {
+    assert(!sf_bootProfile_isReached(phase));
+    assert(!sf_bootProfile_isReportPending());
+    pExpected->timeMs[phase] = loc_advance(phase, deferred);
+    if(E_SF_BOOTPROFILE_PHASE_ASSOCIATED == phase)
+    {
+      /* From the TSCH process */
+      sf_bootProfile_joiningNetworkCallback();
+    }
+    else
+    {
+      sf_bootProfile_mark(phase);
+    }
+    loc_run();
+    assert(sf_bootProfile_isReached(phase));
+  }
+  /* One event on the first uplink only */
+  assert(events + 1U == gEvents);
+
+  /* Only the first time of a phase is kept */
+  gNowUs += 1000000U;
+  sf_bootProfile_mark(E_SF_BOOTPROFILE_PHASE_FIRST_UPLINK);
+  loc_run();
+  assert(events + 1U == gEvents);
+
+  assert(sf_bootProfile_isReportPending());
+  frame[0] = E_FRAME_TYPE_BOOT_PROFILE;
+  assert(0 == sf_bootProfile_getReport(&frame[SF_FRAME_TYPE_LEN], REPORT_LEN - 1U));
+  len = sf_bootProfile_getReport(&frame[SF_FRAME_TYPE_LEN],
+                                 sizeof(frame) - SF_FRAME_TYPE_LEN);
+  assert(REPORT_LEN == len);
+  boot_trace_write(pTrace, frame, SF_FRAME_TYPE_LEN + len);
+
+  /* Sent again until delivered */
+  assert(sf_bootProfile_isReportPending());
+  sf_bootProfile_setReported();
+  assert(!sf_bootProfile_isReportPending());
+  assert(0 == sf_bootProfile_getReport(&frame[SF_FRAME_TYPE_LEN],
+                                       sizeof(frame) - SF_FRAME_TYPE_LEN));
+
+  pExpected->resetSource = RESET_SOURCE;
+  pExpected->phases = E_SF_BOOTPROFILE_PHASE_MAX;
+}
+
+/*=== Tests ==================================================================*/
+/* The boots are read back as they were profiled, the boot count is kept
+   over the resets. */
+static void test_replay(bool deferred, boot_trace_summary_t *pSum)
+{
+  static boot_trace_t expected[BOOTS];
+  boot_trace_t trace;
+  uint16_t firstBoot = 0;
+  FILE *pTrace = tmpfile();
+  unsigned b;
+
+  assert(NULL != pTrace);
+  srand(1);
+  for(b = 0; b < BOOTS; b++)
+  {
+    loc_boot(deferred, pTrace, &expected[b]);
+  }
+
+  rewind(pTrace);
+  for(b = 0; b < BOOTS; b++)
+  {
+    assert(1 == boot_trace_read(pTrace, &trace));
+    firstBoot = (0U == b) ? trace.bootCount : firstBoot;
+    expected[b].bootCount = (uint16_t)(firstBoot + b);
+    assert(0 == memcmp(&expected[b], &trace, sizeof(trace)));
+  }
+  assert(0 == boot_trace_read(pTrace, &trace));
+
+  rewind(pTrace);
+  boot_trace_analyze(pTrace, pSum);
+  fclose(pTrace);
+  assert(BOOTS == pSum->boots);
+  assert(0U == pSum->invalid);
+}
+
+/* UART log lines, comments, phases not reached and lines which are no
+   boot profile frame. */
+static void test_format(void)
+{
+  static const char trace[] =
+    "# boot profile trace\n"
+    "\n"
+    "[INFO: Meas Sender] Boot profile report is transmitted to the BMS-CC; "
+    "0a070002" "07" "05000000" "28000000" "2a000000" "2b000000"
+    "ffffffff" "ffffffff" "ffffffff\n"
+    "0a07000207050000\n"
+    "0b0700020105000000\n"
+    "0a07000201zz000000\n"
+    "0a0800020100000000\n";
+  boot_trace_summary_t sum;
+  boot_trace_t boot;
+  FILE *pTrace = tmpfile();
+
+  assert(NULL != pTrace);
+  fputs(trace, pTrace);
+
+  rewind(pTrace);
+  assert(1 == boot_trace_read(pTrace, &boot));
+  assert((7 == boot.bootCount) && (2 == boot.resetSource) && (7 == boot.phases));
+  assert((5 == boot.timeMs[0]) && (43 == boot.timeMs[3]));
+  assert(BOOT_TRACE_NONE == boot.timeMs[E_SF_BOOTPROFILE_PHASE_FIRST_UPLINK]);
+  /* Truncated, other frame type and no hex */
+  assert(-1 == boot_trace_read(pTrace, &boot));
+  assert(-1 == boot_trace_read(pTrace, &boot));
+  assert(-1 == boot_trace_read(pTrace, &boot));
+  /* One phase of a later firmware */
+  assert(1 == boot_trace_read(pTrace, &boot));
+  assert((8 == boot.bootCount) && (1 == boot.phases) && (0 == boot.timeMs[0]));
+  assert(0 == boot_trace_read(pTrace, &boot));
+
+  rewind(pTrace);
+  boot_trace_analyze(pTrace, &sum);
+  fclose(pTrace);
+  assert((2U == sum.boots) && (3U == sum.invalid));
+  assert((2U == sum.reached[0]) && (1U == sum.reached[3]));
+  assert(0U == sum.reached[E_SF_BOOTPROFILE_PHASE_FIRST_UPLINK]);
+  assert((35.0 == sum.stepP50Ms[1]) && (1.0 == sum.stepP50Ms[3]));
+}
+
+int main(void)
+{
+  boot_trace_summary_t former;
+  boot_trace_summary_t fast;
+  double savedMs;
+
+  /* Keep the report of the runs before a failed assertion */
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  process_init();
+  process_start(&app_process, NULL);
+
+  test_format();
+  test_replay(false, &former);
+  test_replay(true, &fast);
+  boot_trace_print("former boot", &former);
+  boot_trace_print("fast boot", &fast);
+
+  /* The same boots without the fades and the console */
+  savedMs = FADES * FADE_MS;
+  printf("first uplink %.1f ms earlier (p50)\n", former.uplinkP50Ms - fast.uplinkP50Ms);
+  assert(former.uplinkP50Ms - fast.uplinkP50Ms >= savedMs);
+  /* Equal up to the rounding to ms */
+  assert(fabs(former.stepP50Ms[E_SF_BOOTPROFILE_PHASE_ASSOCIATED] -
+              fast.stepP50Ms[E_SF_BOOTPROFILE_PHASE_ASSOCIATED]) <= 1.0);
+  assert(fast.stepP90Ms[E_SF_BOOTPROFILE_PHASE_FIRST_UPLINK] <= SLOTFRAME_MS);
+
+  printf("test_bootProfile: OK\n");
+  return 0;
+}
@@ -0,0 +1,429 @@
+/**
+ @file
+ @brief      Host test of the configuration registry, its TLV persistence
+             and the migration of the configuration of previous firmware
+             versions.
+
+ @details The module runs unchanged on flash_emu. The configurations of
+          the previous firmware versions are planted through the flash
+          interface in their formats: the structure without channel offset,
+          the fixed structure and the log of fixed structures over both
+          configuration pages. Each is migrated to the TLV encoding, also
+          with the power cut at every programmed byte and page erase of the
+          migration.
+
+          The microbenchmark compares the typed inline accessors to
+          sf_configMgmt_getParam for the parameters read per measurement
+          cycle and per received beacon.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "flash_interface.h"
+#include "contiki-crc16.h"
+#include "inc/hw_fcfg1.h"
+#include "sf_persistentDataStorage.h"
+#include "sf_configMgmt.h"
+#include "flash_emu.h"
+
+/* Version of the TLV encoding of the module, SF_CONFIGMGMT_TLV_VERSION */
+#define TLV_VERSION        1
+/* Configuration pages, FLASH_SIZE - 2 and - 5 pages */
+#define CONFIG_ADDR        (FLASH_EMU_SIZE - 2U * SF_PERSISTENTDATASTORAGE_PAGE_SIZE)
+#define CONFIG_ADDR2       (FLASH_EMU_SIZE - 5U * SF_PERSISTENTDATASTORAGE_PAGE_SIZE)
+/* Flags of the previous formats */
+#define FLAG_V1            0xB0
+#define FLAG_FIXED         0xB1
+#define FLAG_LOG           0xB2
+/* CRC protected length of the structure without channel offset */
+#define V1_LEN             offsetof(sf_persistent_deviceConfig_t, channelOffset)
+/* Accessor calls per benchmark run and runs, the fastest run counts */
+#define BENCH_CALLS        10000000UL
+#define BENCH_RUNS         5
+
+/*! Record of the configuration log of fixed structures. */
+PACKED_STRUCT(typedef struct
+{
+  uint8_t flag;
+  uint8_t reserved;
+  uint16_t seq;
+  sf_persistent_deviceConfig_t config;
+  uint16_t crc;
+}, legacy_configRecord_t);
+
+#define LOG_RECORDS        (SF_PERSISTENTDATASTORAGE_PAGE_SIZE / sizeof(legacy_configRecord_t))
+
+/* Factory configuration with the IEEE MAC address */
+uint8_t host_fcfg1[0x400];
+static uint8_t gSnapshot[FLASH_EMU_SIZE];
+
+/*=== Fakes ==================================================================*/
+int ieee_addr_cpy_to(uint8_t *dst, uint8_t len)
+{
+  memcpy(dst, &host_fcfg1[FCFG1_O_MAC_15_4_0], len);
+  return 0;
+}
+
+/*=== Helpers ================================================================*/
+/* Configuration stored by a previous firmware. */
+static sf_persistent_deviceConfig_t loc_legacyConfig(uint16_t panId)
+{
+  sf_persistent_deviceConfig_t config;
+
+  memset(&config, 0, sizeof(config));
+  config.deviceSerial = 0x12345678;
+  config.measIntervalSec = 9;
+  config.bmsccAddr[0] = 0x01;
+  config.bmsccAddr[1] = 0x02;
+  config.panId = panId;
+  config.deviceAddr[0] = 0x11;
+  config.deviceAddr[1] = 0x22;
+  config.channelOffset = 3;
+
+  return config;
+}
+
+static void loc_assertConfig(const sf_persistent_deviceConfig_t *pExpected,
+                             bool withChannelOffset)
+{
+  assert(pExpected->deviceSerial == sf_configMgmt_getDeviceSerial());
+  assert(pExpected->measIntervalSec == sf_configMgmt_getMeasInterval());
+  assert(0 == memcmp(pExpected->bmsccAddr, sf_configMgmt_getGwAddr()->u8, 2));
+  assert(pExpected->panId == sf_configMgmt_getPanId());
+  assert(0 == memcmp(pExpected->deviceAddr, sf_configMgmt_getDeviceAddr()->u8, 2));
+  assert((withChannelOffset ? pExpected->channelOffset : 0) ==
+         sf_configMgmt_getChannelOffset());
+}
+
+/* Read the configuration from the flash into a cleared one. */
+static E_SF_RETURN_t loc_reload(void)
+{
+  memset(&gDeviceConfig, 0, sizeof(gDeviceConfig));
+  return sf_configMgmt_readConfig();
+}
+
+static void loc_plant(uint32_t addr, void *pData, size_t len)
+{
+  assert(FLASH_SUCCESS == writeFlash(addr, (uint8_t*)pData, len));
+}
+
+/* Configuration of the firmware without channel offset. */
+static void loc_storeV1(const sf_persistent_deviceConfig_t *pConfig)
+{
+  sf_persistent_deviceConfig_t config = *pConfig;
+  uint16_t crc;
+
+  config.flag = FLAG_V1;
+  crc = crc16_data((uint8_t*)&config, V1_LEN, 0);
+  memcpy((uint8_t*)&config + V1_LEN, &crc, sizeof(crc));
+  loc_plant(CONFIG_ADDR, &config, V1_LEN + sizeof(crc));
+}
+
+/* Configuration of the firmware with a single fixed structure. */
+static void loc_storeFixed(const sf_persistent_deviceConfig_t *pConfig)
+{
+  sf_persistent_deviceConfig_t config = *pConfig;
+
+  config.flag = FLAG_FIXED;
+  config.crc = crc16_data((uint8_t*)&config, sizeof(config) - sizeof(uint16_t), 0);
+  loc_plant(CONFIG_ADDR, &config, sizeof(config));
+}
+
+/* Record of the configuration log of fixed structures. */
+static void loc_storeLogRecord(uint8_t page, uint16_t idx, uint16_t seq,
+                               const sf_persistent_deviceConfig_t *pConfig)
+{
+  legacy_configRecord_t record;
+
+  memset(&record, 0, sizeof(record));
+  record.flag = FLAG_LOG;
+  record.seq = seq;
+  record.config = *pConfig;
+  record.crc = crc16_data((uint8_t*)&record, sizeof(record) - sizeof(uint16_t), 0);
+  loc_plant(((0 == page) ? CONFIG_ADDR : CONFIG_ADDR2) + idx * sizeof(record),
+            &record, sizeof(record));
+}
+
+static void loc_storeLogOnBothPages(const sf_persistent_deviceConfig_t *pConfig)
+{
+  uint16_t idx;
+
+  for(idx = 0; idx < LOG_RECORDS; idx++)
+  {
+    loc_storeLogRecord(0, idx, idx, pConfig);
+  }
+  loc_storeLogRecord(1, 0, idx, pConfig);
+}
+
+static double loc_nowNs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/*=== Tests ==================================================================*/
+static void test_roundTrip(void)
+{
+  uint32_t serial = 0xCAFE;
+  uint32_t interval = 6;
+  linkaddr_t addr = {{0x33, 0x44}};
+  uint16_t panId = 0xABCD;
+  uint8_t offset = 2;
+  uint32_t value;
+
+  flash_emu_reset();
+  assert(E_SF_SUCCESS != loc_reload());
+
+  assert(E_SF_SUCCESS == sf_configMgmt_setParam(&serial, sizeof(serial),
+                                                E_CONFIGMGMT_PARAM_DEVICE_SERIAL));
+  assert(E_SF_SUCCESS == sf_configMgmt_setParam(&interval, sizeof(interval),
+                                                E_CONFIGMGMT_PARAM_MEAS_INTERVAL));
+  assert(E_SF_SUCCESS == sf_configMgmt_setParam(addr.u8, LINKADDR_SIZE,
+                                                E_CONFIGMGMT_PARAM_GW_ADDR));
+  assert(E_SF_SUCCESS == sf_configMgmt_setParam(&panId, sizeof(panId),
+                                                E_CONFIGMGMT_PARAM_PAN_ID));
+  assert(E_SF_SUCCESS == sf_configMgmt_setParam(&offset, sizeof(offset),
+                                                E_CONFIGMGMT_PARAM_CHANNEL_OFFSET));
+  assert(E_SF_SUCCESS == sf_configMgmt_writeConfig());
+
+  assert(E_SF_SUCCESS == loc_reload());
+  assert(serial == sf_configMgmt_getDeviceSerial());
+  assert(interval == sf_configMgmt_getMeasInterval());
+  assert(linkaddr_cmp(&addr, sf_configMgmt_getGwAddr()));
+  assert(panId == sf_configMgmt_getPanId());
+  assert(offset == sf_configMgmt_getChannelOffset());
+  value = 0;
+  assert(E_SF_SUCCESS == sf_configMgmt_getParam(&value, sizeof(value),
+                                                E_CONFIGMGMT_PARAM_MEAS_INTERVAL));
+  assert(interval == value);
+
+  /* Invalid values and sizes are rejected, the value is kept. */
+  value = SF_CONFIGMGMT_MEAS_INTERVAL_LIMIT_LOWER - 1U;
+  assert(E_SF_SUCCESS != sf_configMgmt_setParam(&value, sizeof(value),
+                                                E_CONFIGMGMT_PARAM_MEAS_INTERVAL));
+  offset = APP_SLOTFRAME_CHANNEL_OFFSET_NUM;
+  assert(E_SF_SUCCESS != sf_configMgmt_setParam(&offset, sizeof(offset),
+                                                E_CONFIGMGMT_PARAM_CHANNEL_OFFSET));
+  assert(E_SF_SUCCESS != sf_configMgmt_setParam(&panId, sizeof(panId),
+                                                E_CONFIGMGMT_PARAM_DEVICE_SERIAL));
+  assert(E_SF_SUCCESS != sf_configMgmt_getParam(&panId, sizeof(panId),
+                                                E_CONFIGMGMT_PARAM_MAX));
+  assert(interval == sf_configMgmt_getMeasInterval());
+  assert(2 == sf_configMgmt_getChannelOffset());
+  assert(serial == sf_configMgmt_getDeviceSerial());
+}
+
+/* The defaults are taken from the IEEE MAC address and stored. */
+static void test_default(void)
+{
+  static const uint8_t mac[8] = {0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0x70, 0x80};
+  uint32_t serial;
+
+  flash_emu_reset();
+  memcpy(&host_fcfg1[FCFG1_O_MAC_15_4_0], mac, sizeof(mac));
+  memcpy(&serial, mac, sizeof(serial));
+  memset(&gDeviceConfig, 0, sizeof(gDeviceConfig));
+  assert(E_SF_SUCCESS == sf_configMgmt_setDefaultConfig());
+
+  assert(E_SF_SUCCESS == loc_reload());
+  assert(serial == sf_configMgmt_getDeviceSerial());
+  assert(3 == sf_configMgmt_getMeasInterval());
+  assert(0 == memcmp(mac, sf_configMgmt_getDeviceAddr()->u8, LINKADDR_SIZE));
+}
+
+/* Unknown tags and values of an unexpected size or an invalid value are
+   skipped, a truncated TLV ends the decoding. */
+static void test_decode(void)
+{
+  const uint8_t tlv[] =
+  {
+    0x7F, 0x03, 0xAA, 0xBB, 0xCC,          /* unknown tag */
+    0x05, 0x02, 0x34, 0x12,                /* PAN ID */
+    0x02, 0x04, 0x01, 0x00, 0x00, 0x00,    /* invalid interval */
+    0x06, 0x02, 0x01, 0x00,                /* channel offset, wrong size */
+    0x04, 0x02, 0x55, 0x66,                /* BMS-CC address */
+    0x01, 0x04, 0xEF, 0xBE                 /* truncated serial */
+  };
+
+  flash_emu_reset();
+  /* Stored by a later version */
+  assert(E_SF_SUCCESS == sf_persistentDataStorage_writeConfigTlv(TLV_VERSION + 1,
+                                                                 tlv, sizeof(tlv)));
+  memset(&gDeviceConfig, 0, sizeof(gDeviceConfig));
+  gDeviceConfig.measIntervalSec = 3;
+  gDeviceConfig.channelOffset = 1;
+  gDeviceConfig.deviceSerial = 77;
+  assert(E_SF_SUCCESS == sf_configMgmt_readConfig());
+
+  assert(0x1234 == sf_configMgmt_getPanId());
+  assert(3 == sf_configMgmt_getMeasInterval());
+  assert(1 == sf_configMgmt_getChannelOffset());
+  assert((0x55 == sf_configMgmt_getGwAddr()->u8[0]) &&
+         (0x66 == sf_configMgmt_getGwAddr()->u8[1]));
+  assert(77 == sf_configMgmt_getDeviceSerial());
+}
+
+/* Migrate the configuration planted in the flash. It must be kept by the
+   TLV record and a later change must be stored. */
+static void loc_checkMigration(const sf_persistent_deviceConfig_t *pExpected,
+                               bool withChannelOffset)
+{
+  uint8_t tlv[SF_PERSISTENTDATASTORAGE_CONFIG_TLV_MAX_LEN];
+  uint8_t version;
+  uint8_t len;
+  uint16_t panId = 0x0BAD;
+
+  assert(E_SF_SUCCESS != sf_persistentDataStorage_readConfigTlv(&version, tlv, &len));
+  assert(E_SF_SUCCESS == loc_reload());
+  loc_assertConfig(pExpected, withChannelOffset);
+
+  assert(E_SF_SUCCESS == sf_persistentDataStorage_readConfigTlv(&version, tlv, &len));
+  assert(TLV_VERSION == version);
+  assert(E_SF_SUCCESS == loc_reload());
+  loc_assertConfig(pExpected, withChannelOffset);
+
+  assert(E_SF_SUCCESS == sf_configMgmt_setParam(&panId, sizeof(panId),
+                                                E_CONFIGMGMT_PARAM_PAN_ID));
+  assert(E_SF_SUCCESS == sf_configMgmt_writeConfig());
+  assert(E_SF_SUCCESS == loc_reload());
+  assert(panId == sf_configMgmt_getPanId());
+}
+
+static void test_migrateV1(void)
+{
+  sf_persistent_deviceConfig_t config = loc_legacyConfig(0x0101);
+
+  flash_emu_reset();
+  loc_storeV1(&config);
+  loc_checkMigration(&config, false);
+}
+
+static void test_migrateFixed(void)
+{
+  sf_persistent_deviceConfig_t config = loc_legacyConfig(0x0202);
+
+  flash_emu_reset();
+  loc_storeFixed(&config);
+  loc_checkMigration(&config, true);
+}
+
+/* Log of fixed structures over both pages, the newest record is found by
+   its sequence number, which may have wrapped around. */
+static void test_migrateLog(uint8_t newestPage)
+{
+  sf_persistent_deviceConfig_t older = loc_legacyConfig(0x0303);
+  sf_persistent_deviceConfig_t newest = loc_legacyConfig(0x0404);
+  uint16_t idx;
+  uint16_t seq = 0xFFF0;
+
+  flash_emu_reset();
+  for(idx = 0; idx < LOG_RECORDS; idx++)
+  {
+    loc_storeLogRecord(1 - newestPage, idx, seq++, &older);
+  }
+  loc_storeLogRecord(newestPage, 0, seq++, &older);
+  loc_storeLogRecord(newestPage, 1, seq, &newest);
+
+  loc_checkMigration(&newest, true);
+}
+
+/* Cut the power at every step of the migration. The configuration of the
+   previous firmware must be read until the TLV record is complete. */
+static void test_migratePowerLoss(void (*pStore)(const sf_persistent_deviceConfig_t*))
+{
+  sf_persistent_deviceConfig_t config = loc_legacyConfig(0x0505);
+  unsigned long steps;
+  unsigned long cut;
+
+  flash_emu_reset();
+  pStore(&config);
+  flash_emu_save(gSnapshot);
+
+  steps = flash_emu_getOps();
+  assert(E_SF_SUCCESS == loc_reload());
+  steps = flash_emu_getOps() - steps;
+  assert(0 != steps);
+
+  for(cut = 0; cut < steps; cut++)
+  {
+    flash_emu_restore(gSnapshot);
+    flash_emu_powerOn();
+    flash_emu_setBudget((long)cut);
+    loc_reload();
+    assert(flash_emu_powerLost());
+    flash_emu_powerOn();
+
+    assert(E_SF_SUCCESS == loc_reload());
+    loc_assertConfig(&config, true);
+    assert(E_SF_SUCCESS == loc_reload());
+    loc_assertConfig(&config, true);
+  }
+  printf("migration cut at each of %lu steps: configuration kept\n", steps);
+}
+
+/* Reads of the BMS-CC address and the PAN ID, as per measurement cycle and
+   per received beacon. The barrier makes every call read the
+   configuration. */
+static void test_benchmark(void)
+{
+  volatile uint16_t sink = 0;
+  linkaddr_t addr;
+  uint16_t panId;
+  double getParamNs = 1e18;
+  double accessorNs = 1e18;
+  double start;
+  double ns;
+  unsigned long i;
+  int run;
+
+  for(run = 0; run < BENCH_RUNS; run++)
+  {
+    start = loc_nowNs();
+    for(i = 0; i < BENCH_CALLS; i++)
+    {
+      sf_configMgmt_getParam(addr.u8, sizeof(addr.u8), E_CONFIGMGMT_PARAM_GW_ADDR);
+      sf_configMgmt_getParam(&panId, sizeof(panId), E_CONFIGMGMT_PARAM_PAN_ID);
+      sink ^= addr.u16 ^ panId;
+      __asm__ volatile("" ::: "memory");
+    }
+    ns = (loc_nowNs() - start) / BENCH_CALLS;
+    getParamNs = (ns < getParamNs) ? ns : getParamNs;
+
+    start = loc_nowNs();
+    for(i = 0; i < BENCH_CALLS; i++)
+    {
+      sink ^= sf_configMgmt_getGwAddr()->u16 ^ sf_configMgmt_getPanId();
+      __asm__ volatile("" ::: "memory");
+    }
+    ns = (loc_nowNs() - start) / BENCH_CALLS;
+    accessorNs = (ns < accessorNs) ? ns : accessorNs;
+  }
+
+  printf("BMS-CC address and PAN ID: getParam %.2f ns, inline accessors "
+         "%.2f ns per read\n", getParamNs, accessorNs);
+  assert(accessorNs < getParamNs);
+}
+
+int main(void)
+{
+  /* Keep the report of the runs before a failed assertion */
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  test_roundTrip();
+  test_default();
+  test_decode();
+  test_migrateV1();
+  test_migrateFixed();
+  test_migrateLog(0);
+  test_migrateLog(1);
+  test_migratePowerLoss(loc_storeFixed);
+  test_migratePowerLoss(loc_storeLogOnBothPages);
+  test_benchmark();
+
+  printf("test_configTlv: OK\n");
+  return 0;
+}
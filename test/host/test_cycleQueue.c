@@ -0,0 +1,220 @@
+/**
+ @file
+ @brief      Host stress test of the cycle start queue with a simulated
+             rtimer interrupt.
+
+ @details A SIGALRM timer stands for the rtimer interrupt and puts the cycle
+          starts with a sequence number in the ASN, while the main loop
+          drains the queue with random processing times as the processes
+          do. Disabling the interrupts blocks the signal. Every cycle start
+          must be drained in order or counted as dropped. The longest
+          enqueue, the longest drain latency and the drop rate are reported.
+*/
+#include <assert.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "sf_cycleQueue.h"
+#include "sys/int-master.h"
+
+/* Size of the queue, as configured for the module */
+#ifdef SF_CONF_MEAS_CYCLE_QUEUE_SIZE
+#define QUEUE_SIZE       SF_CONF_MEAS_CYCLE_QUEUE_SIZE
+#else
+#define QUEUE_SIZE       4U
+#endif
+/* The ring keeps one index free to tell full from empty. */
+#define QUEUE_CAPACITY   (QUEUE_SIZE - 1U)
+/* Period of the simulated interrupt and duration of the stress test */
+#define ISR_PERIOD_US    100
+#define STRESS_US        (2 * 1000 * 1000)
+/* Processing of an entry: mostly shorter than the period, one in
+   PROCESS_LONG_RATE takes up to PROCESS_LONG_US and forces drops. */
+#define PROCESS_US       (ISR_PERIOD_US / 2)
+#define PROCESS_LONG_RATE 20
+#define PROCESS_LONG_US  (6 * ISR_PERIOD_US)
+
+static volatile uint32_t gProduced;
+static volatile uint32_t gPutFailed;
+
+/*=== Fakes of the rtimer and the master interrupt ===========================*/
+rtimer_clock_t rtimer_arch_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (rtimer_clock_t)(ts.tv_sec * 1000000UL + ts.tv_nsec / 1000UL);
+}
+
+int_master_status_t int_master_read_and_disable(void)
+{
+  sigset_t set;
+  sigset_t old;
+
+  sigemptyset(&set);
+  sigaddset(&set, SIGALRM);
+  sigprocmask(SIG_BLOCK, &set, &old);
+  return sigismember(&old, SIGALRM) ? 1U : 0U;
+}
+
+void int_master_status_set(int_master_status_t status)
+{
+  sigset_t set;
+
+  sigemptyset(&set);
+  sigaddset(&set, SIGALRM);
+  sigprocmask(status ? SIG_BLOCK : SIG_UNBLOCK, &set, NULL);
+}
+
+/*=== Simulated rtimer interrupt ============================================*/
+static void loc_isr(int sig)
+{
+  struct tsch_asn_t asn;
+
+  (void)sig;
+  TSCH_ASN_INIT(asn, 0, gProduced);
+  if(!sf_cycleQueue_put(&asn, RTIMER_NOW()))
+  {
+    gPutFailed++;
+  }
+  gProduced++;
+}
+
+static void loc_timer(long periodUs)
+{
+  struct itimerval it;
+
+  memset(&it, 0, sizeof(it));
+  it.it_interval.tv_usec = periodUs;
+  it.it_value.tv_usec = periodUs;
+  setitimer(ITIMER_REAL, &it, NULL);
+}
+
+static void loc_busy(rtimer_clock_t us)
+{
+  rtimer_clock_t start = RTIMER_NOW();
+
+  while((rtimer_clock_t)(RTIMER_NOW() - start) < us)
+  {
+  }
+}
+
+/*=== Tests ==================================================================*/
+static void test_fifoAndOverflow(void)
+{
+  struct tsch_asn_t asn;
+  const sf_cycleQueue_entry_t *pEntry;
+  sf_cycleQueue_stats_t stats;
+  uint32_t i;
+
+  sf_cycleQueue_init();
+  assert(NULL == sf_cycleQueue_peek());
+
+  for(i = 0; i < QUEUE_CAPACITY + 2U; i++)
+  {
+    TSCH_ASN_INIT(asn, 1, i);
+    assert(sf_cycleQueue_put(&asn, 100U + i) == (i < QUEUE_CAPACITY));
+  }
+
+  for(i = 0; i < QUEUE_CAPACITY; i++)
+  {
+    pEntry = sf_cycleQueue_peek();
+    assert(NULL != pEntry);
+    assert((1U == pEntry->asn.ms1b) && (i == pEntry->asn.ls4b));
+    assert(100U + i == pEntry->slotStart);
+    /* Peeking twice returns the same entry until it is released. */
+    assert(pEntry == sf_cycleQueue_peek());
+    sf_cycleQueue_release();
+  }
+  assert(NULL == sf_cycleQueue_peek());
+
+  sf_cycleQueue_getStats(&stats);
+  assert(2U == stats.dropped);
+
+  /* A reset empties the queue and clears the statistics. */
+  TSCH_ASN_INIT(asn, 0, 0);
+  assert(sf_cycleQueue_put(&asn, 0));
+  sf_cycleQueue_init();
+  assert(NULL == sf_cycleQueue_peek());
+  sf_cycleQueue_getStats(&stats);
+  assert((0U == stats.dropped) && (0U == stats.enqueueMax) &&
+         (0U == stats.latencyMax));
+}
+
+static void test_isrStress(void)
+{
+  const sf_cycleQueue_entry_t *pEntry;
+  sf_cycleQueue_stats_t stats;
+  int_master_status_t status;
+  rtimer_clock_t start;
+  uint32_t expected = 0;
+  uint32_t drained = 0;
+  uint32_t gaps = 0;
+  uint32_t produced;
+  uint64_t latencySum = 0;
+
+  signal(SIGALRM, loc_isr);
+  srand(1);
+  sf_cycleQueue_init();
+  loc_timer(ISR_PERIOD_US);
+
+  start = RTIMER_NOW();
+  while((rtimer_clock_t)(RTIMER_NOW() - start) < STRESS_US)
+  {
+    while((pEntry = sf_cycleQueue_peek()) != NULL)
+    {
+      /* In order, the missing ones are the dropped ones. */
+      assert(pEntry->asn.ls4b >= expected);
+      gaps += pEntry->asn.ls4b - expected;
+      expected = pEntry->asn.ls4b + 1U;
+      latencySum += RTIMER_NOW() - pEntry->putTime;
+      drained++;
+      loc_busy((rtimer_clock_t)(rand() % ((0 == rand() % PROCESS_LONG_RATE) ?
+                                          PROCESS_LONG_US : PROCESS_US)));
+      sf_cycleQueue_release();
+    }
+  }
+
+  loc_timer(0);
+  status = int_master_read_and_disable();
+  produced = gProduced;
+  int_master_status_set(status);
+
+  while((pEntry = sf_cycleQueue_peek()) != NULL)
+  {
+    assert(pEntry->asn.ls4b >= expected);
+    gaps += pEntry->asn.ls4b - expected;
+    expected = pEntry->asn.ls4b + 1U;
+    drained++;
+    sf_cycleQueue_release();
+  }
+  gaps += produced - expected;
+
+  sf_cycleQueue_getStats(&stats);
+  assert(stats.dropped == gPutFailed);
+  assert(stats.dropped == gaps);
+  assert(drained + stats.dropped == produced);
+  /* The processing is much longer than the period at times. */
+  assert(stats.dropped > 0U);
+
+  printf("%u cycle starts every %u us, queue of %u entries: %u drained, %u dropped "
+         "(%.2f %%)\n", produced, ISR_PERIOD_US, QUEUE_CAPACITY,
+         drained, stats.dropped, 100.0 * stats.dropped / produced);
+  printf("enqueue cost max %u us, drain latency max %u us, mean %.1f us\n",
+         (unsigned)RTIMERTICKS_TO_US(stats.enqueueMax),
+         (unsigned)RTIMERTICKS_TO_US(stats.latencyMax),
+         (double)latencySum / drained);
+}
+
+int main(void)
+{
+  test_fifoAndOverflow();
+  test_isrStress();
+
+  printf("test_cycleQueue: OK\n");
+  return 0;
+}
@@ -0,0 +1,302 @@
+/**
+ @file
+ @brief      Host test of the energy accounting and of the charge model of
+             its reports.
+
+ @details The accounting runs unchanged on the energest of Contiki-NG with
+          a fake rtimer. One hour of the duty cycle of an SC is simulated:
+          every second the CPU wakes up and samples the ADC, the radio
+          listens in a beacon and in a downlink slot and sends the
+          measurement, every minute the journal writes to the flash. An
+          energy report is taken every 10 minutes.
+
+          The times of the reports must match the simulated ones and the
+          charge summed over the reports the charge from the reset to the
+          last one. Tested besides are the report of a slot still running,
+          the conversion to uAh, the wrap around of the times, the decoding
+          and the current tables.
+
+          Reported: the charge of the hour per subsystem and the average
+          current.
+*/
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "sys/energest.h"
+#include "net/mac/tsch/tsch.h"
+#include "sf_energy.h"
+#include "sf_frameType.h"
+#include "energy_model.h"
+
+#define SECONDS            3600U
+#define REPORT_INTERVAL    600U
+#define REPORTS            (SECONDS / REPORT_INTERVAL)
+#define REPORT_LEN         (5U + E_SF_ENERGY_MAX * 4U)
+/* Duty cycle per second in us */
+#define CPU_US             3000U
+#define ADC_US             1000U
+#define RX_BEACON_US       2200U
+#define RX_DOWNLINK_US     1000U
+#define TX_US              4000U
+/* Journal write per minute in us */
+#define FLASH_US           25000U
+
+static rtimer_clock_t gNowUs;
+static bool gLocked;
+
+/*=== Fakes ==================================================================*/
+rtimer_clock_t rtimer_arch_now(void)
+{
+  return gNowUs;
+}
+
+clock_time_t clock_time(void)
+{
+  return 0;
+}
+
+int tsch_get_lock(void)
+{
+  return !gLocked;
+}
+
+void tsch_release_lock(void)
+{
+}
+
+/*=== Helpers ================================================================*/
+static void loc_getReport(energy_report_t *pReport)
+{
+  uint8_t frame[SF_FRAME_TYPE_LEN + REPORT_LEN + 8];
+  uint8_t len;
+
+  frame[0] = E_FRAME_TYPE_ENERGY;
+  assert(0 == sf_energy_getReport(&frame[SF_FRAME_TYPE_LEN], REPORT_LEN - 1U));
+  len = sf_energy_getReport(&frame[SF_FRAME_TYPE_LEN],
+                            sizeof(frame) - SF_FRAME_TYPE_LEN);
+  assert(REPORT_LEN == len);
+  assert(energy_model_decode(frame, SF_FRAME_TYPE_LEN + len, pReport));
+  assert(E_SF_ENERGY_MAX == pReport->subsystems);
+}
+
+/* One second of the duty cycle, starting and ending in LPM */
+static void loc_second(unsigned s)
+{
+  rtimer_clock_t start = gNowUs;
+
+  ENERGEST_SWITCH(ENERGEST_TYPE_LPM, ENERGEST_TYPE_CPU);
+  ENERGEST_ON(ENERGEST_TYPE_SF_ADC);
+  gNowUs += ADC_US;
+  ENERGEST_OFF(ENERGEST_TYPE_SF_ADC);
+  gNowUs += CPU_US - ADC_US;
+  if(0U == (s % 60U))
+  {
+    ENERGEST_ON(ENERGEST_TYPE_SF_FLASH);
+    gNowUs += FLASH_US;
+    ENERGEST_OFF(ENERGEST_TYPE_SF_FLASH);
+  }
+  ENERGEST_SWITCH(ENERGEST_TYPE_CPU, ENERGEST_TYPE_LPM);
+
+  /* Slots of the rtimer interrupt */
+  gNowUs += 100000U;
+  sf_energy_rxListenStartCallback(LINK_TYPE_ADVERTISING_ONLY);
+  gNowUs += RX_BEACON_US;
+  sf_energy_rxListenEndCallback();
+  gNowUs += 100000U;
+  sf_energy_rxListenStartCallback(LINK_TYPE_NORMAL);
+  gNowUs += RX_DOWNLINK_US;
+  sf_energy_rxListenEndCallback();
+  gNowUs += 100000U;
+  ENERGEST_ON(ENERGEST_TYPE_TRANSMIT);
+  gNowUs += TX_US;
+  ENERGEST_OFF(ENERGEST_TYPE_TRANSMIT);
+
+  gNowUs = start + 1000000U;
+}
+
+static bool loc_near(double a, double b)
+{
+  return fabs(a - b) <= 1e-9 * fmax(fabs(a), fabs(b));
+}
+
+/*=== Tests ==================================================================*/
+/* An hour of the duty cycle, reported in parts and at once */
+static void test_hour(void)
+{
+  static const uint32_t expectedMs[E_SF_ENERGY_MAX] =
+  {
+    [E_SF_ENERGY_CPU] = SECONDS * CPU_US / 1000U + (SECONDS / 60U) * FLASH_US / 1000U,
+    [E_SF_ENERGY_ADC] = SECONDS * ADC_US / 1000U,
+    [E_SF_ENERGY_RX_BEACON] = SECONDS * RX_BEACON_US / 1000U,
+    [E_SF_ENERGY_RX_DOWNLINK] = SECONDS * RX_DOWNLINK_US / 1000U,
+    [E_SF_ENERGY_TX_DATA] = SECONDS * TX_US / 1000U,
+    [E_SF_ENERGY_FLASH] = (SECONDS / 60U) * FLASH_US / 1000U,
+  };
+  const energy_currents_t *pCurrents = &gEnergyModelCc2652r;
+  energy_report_t report[REPORTS + 1];
+  double uah[E_SF_ENERGY_MAX];
+  double sumUah = 0.0;
+  double expectedUah;
+  unsigned s;
+  unsigned r;
+  uint8_t i;
+
+  gNowUs = 0;
+  energest_init();
+  ENERGEST_SWITCH(ENERGEST_TYPE_CPU, ENERGEST_TYPE_LPM);
+  loc_getReport(&report[0]);
+  assert(0U == report[0].uptimeMs);
+
+  for(s = 0, r = 1; s < SECONDS; s++)
+  {
+    loc_second(s);
+    if(0U == ((s + 1U) % REPORT_INTERVAL))
+    {
+      loc_getReport(&report[r]);
+      sumUah += energy_model_chargeUah(&report[r - 1], &report[r], pCurrents, NULL);
+      r++;
+    }
+  }
+
+  assert(SECONDS * 1000U == report[REPORTS].uptimeMs);
+  for(i = 0; i < E_SF_ENERGY_MAX; i++)
+  {
+    assert(expectedMs[i] == report[REPORTS].timeMs[i]);
+  }
+
+  expectedUah = pCurrents->standbyUa;
+  for(i = 0; i < E_SF_ENERGY_MAX; i++)
+  {
+    expectedUah += pCurrents->activeUa[i] * expectedMs[i] / 3600000.0;
+  }
+  assert(loc_near(expectedUah,
+                  energy_model_chargeUah(NULL, &report[REPORTS], pCurrents, uah)));
+  assert(loc_near(expectedUah, sumUah));
+
+  printf("one hour of the duty cycle: %.2f uAh, average %.2f uA\n", sumUah, sumUah);
+  printf("  %-12s %8.2f uAh\n", "standby", pCurrents->standbyUa);
+  for(i = 0; i < E_SF_ENERGY_MAX; i++)
+  {
+    printf("  %-12s %8.2f uAh %5.1f %%\n", gEnergyModelName[i], uah[i],
+           100.0 * uah[i] / sumUah);
+  }
+}
+
+/* A listening slot is reported up to now unless the slot operation holds
+   the lock */
+static void test_running(void)
+{
+  energy_report_t report;
+
+  gNowUs = 0;
+  energest_init();
+  ENERGEST_SWITCH(ENERGEST_TYPE_CPU, ENERGEST_TYPE_LPM);
+  gNowUs += 10000U;
+  sf_energy_rxListenStartCallback(LINK_TYPE_ADVERTISING);
+  gNowUs += 3000U;
+
+  gLocked = true;
+  loc_getReport(&report);
+  assert((0U == report.timeMs[E_SF_ENERGY_RX_BEACON]) && (0U == report.uptimeMs));
+
+  gLocked = false;
+  loc_getReport(&report);
+  assert((3U == report.timeMs[E_SF_ENERGY_RX_BEACON]) && (13U == report.uptimeMs));
+  assert(0U == report.timeMs[E_SF_ENERGY_RX_DOWNLINK]);
+
+  /* Not counted twice after the flush */
+  gNowUs += 2000U;
+  sf_energy_rxListenEndCallback();
+  loc_getReport(&report);
+  assert((5U == report.timeMs[E_SF_ENERGY_RX_BEACON]) && (15U == report.uptimeMs));
+}
+
+/* 1 mA over 1 h is 1000 uAh, the times wrap around at 2^32 ms */
+static void test_charge(void)
+{
+  energy_currents_t currents = {.standbyUa = 1.0, .activeUa = {[E_SF_ENERGY_TX_DATA] = 1000.0}};
+  energy_report_t from = {.uptimeMs = 0xFFFFFFFFUL - 1800000UL + 1UL, .subsystems = E_SF_ENERGY_MAX};
+  energy_report_t to = {.uptimeMs = 1800000UL, .subsystems = E_SF_ENERGY_MAX};
+  double uah[E_SF_ENERGY_MAX];
+
+  from.timeMs[E_SF_ENERGY_TX_DATA] = 0xFFFFFFFFUL - 1000UL + 1UL;
+  to.timeMs[E_SF_ENERGY_TX_DATA] = 3599000UL;
+  assert(loc_near(1001.0, energy_model_chargeUah(&from, &to, &currents, uah)));
+  assert(loc_near(1000.0, uah[E_SF_ENERGY_TX_DATA]) && (0.0 == uah[E_SF_ENERGY_CPU]));
+
+  /* Subsystems of an earlier firmware are not charged */
+  to.subsystems = E_SF_ENERGY_TX_DATA;
+  assert(loc_near(1.0, energy_model_chargeUah(&from, &to, &currents, NULL)));
+}
+
+/* Other frame types, truncated frames and frames of later firmware */
+static void test_decode(void)
+{
+  uint8_t frame[SF_FRAME_TYPE_LEN + 5U + 20U * 4U] = {E_FRAME_TYPE_ENERGY, 0x10, 0x27, 0, 0, 8};
+  energy_report_t report;
+
+  frame[6] = 0x2A;
+  assert(energy_model_decode(frame, 6U + 8U * 4U, &report));
+  assert((10000U == report.uptimeMs) && (8U == report.subsystems));
+  assert(42U == report.timeMs[0]);
+  assert(!energy_model_decode(frame, 6U + 8U * 4U - 1U, &report));
+  assert(!energy_model_decode(frame, 5U, &report));
+
+  frame[5] = 20U;
+  assert(!energy_model_decode(frame, sizeof(frame), &report));
+  frame[5] = 8U;
+  frame[0] = E_FRAME_TYPE_BOOT_PROFILE;
+  assert(!energy_model_decode(frame, 6U + 8U * 4U, &report));
+}
+
+/* Current tables overriding the defaults, and their errors */
+static void test_currents(void)
+{
+  static const char *const invalid[] =
+  {
+    "radio 6900\n",
+    "cpu -1\n",
+    "cpu 3 mA\n",
+    "# no current\ntx_data\n",
+  };
+  static const int invalidLine[] = {1, 1, 1, 2};
+  energy_currents_t currents = gEnergyModelCc2652r;
+  FILE *pFile = tmpfile();
+  unsigned i;
+
+  assert(NULL != pFile);
+  fputs("# CC2652P, +10 dBm\n\nstandby 1.2\n  tx_data  22500\n", pFile);
+  rewind(pFile);
+  assert(0 == energy_model_readCurrents(pFile, &currents));
+  fclose(pFile);
+  assert((1.2 == currents.standbyUa) && (22500.0 == currents.activeUa[E_SF_ENERGY_TX_DATA]));
+  assert(gEnergyModelCc2652r.activeUa[E_SF_ENERGY_CPU] == currents.activeUa[E_SF_ENERGY_CPU]);
+
+  for(i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+  {
+    pFile = tmpfile();
+    assert(NULL != pFile);
+    fputs(invalid[i], pFile);
+    rewind(pFile);
+    assert(invalidLine[i] == energy_model_readCurrents(pFile, &currents));
+    fclose(pFile);
+  }
+}
+
+int main(void)
+{
+  /* Keep the report of the runs before a failed assertion */
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  test_running();
+  test_charge();
+  test_decode();
+  test_currents();
+  test_hour();
+
+  printf("test_energy: OK\n");
+  return 0;
+}
@@ -0,0 +1,307 @@
+/**
+ @file
+ @brief      Host test of the fixed-point EWMA of the link quality cache.
+
+ @details The cache is fed through the beacon scan and TSCH callbacks and
+          read back through the best neighbour, which is a copy of the
+          entry with the averages in their fixed-point scaling, and through
+          the report, which is split into parts for the short timeslot
+          profiles.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/mac/mac.h"
+#include "sys/int-master.h"
+#include "sf_linkQuality.h"
+
+/* EWMA weight of a new sample, SF_LINKQUALITY_EWMA_SHIFT */
+#define EWMA_DIV           8
+/* Largest error of the truncating update in steady state */
+#define EWMA_STEADY_ERROR  (EWMA_DIV - 1)
+/* Report entry lengths */
+#define REPORT_CH_LEN      2
+#define REPORT_NBR_LEN     6
+/* Frame payload of the 4000 us profile without the frame type, with and
+   without a MIC */
+#define REPORT_SHORT_LEN   36
+#define REPORT_MIC_LEN     32
+
+static unsigned long gSeconds;
+static bool gDisabled;
+
+/*=== Fakes ==================================================================*/
+unsigned long clock_seconds(void)
+{
+  return gSeconds;
+}
+
+int_master_status_t int_master_read_and_disable(void)
+{
+  int_master_status_t status = gDisabled;
+
+  gDisabled = true;
+  return status;
+}
+
+void int_master_status_set(int_master_status_t status)
+{
+  gDisabled = (0U != status);
+}
+
+/*=== Helpers ================================================================*/
+/* Returns the entry of the only neighbour seen since now. */
+static sf_linkQuality_t loc_getLink(void)
+{
+  sf_linkQuality_neighbour_t best;
+
+  assert(sf_linkQuality_getBestNeighbour(gSeconds, &best));
+  /* Interrupts enabled again */
+  assert(!gDisabled);
+  return best.link;
+}
+
+/*=== Tests ==================================================================*/
+/* The report in one part and in parts of the short profiles. */
+static void test_report(void)
+{
+  const linkaddr_t good = {{0x01, 0x00}};
+  const linkaddr_t bad = {{0x02, 0x00}};
+  const uint8_t lens[] = {64, REPORT_SHORT_LEN, REPORT_MIC_LEN,
+                          1 + REPORT_NBR_LEN};
+  uint8_t full[64];
+  uint8_t part[64];
+  uint8_t joined[64];
+  uint8_t fullLen;
+  uint8_t joinedLen;
+  uint8_t next;
+  uint8_t len;
+  uint8_t first;
+  unsigned parts;
+  unsigned l;
+  int i;
+
+  gSeconds = 100;
+  for(i = 0; i < 100; i++)
+  {
+    sf_linkQuality_txCallback(&good, MAC_TX_OK, 11, -20);
+    sf_linkQuality_txCallback(&bad, MAC_TX_NOACK, 26, 0);
+    sf_linkQuality_rxCallback(&bad, -100, 26);
+    /* Not sent, does not count. */
+    sf_linkQuality_txCallback(&good, MAC_TX_COLLISION, 11, 0);
+  }
+  /* Out of range channel */
+  sf_linkQuality_rxCallback(NULL, -50, 27);
+
+  gSeconds = 130;
+  next = 0;
+  fullLen = sf_linkQuality_getReport(full, sizeof(full), &next);
+  assert(0 == next);
+  assert(1 + REPORT_CH_LEN * SF_LINKQUALITY_NUM_CHANNELS +
+         2 * REPORT_NBR_LEN == fullLen);
+  /* First entry */
+  assert(0 == full[0]);
+  /* Channel 11, the ACKs are receptions as well. */
+  assert((uint8_t)(int8_t)-20 == full[1]);
+  assert(100 == full[2]);
+  /* Channel 12, unused */
+  assert((uint8_t)INT8_MIN == full[3]);
+  assert(0xFF == full[4]);
+  /* Channel 26 */
+  assert((uint8_t)(int8_t)-100 == full[31]);
+  assert(0 == full[32]);
+  /* Neighbours: address, RSSI, PRR and age */
+  assert((0x01 == full[33]) && ((uint8_t)(int8_t)-20 == full[35]) &&
+         (100 == full[36]) && (30 == full[37]) && (0 == full[38]));
+  assert((0x02 == full[39]) && ((uint8_t)(int8_t)-100 == full[41]) &&
+         (0 == full[42]) && (30 == full[43]));
+
+  /* The parts hold the entries of the full report in order. */
+  for(l = 0; l < sizeof(lens); l++)
+  {
+    next = 0;
+    parts = 0;
+    joined[0] = 0;
+    joinedLen = 1;
+    do
+    {
+      first = next;
+      len = sf_linkQuality_getReport(part, lens[l], &next);
+      assert((len > 1) && (len <= lens[l]));
+      assert(first == part[0]);
+      /* No room left for the next entry */
+      if(0 != next)
+      {
+        assert(len + ((next < SF_LINKQUALITY_NUM_CHANNELS) ?
+                      REPORT_CH_LEN : REPORT_NBR_LEN) > lens[l]);
+      }
+      memcpy(&joined[joinedLen], &part[1], len - 1U);
+      joinedLen += len - 1U;
+      parts++;
+    } while(0 != next);
+    printf("report in %2u byte parts: %u parts\n", lens[l], parts);
+    assert((fullLen == joinedLen) && (0 == memcmp(full, joined, fullLen)));
+  }
+
+  /* Too small for an entry */
+  next = 0;
+  assert(0 == sf_linkQuality_getReport(part, REPORT_NBR_LEN, &next));
+  next = SF_LINKQUALITY_NUM_CHANNELS + 100;
+  assert(0 == sf_linkQuality_getReport(part, sizeof(part), &next));
+  assert(!gDisabled);
+}
+
+/* One step moves by 1/8 of the difference, truncated towards zero. */
+static void test_update(void)
+{
+  const linkaddr_t addr = {{0x10, 0x00}};
+  sf_linkQuality_neighbour_t best;
+
+  gSeconds = 1000;
+  /* The first sample initializes the average. */
+  sf_linkQuality_beaconRx(&addr, -100, 15);
+  assert(-100 * SF_LINKQUALITY_RSSI_SCALE == loc_getLink().rssi);
+  assert(sf_linkQuality_getBestNeighbour(gSeconds, &best));
+  assert(linkaddr_cmp(&addr, &best.addr) && (15 == best.beaconChannel));
+
+  sf_linkQuality_beaconRx(&addr, -50, 15);
+  assert(-1500 == loc_getLink().rssi);
+  /* -94 dBm is 4/16 dB below, less than one step */
+  sf_linkQuality_beaconRx(&addr, -94, 15);
+  assert(-1500 == loc_getLink().rssi);
+  /* -95 dBm is 20/16 dB below */
+  sf_linkQuality_beaconRx(&addr, -95, 15);
+  assert(-1502 == loc_getLink().rssi);
+  assert(4 == loc_getLink().rxCount);
+  assert(0 == loc_getLink().txCount);
+
+  /* The first attempt initializes the PRR. */
+  sf_linkQuality_txCallback(&addr, MAC_TX_NOACK, 15, 0);
+  assert(0 == loc_getLink().prr);
+  sf_linkQuality_txCallback(&addr, MAC_TX_OK, 15, -95);
+  assert(SF_LINKQUALITY_PRR_SCALE / EWMA_DIV == loc_getLink().prr);
+}
+
+/* A constant input converges from both sides up to the truncation and never
+   overshoots. */
+static void test_converge(int16_t start, int16_t sample)
+{
+  /* A new neighbour for each run */
+  const linkaddr_t addr = {{0x20, (uint8_t)gSeconds}};
+  int32_t avg;
+  int32_t prev;
+  int i;
+
+  gSeconds++;
+  sf_linkQuality_beaconRx(&addr, start, 20);
+  prev = loc_getLink().rssi;
+  for(i = 0; i < 200; i++)
+  {
+    sf_linkQuality_beaconRx(&addr, sample, 20);
+    avg = loc_getLink().rssi;
+    assert((start <= sample) ? ((avg >= prev) && (avg <= sample * SF_LINKQUALITY_RSSI_SCALE)) :
+                               ((avg <= prev) && (avg >= sample * SF_LINKQUALITY_RSSI_SCALE)));
+    prev = avg;
+  }
+  assert(labs(avg - sample * SF_LINKQUALITY_RSSI_SCALE) <= EWMA_STEADY_ERROR);
+}
+
+/* The PRR of a link lost after a perfect start and of a link recovering. */
+static void test_prr(void)
+{
+  const linkaddr_t addr = {{0x30, 0x00}};
+  uint16_t prr;
+  int i;
+
+  gSeconds = 2000;
+  sf_linkQuality_beaconRx(&addr, -60, 11);
+  for(i = 0; i < 10; i++)
+  {
+    sf_linkQuality_txCallback(&addr, MAC_TX_OK, 11, -60);
+  }
+  assert(SF_LINKQUALITY_PRR_SCALE == loc_getLink().prr);
+
+  /* Below the report resolution of 1% within a few dozen attempts */
+  for(i = 0; i < 60; i++)
+  {
+    sf_linkQuality_txCallback(&addr, MAC_TX_NOACK, 11, 0);
+  }
+  assert(loc_getLink().prr <= EWMA_STEADY_ERROR);
+
+  /* Above 99% again within the same number of attempts at most */
+  for(i = 0; i < 200; i++)
+  {
+    sf_linkQuality_txCallback(&addr, MAC_TX_OK, 11, -60);
+    prr = loc_getLink().prr;
+    assert(prr <= SF_LINKQUALITY_PRR_SCALE);
+  }
+  assert(prr >= SF_LINKQUALITY_PRR_SCALE - EWMA_STEADY_ERROR);
+}
+
+/* The truncation error stays bounded against a floating point EWMA. */
+static void test_reference(void)
+{
+  const linkaddr_t addr = {{0x40, 0x00}};
+  double ref = 0;
+  int32_t avg;
+  int16_t sample;
+  int i;
+
+  gSeconds = 3000;
+  srand(1);
+  for(i = 0; i < 10000; i++)
+  {
+    sample = (int16_t)((rand() % 100) - 100);
+    sf_linkQuality_beaconRx(&addr, sample, 25);
+    avg = loc_getLink().rssi;
+    ref = (0 == i) ? sample * SF_LINKQUALITY_RSSI_SCALE :
+          ref + (sample * SF_LINKQUALITY_RSSI_SCALE - ref) / EWMA_DIV;
+    assert(labs(avg - (int32_t)ref) <= EWMA_STEADY_ERROR + 1);
+  }
+}
+
+/* Lost ACKs lower the rating of a stronger neighbour. */
+static void test_rating(void)
+{
+  const linkaddr_t strong = {{0x50, 0x00}};
+  const linkaddr_t weak = {{0x51, 0x00}};
+  sf_linkQuality_neighbour_t best;
+  int i;
+
+  gSeconds = 4000;
+  sf_linkQuality_beaconRx(&strong, -60, 12);
+  sf_linkQuality_beaconRx(&weak, -65, 13);
+  assert(sf_linkQuality_getBestNeighbour(gSeconds, &best));
+  assert(linkaddr_cmp(&strong, &best.addr) && (12 == best.beaconChannel));
+
+  /* A PRR of 0 costs SF_LINKQUALITY_PRR_PENALTY dB */
+  for(i = 0; i < 100; i++)
+  {
+    sf_linkQuality_txCallback(&strong, MAC_TX_NOACK, 12, 0);
+  }
+  assert(sf_linkQuality_getBestNeighbour(gSeconds, &best));
+  assert(linkaddr_cmp(&weak, &best.addr) && (13 == best.beaconChannel));
+
+  /* Nothing seen since */
+  assert(!sf_linkQuality_getBestNeighbour(gSeconds + 1, &best));
+  assert(!gDisabled);
+}
+
+int main(void)
+{
+  test_report();
+  test_update();
+  test_converge(-100, 10);
+  test_converge(10, -100);
+  test_converge(-30, -31);
+  test_converge(-31, -30);
+  test_prr();
+  test_reference();
+  test_rating();
+
+  printf("test_ewma: OK\n");
+  return 0;
+}
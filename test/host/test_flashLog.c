@@ -0,0 +1,276 @@
+/**
+ @file
+ @brief      Host test of the configuration log and the record logs of the
+             persistent data storage on the flash emulation.
+
+ @details The module runs unchanged on flash_emu. Counted are the page
+          erases per 10000 updates of the configuration, the drift model
+          and the sync context, against one erase per configuration write
+          of the former in-place storage. The power is cut at every
+          programmed byte and page erase of an update: the configuration
+          read afterwards is the new or the previous one, never none, and
+          the log takes new records after the power is back.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sf_persistentDataStorage.h"
+#include "flash_emu.h"
+
+/* Value read back when no configuration is stored */
+#define TEST_NONE          UINT32_MAX
+/* Version of the TLV encoding used by the tests */
+#define TEST_TLV_VERSION   1
+#define UPDATES            10000UL
+/* Configuration log pages, FLASH_SIZE - 2 and - 5 pages */
+#define CONFIG_PAGE        (FLASH_EMU_PAGES - 2U)
+#define CONFIG_PAGE2       (FLASH_EMU_PAGES - 5U)
+
+static uint8_t gSnapshot[FLASH_EMU_SIZE];
+/* Length of a configuration record, from the bytes of the first write */
+static unsigned long gConfigRecordLen;
+
+/*=== Helpers ================================================================*/
+/* Append a configuration with a single 4 byte TLV. */
+static E_SF_RETURN_t loc_write(uint32_t value)
+{
+  uint8_t tlv[6] = {0x01, 0x04};
+
+  memcpy(&tlv[2], &value, sizeof(value));
+  return sf_persistentDataStorage_writeConfigTlv(TEST_TLV_VERSION, tlv, sizeof(tlv));
+}
+
+/* Read the stored configuration back, TEST_NONE if there is none. */
+static uint32_t loc_read(void)
+{
+  uint8_t tlv[SF_PERSISTENTDATASTORAGE_CONFIG_TLV_MAX_LEN];
+  uint8_t version;
+  uint8_t len;
+  uint32_t value;
+
+  if(E_SF_SUCCESS != sf_persistentDataStorage_readConfigTlv(&version, tlv, &len))
+  {
+    return TEST_NONE;
+  }
+  assert(TEST_TLV_VERSION == version);
+  assert(6 == len);
+  assert((0x01 == tlv[0]) && (0x04 == tlv[1]));
+  memcpy(&value, &tlv[2], sizeof(value));
+  return value;
+}
+
+static E_SF_RETURN_t loc_writeDrift(int32_t driftPpm)
+{
+  sf_persistent_driftModel_t model;
+
+  memset(&model, 0, sizeof(model));
+  model.driftPpm = driftPpm;
+  return sf_persistentDataStorage_writeDriftModel(&model);
+}
+
+static E_SF_RETURN_t loc_writeSync(uint32_t absoluteTime)
+{
+  sf_persistent_syncContext_t context;
+
+  memset(&context, 0, sizeof(context));
+  context.absoluteTime = absoluteTime;
+  return sf_persistentDataStorage_writeSyncContext(&context);
+}
+
+/*=== Tests ==================================================================*/
+static void test_appendAndRead(void)
+{
+  unsigned long ops;
+
+  flash_emu_reset();
+  assert(TEST_NONE == loc_read());
+
+  /* The first record erases a page for the log. */
+  assert(E_SF_SUCCESS == loc_write(1));
+  assert(1 == flash_emu_getErases());
+  gConfigRecordLen = flash_emu_getWrites();
+  assert(1 == loc_read());
+
+  /* An unchanged configuration is not written again. */
+  ops = flash_emu_getOps();
+  assert(E_SF_SUCCESS == loc_write(1));
+  assert(ops == flash_emu_getOps());
+
+  assert(E_SF_SUCCESS == loc_write(2));
+  assert(2 == loc_read());
+  assert(2 * gConfigRecordLen == flash_emu_getWrites());
+}
+
+static void test_pageSwitch(void)
+{
+  const uint32_t perPage = SF_PERSISTENTDATASTORAGE_PAGE_SIZE / gConfigRecordLen;
+  uint32_t i;
+
+  flash_emu_reset();
+  /* Several turns over both pages */
+  for(i = 0; i < 3 * perPage + 5; i++)
+  {
+    assert(E_SF_SUCCESS == loc_write(i));
+    assert(i == loc_read());
+  }
+  /* Each page is erased when the log moves onto it. */
+  assert(4 == flash_emu_getErases());
+  assert(2 == flash_emu_getPageErases(CONFIG_PAGE));
+  assert(2 == flash_emu_getPageErases(CONFIG_PAGE2));
+}
+
+/* Page erases per UPDATES updates of the logs, spread over the pages. */
+static void test_wear(void)
+{
+  unsigned long erases;
+  unsigned long i;
+
+  flash_emu_reset();
+  for(i = 0; i < UPDATES; i++)
+  {
+    assert(E_SF_SUCCESS == loc_write(i));
+  }
+  assert(UPDATES - 1 == loc_read());
+  erases = flash_emu_getErases();
+  printf("configuration: %lu erases per %lu updates, %lu and %lu per page, "
+         "%lu before\n", erases, UPDATES, flash_emu_getPageErases(CONFIG_PAGE),
+         flash_emu_getPageErases(CONFIG_PAGE2), UPDATES);
+  assert(erases <= UPDATES / (SF_PERSISTENTDATASTORAGE_PAGE_SIZE / gConfigRecordLen) + 1);
+  /* The wear is shared by both pages. */
+  assert(flash_emu_getPageErases(CONFIG_PAGE) + 1 >= flash_emu_getPageErases(CONFIG_PAGE2));
+  assert(flash_emu_getPageErases(CONFIG_PAGE2) + 1 >= flash_emu_getPageErases(CONFIG_PAGE));
+
+  flash_emu_reset();
+  for(i = 0; i < UPDATES; i++)
+  {
+    assert(E_SF_SUCCESS == loc_writeDrift((int32_t)i));
+  }
+  printf("drift model:   %lu erases per %lu updates\n", flash_emu_getErases(), UPDATES);
+  assert(flash_emu_getErases() * 100UL <= UPDATES);
+
+  flash_emu_reset();
+  for(i = 0; i < UPDATES; i++)
+  {
+    assert(E_SF_SUCCESS == loc_writeSync(i));
+  }
+  printf("sync context:  %lu erases per %lu updates\n", flash_emu_getErases(), UPDATES);
+  assert(flash_emu_getErases() * 100UL <= UPDATES);
+}
+
+/* Cut the power at every step of one append after the given number of
+   records. The newest complete record must survive, the log must take
+   new records after the power is back. */
+static void test_powerLossAppend(uint32_t records)
+{
+  const uint32_t newValue = 0x10000;
+  uint32_t expectedOld = (0 == records) ? TEST_NONE : records - 1;
+  unsigned long steps;
+  unsigned long cut;
+  uint32_t i;
+  uint32_t value;
+
+  flash_emu_reset();
+  for(i = 0; i < records; i++)
+  {
+    assert(E_SF_SUCCESS == loc_write(i));
+  }
+  flash_emu_save(gSnapshot);
+
+  steps = flash_emu_getOps();
+  assert(E_SF_SUCCESS == loc_write(newValue));
+  steps = flash_emu_getOps() - steps;
+  assert(newValue == loc_read());
+
+  for(cut = 0; cut < steps; cut++)
+  {
+    flash_emu_restore(gSnapshot);
+    flash_emu_powerOn();
+    flash_emu_setBudget((long)cut);
+    assert(E_SF_SUCCESS != loc_write(newValue));
+    assert(flash_emu_powerLost());
+    flash_emu_powerOn();
+
+    /* The record is either complete or the previous one is read. */
+    value = loc_read();
+    assert((expectedOld == value) || (newValue == value));
+
+    /* The log recovers. */
+    assert(E_SF_SUCCESS == loc_write(newValue + 1));
+    assert(newValue + 1 == loc_read());
+    assert(E_SF_SUCCESS == loc_write(newValue + 2));
+    assert(newValue + 2 == loc_read());
+  }
+}
+
+/* Cut the power at every step of a drift model checkpoint. A cut record is
+   never read. The page is erased in place when full, so a cut after the
+   erase loses the checkpoint, which is relearned. */
+static void test_powerLossRecord(uint32_t records)
+{
+  sf_persistent_driftModel_t readModel;
+  unsigned long steps;
+  unsigned long cut;
+  uint32_t i;
+
+  flash_emu_reset();
+  for(i = 0; i < records; i++)
+  {
+    assert(E_SF_SUCCESS == loc_writeDrift((int32_t)i));
+  }
+  flash_emu_save(gSnapshot);
+
+  steps = flash_emu_getOps();
+  assert(E_SF_SUCCESS == loc_writeDrift(-1));
+  steps = flash_emu_getOps() - steps;
+
+  for(cut = 0; cut < steps; cut++)
+  {
+    flash_emu_restore(gSnapshot);
+    flash_emu_powerOn();
+    flash_emu_setBudget((long)cut);
+    assert(E_SF_SUCCESS != loc_writeDrift(-1));
+    flash_emu_powerOn();
+
+    if(E_SF_SUCCESS == sf_persistentDataStorage_readDriftModel(&readModel))
+    {
+      assert((-1 == readModel.driftPpm) ||
+             ((0 != records) && ((int32_t)records - 1 == readModel.driftPpm)));
+    }
+
+    assert(E_SF_SUCCESS == loc_writeDrift(7));
+    assert(E_SF_SUCCESS == sf_persistentDataStorage_readDriftModel(&readModel));
+    assert(7 == readModel.driftPpm);
+  }
+}
+
+int main(void)
+{
+  uint32_t perPage;
+  uint32_t perDriftPage;
+
+  /* Keep the report of the runs before a failed assertion */
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  test_appendAndRead();
+  perPage = SF_PERSISTENTDATASTORAGE_PAGE_SIZE / gConfigRecordLen;
+  perDriftPage = SF_PERSISTENTDATASTORAGE_PAGE_SIZE / sizeof(sf_persistent_driftModel_t);
+  test_pageSwitch();
+  test_wear();
+
+  /* First record, within a page, last slot of a page, switch to the other
+     page with an erase and a switch back */
+  test_powerLossAppend(0);
+  test_powerLossAppend(1);
+  test_powerLossAppend(perPage / 2);
+  test_powerLossAppend(perPage - 1);
+  test_powerLossAppend(perPage);
+  test_powerLossAppend(2 * perPage);
+
+  test_powerLossRecord(0);
+  test_powerLossRecord(3);
+  test_powerLossRecord(perDriftPage);
+
+  printf("test_flashLog: OK\n");
+  return 0;
+}
@@ -0,0 +1,332 @@
+/**
+ @file
+ @brief      Host simulation of the adaptive channel selection of the
+             coordinator under narrowband interference.
+
+ @details The channel selection of tsch-cs runs unchanged on the Contiki-NG
+          processes and timers with a simulated clock. The slot operation of
+          the coordinator is modeled: at the start of every active slot it
+          applies a scheduled blacklist once its ASN is reached, samples the
+          noise on the next channel of the band, including the blacklisted
+          ones, and passes the channel statistics to tsch-cs. The hopping sequence is the default one without the
+          blacklisted entries, in order, as built by tsch.c. All nodes switch
+          in the announced slot, the EBs announcing it are not modeled.
+
+          The PAN is the EU sequence of 12 channels with one uplink slot per
+          SC and one downlink slot of the coordinator per slotframe, the
+          downlink attempts are accounted by tsch-cs. Another 868 MHz system
+          occupies 5 channels of the sequence for the first phase and is off
+          for the second. A frame on an occupied channel is lost if it
+          overlaps a burst, a noise sample finds the channel busy at the
+          duty cycle of the interferer.
+
+          Reported per phase: PDR of the uplink attempts and transmissions per
+          delivered frame with the fixed and the adaptive sequence, after the
+          selection settled, and the blacklist and the number of switches.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/mac/mac.h"
+#include "net/mac/tsch/tsch.h"
+#include "services/tsch-cs/tsch-cs.h"
+
+#define SLOT_US            7500UL
+#define CELLS              24U
+/* Interference on, then off */
+#define PHASE_MIN          40UL
+/* Time for the selection to settle before the PDR of a phase is counted */
+#define SETTLE_MIN         20UL
+#define MIN_SLOTS          (60UL * 1000000UL / SLOT_US)
+/* Frame loss on a clean channel */
+#define BASE_LOSS          0.01
+/* Share of the bursts of the interferer overlapping a frame */
+#define OVERLAP            0.9
+
+static const uint8_t gSequence[] = { 6, 10, 5, 11, 3, 2, 12, 9, 13, 1, 4, 8 };
+
+/* Duty cycle of the interferer per channel 0 to 14 */
+static const double gDuty[TSCH_STATS_NUM_CHANNELS] =
+{
+  0.0, 0.0, 0.6, 0.5, 0.6, 0.4, 0.0, 0.0, 0.0, 0.0, 0.0, 0.5, 0.0, 0.0, 0.0
+};
+
+/* TSCH state of the coordinator */
+int tsch_is_associated;
+int tsch_is_coordinator;
+const uint8_t *default_tsch_hopping_sequence = gSequence;
+uint16_t default_tsch_hopping_sequence_length = sizeof(gSequence);
+struct tsch_asn_t tsch_current_asn;
+tsch_timeslot_timing_usec tsch_timing_us;
+struct tsch_global_stats tsch_stats;
+
+static clock_time_t gNow;
+static bool gInterference;
+
+/* Hopping sequence of the slot operation */
+static uint16_t gBlacklist;
+static uint16_t gNextBlacklist;
+static struct tsch_asn_t gSwitchAsn;
+static bool gSwitchPending;
+static uint8_t gHopping[sizeof(gSequence)];
+static struct tsch_asn_divisor_t gHoppingLen;
+static unsigned gSwitches;
+/* Channel of the next noise sample */
+static uint8_t gMeasChannel;
+
+typedef struct
+{
+  unsigned long attempts;
+  unsigned long delivered;
+} sim_link_t;
+
+typedef struct
+{
+  sim_link_t phase[2];
+  uint16_t blacklist[2];
+  unsigned switches[2];
+} sim_result_t;
+
+static double loc_rand(void)
+{
+  return (double)rand() / ((double)RAND_MAX + 1.0);
+}
+
+/*=== Fakes ==================================================================*/
+clock_time_t clock_time(void)
+{
+  return gNow;
+}
+
+unsigned long clock_seconds(void)
+{
+  return gNow / CLOCK_SECOND;
+}
+
+int tsch_schedule_hopping_blacklist(uint16_t blacklist, const struct tsch_asn_t *asn)
+{
+  unsigned len = 0;
+  unsigned i;
+
+  for(i = 0; i < sizeof(gSequence); i++)
+  {
+    len += (0U == (blacklist & (1U << i)));
+  }
+  if(len < TSCH_HOPPING_MIN_LEN)
+  {
+    return -1;
+  }
+  /* Announced in the EBs before the switch */
+  assert(TSCH_ASN_DIFF(*asn, tsch_current_asn) >=
+         TSCH_CS_SWITCH_DELAY_SEC * 1000000UL / SLOT_US);
+  gNextBlacklist = blacklist;
+  gSwitchAsn = *asn;
+  gSwitchPending = true;
+  return 0;
+}
+
+int tsch_get_hopping_blacklist(uint16_t *blacklist, uint16_t *next_blacklist,
+                               struct tsch_asn_t *asn)
+{
+  *blacklist = gBlacklist;
+  if(gSwitchPending)
+  {
+    *next_blacklist = gNextBlacklist;
+    *asn = gSwitchAsn;
+  }
+  return gSwitchPending;
+}
+
+/*=== Slot operation =========================================================*/
+/* The default sequence without the blacklisted entries, as tsch.c */
+static void loc_applyBlacklist(uint16_t blacklist)
+{
+  unsigned i;
+  uint16_t len = 0;
+
+  for(i = 0; i < sizeof(gSequence); i++)
+  {
+    if(0U == (blacklist & (1U << i)))
+    {
+      gHopping[len++] = gSequence[i];
+    }
+  }
+  TSCH_ASN_DIVISOR_INIT(gHoppingLen, len);
+  gBlacklist = blacklist;
+}
+
+/* Start of an active slot with the given channel offset, returns the
+   channel of the slot */
+static uint8_t loc_slotStart(uint16_t channelOffset, bool adaptive)
+{
+  uint8_t channel;
+  uint8_t index;
+  tsch_stat_t old;
+  uint16_t isFree;
+
+  if(gSwitchPending && ((int32_t)TSCH_ASN_DIFF(tsch_current_asn, gSwitchAsn) >= 0))
+  {
+    loc_applyBlacklist(gNextBlacklist);
+    gSwitchPending = false;
+    gSwitches++;
+  }
+  channel = gHopping[(TSCH_ASN_MOD(tsch_current_asn, gHoppingLen) + channelOffset) %
+                     gHoppingLen.val];
+
+  /* Noise sample of tsch-stats, on all channels in turn */
+  index = tsch_stats_channel_to_index(gMeasChannel);
+  isFree = (gInterference && (loc_rand() < gDuty[index])) ? 0 : TSCH_STATS_BINARY_SCALING_FACTOR;
+  old = tsch_stats.channel_free_ewma[index];
+  TSCH_STATS_EWMA_UPDATE(tsch_stats.channel_free_ewma[index], isFree);
+  if(adaptive)
+  {
+    tsch_cs_channel_stats_updated(gMeasChannel, old);
+  }
+  gMeasChannel = (gMeasChannel + 1U < TSCH_STATS_FIRST_CHANNEL + TSCH_STATS_NUM_CHANNELS) ?
+                 gMeasChannel + 1U : TSCH_STATS_FIRST_CHANNEL;
+  return channel;
+}
+
+static bool loc_send(uint8_t channel)
+{
+  double duty = gInterference ? gDuty[tsch_stats_channel_to_index(channel)] : 0.0;
+
+  return loc_rand() >= BASE_LOSS + (1.0 - BASE_LOSS) * duty * OVERLAP;
+}
+
+/*=== Simulation =============================================================*/
+static void loc_run(bool adaptive, sim_result_t *pRes)
+{
+  unsigned long slots = 2UL * PHASE_MIN * MIN_SLOTS;
+  unsigned long s;
+  unsigned phase;
+  uint16_t ts;
+  uint8_t channel;
+  bool ok;
+  unsigned i;
+
+  memset(pRes, 0, sizeof(*pRes));
+  srand(1);
+  gNow = 0;
+  gSwitchPending = false;
+  gSwitches = 0;
+  gMeasChannel = TSCH_STATS_FIRST_CHANNEL;
+  loc_applyBlacklist(0);
+  TSCH_ASN_INIT(tsch_current_asn, 0, 0);
+  for(i = 0; i < TSCH_STATS_NUM_CHANNELS; i++)
+  {
+    tsch_stats.channel_free_ewma[i] = TSCH_STATS_DEFAULT_CHANNEL_FREE;
+  }
+  if(adaptive)
+  {
+    tsch_cs_adaptations_init();
+  }
+
+  for(s = 0; s < slots; s++)
+  {
+    phase = (s < PHASE_MIN * MIN_SLOTS) ? 0U : 1U;
+    gInterference = (0U == phase);
+    if(s == PHASE_MIN * MIN_SLOTS)
+    {
+      pRes->blacklist[0] = gBlacklist;
+      pRes->switches[0] = gSwitches;
+    }
+
+    /* Slot 0 is the beacon, then the uplinks and the downlink */
+    ts = (uint16_t)(s % APP_SLOTFRAME_SIZE);
+    if(ts <= CELLS + 1U)
+    {
+      channel = loc_slotStart(ts, adaptive);
+      ok = loc_send(channel);
+      if((ts >= 1U) && (ts <= CELLS) &&
+         ((s % (PHASE_MIN * MIN_SLOTS)) >= SETTLE_MIN * MIN_SLOTS))
+      {
+        pRes->phase[phase].attempts++;
+        pRes->phase[phase].delivered += ok;
+      }
+      if(adaptive && (CELLS + 1U == ts))
+      {
+        tsch_cs_tx_packet(channel, ok ? MAC_TX_OK : MAC_TX_NOACK);
+      }
+    }
+
+    TSCH_ASN_INC(tsch_current_asn, 1);
+    gNow = (clock_time_t)((s + 1U) * SLOT_US * CLOCK_SECOND / 1000000UL);
+    if(etimer_pending() &&
+       ((int32_t)(gNow - etimer_next_expiration_time()) >= 0))
+    {
+      etimer_request_poll();
+    }
+    while(process_run() > 0)
+    {
+    }
+  }
+  pRes->blacklist[1] = gBlacklist;
+  pRes->switches[1] = gSwitches - pRes->switches[0];
+}
+
+static double loc_pdr(const sim_link_t *pLink)
+{
+  return (double)pLink->delivered / (double)pLink->attempts;
+}
+
+static void loc_report(const char *pName, const sim_result_t *pRes, unsigned phase)
+{
+  printf("  %-9s PDR %5.1f %%, %.2f Tx per frame, blacklist %03x, %u switches\n",
+         pName, 100.0 * loc_pdr(&pRes->phase[phase]),
+         1.0 / loc_pdr(&pRes->phase[phase]), pRes->blacklist[phase],
+         pRes->switches[phase]);
+}
+
+int main(void)
+{
+  static const char *phases[] = {"interferer on 5 of 12 channels", "interferer off"};
+  sim_result_t fixed;
+  sim_result_t adaptive;
+  uint16_t interfered = 0;
+  unsigned p;
+  unsigned i;
+
+  /* Keep the report of the runs before a failed assertion */
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  tsch_is_associated = 1;
+  tsch_is_coordinator = 1;
+  tsch_timing_us[tsch_ts_timeslot_length] = SLOT_US;
+  process_init();
+  process_start(&etimer_process, NULL);
+
+  for(i = 0; i < sizeof(gSequence); i++)
+  {
+    if(gDuty[tsch_stats_channel_to_index(gSequence[i])] > 0.0)
+    {
+      interfered |= 1U << i;
+    }
+  }
+
+  loc_run(false, &fixed);
+  loc_run(true, &adaptive);
+  for(p = 0; p < 2; p++)
+  {
+    printf("%u SCs, %s, %lu min:\n", CELLS, phases[p], PHASE_MIN);
+    loc_report("fixed", &fixed, p);
+    loc_report("adaptive", &adaptive, p);
+  }
+
+  /* The interfered channels are left, one per switch, without dropping a
+     clean one. The sequence keeps TSCH_HOPPING_MIN_LEN channels. */
+  assert(loc_pdr(&adaptive.phase[0]) > loc_pdr(&fixed.phase[0]) + 0.1);
+  assert(loc_pdr(&adaptive.phase[0]) > 1.0 - 2.0 * BASE_LOSS);
+  assert(interfered == adaptive.blacklist[0]);
+  assert(adaptive.switches[0] <= 5U + 2U);
+  /* All channels are used again once the interferer is off */
+  assert(0U == adaptive.blacklist[1]);
+  assert(adaptive.switches[1] <= 5U + 2U);
+  assert(loc_pdr(&adaptive.phase[1]) > loc_pdr(&fixed.phase[1]) - 0.01);
+
+  printf("test_hoppingSim: OK\n");
+  return 0;
+}
@@ -0,0 +1,130 @@
+/**
+ @file
+ @brief      Host simulation of the join handshake of an SC under frame loss.
+
+ @details The join requester runs unchanged on the model of join_model.h,
+          from the manual join to the connected state.
+
+          Compared are the three-message handshake, the compact handshake
+          and the compact handshake with a BMS-CC not answering it, which
+          falls back to the three-message one. Reported per frame loss rate:
+          time from the join to the connected state and to the first
+          delivered measurement, joins failed (device shut down) and
+          networks left because the compact join was not confirmed.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "join_model.h"
+
+#define LIMIT_MS           (20.0 * 60.0 * 1000.0)
+#define RUNS               200
+
+static int loc_cmp(const void *a, const void *b)
+{
+  double d = *(const double *)a - *(const double *)b;
+
+  return (d > 0) - (d < 0);
+}
+
+typedef struct
+{
+  double connectedMs;
+  double connectedP95Ms;
+  double firstDataMs;
+  unsigned failed;
+  unsigned leaves;
+} sim_summary_t;
+
+static void loc_summarize(const join_model_cfg_t *pCfg, sim_summary_t *pSum)
+{
+  static double connected[RUNS];
+  join_model_result_t res;
+  unsigned n = 0;
+  unsigned i;
+
+  memset(pSum, 0, sizeof(*pSum));
+  for(i = 0; i < RUNS; i++)
+  {
+    join_model_fork(pCfg, i + 1U, false, true, LIMIT_MS, &res);
+    pSum->leaves += res.leaves;
+    if(res.shutdown || (res.connectedMs < 0.0) || (res.firstDataMs < 0.0))
+    {
+      pSum->failed++;
+      continue;
+    }
+    connected[n++] = res.connectedMs;
+    pSum->connectedMs += res.connectedMs;
+    pSum->firstDataMs += res.firstDataMs;
+  }
+  assert(n > 0);
+  qsort(connected, n, sizeof(connected[0]), loc_cmp);
+  pSum->connectedMs /= n;
+  pSum->firstDataMs /= n;
+  pSum->connectedP95Ms = connected[n * 95U / 100U];
+}
+
+int main(void)
+{
+  static const double losses[] = {0.0, 0.1, 0.2, 0.3};
+  static const char *names[] = {"3-message", "compact", "compact, no BMS-CC support"};
+  join_model_cfg_t cfgs[3] =
+  {
+    {0.0, false, true, 0.0, 0.0, 0.0},
+    {0.0, true, true, 0.0, 0.0, 0.0},
+    {0.0, true, false, 0.0, 0.0, 0.0}
+  };
+  sim_summary_t sum[3];
+  join_model_result_t res;
+  join_model_cfg_t cfg;
+  unsigned l;
+  unsigned c;
+
+  /* Keep the report of the runs before a failed assertion */
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  for(l = 0; l < sizeof(losses) / sizeof(losses[0]); l++)
+  {
+    printf("frame loss %.0f %%:\n", 100.0 * losses[l]);
+    for(c = 0; c < 3; c++)
+    {
+      cfgs[c].loss = losses[l];
+      loc_summarize(&cfgs[c], &sum[c]);
+      printf("  %-27s connected %6.1f s (p95 %6.1f s), first data %6.1f s, "
+             "%3u failed, %3u left\n", names[c], sum[c].connectedMs / 1000.0,
+             sum[c].connectedP95Ms / 1000.0, sum[c].firstDataMs / 1000.0,
+             sum[c].failed, sum[c].leaves);
+    }
+
+    /* The compact handshake saves the join successful frame and delivers
+       the first measurement earlier. Without the support of the BMS-CC it
+       falls back after the compact response timeout of 30 s and a request
+       retry and still joins. */
+    assert(sum[1].connectedMs < sum[0].connectedMs);
+    assert(sum[1].firstDataMs < sum[0].firstDataMs);
+    assert(sum[1].failed <= sum[0].failed);
+    assert(sum[2].failed <= sum[0].failed);
+    assert(sum[2].connectedMs < sum[0].connectedMs + 45000.0);
+    assert(0U == sum[0].leaves);
+    assert(0U == sum[2].leaves);
+  }
+
+  /* A compact join the BMS-CC does not confirm leaves the network and joins
+     again after the rejoin backoff. */
+  cfg = cfgs[1];
+  cfg.loss = 0.0;
+  cfg.dataBlockedMs = 90000.0;
+  join_model_fork(&cfg, 1U, false, true, LIMIT_MS, &res);
+  printf("compact join not confirmed until %.0f s: connected %.1f s, "
+         "%u scans, %u left\n", cfg.dataBlockedMs / 1000.0,
+         res.connectedMs / 1000.0, res.scans, res.leaves);
+  assert(!res.shutdown);
+  assert(res.leaves >= 1U);
+  assert(res.scans == res.leaves + 1U);
+  assert(res.connectedMs > cfg.dataBlockedMs);
+
+  printf("test_joinHandshake: OK\n");
+  return 0;
+}
@@ -0,0 +1,340 @@
+/**
+ @file
+ @brief      Host simulation of a pack of SCs joining at the same time.
+
+ @details All cells of a pack are powered up together and associate within
+          the beacon scan time. Each then runs the join request backoff of
+          the module unchanged: it queues a join request whenever its retry
+          timer expires and no request is queued. The MAC is a model of the
+          TSCH CSMA on shared links with the Contiki-NG defaults: a request
+          is sent at the next join request link with an expired backoff
+          window, a collision (two or more senders in a slot) grows the
+          backoff exponent and the window counts the links of the sender,
+          the request is dropped after the last transmission. The former
+          policy queues a request on all join request slots with the
+          default budget of 8 transmissions. With the join backoff the
+          request is sent once in the slot of the cell, a drop moves the
+          cell to another slot, widens its retry window and restarts the
+          CSMA window from the minimum. The BMS-CC answers the ACKed
+          requests in the join process slots, a join takes one for the
+          response and one for the join successful frame. A request state
+          left after SF_JOIN_REQ_TIMEOUT restarts the join with a new scan.
+
+          Compared are the former policy (all join request slots, request
+          every 3 s), the slot and window backoff of the module and the
+          backoff widened by a congestion level the BMS-CC derives from the
+          collided join request slots and signals in the beacons.
+
+          Reported per pack size: time until all cells are joined, median
+          and 95th percentile of the join time, requests sent and collided.
+*/
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "lib/random.h"
+#include "sf_joinBackoff.h"
+
+#define SLOT_MS            7.5
+#define SLOTFRAME_MS       (APP_SLOTFRAME_SIZE * SLOT_MS)
+#define REQ_SLOTS          APP_SLOTFRAME_SECTION_JOIN_REQUEST_SLOTS
+#define PROC_SLOTS         APP_SLOTFRAME_SECTION_JOIN_PROCESS_SLOTS
+/* TSCH CSMA defaults: TSCH_MAC_MIN_BE, TSCH_MAC_MAX_BE and
+   TSCH_MAC_MAX_FRAME_RETRIES + 1 transmissions */
+#define MAC_MIN_BE         2
+#define MAC_MAX_BE         6
+#define MAC_MAX_TX         8
+/* Transmissions of E_SF_TSCH_TRAFFIC_JOIN_REQUEST */
+#define JOIN_REQUEST_TX    1
+/* Request retry time of the former policy */
+#define SHARED_RETRY_MS    3000.0
+/* Beacon scan until the association */
+#define SCAN_MS            30000.0
+/* Join request state timeout, SF_JOIN_REQ_TIMEOUT */
+#define REQ_TIMEOUT_MS     120000.0
+#define LIMIT_MS           (2.0 * 3600.0 * 1000.0)
+#define MAX_CELLS          500
+#define SEEDS              5
+
+typedef enum
+{
+  /* All join request slots, request every 3 s */
+  E_POLICY_SHARED,
+  /* Join request slot and retry window backoff */
+  E_POLICY_BACKOFF,
+  /* The same, widened by the congestion level of the BMS-CC */
+  E_POLICY_CONGESTION,
+  E_POLICY_COUNT
+} E_POLICY_t;
+
+static const char *gPolicyName[E_POLICY_COUNT] =
+{
+  "all slots, 3 s", "slot backoff", "slot backoff + congestion"
+};
+
+typedef struct
+{
+  sf_joinBackoff_t backoff;
+  /* Start of the request state and next expiry of the retry timer */
+  double reqStartMs;
+  double tickMs;
+  double joinedMs;
+  /* Request queued in the MAC and its CSMA state */
+  bool active;
+  bool acked;
+  uint8_t tx;
+  uint8_t be;
+  uint8_t window;
+} cell_t;
+
+typedef struct
+{
+  double allMs;
+  double p50Ms;
+  double p95Ms;
+  unsigned long requests;
+  unsigned long collided;
+  unsigned long restarts;
+} sim_result_t;
+
+static cell_t gCells[MAX_CELLS];
+/* Cells waiting for their join process slots, in the order of their ACK */
+static int gQueue[MAX_CELLS];
+
+/*=== Fakes ==================================================================*/
+unsigned short random_rand(void)
+{
+  return (unsigned short)(rand() >> 8);
+}
+
+/*=== Simulation =============================================================*/
+static double loc_ticksToMs(clock_time_t ticks)
+{
+  return ticks * 1000.0 / CLOCK_SECOND;
+}
+
+static double loc_retryMs(E_POLICY_t policy, const cell_t *pCell, uint8_t congestion)
+{
+  if(E_POLICY_SHARED == policy)
+  {
+    return SHARED_RETRY_MS;
+  }
+  return loc_ticksToMs(sf_joinBackoff_getRetryTime(&pCell->backoff, congestion));
+}
+
+/* Association after a beacon scan, the request process starts with it */
+static void loc_associate(E_POLICY_t policy, cell_t *pCell, uint32_t serial,
+                          double nowMs, uint8_t congestion)
+{
+  sf_joinBackoff_init(&pCell->backoff, serial);
+  pCell->active = false;
+  pCell->be = MAC_MIN_BE;
+  pCell->window = 0;
+  pCell->reqStartMs = nowMs + SCAN_MS * rand() / RAND_MAX;
+  pCell->tickMs = pCell->reqStartMs + loc_retryMs(policy, pCell, congestion);
+}
+
+static bool loc_hasLink(E_POLICY_t policy, const cell_t *pCell, int slot)
+{
+  return (E_POLICY_SHARED == policy) || (pCell->backoff.slot == slot);
+}
+
+static int loc_cmp(const void *a, const void *b)
+{
+  double d = *(const double *)a - *(const double *)b;
+
+  return (d > 0) - (d < 0);
+}
+
+static void loc_run(E_POLICY_t policy, int cells, sim_result_t *pRes)
+{
+  static int senders[MAX_CELLS];
+  static double joined[MAX_CELLS];
+  uint8_t congestion = 0;
+  double collidedAvg = 0.0;
+  int queueHead = 0;
+  int queueTail = 0;
+  int pending = 0;
+  int remaining = cells;
+  int collidedSlots;
+  int served;
+  int nSenders;
+  int i;
+  int s;
+  unsigned long frame;
+  double t0;
+  double ts;
+  cell_t *pCell;
+
+  memset(pRes, 0, sizeof(*pRes));
+  memset(gCells, 0, sizeof(gCells));
+  for(i = 0; i < cells; i++)
+  {
+    gCells[i].joinedMs = -1.0;
+    loc_associate(policy, &gCells[i], 0x1000U + (uint32_t)i, 0.0, 0);
+  }
+
+  for(frame = 0; (remaining > 0) && (frame * SLOTFRAME_MS < LIMIT_MS); frame++)
+  {
+    t0 = frame * SLOTFRAME_MS;
+    collidedSlots = 0;
+
+    for(s = 0; s < REQ_SLOTS; s++)
+    {
+      ts = t0 + (1 + s) * SLOT_MS;
+      nSenders = 0;
+      for(i = 0; i < cells; i++)
+      {
+        pCell = &gCells[i];
+        if(pCell->acked)
+        {
+          continue;
+        }
+        /* Retry timer of the request process */
+        while(pCell->tickMs <= ts)
+        {
+          if(!pCell->active &&
+             (pCell->tickMs - pCell->reqStartMs >= REQ_TIMEOUT_MS))
+          {
+            pRes->restarts++;
+            loc_associate(policy, pCell, 0x1000U + (uint32_t)i,
+                          pCell->tickMs, congestion);
+            continue;
+          }
+          if(!pCell->active)
+          {
+            pCell->active = true;
+            pCell->tx = 0;
+            pRes->requests++;
+          }
+          pCell->tickMs += loc_retryMs(policy, pCell, congestion);
+        }
+        if(!pCell->active || !loc_hasLink(policy, pCell, s))
+        {
+          continue;
+        }
+        if(pCell->window > 0)
+        {
+          pCell->window--;
+          continue;
+        }
+        senders[nSenders++] = i;
+      }
+
+      if(1 == nSenders)
+      {
+        pCell = &gCells[senders[0]];
+        pCell->active = false;
+        pCell->acked = true;
+        gQueue[queueTail++] = senders[0];
+        pending++;
+        continue;
+      }
+      if(nSenders > 1)
+      {
+        collidedSlots++;
+        pRes->collided += nSenders;
+      }
+      for(i = 0; i < nSenders; i++)
+      {
+        pCell = &gCells[senders[i]];
+        pCell->tx++;
+        pCell->be = ((pCell->be < MAC_MAX_BE) ? pCell->be : MAC_MAX_BE) + 1;
+        pCell->window = (uint8_t)(random_rand() % (1U << pCell->be));
+        if(pCell->tx >= ((E_POLICY_SHARED == policy) ? MAC_MAX_TX : JOIN_REQUEST_TX))
+        {
+          pCell->active = false;
+          if(E_POLICY_SHARED != policy)
+          {
+            /* As loc_joinBackoff(), tsch_queue_backoff_reset() */
+            sf_joinBackoff_failed(&pCell->backoff);
+            pCell->be = MAC_MIN_BE + 1;
+            pCell->window = (uint8_t)(random_rand() % (1U << pCell->be));
+          }
+        }
+      }
+    }
+
+    /* Join process slots: response and join successful frame */
+    for(served = 0; (served + 2 <= PROC_SLOTS) && (pending > 0); served += 2)
+    {
+      pCell = &gCells[gQueue[queueHead++]];
+      pending--;
+      pCell->joinedMs = t0 + SLOTFRAME_MS + (1 + REQ_SLOTS + served) * SLOT_MS;
+      remaining--;
+    }
+
+    /* Congestion level of the BMS-CC, signaled in the next beacon */
+    collidedAvg += (collidedSlots - collidedAvg) / 4.0;
+    if(E_POLICY_CONGESTION == policy)
+    {
+      congestion = (collidedAvg >= REQ_SLOTS / 2) ? 3U :
+                   (collidedAvg >= REQ_SLOTS / 4) ? 2U :
+                   (collidedAvg >= 1.0) ? 1U : 0U;
+    }
+  }
+
+  for(i = 0; i < cells; i++)
+  {
+    joined[i] = (gCells[i].joinedMs < 0.0) ? LIMIT_MS : gCells[i].joinedMs;
+  }
+  qsort(joined, cells, sizeof(joined[0]), loc_cmp);
+  pRes->allMs = joined[cells - 1];
+  pRes->p50Ms = joined[cells / 2];
+  pRes->p95Ms = joined[cells * 95 / 100];
+}
+
+static void loc_accumulate(sim_result_t *pSum, const sim_result_t *pRes)
+{
+  pSum->allMs += pRes->allMs / SEEDS;
+  pSum->p50Ms += pRes->p50Ms / SEEDS;
+  pSum->p95Ms += pRes->p95Ms / SEEDS;
+  pSum->requests += pRes->requests;
+  pSum->collided += pRes->collided;
+  pSum->restarts += pRes->restarts;
+}
+
+int main(void)
+{
+  static const int packs[] = {100, 200, 300, 500};
+  sim_result_t sum[E_POLICY_COUNT];
+  sim_result_t res;
+  unsigned p;
+  int policy;
+  int seed;
+
+  for(p = 0; p < sizeof(packs) / sizeof(packs[0]); p++)
+  {
+    printf("%d cells:\n", packs[p]);
+    for(policy = 0; policy < E_POLICY_COUNT; policy++)
+    {
+      memset(&sum[policy], 0, sizeof(sum[policy]));
+      for(seed = 1; seed <= SEEDS; seed++)
+      {
+        srand(seed);
+        loc_run((E_POLICY_t)policy, packs[p], &res);
+        loc_accumulate(&sum[policy], &res);
+      }
+      printf("  %-26s all joined %6.1f s, join time p50 %6.1f s p95 %6.1f s, "
+             "%5lu requests, %6lu collided Tx, %4lu restarts\n",
+             gPolicyName[policy], sum[policy].allMs / 1000.0,
+             sum[policy].p50Ms / 1000.0, sum[policy].p95Ms / 1000.0,
+             sum[policy].requests / SEEDS, sum[policy].collided / SEEDS,
+             sum[policy].restarts / SEEDS);
+    }
+
+    /* The backoff with the congestion level joins the pack faster, the
+       former policy does not join a pack of 500 within the limit. */
+    assert(sum[E_POLICY_CONGESTION].allMs < sum[E_POLICY_SHARED].allMs);
+    assert(sum[E_POLICY_CONGESTION].p50Ms < sum[E_POLICY_SHARED].p50Ms);
+    assert(sum[E_POLICY_CONGESTION].allMs <= sum[E_POLICY_BACKOFF].allMs * 1.1);
+    assert(sum[E_POLICY_CONGESTION].allMs < 2.5 * packs[p] * 1000.0);
+  }
+  assert(sum[E_POLICY_SHARED].allMs >= LIMIT_MS);
+
+  printf("test_joinSim: OK\n");
+  return 0;
+}
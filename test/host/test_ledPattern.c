@@ -0,0 +1,340 @@
+/**
+ @file
+ @brief      Host test of the queued LED pattern engine on a fake clock.
+
+ @details The engine runs unchanged on the Contiki-NG processes and timers.
+          The clock advances one tick at a time, the LED transitions and the
+          completion events are logged with their tick. Tested are the
+          timing of a flash, the factory reset sequence of four flashes
+          back to back, the full queue, a pattern queued from a completion
+          callback and a pattern taking over from a blinking LED.
+
+          A ticker process waiting on an etimer of one tick runs alongside:
+          the patterns never keep it from running, where the former busy
+          wait stalled the scheduler for about one second per flash.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "sf_led.h"
+
+/* Ticks of the 200 ms on and 800 ms off time of a flash */
+#define FLASH_ON           (CLOCK_SECOND * 200U / 1000U)
+#define FLASH_OFF          (CLOCK_SECOND * 800U / 1000U)
+#define FLASH_TICKS        (FLASH_ON + FLASH_OFF)
+#define LOG_MAX            64U
+#define LEDS               2U
+
+typedef struct
+{
+  clock_time_t time;
+  /* LED and new state, or the data of a completion event */
+  leds_num_t led;
+  bool on;
+  void *ptr;
+} log_entry_t;
+
+static clock_time_t gNow;
+static bool gLed[LEDS];
+static log_entry_t gLedLog[LOG_MAX];
+static unsigned gLedLogCount;
+static log_entry_t gEventLog[LOG_MAX];
+static unsigned gEventLogCount;
+static unsigned long gTicks;
+static unsigned gCallbacks;
+
+PROCESS(test_process, "LED test");
+PROCESS(ticker_process, "Ticker");
+
+/*=== Fakes ==================================================================*/
+clock_time_t clock_time(void)
+{
+  return gNow;
+}
+
+unsigned long clock_seconds(void)
+{
+  return gNow / CLOCK_SECOND;
+}
+
+static void loc_setLed(leds_num_t led, bool on)
+{
+  assert(led < LEDS);
+  if(gLed[led] != on)
+  {
+    assert(gLedLogCount < LOG_MAX);
+    gLedLog[gLedLogCount].time = gNow;
+    gLedLog[gLedLogCount].led = led;
+    gLedLog[gLedLogCount].on = on;
+    gLedLogCount++;
+  }
+  gLed[led] = on;
+}
+
+void leds_single_on(leds_num_t led)
+{
+  loc_setLed(led, true);
+}
+
+void leds_single_off(leds_num_t led)
+{
+  loc_setLed(led, false);
+}
+
+/*=== Processes ==============================================================*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  while(1)
+  {
+    PROCESS_WAIT_EVENT();
+    if(ev == sf_led_event)
+    {
+      assert(gEventLogCount < LOG_MAX);
+      gEventLog[gEventLogCount].time = gNow;
+      gEventLog[gEventLogCount].ptr = data;
+      gEventLogCount++;
+    }
+  }
+
+  PROCESS_END();
+}
+
+PROCESS_THREAD(ticker_process, ev, data)
+{
+  static struct etimer timer;
+
+  PROCESS_BEGIN();
+
+  etimer_set(&timer, 1);
+  while(1)
+  {
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&timer));
+    gTicks++;
+    etimer_reset(&timer);
+  }
+
+  PROCESS_END();
+}
+
+/*=== Helpers ================================================================*/
+static void loc_run(void)
+{
+  while(process_run() > 0)
+  {
+  }
+}
+
+/* Advance the clock tick by tick, running the due timers. */
+static void loc_advance(clock_time_t ticks)
+{
+  while(ticks--)
+  {
+    gNow++;
+    if(etimer_pending() &&
+       ((int32_t)(gNow - etimer_next_expiration_time()) >= 0))
+    {
+      etimer_request_poll();
+    }
+    loc_run();
+  }
+}
+
+static void loc_clearLogs(void)
+{
+  gLedLogCount = 0;
+  gEventLogCount = 0;
+  gCallbacks = 0;
+}
+
+/* Queue a pattern as the test process, returns whether it has been queued.
+   The call returns on the same tick. */
+static bool loc_queue(leds_num_t led, uint16_t onMs, uint16_t offMs,
+                      sf_led_callback_t callback, void *ptr)
+{
+  clock_time_t start = gNow;
+  bool queued;
+
+  PROCESS_CONTEXT_BEGIN(&test_process);
+  queued = sf_led_queuePattern(led, onMs, offMs, callback, ptr);
+  PROCESS_CONTEXT_END(&test_process);
+  assert(start == gNow);
+  return queued;
+}
+
+static bool loc_flash(leds_num_t led, void *ptr)
+{
+  return loc_queue(led, 200U, 800U, NULL, ptr);
+}
+
+/* The LED log entry i is the given transition at the given tick. */
+static void loc_checkLed(unsigned i, clock_time_t time, leds_num_t led, bool on)
+{
+  assert(i < gLedLogCount);
+  assert((time == gLedLog[i].time) && (led == gLedLog[i].led) &&
+         (on == gLedLog[i].on));
+}
+
+static void loc_callback(void *ptr)
+{
+  (void)ptr;
+  gCallbacks++;
+}
+
+static void loc_chainCallback(void *ptr)
+{
+  gCallbacks++;
+  /* Queued from the timer, which runs in the context of the process that
+     queued the first pattern */
+  if(NULL != ptr)
+  {
+    assert(sf_led_queuePattern(LEDS_CONF_GREEN, 100U, 100U, loc_callback, NULL));
+  }
+}
+
+/*=== Tests ==================================================================*/
+/* A flash is 200 ms on and 800 ms off, the event follows the off time. */
+static void test_flash(void)
+{
+  clock_time_t start = gNow;
+  int tag;
+
+  loc_clearLogs();
+  assert(!sf_led_isBusy());
+  assert(loc_flash(LEDS_CONF_RED, &tag));
+  assert(sf_led_isBusy());
+  loc_checkLed(0, start, LEDS_CONF_RED, true);
+
+  loc_advance(FLASH_TICKS + 10U);
+  assert(2U == gLedLogCount);
+  loc_checkLed(1, start + FLASH_ON, LEDS_CONF_RED, false);
+  assert(1U == gEventLogCount);
+  assert((start + FLASH_TICKS == gEventLog[0].time) && (&tag == gEventLog[0].ptr));
+  assert(!sf_led_isBusy());
+}
+
+/* The four flashes of the factory reset are shown back to back, with the
+   events in order, while the ticker keeps running every tick. */
+static void test_factoryReset(void)
+{
+  static int tags[4];
+  clock_time_t start = gNow;
+  unsigned long ticks = gTicks;
+  unsigned i;
+
+  loc_clearLogs();
+  for(i = 0; i < 4U; i++)
+  {
+    assert(loc_flash((0U == (i % 2U)) ? LEDS_CONF_RED : LEDS_CONF_GREEN, &tags[i]));
+  }
+  loc_advance(4U * FLASH_TICKS);
+
+  assert(8U == gLedLogCount);
+  assert(4U == gEventLogCount);
+  for(i = 0; i < 4U; i++)
+  {
+    loc_checkLed(2U * i, start + i * FLASH_TICKS,
+                 (0U == (i % 2U)) ? LEDS_CONF_RED : LEDS_CONF_GREEN, true);
+    loc_checkLed(2U * i + 1U, start + i * FLASH_TICKS + FLASH_ON,
+                 (0U == (i % 2U)) ? LEDS_CONF_RED : LEDS_CONF_GREEN, false);
+    assert((start + (i + 1U) * FLASH_TICKS == gEventLog[i].time) &&
+           (&tags[i] == gEventLog[i].ptr));
+  }
+  assert(!sf_led_isBusy());
+
+  printf("factory reset: 4 flashes in %lu ms, ticker ran %lu of %lu ticks\n",
+         (unsigned long)(gNow - start) * 1000UL / CLOCK_SECOND, gTicks - ticks,
+         (unsigned long)(gNow - start));
+  assert(gNow - start == gTicks - ticks);
+}
+
+/* The queue holds 7 patterns, a pattern is refused when it is full. */
+static void test_full(void)
+{
+  unsigned i;
+
+  loc_clearLogs();
+  for(i = 0; i < 7U; i++)
+  {
+    assert(loc_queue(LEDS_CONF_GREEN, 10U, 10U, loc_callback, NULL));
+  }
+  assert(!loc_queue(LEDS_CONF_GREEN, 10U, 10U, loc_callback, NULL));
+
+  /* Room again once the first pattern is done */
+  loc_advance(CLOCK_SECOND * 20U / 1000U + 1U);
+  assert(1U == gCallbacks);
+  assert(loc_queue(LEDS_CONF_GREEN, 10U, 10U, loc_callback, NULL));
+  loc_advance(CLOCK_SECOND);
+  assert(8U == gCallbacks);
+  assert(8U == gEventLogCount);
+  assert(!sf_led_isBusy());
+}
+
+/* A pattern queued by the completion callback follows directly. */
+static void test_chain(void)
+{
+  int tag;
+  clock_time_t start = gNow;
+
+  loc_clearLogs();
+  assert(loc_queue(LEDS_CONF_RED, 100U, 100U, loc_chainCallback, &tag));
+  loc_advance(CLOCK_SECOND);
+  assert(2U == gCallbacks);
+  assert(2U == gEventLogCount);
+  assert((&tag == gEventLog[0].ptr) && (NULL == gEventLog[1].ptr));
+  loc_checkLed(2, start + 2U * (CLOCK_SECOND * 100U / 1000U), LEDS_CONF_GREEN, true);
+  assert(!sf_led_isBusy());
+}
+
+/* A pattern takes over from a blinking LED, which stays off afterwards. No
+   other LED is switched on when the blinking stops. */
+static void test_blink(void)
+{
+  clock_time_t start;
+  bool greenOn;
+
+  loc_clearLogs();
+  sf_led_startBlink(LEDS_CONF_GREEN, 100U, 100U);
+  loc_run();
+  /* Stopped in the off period */
+  loc_advance(CLOCK_SECOND / 2U);
+  assert(gLedLogCount > 2U);
+  assert(!gLed[LEDS_CONF_GREEN]);
+
+  loc_clearLogs();
+  start = gNow;
+  greenOn = gLed[LEDS_CONF_GREEN];
+  assert(loc_flash(LEDS_CONF_RED, NULL));
+  loc_advance(2U * FLASH_TICKS);
+  assert((greenOn ? 3U : 2U) == gLedLogCount);
+  assert(!gLed[LEDS_CONF_GREEN] && !gLed[LEDS_CONF_RED]);
+  loc_checkLed(gLedLogCount - 1U, start + FLASH_ON, LEDS_CONF_RED, false);
+  /* The blinking does not resume */
+  loc_advance(CLOCK_SECOND);
+  assert(!gLed[LEDS_CONF_GREEN]);
+}
+
+int main(void)
+{
+  /* Keep the report of the runs before a failed assertion */
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  process_init();
+  process_start(&etimer_process, NULL);
+  ctimer_init();
+  process_start(&test_process, NULL);
+  process_start(&ticker_process, NULL);
+  loc_run();
+
+  test_flash();
+  test_factoryReset();
+  test_full();
+  test_chain();
+  test_blink();
+
+  printf("test_ledPattern: OK\n");
+  return 0;
+}
@@ -0,0 +1,229 @@
+/**
+ @file
+ @brief      Host test of the measurement frame encoder and decoder.
+
+ @details Checks the varint boundaries of the timestamp differences and the
+          rejection of malformed frames. A stream of measurements with
+          irregular intervals and outages is then sent in frames of one to
+          several measurements, newest first as the journal replay does,
+          and in legacy frames. The absolute time reconstructed from the
+          frames must stay within the timestamp resolution of the true
+          time. The error and the bytes per measurement are reported.
+*/
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sf_frameType.h"
+#include "sf_measFrame.h"
+
+/* Payload of the measurement frames, as in sf_measSender.c */
+#define PAYLOAD_LEN_MAX  40U
+#define STREAM_LEN       100000U
+#define BATCH_MAX        8U
+
+static meas_t loc_meas(uint64_t timeMs, float value)
+{
+  meas_t m;
+
+  m.timeStamp = (uint32_t)(timeMs / 1000U);
+  m.timeStampMs = (uint16_t)(timeMs % 1000U);
+  m.value = value;
+  return m;
+}
+
+static uint64_t loc_ms(const meas_t *pMeas)
+{
+  return (uint64_t)pMeas->timeStamp * 1000U + pMeas->timeStampMs;
+}
+
+/* Length of the frame of two measurements delta ms apart */
+static uint8_t loc_pairLen(int64_t delta)
+{
+  uint8_t buf[PAYLOAD_LEN_MAX];
+  meas_t in[2];
+  meas_t out[2];
+  uint8_t num = 2U;
+  uint8_t len;
+
+  in[0] = loc_meas(1700000000000ULL, 1.5f);
+  in[1] = loc_meas(1700000000000ULL + delta, -2.25f);
+  len = sf_measFrame_encode(buf, sizeof(buf), in, &num);
+  if(2U == num)
+  {
+    assert(2U == sf_measFrame_decode(buf, len, out, 2U));
+    assert(0 == memcmp(in, out, sizeof(in)));
+  }
+  return (2U == num) ? len : 0U;
+}
+
+static void test_encoding(void)
+{
+  uint8_t buf[PAYLOAD_LEN_MAX];
+  meas_t in[BATCH_MAX];
+  meas_t out[BATCH_MAX];
+  uint8_t num;
+  uint8_t len;
+  uint8_t i;
+
+  /* One measurement */
+  in[0] = loc_meas(1700000000123ULL, 3.0f);
+  num = 1U;
+  len = sf_measFrame_encode(buf, sizeof(buf), in, &num);
+  assert((1U == num) && (SF_MEAS_FRAME_HR_LEN_MIN == len));
+  assert(E_FRAME_TYPE_MEASUREMENT_HR == buf[0]);
+  assert(1U == sf_measFrame_decode(buf, len, out, 1U));
+  assert(0 == memcmp(&in[0], &out[0], sizeof(meas_t)));
+
+  /* Varint boundaries, zigzag encoded */
+  assert(SF_MEAS_FRAME_HR_LEN_MIN + 1U + 4U == loc_pairLen(0));
+  assert(SF_MEAS_FRAME_HR_LEN_MIN + 1U + 4U == loc_pairLen(63));
+  assert(SF_MEAS_FRAME_HR_LEN_MIN + 1U + 4U == loc_pairLen(-64));
+  assert(SF_MEAS_FRAME_HR_LEN_MIN + 2U + 4U == loc_pairLen(64));
+  assert(SF_MEAS_FRAME_HR_LEN_MIN + 2U + 4U == loc_pairLen(-65));
+  assert(SF_MEAS_FRAME_HR_LEN_MIN + 2U + 4U == loc_pairLen(8191));
+  assert(SF_MEAS_FRAME_HR_LEN_MIN + 3U + 4U == loc_pairLen(8192));
+  assert(SF_MEAS_FRAME_HR_LEN_MIN + 5U + 4U == loc_pairLen(INT32_MAX));
+  assert(SF_MEAS_FRAME_HR_LEN_MIN + 5U + 4U == loc_pairLen(INT32_MIN));
+  /* Beyond 2^31 ms only the first one is sent */
+  assert(0U == loc_pairLen((int64_t)INT32_MAX + 1));
+
+  /* As many as fit */
+  for(i = 0U; i < BATCH_MAX; i++)
+  {
+    in[i] = loc_meas(1700000000000ULL + i * 3000U, (float)i);
+  }
+  num = BATCH_MAX;
+  len = sf_measFrame_encode(buf, sizeof(buf), in, &num);
+  assert((5U == num) && (SF_MEAS_FRAME_HR_LEN_MIN + 4U * 6U == len));
+  assert(num == sf_measFrame_decode(buf, len, out, BATCH_MAX));
+  assert(0 == memcmp(in, out, num * sizeof(meas_t)));
+  num = 1U;
+  assert(0U == sf_measFrame_encode(buf, SF_MEAS_FRAME_HR_LEN_MIN - 1U, in, &num));
+  assert(0U == num);
+
+  /* Malformed frames */
+  num = 3U;
+  len = sf_measFrame_encode(buf, sizeof(buf), in, &num);
+  assert(0U == sf_measFrame_decode(buf, len, out, 2U));
+  assert(0U == sf_measFrame_decode(buf, len - 1U, out, BATCH_MAX));
+  assert(0U == sf_measFrame_decode(buf, len + 1U, out, BATCH_MAX));
+  buf[1] = 0U;
+  assert(0U == sf_measFrame_decode(buf, len, out, BATCH_MAX));
+  buf[0] = E_FRAME_TYPE_REMOTE;
+  assert(0U == sf_measFrame_decode(buf, len, out, BATCH_MAX));
+
+  /* Legacy frame */
+  sf_frameType_set(buf, E_FRAME_TYPE_MEASUREMENT);
+  memcpy(buf + 1, &in[1].timeStamp, 4);
+  memcpy(buf + 5, &in[1].value, 4);
+  assert(1U == sf_measFrame_decode(buf, SF_MEAS_FRAME_LEGACY_LEN, out, 1U));
+  assert((in[1].timeStamp == out[0].timeStamp) && (0U == out[0].timeStampMs) &&
+         (in[1].value == out[0].value));
+}
+
+static void test_reconstruction(void)
+{
+  static meas_t stream[STREAM_LEN];
+  static uint64_t trueUs[STREAM_LEN];
+  static bool sent[STREAM_LEN];
+  uint8_t buf[PAYLOAD_LEN_MAX];
+  uint32_t idx[BATCH_MAX];
+  meas_t batch[BATCH_MAX];
+  meas_t out[BATCH_MAX];
+  uint64_t us = 1700000000ULL * 1000000U + 777777U;
+  uint64_t errHr = 0;
+  uint64_t errLegacy = 0;
+  uint64_t err;
+  unsigned long bytes = 0;
+  unsigned long frames = 0;
+  uint32_t first = 0;
+  uint32_t i;
+  uint8_t num;
+  uint8_t len;
+  uint8_t j;
+
+  srand(1);
+  for(i = 0; i < STREAM_LEN; i++)
+  {
+    /* 50 ms to 5 s apart, an outage of up to 3 h now and then */
+    us += 50000U + (uint64_t)(rand() % 4950000);
+    if(0 == rand() % 1000)
+    {
+      us += (uint64_t)(rand() % 10800) * 1000000U;
+    }
+    trueUs[i] = us;
+    /* Timestamp of sf_absoluteTime_getTimeMs(), the value tells the index */
+    stream[i] = loc_meas(us / 1000U, (float)i);
+  }
+
+  while(first < STREAM_LEN)
+  {
+    /* The oldest unsent ones, up to BATCH_MAX */
+    num = 0U;
+    for(i = first; (i < STREAM_LEN) && (num < 1U + rand() % BATCH_MAX); i++)
+    {
+      if(!sent[i])
+      {
+        idx[num++] = i;
+      }
+    }
+    /* The newest one first as the current measurement, then the older
+       ones from the journal, oldest first */
+    batch[0] = stream[idx[num - 1U]];
+    for(j = 1U; j < num; j++)
+    {
+      batch[j] = stream[idx[j - 1U]];
+    }
+
+    /* The ones that do not fit follow in the next frames */
+    len = sf_measFrame_encode(buf, sizeof(buf), batch, &num);
+    assert((len > 0U) && (len <= sizeof(buf)));
+    assert(num == sf_measFrame_decode(buf, len, out, BATCH_MAX));
+    for(j = 0; j < num; j++)
+    {
+      i = (uint32_t)out[j].value;
+      assert(out[j].value == batch[j].value);
+      assert(!sent[i]);
+      sent[i] = true;
+      assert(trueUs[i] >= loc_ms(&out[j]) * 1000U);
+      err = trueUs[i] - loc_ms(&out[j]) * 1000U;
+      errHr = (err > errHr) ? err : errHr;
+    }
+    bytes += len;
+    frames++;
+
+    while((first < STREAM_LEN) && sent[first])
+    {
+      first++;
+    }
+  }
+  assert(errHr < 1000U);
+  printf("high resolution: %u measurements in %lu frames, %.2f bytes per "
+         "measurement, error max %u us\n", STREAM_LEN, frames,
+         (double)bytes / STREAM_LEN, (unsigned)errHr);
+
+  for(i = 0; i < STREAM_LEN; i++)
+  {
+    sf_frameType_set(buf, E_FRAME_TYPE_MEASUREMENT);
+    memcpy(buf + 1, &stream[i].timeStamp, 4);
+    memcpy(buf + 5, &stream[i].value, 4);
+    assert(1U == sf_measFrame_decode(buf, SF_MEAS_FRAME_LEGACY_LEN, out, 1U));
+    err = trueUs[i] - loc_ms(&out[0]) * 1000U;
+    errLegacy = (err > errLegacy) ? err : errLegacy;
+  }
+  assert(errLegacy < 1000000U);
+  printf("legacy: %u bytes per measurement, error max %u us\n",
+         SF_MEAS_FRAME_LEGACY_LEN, (unsigned)errLegacy);
+}
+
+int main(void)
+{
+  test_encoding();
+  test_reconstruction();
+
+  printf("test_measFrame: OK\n");
+  return 0;
+}
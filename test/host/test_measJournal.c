@@ -0,0 +1,327 @@
+/**
+ @file
+ @brief      Host test of the measurement journal on the flash emulation.
+
+ @details The journal runs unchanged on flash_emu. Tested are the replay
+          in order, a reboot during the replay, the overwrite of the oldest
+          page when the journal is full and power losses at every
+          programmed byte and page erase of a block.
+
+          Reported per measurement interval for one day of outage: flash
+          bytes per measurement, erases per journal page and the days of
+          outage until the page endurance is reached, flash time per
+          measurement and of the longest add, and the measurements kept.
+          Compared is the former block of 8 plain records of 10 bytes.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sf_persistentDataStorage.h"
+#include "sf_measJournal.h"
+#include "flash_emu.h"
+
+/* Journal pages below the pages of the persistent data storage */
+#define JOURNAL_PAGE       (FLASH_EMU_PAGES - SF_PERSISTENTDATASTORAGE_PAGES_USED - 2U)
+/* Measurements per replay frame */
+#define REPLAY             5U
+#define DAY_S              86400UL
+#define MEAS_MAX           30000U
+/* Former block: state, count, sequence number, 8 records of 10 bytes and
+   the CRC */
+#define FORMER_RECORDS     8U
+#define FORMER_BLOCK_LEN   (4U + FORMER_RECORDS * 10U + 2U)
+
+static meas_t gMeas[MEAS_MAX];
+static meas_t gReplayed[MEAS_MAX];
+
+/*=== Helpers ================================================================*/
+/* Measurements every intervalS seconds with a jitter of +-10 ms */
+static void loc_makeMeas(unsigned count, unsigned intervalS)
+{
+  unsigned long long ms = 1700000000ULL * 1000ULL;
+  unsigned i;
+
+  assert(count <= MEAS_MAX);
+  srand(1);
+  for(i = 0; i < count; i++)
+  {
+    ms += intervalS * 1000ULL + (unsigned long long)(rand() % 21) - 10ULL;
+    gMeas[i].timeStamp = (uint32_t)(ms / 1000ULL);
+    gMeas[i].timeStampMs = (uint16_t)(ms % 1000ULL);
+    gMeas[i].value = 25.0f + (float)(rand() % 1000) / 100.0f;
+  }
+}
+
+static bool loc_equal(const meas_t *pA, const meas_t *pB)
+{
+  return (pA->timeStamp == pB->timeStamp) &&
+         (pA->timeStampMs == pB->timeStampMs) &&
+         (0 == memcmp(&pA->value, &pB->value, sizeof(pA->value)));
+}
+
+/* Index of a measurement in gMeas, -1 if it is none of them */
+static int loc_find(const meas_t *pMeas, unsigned count)
+{
+  unsigned i;
+
+  for(i = 0; i < count; i++)
+  {
+    if(loc_equal(pMeas, &gMeas[i]))
+    {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+/* Replay and acknowledge the whole journal, returns the number replayed */
+static unsigned loc_replayAll(void)
+{
+  unsigned count = 0;
+  uint8_t n;
+
+  while(0U != (n = sf_measJournal_peek(&gReplayed[count], REPLAY)))
+  {
+    sf_measJournal_commit(n);
+    count += n;
+    assert(count <= MEAS_MAX);
+  }
+  return count;
+}
+
+/* The replayed measurements are gMeas[first] onwards, in order. Returns
+   the index of the first one, -1 if none has been replayed. */
+static int loc_checkRange(unsigned replayed, unsigned count)
+{
+  int first;
+  unsigned i;
+
+  if(0U == replayed)
+  {
+    return -1;
+  }
+  first = loc_find(&gReplayed[0], count);
+  assert(first >= 0);
+  assert((unsigned)first + replayed <= count);
+  for(i = 0; i < replayed; i++)
+  {
+    assert(loc_equal(&gReplayed[i], &gMeas[first + i]));
+  }
+  return first;
+}
+
+/*=== Tests ==================================================================*/
+/* All measurements come back in order, from flash and from RAM. */
+static void test_replay(void)
+{
+  const unsigned count = 100U;
+  unsigned i;
+
+  flash_emu_reset();
+  sf_measJournal_init();
+  loc_makeMeas(count, 3U);
+  for(i = 0; i < count; i++)
+  {
+    assert(sf_measJournal_add(&gMeas[i]));
+  }
+  assert(count == loc_replayAll());
+  assert(0 == loc_checkRange(count, count));
+  assert(0U == loc_replayAll());
+
+  /* Nothing acknowledged, the same measurements are peeked again. */
+  assert(sf_measJournal_add(&gMeas[0]));
+  assert(1U == sf_measJournal_peek(gReplayed, REPLAY));
+  sf_measJournal_commit(0);
+  assert(1U == sf_measJournal_peek(gReplayed, REPLAY));
+  sf_measJournal_commit(1);
+  assert(0U == sf_measJournal_peek(gReplayed, REPLAY));
+}
+
+/* A reboot keeps the blocks in flash and loses the records in RAM. The
+   records of a partly replayed block are sent again. */
+static void test_reboot(void)
+{
+  const unsigned count = 100U;
+  unsigned replayed = 0;
+  unsigned i;
+  uint8_t n;
+  int first;
+
+  flash_emu_reset();
+  sf_measJournal_init();
+  loc_makeMeas(count, 3U);
+  for(i = 0; i < count; i++)
+  {
+    assert(sf_measJournal_add(&gMeas[i]));
+  }
+  while(replayed < 30U)
+  {
+    n = sf_measJournal_peek(gReplayed, REPLAY);
+    sf_measJournal_commit(n);
+    replayed += n;
+  }
+
+  sf_measJournal_init();
+  n = (uint8_t)loc_replayAll();
+  first = loc_checkRange(n, count);
+  assert((first >= 0) && (first <= 30));
+  /* No more than a block was lost in RAM */
+  assert((unsigned)first + n > count - 25U);
+}
+
+/* A full journal drops the oldest page and keeps the newest blocks. */
+static void test_full(void)
+{
+  const unsigned count = 10000U;
+  unsigned replayed;
+  unsigned i;
+  int first;
+
+  flash_emu_reset();
+  sf_measJournal_init();
+  loc_makeMeas(count, 3U);
+  for(i = 0; i < count; i++)
+  {
+    assert(sf_measJournal_add(&gMeas[i]));
+  }
+  replayed = loc_replayAll();
+  first = loc_checkRange(replayed, count);
+  assert(count == (unsigned)first + replayed);
+  /* At least one page of blocks is kept */
+  assert(replayed > SF_PERSISTENTDATASTORAGE_PAGE_SIZE / 128U * 15U);
+}
+
+/* Cut the power at every step of the add writing the given block. The
+   blocks before it are replayed after the reboot, never a cut one. */
+static void test_powerLoss(unsigned block)
+{
+  const unsigned count = 400U;
+  unsigned long ops;
+  unsigned long steps = 0;
+  unsigned long cut;
+  unsigned trigger = 0;
+  unsigned blocks = 0;
+  unsigned replayed;
+  unsigned i;
+  int first;
+
+  loc_makeMeas(count, 3U);
+  flash_emu_reset();
+  sf_measJournal_init();
+  for(i = 0; (i < count) && (0UL == steps); i++)
+  {
+    ops = flash_emu_getOps();
+    assert(sf_measJournal_add(&gMeas[i]));
+    if(ops != flash_emu_getOps())
+    {
+      if(block == blocks++)
+      {
+        trigger = i;
+        steps = flash_emu_getOps() - ops;
+      }
+    }
+  }
+  assert(0UL != steps);
+
+  for(cut = 0; cut < steps; cut++)
+  {
+    flash_emu_reset();
+    sf_measJournal_init();
+    for(i = 0; i < trigger; i++)
+    {
+      assert(sf_measJournal_add(&gMeas[i]));
+    }
+    flash_emu_setBudget((long)cut);
+    sf_measJournal_add(&gMeas[trigger]);
+    assert(flash_emu_powerLost());
+    flash_emu_powerOn();
+
+    sf_measJournal_init();
+    replayed = loc_replayAll();
+    first = loc_checkRange(replayed, count);
+    assert((0U == replayed) || (0 == first));
+    /* The earlier blocks are complete, the cut one is not replayed. */
+    assert(replayed < trigger);
+    assert((0U == block) || (replayed > 0U));
+
+    /* The journal takes new blocks after the power is back. */
+    for(i = 0; i < 50U; i++)
+    {
+      assert(sf_measJournal_add(&gMeas[i]));
+    }
+    assert(loc_replayAll() >= 25U);
+  }
+}
+
+/*=== Report =================================================================*/
+/* One day of outage at the given measurement interval */
+static void test_wear(unsigned intervalS)
+{
+  const unsigned count = (unsigned)(DAY_S / intervalS);
+  unsigned long timeUs;
+  unsigned long maxAddUs = 0;
+  unsigned long erases;
+  unsigned long formerErases;
+  double bytes;
+  unsigned kept;
+  unsigned i;
+
+  flash_emu_reset();
+  sf_measJournal_init();
+  loc_makeMeas(count, intervalS);
+  for(i = 0; i < count; i++)
+  {
+    timeUs = flash_emu_getTimeUs();
+    assert(sf_measJournal_add(&gMeas[i]));
+    timeUs = flash_emu_getTimeUs() - timeUs;
+    maxAddUs = (timeUs > maxAddUs) ? timeUs : maxAddUs;
+  }
+  timeUs = flash_emu_getTimeUs();
+  bytes = (double)flash_emu_getWrites() / count;
+  erases = flash_emu_getPageErases(JOURNAL_PAGE);
+  if(flash_emu_getPageErases(JOURNAL_PAGE + 1U) > erases)
+  {
+    erases = flash_emu_getPageErases(JOURNAL_PAGE + 1U);
+  }
+  assert(erases + flash_emu_getPageErases(JOURNAL_PAGE + 1U) >= flash_emu_getErases() - 1UL);
+  kept = loc_replayAll();
+  assert(count == (unsigned)loc_checkRange(kept, count) + kept);
+
+  formerErases = (count / FORMER_RECORDS /
+                  (SF_PERSISTENTDATASTORAGE_PAGE_SIZE / FORMER_BLOCK_LEN) + 1UL) / 2UL;
+  printf("every %2u s, 1 day of outage: %.2f bytes per measurement (former "
+         "%.2f), %lu erases per page (former %lu), endurance after %lu days, "
+         "%.0f us flash time per measurement (%.0f measurements/s), longest "
+         "add %lu us, %u measurements kept (%.1f h)\n", intervalS, bytes,
+         (double)FORMER_BLOCK_LEN / FORMER_RECORDS, erases, formerErases,
+         FLASH_EMU_ENDURANCE / erases, (double)timeUs / count,
+         1e6 * count / timeUs, maxAddUs, kept, kept * intervalS / 3600.0);
+
+  /* The delta of the timestamp takes 2 bytes up to 8 s, 3 bytes above */
+  assert(bytes < ((intervalS < 8U) ? 0.65 : 0.8) * FORMER_BLOCK_LEN / FORMER_RECORDS);
+  assert(erases <= formerErases);
+  /* The longest add is the erase of a page and one block */
+  assert(maxAddUs <= FLASH_EMU_ERASE_US + 32U * FLASH_EMU_WORD_US);
+}
+
+int main(void)
+{
+  /* Keep the report of the runs before a failed assertion */
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  test_replay();
+  test_reboot();
+  test_full();
+  /* First block with the erase of the first page, a block within a page */
+  test_powerLoss(0U);
+  test_powerLoss(3U);
+
+  test_wear(3U);
+  test_wear(10U);
+  test_wear(60U);
+
+  printf("test_measJournal: OK\n");
+  return 0;
+}
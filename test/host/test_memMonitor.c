@@ -0,0 +1,293 @@
+/**
+ @file
+ @brief      Host test of the stack watermark scan and of the memory monitor.
+
+ @details The stack checker of Contiki-NG runs unchanged on a stack area
+          of the test, placed at its linker symbols. The area is painted as
+          at the boot and used from its top down, the scan must find the
+          deepest byte written. The monitor takes its watermarks from the
+          scan and from fakes of the queue buffer and TSCH queue
+          watermarks, and is sampled by its process and by the report.
+
+          Reported: the scan time of the stack area and the memory report
+          after the faults.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "sys/stack-check.h"
+#include "net/queuebuf.h"
+#include "net/mac/tsch/tsch.h"
+#include "sf_memMonitor.h"
+
+/* Fill pattern of the stack checker */
+#define STACK_FILL         0xCDU
+/* Bytes of the heap end below the stack, not painted */
+#define HEAP_END_LEN       1U
+/* Stack margin of the monitor */
+#define STACK_MARGIN       256U
+#define REPORT_LEN         9U
+#define SAMPLE_INTERVAL    (10U * CLOCK_SECOND)
+#define SCANS              10000U
+
+/* Stack area between _stack and _stack_origin */
+uint8_t gStackArea[STACK_LEN];
+
+uint8_t queuebuf_len;
+uint8_t queuebuf_max_len;
+static int gTschPacketPeak;
+static clock_time_t gNow;
+static unsigned gFaultCalls[8];
+
+/*=== Fakes ==================================================================*/
+clock_time_t clock_time(void)
+{
+  return gNow;
+}
+
+void watchdog_periodic(void)
+{
+}
+
+int queuebuf_numfree(void)
+{
+  return QUEUEBUF_NUM - queuebuf_len;
+}
+
+int tsch_queue_global_packet_peak(void)
+{
+  return gTschPacketPeak;
+}
+
+void fault_handler(uint8_t fault)
+{
+  assert((1U == fault) || (2U == fault) || (4U == fault));
+  gFaultCalls[fault]++;
+}
+
+/*=== Helpers ================================================================*/
+typedef struct
+{
+  uint16_t stackSize;
+  uint16_t stackPeak;
+  uint8_t queuebufNum;
+  uint8_t queuebufPeak;
+  uint8_t tschPacketNum;
+  uint8_t tschPacketPeak;
+  uint8_t faults;
+} mem_report_t;
+
+static void loc_getReport(mem_report_t *pReport)
+{
+  uint8_t buf[REPORT_LEN + 2U];
+
+  assert(0U == sf_memMonitor_getReport(buf, REPORT_LEN - 1U));
+  assert(REPORT_LEN == sf_memMonitor_getReport(buf, sizeof(buf)));
+  memcpy(&pReport->stackSize, &buf[0], sizeof(uint16_t));
+  memcpy(&pReport->stackPeak, &buf[2], sizeof(uint16_t));
+  pReport->queuebufNum = buf[4];
+  pReport->queuebufPeak = buf[5];
+  pReport->tschPacketNum = buf[6];
+  pReport->tschPacketPeak = buf[7];
+  pReport->faults = buf[8];
+}
+
+/* Paints the stack area as stack_check_init() at the boot. */
+static void loc_paint(void)
+{
+  memset(gStackArea, 0, HEAP_END_LEN);
+  memset(&gStackArea[HEAP_END_LEN], STACK_FILL, STACK_LEN - HEAP_END_LEN);
+}
+
+/* Uses the stack from its top down to a depth, with random contents other
+   than the pattern. */
+static void loc_use(unsigned depth)
+{
+  unsigned i;
+
+  for(i = STACK_LEN - depth; i < STACK_LEN; i++)
+  {
+    gStackArea[i] = (uint8_t)rand();
+    gStackArea[i] ^= (STACK_FILL == gStackArea[i]) ? 1U : 0U;
+  }
+  /* The deepest byte differs from the pattern */
+  gStackArea[STACK_LEN - depth] = 0x00U;
+}
+
+static void loc_run(void)
+{
+  while(process_run() > 0)
+  {
+  }
+}
+
+/* Advances the clock tick by tick, running the due timers. */
+static void loc_advance(clock_time_t ticks)
+{
+  while(ticks--)
+  {
+    gNow++;
+    if(etimer_pending() &&
+       ((int32_t)(gNow - etimer_next_expiration_time()) >= 0))
+    {
+      etimer_request_poll();
+    }
+    loc_run();
+  }
+}
+
+static long loc_nowNs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+/*=== Tests ==================================================================*/
+/* The scan finds the deepest byte written at every depth. */
+static void test_scan(void)
+{
+  unsigned depth;
+
+  assert(STACK_LEN == stack_check_get_reserved_size());
+  for(depth = 1; depth < STACK_LEN - HEAP_END_LEN; depth++)
+  {
+    loc_paint();
+    loc_use(depth);
+    assert((int32_t)depth == stack_check_get_usage());
+  }
+
+  /* Heap grown into the area, the free stack is counted from the heap */
+  loc_paint();
+  loc_use(100U);
+  memset(gStackArea, 0x11, 300U);
+  assert(100 == stack_check_get_usage());
+}
+
+/* Known limits of the scan: bytes written with the pattern and frames
+   reserved but not written are not seen. */
+static void test_scanLimits(void)
+{
+  loc_paint();
+  loc_use(200U);
+  gStackArea[STACK_LEN - 200U] = STACK_FILL;
+  gStackArea[STACK_LEN - 199U] = STACK_FILL;
+  gStackArea[STACK_LEN - 198U] = 0x01U;
+  assert(198 == stack_check_get_usage());
+
+  /* A gap of the pattern within the used stack is not taken for free
+     stack */
+  loc_paint();
+  loc_use(500U);
+  memset(&gStackArea[STACK_LEN - 400U], STACK_FILL, 16U);
+  assert(500 == stack_check_get_usage());
+
+  /* Not used at all, read as overwritten */
+  loc_paint();
+  assert(-1 == stack_check_get_usage());
+
+  /* Overwritten up to the heap end: no pattern left */
+  loc_paint();
+  loc_use(STACK_LEN - HEAP_END_LEN);
+  assert(-1 == stack_check_get_usage());
+
+  /* Once overwritten, a byte written with the pattern is taken for the
+     end of the heap */
+  gStackArea[STACK_LEN - 100U] = STACK_FILL;
+  assert(99 == stack_check_get_usage());
+}
+
+/* Watermarks of the report and the faults, each handled once. */
+static void test_monitor(void)
+{
+  mem_report_t report;
+
+  loc_paint();
+  loc_use(300U);
+  queuebuf_len = 2U;
+  queuebuf_max_len = 3U;
+  gTschPacketPeak = 2;
+  process_init();
+  process_start(&etimer_process, NULL);
+  sf_memMonitor_init();
+  loc_run();
+
+  loc_getReport(&report);
+  assert((STACK_LEN == report.stackSize) && (300U == report.stackPeak));
+  assert((QUEUEBUF_NUM == report.queuebufNum) && (3U == report.queuebufPeak));
+  assert((QUEUEBUF_NUM == report.tschPacketNum) && (2U == report.tschPacketPeak));
+  assert(0U == report.faults);
+
+  /* Sampled by the process */
+  loc_use(STACK_LEN - STACK_MARGIN + 10U);
+  queuebuf_max_len = QUEUEBUF_NUM;
+  loc_advance(SAMPLE_INTERVAL - 1U);
+  assert(0U == gFaultCalls[E_SF_MEMMONITOR_FAULT_STACK]);
+  loc_advance(1U);
+  assert(1U == gFaultCalls[E_SF_MEMMONITOR_FAULT_STACK]);
+  assert(1U == gFaultCalls[E_SF_MEMMONITOR_FAULT_QUEUEBUF]);
+
+  /* The watermarks are kept, the faults latched */
+  queuebuf_max_len = 1U;
+  gTschPacketPeak = 1;
+  loc_advance(3U * SAMPLE_INTERVAL);
+  loc_getReport(&report);
+  assert(STACK_LEN - STACK_MARGIN + 10U == report.stackPeak);
+  assert((QUEUEBUF_NUM == report.queuebufPeak) && (2U == report.tschPacketPeak));
+  assert((E_SF_MEMMONITOR_FAULT_STACK | E_SF_MEMMONITOR_FAULT_QUEUEBUF) == report.faults);
+  assert(1U == gFaultCalls[E_SF_MEMMONITOR_FAULT_STACK]);
+  assert(1U == gFaultCalls[E_SF_MEMMONITOR_FAULT_QUEUEBUF]);
+
+  /* Overflow, the peak is the whole area */
+  loc_use(STACK_LEN - HEAP_END_LEN);
+  loc_getReport(&report);
+  loc_getReport(&report);
+  assert(STACK_LEN == report.stackPeak);
+  assert(E_SF_MEMMONITOR_FAULT_STACK_OVERFLOW & report.faults);
+  assert(1U == gFaultCalls[E_SF_MEMMONITOR_FAULT_STACK_OVERFLOW]);
+  assert(0U == sf_memMonitor_getReport(NULL, REPORT_LEN));
+}
+
+/* Scan time of the stack area at half use. */
+static void test_scanTime(void)
+{
+  long start;
+  unsigned i;
+
+  loc_paint();
+  loc_use(STACK_LEN / 2U);
+  start = loc_nowNs();
+  for(i = 0; i < SCANS; i++)
+  {
+    assert(STACK_LEN / 2 == stack_check_get_usage());
+  }
+  printf("scan of %u bytes at half use: %.2f us\n", STACK_LEN,
+         (loc_nowNs() - start) / 1000.0 / SCANS);
+}
+
+int main(void)
+{
+  mem_report_t report;
+
+  /* Keep the report of the runs before a failed assertion */
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  srand(1);
+  test_scan();
+  test_scanLimits();
+  test_monitor();
+  test_scanTime();
+
+  loc_getReport(&report);
+  printf("report: stack %u of %u bytes, queuebuf %u of %u, tsch packets %u of %u, "
+         "faults 0x%02x\n", report.stackPeak, report.stackSize, report.queuebufPeak,
+         report.queuebufNum, report.tschPacketPeak, report.tschPacketNum, report.faults);
+
+  printf("test_memMonitor: OK\n");
+  return 0;
+}
@@ -0,0 +1,249 @@
+/**
+ @file
+ @brief      Host simulation of a pack-wide outage of the BMS-CC and of the
+             rejoin of its SCs.
+
+ @details All SCs of a pack are connected when the BMS-CC goes off. Each
+          loses the synchronization after the desync threshold and runs the
+          rejoin of the join requester unchanged on the model of
+          join_model.h, seeded with its serial: the warm start listening for
+          the last time source, the beacon scans with the bounded
+          exponential backoff and jitter, and the passive listening between
+          the scans. The former rejoin, a beacon scan every 5 min after the
+          2 s LED indication, is modeled alongside with the same scan.
+
+          Reported per outage duration: time from the return of the BMS-CC
+          until the cells are connected again (median and all), the peak
+          channel load as the most cells scanning or listening at the same
+          time after the return and as the most cells associating within
+          10 s, and the radio on time per cell.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "net/mac/tsch/tsch.h"
+#include "join_model.h"
+
+#define CELLS              200
+#define OFF_MS             60000.0
+#define DESYNC_MS          (TSCH_DESYNC_THRESHOLD * 1000.0 / CLOCK_SECOND)
+#define AFTER_MS           (30.0 * 60.0 * 1000.0)
+#define BURST_MS           10000.0
+/* SF_JOIN_REJOIN_MAX_INTERVAL */
+#define REJOIN_MAX_MS      (5.0 * 60.0 * 1000.0)
+/* Former rejoin: scan, 2 s LED, 5 min */
+#define FORMER_SCAN_MS     30000.0
+#define FORMER_RETRY_MS    (2000.0 + 5.0 * 60.0 * 1000.0)
+
+typedef struct
+{
+  double recoveryP50Ms;
+  double recoveryMaxMs;
+  unsigned peakRadio;
+  unsigned peakBurst;
+  double radioOnMs;
+} sim_summary_t;
+
+static join_model_result_t gCells[CELLS];
+
+static double loc_rand(void)
+{
+  return (double)rand() / ((double)RAND_MAX + 1.0);
+}
+
+/* The former rejoin with the scan of the model: the BMS-CC is found 3 to
+   10 s after it is on, the scan gives up after 30 s. */
+static void loc_former(const join_model_cfg_t *pCfg, join_model_result_t *pRes)
+{
+  double t = pCfg->gwOffMs - loc_rand() * JOIN_MODEL_SLOTFRAME_MS + DESYNC_MS;
+  double foundMs;
+
+  memset(pRes, 0, sizeof(*pRes));
+  pRes->connectedMs = -1.0;
+  while(pRes->connectedMs < 0.0)
+  {
+    foundMs = ((t >= pCfg->gwOnMs) ? t : pCfg->gwOnMs) + 3000.0 + loc_rand() * 7000.0;
+    pRes->scans++;
+    if(foundMs <= t + FORMER_SCAN_MS)
+    {
+      /* Associated with the next beacon */
+      pRes->radioOnMs[pRes->radioCount][0] = t;
+      pRes->radioOnMs[pRes->radioCount][1] = foundMs + JOIN_MODEL_SLOTFRAME_MS;
+      pRes->radioCount++;
+      pRes->connectedMs = foundMs + JOIN_MODEL_SLOTFRAME_MS;
+      break;
+    }
+    assert(pRes->radioCount < JOIN_MODEL_RADIO_MAX);
+    pRes->radioOnMs[pRes->radioCount][0] = t;
+    pRes->radioOnMs[pRes->radioCount][1] = t + FORMER_SCAN_MS;
+    pRes->radioCount++;
+    t += FORMER_SCAN_MS + FORMER_RETRY_MS;
+  }
+}
+
+static int loc_cmp(const void *a, const void *b)
+{
+  double d = *(const double *)a - *(const double *)b;
+
+  return (d > 0) - (d < 0);
+}
+
+typedef struct
+{
+  double ms;
+  int delta;
+} edge_t;
+
+static int loc_cmpEdge(const void *a, const void *b)
+{
+  const edge_t *pA = (const edge_t *)a;
+  const edge_t *pB = (const edge_t *)b;
+
+  if(pA->ms != pB->ms)
+  {
+    return (pA->ms > pB->ms) - (pA->ms < pB->ms);
+  }
+  /* Ends before starts at the same time */
+  return pA->delta - pB->delta;
+}
+
+/* Peak number of cells with the radio on at the same time after fromMs */
+static unsigned loc_peakRadio(double fromMs)
+{
+  static edge_t edges[CELLS * JOIN_MODEL_RADIO_MAX * 2];
+  unsigned n = 0;
+  int on = 0;
+  int peak = 0;
+  unsigned c;
+  unsigned i;
+
+  for(c = 0; c < CELLS; c++)
+  {
+    for(i = 0; i < gCells[c].radioCount; i++)
+    {
+      if(gCells[c].radioOnMs[i][1] <= fromMs)
+      {
+        continue;
+      }
+      edges[n].ms = (gCells[c].radioOnMs[i][0] > fromMs) ?
+                    gCells[c].radioOnMs[i][0] : fromMs;
+      edges[n++].delta = 1;
+      edges[n].ms = gCells[c].radioOnMs[i][1];
+      edges[n++].delta = -1;
+    }
+  }
+  qsort(edges, n, sizeof(edges[0]), loc_cmpEdge);
+  for(i = 0; i < n; i++)
+  {
+    on += edges[i].delta;
+    peak = (on > peak) ? on : peak;
+  }
+  return (unsigned)peak;
+}
+
+static void loc_summarize(const join_model_cfg_t *pCfg, sim_summary_t *pSum)
+{
+  static double recovery[CELLS];
+  unsigned c;
+  unsigned i;
+  unsigned j;
+
+  memset(pSum, 0, sizeof(*pSum));
+  for(c = 0; c < CELLS; c++)
+  {
+    assert(gCells[c].connectedMs >= pCfg->gwOnMs);
+    recovery[c] = gCells[c].connectedMs - pCfg->gwOnMs;
+    for(i = 0; i < gCells[c].radioCount; i++)
+    {
+      pSum->radioOnMs += (gCells[c].radioOnMs[i][1] - gCells[c].radioOnMs[i][0]) / CELLS;
+    }
+  }
+  qsort(recovery, CELLS, sizeof(recovery[0]), loc_cmp);
+  pSum->recoveryP50Ms = recovery[CELLS / 2];
+  pSum->recoveryMaxMs = recovery[CELLS - 1];
+  pSum->peakRadio = loc_peakRadio(pCfg->gwOnMs);
+
+  /* Associations within BURST_MS, over the sorted recovery times */
+  for(i = 0, j = 0; i < CELLS; i++)
+  {
+    while(recovery[i] - recovery[j] >= BURST_MS)
+    {
+      j++;
+    }
+    pSum->peakBurst = (i - j + 1 > pSum->peakBurst) ? i - j + 1 : pSum->peakBurst;
+  }
+}
+
+static void loc_report(const char *pName, const sim_summary_t *pSum)
+{
+  printf("  %-14s recovery p50 %6.1f s all %6.1f s, peak %3u cells scanning, "
+         "%3u associating in 10 s, radio on %5.1f s per cell\n", pName,
+         pSum->recoveryP50Ms / 1000.0, pSum->recoveryMaxMs / 1000.0,
+         pSum->peakRadio, pSum->peakBurst, pSum->radioOnMs / 1000.0);
+}
+
+int main(void)
+{
+  static const double outagesMin[] = {10.0, 15.0, 20.0, 30.0, 45.0, 60.0};
+  const unsigned outages = sizeof(outagesMin) / sizeof(outagesMin[0]);
+  join_model_cfg_t cfg = {0.05, false, true, 0.0, OFF_MS, 0.0};
+  sim_summary_t former;
+  sim_summary_t rejoin;
+  double formerP50Ms = 0.0;
+  double formerMaxMs = 0.0;
+  double rejoinP50Ms = 0.0;
+  double rejoinMaxMs = 0.0;
+  unsigned o;
+  unsigned c;
+
+  /* Keep the report of the runs before a failed assertion */
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  for(o = 0; o < outages; o++)
+  {
+    cfg.gwOnMs = OFF_MS + outagesMin[o] * 60.0 * 1000.0;
+    printf("%u cells, BMS-CC off for %.0f min:\n", CELLS, outagesMin[o]);
+
+    srand(1);
+    for(c = 0; c < CELLS; c++)
+    {
+      loc_former(&cfg, &gCells[c]);
+    }
+    loc_summarize(&cfg, &former);
+    loc_report("former", &former);
+
+    for(c = 0; c < CELLS; c++)
+    {
+      /* Seeded with the serial of the cell */
+      join_model_fork(&cfg, 0x1000U + c, true, false, cfg.gwOnMs + AFTER_MS,
+                      &gCells[c]);
+    }
+    loc_summarize(&cfg, &rejoin);
+    loc_report("rejoin backoff", &rejoin);
+
+    /* The cells spread over the rejoin interval instead of scanning in
+       lockstep. All are back within the maximum rejoin interval. */
+    assert(rejoin.peakRadio * 2U <= former.peakRadio);
+    assert(rejoin.peakBurst * 2U <= former.peakBurst);
+    assert(rejoin.recoveryMaxMs <= REJOIN_MAX_MS);
+
+    formerP50Ms += former.recoveryP50Ms / outages;
+    formerMaxMs += former.recoveryMaxMs / outages;
+    rejoinP50Ms += rejoin.recoveryP50Ms / outages;
+    rejoinMaxMs += rejoin.recoveryMaxMs / outages;
+  }
+
+  /* The recovery of the former rejoin depends on the phase of its scans at
+     the return of the BMS-CC, the median is compared over all outages. The
+     last cells of the rejoin backoff wait for up to half an interval for
+     the passive listening, the former ones come back together. */
+  printf("mean over the outages: recovery p50 %.1f s all %.1f s former, "
+         "p50 %.1f s all %.1f s rejoin backoff\n", formerP50Ms / 1000.0,
+         formerMaxMs / 1000.0, rejoinP50Ms / 1000.0, rejoinMaxMs / 1000.0);
+  assert(rejoinP50Ms * 2.0 < formerP50Ms);
+
+  printf("test_rejoinSim: OK\n");
+  return 0;
+}
@@ -0,0 +1,243 @@
+/**
+ @file
+ @brief      Host capacity model and collision test of the data slots
+             assigned per channel offset (shard).
+
+ @details All cells of a pack are assigned through
+          sf_tsch_schedule_assign_data_slots() as done by the BMS-CCs and
+          their data slots are added to a common table of the air. No
+          timeslot and channel offset may be used twice and the data slots
+          must not overlap the beacon and join slots.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sf-tsch-schedule.h"
+#include "net/mac/tsch/tsch-schedule.h"
+
+/* Links of the single node emulated by the fake schedule */
+#define NODE_LINKS_MAX   (APP_SLOTFRAME_SECTION_JOIN_SLOTS + 8)
+
+const linkaddr_t tsch_broadcast_address = {{ 0xFF, 0xFF }};
+
+static struct tsch_slotframe gSlotframe;
+static bool gSlotframeAdded;
+static struct tsch_link gLinks[NODE_LINKS_MAX];
+static int gLinkCount;
+
+/* Cell index + 1 of the owner of each timeslot and channel offset */
+static uint16_t gAir[APP_SLOTFRAME_SIZE][APP_SLOTFRAME_CHANNEL_OFFSET_NUM];
+
+/*=== Fake TSCH schedule of one node ========================================*/
+int tsch_schedule_remove_all_slotframes(void)
+{
+  gSlotframeAdded = false;
+  gLinkCount = 0;
+  return 1;
+}
+
+struct tsch_slotframe *tsch_schedule_add_slotframe(uint16_t handle, uint16_t size)
+{
+  gSlotframe.handle = handle;
+  gSlotframe.size.val = size;
+  gSlotframeAdded = true;
+  return &gSlotframe;
+}
+
+struct tsch_slotframe *tsch_schedule_get_slotframe_by_handle(uint16_t handle)
+{
+  return (gSlotframeAdded && (handle == gSlotframe.handle)) ? &gSlotframe : NULL;
+}
+
+struct tsch_link *tsch_schedule_get_link_by_timeslot(struct tsch_slotframe *slotframe,
+                                                     uint16_t timeslot,
+                                                     uint16_t channel_offset)
+{
+  int i;
+
+  for(i = 0; i < gLinkCount; i++)
+  {
+    if((gLinks[i].timeslot == timeslot) &&
+       (gLinks[i].channel_offset == channel_offset))
+    {
+      return &gLinks[i];
+    }
+  }
+  return NULL;
+}
+
+int tsch_schedule_remove_link_by_timeslot(struct tsch_slotframe *slotframe,
+                                          uint16_t timeslot, uint16_t channel_offset)
+{
+  struct tsch_link *l = tsch_schedule_get_link_by_timeslot(slotframe, timeslot,
+                                                           channel_offset);
+
+  if(NULL == l)
+  {
+    return 0;
+  }
+  *l = gLinks[--gLinkCount];
+  return 1;
+}
+
+struct tsch_link *tsch_schedule_add_link(struct tsch_slotframe *slotframe,
+                                         uint8_t link_options, enum link_type link_type,
+                                         const linkaddr_t *address,
+                                         uint16_t timeslot, uint16_t channel_offset,
+                                         uint8_t do_remove)
+{
+  struct tsch_link *l;
+
+  assert(timeslot < slotframe->size.val);
+  if(do_remove)
+  {
+    tsch_schedule_remove_link_by_timeslot(slotframe, timeslot, channel_offset);
+  }
+  assert(gLinkCount < NODE_LINKS_MAX);
+  l = &gLinks[gLinkCount++];
+  l->addr = *address;
+  l->timeslot = timeslot;
+  l->channel_offset = channel_offset;
+  l->link_options = link_options;
+  l->link_type = link_type;
+  return l;
+}
+
+/*=== Tests =================================================================*/
+/* Schedule of a joined cell: beacon slots plus its data slots. */
+static void loc_joinCell(const linkaddr_t *pAddr, uint16_t channelOffset)
+{
+  assert(0 == sf_tsch_schedule_init());
+  assert(0 == sf_tsch_schedule_add_beacon_slots());
+  assert(0 == sf_tsch_schedule_set_data_channel_offset(channelOffset));
+  assert(0 == sf_tsch_schedule_add_data_slots(pAddr));
+}
+
+/* All cells of a full pack use disjoint timeslots and channel offsets. */
+static void test_collision(void)
+{
+  uint16_t cell;
+  uint16_t channelOffset;
+  linkaddr_t addr;
+  int i;
+  int dataLinks;
+
+  memset(gAir, 0, sizeof(gAir));
+
+  for(cell = 0; cell < SF_TSCH_SCHEDULE_DATA_CAPACITY; cell++)
+  {
+    assert(0 == sf_tsch_schedule_assign_data_slots(cell, &addr, &channelOffset));
+    assert(channelOffset < APP_SLOTFRAME_CHANNEL_OFFSET_NUM);
+    loc_joinCell(&addr, channelOffset);
+
+    dataLinks = 0;
+    for(i = 0; i < gLinkCount; i++)
+    {
+      if(LINK_TYPE_ADVERTISING_ONLY == gLinks[i].link_type)
+      {
+        continue;
+      }
+      dataLinks++;
+      assert(channelOffset == gLinks[i].channel_offset);
+      /* Not within the beacon and join slots of the section */
+      assert((gLinks[i].timeslot % APP_SLOTFRAME_SECTION_SIZE) >=
+             APP_SLOTFRAME_SECTION_BEACON_SLOTS + APP_SLOTFRAME_SECTION_JOIN_SLOTS);
+      assert(0 == gAir[gLinks[i].timeslot][gLinks[i].channel_offset]);
+      gAir[gLinks[i].timeslot][gLinks[i].channel_offset] = cell + 1;
+    }
+    /* TX, retransmission and RX slot */
+    assert(3 == dataLinks);
+  }
+
+  /* The pack is full. */
+  assert(0 != sf_tsch_schedule_assign_data_slots(SF_TSCH_SCHEDULE_DATA_CAPACITY,
+                                                 &addr, &channelOffset));
+}
+
+/* The data slots are removed even if the channel offset changed since they
+   have been added, e.g. on a rejoin with a new assignment. */
+static void test_deleteAfterReassignment(void)
+{
+  linkaddr_t addr = {{ 0 }};
+  int beaconLinks;
+
+  addr.u16 = 7;
+  loc_joinCell(&addr, 0);
+  beaconLinks = gLinkCount - 3;
+  assert(0 == sf_tsch_schedule_set_data_channel_offset(0));
+  assert(0 == sf_tsch_schedule_delete_data_slots(&addr));
+  assert(beaconLinks == gLinkCount);
+
+  loc_joinCell(&addr, APP_SLOTFRAME_CHANNEL_OFFSET_NUM - 1);
+  assert(0 == sf_tsch_schedule_set_data_channel_offset(1));
+  assert(0 == sf_tsch_schedule_delete_data_slots(&addr));
+  assert(beaconLinks == gLinkCount);
+  /* Nothing left to remove */
+  assert(0 != sf_tsch_schedule_delete_data_slots(&addr));
+
+  /* Invalid offsets and addresses */
+  assert(0 != sf_tsch_schedule_set_data_channel_offset(APP_SLOTFRAME_CHANNEL_OFFSET_NUM));
+  addr.u16 = 0;
+  assert(0 != sf_tsch_schedule_add_data_slots(&addr));
+  addr.u16 = APP_MAX_DEVICES + 1;
+  assert(0 != sf_tsch_schedule_add_data_slots(&addr));
+}
+
+/* The first half of the devices keeps the timeslots of previous firmware
+   versions, which computed both as (devid * 2) % slots. */
+static void test_previousMapping(void)
+{
+  linkaddr_t addr = {{ 0 }};
+  uint16_t devid;
+  uint16_t tx;
+  uint16_t rx;
+  const uint16_t base = APP_SLOTFRAME_SECTION_BEACON_SLOTS +
+                        APP_SLOTFRAME_SECTION_JOIN_SLOTS;
+
+  for(devid = 0; devid < APP_SLOTFRAME_SECTION_DEVICE_RX_SLOTS / 2; devid++)
+  {
+    addr.u16 = devid + 1;
+    assert(0 == sf_tsch_schedule_get_data_timeslots(&addr, &tx, &rx));
+    assert(base + (devid * 2) % APP_SLOTFRAME_SECTION_DEVICE_TX_SLOTS == tx);
+    assert(base + 2 * APP_SLOTFRAME_SECTION_DEVICE_TX_SLOTS +
+           (devid * 2) % APP_SLOTFRAME_SECTION_DEVICE_RX_SLOTS == rx);
+  }
+}
+
+/* Capacity of the slotframe with and without channel offsets. */
+static void report_capacity(void)
+{
+  uint16_t timeslot;
+  uint16_t used = 0;
+  uint16_t channelOffset;
+
+  for(timeslot = 0; timeslot < APP_SLOTFRAME_SIZE; timeslot++)
+  {
+    for(channelOffset = 0; channelOffset < APP_SLOTFRAME_CHANNEL_OFFSET_NUM; channelOffset++)
+    {
+      if(0 != gAir[timeslot][channelOffset])
+      {
+        used++;
+        break;
+      }
+    }
+  }
+
+  printf("capacity: %u timeslots per cycle, %u used for data\n",
+         (unsigned)APP_SLOTFRAME_SIZE, (unsigned)used);
+  printf("capacity: %u cells per BMS-CC, %u channel offsets, %u cells per pack\n",
+         (unsigned)APP_MAX_DEVICES, (unsigned)APP_SLOTFRAME_CHANNEL_OFFSET_NUM,
+         (unsigned)SF_TSCH_SCHEDULE_DATA_CAPACITY);
+}
+
+int main(void)
+{
+  test_collision();
+  report_capacity();
+  test_deleteAfterReassignment();
+  test_previousMapping();
+
+  printf("test_schedule: OK\n");
+  return 0;
+}
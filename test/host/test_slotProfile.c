@@ -0,0 +1,379 @@
+/**
+ @file
+ @brief      Host test of the histograms of the slot operation profiler and
+             of the profiler hooks.
+
+ @details The histogram module is tested on its bins, its statistics and
+          the percentiles estimated from the bins, which are compared with
+          the exact percentiles of random samples. The profiler runs
+          unchanged with a fake rtimer, which also stands for the cycle
+          counter off the SimpleLink target. The hooks are called in the
+          order of the TSCH_DEBUG_* points of a slot.
+
+          Reported: the histograms of a modeled run of 10000 slots, with
+          the estimated and the exact p50 and p99.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "sys/int-master.h"
+#include "sf_histogram.h"
+#include "sf_slotProfile.h"
+
+#define SAMPLES            10000U
+/* Samples below the last bin */
+#define SAMPLE_MAX         ((1UL << (SF_HISTOGRAM_BINS - 2U)) - 1U)
+
+static const char *const gMetricName[E_SF_SLOTPROFILE_MAX] =
+{
+  "ISR latency",
+  "Tx prepare",
+  "ACK turnaround",
+  "Deadline margin"
+};
+
+static rtimer_clock_t gNowUs;
+static bool gDisabled;
+
+/*=== Fakes ==================================================================*/
+rtimer_clock_t rtimer_arch_now(void)
+{
+  return gNowUs;
+}
+
+clock_time_t clock_time(void)
+{
+  return 0;
+}
+
+int_master_status_t int_master_read_and_disable(void)
+{
+  int_master_status_t status = gDisabled;
+
+  gDisabled = true;
+  return status;
+}
+
+void int_master_status_set(int_master_status_t status)
+{
+  gDisabled = (0U != status);
+}
+
+/*=== Helpers ================================================================*/
+static int loc_cmp(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+
+  return (x > y) - (x < y);
+}
+
+/* Exact percentile of sorted samples, by the rank of the histogram. */
+static uint32_t loc_percentile(const uint32_t *pSorted, unsigned n, uint8_t percent)
+{
+  unsigned rank = (n * percent + 99U) / 100U;
+
+  return pSorted[(0U == rank) ? 0U : rank - 1U];
+}
+
+/* Random sample of one of the shapes of the slot timing. */
+static uint32_t loc_sample(unsigned shape)
+{
+  switch(shape)
+  {
+    case 0:
+      /* Uniform */
+      return (uint32_t)rand() % (SAMPLE_MAX + 1U);
+    case 1:
+      /* Narrow around a typical value, e.g. the ACK turnaround */
+      return 180U + (uint32_t)rand() % 40U;
+    default:
+      /* Mostly short with a long tail, e.g. the ISR latency */
+      return (0U == rand() % 50) ? 1000U + (uint32_t)rand() % 4000U
+                                 : 20U + (uint32_t)rand() % 30U;
+  }
+}
+
+static void loc_getAll(sf_histogram_t hist[E_SF_SLOTPROFILE_MAX])
+{
+  uint8_t metric;
+
+  for(metric = 0; metric < E_SF_SLOTPROFILE_MAX; metric++)
+  {
+    sf_slotProfile_get((E_SF_SLOTPROFILE_t)metric, &hist[metric]);
+    /* Interrupts enabled again */
+    assert(!gDisabled);
+  }
+}
+
+/*=== Tests ==================================================================*/
+/* Bin n holds [2^(n-1), 2^n), the last bin everything above. */
+static void test_bins(void)
+{
+  uint8_t bin;
+
+  assert(0U == sf_histogram_bin(0U));
+  assert(1U == sf_histogram_bin(1U));
+  for(bin = 2; bin < SF_HISTOGRAM_BINS; bin++)
+  {
+    assert(bin == sf_histogram_bin(1UL << (bin - 1U)));
+    assert(bin - 1U == sf_histogram_bin((1UL << (bin - 1U)) - 1U));
+  }
+  assert(SF_HISTOGRAM_BINS - 1U == sf_histogram_bin(1UL << SF_HISTOGRAM_BINS));
+  assert(SF_HISTOGRAM_BINS - 1U == sf_histogram_bin(UINT32_MAX));
+}
+
+/* Count, minimum, maximum, mean and the negative samples. */
+static void test_stats(void)
+{
+  sf_histogram_t hist;
+
+  memset(&hist, 0, sizeof(hist));
+  assert((0U == sf_histogram_mean(&hist)) && (0U == sf_histogram_percentile(&hist, 50U)));
+
+  sf_histogram_add(&hist, 7U);
+  assert((7U == hist.min) && (7U == hist.max) && (7U == sf_histogram_mean(&hist)));
+  assert(7U == sf_histogram_percentile(&hist, 0U));
+  assert(7U == sf_histogram_percentile(&hist, 100U));
+
+  sf_histogram_add(&hist, 0U);
+  sf_histogram_add(&hist, UINT32_MAX);
+  sf_histogram_addNegative(&hist);
+  assert((3U == hist.count) && (1U == hist.negative));
+  assert((0U == hist.min) && (UINT32_MAX == hist.max));
+  assert((uint64_t)UINT32_MAX + 7U == hist.sum);
+  assert((UINT32_MAX + 7ULL) / 3U == sf_histogram_mean(&hist));
+  assert((1U == hist.bins[0]) && (1U == hist.bins[3]) &&
+         (1U == hist.bins[SF_HISTOGRAM_BINS - 1U]));
+  assert(0U == sf_histogram_percentile(&hist, 33U));
+  assert(7U == sf_histogram_percentile(&hist, 34U));
+  assert(UINT32_MAX == sf_histogram_percentile(&hist, 99U));
+}
+
+/* A bin saturates, the count and the percentiles go on. */
+static void test_saturation(void)
+{
+  sf_histogram_t hist;
+  unsigned i;
+
+  memset(&hist, 0, sizeof(hist));
+  for(i = 0; i < 70000U; i++)
+  {
+    sf_histogram_add(&hist, 3U);
+  }
+  sf_histogram_add(&hist, 100U);
+  assert((70001U == hist.count) && (UINT16_MAX == hist.bins[2]) && (1U == hist.bins[7]));
+  assert(3U == sf_histogram_percentile(&hist, 99U));
+  assert(100U == sf_histogram_percentile(&hist, 100U));
+}
+
+/* The estimate is in the bin of the exact percentile, at most twice it. */
+static void test_percentile(void)
+{
+  static const uint8_t percent[] = {0U, 1U, 10U, 50U, 90U, 99U, 100U};
+  static uint32_t value[SAMPLES];
+  sf_histogram_t hist;
+  uint32_t exact;
+  uint32_t estimate;
+  unsigned shape;
+  unsigned n;
+  unsigned i;
+  unsigned p;
+
+  srand(1);
+  for(shape = 0; shape < 3U; shape++)
+  {
+    for(n = 1; n <= SAMPLES; n *= 10U)
+    {
+      memset(&hist, 0, sizeof(hist));
+      for(i = 0; i < n; i++)
+      {
+        value[i] = loc_sample(shape);
+        sf_histogram_add(&hist, value[i]);
+      }
+      qsort(value, n, sizeof(value[0]), loc_cmp);
+
+      for(p = 0; p < sizeof(percent); p++)
+      {
+        exact = loc_percentile(value, n, percent[p]);
+        estimate = sf_histogram_percentile(&hist, percent[p]);
+        assert(sf_histogram_bin(exact) == sf_histogram_bin(estimate));
+        assert((exact <= estimate) && (estimate <= 2U * exact));
+        assert((hist.min <= estimate) && (estimate <= hist.max));
+      }
+    }
+  }
+}
+
+/* Each hook measures its metric, the print restarts the histograms. */
+static void test_hooks(void)
+{
+  sf_histogram_t hist[E_SF_SLOTPROFILE_MAX];
+  uint8_t metric;
+
+  /* Across the wrap around of the rtimer */
+  gNowUs = UINT32_MAX - 100U;
+  sf_slotProfile_init();
+  loc_getAll(hist);
+  for(metric = 0; metric < E_SF_SLOTPROFILE_MAX; metric++)
+  {
+    assert(0U == hist[metric].count);
+  }
+
+  /* The first wakeup is not scheduled by the hook */
+  sf_slotProfile_interrupt();
+
+  /* Tx slot, the frame is ready 120 us after the start */
+  sf_slotProfile_schedule(gNowUs + 500U, gNowUs);
+  gNowUs += 537U;
+  sf_slotProfile_interrupt();
+  sf_slotProfile_txSlotStart();
+  gNowUs += 120U;
+  sf_slotProfile_schedule(gNowUs + 2000U, gNowUs);
+  sf_slotProfile_schedule(gNowUs + 3000U, gNowUs);
+
+  /* Rx slot, the ACK is sent 192 us after the frame */
+  sf_slotProfile_rxEnd();
+  gNowUs += 192U;
+  sf_slotProfile_ackSendStart();
+  sf_slotProfile_ackSendStart();
+
+  /* Deadline missed, the interrupt comes at once 10 us late */
+  sf_slotProfile_schedule(gNowUs - 10U, gNowUs);
+  sf_slotProfile_interrupt();
+  /* Interrupt before the target, not the scheduled one */
+  sf_slotProfile_schedule(gNowUs + 10U, gNowUs);
+  sf_slotProfile_interrupt();
+
+  loc_getAll(hist);
+  assert((2U == hist[E_SF_SLOTPROFILE_ISR_LATENCY].count) &&
+         (10U == hist[E_SF_SLOTPROFILE_ISR_LATENCY].min) &&
+         (37U == hist[E_SF_SLOTPROFILE_ISR_LATENCY].max));
+  assert((1U == hist[E_SF_SLOTPROFILE_TX_PREPARE].count) &&
+         (120U == hist[E_SF_SLOTPROFILE_TX_PREPARE].max));
+  assert((1U == hist[E_SF_SLOTPROFILE_ACK_TURNAROUND].count) &&
+         (192U == hist[E_SF_SLOTPROFILE_ACK_TURNAROUND].max));
+  assert((4U == hist[E_SF_SLOTPROFILE_DEADLINE_MARGIN].count) &&
+         (1U == hist[E_SF_SLOTPROFILE_DEADLINE_MARGIN].negative));
+  assert((10U == hist[E_SF_SLOTPROFILE_DEADLINE_MARGIN].min) &&
+         (3000U == hist[E_SF_SLOTPROFILE_DEADLINE_MARGIN].max));
+
+  sf_slotProfile_print();
+  assert(!gDisabled);
+  loc_getAll(hist);
+  for(metric = 0; metric < E_SF_SLOTPROFILE_MAX; metric++)
+  {
+    assert((0U == hist[metric].count) && (0U == hist[metric].negative));
+  }
+
+  /* A restart of the slot operation drops the pending measurements */
+  sf_slotProfile_schedule(gNowUs + 500U, gNowUs);
+  sf_slotProfile_txSlotStart();
+  sf_slotProfile_rxEnd();
+  sf_slotProfile_init();
+  gNowUs += 600U;
+  sf_slotProfile_interrupt();
+  sf_slotProfile_schedule(gNowUs + 500U, gNowUs);
+  sf_slotProfile_ackSendStart();
+  loc_getAll(hist);
+  assert(0U == hist[E_SF_SLOTPROFILE_ISR_LATENCY].count);
+  assert(0U == hist[E_SF_SLOTPROFILE_TX_PREPARE].count);
+  assert(0U == hist[E_SF_SLOTPROFILE_ACK_TURNAROUND].count);
+  sf_slotProfile_print();
+}
+
+/* Slots with the modeled timing, reported as printed by the profiler. */
+static void test_run(void)
+{
+  static uint32_t value[E_SF_SLOTPROFILE_MAX][2U * SAMPLES];
+  sf_histogram_t hist[E_SF_SLOTPROFILE_MAX];
+  unsigned n[E_SF_SLOTPROFILE_MAX] = {0};
+  uint32_t us;
+  uint8_t metric;
+  uint8_t bin;
+  unsigned s;
+
+  srand(2);
+  for(s = 0; s < SAMPLES; s++)
+  {
+    /* Wakeup at the slot start */
+    us = 2000U + (uint32_t)rand() % 1000U;
+    value[E_SF_SLOTPROFILE_DEADLINE_MARGIN][n[E_SF_SLOTPROFILE_DEADLINE_MARGIN]++] = us;
+    sf_slotProfile_schedule(gNowUs + us, gNowUs);
+    gNowUs += us;
+    us = loc_sample(2U);
+    value[E_SF_SLOTPROFILE_ISR_LATENCY][n[E_SF_SLOTPROFILE_ISR_LATENCY]++] = us;
+    gNowUs += us;
+    sf_slotProfile_interrupt();
+
+    if(0U == (s % 4U))
+    {
+      /* Tx slot of the measurement */
+      sf_slotProfile_txSlotStart();
+      us = 300U + (uint32_t)rand() % 500U;
+      value[E_SF_SLOTPROFILE_TX_PREPARE][n[E_SF_SLOTPROFILE_TX_PREPARE]++] = us;
+      gNowUs += us;
+    }
+    else
+    {
+      /* Rx slot with a frame to acknowledge */
+      gNowUs += 1500U;
+      sf_slotProfile_rxEnd();
+      us = loc_sample(1U);
+      value[E_SF_SLOTPROFILE_ACK_TURNAROUND][n[E_SF_SLOTPROFILE_ACK_TURNAROUND]++] = us;
+      gNowUs += us;
+      sf_slotProfile_ackSendStart();
+    }
+    /* Time left to the Tx offset or to the ACK end, woken up in time */
+    us = 1000U + (uint32_t)rand() % 1000U;
+    value[E_SF_SLOTPROFILE_DEADLINE_MARGIN][n[E_SF_SLOTPROFILE_DEADLINE_MARGIN]++] = us;
+    sf_slotProfile_schedule(gNowUs + us, gNowUs);
+    gNowUs += us;
+    value[E_SF_SLOTPROFILE_ISR_LATENCY][n[E_SF_SLOTPROFILE_ISR_LATENCY]++] = 0U;
+    sf_slotProfile_interrupt();
+  }
+
+  loc_getAll(hist);
+  for(metric = 0; metric < E_SF_SLOTPROFILE_MAX; metric++)
+  {
+    assert(n[metric] == hist[metric].count);
+    qsort(value[metric], n[metric], sizeof(uint32_t), loc_cmp);
+
+    printf("%-16s n %5lu min %4lu avg %4lu p50 %4lu (%4lu) p99 %4lu (%4lu) max %4lu us\n",
+           gMetricName[metric], (unsigned long)hist[metric].count,
+           (unsigned long)hist[metric].min, (unsigned long)sf_histogram_mean(&hist[metric]),
+           (unsigned long)sf_histogram_percentile(&hist[metric], 50U),
+           (unsigned long)loc_percentile(value[metric], n[metric], 50U),
+           (unsigned long)sf_histogram_percentile(&hist[metric], 99U),
+           (unsigned long)loc_percentile(value[metric], n[metric], 99U),
+           (unsigned long)hist[metric].max);
+    printf("  log2 us:");
+    for(bin = 0; bin < SF_HISTOGRAM_BINS; bin++)
+    {
+      printf(" %u", hist[metric].bins[bin]);
+    }
+    printf("\n");
+  }
+  sf_slotProfile_print();
+}
+
+int main(void)
+{
+  /* Keep the report of the runs before a failed assertion */
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  process_init();
+
+  test_bins();
+  test_stats();
+  test_saturation();
+  test_percentile();
+  test_hooks();
+  test_run();
+
+  printf("test_slotProfile: OK\n");
+  return 0;
+}
@@ -0,0 +1,352 @@
+/**
+ @file
+ @brief      Host test of the slot statistics counters and their report.
+
+ @details The counters are fed through the TSCH callbacks and read back
+          through the report, which restarts them. The call site names are
+          taken from the calls of the slot operation of Contiki-NG, so a
+          renamed call site is not counted as other unnoticed.
+
+          A SIGALRM timer stands for the rtimer interrupt and calls the
+          callbacks at random, while the main loop reads the reports as the
+          measurement sender does. Disabling the interrupts blocks the
+          signal. No count may be lost or reported twice.
+
+          Reported: the call sites found and the counts and reports of the
+          stress run.
+*/
+#include <assert.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "sys/int-master.h"
+#include "sf_slotStats.h"
+
+/* Counters of the report after the sites */
+#define SKIP_LOCKED        0U
+#define SKIP_LOCK_REQ      1U
+#define SKIP_NO_LINK       2U
+#define INPUT_QUEUE_DROP   3U
+#define ACK_TIMEOUT        4U
+#define COUNTERS           (E_SF_SLOTSTATS_SITE_MAX + 5U)
+#define REPORT_LEN         (1U + COUNTERS * 2U)
+/* Period of the simulated interrupt and duration of the stress test */
+#define ISR_PERIOD_US      50
+#define STRESS_US          (1000 * 1000)
+/* Longest source file scanned */
+#define SOURCE_MAX_LEN     (256U * 1024U)
+
+static const char *const gSiteName[E_SF_SLOTSTATS_SITE_OTHER] =
+{
+  "cca",
+  "TxBeforeTx",
+  "TxBeforeAck",
+  "RxBeforeListen",
+  "RxBeforeAck",
+  "MainBeforeReady",
+  "main",
+  "assoc"
+};
+
+/* Counts of the simulated interrupt */
+static volatile uint32_t gExpected[COUNTERS];
+
+/*=== Fakes of the master interrupt ==========================================*/
+int_master_status_t int_master_read_and_disable(void)
+{
+  sigset_t set;
+  sigset_t old;
+
+  sigemptyset(&set);
+  sigaddset(&set, SIGALRM);
+  sigprocmask(SIG_BLOCK, &set, &old);
+  return sigismember(&old, SIGALRM) ? 1U : 0U;
+}
+
+void int_master_status_set(int_master_status_t status)
+{
+  sigset_t set;
+
+  sigemptyset(&set);
+  sigaddset(&set, SIGALRM);
+  sigprocmask(status ? SIG_BLOCK : SIG_UNBLOCK, &set, NULL);
+}
+
+/*=== Helpers ================================================================*/
+static bool loc_blocked(void)
+{
+  sigset_t old;
+
+  sigprocmask(SIG_BLOCK, NULL, &old);
+  return sigismember(&old, SIGALRM);
+}
+
+/* Reads a report, adds its counters and checks the interrupts are enabled
+   again. */
+static void loc_read(uint32_t sum[COUNTERS])
+{
+  uint8_t buf[REPORT_LEN + 4U];
+  uint16_t counter;
+  unsigned i;
+
+  assert(REPORT_LEN == sf_slotStats_getReport(buf, sizeof(buf)));
+  assert(!loc_blocked());
+  assert(E_SF_SLOTSTATS_SITE_MAX == buf[0]);
+  for(i = 0; i < COUNTERS; i++)
+  {
+    memcpy(&counter, &buf[1U + i * 2U], sizeof(counter));
+    sum[i] += counter;
+  }
+}
+
+/* Simulated rtimer interrupt, one callback at random */
+static void loc_isr(int sig)
+{
+  unsigned r = (unsigned)rand() % (E_SF_SLOTSTATS_SITE_MAX + 6U);
+
+  (void)sig;
+  if(r < E_SF_SLOTSTATS_SITE_OTHER)
+  {
+    sf_slotStats_deadlineMissCallback(gSiteName[r]);
+    gExpected[r]++;
+  }
+  else if(r == E_SF_SLOTSTATS_SITE_OTHER)
+  {
+    sf_slotStats_deadlineMissCallback("later");
+    gExpected[E_SF_SLOTSTATS_SITE_OTHER]++;
+  }
+  else if(r == E_SF_SLOTSTATS_SITE_MAX)
+  {
+    sf_slotStats_slotSkippedCallback(1, 1, 0);
+    gExpected[E_SF_SLOTSTATS_SITE_MAX + SKIP_LOCKED]++;
+  }
+  else if(r == E_SF_SLOTSTATS_SITE_MAX + 1U)
+  {
+    sf_slotStats_slotSkippedCallback(0, 1, 0);
+    gExpected[E_SF_SLOTSTATS_SITE_MAX + SKIP_LOCK_REQ]++;
+  }
+  else if(r == E_SF_SLOTSTATS_SITE_MAX + 2U)
+  {
+    sf_slotStats_slotSkippedCallback(1, 0, 1);
+    gExpected[E_SF_SLOTSTATS_SITE_MAX + SKIP_NO_LINK]++;
+  }
+  else if(r == E_SF_SLOTSTATS_SITE_MAX + 3U)
+  {
+    sf_slotStats_inputQueueDropCallback();
+    gExpected[E_SF_SLOTSTATS_SITE_MAX + INPUT_QUEUE_DROP]++;
+  }
+  else if(r == E_SF_SLOTSTATS_SITE_MAX + 4U)
+  {
+    sf_slotStats_ackTimeoutCallback();
+    gExpected[E_SF_SLOTSTATS_SITE_MAX + ACK_TIMEOUT]++;
+  }
+  else
+  {
+    /* Slot skipped for none of the causes */
+    sf_slotStats_slotSkippedCallback(0, 0, 0);
+  }
+}
+
+static void loc_timer(long periodUs)
+{
+  struct itimerval it;
+
+  memset(&it, 0, sizeof(it));
+  it.it_interval.tv_usec = periodUs;
+  it.it_value.tv_usec = periodUs;
+  setitimer(ITIMER_REAL, &it, NULL);
+}
+
+static long loc_nowUs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000L + ts.tv_nsec / 1000L;
+}
+
+/*=== Tests ==================================================================*/
+/* Each counter at its position, the sites and causes apart. */
+static void test_report(void)
+{
+  uint32_t sum[COUNTERS] = {0};
+  uint8_t buf[REPORT_LEN];
+  unsigned site;
+  unsigned i;
+
+  loc_read(sum);
+  memset(sum, 0, sizeof(sum));
+
+  for(site = 0; site < E_SF_SLOTSTATS_SITE_OTHER; site++)
+  {
+    for(i = 0; i <= site; i++)
+    {
+      sf_slotStats_deadlineMissCallback(gSiteName[site]);
+    }
+  }
+  sf_slotStats_deadlineMissCallback(NULL);
+  sf_slotStats_deadlineMissCallback("Main");
+  /* No link first, then locked before the lock requested */
+  sf_slotStats_slotSkippedCallback(1, 1, 1);
+  sf_slotStats_slotSkippedCallback(1, 1, 0);
+  sf_slotStats_slotSkippedCallback(1, 0, 0);
+  sf_slotStats_slotSkippedCallback(0, 1, 0);
+  sf_slotStats_slotSkippedCallback(0, 0, 0);
+  sf_slotStats_inputQueueDropCallback();
+  sf_slotStats_ackTimeoutCallback();
+  sf_slotStats_ackTimeoutCallback();
+
+  /* Too short, the counters are kept */
+  assert(0U == sf_slotStats_getReport(buf, REPORT_LEN - 1U));
+  assert(0U == sf_slotStats_getReport(NULL, REPORT_LEN));
+  loc_read(sum);
+  for(site = 0; site < E_SF_SLOTSTATS_SITE_OTHER; site++)
+  {
+    assert(site + 1U == sum[site]);
+  }
+  assert(2U == sum[E_SF_SLOTSTATS_SITE_OTHER]);
+  assert(2U == sum[E_SF_SLOTSTATS_SITE_MAX + SKIP_LOCKED]);
+  assert(1U == sum[E_SF_SLOTSTATS_SITE_MAX + SKIP_LOCK_REQ]);
+  assert(1U == sum[E_SF_SLOTSTATS_SITE_MAX + SKIP_NO_LINK]);
+  assert(1U == sum[E_SF_SLOTSTATS_SITE_MAX + INPUT_QUEUE_DROP]);
+  assert(2U == sum[E_SF_SLOTSTATS_SITE_MAX + ACK_TIMEOUT]);
+
+  /* Restarted on read */
+  memset(sum, 0, sizeof(sum));
+  loc_read(sum);
+  for(i = 0; i < COUNTERS; i++)
+  {
+    assert(0U == sum[i]);
+  }
+}
+
+/* The counters stop at 0xFFFF. */
+static void test_saturation(void)
+{
+  uint32_t sum[COUNTERS] = {0};
+  uint32_t i;
+
+  for(i = 0; i < UINT16_MAX + 10UL; i++)
+  {
+    sf_slotStats_ackTimeoutCallback();
+  }
+  sf_slotStats_inputQueueDropCallback();
+  loc_read(sum);
+  assert(UINT16_MAX == sum[E_SF_SLOTSTATS_SITE_MAX + ACK_TIMEOUT]);
+  assert(1U == sum[E_SF_SLOTSTATS_SITE_MAX + INPUT_QUEUE_DROP]);
+}
+
+/* Every call site of the slot operation has its own counter. */
+static void test_sourceSites(void)
+{
+  static const char *const call[] = {"TSCH_SCHEDULE_AND_YIELD(",
+                                     "tsch_schedule_slot_operation("};
+  static char src[SOURCE_MAX_LEN];
+  uint32_t sum[COUNTERS] = {0};
+  unsigned found = 0;
+  FILE *pFile = fopen(SLOT_OPERATION_SRC, "r");
+  size_t len;
+  char *pCall;
+  char *pEnd;
+  char *pName;
+  char name[32];
+  unsigned depth;
+  unsigned c;
+  unsigned i;
+
+  assert(NULL != pFile);
+  len = fread(src, 1, sizeof(src) - 1U, pFile);
+  assert(!ferror(pFile) && feof(pFile));
+  fclose(pFile);
+  src[len] = '\0';
+
+  for(c = 0; c < sizeof(call) / sizeof(call[0]); c++)
+  {
+    for(pCall = strstr(src, call[c]); NULL != pCall;
+        pCall = strstr(pCall + 1, call[c]))
+    {
+      /* End of the call, the name is its last string literal */
+      pName = NULL;
+      for(pEnd = pCall + strlen(call[c]), depth = 1; depth > 0; pEnd++)
+      {
+        assert('\0' != *pEnd);
+        depth += ('(' == *pEnd) ? 1U : 0U;
+        depth -= (')' == *pEnd) ? 1U : 0U;
+        pName = ('"' == *pEnd) ? pEnd : pName;
+      }
+      /* The definitions pass the name on */
+      if(NULL == pName)
+      {
+        continue;
+      }
+      for(i = 0; ('"' != pName[-(int)i - 1]) && (i < sizeof(name) - 1U); i++)
+      {
+      }
+      assert(i < sizeof(name) - 1U);
+      memcpy(name, pName - i, i);
+      name[i] = '\0';
+      printf("call site %-16s\n", name);
+      sf_slotStats_deadlineMissCallback(name);
+      found++;
+    }
+  }
+
+  loc_read(sum);
+  assert(found >= E_SF_SLOTSTATS_SITE_OTHER);
+  assert(0U == sum[E_SF_SLOTSTATS_SITE_OTHER]);
+  for(i = 0; i < E_SF_SLOTSTATS_SITE_OTHER; i++)
+  {
+    assert(0U != sum[i]);
+  }
+}
+
+/* Counts from the interrupt while the reports are read. */
+static void test_stress(void)
+{
+  uint32_t sum[COUNTERS] = {0};
+  unsigned long total = 0;
+  unsigned reports = 0;
+  long start;
+  unsigned i;
+
+  srand(1);
+  loc_read(sum);
+  memset(sum, 0, sizeof(sum));
+  signal(SIGALRM, loc_isr);
+  loc_timer(ISR_PERIOD_US);
+  start = loc_nowUs();
+  while(loc_nowUs() - start < STRESS_US)
+  {
+    loc_read(sum);
+    reports++;
+  }
+  loc_timer(0);
+  loc_read(sum);
+
+  for(i = 0; i < COUNTERS; i++)
+  {
+    assert(gExpected[i] == sum[i]);
+    total += sum[i];
+  }
+  printf("%lu counts from the interrupt in %u reports\n", total, reports);
+  assert(total > 0U);
+}
+
+int main(void)
+{
+  /* Keep the report of the runs before a failed assertion */
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  test_report();
+  test_saturation();
+  test_sourceSites();
+  test_stress();
+
+  printf("test_slotStats: OK\n");
+  return 0;
+}
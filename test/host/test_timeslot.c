@@ -0,0 +1,97 @@
+/**
+ @file
+ @brief      Host checker of the timeslot timing profiles.
+
+ @details Each profile is checked with a timeline of its own, independent of
+          the macros the tables are built from: the receiver may be early or
+          late by half the guard time, the frame has the maximum length of
+          the profile, and the ACK must be heard by the transmitter and end
+          within the timeslot. The radio needs the turnaround time between
+          receiving and transmitting.
+*/
+#include <assert.h>
+#include <stdio.h>
+
+#include "sf-tsch-timeslot.h"
+#include "net/mac/tsch/tsch.h"
+
+/* Airtime of a byte and the PHY header (preamble, SFD and PHR) */
+#define BYTE_US           (8000 / SF_RADIO_BIT_RATE)
+#define PHY_HDR_LEN       6
+#define AIRTIME(len)      (((len) + PHY_HDR_LEN) * BYTE_US)
+/* Enhanced ACK with time correction IE */
+#define ACK_LEN           11
+/* Radio Rx/Tx turnaround */
+#define TURNAROUND_US     192
+
+/* Check a profile and return its slack at the end of the timeslot in us. */
+static int loc_check(const char *pName, uint8_t id)
+{
+  const uint16_t *t = sf_tsch_timeslot_get_timing(id);
+  uint8_t maxLen = sf_tsch_timeslot_get_max_frame_len(id);
+  /* Latest frame start and end in the time of the transmitter */
+  long frameStart;
+  long frameEnd;
+  /* Latest end of the ACK, seen by either node */
+  long ackEnd;
+
+  assert(NULL != t);
+  assert(0 != maxLen);
+
+  /* The maximum frame fits into MaxTx and a byte more does not. */
+  assert(AIRTIME(maxLen) <= t[tsch_ts_max_tx]);
+  assert((127 == maxLen) || (AIRTIME(maxLen + 1) > t[tsch_ts_max_tx]));
+  assert(AIRTIME(ACK_LEN) <= t[tsch_ts_max_ack]);
+
+  /* The CCA ends before the frame and the receiver listens early enough. */
+  assert(t[tsch_ts_cca_offset] + t[tsch_ts_cca] <= t[tsch_ts_tx_offset]);
+  assert(t[tsch_ts_rx_offset] + t[tsch_ts_rx_wait] / 2 <= t[tsch_ts_tx_offset]);
+  assert(t[tsch_ts_rx_offset] + t[tsch_ts_rx_wait] >=
+         t[tsch_ts_tx_offset] + t[tsch_ts_rx_wait] / 2);
+
+  /* Frame of a receiver late by half the guard time */
+  frameStart = t[tsch_ts_tx_offset] + t[tsch_ts_rx_wait] / 2;
+  frameEnd = frameStart + AIRTIME(maxLen);
+  assert(frameEnd <= t[tsch_ts_rx_offset] + t[tsch_ts_rx_wait] + t[tsch_ts_max_tx]);
+
+  /* ACK window of the transmitter around the ACK start of the receiver */
+  assert(t[tsch_ts_rx_ack_delay] + t[tsch_ts_ack_wait] / 2 <= t[tsch_ts_tx_ack_delay]);
+  assert(t[tsch_ts_rx_ack_delay] + t[tsch_ts_ack_wait] >=
+         t[tsch_ts_tx_ack_delay] + t[tsch_ts_ack_wait] / 2);
+  /* Both radios turn around in time. */
+  assert(t[tsch_ts_tx_ack_delay] >= TURNAROUND_US);
+  assert(t[tsch_ts_rx_ack_delay] >= TURNAROUND_US);
+  assert(t[tsch_ts_rx_tx] <= t[tsch_ts_tx_ack_delay]);
+
+  /* ACK of the late receiver and the end of the ACK window */
+  ackEnd = frameEnd + t[tsch_ts_tx_ack_delay] + AIRTIME(ACK_LEN);
+  if(t[tsch_ts_tx_offset] + t[tsch_ts_max_tx] + t[tsch_ts_rx_ack_delay] +
+     t[tsch_ts_ack_wait] + t[tsch_ts_max_ack] > ackEnd)
+  {
+    ackEnd = t[tsch_ts_tx_offset] + t[tsch_ts_max_tx] + t[tsch_ts_rx_ack_delay] +
+             t[tsch_ts_ack_wait] + t[tsch_ts_max_ack];
+  }
+  assert(ackEnd <= t[tsch_ts_timeslot_length]);
+
+  printf("%s: max frame %u bytes, %u us airtime, ACK end %ld us, slack %ld us\n",
+         pName, maxLen, AIRTIME(maxLen), ackEnd, t[tsch_ts_timeslot_length] - ackEnd);
+
+  return (int)(t[tsch_ts_timeslot_length] - ackEnd);
+}
+
+int main(void)
+{
+  loc_check("7500 us", SF_TSCH_TIMESLOT_ID_7500);
+#if SF_RADIO_BIT_RATE >= 250
+  loc_check("5000 us", SF_TSCH_TIMESLOT_ID_5000);
+  loc_check("4000 us", SF_TSCH_TIMESLOT_ID_4000);
+#endif
+  /* The default timing is the 7500 us profile, unknown IDs have none. */
+  assert(sf_tsch_timeslot_get_max_frame_len(0) ==
+         sf_tsch_timeslot_get_max_frame_len(SF_TSCH_TIMESLOT_ID_7500));
+  assert(NULL == sf_tsch_timeslot_get_timing(0x7F));
+  assert(0 == sf_tsch_timeslot_get_max_frame_len(0x7F));
+
+  printf("test_timeslot: OK\n");
+  return 0;
+}
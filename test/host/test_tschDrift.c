@@ -0,0 +1,319 @@
+/**
+ @file
+ @brief      Host simulation of the clock drift of an SC and of the beacon
+             skipping of the drift model.
+
+ @details The 32 kHz crystal of the SC drifts with the temperature on a
+          parabola around 25 C. The module runs unchanged on the Contiki-NG
+          processes and timers with a simulated clock. It is fed by a model
+          of the TSCH adaptive time synchronization, which learns the drift
+          at every synchronization at least 4 s apart and converges after 8.
+          At every beacon slot the module decides whether to listen. A
+          listened beacon is received if the clock error is within the Rx
+          guard time, and is lost on the air at a given rate. The clock
+          error grows by the uncompensated drift while not synchronized.
+
+          Reported per scenario: beacon listens saved, sync losses (beacons
+          missed due to the clock error) per listen and desynchronizations.
+          The clock error in the first minute after a warm and after a cold
+          restart is compared.
+*/
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch.h"
+#include "sf_persistentDataStorage.h"
+#include "sf_tschDrift.h"
+
+#define TIMESLOT_US        7500.0
+#define CYCLE_US           (APP_SLOTFRAME_SIZE * TIMESLOT_US)
+#define DAY_US             (86400.0 * 1e6)
+/* Beacons lost on the air */
+#define AIR_LOSS           0.05
+/* Drift at 25 C and parabola of the tuning fork crystal in ppm */
+#define CRYSTAL_PPM        18.0
+#define CRYSTAL_PARABOLA   (-0.035)
+/* Noise of a drift measurement of the adaptive time synchronization */
+#define MEAS_NOISE_PPM     0.5
+/* Drift learnings until the adaptive time synchronization converged */
+#define TIMESYNC_ENTRIES   8
+
+int tsch_is_associated;
+tsch_timeslot_timing_usec tsch_timing_us;
+
+static clock_time_t gNow;
+static double gTimeUs;
+static double gTempC;
+
+/* Adaptive time synchronization: drift compensated, in ppm * 256 */
+static int32_t gInitialDrift;
+static int32_t gCompensation;
+static int gLearnings;
+static double gLastLearningUs;
+
+/* Flash of the drift model */
+static sf_persistent_driftModel_t gFlashModel;
+static bool gFlashValid;
+static int gFlashWrites;
+
+/*=== Fakes ==================================================================*/
+clock_time_t clock_time(void)
+{
+  return gNow;
+}
+
+unsigned long clock_seconds(void)
+{
+  return gNow / CLOCK_SECOND;
+}
+
+int32_t tsch_adaptive_timesync_get_drift(void)
+{
+  return gCompensation;
+}
+
+int tsch_adaptive_timesync_is_converged(void)
+{
+  return tsch_is_associated && (gLearnings >= TIMESYNC_ENTRIES);
+}
+
+void tsch_adaptive_timesync_set_initial_drift(int32_t drift)
+{
+  gInitialDrift = drift;
+}
+
+E_SF_RETURN_t sf_persistentDataStorage_writeDriftModel(sf_persistent_driftModel_t *pDriftModel)
+{
+  gFlashModel = *pDriftModel;
+  gFlashValid = true;
+  gFlashWrites++;
+  return E_SF_SUCCESS;
+}
+
+E_SF_RETURN_t sf_persistentDataStorage_readDriftModel(sf_persistent_driftModel_t *pDriftModel)
+{
+  if(!gFlashValid)
+  {
+    return E_SF_ERROR;
+  }
+  *pDriftModel = gFlashModel;
+  return E_SF_SUCCESS;
+}
+
+/*=== Simulation =============================================================*/
+typedef enum
+{
+  E_SCENARIO_REST,
+  E_SCENARIO_CHARGING
+} E_SCENARIO_t;
+
+typedef struct
+{
+  unsigned long listened;
+  unsigned long skipped;
+  unsigned long syncLoss;
+  unsigned long desyncs;
+  double errMaxUs;
+} sim_result_t;
+
+static double loc_rand(void)
+{
+  return (double)rand() / RAND_MAX;
+}
+
+static double loc_temperature(E_SCENARIO_t scenario, double us)
+{
+  /* Daily swing of +-10 C around 30 C */
+  double t = 30.0 + 10.0 * sin(2.0 * M_PI * us / DAY_US);
+  double phase;
+
+  if(E_SCENARIO_CHARGING == scenario)
+  {
+    /* Every 6 h: +20 C within 20 min, cooling down within 1 h */
+    phase = fmod(us / 60e6, 360.0);
+    if(phase < 20.0)
+    {
+      t += 20.0 * phase / 20.0;
+    }
+    else if(phase < 80.0)
+    {
+      t += 20.0 * (80.0 - phase) / 60.0;
+    }
+  }
+  return t;
+}
+
+static double loc_trueDriftPpm(double tempC)
+{
+  return CRYSTAL_PPM + CRYSTAL_PARABOLA * (tempC - 25.0) * (tempC - 25.0);
+}
+
+/* Let the Contiki-NG processes run up to the current time */
+static void loc_advance(double us)
+{
+  gTimeUs += us;
+  gNow = (clock_time_t)(gTimeUs * CLOCK_SECOND / 1e6);
+  if(etimer_pending() &&
+     ((int32_t)(gNow - etimer_next_expiration_time()) >= 0))
+  {
+    etimer_request_poll();
+  }
+  while(process_run() > 0)
+  {
+  }
+}
+
+static void loc_associate(void)
+{
+  tsch_is_associated = 1;
+  gCompensation = gInitialDrift;
+  gLearnings = 0;
+  gLastLearningUs = gTimeUs;
+}
+
+/* Simulates durationUs from the current state. The first minute after the
+   start is recorded in pFirstMinUs if not NULL. */
+static void loc_run(E_SCENARIO_t scenario, double durationUs, sim_result_t *pRes,
+                    double *pFirstMinUs)
+{
+  double endUs = gTimeUs + durationUs;
+  double startUs = gTimeUs;
+  double lastSyncUs = gTimeUs;
+  double errUs = 0.0;
+  double guardUs = tsch_timing_us[tsch_ts_rx_wait] / 2.0;
+  double drift;
+  double measured;
+
+  memset(pRes, 0, sizeof(*pRes));
+  loc_associate();
+
+  while(gTimeUs < endUs)
+  {
+    loc_advance(CYCLE_US);
+    gTempC = loc_temperature(scenario, gTimeUs);
+    /* As the app, which samples the temperature with every measurement */
+    sf_tschDrift_setTemperature((int8_t)lround(gTempC));
+
+    drift = loc_trueDriftPpm(gTempC);
+    errUs += (drift - gCompensation / 256.0) * CYCLE_US / 1e6;
+    if((NULL != pFirstMinUs) && (gTimeUs - startUs < 60e6) &&
+       (fabs(errUs) > *pFirstMinUs))
+    {
+      *pFirstMinUs = fabs(errUs);
+    }
+    if(fabs(errUs) > pRes->errMaxUs)
+    {
+      pRes->errMaxUs = fabs(errUs);
+    }
+
+    if(!tsch_is_associated)
+    {
+      /* Scanning, joins at this beacon */
+      pRes->listened++;
+      loc_associate();
+      errUs = 0.0;
+      lastSyncUs = gTimeUs;
+      continue;
+    }
+
+    if((gTimeUs - lastSyncUs) * CLOCK_SECOND / 1e6 >= TSCH_DESYNC_THRESHOLD)
+    {
+      pRes->desyncs++;
+      tsch_is_associated = 0;
+      continue;
+    }
+
+    if(sf_tschDrift_skipBeaconCallback((clock_time_t)((gTimeUs - lastSyncUs) *
+                                                      CLOCK_SECOND / 1e6)))
+    {
+      pRes->skipped++;
+      continue;
+    }
+
+    pRes->listened++;
+    if(fabs(errUs) > guardUs)
+    {
+      pRes->syncLoss++;
+      continue;
+    }
+    if(loc_rand() < AIR_LOSS)
+    {
+      continue;
+    }
+
+    /* Synchronized. The drift is learned over at least 4 s. */
+    if(gTimeUs - gLastLearningUs >= 4e6)
+    {
+      measured = drift + (2.0 * loc_rand() - 1.0) * MEAS_NOISE_PPM;
+      gCompensation = (0 == gLearnings) ? (int32_t)(measured * 256.0) :
+                      (7 * gCompensation + (int32_t)(measured * 256.0)) / 8;
+      gLearnings++;
+      gLastLearningUs = gTimeUs;
+    }
+    errUs = 0.0;
+    lastSyncUs = gTimeUs;
+  }
+}
+
+static void loc_report(const char *pName, const sim_result_t *pRes)
+{
+  unsigned long slots = pRes->listened + pRes->skipped;
+
+  printf("%s: %lu beacon slots, %.1f %% listens saved, %lu sync losses "
+         "(%.3f %% of listens), %lu desyncs, clock error max %.0f us\n",
+         pName, slots, 100.0 * pRes->skipped / slots, pRes->syncLoss,
+         100.0 * pRes->syncLoss / pRes->listened, pRes->desyncs,
+         pRes->errMaxUs);
+}
+
+static void loc_check(const sim_result_t *pRes)
+{
+  assert(0U == pRes->desyncs);
+  assert(pRes->syncLoss * 1000U <= pRes->listened);
+  assert(pRes->skipped * 10U >= (pRes->listened + pRes->skipped) * 8U);
+}
+
+int main(void)
+{
+  sim_result_t res;
+  double warmUs = 0.0;
+  double coldUs = 0.0;
+
+  tsch_timing_us[tsch_ts_rx_wait] = TSCH_CONF_RX_WAIT;
+  tsch_timing_us[tsch_ts_timeslot_length] = (uint16_t)TIMESLOT_US;
+  srand(1);
+  process_init();
+  process_start(&etimer_process, NULL);
+
+  /* First power up, nothing stored */
+  sf_tschDrift_start(false);
+  loc_run(E_SCENARIO_REST, 3.0 * DAY_US, &res, NULL);
+  loc_report("at rest, 3 days", &res);
+  loc_check(&res);
+  assert(gFlashValid);
+
+  loc_run(E_SCENARIO_CHARGING, 3.0 * DAY_US, &res, NULL);
+  loc_report("charging every 6 h, 3 days", &res);
+  loc_check(&res);
+  printf("drift model checkpoints: %d in 6 days\n", gFlashWrites);
+
+  /* Reboot at the same time, with and without the stored model */
+  tsch_is_associated = 0;
+  gInitialDrift = 0;
+  sf_tschDrift_start(true);
+  loc_run(E_SCENARIO_REST, 60e6, &res, &warmUs);
+  tsch_is_associated = 0;
+  gInitialDrift = 0;
+  sf_tschDrift_start(false);
+  loc_run(E_SCENARIO_REST, 60e6, &res, &coldUs);
+  printf("first minute after a restart: clock error max %.0f us warm, "
+         "%.0f us cold\n", warmUs, coldUs);
+  assert(warmUs * 4.0 < coldUs);
+
+  printf("test_tschDrift: OK\n");
+  return 0;
+}
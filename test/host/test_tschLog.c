@@ -0,0 +1,548 @@
+/**
+ @file
+ @brief      Host test of the binary per-slot TSCH log and benchmark of the
+             log cost per slot in text and in binary mode.
+
+ @details The per-slot log of Contiki-NG is built unchanged in both modes,
+          the text mode as test_tschLogText. Both runs log the same slots
+          of an SC, an EB received, a measurement sent and a downlink
+          listened to per slotframe, messages of the process context and
+          text of other logs in between, and capture the UART output.
+
+          The text run keeps its output and its cost in build/. The binary
+          run decodes its output with tsch_log_reader and compares it line
+          by line with the text output; only the messages longer than
+          TSCH_LOG_BINARY_MESSAGE_LEN differ, as they are cut.
+
+          Reported per mode: the time of a log in the slot operation and
+          in the pending events process, the bytes and the UART time per
+          log, and the logs kept of a burst logged before the process
+          runs.
+*/
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch.h"
+#if TSCH_LOG_BINARY
+#include "tsch_log_reader.h"
+#endif
+
+#define SLOTFRAME_SIZE     11U
+#define SLOTFRAMES         2000U
+/* Logs between two runs of the pending events process */
+#define LOGS_PER_RUN       3U
+/* Logs before the pending events process runs */
+#define BURST              40U
+#define BENCH_RUNS         20000U
+#define UART_BAUD          115200.0
+#define TEXT_LOG           "build/tsch_log_text.log"
+#define TEXT_COST          "build/tsch_log_text.cost"
+#define LINE_MAX_LEN       256U
+
+typedef struct
+{
+  /* Time of a log in the slot operation and the process in ns */
+  double slotNs;
+  double processNs;
+  double bytes;
+  unsigned burstKept;
+} cost_t;
+
+static struct tsch_slotframe gSlotframe = {.handle = 0, .size = {.val = SLOTFRAME_SIZE}};
+static struct tsch_link gLink[] =
+{
+  /* EB */
+  {.slotframe_handle = 0, .timeslot = 0, .link_type = LINK_TYPE_ADVERTISING_ONLY},
+  /* Measurement to the BMS-CC */
+  {.addr = {{0x00, 0x01}}, .slotframe_handle = 0, .timeslot = 3},
+  /* Downlink from the BMS-CC */
+  {.addr = {{0x00, 0x01}}, .slotframe_handle = 0, .timeslot = 7},
+};
+static const linkaddr_t gCoordinator = {{0x00, 0x01}};
+static unsigned gLongMessages;
+static int gStdout;
+
+struct tsch_asn_t tsch_current_asn;
+struct tsch_link *current_link;
+uint8_t tsch_current_channel;
+uint8_t tsch_current_channel_offset;
+int tsch_current_burst_count;
+linkaddr_t linkaddr_node_addr = {{0x12, 0xa4}};
+
+PROCESS(tsch_pending_events_process, "pending events process");
+
+/*=== Fakes ==================================================================*/
+PROCESS_THREAD(tsch_pending_events_process, ev, data)
+{
+  PROCESS_BEGIN();
+  PROCESS_END();
+}
+
+clock_time_t clock_time(void)
+{
+  return 0;
+}
+
+struct tsch_slotframe *tsch_schedule_get_slotframe_by_handle(uint16_t handle)
+{
+  return (handle == gSlotframe.handle) ? &gSlotframe : NULL;
+}
+
+/* As log.c for 2 byte addresses */
+void log_lladdr_compact(const linkaddr_t *lladdr)
+{
+  if((NULL == lladdr) || linkaddr_cmp(lladdr, &linkaddr_null))
+  {
+    printf("LL-NULL");
+  }
+  else
+  {
+    printf("LL-%02x%02x", lladdr->u8[0], lladdr->u8[1]);
+  }
+}
+
+/*=== Helpers ================================================================*/
+static double loc_nowNs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* The UART output goes to a file until released */
+static void loc_capture(int fd)
+{
+  fflush(stdout);
+  gStdout = dup(STDOUT_FILENO);
+  assert(gStdout >= 0);
+  assert(dup2(fd, STDOUT_FILENO) >= 0);
+}
+
+static void loc_release(void)
+{
+  fflush(stdout);
+  assert(dup2(gStdout, STDOUT_FILENO) >= 0);
+  close(gStdout);
+}
+
+/* Logs slot n of the scenario as the slot operation or the process does */
+static void loc_log(unsigned n)
+{
+  unsigned slotframe = n / 3U;
+  uint64_t asn = 0xFFFFFF00ULL + (uint64_t)slotframe * SLOTFRAME_SIZE;
+  struct tsch_link *pLink = &gLink[n % 3U];
+  int drift = rand() % 61 - 30;
+  int r = rand() % 100;
+
+  asn += pLink->timeslot;
+  tsch_current_asn.ls4b = (uint32_t)asn;
+  tsch_current_asn.ms1b = (uint8_t)(asn >> 32);
+  tsch_current_channel_offset = (uint8_t)(slotframe % 4U);
+  tsch_current_channel = (uint8_t)(11U + (slotframe * 5U + pLink->timeslot) % 16U);
+  tsch_current_burst_count = 0;
+  current_link = pLink;
+
+  if(0U == (n % 97U))
+  {
+    /* From the process context, as tsch_schedule_slot_operation */
+    current_link = NULL;
+    if(r < 50)
+    {
+      gLongMessages++;
+      TSCH_LOG_ADD(tsch_log_message,
+                   snprintf(log->message, sizeof(log->message),
+                            "!dl-miss %s %d %d", "RxBeforeTx", drift + 100, 3000 + r));
+    }
+    else
+    {
+      TSCH_LOG_ADD(tsch_log_message,
+                   snprintf(log->message, sizeof(log->message), "!skipped slot"));
+    }
+    return;
+  }
+
+  switch(n % 3U)
+  {
+    case 0:
+      TSCH_LOG_ADD(tsch_log_rx,
+        linkaddr_copy(&log->rx.src, &gCoordinator);
+        log->rx.is_unicast = 0;
+        log->rx.datalen = 35;
+        log->rx.drift = drift;
+        log->rx.drift_used = 1;
+        log->rx.is_data = 0;
+        log->rx.sec_level = 0;
+        log->rx.estimated_drift = drift / 4;
+        log->rx.seqno = (uint8_t)slotframe;
+        log->rx.ack_data = 0;
+      );
+      break;
+    case 1:
+      /* A retransmission in the next slot of a burst now and then */
+      tsch_current_burst_count = (r >= 95) ? 1 : 0;
+      TSCH_LOG_ADD(tsch_log_tx,
+        log->tx.mac_tx_status = (r < 85) ? MAC_TX_OK : MAC_TX_NOACK;
+        log->tx.dest = gCoordinator;
+        log->tx.num_tx = (uint8_t)(1 + r % 3);
+        log->tx.datalen = 48;
+        log->tx.is_data = 1;
+        log->tx.sec_level = 5;
+        log->tx.drift = drift;
+        log->tx.drift_used = (r < 85);
+        log->tx.seqno = (uint8_t)(slotframe * 7U);
+        log->tx.radio_prop_err = (r < 2) ? -1 : 0;
+        log->tx.radio_sched_err = (r < 2) ? -70000 : 0;
+        log->tx.pendingTxCounter = r % 5;
+        log->tx.pendingTxCounterReset = 2;
+      );
+      break;
+    default:
+      TSCH_LOG_ADD(tsch_log_rx,
+        linkaddr_copy(&log->rx.src, &gCoordinator);
+        log->rx.is_unicast = 1;
+        log->rx.datalen = 21;
+        log->rx.drift = 0;
+        log->rx.drift_used = 0;
+        log->rx.is_data = 1;
+        log->rx.sec_level = 5;
+        log->rx.estimated_drift = -drift;
+        log->rx.seqno = (uint8_t)r;
+        log->rx.ack_data = (uint8_t)(r % 2);
+      );
+      break;
+  }
+}
+
+/* The scenario, with the text of other logs in between */
+static void loc_scenario(void)
+{
+  unsigned n;
+
+  srand(1);
+  gLongMessages = 0;
+  for(n = 0; n < SLOTFRAMES * 3U; n++)
+  {
+    loc_log(n);
+    if(0U == ((n + 1U) % LOGS_PER_RUN))
+    {
+      tsch_log_process_pending();
+    }
+    if(0U == (n % 300U))
+    {
+      printf("[INFO: Meas Sender] Measurement is transmitted to the BMS-CC; %04x\n", n);
+    }
+  }
+  tsch_log_process_pending();
+}
+
+static void loc_bench(cost_t *pCost)
+{
+  int null = open("/dev/null", O_WRONLY);
+  FILE *pCapture = tmpfile();
+  double slotNs = 0.0;
+  double processNs = 0.0;
+  double start;
+  long bytes;
+  unsigned run;
+  unsigned n;
+
+  assert((null >= 0) && (NULL != pCapture));
+  srand(2);
+  loc_capture(null);
+  for(run = 0; run < BENCH_RUNS; run++)
+  {
+    start = loc_nowNs();
+    for(n = 0; n < LOGS_PER_RUN; n++)
+    {
+      loc_log(run * LOGS_PER_RUN + n + 1U);
+    }
+    slotNs += loc_nowNs() - start;
+    start = loc_nowNs();
+    tsch_log_process_pending();
+    processNs += loc_nowNs() - start;
+  }
+  loc_release();
+  close(null);
+  pCost->slotNs = slotNs / (BENCH_RUNS * LOGS_PER_RUN);
+  pCost->processNs = processNs / (BENCH_RUNS * LOGS_PER_RUN);
+
+  /* Bytes of the same logs */
+  srand(2);
+  loc_capture(fileno(pCapture));
+  for(run = 0; run < BENCH_RUNS; run++)
+  {
+    for(n = 0; n < LOGS_PER_RUN; n++)
+    {
+      loc_log(run * LOGS_PER_RUN + n + 1U);
+    }
+    tsch_log_process_pending();
+  }
+  loc_release();
+  bytes = ftell(pCapture);
+  pCost->bytes = (double)bytes / (BENCH_RUNS * LOGS_PER_RUN);
+  fclose(pCapture);
+}
+
+/* Logs kept of a burst, taken from the output after it */
+static unsigned loc_burst(void)
+{
+  FILE *pCapture = tmpfile();
+  unsigned kept = 0;
+#if TSCH_LOG_BINARY
+  static tsch_log_reader_t reader;
+  int c;
+#else
+  char line[LINE_MAX_LEN];
+#endif
+  unsigned n;
+
+  assert(NULL != pCapture);
+  for(n = 0; n < BURST; n++)
+  {
+    loc_log(n + 1U);
+  }
+  loc_capture(fileno(pCapture));
+  tsch_log_process_pending();
+  loc_release();
+
+  rewind(pCapture);
+#if TSCH_LOG_BINARY
+  tsch_log_reader_init(&reader);
+  while(EOF != (c = fgetc(pCapture)))
+  {
+    if((TSCH_LOG_READ_RECORD == tsch_log_reader_feed(&reader, (uint8_t)c)) &&
+       (TSCH_LOG_RECORD_TYPE_DROPPED != reader.record.type))
+    {
+      kept++;
+    }
+  }
+#else
+  while(NULL != fgets(line, sizeof(line), pCapture))
+  {
+    kept += (NULL == strstr(line, "logs dropped"));
+  }
+#endif
+  fclose(pCapture);
+  return kept;
+}
+
+static void loc_printCost(const char *pMode, const cost_t *pCost)
+{
+  printf("%-6s mode: %6.1f ns in the slot, %7.1f ns in the process, "
+         "%5.1f bytes (%.2f ms on the UART) per log, %u of %u logs of a burst kept\n",
+         pMode, pCost->slotNs, pCost->processNs, pCost->bytes,
+         pCost->bytes * 10.0 * 1000.0 / UART_BAUD, pCost->burstKept, BURST);
+}
+
+/*=== Tests ==================================================================*/
+#if TSCH_LOG_BINARY
+/* The decoded log is the text log, the long messages cut */
+static void test_decode(void)
+{
+  static tsch_log_reader_t reader;
+  static tsch_log_stats_t stats;
+  FILE *pCapture = tmpfile();
+  FILE *pDecoded = tmpfile();
+  FILE *pText = fopen(TEXT_LOG, "r");
+  char text[LINE_MAX_LEN];
+  char decoded[LINE_MAX_LEN];
+  unsigned lines = 0;
+  unsigned cut = 0;
+  unsigned records = 0;
+  int c;
+
+  assert((NULL != pCapture) && (NULL != pDecoded));
+  assert(NULL != pText);
+  loc_capture(fileno(pCapture));
+  loc_scenario();
+  loc_release();
+
+  rewind(pCapture);
+  tsch_log_reader_init(&reader);
+  while(EOF != (c = fgetc(pCapture)))
+  {
+    switch(tsch_log_reader_feed(&reader, (uint8_t)c))
+    {
+      case TSCH_LOG_READ_RECORD:
+        tsch_log_print(pDecoded, &reader.record, &linkaddr_node_addr);
+        tsch_log_stats_add(&stats, &reader.record);
+        records++;
+        break;
+      case TSCH_LOG_READ_TEXT:
+        fprintf(pDecoded, "%s\n", reader.text);
+        break;
+      case TSCH_LOG_READ_INVALID:
+        assert(false);
+        break;
+      default:
+        break;
+    }
+  }
+  fclose(pCapture);
+
+  rewind(pDecoded);
+  while(NULL != fgets(text, sizeof(text), pText))
+  {
+    assert(NULL != fgets(decoded, sizeof(decoded), pDecoded));
+    lines++;
+    if(0 != strcmp(text, decoded))
+    {
+      decoded[strcspn(decoded, "\n")] = '\0';
+      assert(NULL != strstr(text, "link-NULL"));
+      assert(0 == strncmp(text, decoded, strlen(decoded)));
+      assert(TSCH_LOG_BINARY_MESSAGE_LEN == strlen(strrchr(decoded, '}') + 2));
+      cut++;
+    }
+  }
+  assert(NULL == fgets(decoded, sizeof(decoded), pDecoded));
+  fclose(pDecoded);
+  fclose(pText);
+  assert(gLongMessages == cut);
+  assert(SLOTFRAMES * 3U == records);
+
+  /* The slots of the scenario */
+  assert((SLOTFRAMES * 3U == stats.records) && (0U == stats.dropped));
+  assert((3U == stats.slots) && (3U == stats.slot[1].timeslot) && (0U == stats.slot[1].rx));
+  assert(stats.slot[1].txOk + stats.slot[1].txNoAck == stats.slot[1].tx);
+  assert((0U == stats.slot[2].tx) && (0U == stats.slot[2].drifts));
+  printf("%u lines decoded as in text mode, %u messages cut\n", lines, cut);
+  tsch_log_stats_print(stdout, &stats);
+}
+
+/* Text between the frames, bytes to escape, corrupted frames and a frame
+   missing its END */
+static void test_reader(void)
+{
+  static const char text[] = "[INFO: App       ] hi\n";
+  static const char message[] = "\xc0\xdb end";
+  static tsch_log_reader_t reader;
+  const size_t textLen = sizeof(text) - 1U;
+  uint8_t stream[2 * sizeof(struct tsch_log_record_t) + sizeof(text) + 8];
+  FILE *pCapture = tmpfile();
+  unsigned counts[4];
+  size_t len;
+  size_t i;
+  size_t j;
+
+  assert(NULL != pCapture);
+  loc_capture(fileno(pCapture));
+  printf("%s", text);
+  TSCH_LOG_ADD(tsch_log_message, memcpy(log->message, message, sizeof(message)));
+  tsch_log_process_pending();
+  loc_release();
+  len = (size_t)ftell(pCapture);
+  assert(len < sizeof(stream));
+  rewind(pCapture);
+  assert(len == fread(stream, 1, len, pCapture));
+  fclose(pCapture);
+
+  memset(counts, 0, sizeof(counts));
+  tsch_log_reader_init(&reader);
+  for(i = 0; i < len; i++)
+  {
+    counts[tsch_log_reader_feed(&reader, stream[i])]++;
+  }
+  assert((1U == counts[TSCH_LOG_READ_TEXT]) && (1U == counts[TSCH_LOG_READ_RECORD]));
+  assert(0 == strncmp(text, reader.text, textLen - 1U));
+  assert(0 == strcmp(message, reader.record.message));
+
+  /* Each byte flipped but the ENDs: the text stays text, the record is lost */
+  for(i = 0; i < len - 1U; i++)
+  {
+    if(textLen == i)
+    {
+      continue;
+    }
+    stream[i] ^= 0x01;
+    memset(counts, 0, sizeof(counts));
+    tsch_log_reader_init(&reader);
+    for(j = 0; j < len; j++)
+    {
+      counts[tsch_log_reader_feed(&reader, stream[j])]++;
+    }
+    stream[i] ^= 0x01;
+    /* Unless the line end is lost */
+    assert(((textLen - 1U == i) ? 0U : 1U) == counts[TSCH_LOG_READ_TEXT]);
+    assert((i < textLen) ? (1U == counts[TSCH_LOG_READ_RECORD]) :
+           ((0U == counts[TSCH_LOG_READ_RECORD]) && (counts[TSCH_LOG_READ_INVALID] >= 1U)));
+  }
+
+  /* Two frames with the END between them lost, then a frame again */
+  memset(counts, 0, sizeof(counts));
+  tsch_log_reader_init(&reader);
+  for(i = textLen; i < len - 1U; i++)
+  {
+    counts[tsch_log_reader_feed(&reader, stream[i])]++;
+  }
+  for(i = textLen + 1U; i < len; i++)
+  {
+    counts[tsch_log_reader_feed(&reader, stream[i])]++;
+  }
+  assert((1U == counts[TSCH_LOG_READ_INVALID]) && (0U == counts[TSCH_LOG_READ_RECORD]));
+  for(i = textLen; i < len; i++)
+  {
+    counts[tsch_log_reader_feed(&reader, stream[i])]++;
+  }
+  assert(1U == counts[TSCH_LOG_READ_RECORD]);
+}
+#endif /* TSCH_LOG_BINARY */
+
+int main(void)
+{
+  cost_t cost;
+#if TSCH_LOG_BINARY
+  cost_t textCost;
+  FILE *pFile;
+#else
+  FILE *pFile = fopen(TEXT_LOG, "w");
+#endif
+
+  /* Keep the report of the runs before a failed assertion */
+  setvbuf(stdout, NULL, _IOLBF, 0);
+  tsch_log_init();
+
+#if TSCH_LOG_BINARY
+  test_reader();
+  test_decode();
+#else
+  assert(NULL != pFile);
+  loc_capture(fileno(pFile));
+  loc_scenario();
+  loc_release();
+  fclose(pFile);
+#endif
+
+  loc_bench(&cost);
+  cost.burstKept = loc_burst();
+
+#if TSCH_LOG_BINARY
+  pFile = fopen(TEXT_COST, "r");
+  assert(NULL != pFile);
+  assert(4 == fscanf(pFile, "%lf %lf %lf %u", &textCost.slotNs, &textCost.processNs,
+                     &textCost.bytes, &textCost.burstKept));
+  fclose(pFile);
+  loc_printCost("text", &textCost);
+  loc_printCost("binary", &cost);
+  assert(cost.bytes < textCost.bytes / 2.0);
+  assert(cost.processNs < textCost.processNs);
+  /* A ring index keeps one entry less than its size */
+  assert((TSCH_LOG_BINARY_QUEUE_LEN - 1U == cost.burstKept) &&
+         (TSCH_LOG_QUEUE_LEN - 1U == textCost.burstKept));
+  printf("test_tschLog: OK\n");
+#else
+  pFile = fopen(TEXT_COST, "w");
+  assert(NULL != pFile);
+  fprintf(pFile, "%f %f %f %u\n", cost.slotNs, cost.processNs, cost.bytes, cost.burstKept);
+  fclose(pFile);
+  loc_printCost("text", &cost);
+  printf("test_tschLogText: OK\n");
+#endif
+  return 0;
+}
@@ -0,0 +1,421 @@
+/**
+ @file
+ @brief      Host simulation of the retransmission policies of the
+             measurements on a link with bursty losses.
+
+ @details The policy of sf_tsch and the ETX of link-stats run unchanged. The
+          network driver models nullnet with a single frame in flight and
+          the TSCH queue of the SC: a new measurement is refused while the
+          previous one is queued, the frame is sent in the Tx slot of the
+          SC, once per slotframe, up to its maximum number of transmissions
+          and is dropped unsent once its time to live elapsed. Every attempt
+          is lost according to a Gilbert-Elliott channel changing its state
+          per slotframe.
+
+          A measurement is sent at the first cycle start of every
+          measurement interval, at the lowest interval at every cycle start.
+          Compared are the former fixed policy, 2 transmissions without a
+          time to live, and the adaptive policy of the traffic class with
+          and without the measurement interval as the lifetime. Reported per channel and interval: delivery ratio of the
+          measurements, airtime as transmissions per measurement, and the
+          latency from the cycle start until the ACK, mean and 95th
+          percentile.
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/link-stats.h"
+#include "net/nullnet/nullnet.h"
+#include "net/mac/tsch/tsch.h"
+#include "sf_callbackHandler.h"
+#include "sf-tsch-schedule.h"
+#include "sf-tsch-timeslot.h"
+#include "sf_tsch.h"
+#include "sf_linkQuality.h"
+#include "sf_txPower.h"
+
+#define SLOT_US            7500UL
+#define SLOTFRAME_MS       (APP_SLOTFRAME_SIZE * SLOT_US / 1000.0)
+#define MEAS               20000U
+/* SF_CONFIGMGMT_MEAS_INTERVAL_LIMIT_LOWER */
+#define INTERVAL_MIN       3U
+/* Tx slot of the SC in its slotframe */
+#define TX_SLOT            100U
+/* Former fixed policy */
+#define FIXED_MAX_TX       2U
+#define LATENCY_MAX        64U
+
+typedef struct
+{
+  const char *pName;
+  /* Transitions per slotframe from the good to the bad state and back */
+  double pGoodBad;
+  double pBadGood;
+  /* Loss of an attempt per state */
+  double lossGood;
+  double lossBad;
+} sim_channel_t;
+
+typedef enum
+{
+  SIM_POLICY_FIXED,
+  SIM_POLICY_CLASS,
+  SIM_POLICY_LIFETIME
+} sim_policy_t;
+
+typedef struct
+{
+  unsigned generated;
+  unsigned delivered;
+  unsigned attempts;
+  /* Latency in slotframes */
+  unsigned latency[LATENCY_MAX];
+} sim_result_t;
+
+static const linkaddr_t gBmscc = {{0x01, 0x00}};
+
+/* Queued frame of the TSCH queue */
+static bool gQueued;
+static uint32_t gGeneratedAsn;
+static uint32_t gExpiryAsn;
+static uint8_t gMaxTx;
+static uint8_t gTx;
+static packetbuf_attr_t gAttr[PACKETBUF_NUM_ATTRS];
+static uint32_t gAsn;
+static bool gBad;
+static sim_result_t *gRes;
+
+uint8_t tsch_timeslot_id;
+tsch_timeslot_timing_usec tsch_timing_us;
+uint8_t *nullnet_buf;
+uint16_t nullnet_len;
+
+static double loc_rand(void)
+{
+  return (double)rand() / ((double)RAND_MAX + 1.0);
+}
+
+/*=== Fakes ==================================================================*/
+clock_time_t clock_time(void)
+{
+  return (clock_time_t)((uint64_t)gAsn * SLOT_US * CLOCK_SECOND / 1000000UL);
+}
+
+int packetbuf_set_attr(uint8_t type, const packetbuf_attr_t val)
+{
+  gAttr[type] = val;
+  return 1;
+}
+
+packetbuf_attr_t packetbuf_attr(uint8_t type)
+{
+  return gAttr[type];
+}
+
+/* nullnet with a single frame in flight, queued as by tsch-queue */
+static uint8_t loc_output(const linkaddr_t *pDest, void *pCtx, const uint8_t frameType)
+{
+  (void)pDest;
+  (void)pCtx;
+  (void)frameType;
+
+  if(gQueued)
+  {
+    return 0;
+  }
+  gQueued = true;
+  gGeneratedAsn = gAsn;
+  gMaxTx = (uint8_t)packetbuf_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS);
+  gExpiryAsn = (0U != packetbuf_attr(PACKETBUF_ATTR_MAC_TTL)) ?
+               gAsn + packetbuf_attr(PACKETBUF_ATTR_MAC_TTL) : 0U;
+  gTx = 0;
+  assert(gMaxTx >= 1U);
+  return 1;
+}
+
+const struct network_driver host_network_driver = {
+  .output = loc_output,
+};
+
+const struct radio_driver host_radio_driver;
+const struct mac_driver host_mac_driver;
+
+void nullnet_set_input_callback(nullnet_input_callback_t callback)
+{
+  (void)callback;
+}
+
+void nullnet_set_output_callback(nullnet_output_callback_t callback)
+{
+  (void)callback;
+}
+
+void sf_input_callback_handler(const void *data, uint16_t len,
+                               const linkaddr_t *src, const linkaddr_t *dest)
+{
+  (void)data;
+  (void)len;
+  (void)src;
+  (void)dest;
+}
+
+void sf_output_callback_handler(void *ptr, nullnet_tx_status_t status,
+                                uint8_t ackAppData)
+{
+  (void)ptr;
+  (void)status;
+  (void)ackAppData;
+}
+
+int sf_tsch_schedule_init(void)
+{
+  return 1;
+}
+
+int sf_tsch_schedule_add_beacon_slots(void)
+{
+  return 1;
+}
+
+int sf_tsch_schedule_add_data_slots(const linkaddr_t *pAddr)
+{
+  (void)pAddr;
+  return 1;
+}
+
+uint8_t sf_tsch_timeslot_get_max_frame_len(uint8_t timeslotId)
+{
+  (void)timeslotId;
+  return 127U;
+}
+
+void sf_linkQuality_txCallback(const linkaddr_t *pAddr, uint8_t macTxStatus,
+                               uint8_t channel, int16_t ackRssi)
+{
+  (void)pAddr;
+  (void)macTxStatus;
+  (void)channel;
+  (void)ackRssi;
+}
+
+void sf_txPower_txCallback(uint8_t macTxStatus, int16_t ackRssi)
+{
+  (void)macTxStatus;
+  (void)ackRssi;
+}
+
+void tsch_set_coordinator(int enable)
+{
+  (void)enable;
+}
+
+void tsch_scan_enable(void)
+{
+}
+
+linkaddr_t linkaddr_node_addr;
+
+void linkaddr_set_node_addr(linkaddr_t *addr)
+{
+  linkaddr_copy(&linkaddr_node_addr, addr);
+}
+
+/*=== Model ==================================================================*/
+/* Tx slot of the SC, the queued frame is sent or dropped. */
+static void loc_txSlot(const sim_channel_t *pChannel)
+{
+  unsigned latency;
+  bool ok;
+
+  if(!gQueued)
+  {
+    return;
+  }
+  if((0U != gExpiryAsn) && ((int32_t)(gAsn - gExpiryAsn) > 0))
+  {
+    /* Stale, dropped without sending. Not counted by link-stats. */
+    gQueued = false;
+    return;
+  }
+
+  gTx++;
+  gRes->attempts++;
+  ok = loc_rand() >= (gBad ? pChannel->lossBad : pChannel->lossGood);
+  if(ok)
+  {
+    latency = (gAsn - gGeneratedAsn) / APP_SLOTFRAME_SIZE;
+    gRes->delivered++;
+    gRes->latency[(latency < LATENCY_MAX) ? latency : LATENCY_MAX - 1U]++;
+    link_stats_packet_sent(&gBmscc, MAC_TX_OK, gTx);
+    gQueued = false;
+  }
+  else if(gTx >= gMaxTx)
+  {
+    link_stats_packet_sent(&gBmscc, MAC_TX_NOACK, gTx);
+    gQueued = false;
+  }
+}
+
+/*=== Simulation =============================================================*/
+static void loc_run(sim_policy_t policy, const sim_channel_t *pChannel,
+                    unsigned interval, sim_result_t *pRes)
+{
+  sf_callbackHandlerCtxt_t ctx = {0};
+  uint8_t frame[16] = {0};
+  double nextMs = 0.0;
+  unsigned sf;
+
+  memset(pRes, 0, sizeof(*pRes));
+  gRes = pRes;
+  srand(1);
+  gAsn = 0;
+  gQueued = false;
+  gBad = false;
+  link_stats_reset();
+  /* Known from the beacons and the join, as on the SC */
+  packetbuf_set_attr(PACKETBUF_ATTR_RSSI, (packetbuf_attr_t)-70);
+  link_stats_input_callback(&gBmscc);
+
+  for(sf = 0; pRes->generated < MEAS; sf++)
+  {
+    /* Cycle start */
+    gAsn = sf * APP_SLOTFRAME_SIZE;
+    if((INTERVAL_MIN >= interval) || (sf * SLOTFRAME_MS >= nextMs))
+    {
+      nextMs += interval * 1000.0;
+      pRes->generated++;
+      if(SIM_POLICY_FIXED != policy)
+      {
+        assert(E_SF_SUCCESS == sf_tsch_setTxPolicy(E_SF_TSCH_TRAFFIC_MEAS, &gBmscc,
+                                                   (SIM_POLICY_LIFETIME == policy) ?
+                                                   interval : 0U));
+      }
+      else
+      {
+        packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS, FIXED_MAX_TX);
+        packetbuf_set_attr(PACKETBUF_ATTR_MAC_TTL, 0U);
+      }
+      assert(E_SF_SUCCESS == sf_tsch_send(frame, sizeof(frame),
+                                          (linkaddr_t *)&gBmscc, &ctx));
+    }
+
+    gAsn += TX_SLOT;
+    loc_txSlot(pChannel);
+
+    gBad = gBad ? (loc_rand() >= pChannel->pBadGood) :
+                  (loc_rand() < pChannel->pGoodBad);
+  }
+}
+
+static double loc_latencyMean(const sim_result_t *pRes)
+{
+  double sum = 0.0;
+  unsigned i;
+
+  for(i = 0; i < LATENCY_MAX; i++)
+  {
+    sum += (double)pRes->latency[i] * (i * SLOTFRAME_MS + TX_SLOT * SLOT_US / 1000.0);
+  }
+  return sum / pRes->delivered;
+}
+
+static double loc_latencyP95(const sim_result_t *pRes)
+{
+  unsigned count = 0;
+  unsigned i;
+
+  for(i = 0; i < LATENCY_MAX; i++)
+  {
+    count += pRes->latency[i];
+    if(count * 100U >= pRes->delivered * 95U)
+    {
+      break;
+    }
+  }
+  return i * SLOTFRAME_MS + TX_SLOT * SLOT_US / 1000.0;
+}
+
+static double loc_delivery(const sim_result_t *pRes)
+{
+  return (double)pRes->delivered / pRes->generated;
+}
+
+static void loc_report(const char *pName, const sim_result_t *pRes)
+{
+  printf("  %-11s delivery %5.1f %%, %.2f Tx per measurement, latency "
+         "mean %5.2f s p95 %5.2f s\n", pName, 100.0 * loc_delivery(pRes),
+         (double)pRes->attempts / pRes->generated,
+         loc_latencyMean(pRes) / 1000.0, loc_latencyP95(pRes) / 1000.0);
+}
+
+int main(void)
+{
+  static const sim_channel_t channels[] =
+  {
+    {"good link",  0.01, 0.50, 0.02, 0.80},
+    {"bursty",     0.05, 0.30, 0.05, 0.90},
+    {"poor link",  0.10, 0.20, 0.20, 0.95},
+  };
+  /* Measurement intervals in seconds */
+  static const unsigned intervals[] = {INTERVAL_MIN, 30U};
+  sim_result_t fixed;
+  sim_result_t class;
+  sim_result_t adaptive;
+  unsigned c;
+  unsigned i;
+
+  /* Keep the report of the runs before a failed assertion */
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  tsch_timing_us[tsch_ts_timeslot_length] = SLOT_US;
+  process_init();
+  process_start(&etimer_process, NULL);
+  ctimer_init();
+  link_stats_init();
+
+  for(c = 0; c < sizeof(channels) / sizeof(channels[0]); c++)
+  {
+    for(i = 0; i < sizeof(intervals) / sizeof(intervals[0]); i++)
+    {
+      printf("%s, measurement interval %u s:\n", channels[c].pName,
+             intervals[i]);
+      loc_run(SIM_POLICY_FIXED, &channels[c], intervals[i], &fixed);
+      loc_report("fixed", &fixed);
+      loc_run(SIM_POLICY_CLASS, &channels[c], intervals[i], &class);
+      loc_report("no lifetime", &class);
+      loc_run(SIM_POLICY_LIFETIME, &channels[c], intervals[i], &adaptive);
+      loc_report("adaptive", &adaptive);
+
+      /* No worse delivery for at most the airtime of the fixed policy on a
+         good link. */
+      assert(adaptive.delivered * 1000U >= fixed.delivered * 995U);
+      if(channels[c].lossGood <= 0.02)
+      {
+        assert(adaptive.attempts * 100U <= fixed.attempts * 105U);
+      }
+      if(INTERVAL_MIN >= intervals[i])
+      {
+        /* Every cycle brings a new measurement. A retransmission in the
+           next cycle refuses it, the delivery stays the same and the
+           latency grows. */
+        assert(adaptive.attempts <= fixed.attempts);
+        assert(loc_latencyP95(&adaptive) <= loc_latencyP95(&fixed));
+        assert(loc_latencyMean(&adaptive) < loc_latencyMean(&class));
+        assert(class.delivered * 1000U <= adaptive.delivered * 1005U);
+      }
+      else if(channels[c].lossGood > 0.02)
+      {
+        /* The slots until the next measurement recover the bursts */
+        assert(loc_delivery(&adaptive) > loc_delivery(&fixed) + 0.03);
+      }
+    }
+  }
+
+  printf("test_txPolicySim: OK\n");
+  return 0;
+}
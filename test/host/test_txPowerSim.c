@@ -0,0 +1,262 @@
+/**
+ @file
+ @brief      Host model of the closed-loop Tx power control of an SC.
+
+ @details The control loop runs unchanged on the Contiki-NG processes, on
+          the power table of the CC2652R. Every measurement is sent with up
+          to 4 transmissions. The BMS-CC sends the ACKs at the maximum
+          power, the path loss is the same in both directions. Each frame
+          and each ACK sees the path loss plus a Gaussian fading and is
+          received with a logistic probability around the sensitivity.
+
+          The charge of an attempt is the Tx current of the power level for
+          the frame plus the Rx current for the ACK. Compared are the fixed
+          maximum power and the control loop per path loss: PRR of the
+          measurements, mean Tx power, mean RSSI of the frames at the
+          BMS-CC and charge per delivered measurement.
+          A link losing 30 dB at once shows the fast step up: measurements
+          lost and attempts in the 100 measurements after the loss.
+*/
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/mac/mac.h"
+#include "rf/tx-power.h"
+#include "sf_txPower.h"
+
+#define FRAMES             20000U
+#define MAX_TX             4U
+/* Received with 50 % at the sensitivity, in dB per e-fold */
+#define SENSITIVITY_DBM    (-97.0)
+#define SLOPE_DB           1.5
+#define FADING_DB          2.0
+/* Measurement frame of 60 bytes and ACK at 250 kbit/s */
+#define FRAME_MS           ((6.0 + 60.0) * 0.032)
+#define ACK_MS             (1.0 + (6.0 + 5.0) * 0.032)
+#define RX_MA              6.9
+/* SF_TXPOWER_TARGET_RSSI */
+#define TARGET_RSSI        (-75.0)
+
+/* Power levels of the CC2652R and their Tx current in mA */
+static tx_power_table_t gTable[] =
+{
+  {-20}, {-15}, {-10}, {-5}, {0}, {1}, {2}, {3}, {4}, {5}
+};
+static const double gTxMa[] =
+{
+  3.8, 4.3, 4.9, 5.9, 7.3, 7.6, 8.0, 8.5, 9.1, 9.6
+};
+#define LEVELS             (sizeof(gTable) / sizeof(gTable[0]))
+
+tx_power_table_t *const rf_tx_power_table = gTable;
+const size_t rf_tx_power_table_size = LEVELS;
+
+static int8_t gPower;
+
+typedef struct
+{
+  unsigned delivered;
+  unsigned attempts;
+  double chargeUc;
+  double powerSum;
+  /* RSSI of the received frames at the BMS-CC */
+  double rssiSum;
+  unsigned received;
+} sim_result_t;
+
+/*=== Fakes ==================================================================*/
+clock_time_t clock_time(void)
+{
+  return 0;
+}
+
+static radio_result_t loc_radioGet(radio_param_t param, radio_value_t *pValue)
+{
+  (void)param;
+  *pValue = 0;
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+
+static radio_result_t loc_radioSet(radio_param_t param, radio_value_t value)
+{
+  assert(RADIO_PARAM_TXPOWER == param);
+  gPower = (int8_t)value;
+  return RADIO_RESULT_OK;
+}
+
+const struct radio_driver host_radio_driver = {
+  .get_value = loc_radioGet,
+  .set_value = loc_radioSet,
+};
+
+const struct mac_driver host_mac_driver;
+
+int tsch_get_lock(void)
+{
+  return 1;
+}
+
+void tsch_release_lock(void)
+{
+}
+
+/*=== Model ==================================================================*/
+static double loc_gauss(void)
+{
+  double u1 = ((double)rand() + 1.0) / ((double)RAND_MAX + 2.0);
+  double u2 = (double)rand() / ((double)RAND_MAX + 1.0);
+
+  return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+/* Returns the RSSI if received, a value below -200 dBm otherwise */
+static double loc_receive(double powerDbm, double pathLossDb)
+{
+  double rssi = powerDbm - pathLossDb + FADING_DB * loc_gauss();
+  double pOk = 1.0 / (1.0 + exp(-(rssi - SENSITIVITY_DBM) / SLOPE_DB));
+
+  return ((double)rand() / ((double)RAND_MAX + 1.0) < pOk) ? rssi : -1000.0;
+}
+
+static int loc_level(int8_t power)
+{
+  unsigned l;
+
+  for(l = 0; l < LEVELS; l++)
+  {
+    if(gTable[l].power == power)
+    {
+      return (int)l;
+    }
+  }
+  assert(false);
+  return -1;
+}
+
+/* Sends one measurement, returns true if the BMS-CC received it */
+static bool loc_sendFrame(bool control, double pathLossDb, sim_result_t *pRes)
+{
+  bool delivered = false;
+  double rssi;
+  double ack;
+  unsigned t;
+
+  for(t = 0; t < MAX_TX; t++)
+  {
+    pRes->attempts++;
+    pRes->powerSum += gPower;
+    pRes->chargeUc += gTxMa[loc_level(gPower)] * FRAME_MS + RX_MA * ACK_MS;
+    ack = -1000.0;
+    rssi = loc_receive(gPower, pathLossDb);
+    if(rssi > -200.0)
+    {
+      pRes->rssiSum += rssi;
+      pRes->received++;
+      delivered = true;
+      ack = loc_receive(gTable[LEVELS - 1].power, pathLossDb);
+    }
+    if(control)
+    {
+      sf_txPower_txCallback((ack > -200.0) ? MAC_TX_OK : MAC_TX_NOACK,
+                            (ack > -200.0) ? (int16_t)lround(ack) : 0);
+      while(process_run() > 0)
+      {
+      }
+    }
+    if(ack > -200.0)
+    {
+      break;
+    }
+  }
+  pRes->delivered += delivered;
+  return delivered;
+}
+
+static void loc_run(bool control, double pathLossDb, sim_result_t *pRes)
+{
+  unsigned f;
+
+  memset(pRes, 0, sizeof(*pRes));
+  srand(1);
+  gPower = gTable[LEVELS - 1].power;
+  if(control)
+  {
+    sf_txPower_reset();
+    while(process_run() > 0)
+    {
+    }
+    assert(gTable[LEVELS - 1].power == sf_txPower_get());
+  }
+  for(f = 0; f < FRAMES; f++)
+  {
+    loc_sendFrame(control, pathLossDb, pRes);
+  }
+}
+
+static void loc_report(const char *pName, const sim_result_t *pRes)
+{
+  printf("  %-8s PRR %5.1f %%, mean Tx power %5.1f dBm, RSSI at the BMS-CC "
+         "%6.1f dBm, %5.1f uC per delivered frame\n", pName,
+         100.0 * pRes->delivered / FRAMES, pRes->powerSum / pRes->attempts,
+         pRes->rssiSum / pRes->received, pRes->chargeUc / pRes->delivered);
+}
+
+int main(void)
+{
+  static const double pathLossDb[] = {40.0, 60.0, 70.0, 75.0, 85.0, 95.0};
+  sim_result_t fixed;
+  sim_result_t tpc;
+  unsigned lost = 0;
+  unsigned p;
+  unsigned f;
+
+  /* Keep the report of the runs before a failed assertion */
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  process_init();
+  sf_txPower_init();
+
+  for(p = 0; p < sizeof(pathLossDb) / sizeof(pathLossDb[0]); p++)
+  {
+    printf("path loss %.0f dB:\n", pathLossDb[p]);
+    loc_run(false, pathLossDb[p], &fixed);
+    loc_report("fixed", &fixed);
+    loc_run(true, pathLossDb[p], &tpc);
+    loc_report("control", &tpc);
+
+    /* Delivery kept and the frames arrive above the target where the
+       maximum power allows it. Less charge on the strong links, the weak
+       links stay at the maximum power. */
+    assert(tpc.delivered * 1000U >= fixed.delivered * 995U);
+    if(fixed.rssiSum / fixed.received >= TARGET_RSSI)
+    {
+      assert(tpc.rssiSum / tpc.received >= TARGET_RSSI - 1.0);
+    }
+    if(pathLossDb[p] <= 60.0)
+    {
+      assert(tpc.chargeUc / tpc.delivered < 0.75 * fixed.chargeUc / fixed.delivered);
+    }
+    assert(tpc.chargeUc / tpc.delivered < 1.02 * fixed.chargeUc / fixed.delivered);
+  }
+
+  /* Settled on a strong link, then 30 dB more path loss */
+  loc_run(true, 60.0, &tpc);
+  memset(&tpc, 0, sizeof(tpc));
+  for(f = 0; f < 100U; f++)
+  {
+    lost += !loc_sendFrame(true, 90.0, &tpc);
+  }
+  printf("path loss 60 dB to 90 dB: %u of 100 frames lost, %u attempts, "
+         "Tx power %d dBm\n", lost, tpc.attempts, sf_txPower_get());
+  assert(lost <= 2U);
+  assert(tpc.attempts <= 110U);
+  assert(sf_txPower_get() >= 0);
+
+  printf("test_txPowerSim: OK\n");
+  return 0;
+}
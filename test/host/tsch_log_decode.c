@@ -0,0 +1,77 @@
+/**
+ @file
+ @brief      Decoder of the binary per-slot TSCH log, see tsch_log_reader.h.
+
+ @details Usage: tsch_log_decode [-a <own address>] [-s] [uart capture]
+          Prints the log as in text mode, the other logs as they are, from
+          the capture or the standard input. The own address is given as 4
+          hex digits. With -s, the per-slot statistics follow the log.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "tsch_log_reader.h"
+
+int main(int argc, char *argv[])
+{
+  static tsch_log_reader_t reader;
+  static tsch_log_stats_t stats;
+  linkaddr_t ownAddr = linkaddr_null;
+  bool withStats = false;
+  unsigned invalid = 0;
+  unsigned long addr;
+  FILE *pFile = stdin;
+  int c;
+
+  while(-1 != (c = getopt(argc, argv, "a:s")))
+  {
+    switch(c)
+    {
+      case 'a':
+        addr = strtoul(optarg, NULL, 16);
+        ownAddr.u8[0] = (uint8_t)(addr >> 8);
+        ownAddr.u8[1] = (uint8_t)addr;
+        break;
+      case 's':
+        withStats = true;
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-a <own address>] [-s] [uart capture]\n", argv[0]);
+        return 1;
+    }
+  }
+  if((optind < argc) && (NULL == (pFile = fopen(argv[optind], "rb"))))
+  {
+    perror(argv[optind]);
+    return 1;
+  }
+
+  tsch_log_reader_init(&reader);
+  while(EOF != (c = fgetc(pFile)))
+  {
+    switch(tsch_log_reader_feed(&reader, (uint8_t)c))
+    {
+      case TSCH_LOG_READ_RECORD:
+        tsch_log_print(stdout, &reader.record, &ownAddr);
+        tsch_log_stats_add(&stats, &reader.record);
+        break;
+      case TSCH_LOG_READ_TEXT:
+        printf("%s\n", reader.text);
+        break;
+      case TSCH_LOG_READ_INVALID:
+        invalid++;
+        break;
+      default:
+        break;
+    }
+  }
+
+  if(withStats)
+  {
+    printf("\n%u invalid frames, ", invalid);
+    tsch_log_stats_print(stdout, &stats);
+  }
+  return 0;
+}
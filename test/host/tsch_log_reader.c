@@ -0,0 +1,259 @@
+/**
+ @file
+ @brief      Decoder of the binary per-slot TSCH log, see tsch_log_reader.h.
+*/
+#include <stdlib.h>
+#include <string.h>
+
+#include "lib/contiki-crc16.h"
+#include "tsch_log_reader.h"
+
+/* SLIP special characters */
+#define SLIP_END           0300
+#define SLIP_ESC           0333
+#define SLIP_ESC_END       0334
+#define SLIP_ESC_ESC       0335
+#define RECORD_LEN         sizeof(struct tsch_log_record_t)
+#define CRC_LEN            2U
+
+static void loc_lladdr(FILE *pFile, const linkaddr_t *pAddr)
+{
+  if((NULL == pAddr) || linkaddr_cmp(pAddr, &linkaddr_null))
+  {
+    fprintf(pFile, "LL-NULL");
+  }
+  else
+  {
+    fprintf(pFile, "LL-%02x%02x", pAddr->u8[0], pAddr->u8[1]);
+  }
+}
+
+static tsch_log_read_t loc_frameEnd(tsch_log_reader_t *pReader)
+{
+  uint16_t crc;
+
+  if(RECORD_LEN + CRC_LEN != pReader->len)
+  {
+    return TSCH_LOG_READ_INVALID;
+  }
+  crc = crc16_data(pReader->frame, RECORD_LEN, 0);
+  if((pReader->frame[RECORD_LEN] != (crc & 0xFF)) ||
+     (pReader->frame[RECORD_LEN + 1] != (crc >> 8)))
+  {
+    return TSCH_LOG_READ_INVALID;
+  }
+  memcpy(&pReader->record, pReader->frame, RECORD_LEN);
+  return TSCH_LOG_READ_RECORD;
+}
+
+void tsch_log_reader_init(tsch_log_reader_t *pReader)
+{
+  memset(pReader, 0, sizeof(*pReader));
+}
+
+tsch_log_read_t tsch_log_reader_feed(tsch_log_reader_t *pReader, uint8_t byte)
+{
+  if(SLIP_END == byte)
+  {
+    /* Frames start and end with END, an empty frame is a start */
+    if(!pReader->inFrame || (0U == pReader->len))
+    {
+      pReader->inFrame = true;
+      pReader->escaped = false;
+      pReader->len = 0;
+      return TSCH_LOG_READ_NONE;
+    }
+    pReader->inFrame = false;
+    return loc_frameEnd(pReader);
+  }
+
+  if(!pReader->inFrame)
+  {
+    if('\n' == byte)
+    {
+      pReader->text[pReader->textLen] = '\0';
+      pReader->textLen = 0;
+      return TSCH_LOG_READ_TEXT;
+    }
+    if(pReader->textLen < sizeof(pReader->text) - 1U)
+    {
+      pReader->text[pReader->textLen++] = (char)byte;
+    }
+    return TSCH_LOG_READ_NONE;
+  }
+
+  if(SLIP_ESC == byte)
+  {
+    pReader->escaped = true;
+    return TSCH_LOG_READ_NONE;
+  }
+  if(pReader->escaped)
+  {
+    byte = (SLIP_ESC_END == byte) ? SLIP_END : (SLIP_ESC_ESC == byte) ? SLIP_ESC : byte;
+    pReader->escaped = false;
+  }
+  if(pReader->len < sizeof(pReader->frame))
+  {
+    pReader->frame[pReader->len++] = byte;
+  }
+  return TSCH_LOG_READ_NONE;
+}
+
+void tsch_log_print(FILE *pFile, const struct tsch_log_record_t *pRecord,
+                    const linkaddr_t *pOwnAddr)
+{
+  unsigned unicast = (0U != (pRecord->flags & TSCH_LOG_RECORD_FLAG_UNICAST));
+  unsigned data = (0U != (pRecord->flags & TSCH_LOG_RECORD_FLAG_DATA));
+  unsigned secLevel = (pRecord->flags >> TSCH_LOG_RECORD_SEC_LEVEL_SHIFT) & 7U;
+  bool driftUsed = (0U != (pRecord->flags & TSCH_LOG_RECORD_FLAG_DRIFT_USED));
+  /* Copied out of the packed record */
+  linkaddr_t addr;
+
+  if(TSCH_LOG_RECORD_TYPE_DROPPED == pRecord->type)
+  {
+    fprintf(pFile, "[WARN: TSCH-LOG  ] logs dropped %u\n", pRecord->dropped.count);
+    return;
+  }
+
+  if(0U == (pRecord->flags & TSCH_LOG_RECORD_FLAG_LINK))
+  {
+    fprintf(pFile, "[INFO: TSCH-LOG  ] {asn %02x.%08x link-NULL} ",
+            pRecord->asn_ms1b, pRecord->asn_ls4b);
+  }
+  else
+  {
+    fprintf(pFile, "[INFO: TSCH-LOG  ] {asn %02x.%08x link %2u %3u %3u %2u %2u ch %2u} ",
+            pRecord->asn_ms1b, pRecord->asn_ls4b, pRecord->slotframe_handle,
+            pRecord->slotframe_size, pRecord->burst_count,
+            pRecord->timeslot + pRecord->burst_count, pRecord->channel_offset,
+            pRecord->channel);
+  }
+
+  switch(pRecord->type)
+  {
+    case tsch_log_tx:
+      fprintf(pFile, "%s-%u-%u tx ", unicast ? "uc" : "bc", data, secLevel);
+      loc_lladdr(pFile, pOwnAddr);
+      fprintf(pFile, "->");
+      addr = pRecord->tx.dest;
+      loc_lladdr(pFile, &addr);
+      fprintf(pFile, ", len %3u, seq %3u, st %d (%d/%d) (%d/%d) %2d",
+              pRecord->tx.datalen, pRecord->seqno, pRecord->tx.mac_tx_status,
+              pRecord->tx.radio_prop_err, pRecord->tx.radio_sched_err,
+              pRecord->tx.pending_tx_counter, pRecord->tx.pending_tx_counter_reset,
+              pRecord->tx.num_tx);
+      if(driftUsed)
+      {
+        fprintf(pFile, ", dr %3d", pRecord->tx.drift);
+      }
+      fprintf(pFile, "\n");
+      break;
+    case tsch_log_rx:
+      fprintf(pFile, "%s-%u-%u rx ", unicast ? "uc" : "bc", data, secLevel);
+      addr = pRecord->rx.src;
+      loc_lladdr(pFile, &addr);
+      fprintf(pFile, "->");
+      loc_lladdr(pFile, unicast ? pOwnAddr : NULL);
+      fprintf(pFile, ", app ack %2u", pRecord->rx.ack_data);
+      fprintf(pFile, ", len %3u, seq %3u", pRecord->rx.datalen, pRecord->seqno);
+      fprintf(pFile, ", edr %3d", pRecord->rx.estimated_drift);
+      if(driftUsed)
+      {
+        fprintf(pFile, ", dr %3d", pRecord->rx.drift);
+      }
+      fprintf(pFile, "\n");
+      break;
+    case tsch_log_message:
+      fprintf(pFile, "%.*s\n", (int)sizeof(pRecord->message), pRecord->message);
+      break;
+    default:
+      fprintf(pFile, "type %u\n", pRecord->type);
+      break;
+  }
+}
+
+void tsch_log_stats_add(tsch_log_stats_t *pStats, const struct tsch_log_record_t *pRecord)
+{
+  tsch_log_slot_t *pSlot;
+  bool driftUsed = (0U != (pRecord->flags & TSCH_LOG_RECORD_FLAG_DRIFT_USED));
+  int drift = 0;
+  unsigned s;
+
+  if(TSCH_LOG_RECORD_TYPE_DROPPED == pRecord->type)
+  {
+    pStats->dropped = pRecord->dropped.count;
+    return;
+  }
+  pStats->records++;
+  if(0U == (pRecord->flags & TSCH_LOG_RECORD_FLAG_LINK))
+  {
+    pStats->messages++;
+    return;
+  }
+
+  /* The slot, inserted in order if new */
+  for(s = 0; s < pStats->slots; s++)
+  {
+    pSlot = &pStats->slot[s];
+    if((pSlot->slotframeHandle > pRecord->slotframe_handle) ||
+       ((pSlot->slotframeHandle == pRecord->slotframe_handle) &&
+        (pSlot->timeslot >= pRecord->timeslot)))
+    {
+      break;
+    }
+  }
+  if((s == pStats->slots) || (pStats->slot[s].slotframeHandle != pRecord->slotframe_handle) ||
+     (pStats->slot[s].timeslot != pRecord->timeslot))
+  {
+    if(TSCH_LOG_STATS_SLOTS_MAX == pStats->slots)
+    {
+      return;
+    }
+    memmove(&pStats->slot[s + 1], &pStats->slot[s],
+            (pStats->slots - s) * sizeof(pStats->slot[0]));
+    memset(&pStats->slot[s], 0, sizeof(pStats->slot[0]));
+    pStats->slot[s].slotframeHandle = pRecord->slotframe_handle;
+    pStats->slot[s].timeslot = pRecord->timeslot;
+    pStats->slots++;
+  }
+  pSlot = &pStats->slot[s];
+
+  if(tsch_log_tx == pRecord->type)
+  {
+    pSlot->tx++;
+    pSlot->txOk += (MAC_TX_OK == pRecord->tx.mac_tx_status);
+    pSlot->txNoAck += (MAC_TX_NOACK == pRecord->tx.mac_tx_status);
+    drift = pRecord->tx.drift;
+  }
+  else if(tsch_log_rx == pRecord->type)
+  {
+    pSlot->rx++;
+    drift = pRecord->rx.drift;
+  }
+  if(driftUsed)
+  {
+    pSlot->drifts++;
+    pSlot->driftSum += drift;
+    pSlot->driftMax = (abs(drift) > abs(pSlot->driftMax)) ? drift : pSlot->driftMax;
+  }
+}
+
+void tsch_log_stats_print(FILE *pFile, const tsch_log_stats_t *pStats)
+{
+  const tsch_log_slot_t *pSlot;
+  unsigned s;
+
+  fprintf(pFile, "%u records, %u without link, %u logs dropped\n",
+          pStats->records, pStats->messages, pStats->dropped);
+  fprintf(pFile, "  sf  ts      tx  ok %%  noack %%      rx  drift mean   max\n");
+  for(s = 0; s < pStats->slots; s++)
+  {
+    pSlot = &pStats->slot[s];
+    fprintf(pFile, "  %2u %3u  %6u  %5.1f  %7.1f  %6u  %10.1f  %4d\n",
+            pSlot->slotframeHandle, pSlot->timeslot, pSlot->tx,
+            pSlot->tx ? 100.0 * pSlot->txOk / pSlot->tx : 0.0,
+            pSlot->tx ? 100.0 * pSlot->txNoAck / pSlot->tx : 0.0, pSlot->rx,
+            pSlot->drifts ? (double)pSlot->driftSum / pSlot->drifts : 0.0,
+            pSlot->driftMax);
+  }
+}
@@ -0,0 +1,97 @@
+/**
+ @file
+ @brief      Decoder of the binary per-slot TSCH log of the SCs.
+
+ @details Reads the UART stream of an SC built with TSCH_LOG_CONF_BINARY:
+          SLIP frames of struct tsch_log_record_t with their CRC-16,
+          interleaved with the ASCII text of the other logs. A record is
+          printed in the text format of the per-slot log, messages cut to
+          TSCH_LOG_BINARY_MESSAGE_LEN characters. The own address, not
+          part of the records, is given by the reader.
+
+          The statistics count per slot the Tx with their status and the
+          Rx, and the drift corrections taken.
+*/
+#ifndef TSCH_LOG_READER_H
+#define TSCH_LOG_READER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "net/mac/tsch/tsch.h"
+
+#if !TSCH_LOG_BINARY
+#error The decoder is built with TSCH_LOG_CONF_BINARY
+#endif
+
+/* Slots of the statistics */
+#define TSCH_LOG_STATS_SLOTS_MAX   64U
+/* Longest text line kept */
+#define TSCH_LOG_TEXT_MAX_LEN      256U
+
+typedef enum
+{
+  /* More bytes needed */
+  TSCH_LOG_READ_NONE,
+  /* A record in record */
+  TSCH_LOG_READ_RECORD,
+  /* A line of text in text, without the line end */
+  TSCH_LOG_READ_TEXT,
+  /* A frame of a wrong length or CRC */
+  TSCH_LOG_READ_INVALID,
+} tsch_log_read_t;
+
+typedef struct
+{
+  bool inFrame;
+  bool escaped;
+  /* Record and CRC, one more byte marks a frame too long */
+  uint8_t frame[sizeof(struct tsch_log_record_t) + 3];
+  size_t len;
+  char text[TSCH_LOG_TEXT_MAX_LEN];
+  size_t textLen;
+  struct tsch_log_record_t record;
+} tsch_log_reader_t;
+
+typedef struct
+{
+  uint16_t slotframeHandle;
+  uint16_t timeslot;
+  unsigned tx;
+  unsigned txOk;
+  unsigned txNoAck;
+  unsigned rx;
+  unsigned drifts;
+  long driftSum;
+  int driftMax;
+} tsch_log_slot_t;
+
+typedef struct
+{
+  unsigned records;
+  /* Records without a link */
+  unsigned messages;
+  /* Logs dropped by the SC, as last reported */
+  unsigned dropped;
+  unsigned slots;
+  /* Ordered by slotframe and timeslot */
+  tsch_log_slot_t slot[TSCH_LOG_STATS_SLOTS_MAX];
+} tsch_log_stats_t;
+
+void tsch_log_reader_init(tsch_log_reader_t *pReader);
+
+/* Reads the next byte of the stream. */
+tsch_log_read_t tsch_log_reader_feed(tsch_log_reader_t *pReader, uint8_t byte);
+
+/* Prints a record as the per-slot log in text mode, with its line end. */
+void tsch_log_print(FILE *pFile, const struct tsch_log_record_t *pRecord,
+                    const linkaddr_t *pOwnAddr);
+
+/* Adds a record to the statistics, initialized with zeros. */
+void tsch_log_stats_add(tsch_log_stats_t *pStats, const struct tsch_log_record_t *pRecord);
+
+void tsch_log_stats_print(FILE *pFile, const tsch_log_stats_t *pStats);
+
+#endif /* TSCH_LOG_READER_H */